@@ -0,0 +1,375 @@
+#include <benchmark/benchmark.h>
+
+#include <QtGlobal>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+#include <opencv2/imgproc.hpp>
+
+#include "core/detection_controller.h"
+#include "core/synthetic_parts.h"
+#include "core/yolo_detector.h"
+#include "ui/widgets/video_display.h"
+
+/**
+ * 檢測管線基準測試（Google Benchmark）
+ *
+ * 微基準：standardProcessing / ultraHighSpeedProcessing / detectObjects / updateObjectTracks /
+ *         YoloDetector::detect / VideoDisplayWidget::matToQImage，涵蓋代表性的 ROI 尺寸與物件密度
+ * 巨集基準：SyntheticPartsGenerator 的落料序列完整跑過 processFrame，同時回報吞吐量與計數準確度（相對真值）
+ *
+ * 機器可讀輸出：--benchmark_format=json 或 --benchmark_out=<檔案> --benchmark_out_format=json
+ * （scripts/benchmark.sh 以版本號命名保存並與上一份結果比較）
+ * YOLO 基準需以 BASLER_BENCH_YOLO_MODEL 指定 ONNX 模型，未指定時略過。
+ */
+
+namespace basler
+{
+
+    // 只供基準測試使用：存取 DetectionController 的私有處理階段
+    class DetectionBenchmark
+    {
+    public:
+        static cv::Mat standardProcessing(DetectionController &c, const cv::Mat &region) { return c.standardProcessing(region); }
+        static cv::Mat ultraHighSpeedProcessing(DetectionController &c, const cv::Mat &region) { return c.ultraHighSpeedProcessing(region); }
+        static std::vector<DetectedObject> detectObjects(DetectionController &c, const cv::Mat &mask) { return c.detectObjects(mask, false); }
+        static void updateObjectTracks(DetectionController &c, const std::vector<DetectedObject> &objects) { c.updateObjectTracks(objects); }
+    };
+
+} // namespace basler
+
+namespace
+{
+    using basler::DetectedObject;
+    using basler::DetectionBenchmark;
+    using basler::DetectionController;
+    using basler::SyntheticConfig;
+    using basler::SyntheticPartsGenerator;
+
+    constexpr int SEQUENCE_FRAMES = 64;
+    constexpr int WARMUP_FRAMES = 32;
+
+    // 合成落料場景：約 40 幀穿越畫面高度（120 fps）
+    SyntheticConfig sceneConfig(int width, int height, double partsPerMinute, int frames)
+    {
+        SyntheticConfig config;
+        config.width = width;
+        config.height = height;
+        config.frames = frames;
+        config.partsPerMinute = partsPerMinute;
+        config.speedPxPerFrame = height / 40.0;
+        return config;
+    }
+
+    std::vector<cv::Mat> renderAll(const SyntheticPartsGenerator &generator)
+    {
+        std::vector<cv::Mat> frames(generator.frameCount());
+        for (int i = 0; i < generator.frameCount(); ++i)
+        {
+            generator.render(i, frames[i]);
+        }
+        return frames;
+    }
+
+    // 含 count 個互不重疊方塊的二值遮罩（detectObjects 的輸入）
+    cv::Mat makeBlobMask(cv::Size size, int count)
+    {
+        cv::Mat mask = cv::Mat::zeros(size, CV_8UC1);
+        cv::RNG rng(7);
+        const int cell = std::max(8, static_cast<int>(std::sqrt(size.area() / std::max(1, count))));
+        const int columns = std::max(1, size.width / cell);
+        for (int i = 0; i < count; ++i)
+        {
+            const int x = (i % columns) * cell;
+            const int y = (i / columns) * cell;
+            if (y + cell > size.height)
+            {
+                break;
+            }
+            const int side = rng.uniform(3, std::max(4, cell / 2));
+            cv::rectangle(mask, cv::Rect(x + 1, y + 1, side, side), cv::Scalar(255), cv::FILLED);
+        }
+        return mask;
+    }
+
+    // 代表性 ROI：{寬, 高, 每分鐘零件數}
+    void roiArgs(benchmark::internal::Benchmark *b)
+    {
+        b->ArgNames({"w", "h", "ppm"});
+        for (const auto &size : std::vector<std::pair<int, int>>{{640, 120}, {640, 240}, {1280, 240}, {1920, 480}})
+        {
+            for (int partsPerMinute : {300, 3000})
+            {
+                b->Args({size.first, size.second, partsPerMinute});
+            }
+        }
+    }
+
+    // processRegion 類階段：背景先以序列暖身（有狀態），之後循環餵入
+    template <cv::Mat (*Stage)(DetectionController &, const cv::Mat &)>
+    void runRegionStage(benchmark::State &state)
+    {
+        const cv::Size size(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+        SyntheticPartsGenerator generator;
+        generator.configure(sceneConfig(size.width, size.height, static_cast<double>(state.range(2)), SEQUENCE_FRAMES));
+        const std::vector<cv::Mat> sequence = renderAll(generator);
+
+        DetectionController controller;
+        for (int i = 0; i < WARMUP_FRAMES; ++i)
+        {
+            Stage(controller, sequence[i % SEQUENCE_FRAMES]);
+        }
+
+        size_t frame = 0;
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(Stage(controller, sequence[frame++ % SEQUENCE_FRAMES]).data);
+        }
+        state.SetItemsProcessed(state.iterations());
+        state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(size.area()));
+    }
+
+    void BM_StandardProcessing(benchmark::State &state)
+    {
+        runRegionStage<&DetectionBenchmark::standardProcessing>(state);
+    }
+    BENCHMARK(BM_StandardProcessing)->Apply(roiArgs)->Unit(benchmark::kMicrosecond);
+
+    void BM_UltraHighSpeedProcessing(benchmark::State &state)
+    {
+        runRegionStage<&DetectionBenchmark::ultraHighSpeedProcessing>(state);
+    }
+    BENCHMARK(BM_UltraHighSpeedProcessing)->Apply(roiArgs)->Unit(benchmark::kMicrosecond);
+
+    void BM_DetectObjects(benchmark::State &state)
+    {
+        const cv::Size size(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+        const cv::Mat mask = makeBlobMask(size, static_cast<int>(state.range(2)));
+
+        DetectionController controller;
+        size_t objects = 0;
+        for (auto _ : state)
+        {
+            const auto detected = DetectionBenchmark::detectObjects(controller, mask);
+            objects = detected.size();
+            benchmark::DoNotOptimize(detected.data());
+        }
+        state.counters["objects"] = static_cast<double>(objects);
+        state.SetItemsProcessed(state.iterations());
+    }
+    BENCHMARK(BM_DetectObjects)
+        ->ArgNames({"w", "h", "blobs"})
+        ->Args({640, 120, 4})
+        ->Args({640, 120, 32})
+        ->Args({640, 240, 128})
+        ->Args({1920, 480, 512})
+        ->Unit(benchmark::kMicrosecond);
+
+    // 每幀的偵測結果直接取自合成序列的真值位置（追蹤與匹配成本只取決於物件數與移動量）
+    void BM_UpdateObjectTracks(benchmark::State &state)
+    {
+        SyntheticPartsGenerator generator;
+        generator.configure(sceneConfig(640, 480, static_cast<double>(state.range(0)), SEQUENCE_FRAMES));
+
+        std::vector<std::vector<DetectedObject>> detections(SEQUENCE_FRAMES);
+        std::vector<int> visible;
+        size_t totalObjects = 0;
+        for (int f = 0; f < SEQUENCE_FRAMES; ++f)
+        {
+            generator.visibleParts(f, visible);
+            for (int index : visible)
+            {
+                const basler::SyntheticPart &part = generator.parts()[index];
+                const int cx = static_cast<int>(part.x);
+                const int cy = static_cast<int>(part.yAt(f));
+                const int rx = static_cast<int>(part.radiusX) + 1;
+                const int ry = static_cast<int>(part.radiusY) + 1;
+                detections[f].push_back({cx - rx, cy - ry, 2 * rx, 2 * ry, cx, cy, 4 * rx * ry});
+            }
+            totalObjects += detections[f].size();
+        }
+
+        DetectionController controller;
+        size_t frame = 0;
+        for (auto _ : state)
+        {
+            // 序列循環時零件位置不連續，重置追蹤表而非累積大量孤立追蹤
+            if (frame % SEQUENCE_FRAMES == 0)
+            {
+                state.PauseTiming();
+                controller.reset();
+                state.ResumeTiming();
+            }
+            DetectionBenchmark::updateObjectTracks(controller, detections[frame++ % SEQUENCE_FRAMES]);
+        }
+        state.counters["objects"] = static_cast<double>(totalObjects) / SEQUENCE_FRAMES;
+        state.SetItemsProcessed(state.iterations());
+    }
+    BENCHMARK(BM_UpdateObjectTracks)->ArgName("ppm")->Arg(300)->Arg(1200)->Arg(6000)->Arg(24000)->Unit(benchmark::kMicrosecond);
+
+    void BM_YoloDetect(benchmark::State &state)
+    {
+        const char *modelPath = std::getenv("BASLER_BENCH_YOLO_MODEL");
+        if (!modelPath || !*modelPath)
+        {
+            state.SkipWithError("未設定 BASLER_BENCH_YOLO_MODEL");
+            return;
+        }
+
+        basler::YoloDetector detector;
+        if (!detector.loadModel(modelPath))
+        {
+            state.SkipWithError("YOLO 模型載入失敗");
+            return;
+        }
+
+        SyntheticPartsGenerator generator;
+        generator.configure(sceneConfig(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)),
+                                        static_cast<double>(state.range(2)), 1));
+        cv::Mat frame;
+        cv::Mat roi;
+        generator.render(0, frame);
+        cv::cvtColor(frame, roi, cv::COLOR_GRAY2BGR);
+
+        std::vector<DetectedObject> results;
+        for (auto _ : state)
+        {
+            detector.detect(roi, 0, 0, results);
+            benchmark::DoNotOptimize(results.data());
+        }
+        state.counters["objects"] = static_cast<double>(results.size());
+        state.SetItemsProcessed(state.iterations());
+        state.SetLabel(detector.backendName() + "/" + detector.modelPrecision());
+    }
+    BENCHMARK(BM_YoloDetect)
+        ->ArgNames({"w", "h", "ppm"})
+        ->Args({640, 120, 1200})
+        ->Args({1280, 240, 6000})
+        ->Unit(benchmark::kMillisecond);
+
+    void BM_MatToQImage(benchmark::State &state)
+    {
+        const cv::Size size(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)));
+        const int channels = static_cast<int>(state.range(2));
+        SyntheticPartsGenerator generator;
+        generator.configure(sceneConfig(size.width, size.height, 1200, 1));
+        cv::Mat frame;
+        generator.render(0, frame);
+        if (channels == 3)
+        {
+            cv::cvtColor(frame, frame, cv::COLOR_GRAY2BGR);
+        }
+
+        for (auto _ : state)
+        {
+            QImage image = basler::VideoDisplayWidget::matToQImage(frame);
+            benchmark::DoNotOptimize(image.constBits());
+        }
+        state.SetItemsProcessed(state.iterations());
+        state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(frame.total() * frame.elemSize()));
+    }
+    BENCHMARK(BM_MatToQImage)
+        ->ArgNames({"w", "h", "ch"})
+        ->Args({640, 480, 1})
+        ->Args({640, 480, 3})
+        ->Args({1920, 1200, 1})
+        ->Args({1920, 1200, 3})
+        ->Unit(benchmark::kMicrosecond);
+
+    /**
+     * 巨集基準：每次迭代以全新的 DetectionController 跑完整段合成序列（processFrame 全流程）。
+     * burnin = 1 時每幀複製並燒入繪製結果（舊行為），否則只產生 FrameOverlay 資料（預設顯示路徑）。
+     * counted / truth = 最後一次迭代的計數與真值穿越數；accuracy = 1 - |counted - truth| / truth
+     */
+    void BM_FallingPartsPipeline(benchmark::State &state)
+    {
+        SyntheticConfig config = sceneConfig(static_cast<int>(state.range(0)), static_cast<int>(state.range(1)),
+                                             static_cast<double>(state.range(2)), static_cast<int>(state.range(3)));
+        config.reflectiveRatio = state.range(5) != 0 ? 1.0 : 0.0;
+        config.overlapRatio = state.range(6) / 100.0;
+        SyntheticPartsGenerator generator;
+        generator.configure(config);
+        const std::vector<cv::Mat> sequence = renderAll(generator);
+
+        int counted = 0;
+        int truth = 0;
+        for (auto _ : state)
+        {
+            state.PauseTiming();
+            auto controller = std::make_unique<DetectionController>();
+            controller->setUltraHighSpeedMode(state.range(4) != 0);
+            controller->enable();
+            std::vector<DetectedObject> objects;
+            basler::FrameOverlay overlay;
+            cv::Mat annotated;
+            cv::Mat *burnIn = state.range(7) != 0 ? &annotated : nullptr;
+            state.ResumeTiming();
+
+            for (const cv::Mat &frame : sequence)
+            {
+                controller->processFrame(frame, objects, overlay, burnIn);
+                benchmark::DoNotOptimize(overlay.boxes.data());
+                benchmark::DoNotOptimize(annotated.data);
+            }
+
+            state.PauseTiming();
+            counted = controller->count();
+            truth = generator.crossings(controller->gateLineY());
+            controller.reset();
+            state.ResumeTiming();
+        }
+
+        const double frames = static_cast<double>(sequence.size());
+        state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(sequence.size()));
+        state.counters["fps"] = benchmark::Counter(frames, benchmark::Counter::kIsIterationInvariantRate);
+        state.counters["counted"] = counted;
+        state.counters["truth"] = truth;
+        state.counters["accuracy"] = truth > 0 ? 1.0 - std::abs(counted - truth) / static_cast<double>(truth) : 1.0;
+    }
+    BENCHMARK(BM_FallingPartsPipeline)
+        ->ArgNames({"w", "h", "ppm", "frames", "ultra", "reflective", "overlap", "burnin"})
+        ->Args({640, 480, 300, 1200, 0, 0, 0, 0})
+        ->Args({640, 480, 1200, 1200, 0, 0, 0, 0})
+        ->Args({640, 480, 1200, 1200, 0, 0, 0, 1})
+        ->Args({640, 480, 1200, 1200, 1, 0, 0, 0})
+        ->Args({640, 480, 1200, 1200, 0, 1, 0, 0})
+        ->Args({640, 480, 1200, 1200, 0, 0, 20, 0})
+        ->Args({1280, 1024, 3000, 1200, 0, 0, 0, 0})
+        ->Args({1920, 1200, 6000, 1200, 0, 0, 0, 0})
+        ->Args({1920, 1200, 6000, 1200, 0, 0, 0, 1})
+        ->Unit(benchmark::kMillisecond)
+        ->MeasureProcessCPUTime()
+        ->UseRealTime();
+
+    // 檢測管線的 qDebug 輸出會干擾計時與 JSON 輸出；設定 BASLER_BENCH_VERBOSE 時保留
+    void quietMessageHandler(QtMsgType type, const QMessageLogContext &, const QString &message)
+    {
+        if (type != QtDebugMsg && type != QtInfoMsg)
+        {
+            std::fprintf(stderr, "%s\n", qPrintable(message));
+        }
+    }
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    if (!std::getenv("BASLER_BENCH_VERBOSE"))
+    {
+        qInstallMessageHandler(quietMessageHandler);
+    }
+
+    benchmark::AddCustomContext("basler_version", BASLER_BENCH_VERSION);
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv))
+    {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
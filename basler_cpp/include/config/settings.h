@@ -32,6 +32,7 @@ struct DetectionConfig {
     int bgVarThreshold = 3;
     bool detectShadows = false;
     double bgLearningRate = 0.001;
+    QString bgModel = "mog2";              // 背景模型: mog2 / gaussian（單高斯定點，mono8 固定背景）
 
     // 邊緣檢測參數
     int gaussianBlurKernelSize = 1;
@@ -68,6 +69,7 @@ struct DetectionConfig {
     int targetFps = 280;
     int highSpeedBgHistory = 100;
     int highSpeedBgVarThreshold = 8;
+    QString highSpeedBgModel = "mog2";     // 高速模式的背景模型（gaussian 約為 MOG2 成本的一小部分）
     int highSpeedMinArea = 1;
     int highSpeedMaxArea = 2000;
     int highSpeedBinaryThreshold = 3;
@@ -85,6 +87,10 @@ struct GateConfig {
     int gateTriggerRadius = 20;
     int gateHistoryFrames = 8;
 
+    // 追蹤匹配：全域最佳指派（Hungarian），每幀超出時間預算的部分回退貪婪匹配
+    bool optimalAssignment = false;
+    double assignmentBudgetMs = 2.0;
+
     // 直接位置參數（UI 面板使用）
     int yPosition = 240;      // 虛擬閘門 Y 位置
     int triggerRadius = 20;   // 觸發半徑
@@ -116,7 +122,23 @@ struct PackagingConfig {
 
     // 反應時間補償
     int stopDelayFrames = 10;
-    int advanceStopCount = 2;
+    int advanceStopCount = 2;            // predictive 模式：以 CREEP 落料的最少顆數
+
+    // 降速排程："predictive" = 依量測的落料速率與致動延遲預估剩餘時間；"threshold" = 依進度閾值
+    // （predictive 在 FULL 速率量測到之前自動使用 threshold）
+    QString speedControlMode = "predictive";
+    int flowSettleMs = 300;              // 速度切換後流量穩定所需時間（含機械反應）
+    int actuationLatencyMs = 50;         // 沒有即時控制線程量測值時假設的計數→致動延遲
+    double flowSafetyFactor = 1.5;       // 過渡期落料數的安全係數
+    double flowRateAlpha = 0.2;          // 落料間隔 EWMA 係數
+    int flowMinSamples = 3;              // 檔位至少累積幾個間隔才採用
+
+    // 即時控制線程：計數事件經無鎖佇列直送震動機（不經 Qt 事件循環），並統計計數→致動延遲
+    bool realtimeControl = true;
+    int controlThreadCore = -1;          // 控制線程綁定的核心（-1 = 不綁定）
+    int controlQueueCapacity = 256;      // 計數事件可排隊數（上限 4096；佇列只配置一次，重啟時不重建）
+    int controlSpinUs = 200;             // 佇列空時先自旋的時間（微秒），之後才休眠等待
+    int latencyReportIntervalMs = 10000; // 延遲直方圖輸出間隔（0 = 不輸出）
 
     // 提示音設定
     bool enableSoundAlert = true;
@@ -127,6 +149,39 @@ struct PackagingConfig {
     static PackagingConfig fromJson(const QJsonObject& json);
 };
 
+/**
+ * @brief 震動機驅動配置（兩台震動機共用同一條 Modbus 鏈路，以站號區分）
+ */
+struct VibratorConfig {
+    QString driver = "simulated"; // "simulated" / "modbus_rtu" / "modbus_tcp"
+
+    // Modbus RTU（RS-485）
+    QString serialPort;           // 例如 /dev/ttyUSB0、COM3
+    int baudRate = 19200;
+    QString parity = "even";      // "none" / "even" / "odd"
+    int stopBits = 1;
+
+    // Modbus TCP
+    QString host = "192.168.1.10";
+    int tcpPort = 502;
+
+    // 站號與暫存器（以 FC06 寫單一保持暫存器）
+    int unitId1 = 1;
+    int unitId2 = 2;
+    int speedRegister = 0;        // 速度設定值暫存器
+    int runRegister = 1;          // 運轉 / 停止暫存器（寫 1 / 0；-1 = 無，速度 0 即停止）
+    int speedFullScale = 100;     // 100% 對應的暫存器值（例如變頻器 5000 = 50.00Hz）
+
+    // 通訊
+    int responseTimeoutMs = 50;   // 單次請求等待回應的上限
+    int maxRetries = 2;           // 每個指令失敗後的重試次數（之後回報錯誤並於 retryBackoffMs 後再送）
+    int retryBackoffMs = 200;
+    int refreshIntervalMs = 1000; // 無新指令時重送目前設定值的間隔（0 = 不重送）
+
+    QJsonObject toJson() const;
+    static VibratorConfig fromJson(const QJsonObject& json);
+};
+
 /**
  * @brief 性能優化配置
  */
@@ -137,6 +192,50 @@ struct PerformanceConfig {
     int targetProcessingWidth = 640;
     int skipFrames = 0;
 
+    // 幀環形緩衝槽位數（檢測/錄影可落後的最大幀數，640×480 mono8 每槽約 300KB）
+    int frameRingCapacity = 32;
+
+    // standardProcessing 使用融合管線（持久緩衝 + 快取結構元素 + SIMD 融合逐像素步驟）
+    bool fusedStandardPipeline = true;
+
+    // 每幀同時執行參考管線並比對輸出（驗證用，約多一倍處理時間）；
+    // cropBeforeResize 時另以整幀縮放後裁切的條帶重跑背景模型與濾波，比對最終遮罩與物件清單
+    bool verifyFusedPipeline = false;
+
+    // 先裁切再縮放：ROI 在縮放座標計算後只縮放 ROI 條帶加濾波半徑的邊界（取樣網格與整幀縮放相同，
+    // 結果逐像素一致）；false = 整幀縮放後裁切
+    bool cropBeforeResize = true;
+
+    // 傳統檢測管線執行裝置：cpu / opencl / auto（auto 只在預設 OpenCL 裝置為 GPU 時使用裝置）；
+    // 裝置模式下中間結果留在裝置上，只下載最終遮罩；無可用裝置或執行失敗時自動回退 CPU
+    QString classicalDevice = "cpu";
+
+    // 背景減除分帶數（ROI 切成 N 個水平帶各自一個 MOG2，平行執行；1 = 單一實例，結果相同）
+    int bgSubtractorBands = 4;
+
+    // detectObjects 以行程編碼擷取連通元件（不產生 labels 影像）；false = connectedComponentsWithStats
+    bool runLengthBlobs = true;
+
+    // 自適應品質調節：檢測跟不上相機幀率時依序降級（調試擷取 → overlay → 高速流程 → 處理寬度）
+    bool adaptiveQuality = true;
+    double governorDegradeLoad = 0.9;   // 處理耗時 / 幀間隔超過此值視為過載
+    double governorRestoreLoad = 0.6;   // 低於此值視為有餘裕
+    int governorBacklogFrames = 4;      // 落後幀數超過此值視為過載
+
+    // 逐階段延遲統計（常駐，開銷約每階段兩次時鐘讀取）；每個窗口發送一次快照
+    bool stageProfiling = true;
+    int stageProfilingIntervalMs = 1000;
+
+    // 檢測結果以 FrameOverlay 資料交給顯示組件繪製（不複製 / 不燒入幀）；
+    // false = 舊行為，檢測線程每幀複製並燒入繪製結果
+    bool overlayAsData = true;
+
+    // 影片播放：解碼線程預先解碼的幀數；最近解碼幀快取（單步後退），
+    // 未命中時從目標往前 videoStepBackSpan 幀一次跳轉並解碼整段
+    int videoPrefetchFrames = 16;
+    int videoFrameCacheFrames = 64;
+    int videoStepBackSpan = 30;
+
     bool showGray = false;
     bool showBinary = false;
     bool showEdges = false;
@@ -147,6 +246,52 @@ struct PerformanceConfig {
     static PerformanceConfig fromJson(const QJsonObject& json);
 };
 
+/**
+ * @brief 遙測配置（內嵌 HTTP 指標端點，Prometheus / OpenMetrics 文字格式）
+ */
+struct TelemetryConfig {
+    bool enabled = false;
+    QString bindAddress = "0.0.0.0"; // 只監聽本機時用 127.0.0.1
+    int port = 9464;
+    QString station;                 // 指標的 station 標籤（空 = 主機名稱）
+
+    QJsonObject toJson() const;
+    static TelemetryConfig fromJson(const QJsonObject& json);
+};
+
+/**
+ * @brief 單一類管線線程的排程配置
+ */
+struct ThreadSchedulingConfig {
+    QString affinity;            // 允許執行的邏輯核心，如 "2-3,6"（空 = 不限制）
+    QString priority = "normal"; // "normal" / "high" / "realtime"
+    QString coreClass = "any";   // "any" / "performance" / "efficiency"（big.LITTLE、Intel P/E 核心）
+    int numaNode = -1;           // 限制在該 NUMA 節點的核心（-1 = 不限制）
+
+    QJsonObject toJson() const;
+    static ThreadSchedulingConfig fromJson(const QJsonObject& json, const ThreadSchedulingConfig& defaults);
+};
+
+/**
+ * @brief 管線線程排程配置（綁核、優先權、異質核心 / NUMA 提示）
+ *
+ * 各線程啟動時依角色套用，實際結果（允許核心、優先權、目前所在 CPU）寫入日誌。
+ * 多相機的 grabCore / detectionCore 與 controlThreadCore 指定單一核心時優先於此處的 affinity。
+ */
+struct SchedulingConfig {
+    bool enabled = true;  // false = 全部線程維持作業系統預設排程
+
+    ThreadSchedulingConfig grab{"", "high"};         // 相機抓取 / 影片解碼
+    ThreadSchedulingConfig detection;                // 檢測管線
+    ThreadSchedulingConfig inference;                // YOLO 非同步推理
+    ThreadSchedulingConfig recording;                // 錄影寫檔 / 事件錄影
+    ThreadSchedulingConfig control{"", "realtime"};  // 震動機控制迴圈 / Modbus 通訊
+    ThreadSchedulingConfig ui;                       // 主線程（事件循環）
+
+    QJsonObject toJson() const;
+    static SchedulingConfig fromJson(const QJsonObject& json);
+};
+
 /**
  * @brief YOLO 深度學習偵測配置
  */
@@ -157,18 +302,67 @@ struct YoloConfig {
     double roiUpscaleFactor = 2.0;        // ROI 放大倍數（小零件增強）
     int inputSize = 640;                  // 模型輸入尺寸
     bool enabled = false;                 // 是否啟用 YOLO 模式
+    bool asyncInference = true;           // 推理線程非同步執行（前處理與 forward 重疊）
+    int batchSize = 4;                    // 推理線程忙碌時，每次 forward 最多合併的幀數
+    QString backend = "opencv";           // 推理後端: opencv / onnxruntime / openvino
+    QString device = "auto";              // 裝置提示: auto / cpu / cuda / tensorrt / gpu
+    bool tiledInference = false;          // ROI 條帶切成方形 tile 批次推理（取代整條 letterbox）
+    int tileOverlap = 32;                 // 相鄰 tile 重疊寬度（ROI 像素）
 
     QJsonObject toJson() const;
     static YoloConfig fromJson(const QJsonObject& json);
 };
 
 /**
- * @brief 調試配置
+ * @brief 錄影配置
+ *
+ * 編碼在 VideoRecorder 的專用線程執行；呼叫端只把幀放進有界佇列。
+ */
+struct RecordingConfig {
+    // 編碼佇列容量（幀）：吸收編碼器的延遲尖峰
+    int queueFrames = 64;
+
+    // 佇列滿時：false = 丟棄新幀（呼叫端不等待）；true = 等待空位，最多 blockTimeoutMs 後仍丟棄
+    bool blockWhenFull = false;
+    int blockTimeoutMs = 20;
+
+    // 進度信號（recordingProgress）的最短間隔
+    int progressIntervalMs = 250;
+
+    // 錄製格式："video" = 編碼檔（mp4/avi）；"raw" = 無損原始擷取（*.rawcap 目錄）
+    QString format = "video";
+
+    // 編碼後端：auto / qsv / vaapi / nvenc / videotoolbox / software
+    // 指定的硬體後端無法開啟時（OpenCV 未編入或無對應硬體）自動退回軟體編碼器
+    QString encoderBackend = "auto";
+    int rawSegmentMegabytes = 1024; // 原始擷取單一分段檔大小
+
+    // 錄製帶檢測疊加的畫面（僅 video 格式；在錄影線程以最近的檢測結果燒入，單通道來源改以彩色編碼）
+    bool burnInOverlay = false;
+
+    QJsonObject toJson() const;
+    static RecordingConfig fromJson(const QJsonObject& json);
+};
+
+/**
+ * @brief 調試配置（事件觸發錄影）
+ *
+ * 記憶體中以 JPEG 保留最近 preTriggerSeconds 秒的幀；事件發生時把這段連同之後
+ * postTriggerSeconds 秒寫成一個片段（經 VideoRecorder 的錄影線程）。
  */
 struct DebugConfig {
-    bool debugSaveEnabled = false;
-    QString debugSaveDir = "recordings/debug";
-    int maxDebugFrames = 100;
+    bool eventRecordingEnabled = false;
+    QString eventRecordingDir = "recordings/events";
+    double preTriggerSeconds = 5.0;
+    double postTriggerSeconds = 3.0;
+    int jpegQuality = 80;            // 預觸發緩衝的壓縮品質
+    int maxBufferMegabytes = 256;    // 預觸發緩衝上限（先到者為準）
+
+    // 觸發條件
+    int gateBurstCount = 5;          // gateBurstWindowMs 內穿越光柵達此數即觸發（0 = 停用）
+    int gateBurstWindowMs = 500;
+    bool triggerOnPackagingMismatch = true; // 包裝完成時計數 != 目標
+    bool triggerOnQualityDegrade = true;    // 品質調節降級
 
     QJsonObject toJson() const;
     static DebugConfig fromJson(const QJsonObject& json);
@@ -191,6 +385,9 @@ struct UIConfig {
     int bgVarThresholdRangeMax = 20;
     int bgVarThresholdDefault = 3;
 
+    // 視頻顯示走 GPU 紋理路徑（需編譯時有 OpenGL 支援；初始化失敗自動退回 CPU 繪製）
+    bool gpuDisplay = true;
+
     QJsonObject toJson() const;
     static UIConfig fromJson(const QJsonObject& json);
 };
@@ -209,6 +406,23 @@ struct DetectionMethodConfig {
     static DetectionMethodConfig fromJson(const QJsonObject& json);
 };
 
+/**
+ * @brief 單一料道的 ROI 與包裝目標（寬輸送帶上同一幀的多條料道）
+ *
+ * 座標為處理解析度（targetProcessingWidth 縮放後）下的像素，與 DetectionConfig::roiX / roiWidth 相同；
+ * ROI 高度與垂直位置沿用 DetectionConfig。
+ */
+struct LaneConfig {
+    QString name;
+    int roiX = 0;
+    int roiWidth = 0;                    // 0 = 延伸到幀右緣
+    int targetCount = 0;                 // 0 = 使用 PackagingConfig::targetCount
+    double gateLinePositionRatio = -1.0; // < 0 = 使用 GateConfig::gateLinePositionRatio
+
+    QJsonObject toJson() const;
+    static LaneConfig fromJson(const QJsonObject& json);
+};
+
 /**
  * @brief 零件配置檔
  */
@@ -225,6 +439,9 @@ struct PartProfile {
     std::vector<DetectionMethodConfig> availableMethods;
     QString currentMethodId = "counting";
 
+    // 多料道計數：非空時每條料道獨立背景模型 / 追蹤 / 光柵 / 包裝目標，取代單一 ROI
+    std::vector<LaneConfig> lanes;
+
     QJsonObject toJson() const;
     static PartProfile fromJson(const QJsonObject& json);
 };
@@ -242,10 +459,64 @@ struct CameraConfig {
     // 曝光時間（微秒）
     double exposureTimeUs = 1000.0;
 
+    // 零拷貝抓取：Pylon 緩衝直接包裝成 cv::Mat 放進 FrameRing，生產者端不做 memcpy
+    bool zeroCopyGrab = true;
+
+    // Pylon 抓取緩衝數（MaxNumBuffer）；零拷貝時會自動加大到 FrameRing 容量 + 餘量
+    int grabBufferCount = 10;
+
+    // 無損計數模式：GrabStrategy_OneByOne，檢測依序處理每一幀（跟不上時由 Pylon 緩衝排隊，不丟幀）
+    bool losslessCounting = false;
+
+    // 無損模式的 Pylon 排隊緩衝數（決定可吸收的檢測延遲尖峰長度）
+    int losslessBufferCount = 64;
+
+    // 啟動時重新連接上次使用的相機（序號與 GigE IP 快取於使用者偏好，跳過完整列舉）
+    bool autoConnectLastCamera = true;
+
+    // 感測器 AOI：相機只讀出檢測 ROI（外加餘量）的區域以提高幀率；ROI 變更時重新套用
+    // 檢測座標以完整感測器為基準，每幀的 AOI 位置記在 FrameMeta::window
+    bool sensorAoi = false;
+    int sensorAoiMarginRows = 32;  // ROI 上下各保留的感測器列數
+    int sensorAoiMarginCols = 0;   // ROI 左右各保留的感測器行數
+    bool sensorAoiCropWidth = false; // 是否同時裁切寬度（GigE 頻寬受限時有幫助；幀率通常取決於列數）
+    int sensorBinning = 1;         // 垂直 / 水平 binning 倍率（1 = 關閉；相機不支援時忽略）
+
     QJsonObject toJson() const;
     static CameraConfig fromJson(const QJsonObject& json);
 };
 
+/**
+ * @brief 多相機管線中單一相機的配置
+ */
+struct CameraPipelineConfig {
+    QString serial;         // 相機序號（優先；空 = 使用 cameraIndex）
+    int cameraIndex = -1;   // detectCameras() 的索引
+    QString source;         // 非空時改播放影片 / *.synth.json（無相機時驗證用）
+    int lane = 0;           // 所屬料道（DualVibratorManager 的震動機 0 / 1）
+    int grabCore = -1;      // 抓取線程綁定核心（-1 = 自動分配或不綁定）
+    int detectionCore = -1; // 檢測線程綁定核心
+
+    QJsonObject toJson() const;
+    static CameraPipelineConfig fromJson(const QJsonObject& json);
+};
+
+/**
+ * @brief 多相機配置（每台相機一條 SourceManager / DetectionController 管線）
+ */
+struct MultiCameraConfig {
+    std::vector<CameraPipelineConfig> cameras;
+
+    // 共用 YOLO 推理池的實例數（1 = 所有相機排隊共用一個模型）
+    int inferenceWorkers = 1;
+
+    // 未指定核心的線程依序分配（從核心 1 開始，核心 0 留給主線程）；false 則不綁定
+    bool autoAssignCores = true;
+
+    QJsonObject toJson() const;
+    static MultiCameraConfig fromJson(const QJsonObject& json);
+};
+
 /**
  * @brief 應用程序總配置
  *
@@ -265,6 +536,9 @@ public:
     CameraConfig& camera() { return m_camera; }
     const CameraConfig& camera() const { return m_camera; }
 
+    MultiCameraConfig& multiCamera() { return m_multiCamera; }
+    const MultiCameraConfig& multiCamera() const { return m_multiCamera; }
+
     DetectionConfig& detection() { return m_detection; }
     const DetectionConfig& detection() const { return m_detection; }
 
@@ -274,9 +548,21 @@ public:
     PackagingConfig& packaging() { return m_packaging; }
     const PackagingConfig& packaging() const { return m_packaging; }
 
+    VibratorConfig& vibrator() { return m_vibrator; }
+    const VibratorConfig& vibrator() const { return m_vibrator; }
+
     PerformanceConfig& performance() { return m_performance; }
     const PerformanceConfig& performance() const { return m_performance; }
 
+    TelemetryConfig& telemetry() { return m_telemetry; }
+    const TelemetryConfig& telemetry() const { return m_telemetry; }
+
+    SchedulingConfig& scheduling() { return m_scheduling; }
+    const SchedulingConfig& scheduling() const { return m_scheduling; }
+
+    RecordingConfig& recording() { return m_recording; }
+    const RecordingConfig& recording() const { return m_recording; }
+
     DebugConfig& debug() { return m_debug; }
     const DebugConfig& debug() const { return m_debug; }
 
@@ -318,10 +604,15 @@ private:
     void initDefaultPartProfiles();
 
     CameraConfig m_camera;
+    MultiCameraConfig m_multiCamera;
     DetectionConfig m_detection;
     GateConfig m_gate;
     PackagingConfig m_packaging;
+    VibratorConfig m_vibrator;
     PerformanceConfig m_performance;
+    TelemetryConfig m_telemetry;
+    SchedulingConfig m_scheduling;
+    RecordingConfig m_recording;
     DebugConfig m_debug;
     UIConfig m_ui;
     YoloConfig m_yolo;
@@ -0,0 +1,84 @@
+#ifndef ASSIGNMENT_SOLVER_H
+#define ASSIGNMENT_SOLVER_H
+
+#include <utility>
+#include <vector>
+
+namespace basler
+{
+
+    /**
+     * @brief 追蹤-偵測候選配對（只收錄通過匹配閾值的組合）
+     */
+    struct AssignmentCandidate
+    {
+        int track;    // 追蹤槽位
+        int object;   // 偵測索引
+        double score; // calculateMatchScore 評分（越高越好）
+    };
+
+    /**
+     * @brief 稀疏全域最佳指派（Hungarian）
+     *
+     * 取代「每個偵測各挑最佳追蹤、再依分數貪婪套用」在密集零件時的 ID 交換：
+     * 1. 候選配對以聯集-查找拆成連通分量，各分量獨立求總分最大的指派
+     * 2. 分量邊長不超過 MAX_DENSE_SIZE 時用 Hungarian（O(n³)），否則該分量用貪婪
+     * 3. 每幀時間預算用完後，剩餘分量全部改用貪婪（依分數由高到低，兩端都未使用才配對）
+     * 4. 工作緩衝重用，穩態不配置記憶體
+     */
+    class AssignmentSolver
+    {
+    public:
+        static constexpr int MAX_DENSE_SIZE = 64;
+
+        struct Stats
+        {
+            int optimalComponents = 0; // 以 Hungarian 求解的分量數
+            int greedyComponents = 0;  // 以貪婪求解的分量數（過大或超出預算）
+            bool budgetExceeded = false;
+            double elapsedMs = 0.0;
+        };
+
+        /**
+         * @brief 求解一幀的指派
+         * @param[in,out] candidates 候選配對（會被重新排序）
+         * @param trackCount 追蹤槽位範圍 [0, trackCount)
+         * @param objectCount 偵測索引範圍 [0, objectCount)
+         * @param budgetMs 時間預算（毫秒，<= 0 不限制）
+         * @param[out] assignments 配對結果 (track, object)
+         */
+        Stats solve(std::vector<AssignmentCandidate> &candidates, int trackCount, int objectCount,
+                    double budgetMs, std::vector<std::pair<int, int>> &assignments);
+
+    private:
+        int findRoot(int node);
+        void solveGreedy(const AssignmentCandidate *begin, const AssignmentCandidate *end,
+                         std::vector<std::pair<int, int>> &assignments);
+        void solveHungarian(const AssignmentCandidate *begin, const AssignmentCandidate *end,
+                            int rows, int cols, bool transposed,
+                            std::vector<std::pair<int, int>> &assignments);
+
+        // 聯集-查找（節點：追蹤 [0, T)，偵測 [T, T+O)）
+        int m_trackCount = 0;
+        std::vector<int> m_parent;
+        std::vector<int> m_componentOf; // 候選所屬分量（排序鍵）
+        std::vector<int> m_order;
+
+        // 分量內局部編號與反查表
+        std::vector<int> m_localIndex;
+        std::vector<int> m_rowNodes;
+        std::vector<int> m_colNodes;
+        std::vector<char> m_used;
+
+        // Hungarian 工作緩衝（1-based）
+        std::vector<double> m_cost;
+        std::vector<double> m_u, m_v, m_minv;
+        std::vector<int> m_match, m_way;
+        std::vector<char> m_visited;
+
+        std::vector<AssignmentCandidate> m_sorted;
+    };
+
+} // namespace basler
+
+#endif // ASSIGNMENT_SOLVER_H
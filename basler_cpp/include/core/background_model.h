@@ -0,0 +1,94 @@
+#ifndef BACKGROUND_MODEL_H
+#define BACKGROUND_MODEL_H
+
+#include <opencv2/core.hpp>
+#include <opencv2/video/background_segm.hpp>
+#include <string>
+#include <vector>
+
+namespace basler
+{
+
+    /**
+     * @brief 背景模型引擎
+     */
+    enum class BackgroundEngine
+    {
+        MOG2,    // cv::BackgroundSubtractorMOG2（高斯混合，支援陰影）
+        Gaussian // GaussianBackgroundSubtractor（單高斯定點 SIMD，mono8 固定背景）
+    };
+
+    /**
+     * @brief 依設定字串選擇引擎（"gaussian"，其餘為 MOG2）
+     */
+    BackgroundEngine backgroundEngineFromName(const std::string &name);
+
+    const char *backgroundEngineName(BackgroundEngine engine);
+
+    /**
+     * @brief 分帶背景減除（每個水平帶一個背景模型實例，平行執行）
+     *
+     * 兩種引擎都逐像素獨立（模型狀態、陰影判斷都只看自身像素），
+     * 因此把 ROI 切成 N 個水平帶、各自持有模型，輸出與單一實例完全一致：
+     * - 各帶直接寫入同一張前景遮罩的列範圍（不複製、不拼接）
+     * - 後續形態學在完整遮罩上執行，帶間不需重疊也不會產生接縫
+     * - 各帶以 cv::parallel_for_ 分派；帶數 1 時等同原本的單一 apply()
+     *
+     * 帶高不足 MIN_BAND_ROWS 時自動減少帶數；ROI 尺寸改變時重新分帶（模型隨之重建，
+     * 與單一 MOG2 遇到尺寸改變時的行為相同）。
+     * 非線程安全：由 DetectionController 的管線鎖保護。
+     */
+    class BackgroundModel
+    {
+    public:
+        static constexpr int MIN_BAND_ROWS = 16;
+
+        /**
+         * @brief 設定參數並捨棄已學習的背景（模型於下一次 apply() 建立）
+         * @param bands 期望帶數（<= 1 為單一實例）
+         */
+        void reset(BackgroundEngine engine, int history, double varThreshold, bool detectShadows, int bands);
+
+        /**
+         * @brief 更新背景並輸出前景遮罩（CV_8UC1；陰影為 127）
+         */
+        void apply(const cv::Mat &image, cv::Mat &fgMask, double learningRate);
+
+        /**
+         * @brief 裝置版（OpenCL T-API）：影像與遮罩留在裝置上
+         *
+         * MOG2 以單一實例執行 OpenCL 核心（不分帶，核心本身已平行處理整個 ROI）；
+         * 單高斯引擎沒有 OpenCL 實作，改在主機端更新後上傳遮罩。
+         * 與主機版切換時模型重建（模型狀態分別存放於主機 / 裝置記憶體）。
+         */
+        void apply(const cv::UMat &image, cv::UMat &fgMask, double learningRate);
+
+        void release();
+
+        int bandCount() const { return static_cast<int>(m_bands.size()); }
+        BackgroundEngine engine() const { return m_engine; }
+
+    private:
+        struct Band
+        {
+            cv::Ptr<cv::BackgroundSubtractor> subtractor;
+            int rowBegin = 0;
+            int rowEnd = 0;
+        };
+
+        void layoutBands(int rows, int maxBands);
+        cv::Ptr<cv::BackgroundSubtractor> createSubtractor() const;
+
+        std::vector<Band> m_bands;
+        BackgroundEngine m_engine = BackgroundEngine::MOG2;
+        int m_history = 500;
+        double m_varThreshold = 16.0;
+        bool m_detectShadows = false;
+        int m_requestedBands = 1;
+        cv::Size m_size; // 目前分帶依據的影像尺寸
+        bool m_onDevice = false; // 目前模型建立於裝置版 apply()
+    };
+
+} // namespace basler
+
+#endif // BACKGROUND_MODEL_H
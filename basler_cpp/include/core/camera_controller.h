@@ -7,9 +7,12 @@
 #include <QWaitCondition>
 #include <QElapsedTimer>
 #include <QImage>
+#include <QRect>
+#include <QSize>
 #include <atomic>
 #include <memory>
 #include <deque>
+#include <functional>
 
 #ifndef NO_PYLON_SDK
 #include <pylon/PylonIncludes.h>
@@ -19,6 +22,8 @@
 namespace basler
 {
 
+    class FrameRing;
+
     /**
      * @brief 相機資訊結構
      */
@@ -28,6 +33,7 @@ namespace basler
         QString model;
         QString serial;
         QString friendlyName;
+        QString ipAddress;  // GigE 相機目前的 IP（USB 相機為空）
         bool isTargetModel; // acA640-300gm
     };
 
@@ -55,7 +61,7 @@ namespace basler
  * @brief 圖像抓取工作線程
  *
  * 獨立於主線程運行，避免 UI 阻塞。
- * 使用 Qt 信號槽機制安全地將數據傳回主線程。
+ * 幀數據直接寫入 FrameRing，信號只攜帶序號與時間戳通知主線程。
  */
 #ifndef NO_PYLON_SDK
     class GrabWorker : public QObject
@@ -63,21 +69,52 @@ namespace basler
         Q_OBJECT
 
     public:
-        explicit GrabWorker(Pylon::CInstantCamera *camera, QObject *parent = nullptr);
+        explicit GrabWorker(Pylon::CInstantCamera *camera, FrameRing *ring, QObject *parent = nullptr);
         ~GrabWorker();
 
+        // 目前曝光時間（寫進每幀的 FrameMeta，任意線程）
+        void setExposureUs(double exposureUs) { m_exposureUs.store(static_cast<float>(exposureUs)); }
+
+        // 完整感測器尺寸（連同每幀的 AOI 原點寫進 FrameMeta::window；抓取開始前設定）
+        void setSensorSize(int width, int height)
+        {
+            m_sensorWidth = width;
+            m_sensorHeight = height;
+        }
+
     public slots:
         void startGrabbing();
         void stopGrabbing();
 
     signals:
-        void frameGrabbed(const cv::Mat &frame, qint64 timestamp);
+        void frameGrabbed(quint64 sequence, qint64 timestamp);
+        void blockGap(quint64 missed, quint64 blockId); // 區塊 ID 不連續（相機端已送出但未收到的幀）
         void grabError(const QString &error);
         void grabStopped();
 
     private:
+        /**
+         * @brief 依 CameraConfig 設定 MaxNumBuffer、抓取策略與零拷貝 / 複製模式
+         */
+        void configureBuffers();
+
+        /**
+         * @brief 檢查區塊 ID 連續性，有缺口時發出 blockGap
+         */
+        void trackBlockId(quint64 blockId);
+
+        // 零拷貝時 FrameRing 容量之外額外保留的 Pylon 緩衝數
+        static constexpr int ZERO_COPY_BUFFER_HEADROOM = 8;
+
         Pylon::CInstantCamera *m_camera;
+        FrameRing *m_ring;
         std::atomic<bool> m_running{false};
+        bool m_zeroCopy = false;  // 只在抓取線程存取
+        bool m_lossless = false;  // 只在抓取線程存取
+        quint64 m_lastBlockId = 0;
+        std::atomic<float> m_exposureUs{0.0f};
+        int m_sensorWidth = 0;
+        int m_sensorHeight = 0;
         QMutex m_mutex;
     };
 #else
@@ -87,15 +124,20 @@ namespace basler
         Q_OBJECT
 
     public:
-        explicit GrabWorker(void *camera = nullptr, QObject *parent = nullptr) : QObject(parent) { Q_UNUSED(camera); }
+        explicit GrabWorker(void *camera = nullptr, FrameRing *ring = nullptr, QObject *parent = nullptr)
+            : QObject(parent) { Q_UNUSED(camera); Q_UNUSED(ring); }
         ~GrabWorker() = default;
 
+        void setExposureUs(double exposureUs) { Q_UNUSED(exposureUs); }
+        void setSensorSize(int width, int height) { Q_UNUSED(width); Q_UNUSED(height); }
+
     public slots:
         void startGrabbing() {}
         void stopGrabbing() {}
 
     signals:
-        void frameGrabbed(const cv::Mat &frame, qint64 timestamp);
+        void frameGrabbed(quint64 sequence, qint64 timestamp);
+        void blockGap(quint64 missed, quint64 blockId);
         void grabError(const QString &error);
         void grabStopped();
 
@@ -134,6 +176,7 @@ namespace basler
         bool isGrabbing() const;
         double fps() const { return m_currentFps; }
         qint64 totalFrames() const { return m_totalFrames; }
+        quint64 missedFrames() const { return m_missedFrames.load(); } // 區塊 ID 缺口累計（本次抓取）
 
         // ===== 相機操作（全部異步，不阻塞 UI）=====
         /**
@@ -153,6 +196,38 @@ namespace basler
          */
         QList<CameraInfo> detectCamerasWithRetry(int maxRetries = 3, int delayMs = 2000);
 
+        /**
+         * @brief 在背景線程執行 detectCamerasWithRetry，完成後發出 camerasDetected()
+         *
+         * 啟動流程與 UI 掃描按鈕使用，列舉與重試等待都不阻塞 UI。
+         */
+        void detectCamerasAsync(int maxRetries = 3, int delayMs = 2000);
+
+        // ===== 幀環形緩衝 =====
+        /**
+         * @brief 指定抓取幀寫入的環形緩衝（需在 startGrabbing 前設定）
+         * @param ring 外部擁有的緩衝；nullptr 則恢復使用內建緩衝
+         */
+        void setFrameRing(FrameRing *ring);
+        FrameRing *frameRing() const { return m_frameRing; }
+
+        /**
+         * @brief 抓取線程綁定的邏輯核心（下一次 startGrabbing 生效；< 0 = 不綁定）
+         */
+        void setGrabThreadCore(int core) { m_grabCore = core; }
+        int grabThreadCore() const { return m_grabCore; }
+
+        // ===== 感測器 AOI =====
+        /**
+         * @brief 完整感測器尺寸（已計入 binning；連線後有效，未連線時為空）
+         */
+        QSize sensorSize() const { return QSize(m_sensorWidth, m_sensorHeight); }
+
+        /**
+         * @brief 相機目前讀出的 AOI（感測器像素；未裁切時為完整感測器）
+         */
+        QRect sensorAoi() const { return m_currentAoi; }
+
     public slots:
         /**
          * @brief 異步連接相機
@@ -162,6 +237,16 @@ namespace basler
          */
         void connectCamera(int cameraIndex = 0);
 
+        /**
+         * @brief 異步連接指定序號的相機（重新連接上次使用的相機）
+         * @param serial 相機序號
+         * @param ipAddress 上次連線時的 IP（GigE；非空時先以 IP 直接建立裝置，跳過完整列舉）
+         *
+         * IP 無法連接或序號不符時退回完整列舉並依序號尋找；
+         * 操作完成後發出 connected() 或 connectionError() 信號
+         */
+        void connectCameraBySerial(const QString &serial, const QString &ipAddress = QString());
+
         /**
          * @brief 異步斷開相機
          *
@@ -189,6 +274,16 @@ namespace basler
          */
         void setExposure(double exposureUs);
 
+        /**
+         * @brief 依檢測 ROI 設定相機讀出的 AOI（CameraConfig::sensorAoi 啟用時）
+         * @param roi ROI 在感測器上的位置（感測器像素；空 = 完整感測器）
+         *
+         * 外加 sensorAoiMarginRows / Cols 餘量並對齊相機的步進限制。抓取中只有原點改變且
+         * Offset 可即時寫入時直接套用，否則停止抓取、套用後重新開始。
+         * 未啟用 sensorAoi 時恢復完整感測器。完成後發出 sensorAoiChanged()
+         */
+        void setSensorAoi(const QRect &roi);
+
     signals:
         // ===== 狀態信號 =====
         void stateChanged(CameraState newState);
@@ -200,15 +295,21 @@ namespace basler
         void grabbingStopped();
 
         // ===== 數據信號 =====
-        void frameReady(const cv::Mat &frame); // 新幀可用
+        void frameReady(quint64 sequence);     // 新幀已寫入 FrameRing
         void fpsUpdated(double fps);           // FPS 更新
+        void framesMissed(quint64 missed, quint64 totalMissed); // 區塊 ID 缺口（計數可能漏算）
+        void sensorAoiChanged(const QRect &aoi);   // 相機讀出的 AOI 已改變（感測器像素）
+
+        // ===== 列舉結果（detectCamerasAsync）=====
+        void camerasDetected(const QList<CameraInfo> &cameras);
 
         // ===== 錯誤信號 =====
         void connectionError(const QString &error);
         void grabError(const QString &error);
 
     private slots:
-        void onFrameGrabbed(const cv::Mat &frame, qint64 timestamp);
+        void onFrameGrabbed(quint64 sequence, qint64 timestamp);
+        void onBlockGap(quint64 missed, quint64 blockId);
         void onGrabError(const QString &error);
         void onGrabStopped();
 
@@ -220,6 +321,16 @@ namespace basler
         // 相機配置
         void configureCamera();
 
+        // 感測器 AOI：依要求的 ROI 計算對齊後的 AOI，並寫入相機（live = 抓取中只改原點）
+        QRect targetSensorAoi() const;
+        bool applySensorAoi(const QRect &aoi, bool live);
+
+#ifndef NO_PYLON_SDK
+        // 在背景線程建立裝置並填入相機資訊（失敗時拋出例外），其餘連線流程共用
+        using DeviceFactory = std::function<Pylon::IPylonDevice *(Pylon::CTlFactory &, CameraInfo &)>;
+        void connectDevice(const DeviceFactory &createDevice);
+#endif
+
         // 資源
 #ifndef NO_PYLON_SDK
         std::unique_ptr<Pylon::CInstantCamera> m_camera;
@@ -228,18 +339,31 @@ namespace basler
 #endif
         std::unique_ptr<QThread> m_grabThread;
         std::unique_ptr<GrabWorker> m_grabWorker;
+        int m_grabCore = -1;
+
+        // 幀環形緩衝（預設使用內建緩衝，SourceManager 會換成共用緩衝）
+        std::unique_ptr<FrameRing> m_ownedRing;
+        FrameRing *m_frameRing = nullptr;
 
         // 狀態（原子操作保證線程安全）
         std::atomic<CameraState> m_state{CameraState::Disconnected};
 
         // 性能統計
         std::atomic<qint64> m_totalFrames{0};
+        std::atomic<quint64> m_missedFrames{0};
         std::atomic<double> m_currentFps{0.0};
         std::deque<qint64> m_frameTimes;
         QMutex m_statsMutex;
 
         double m_exposureTime = 1000.0; // 微秒（runtime 可由 setExposure 覆蓋）
 
+        // 感測器 AOI（只在主線程存取；configureCamera 在連線完成前重置）
+        int m_sensorWidth = 0;
+        int m_sensorHeight = 0;
+        QRect m_requestedAoi;            // 最近一次要求的 ROI（空 = 完整感測器）
+        QRect m_currentAoi;              // 相機目前讀出的 AOI
+        bool m_aoiRestartPending = false; // 抓取中需改變 AOI 尺寸：停止後套用並重新開始
+
 #ifndef NO_PYLON_SDK
         // Pylon 初始化（全局單例）
         static Pylon::PylonAutoInitTerm s_pylonInit;
@@ -0,0 +1,92 @@
+#ifndef DEBUG_TAP_H
+#define DEBUG_TAP_H
+
+#include <QMutex>
+#include <QtGlobal>
+#include <atomic>
+#include <opencv2/core.hpp>
+
+namespace basler
+{
+
+    /**
+     * @brief 檢測管線中間幀（調試視圖用）
+     */
+    struct DebugFrames
+    {
+        cv::Mat fgMask;        // 背景減除後清理遮罩（fgCleaned）
+        cv::Mat cannyEdges;    // Canny 邊緣（sensitiveEdges）
+        cv::Mat combined;      // 三重聯合結果
+        cv::Mat finalMask;     // 最終形態學結果（送進 detectObjects 的遮罩）
+        int frameNumber = 0;   // 擷取時的 totalProcessedFrames
+    };
+
+    /**
+     * @brief 調試中間幀訂閱點
+     *
+     * 取代每幀四次 clone + getter 再 clone 的做法：
+     * 1. 沒有訂閱者時檢測線程完全不複製中間幀
+     * 2. 有訂閱者時，只在 UI 取走上一份之後才擷取下一份，擷取頻率自動跟隨顯示頻率
+     * 3. 雙緩衝：檢測線程寫 back 槽，publish() 與 ready 槽交換；UI 以 take() 交換取走，
+     *    三份緩衝循環使用，尺寸不變時不重新配置
+     * 4. 交還的緩衝若仍有外部 cv::Mat 引用（UI 保留的淺拷貝），beginCapture() 會放棄重用，
+     *    改為重新配置，不會覆寫 UI 仍在顯示的像素
+     */
+    class DebugTap
+    {
+    public:
+        DebugTap() = default;
+
+        // 禁止複製
+        DebugTap(const DebugTap &) = delete;
+        DebugTap &operator=(const DebugTap &) = delete;
+
+        // ===== 訂閱（UI 線程）=====
+        void subscribe();
+        void unsubscribe();
+        bool isActive() const { return m_subscribers.load(std::memory_order_relaxed) > 0; }
+
+        /**
+         * @brief 取走最新一份中間幀（與 frames 交換，不複製）
+         * @param[in,out] frames 呼叫端持有的緩衝；舊內容交還給 DebugTap 重用
+         * @return 是否有新的一份
+         *
+         * 交還的緩衝只在沒有其他引用時才會被檢測線程覆寫；呼叫端保留的淺拷貝維持原內容。
+         */
+        bool take(DebugFrames &frames);
+
+        // ===== 擷取（檢測線程）=====
+        /**
+         * @brief 本幀是否需要擷取（有訂閱者，且上一份已被取走）
+         */
+        bool wantsCapture() const;
+
+        /**
+         * @brief 開始擷取一份：back 槽中仍被外部引用的 cv::Mat 先釋放（之後的 copyTo 重新配置）
+         */
+        void beginCapture();
+
+        /**
+         * @brief 檢測線程寫入用的緩衝（只在 wantsCapture() 為 true 的幀內、beginCapture() 之後使用）
+         */
+        DebugFrames &backBuffer() { return m_back; }
+
+        /**
+         * @brief 將 back 槽發布為最新一份
+         */
+        void publish();
+
+    private:
+        std::atomic<int> m_subscribers{0};
+        std::atomic<bool> m_pending{false}; // ready 槽有尚未取走的一份
+
+        DebugFrames m_back;  // 只由檢測線程存取
+        DebugFrames m_ready; // m_swapMutex 保護
+
+        // 只保護槽位交換（交換 cv::Mat 標頭，不複製像素）
+        QMutex m_swapMutex;
+    };
+
+} // namespace basler
+
+#endif // DEBUG_TAP_H
@@ -7,12 +7,29 @@
 #include <QRect>
 #include <opencv2/core.hpp>
 #include <opencv2/video/background_segm.hpp>
+#include <array>
 #include <memory>
 #include <vector>
-#include <map>
+#include <atomic>
+#include <thread>
+#include <tuple>
+#include <utility>
+
+#include "core/assignment_solver.h"
+#include "core/background_model.h"
+#include "core/blob_extractor.h"
+#include "core/debug_tap.h"
+#include "core/detection_params.h"
+#include "core/flow_rate_estimator.h"
+#include "core/frame_overlay.h"
+#include "core/frame_ring.h"
+#include "core/quality_governor.h"
+#include "core/spatial_grid.h"
+#include "core/stage_profiler.h"
+#include "core/track_table.h"
 
 // 前向聲明 YoloDetector
-namespace basler { class YoloDetector; }
+namespace basler { class YoloDetector; class YoloInferencePool; struct YoloFrameResult; struct LaneConfig; class VibratorControlLoop; }
 
 namespace basler
 {
@@ -43,30 +60,6 @@ namespace basler
         QPoint center() const { return QPoint(cx, cy); }
     };
 
-    /**
-     * @brief 物件追蹤結構 - 增強型多特徵追蹤
-     */
-    struct ObjectTrack
-    {
-        int trackId;     // 追蹤 ID
-        int x, y;        // 當前位置
-        int w, h;        // 當前寬高
-        int area;        // 當前面積
-        int firstFrame;  // 首次出現幀
-        int lastFrame;   // 最後出現幀
-        int inRoiFrames; // 在 ROI 中的幀數
-        int maxY, minY;  // Y 軸移動範圍
-        int firstY;      // 首次出現的 Y 位置（用於方向驗證）
-        bool counted;    // 是否已計數
-
-        // 增強追蹤特徵
-        std::vector<std::pair<int, int>> positions; // 位置歷史
-        std::vector<int> areaHistory;               // 面積歷史
-        double velocityX, velocityY;                // 速度（用於預測）
-        double predictedX, predictedY;              // 預測位置
-        int missedFrames;                           // 連續未匹配幀數
-    };
-
     /**
      * @brief 震動機速度枚舉
      */
@@ -92,6 +85,18 @@ namespace basler
         bool completed = false;
     };
 
+    /**
+     * @brief 依包裝進度決定震動機速度（未達目標時；達標由呼叫端改為 STOP）
+     * @param count 目前計數
+     * @param target 目標數量
+     * @param advanceStopCount 提前停止數（有效目標 = target - advanceStopCount）
+     * @param fullThreshold 進度達此值降為 MEDIUM
+     * @param mediumThreshold 進度達此值降為 SLOW
+     * @param slowThreshold 進度達此值降為 CREEP
+     */
+    VibratorSpeed packagingSpeedFor(int count, int target, int advanceStopCount,
+                                    double fullThreshold, double mediumThreshold, double slowThreshold);
+
     /**
      * @brief 小零件檢測控制器 - 背景減除 + 虛擬光柵計數
      *
@@ -110,6 +115,12 @@ namespace basler
 
     public:
         explicit DetectionController(QObject *parent = nullptr);
+
+        /**
+         * @brief 使用共用 YOLO 推理池（多相機管線），不建立自己的 YoloDetector
+         * @param sharedYolo 外部擁有的推理池，生命週期需長於本控制器；YOLO 改走同步推理
+         */
+        explicit DetectionController(YoloInferencePool *sharedYolo, QObject *parent = nullptr);
         ~DetectionController();
 
         // 禁止複製
@@ -118,44 +129,88 @@ namespace basler
 
         // ===== 狀態查詢 =====
         bool isEnabled() const { return m_enabled; }
-        int count() const { return m_crossingCounter; }
+        int count() const { return m_crossingCounter.load(std::memory_order_relaxed); }
         int totalProcessedFrames() const { return m_totalProcessedFrames; }
+        int gateLineY() const { QMutexLocker locker(&m_mutex); return m_gateLineY; } // 原始解析度座標（最近一幀）
         DetectionMode detectionMode() const { return m_detectionMode; }
         bool isYoloModelLoaded() const;
+        bool isYoloModelLoading() const { return m_yoloLoading.load(); }
 
-        // 調試用：取得最後一次 standardProcessing 的中間幀
-        cv::Mat lastDebugFrame() const
-        {
-            QMutexLocker locker(&m_mutex);
-            return m_lastDebugFrame.clone();
-        }
-        cv::Mat lastFgMask() const
-        {
-            QMutexLocker locker(&m_mutex);
-            return m_lastFgMask.clone();
-        }
-        cv::Mat lastCannyEdges() const
-        {
-            QMutexLocker locker(&m_mutex);
-            return m_lastCannyEdges.clone();
-        }
-        cv::Mat lastCombined() const
-        {
-            QMutexLocker locker(&m_mutex);
-            return m_lastCombined.clone();
-        }
+        // 追蹤匹配指標（檢測線程寫入，任意線程讀取）
+        double lastMatcherLatencyMs() const { return m_lastMatcherLatencyMs.load(std::memory_order_relaxed); }
+        quint64 assignmentBudgetExceededFrames() const { return m_assignmentBudgetExceeded.load(std::memory_order_relaxed); }
+
+        // 調試用：standardProcessing 中間幀訂閱點（UI 訂閱後以 take() 取用）
+        DebugTap &debugTap() { return m_debugTap; }
+
+        // 逐階段延遲統計（常駐；每 stageProfilingIntervalMs 以 stageLatencyUpdated 發出一個窗口）
+        StageProfiler &stageProfiler() { return m_profiler; }
+
+        // ===== 品質降級（QualityGovernor 由檢測線程設定，下一幀生效） =====
+        void setQualityLevel(QualityLevel level) { m_qualityLevel.store(static_cast<int>(level), std::memory_order_relaxed); }
+        QualityLevel qualityLevel() const { return static_cast<QualityLevel>(m_qualityLevel.load(std::memory_order_relaxed)); }
 
         // ===== 幀處理 =====
         /**
          * @brief 處理幀並執行小零件檢測
          * @param frame 輸入幀
          * @param[out] detectedObjects 檢測到的物件列表
-         * @return 處理後的幀（帶繪製結果）
+         * @return 處理後的幀（燒入繪製結果的複製；失敗、停用或 NoOverlay 降級時為輸入幀本身）
          */
         cv::Mat processFrame(const cv::Mat &frame, std::vector<DetectedObject> &detectedObjects);
 
+        /**
+         * @brief 處理幀，繪製結果以資料形式輸出（不複製、不繪製幀）
+         * @param[out] overlay ROI / 光柵線 / 檢測框 / 計數摘要（NoOverlay 降級時為空）
+         * @param[out] annotated 非 nullptr 時另外輸出燒入結果的複製（NoOverlay 降級時不輸出）
+         * @param window 幀在感測器上的位置（相機端 AOI 裁切時由 FrameMeta 帶入）
+         * @return 是否完成處理（停用、空幀或檢測失敗時為 false）
+         *
+         * ROI 參數以完整感測器為基準：縮放比例依感測器寬度計算，ROI 換算到 AOI 幀內；
+         * 輸出的物件、光柵線與疊加座標都在輸入幀（AOI）座標。
+         */
+        bool processFrame(const cv::Mat &frame, std::vector<DetectedObject> &detectedObjects,
+                          FrameOverlay &overlay, cv::Mat *annotated = nullptr,
+                          const SensorWindow &window = SensorWindow());
+
+        /**
+         * @brief 目前 ROI 在感測器上的位置（感測器像素；相機端 AOI 依此設定）
+         * @return ROI 停用時為完整感測器；多料道時為各料道 ROI 的聯集
+         */
+        QRect sensorRoi(int sensorWidth, int sensorHeight) const;
+
+        /**
+         * @brief 重新發布每幀使用的 PerformanceConfig 項目
+         *
+         * AppConfig::configChanged 時自動呼叫；直接修改 Settings::performance() 的呼叫端需自行呼叫。
+         */
+        void reloadPerformanceParams();
+
         // ===== 包裝控制 =====
-        PackagingStatus getPackagingStatus() const;
+        PackagingStatus getPackagingStatus() const; // 多料道時為各料道合計
+
+        /**
+         * @brief 指定即時控制線程（nullptr = 只發出 vibratorSpeedChanged）
+         *
+         * 包裝模式下每次計數都把計數與決定的速度直接 post() 給控制線程（無鎖），
+         * 不等 Qt 事件循環；多料道時各料道以自己的料道編號送出。
+         */
+        void setControlLoop(VibratorControlLoop *loop);
+
+        // ===== 多料道 =====
+        /**
+         * @brief 設定同一幀內的多條料道（空 = 回到單一 ROI）
+         *
+         * 每條料道一個內部 DetectionController（傳統檢測）：獨立的背景模型、追蹤、光柵與包裝目標。
+         * 各料道從原始幀只縮放自己的窄 ROI 條帶並處理，以 cv::parallel_for_ 平行執行；
+         * count() 為各料道合計，全部料道達標時才發出 packagingCompleted。
+         * 建立時沿用本控制器目前的檢測參數，之後的參數設定會同步到每條料道。
+         * 預設由目前零件配置（PartProfile::lanes）決定，切換零件時自動更新。
+         */
+        void setLanes(const std::vector<LaneConfig> &lanes);
+        int laneTotal() const { return static_cast<int>(m_laneControllers.size()); }
+        int laneCount(int lane) const;
+        PackagingStatus lanePackagingStatus(int lane) const;
 
     public slots:
         // 檢測控制
@@ -177,13 +232,28 @@ namespace basler
         void setGateTriggerRadius(int radius);
         void setGateHistoryFrames(int frames);
         void setGateLinePositionRatio(double ratio);
+        void setOptimalAssignment(bool enabled, double budgetMs);
         void setUltraHighSpeedMode(bool enabled, int targetFps = 280);
         void setBgHistory(int history);
+        void setBackgroundEngine(BackgroundEngine engine, bool highSpeed = false);
         void setCannyThresholds(int low, int high);
         void setMorphParams(int kernelSize, int iterations);
 
         // YOLO 偵測控制
-        bool loadYoloModel(const QString &modelPath);
+        bool loadYoloModel(const QString &modelPath); // 同步載入（離線重播 / 無事件迴圈時使用）
+
+        /**
+         * @brief 在背景線程載入模型並暖機，完成後發出 yoloModelLoaded
+         *
+         * 載入期間 isYoloModelLoaded() 為 false，檢測照常以傳統模式進行；已有載入進行中時忽略。
+         */
+        void loadYoloModelAsync(const QString &modelPath);
+
+        /**
+         * @brief 依配置延遲載入模型：傳統模式、未設定路徑、已載入或載入中時不做事
+         * @param async true = 背景載入（啟動流程）；false = 同步載入
+         */
+        void loadConfiguredYoloModel(bool async = true);
         void setDetectionMode(DetectionMode mode);
         void setYoloConfidence(double threshold);
         void setYoloNmsThreshold(double threshold);
@@ -205,122 +275,236 @@ namespace basler
         void packagingCompleted();
         void vibratorSpeedChanged(VibratorSpeed speed);
         void detectionModeChanged(DetectionMode mode);
+        void yoloModelLoading(const QString &modelPath); // 背景載入開始
         void yoloModelLoaded(bool success);
         void yoloInferenceTimeUpdated(double ms);
+        void trackMatcherTimeUpdated(double ms); // 追蹤匹配耗時（每 10 幀）
         // 瑕疵統計：每次計數事件後更新
         void defectStatsUpdated(double passRate, int passCount, int failCount);
+        // 逐階段延遲窗口（檢測線程發出）
+        void stageLatencyUpdated(const basler::StageLatencySnapshot &snapshot);
+        // 多料道（檢測線程發出）
+        void laneCountChanged(int lane, int count);
+        void laneVibratorSpeedChanged(int lane, VibratorSpeed speed);
+        void lanePackagingCompleted(int lane);
 
     private:
+        // 基準測試直接量測各處理階段（benchmarks/detection_benchmark.cpp）
+        friend class DetectionBenchmark;
+
+        // 料道：不建立 YOLO、不跟隨零件配置，只由父控制器的 processLanes 呼叫
+        DetectionController(YoloInferencePool *sharedYolo, bool isLane, QObject *parent);
+
+        // 縮放後的處理（縮放座標計算 ROI → 只縮放 ROI 條帶 → 檢測 → 光柵計數），單一 ROI 與料道共用
+        void processScaled(const cv::Mat &frame, double scale, const SensorWindow &window,
+                           QualityLevel quality, std::vector<DetectedObject> &detectedObjects);
+
+        // 多料道
+        bool processLanes(const cv::Mat &frame, double scale, const SensorWindow &window,
+                          QualityLevel quality, std::vector<DetectedObject> &detectedObjects);
+        void processLane(const cv::Mat &frame, double scale, const SensorWindow &window,
+                         QualityLevel quality, std::vector<DetectedObject> &detectedObjects);
+
+        // 單一參數快照的 ROI 在感測器上的位置（sensorRoi 使用）
+        static QRect sensorRoiOf(const DetectionParams &params, int sensorWidth, int sensorHeight);
+        FrameOverlay buildLaneOverlay() const;
+        void copyParametersTo(DetectionController &lane) const;
+        void applyPartLanes(const QString &partId);
+
+        // 參數快照：setter 以 fn 修改目前快照的複製後發布（不等待檢測線程）
+        template <typename Fn>
+        void publishParams(Fn &&fn)
+        {
+            m_publishedParams.update(std::forward<Fn>(fn));
+        }
+
+        // 檢測線程（持有管線鎖）取用最新快照；背景模型設定或光柵半徑變更時在此重建
+        void refreshParams();
+
+        template <typename Fn>
+        void forEachLane(Fn &&fn)
+        {
+            for (auto &lane : m_laneControllers)
+            {
+                fn(*lane);
+            }
+        }
+
         // 處理流程
         cv::Mat standardProcessing(const cv::Mat &processRegion);
         cv::Mat ultraHighSpeedProcessing(const cv::Mat &processRegion);
-        std::vector<DetectedObject> detectObjects(const cv::Mat &processed);
+        void highSpeedMorphology(const cv::Mat &fgMask, cv::Mat &out);
+
+        // 先裁切再縮放：條帶外保留的濾波邊界，以及 verifyFusedPipeline 與整幀縮放路徑的比對
+        int filterMargin() const;
+        void verifyRegionPixels(const cv::Mat &frame, const cv::Size &scaledSize, const cv::Rect &roiRect,
+                                const cv::Mat &processRegion);
+        void verifyRegionResult(const cv::Mat &frame, const cv::Size &scaledSize, const cv::Rect &roiRect,
+                                bool highSpeed, const cv::Mat &processed, const std::vector<DetectedObject> &objects);
+
+        // standardProcessing 背景減除之後的兩種實作（輸出逐位元一致）
+        cv::Mat standardStagesReference(const cv::Mat &processRegion, const cv::Mat &fgMask);
+
+        // 融合管線依像素格式（Color = BGR8，否則 Mono8）與啟用階段（FUSED_STAGE_* 位元組合）編譯期特化：
+        // 未啟用的階段與格式分支在編譯期移除；參數或像素格式改變時才重新選擇特化
+        template <bool Color, unsigned Stages>
+        cv::Mat standardStagesFused(const cv::Mat &processRegion, const cv::Mat &fgMask);
+        using FusedStagesFn = cv::Mat (DetectionController::*)(const cv::Mat &, const cv::Mat &);
+        static constexpr unsigned FUSED_STAGE_BLUR = 1u;   // gaussianBlurKernelSize > 1
+        static constexpr unsigned FUSED_STAGE_OPEN = 2u;   // openingKernelSize > 1 且 openingIterations > 0
+        static constexpr unsigned FUSED_STAGE_DILATE = 4u; // dilateKernelSize > 1 且 dilateIterations > 0
+        static constexpr unsigned FUSED_STAGE_CLOSE = 8u;  // closeKernelSize > 1
+        static constexpr unsigned FUSED_STAGE_COMBINATIONS = 16u;
+        template <std::size_t... Index>
+        static std::array<FusedStagesFn, sizeof...(Index)> fusedStagesTable(std::index_sequence<Index...>);
+        FusedStagesFn selectFusedStages(bool color) const;
+        // 裝置版（含背景減除）；失敗時回退 CPU 並回傳 false
+        bool standardStagesDevice(const cv::Mat &processRegion, cv::Mat &result);
+        void selectClassicalDevice();
+        void verifyFusedStages(const cv::Mat &fused, const cv::Mat &reference);
+        static const cv::Mat &cachedKernel(cv::Mat &cache, int shape, int size);
+        // highSpeed = 本幀走 ultraHighSpeedProcessing（面積門檻與微膨脹隨之切換）
+        std::vector<DetectedObject> detectObjects(const cv::Mat &processed, bool highSpeed);
         bool validateShape(int width, int height, int area);
 
         // YOLO 偵測流程
         std::vector<DetectedObject> yoloProcessing(const cv::Mat &roiImage, int roiY);
+        std::vector<DetectedObject> yoloProcessingAsync(const cv::Mat &roiImage, int roiY);
         void yoloBasedCounting(const std::vector<DetectedObject> &objects);
 
         // 判斷當前是否使用 YOLO 模式
         bool shouldUseYolo() const;
 
+        // 模型載入（loadYoloModelNow 可在背景線程執行；finishYoloModelLoad 在本物件線程）
+        bool loadYoloModelNow(const QString &modelPath);
+        void finishYoloModelLoad(const QString &modelPath, bool success);
+
         // 虛擬光柵計數 - 基於物件追蹤
         void virtualGateCounting(const std::vector<DetectedObject> &objects);
         bool checkGateTriggerDuplicate(int cx, int cy);
 
         // 物件追蹤系統 - 增強型多特徵匹配
         void updateObjectTracks(const std::vector<DetectedObject> &objects);
-        int findMatchingTrack(const DetectedObject &obj, double &outScore);
-        double calculateMatchScore(const DetectedObject &obj, const ObjectTrack &track);
+        int findMatchingTrack(const DetectedObject &obj, double &outScore) const;       // 回傳槽位
+        void matchTracksGreedy(const std::vector<DetectedObject> &objects);
+        void matchTracksOptimal(const std::vector<DetectedObject> &objects, int trackCount);
+        double calculateMatchScore(const DetectedObject &obj, int slot) const;
         double calculateIoU(int x1, int y1, int w1, int h1, int x2, int y2, int w2, int h2);
-        void updateTrackVelocity(ObjectTrack &track);
-        bool checkDuplicateCount(const ObjectTrack &track);
+        bool checkDuplicateCount(int x, int y) const;
 
-        // 繪製結果
-        cv::Mat drawDetectionResults(cv::Mat frame, const std::vector<DetectedObject> &objects);
+        // 繪製結果（資料形式；需燒入時交給 burnInOverlay）
+        FrameOverlay buildOverlay(const std::vector<DetectedObject> &objects) const;
 
         // 包裝控制
         void updateVibratorSpeed();
 
-        // 背景減除器
+        // 背景減除器（PerformanceConfig::bgSubtractorBands 個水平帶平行執行）
         void resetBackgroundSubtractor();
-        cv::Ptr<cv::BackgroundSubtractorMOG2> m_bgSubtractor;
+        BackgroundModel m_bgSubtractor;
+        RunLengthBlobExtractor m_blobExtractor; // detectObjects 的連通元件分析（管線鎖保護）
         double m_currentLearningRate = 0.001;
 
-        // 調試視圖：保存中間幀供 UI 視覺化切換
-        cv::Mat m_lastDebugFrame;   // 最終形態學結果（= postProcessed）
-        cv::Mat m_lastFgMask;       // 背景減除後清理遮罩（fgCleaned）
-        cv::Mat m_lastCannyEdges;   // Canny 邊緣（sensitiveEdges）
-        cv::Mat m_lastCombined;     // 三重聯合結果（combined）
-
-        // 狀態
-        bool m_enabled = false;
-
-        // 檢測參數（從配置讀取）
-        int m_minArea = 2;
-        int m_maxArea = 3000;
-        double m_minAspectRatio = 0.001;
-        double m_maxAspectRatio = 100.0;
-        double m_minExtent = 0.001;
-        double m_maxSolidity = 5.0;
-        int m_bgHistory = 1000;
-        int m_bgVarThreshold = 3;
-        bool m_detectShadows = false;
-        double m_bgLearningRate = 0.001;
-        int m_connectivity = 4;
-
-        // 邊緣檢測參數（basler_mvc 驗證值）
-        int m_gaussianBlurKernelSize = 1;
-        int m_cannyLowThreshold = 3;
-        int m_cannyHighThreshold = 10;
-        int m_binaryThreshold = 1;
-
-        // 形態學參數（預設跳過，可由 UI 調整啟用）
-        int m_dilateKernelSize = 1;
-        int m_dilateIterations = 0;
-        int m_closeKernelSize = 1;
-        int m_openingKernelSize = 1;
-        int m_openingIterations = 0;
-
-        // ROI 參數（basler_mvc 驗證值）
-        bool m_roiEnabled = true;
-        int m_roiX = 0;
-        int m_roiWidth = 0;            // 0 = 自動使用全幀寬度
-        int m_roiHeight = 120;
-        double m_roiPositionRatio = 0.12;
+        // 融合管線持久緩衝（ROI 尺寸不變時 OpenCV 直接重用，不重新配置）
+        struct StandardBuffers
+        {
+            cv::Mat fgMask;
+            cv::Mat blurred;
+            cv::Mat fgMedian;
+            cv::Mat fgStep1;
+            cv::Mat fgStep2;
+            cv::Mat fgCleaned;
+            cv::Mat edges;
+            cv::Mat gray;
+            cv::Mat adaptive;
+            cv::Mat combined;
+            cv::Mat postProcessed;
+        };
+        StandardBuffers m_stdBuffers;
+
+        // 裝置管線緩衝（classicalDevice 啟用時；尺寸不變時重用裝置記憶體）
+        struct DeviceBuffers
+        {
+            cv::UMat region;
+            cv::UMat fgMask;
+            cv::UMat blurred;
+            cv::UMat fgMedian;
+            cv::UMat fgStep1;
+            cv::UMat fgStep2;
+            cv::UMat fgCleaned;
+            cv::UMat edges;
+            cv::UMat gray;
+            cv::UMat adaptive;
+            cv::UMat edgeOrAdaptive;
+            cv::UMat combined;
+        };
+        DeviceBuffers m_deviceBuffers;
+        // 裝置選擇狀態（只在檢測線程存取）
+        bool m_deviceSelected = false;
+        ClassicalDevice m_selectedDevice = ClassicalDevice::Cpu; // 上次選擇時的 classicalDevice 設定
+        bool m_deviceActive = false;                             // standardProcessing 走裝置管線
+
+        // 快取的結構元素（每槽固定形狀，核尺寸變更時才重建）
+        struct MorphKernels
+        {
+            cv::Mat ellipse5;
+            cv::Mat ellipse7;
+            cv::Mat ellipse3;
+            cv::Mat opening; // openingKernelSize 橢圓
+            cv::Mat dilate;  // dilateKernelSize 矩形
+            cv::Mat close;   // closeKernelSize 橢圓
+            cv::Mat rect3;   // 超高速模式 3x3 矩形
+        };
+        MorphKernels m_morphKernels;
+        FusedStagesFn m_fusedStages = nullptr; // 目前參數與像素格式對應的特化（nullptr = 待選擇）
+        bool m_fusedStagesColor = false;       // m_fusedStages 選擇時的像素格式
+        int m_fusedMismatchFrames = 0; // verifyFusedPipeline 偵測到不一致的幀數
+        int m_regionMismatchFrames = 0; // verifyFusedPipeline 偵測到先裁切再縮放結果不一致的幀數
+
+        // 先裁切再縮放的驗證狀態（參考條帶有獨立的背景模型，與主模型同步重建）
+        bool m_regionVerifyActive = false;
+        BackgroundModel m_verifyBgSubtractor;
+        cv::Mat m_verifyScaled;
+        cv::Mat m_verifyFgMask;
+        cv::Mat m_verifyProcessed;
+
+        // 調試視圖：中間幀只在 UI 訂閱時擷取
+        DebugTap m_debugTap;
+        bool m_captureDebug = false; // 本幀是否擷取（只在檢測線程存取）
+
+        StageProfiler m_profiler;
+
+        // 狀態（UI 線程寫入、檢測線程讀取）
+        std::atomic<bool> m_enabled{false};
+
+        // 可調參數：UI 線程發布快照，檢測線程每幀開始時（refreshParams）取用為工作副本
+        VersionedSnapshot<DetectionParams> m_publishedParams;
+        DetectionParams m_params;     // 工作副本（只在持有管線鎖時存取）
+        uint64_t m_paramsVersion = 0; // m_params 對應的快照版本
+
+        // 本幀實際使用的 ROI（原始解析度座標）
         int m_currentRoiX = 0;
         int m_currentRoiY = 0;
-        int m_currentRoiWidth = 0;     // 本幀實際使用的 ROI 寬度
+        int m_currentRoiWidth = 0;
         int m_currentRoiHeight = 120;
-
-        // 高速模式參數
-        bool m_ultraHighSpeedMode = false;
-        int m_targetFps = 280;
-        int m_highSpeedBgHistory = 100;
-        int m_highSpeedBgVarThreshold = 8;
-        int m_highSpeedMinArea = 1;
-        int m_highSpeedMaxArea = 2000;
-
-        // 虛擬光柵參數
-        bool m_enableGateCounting = true;
-        double m_gateLinePositionRatio = 0.5;
-        int m_gateTriggerRadius = 20;
-        int m_gateHistoryFrames = 8;
+        SensorWindow m_frameWindow; // 上一幀的感測器 AOI（只在檢測線程存取）
+        cv::Mat m_regionBuffer;     // ROI 條帶縮放暫存（跨幀重用）
 
         // 光柵狀態
-        std::map<std::pair<int, int>, int> m_triggeredPositions; // {(x,y): frame_number}
-        int m_crossingCounter = 0;
+        static constexpr int GATE_TRIGGER_CAPACITY = 64;
+        RecentPositionIndex m_gateTriggers{GATE_TRIGGER_CAPACITY, m_params.gateTriggerRadius}; // 光柵觸發點（時間序 + 空間索引）
+        std::atomic<int> m_crossingCounter{0}; // 檢測 / 料道線程寫入，UI 線程 count() / getPackagingStatus() 讀取
         int m_frameWidth = 0;       // 原始相機幀寬度（連線後由第一幀決定）
         int m_frameHeight = 0;      // 原始相機幀高度
         double m_processingScale = 1.0; // 處理解析度縮放比例，由 targetProcessingWidth 計算
+        double m_areaScale = 1.0;       // 本幀面積門檻換算（品質調節降低處理寬度時 < 1；只在檢測線程存取）
         int m_currentFrameCount = 0;
-        int m_totalProcessedFrames = 0;
+        std::atomic<int> m_totalProcessedFrames{0};
         int m_gateLineY = 0;
 
         // 物件追蹤系統（防重複計數）
-        std::map<int, ObjectTrack> m_objectTracks;                                // {track_id: track_data}
-        std::map<int, ObjectTrack> m_lostTracks;                                  // 暫時失去的追蹤
-        std::vector<std::pair<std::pair<int, int>, int>> m_countedObjectsHistory; // {(x,y), frame}
+        TrackTable m_tracks;                                                      // 活動 + 暫時失去的追蹤（SoA）
+        std::vector<std::tuple<int, int, double>> m_trackMatches;                 // 匹配暫存 (slot, objIdx, score)
+        std::vector<quint8> m_objectUsed;                                         // 每個偵測是否已配對（暫存）
         int m_nextTrackId = 1;
         // 追蹤參數
         int m_crossingToleranceX = 35;         // X 軸容錯距離
@@ -333,6 +517,19 @@ namespace basler
         int m_temporalTolerance = 6;           // 時間容錯
         int m_maxMissedFrames = 5;             // 最大可容忍的未匹配幀數
 
+        // 已計數位置歷史（最近 m_historyLength 筆，時間序環形 + 空間索引，防重複計數）
+        RecentPositionIndex m_countedHistory{m_historyLength, m_duplicateDistanceThreshold};
+        // 追蹤位置網格（每幀重建；格子 = 匹配硬性容許範圍，候選只在相鄰 3×3 格）
+        SpatialGrid m_trackGrid;
+
+        // 全域最佳指派（可選，取代貪婪匹配；開關與預算在 m_params）
+        AssignmentSolver m_assignmentSolver;
+        std::vector<AssignmentCandidate> m_assignmentCandidates;
+        std::vector<std::pair<int, int>> m_assignments;
+        std::atomic<double> m_lastMatcherLatencyMs{0.0};
+        std::atomic<quint64> m_assignmentBudgetExceeded{0};
+        std::atomic<int> m_qualityLevel{0}; // QualityLevel
+
         // 匹配權重（距離 + 面積相似度，防止密集零件 Track Swap）
         double m_weightDistance = 0.8;  // 距離權重（80%）
         double m_weightArea = 0.2;      // 面積相似度權重（20%）
@@ -344,19 +541,34 @@ namespace basler
         int m_defectPassCount = 0;
         int m_defectFailCount = 0;
 
-        // 包裝控制
-        bool m_packagingEnabled = false;
-        int m_targetCount = 150;
+        // 包裝控制（啟用 / 目標 / 速度門檻由 UI 線程設定、檢測線程讀取，以原子變數 relaxed 存取）
+        std::atomic<bool> m_packagingEnabled{false};
+        std::atomic<int> m_targetCount{150};
         int m_advanceStopCount = 2;
-        double m_speedFullThreshold = 0.85;
-        double m_speedMediumThreshold = 0.93;
-        double m_speedSlowThreshold = 0.97;
-        VibratorSpeed m_currentSpeed = VibratorSpeed::STOP;
-        bool m_packagingCompleted = false;
+        std::atomic<double> m_speedFullThreshold{0.85};
+        std::atomic<double> m_speedMediumThreshold{0.93};
+        std::atomic<double> m_speedSlowThreshold{0.97};
+        // 料道線程寫入、UI 線程 getPackagingStatus() 彙總各料道時讀取
+        std::atomic<VibratorSpeed> m_currentSpeed{VibratorSpeed::STOP};
+        std::atomic<bool> m_packagingCompleted{false};
+
+        // 預測式降速（依光柵計數量測各檔位落料速率）
+        bool m_predictiveSpeed = true;
+        int m_flowSettleMs = 300;
+        int m_actuationLatencyMs = 50;
+        double m_flowSafetyFactor = 1.5;
+        FlowRateEstimator m_flowEstimator;
 
         // YOLO 偵測
         std::unique_ptr<YoloDetector> m_yoloDetector;
+        YoloInferencePool *m_yoloPool = nullptr; // 共用推理池（非 nullptr 時 m_yoloDetector 為空）
+        std::thread m_yoloLoadThread;             // 背景模型載入（loadYoloModelAsync；解構時等待）
+        std::atomic<bool> m_yoloLoading{false};
         DetectionMode m_detectionMode = DetectionMode::Auto;
+        bool m_yoloAsync = true;
+        int m_yoloBatchSize = 4;
+        std::vector<YoloFrameResult> m_yoloResults;  // 本幀交付的非同步結果（依提交順序）
+        std::vector<DetectedObject> m_lastYoloObjects; // 最近一筆非同步結果（繪製用）
 
         // YOLO 簡化追蹤（用於計數）
         struct YoloTrack
@@ -366,12 +578,28 @@ namespace basler
             int firstY;       // 首次出現 Y
             int lastFrame;    // 最後出現幀
             bool counted;     // 是否已計數
+            bool matched;     // 本幀已匹配（暫存）
         };
-        std::map<int, YoloTrack> m_yoloTracks;
+        std::vector<YoloTrack> m_yoloTracks; // 依 trackId 遞增排列（附加新增、穩定移除）
         int m_nextYoloTrackId = 1;
 
+        // 多料道（m_pipelineMutex 保護；只在 UI 線程增減）
+        std::vector<std::unique_ptr<DetectionController>> m_laneControllers;
+        std::vector<int> m_laneTargetOverride;                 // 0 = 跟隨 m_targetCount
+        std::vector<double> m_laneGateOverride;                // < 0 = 跟隨 gateLinePositionRatio
+        std::vector<std::vector<DetectedObject>> m_laneObjects; // 各料道本幀的檢測結果（重用）
+        bool m_isLane = false;
+        int m_laneIndex = -1; // 料道編號（即時控制用；-1 = 單一 ROI）
+
+        // 即時控制線程（外部擁有；檢測線程讀取）
+        std::atomic<VibratorControlLoop *> m_controlLoop{nullptr};
+
         // 互斥鎖
         mutable QMutex m_mutex;
+
+        // 處理管線鎖：processFrame 全程持有（在 DetectionWorker 線程執行），
+        // 背景減除器重建與 reset() 也持有，避免 UI 線程與檢測線程同時改動管線狀態
+        QMutex m_pipelineMutex;
     };
 
 } // namespace basler
@@ -379,5 +607,6 @@ namespace basler
 Q_DECLARE_METATYPE(basler::VibratorSpeed)
 Q_DECLARE_METATYPE(basler::DetectedObject)
 Q_DECLARE_METATYPE(basler::DetectionMode)
+Q_DECLARE_METATYPE(basler::StageLatencySnapshot)
 
 #endif // DETECTION_CONTROLLER_H
@@ -0,0 +1,46 @@
+#ifndef DETECTION_KERNELS_H
+#define DETECTION_KERNELS_H
+
+#include <opencv2/core.hpp>
+
+namespace basler
+{
+
+    /**
+     * @brief 三重聯合遮罩融合（單次 SIMD 掃描）
+     *
+     * 等價於 standardProcessing 原本的六個逐像素步驟：
+     *   edgeThresh     = threshold(edges & mask(fg), 1)
+     *   adaptiveClean  = threshold(adaptive & mask(fg), 127)
+     *   out            = fg | edgeThresh | adaptiveClean
+     * 即 out = fg | (fg != 0 ? ((edges > 1 || adaptive > 127) ? 255 : 0) : 0)，逐位元一致。
+     *
+     * @param fg 前景遮罩（CV_8UC1，值可含 MOG2 陰影 127）
+     * @param edges Canny 邊緣（CV_8UC1）
+     * @param adaptive 自適應閾值結果（CV_8UC1）
+     * @param[out] out 輸出遮罩（尺寸不變時重用緩衝）
+     */
+    void fuseTripleMask(const cv::Mat &fg, const cv::Mat &edges, const cv::Mat &adaptive, cv::Mat &out);
+
+    /**
+     * @brief 只縮放幀的一個區域（先裁切再縮放）
+     *
+     * 與 cv::resize(frame, scaled, scaledSize, 0, 0, cv::INTER_LINEAR) 後取 scaled(region) 逐像素相同：
+     * 兩軸各自外擴到能對齊整數原始像素的位置，裁切對應的原始區塊後以同一比例 cv::resize，
+     * 取樣網格與整幀縮放重合（2 倍時 OpenCV 同樣自動改走 INTER_AREA 快速路徑）。
+     * 輸出是緩衝的子視圖，周圍至少保留 margin 個縮放像素（縮放幀邊緣除外），
+     * 讀取 ROI 外像素的濾波（非 BORDER_ISOLATED）看到的鄰域與整幀縮放後取子矩陣時相同。
+     *
+     * @param frame 原始幀
+     * @param scaledSize 整幀縮放後的尺寸（不大於 frame）
+     * @param region 縮放幀座標中的區域（必須在 scaledSize 內）
+     * @param margin 區域外需保留的縮放像素（後續濾波的最大半徑）
+     * @param buffer 縮放暫存（跨幀重用，尺寸不變時不重新配置）
+     * @param[out] out 縮放後的區域（尺寸 = region.size()）；不縮放時為 frame 的子視圖，否則為 buffer 的子視圖
+     */
+    void resizeRegion(const cv::Mat &frame, const cv::Size &scaledSize, const cv::Rect &region, int margin,
+                      cv::Mat &buffer, cv::Mat &out);
+
+} // namespace basler
+
+#endif // DETECTION_KERNELS_H
@@ -0,0 +1,155 @@
+#ifndef DETECTION_PARAMS_H
+#define DETECTION_PARAMS_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+#include "core/background_model.h"
+
+namespace basler
+{
+
+    /**
+     * @brief standardProcessing 的執行裝置（PerformanceConfig::classicalDevice）
+     */
+    enum class ClassicalDevice
+    {
+        Cpu,    // cv::Mat 主機端管線（融合 / 參考）
+        OpenCl, // cv::UMat（OpenCL T-API），任何可用 OpenCL 裝置
+        Auto    // 有 OpenCL GPU 時使用裝置，否則 CPU
+    };
+
+    /**
+     * @brief DetectionController 的可調參數（一份不可變快照）
+     *
+     * setter 複製目前快照、修改後整份發布；檢測線程每幀開始時比較版本號，有新版才取用，
+     * 整幀處理期間只讀自己的工作副本，不需為參數加鎖。
+     */
+    struct DetectionParams
+    {
+        // 檢測參數
+        int minArea = 2;
+        int maxArea = 3000;
+        double minAspectRatio = 0.001;
+        double maxAspectRatio = 100.0;
+        double minExtent = 0.001;
+        double maxSolidity = 5.0;
+        int bgHistory = 1000;
+        int bgVarThreshold = 3;
+        bool detectShadows = false;
+        double bgLearningRate = 0.001;
+        BackgroundEngine bgEngine = BackgroundEngine::MOG2;
+        int connectivity = 4;
+
+        // 邊緣檢測參數（basler_mvc 驗證值）
+        int gaussianBlurKernelSize = 1;
+        int cannyLowThreshold = 3;
+        int cannyHighThreshold = 10;
+        int binaryThreshold = 1;
+
+        // 形態學參數（預設跳過，可由 UI 調整啟用）
+        int dilateKernelSize = 1;
+        int dilateIterations = 0;
+        int closeKernelSize = 1;
+        int openingKernelSize = 1;
+        int openingIterations = 0;
+
+        // ROI 參數（basler_mvc 驗證值）
+        bool roiEnabled = true;
+        int roiX = 0;
+        int roiWidth = 0; // 0 = 自動使用全幀寬度
+        int roiHeight = 120;
+        double roiPositionRatio = 0.12;
+
+        // 高速模式參數
+        bool ultraHighSpeedMode = false;
+        int targetFps = 280;
+        int highSpeedBgHistory = 100;
+        int highSpeedBgVarThreshold = 8;
+        BackgroundEngine highSpeedBgEngine = BackgroundEngine::MOG2;
+        int highSpeedMinArea = 1;
+        int highSpeedMaxArea = 2000;
+
+        // 虛擬光柵參數
+        bool enableGateCounting = true;
+        double gateLinePositionRatio = 0.5;
+        int gateTriggerRadius = 20;
+        int gateHistoryFrames = 8;
+        bool optimalAssignment = false;
+        double assignmentBudgetMs = 2.0;
+
+        // PerformanceConfig 中每幀使用的項目（AppConfig::configChanged 時重新發布）
+        int targetProcessingWidth = 640;
+        int stageProfilingIntervalMs = 1000;
+        bool fusedStandardPipeline = true;
+        bool verifyFusedPipeline = false;
+        bool cropBeforeResize = true;
+        ClassicalDevice classicalDevice = ClassicalDevice::Cpu;
+        bool runLengthBlobs = true;
+        int bgSubtractorBands = 4;
+
+        // 目前生效的背景模型設定（高速模式使用另一組）
+        int effectiveBgHistory() const { return ultraHighSpeedMode ? highSpeedBgHistory : bgHistory; }
+        int effectiveBgVarThreshold() const { return ultraHighSpeedMode ? highSpeedBgVarThreshold : bgVarThreshold; }
+        BackgroundEngine effectiveBgEngine() const { return ultraHighSpeedMode ? highSpeedBgEngine : bgEngine; }
+
+        /**
+         * @brief 兩份參數的背景模型是否不同（不同時需重建背景減除器）
+         */
+        bool backgroundDiffers(const DetectionParams &other) const
+        {
+            return effectiveBgHistory() != other.effectiveBgHistory() ||
+                   effectiveBgVarThreshold() != other.effectiveBgVarThreshold() ||
+                   effectiveBgEngine() != other.effectiveBgEngine() ||
+                   detectShadows != other.detectShadows || bgSubtractorBands != other.bgSubtractorBands;
+        }
+    };
+
+    /**
+     * @brief 版本化的不可變快照（RCU 式發布）
+     *
+     * 寫入端複製目前值、修改後以原子操作替換指標並遞增版本號（寫入端之間以互斥鎖串行）；
+     * 讀取端先比較版本號（單次原子讀取），有變更才取用新快照。舊快照在最後一個讀取端釋放後才回收。
+     */
+    template <typename T>
+    class VersionedSnapshot
+    {
+    public:
+        VersionedSnapshot() : m_current(std::make_shared<const T>()) {}
+
+        VersionedSnapshot(const VersionedSnapshot &) = delete;
+        VersionedSnapshot &operator=(const VersionedSnapshot &) = delete;
+
+        uint64_t version() const { return m_version.load(std::memory_order_acquire); }
+        std::shared_ptr<const T> load() const { return std::atomic_load_explicit(&m_current, std::memory_order_acquire); }
+
+        /**
+         * @brief 以 fn 修改目前值的複製後發布
+         * @return 新版本號
+         */
+        template <typename Fn>
+        uint64_t update(Fn &&fn)
+        {
+            std::lock_guard<std::mutex> lock(m_writeMutex);
+            auto next = std::make_shared<T>(*m_current);
+            std::forward<Fn>(fn)(*next);
+            std::atomic_store_explicit(&m_current, std::shared_ptr<const T>(std::move(next)),
+                                       std::memory_order_release);
+            // 版本號在指標之後發布：讀到新版本號的讀取端一定取得不舊於該版本的快照
+            const uint64_t version = m_version.load(std::memory_order_relaxed) + 1;
+            m_version.store(version, std::memory_order_release);
+            return version;
+        }
+
+    private:
+        std::shared_ptr<const T> m_current;
+        std::atomic<uint64_t> m_version{0};
+        std::mutex m_writeMutex;
+    };
+
+} // namespace basler
+
+#endif // DETECTION_PARAMS_H
@@ -0,0 +1,125 @@
+#ifndef DETECTION_WORKER_H
+#define DETECTION_WORKER_H
+
+#include <QObject>
+#include <QMutex>
+#include <QString>
+#include <atomic>
+#include <vector>
+#include <opencv2/core.hpp>
+
+#include "core/detection_controller.h"
+#include "core/frame_overlay.h"
+#include "core/frame_ring.h"
+#include "core/quality_governor.h"
+
+namespace basler
+{
+
+    /**
+     * @brief 單幀檢測結果
+     *
+     * 由檢測線程產生，UI 線程只取最新一筆顯示。
+     */
+    struct DetectionResult
+    {
+        quint64 sequence = 0;                // FrameRing 幀序號
+        qint64 timestampUs = 0;              // 擷取時間戳（微秒）
+        cv::Mat annotatedFrame;              // 燒入繪製結果的幀（overlayAsData 時為空，改用 overlay）
+        FrameOverlay overlay;                // 繪製結果（資料形式，影像原始座標）
+        std::vector<DetectedObject> objects; // 本幀檢測到的物件
+        int count = 0;                       // 當前累計計數
+        int frameWidth = 0;                  // 原始幀寬度（StatusBar ROI 顯示用）
+        double processingMs = 0.0;           // 本幀檢測耗時
+    };
+
+    /**
+     * @brief 檢測管線工作線程
+     *
+     * 設計要點：
+     * 1. 在專用線程呼叫 DetectionController::processFrame，計數不再受 UI 重繪頻率（16ms）限制
+     * 2. 作為 FrameRing 的「detection」消費者依序讀取每一幀；跟不上時由 FrameRing 累計丟幀
+     *    （無損計數模式下註冊為無損消費者，生產者改為等待，不丟幀）
+     * 3. 結果寫入「最新結果」槽，UI 定時器以顯示頻率取用，不會排隊
+     * 4. 每處理一幀後略過 skipFrames 幀；持續跟不上時由 QualityGovernor 逐級降低處理品質
+     * 5. PerformanceConfig::overlayAsData 時結果只帶 FrameOverlay，不複製幀（顯示端自行讀取 FrameRing）
+     */
+    class DetectionWorker : public QObject
+    {
+        Q_OBJECT
+
+    public:
+        explicit DetectionWorker(DetectionController *controller, FrameRing *ring, QObject *parent = nullptr);
+        ~DetectionWorker() = default;
+
+        /**
+         * @brief 取出最新檢測結果（UI 線程呼叫）
+         * @param[out] result 最新結果
+         * @return 自上次取用後是否有新結果
+         */
+        bool takeLatestResult(DetectionResult &result);
+
+        /**
+         * @brief 清除最新結果（停止檢測時呼叫，避免顯示過期畫面）
+         */
+        void clearLatestResult();
+
+        // ===== 統計 =====
+        qint64 processedFrames() const { return m_processedFrames.load(); }
+        quint64 droppedFrames() const;
+        quint64 backlogFrames() const { return m_backlogFrames.load(std::memory_order_relaxed); } // 最近一幀的落後幀數
+        double lastProcessingMs() const { return m_lastProcessingMs.load(std::memory_order_relaxed); }
+
+        /**
+         * @brief 更新輸入幀率（品質調節的負載計算用，線程安全）
+         */
+        void setSourceFps(double fps) { m_sourceFps.store(fps, std::memory_order_relaxed); }
+
+    signals:
+        /**
+         * @brief 品質等級改變（檢測線程發出）
+         * @param level QualityLevel 數值
+         * @param description 目前等級說明
+         */
+        void qualityLevelChanged(int level, const QString &description);
+
+    public slots:
+        /**
+         * @brief 檢測循環（連接 QThread::started，直到 stop() 才返回）
+         */
+        void run();
+
+        /**
+         * @brief 請求停止檢測循環（線程安全）
+         */
+        void stop();
+
+    private:
+        void processFrame(const cv::Mat &frame, const FrameMeta &meta);
+        void updateQuality(double processingMs, const FrameMeta &meta);
+
+        DetectionController *m_controller;
+        FrameRing *m_ring;
+        std::atomic<int> m_consumerId{-1};
+        std::atomic<bool> m_running{false};
+
+        cv::Mat m_frame; // FrameRing 讀取緩衝（重用，尺寸不變時不配置）
+
+        // 最新結果槽（UI 只讀最新一筆）
+        QMutex m_resultMutex;
+        DetectionResult m_latestResult;
+        bool m_hasNewResult = false;
+
+        // 品質調節（檢測線程專用）
+        QualityGovernor m_governor;
+        std::atomic<double> m_sourceFps{0.0};
+
+        // 統計
+        std::atomic<qint64> m_processedFrames{0};
+        std::atomic<quint64> m_backlogFrames{0};
+        std::atomic<double> m_lastProcessingMs{0.0};
+    };
+
+} // namespace basler
+
+#endif // DETECTION_WORKER_H
@@ -0,0 +1,136 @@
+#ifndef EVENT_RECORDER_H
+#define EVENT_RECORDER_H
+
+#include <QObject>
+#include <QString>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <opencv2/core.hpp>
+
+#include "core/frame_ring.h"
+
+namespace basler {
+
+class VideoRecorder;
+
+/**
+ * @brief 事件錄影的觸發來源
+ */
+enum class EventTrigger {
+    Manual,            // 快捷鍵
+    GateBurst,         // 短時間內大量穿越光柵
+    PackagingMismatch, // 包裝完成時計數與目標不符
+    QualityDegrade     // 品質調節降級（檢測跟不上）
+};
+
+const char* eventTriggerTag(EventTrigger trigger);
+
+/**
+ * @brief 事件觸發錄影（預觸發環形緩衝）
+ *
+ * 1. 專用線程以一般（非無損）消費者讀 FrameRing，每幀 JPEG 壓縮後放進記憶體環形緩衝，
+ *    保留最近 preTriggerSeconds 秒（並受 maxBufferMegabytes 限制）；跟不上時由 FrameRing 丟幀，不影響檢測
+ * 2. trigger() 可從任意線程呼叫；下一幀起把緩衝解碼後依序排入自有的 VideoRecorder（無損佇列），
+ *    之後 postTriggerSeconds 秒的幀直接排入不壓縮；片段進行中再次觸發只延長結束時間
+ * 3. 片段寫出後緩衝清空（其中的幀已在片段內），重新累積
+ */
+class EventRecorder : public QObject {
+    Q_OBJECT
+
+public:
+    explicit EventRecorder(FrameRing* ring, QObject* parent = nullptr);
+    ~EventRecorder();
+
+    EventRecorder(const EventRecorder&) = delete;
+    EventRecorder& operator=(const EventRecorder&) = delete;
+
+    /**
+     * @brief 依 DebugConfig 啟動（eventRecordingEnabled 為 false 時不啟動）
+     * @return 是否在執行中
+     */
+    bool start();
+
+    /**
+     * @brief 停止（進行中的片段會寫完目前已排入的幀）
+     */
+    void stop();
+
+    bool isRunning() const { return m_running.load(); }
+    bool isCapturing() const { return m_capturing.load(); }
+    double bufferedSeconds() const { return m_bufferedUs.load() / 1e6; }
+    int bufferedFrames() const { return m_bufferedFrames.load(); }
+
+public slots:
+    /**
+     * @brief 觸發事件（任意線程；未執行時忽略）
+     */
+    void trigger(basler::EventTrigger trigger, const QString& detail = QString());
+
+    /**
+     * @brief 穿越光柵一次（統計 gateBurstWindowMs 內的次數，達 gateBurstCount 即觸發）
+     */
+    void noteGateCrossing();
+
+signals:
+    void eventStarted(const QString& reason, const QString& path);
+    void eventSaved(const QString& path, int frames, int preTriggerFrames);
+    void eventError(const QString& error);
+
+private:
+    struct BufferedFrame {
+        std::vector<uchar> jpeg;
+        FrameMeta meta;
+    };
+
+    void captureLoop();
+    void bufferFrame(const cv::Mat& frame, const FrameMeta& meta);
+    void beginEvent(const cv::Mat& frame, const FrameMeta& meta, const QString& reason, const QString& tag);
+    void finishEvent();
+    void clearBuffer();
+    double bufferFps() const;
+
+    FrameRing* m_ring;
+    std::unique_ptr<VideoRecorder> m_writer; // 片段寫出（只由擷取線程操作）
+    int m_consumerId = -1;
+
+    std::thread m_thread;
+    std::atomic<bool> m_running{false};
+    std::atomic<bool> m_capturing{false};
+
+    // 觸發請求（任意線程寫入，擷取線程取走）
+    std::mutex m_triggerMutex;
+    bool m_triggerPending = false;
+    QString m_pendingReason;
+    QString m_pendingTag;
+
+    // 預觸發緩衝（只由擷取線程使用）
+    std::deque<BufferedFrame> m_buffer;
+    std::vector<std::vector<uchar>> m_spareJpeg; // 淘汰的壓縮緩衝，重用避免配置
+    size_t m_bufferBytes = 0;
+    std::atomic<qint64> m_bufferedUs{0};
+    std::atomic<int> m_bufferedFrames{0};
+
+    // 設定（start() 時讀取）
+    qint64 m_preTriggerUs = 0;
+    qint64 m_postTriggerUs = 0;
+    size_t m_maxBufferBytes = 0;
+    std::vector<int> m_jpegParams;
+
+    // 進行中的片段
+    qint64 m_postUntilUs = 0;
+    int m_eventPreFrames = 0;
+    QString m_eventPath;
+
+    // 光柵爆量偵測（呼叫端線程）
+    std::deque<qint64> m_gateCrossingsMs;
+};
+
+} // namespace basler
+
+Q_DECLARE_METATYPE(basler::EventTrigger)
+
+#endif // EVENT_RECORDER_H
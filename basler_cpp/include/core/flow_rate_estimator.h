@@ -0,0 +1,104 @@
+#ifndef FLOW_RATE_ESTIMATOR_H
+#define FLOW_RATE_ESTIMATOR_H
+
+#include <array>
+#include <cstdint>
+
+namespace basler
+{
+
+    enum class VibratorSpeed;
+
+    /**
+     * @brief 落料速率估計（每個震動機速度檔位各自量測）
+     *
+     * 由光柵計數的時間戳累積：相鄰兩次計數都在同一速度檔位、且第一筆在速度切換
+     * settleMs 之後，才把間隔計入該檔位的 EWMA（切換後的過渡流量不代表該檔位）。
+     * 學到的速率跨包保留；resetRun() 只清除上一筆計數，避免換包的停機時間被當成間隔。
+     */
+    class FlowRateEstimator
+    {
+    public:
+        static constexpr int LEVELS = 4; // FULL / MEDIUM / SLOW / CREEP
+
+        /**
+         * @param alpha EWMA 係數（0-1，越大越跟隨最近的間隔）
+         * @param settleMs 速度切換後流量穩定所需時間
+         * @param minSamples 檔位至少累積幾個間隔才視為已量測
+         */
+        void configure(double alpha, int settleMs, int minSamples);
+
+        /**
+         * @brief 記錄指令速度切換（STOP 也要記錄，之後的間隔不計入任何檔位）
+         */
+        void setSpeed(VibratorSpeed speed, int64_t timestampNs);
+
+        /**
+         * @brief 記錄一次光柵計數
+         */
+        void recordCrossing(int64_t timestampNs);
+
+        void resetRun();
+        void clear();
+
+        /**
+         * @brief 該檔位的落料速率（顆/秒）
+         *
+         * 未量測的檔位以最近的較快已量測檔位依速度比例外推（震動機有啟動死區，
+         * 線性外推會高估慢檔位的速率，排程因而偏保守）；沒有較快的量測值時回傳 0。
+         */
+        double rate(VibratorSpeed speed) const;
+
+        /**
+         * @brief FULL 檔位已量測（所有檔位皆可估計）
+         */
+        bool ready() const;
+
+        int samples(VibratorSpeed speed) const;
+
+    private:
+        static int levelOf(VibratorSpeed speed); // -1 = STOP / 非檔位值
+
+        double m_alpha = 0.2;
+        int64_t m_settleNs = 300000000;
+        int m_minSamples = 3;
+
+        std::array<double, LEVELS> m_intervalSec{}; // EWMA 計數間隔
+        std::array<int, LEVELS> m_samples{};
+        int m_level = -1;
+        int64_t m_levelSinceNs = 0;
+        int64_t m_lastCrossingNs = 0;
+        int m_lastCrossingLevel = -1;
+    };
+
+    /**
+     * @brief 預測式排程的結果
+     */
+    struct PredictiveSpeedPlan
+    {
+        VibratorSpeed speed;
+        double timeToTargetSec = 0.0; // 依各檔位速率預估的剩餘時間
+    };
+
+    /**
+     * @brief 依預估的剩餘時間選擇震動機速度（未達目標時；達標由呼叫端改為 STOP）
+     *
+     * 降速指令發出後，在 leadSec（計數→致動延遲 + 流量穩定時間）內仍以原速率落料。
+     * 選擇滿足下式的最快檔位：
+     *     remaining > rate(檔位) × leadSec × safetyFactor + creepReserve
+     * 也就是現在立即切到 CREEP 時，過渡期的落料之後還剩 creepReserve 顆以 CREEP 完成，
+     * 達標時流量已穩定在 CREEP，停止的過衝與閾值模式相同，但高速檔位維持得更久。
+     *
+     * @param estimator 已 ready() 的估計器
+     * @param count 目前計數
+     * @param target 目標數量
+     * @param creepReserve 以 CREEP 落料的最少顆數
+     * @param leadSec 降速指令到流量穩定的時間（秒）
+     * @param safetyFactor 過渡期落料數的安全係數（>= 1）
+     */
+    PredictiveSpeedPlan predictiveSpeedFor(const FlowRateEstimator &estimator, int count, int target,
+                                           int creepReserve, double leadSec, double safetyFactor);
+
+} // namespace basler
+
+#endif // FLOW_RATE_ESTIMATOR_H
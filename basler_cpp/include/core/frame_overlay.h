@@ -0,0 +1,61 @@
+#ifndef FRAME_OVERLAY_H
+#define FRAME_OVERLAY_H
+
+#include <QPoint>
+#include <QRect>
+#include <QString>
+#include <vector>
+#include <opencv2/core.hpp>
+
+namespace basler {
+
+/**
+ * @brief 疊加在顯示幀上的檢測資訊（影像原始座標）
+ *
+ * 由 DetectionController::processFrame 以資料形式產生，不複製、不繪製幀。
+ * VideoDisplayWidget 以顯示頻率繪製：GPU 路徑把框線當頂點資料，CPU 路徑以 QPainter 繪製；
+ * 只有需要「燒入」的輸出（錄影 burnInOverlay、舊版 processFrame）才呼叫 burnInOverlay()。
+ */
+struct FrameOverlay {
+    struct Box {
+        QRect rect;
+        QPoint center;
+        int area = 0;         // 標籤（面積）
+        bool crossed = false; // 中心已越過光柵線
+    };
+
+    // 多料道模式：每條料道自己的 ROI 與光柵線（此時 roi 為空、showGateLine 為 false）
+    struct Lane {
+        QRect roi;
+        int gateLineY = -1;   // 只畫在料道 ROI 的寬度內
+        int counted = 0;
+        int targetCount = 0;
+    };
+
+    QRect roi;                // 空 = 不顯示
+    int gateLineY = -1;
+    bool showGateLine = false; // 光柵計數啟用且 gateLineY > 0 時顯示
+    int frameWidth = 0;        // 光柵線長度
+    std::vector<Box> boxes;
+    std::vector<Lane> lanes;
+
+    // 計數摘要
+    QString mode;             // "Classical" / "YOLO"；空 = 不顯示摘要
+    int detections = 0;
+    int counted = 0;
+    double yoloInferenceMs = -1.0; // < 0 = 不顯示
+
+    bool isEmpty() const
+    {
+        return roi.isEmpty() && !showGateLine && boxes.empty() && lanes.empty() && mode.isEmpty();
+    }
+};
+
+/**
+ * @brief 把 overlay 繪製到幀上（與舊版 drawDetectionResults 的輸出相同）
+ */
+void burnInOverlay(cv::Mat& frame, const FrameOverlay& overlay);
+
+} // namespace basler
+
+#endif // FRAME_OVERLAY_H
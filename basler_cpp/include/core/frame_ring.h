@@ -0,0 +1,245 @@
+#ifndef FRAME_RING_H
+#define FRAME_RING_H
+
+#include <QString>
+#include <QMutex>
+#include <QtGlobal>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <opencv2/core.hpp>
+
+namespace basler
+{
+
+    /**
+     * @brief 幀在完整感測器上的位置（相機端 AOI 裁切）
+     *
+     * 相機只傳 AOI 時，幀左上角對應感測器 (offsetX, offsetY)；
+     * sensorWidth / sensorHeight 為 0 表示來源不提供（影片、合成幀），幀本身即完整影像。
+     */
+    struct SensorWindow
+    {
+        int offsetX = 0;
+        int offsetY = 0;
+        int sensorWidth = 0;
+        int sensorHeight = 0;
+
+        bool isValid() const { return sensorWidth > 0 && sensorHeight > 0; }
+        bool operator==(const SensorWindow &other) const
+        {
+            return offsetX == other.offsetX && offsetY == other.offsetY &&
+                   sensorWidth == other.sensorWidth && sensorHeight == other.sensorHeight;
+        }
+        bool operator!=(const SensorWindow &other) const { return !(*this == other); }
+    };
+
+    /**
+     * @brief 幀中繼資料（與像素一起存放在環形緩衝槽位中）
+     */
+    struct FrameMeta
+    {
+        quint64 sequence = 0;  // 發布序號（由 FrameRing 指派，從 1 開始單調遞增）
+        qint64 timestampUs = 0; // 擷取時間戳（微秒，steady clock）
+        quint64 blockId = 0;    // 相機區塊 ID（Pylon GetBlockID；0 = 來源不提供）
+        quint64 deviceTimestamp = 0; // 相機時間戳（Pylon GetTimeStamp，相機時鐘 tick；0 = 不提供）
+        float exposureUs = 0.0f;     // 曝光時間（微秒；0 = 不提供）
+        SensorWindow window;         // 感測器 AOI（相機端裁切時的幀位置）
+    };
+
+    /**
+     * @brief 無鎖單生產者 / 多消費者幀環形緩衝
+     *
+     * 取代「GrabWorker clone → 信號 → MainWindow clone → updateDisplay clone」的三次深拷貝：
+     * 1. 生產者（GrabWorker / VideoPlayWorker）將幀複製進預先配置的槽位（尺寸不變時零配置）
+     * 2. 每個槽位以 seqlock 保護：寫入中版本號為奇數，讀取前後版本號一致才算成功
+     * 3. 檢測、錄影等消費者各自持有游標，依自身步調讀取；被覆寫的幀計入該消費者的丟幀數
+     * 4. 顯示只需要最新幀，使用 readLatest()，不佔用消費者槽位
+     * 5. 零拷貝：publishShared() 讓槽位直接引用來源幀（例如包裝 Pylon 緩衝的 cv::Mat），
+     *    生產者端完全不複製；被覆寫的引用在沒有讀者進行中時才釋放
+     * 6. 無損消費者：生產者以 waitForSpace() 等待其讀完，發布絕不覆寫它尚未讀取的幀
+     *
+     * 限制：同一時間只能有一個線程呼叫 publish() / publishShared() / reserve() / detachSharedFrames()。
+     */
+    class FrameRing
+    {
+    public:
+        static constexpr int MAX_CONSUMERS = 4;
+        static constexpr int MAX_DEFERRED_RELEASES = 4; // 零拷貝引用延遲釋放上限（生產者額外持有的來源緩衝）
+
+        explicit FrameRing(int capacity = 32);
+        ~FrameRing() = default;
+
+        // 禁止複製
+        FrameRing(const FrameRing &) = delete;
+        FrameRing &operator=(const FrameRing &) = delete;
+
+        // ===== 生產者 =====
+        /**
+         * @brief 發布一幀（只允許單一線程呼叫）
+         * @param frame 來源幀（會被複製進槽位，呼叫後可立即重用）
+         * @param timestampUs 擷取時間戳（微秒）
+         * @param blockId 相機區塊 ID（0 = 不提供）
+         * @param deviceTimestamp 相機時間戳（0 = 不提供）
+         * @param exposureUs 曝光時間（0 = 不提供）
+         * @param window 幀在感測器上的位置（預設 = 幀即完整影像）
+         * @return 指派的序號
+         */
+        quint64 publish(const cv::Mat &frame, qint64 timestampUs, quint64 blockId = 0,
+                        quint64 deviceTimestamp = 0, float exposureUs = 0.0f,
+                        const SensorWindow &window = SensorWindow());
+
+        /**
+         * @brief 零拷貝發布一幀（只允許單一線程呼叫）
+         * @param frame 來源幀；槽位持有其引用計數，直到被覆寫或 detachSharedFrames()
+         * @param timestampUs 擷取時間戳（微秒）
+         * @param blockId 相機區塊 ID（0 = 不提供）
+         * @return 指派的序號
+         *
+         * 被覆寫的引用在沒有讀者進行中時釋放；生產者最多額外持有
+         * MAX_DEFERRED_RELEASES 個，超過時短暫等待讀者結束。
+         */
+        quint64 publishShared(const cv::Mat &frame, qint64 timestampUs, quint64 blockId = 0,
+                              quint64 deviceTimestamp = 0, float exposureUs = 0.0f,
+                              const SensorWindow &window = SensorWindow());
+
+        /**
+         * @brief 等待所有無損消費者讓出空間（生產者在 publish 前呼叫）
+         * @return timeoutMs 內下一次發布是否不會覆寫無損消費者未讀的幀
+         */
+        bool waitForSpace(int timeoutMs) const;
+
+        /**
+         * @brief 依幀尺寸預先配置所有槽位（複製模式的固定回收緩衝池，抓取中不再配置）
+         */
+        void reserve(int rows, int cols, int type);
+
+        /**
+         * @brief 將所有零拷貝槽位轉為自有緩衝並釋放來源引用
+         *
+         * 生產者停止前呼叫（例如 StopGrabbing 前歸還 Pylon 緩衝）；最新幀仍可供顯示。
+         * 會等待進行中的讀取結束。
+         */
+        void detachSharedFrames();
+
+        /**
+         * @brief 目前 steady clock 時間（微秒），供生產者標記幀時間戳
+         */
+        static qint64 steadyTimestampUs();
+
+        // ===== 消費者 =====
+        /**
+         * @brief 註冊消費者
+         * @param name 名稱（統計顯示用）
+         * @param lossless 無損消費者：生產者會等待它，而不是覆寫未讀幀
+         * @return 消費者 ID；槽位已滿時回傳 -1
+         *
+         * 新消費者從下一個發布的幀開始讀取。
+         */
+        int registerConsumer(const QString &name, bool lossless = false);
+        void unregisterConsumer(int consumerId);
+
+        /**
+         * @brief 依序讀取下一幀
+         * @param consumerId 消費者 ID
+         * @param[out] out 輸出幀（尺寸不變時重用原有緩衝）
+         * @param[out] meta 幀中繼資料
+         * @return 是否讀到幀；落後超過容量時自動跳到最舊可讀幀並累計丟幀
+         */
+        bool read(int consumerId, cv::Mat &out, FrameMeta &meta);
+
+        /**
+         * @brief 等待該消費者有新幀可讀
+         * @return timeoutMs 內是否有新幀
+         */
+        bool waitForFrame(int consumerId, int timeoutMs) const;
+
+        /**
+         * @brief 游標跳到最新位置（消費者暫停處理時使用，跳過的幀不計為丟幀）
+         */
+        void skipToLatest(int consumerId);
+
+        /**
+         * @brief 略過下一幀（不複製、不計為丟幀；skipFrames 降頻使用）
+         * @return 是否有幀可略過
+         */
+        bool skipFrame(int consumerId);
+
+        /**
+         * @brief 讀取最新一幀（顯示用，不需註冊）
+         * @param afterSequence 只有序號大於此值時才複製
+         * @return 是否讀到新幀
+         */
+        bool readLatest(cv::Mat &out, FrameMeta &meta, quint64 afterSequence = 0) const;
+
+        // ===== 統計 =====
+        int capacity() const { return m_capacity; }
+        quint64 latestSequence() const { return m_head.load(std::memory_order_acquire); }
+        quint64 droppedFrames(int consumerId) const;
+        quint64 consumedFrames(int consumerId) const;
+        QString consumerName(int consumerId) const;
+        bool isConsumerActive(int consumerId) const;
+
+    private:
+        struct Slot
+        {
+            std::atomic<quint64> version{0}; // seqlock：奇數 = 寫入中
+            std::atomic<quint64> sequence{0};
+            std::atomic<qint64> timestampUs{0};
+            std::atomic<quint64> blockId{0};
+            std::atomic<quint64> deviceTimestamp{0};
+            std::atomic<float> exposureUs{0.0f};
+            std::atomic<int> windowOffsetX{0};
+            std::atomic<int> windowOffsetY{0};
+            std::atomic<int> sensorWidth{0};
+            std::atomic<int> sensorHeight{0};
+            std::atomic<int> rows{0};
+            std::atomic<int> cols{0};
+            std::atomic<int> type{0};
+            std::atomic<size_t> step{0};
+            std::atomic<uchar *> data{nullptr};
+            std::vector<uchar> storage; // 只由生產者存取
+            cv::Mat shared;             // 零拷貝引用（只由生產者存取）
+        };
+
+        struct Consumer
+        {
+            std::atomic<bool> active{false};
+            std::atomic<bool> lossless{false};
+            std::atomic<quint64> cursor{0}; // 下一個要讀的序號
+            std::atomic<quint64> dropped{0};
+            std::atomic<quint64> consumed{0};
+            QString name;
+        };
+
+        quint64 beginWrite(Slot &slot);
+        void commitWrite(Slot &slot, quint64 version, const FrameMeta &meta,
+                         int rows, int cols, int type, uchar *data, size_t step);
+        uchar *ensureStorage(Slot &slot, size_t totalBytes);
+        void releaseShared(cv::Mat &&frame);
+        void dropRetiredStorage();
+        void waitForReaders() const;
+        bool copySlot(quint64 sequence, cv::Mat &out, FrameMeta &meta) const;
+        bool isValidConsumer(int consumerId) const;
+
+        const int m_capacity;
+        std::unique_ptr<Slot[]> m_slots;
+        std::array<Consumer, MAX_CONSUMERS> m_consumers;
+        std::atomic<quint64> m_head{0}; // 最新已完成發布的序號
+
+        // 槽位擴容時舊緩衝移到這裡保留，避免正在讀取的消費者存取已釋放記憶體；
+        // 沒有讀者、且已沒有槽位指向它時由生產者釋放（dropRetiredStorage）
+        std::vector<std::vector<uchar>> m_retiredStorage;
+
+        // 零拷貝引用的延遲釋放：覆寫時若有讀者正在複製，先保留到下一次無讀者時
+        mutable std::atomic<int> m_activeReaders{0};
+        std::vector<cv::Mat> m_deferredReleases;
+
+        // 只保護消費者註冊（非熱路徑）
+        mutable QMutex m_registryMutex;
+    };
+
+} // namespace basler
+
+#endif // FRAME_RING_H
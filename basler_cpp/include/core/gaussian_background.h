@@ -0,0 +1,52 @@
+#ifndef GAUSSIAN_BACKGROUND_H
+#define GAUSSIAN_BACKGROUND_H
+
+#include <opencv2/core.hpp>
+#include <opencv2/video/background_segm.hpp>
+
+namespace basler
+{
+
+    /**
+     * @brief 單高斯背景模型（mono8 固定背景專用的輕量替代 MOG2）
+     *
+     * 每像素只維護一個高斯（平均值 + 變異數），狀態為兩張 uint16 定點圖（Q8.8）：
+     * - 前景判斷：(I - μ)² > varThreshold · σ²（與 MOG2 的 varThreshold 同義）
+     * - 更新：μ += α(I - μ)、σ² += α((I - μ)² - σ²)，σ² 夾在 [4, 75]（MOG2 預設範圍）
+     * - 學習率以 Q0.15 定點套用（0 < α < 1/32768 以 1/32768 計），0 = 凍結模型、負值 = 1 / history（同 MOG2）；
+     *   α 很小時 μ 的定點殘差約 ±2 灰階，仍遠小於 varThreshold · σ² 的判斷範圍
+     * - 核心以 CV_SIMD128 一次處理 8 像素，全程 int32 運算不溢位
+     *
+     * 輸出遮罩只有 0 / 255（不做陰影偵測）；多通道輸入先轉灰階。
+     * 輸入尺寸改變時重新以當前幀初始化（第一幀輸出全背景）。
+     */
+    class GaussianBackgroundSubtractor : public cv::BackgroundSubtractor
+    {
+    public:
+        static constexpr int VAR_INIT = 15;
+        static constexpr int VAR_MIN = 4;
+        static constexpr int VAR_MAX = 75;
+
+        GaussianBackgroundSubtractor(int history, double varThreshold);
+
+        void apply(cv::InputArray image, cv::OutputArray fgmask, double learningRate = -1) override;
+        void getBackgroundImage(cv::OutputArray backgroundImage) const override;
+
+    private:
+        void initialize(const cv::Mat &gray);
+
+        int m_history;
+        int m_thresholdQ8; // varThreshold · 256
+        cv::Mat m_mean;    // CV_16UC1，Q8.8
+        cv::Mat m_var;     // CV_16UC1，Q8.8
+        cv::Mat m_gray;    // 多通道輸入的灰階緩衝
+    };
+
+    /**
+     * @brief 建立單高斯背景模型
+     */
+    cv::Ptr<GaussianBackgroundSubtractor> createGaussianBackgroundSubtractor(int history, double varThreshold);
+
+} // namespace basler
+
+#endif // GAUSSIAN_BACKGROUND_H
@@ -0,0 +1,90 @@
+#ifndef INFERENCE_BACKEND_H
+#define INFERENCE_BACKEND_H
+
+#include <opencv2/core.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace basler
+{
+
+    /**
+     * @brief 模型權重精度（tools/export_onnx.py --precision 產生）
+     *
+     * 量化模型的輸入輸出仍為 float32，前後處理不變；精度只影響後端的目標裝置選擇。
+     */
+    enum class ModelPrecision
+    {
+        FP32,
+        FP16,
+        INT8
+    };
+
+    /**
+     * @brief 依檔名後綴判斷精度（xxx.fp16.onnx / xxx.int8.onnx，其餘視為 FP32）
+     */
+    ModelPrecision detectModelPrecision(const std::string &modelPath);
+
+    const char *modelPrecisionName(ModelPrecision precision);
+
+    /**
+     * @brief YOLO 推理後端介面
+     *
+     * YoloDetector 負責前處理（letterbox → blob）與後處理（NMS → 座標反映射），
+     * 後端只負責「NCHW float blob → 原始輸出 tensor」：
+     * - opencv       cv::dnn（CUDA → CPU 自動回退），永遠可用
+     * - onnxruntime  ONNX Runtime（CPU / CUDA / TensorRT 執行提供者），需 WITH_ONNXRUNTIME 編譯
+     * - openvino     OpenVINO（CPU / GPU / AUTO），需 WITH_OPENVINO 編譯
+     *
+     * 線程安全：實作本身不加鎖，由 YoloDetector 的 m_netMutex 序列化呼叫。
+     * 錯誤處理：load() 回傳 false；infer() 失敗時拋出 std::exception 衍生例外。
+     */
+    class InferenceBackend
+    {
+    public:
+        virtual ~InferenceBackend() = default;
+
+        /**
+         * @brief 後端名稱（與 YoloConfig::backend 相同的字串）
+         */
+        virtual const char *name() const = 0;
+
+        /**
+         * @brief 載入 ONNX 模型
+         * @param modelPath ONNX 檔案路徑
+         * @param device 裝置提示（"auto" / "cpu" / "cuda" / "tensorrt" / "gpu"，依後端解讀）
+         * @param precision 模型精度（決定 FP16 / INT8 的執行目標）
+         */
+        virtual bool load(const std::string &modelPath, const std::string &device,
+                          ModelPrecision precision) = 0;
+
+        /**
+         * @brief 模型輸入是否可能接受 batch > 1
+         *
+         * 回傳 true 只代表值得嘗試；實際失敗時 YoloDetector 會改為逐張推理。
+         */
+        virtual bool supportsBatch() const { return true; }
+
+        /**
+         * @brief 執行推理
+         * @param blob NCHW CV_32F 輸入
+         * @param output 輸出 tensor（YOLOv8：[N, 4 + 類別數, anchors]，CV_32F）；
+         *               內容可能引用後端內部緩衝，下一次 infer() 前有效
+         */
+        virtual void infer(const cv::Mat &blob, cv::Mat &output) = 0;
+    };
+
+    /**
+     * @brief 依名稱建立後端；名稱未知或未編譯進來時回退為 opencv
+     */
+    std::unique_ptr<InferenceBackend> createInferenceBackend(const std::string &name);
+
+    /**
+     * @brief 此建置可用的後端名稱
+     */
+    std::vector<std::string> availableInferenceBackends();
+
+} // namespace basler
+
+#endif // INFERENCE_BACKEND_H
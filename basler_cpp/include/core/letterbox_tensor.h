@@ -0,0 +1,88 @@
+#ifndef LETTERBOX_TENSOR_H
+#define LETTERBOX_TENSOR_H
+
+#include <opencv2/core.hpp>
+#include <vector>
+
+namespace basler
+{
+
+    /**
+     * @brief 持久化 NCHW 輸入 tensor + 單次掃描 letterbox 前處理
+     *
+     * 取代「ROI 放大 → letterbox 新 Mat → blobFromImage」三次整圖掃描與三次配置：
+     * 1. 放大與 letterbox 縮放合成一個比例，ROI 像素以雙線性取樣直接寫進 float 平面，
+     *    同一次掃描完成 BGR → RGB 與 0~1 正規化（灰階 ROI 複製到三個平面）
+     * 2. 填充區（灰 114）只在槽位的幾何（尺寸、填充、內容區）改變時重寫；
+     *    640×120 ROI 條帶的 letterbox 大部分是填充，穩態每幀只寫內容區
+     * 3. tensor 依 [批次, 3, size, size] 配置一次；view() 回傳前 n 張的 NCHW 標頭，不複製
+     * 4. 取樣表依（來源寬高、內容寬高）快取
+     */
+    class LetterboxTensor
+    {
+    public:
+        /**
+         * @brief 單張的反映射資訊（與原 letterbox() 相同的定義：ratio 相對於放大後影像）
+         */
+        struct Geometry
+        {
+            double ratio = 1.0;
+            int padX = 0;
+            int padY = 0;
+            int contentWidth = 0;
+            int contentHeight = 0;
+        };
+
+        /**
+         * @brief 確保容量；size 改變時重新配置，只增加批次數時保留既有內容
+         */
+        void reserve(int batch, int size);
+
+        int size() const { return m_size; }
+        int capacity() const { return m_batch; }
+
+        /**
+         * @brief 將 ROI 寫入 slot
+         * @param roi CV_8UC1 / CV_8UC3（BGR）/ CV_8UC4（BGRA，忽略 alpha）
+         * @param upscaleFactor ROI 放大倍數（<= 1 不放大）
+         */
+        Geometry fill(int slot, const cv::Mat &roi, double upscaleFactor);
+
+        /**
+         * @brief [count, 3, size, size] CV_32F 標頭（共用資料）
+         */
+        cv::Mat view(int first, int count) const;
+
+    private:
+        struct SlotState
+        {
+            int padX = -1;
+            int padY = -1;
+            int contentWidth = -1;
+            int contentHeight = -1;
+        };
+
+        // 單軸取樣表：目標座標 → 兩個來源索引與權重
+        struct AxisTable
+        {
+            int srcLength = -1;
+            int dstLength = -1;
+            std::vector<int> index0;
+            std::vector<int> index1;
+            std::vector<float> weight;
+        };
+
+        static void buildAxis(AxisTable &table, int srcLength, int dstLength);
+        float *plane(int slot, int channel) const;
+
+        cv::Mat m_tensor;
+        int m_batch = 0;
+        int m_size = 0;
+        std::vector<SlotState> m_slots;
+        AxisTable m_xTable;
+        AxisTable m_yTable;
+    };
+
+} // namespace basler
+
+#endif // LETTERBOX_TENSOR_H
@@ -0,0 +1,152 @@
+#ifndef METRICS_SERVER_H
+#define METRICS_SERVER_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "core/stage_profiler.h"
+
+namespace basler
+{
+
+    using MetricLabels = std::vector<std::pair<std::string, std::string>>;
+
+    /**
+     * @brief 指標文字輸出（Prometheus 0.0.4 / OpenMetrics 1.0）
+     *
+     * 收集器依任意順序寫入樣本；同名的樣本依 family 分組後輸出（兩種格式都要求同一 family 連續）。
+     * counter 的 family 名稱不含 _total，樣本自動加上。
+     */
+    class MetricsWriter
+    {
+    public:
+        void gauge(const std::string &name, const std::string &help, const MetricLabels &labels, double value);
+        void counter(const std::string &name, const std::string &help, const MetricLabels &labels, double value);
+
+        /**
+         * @brief 累計延遲直方圖（秒）；LatencyHistogram 的對數桶依固定的 le 邊界彙總
+         */
+        void histogram(const std::string &name, const std::string &help, const MetricLabels &labels,
+                       const LatencyHistogram &histogram);
+
+        /**
+         * @brief 所有收集器共用的標籤（例如 station），加在每個樣本最前面
+         */
+        void setCommonLabels(const MetricLabels &labels) { m_common = labels; }
+
+        std::string render(bool openMetrics) const;
+
+    private:
+        struct Family
+        {
+            std::string type;
+            std::string help;
+            std::vector<std::string> lines; // 完整樣本行（名稱{標籤} 值）
+        };
+
+        Family &family(const std::string &name, const char *type, const std::string &help);
+        std::string labelText(const MetricLabels &labels, const char *extraKey = nullptr,
+                              const std::string &extraValue = std::string()) const;
+
+        std::map<std::string, Family> m_families;
+        std::vector<std::string> m_order; // family 首次出現的順序
+        MetricLabels m_common;
+    };
+
+    /**
+     * @brief 單寫者 seqlock 發布的直方圖
+     *
+     * 寫入端（檢測線程）每個統計窗口發布一次累計值；讀取端（指標線程）讀到寫入中或前後不一致的
+     * 版本號時重試。欄位都是 relaxed 原子，讀寫互不阻塞，也沒有資料競爭。
+     */
+    class SeqlockHistogram
+    {
+    public:
+        void publish(const LatencyHistogram &histogram);
+        LatencyHistogram load() const;
+
+    private:
+        std::atomic<uint32_t> m_version{0}; // 奇數 = 寫入中
+        std::array<std::atomic<uint32_t>, LatencyHistogram::BUCKETS> m_counts{};
+        std::atomic<uint64_t> m_count{0};
+        std::atomic<uint64_t> m_sumNs{0};
+        std::atomic<uint64_t> m_maxNs{0};
+    };
+
+    /**
+     * @brief 程序內的指標收集器登錄
+     *
+     * 收集器在指標線程（每次抓取）呼叫，只能讀取原子變數 / seqlock 快照，
+     * 不可取用檢測端的互斥鎖（DetectionController::m_mutex 等）。
+     * 登錄 / 移除與抓取互斥，移除返回後收集器不會再被呼叫。
+     */
+    class MetricsRegistry
+    {
+    public:
+        using Collector = std::function<void(MetricsWriter &)>;
+
+        static MetricsRegistry &instance();
+
+        int addCollector(Collector collector);
+        void removeCollector(int id);
+
+        void setCommonLabels(const MetricLabels &labels);
+
+        std::string render(bool openMetrics) const;
+
+    private:
+        MetricsRegistry() = default;
+
+        mutable std::mutex m_mutex;
+        std::map<int, Collector> m_collectors;
+        MetricLabels m_common;
+        int m_nextId = 1;
+    };
+
+    /**
+     * @brief 內嵌 HTTP 指標端點（專用線程，阻塞式 socket + poll）
+     *
+     * GET /metrics 回傳 MetricsRegistry 的內容：Accept 含 application/openmetrics-text 時以 OpenMetrics 輸出，
+     * 否則為 Prometheus 文字格式。每個連線處理一個請求後關閉；不經 Qt 事件循環，無頭站台也能使用。
+     */
+    class MetricsServer
+    {
+    public:
+        MetricsServer() = default;
+        ~MetricsServer();
+
+        MetricsServer(const MetricsServer &) = delete;
+        MetricsServer &operator=(const MetricsServer &) = delete;
+
+        /**
+         * @return 是否已開始監聽（位址無效或埠被占用時回傳 false）
+         */
+        bool start(const std::string &bindAddress, int port);
+        void stop();
+        bool isRunning() const { return m_running.load(); }
+        int port() const { return m_port; }
+
+        uint64_t scrapes() const { return m_scrapes.load(std::memory_order_relaxed); }
+
+    private:
+        void serveLoop();
+        void handleConnection(intptr_t client);
+
+        std::thread m_thread;
+        std::atomic<bool> m_running{false};
+        intptr_t m_listenSocket = -1;
+        int m_port = 0;
+        std::atomic<uint64_t> m_scrapes{0};
+    };
+
+} // namespace basler
+
+#endif // METRICS_SERVER_H
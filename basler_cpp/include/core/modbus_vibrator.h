@@ -0,0 +1,79 @@
+#ifndef MODBUS_VIBRATOR_H
+#define MODBUS_VIBRATOR_H
+
+#include <QByteArray>
+#include <QString>
+#include <QtGlobal>
+#include <memory>
+
+#include "core/stage_profiler.h"
+#include "core/vibrator_controller.h"
+
+namespace basler {
+
+struct VibratorConfig;
+class ModbusLink;
+
+/**
+ * @brief Modbus RTU CRC-16（多項式 0xA001，初值 0xFFFF；低位元組先送）
+ */
+quint16 modbusCrc16(const QByteArray& data);
+
+/**
+ * @brief 單一震動機的指令統計（快照值）
+ */
+struct ModbusCommandStats {
+    LatencyHistogram roundTrip;  // 成功請求的往返時間（送出 → 收到完整回應）
+    quint64 commands = 0;        // 成功的寫入請求
+    quint64 retries = 0;         // 重試次數
+    quint64 failures = 0;        // 重試用盡的指令
+    quint64 coalesced = 0;       // 尚未送出就被新設定值取代的指令
+    double lastRoundTripUs = 0.0;
+    bool linkUp = false;         // 最近一次請求是否成功
+};
+
+/**
+ * @brief Modbus 震動機驅動（RTU over RS-485 / TCP）
+ *
+ * 同一條鏈路（序列埠或 TCP 端點）上的震動機共用一個 ModbusLink，鏈路擁有自己的 I/O 線程，
+ * 序列埠 / socket 只在該線程建立與讀寫：
+ * 1. start() / stop() / setSpeedPercent() 只更新設定值並喚醒 I/O 線程，立即返回，
+ *    檢測、即時控制與 UI 線程都不會碰到阻塞的 I/O
+ * 2. 指令合併：I/O 線程每次取用最新設定值，中間被覆蓋的設定值不送出（只有最新速度有意義）
+ * 3. 每個寫入請求最多重試 maxRetries 次（失敗時重新開啟連線），用盡後發出 error，
+ *    retryBackoffMs 後以當時的最新設定值再送
+ * 4. 無新指令時每 refreshIntervalMs 重送目前設定值（配合驅動器的通訊中斷保護）
+ *
+ * 寫入以 FC06（寫單一保持暫存器）：速度暫存器 = percent × speedFullScale / 100，
+ * 運轉暫存器 = 1 / 0（runRegister < 0 時以速度 0 表示停止）。
+ */
+class ModbusVibratorController : public VibratorControllerBase {
+    Q_OBJECT
+
+public:
+    /**
+     * @param tcp true = Modbus TCP（host:tcpPort），false = Modbus RTU（serialPort）
+     * @param unitId 站號（1-247）
+     */
+    ModbusVibratorController(const QString& name, const VibratorConfig& config, bool tcp, int unitId,
+                             QObject* parent = nullptr);
+    ~ModbusVibratorController() override;
+
+    int unitId() const { return m_unitId; }
+    QString endpoint() const;
+    ModbusCommandStats commandStats() const;
+
+public slots:
+    void start() override;
+    void stop() override;
+    void setSpeedPercent(int percent) override;
+
+private:
+    std::shared_ptr<ModbusLink> m_link;
+    int m_slot = -1;
+    int m_unitId = 1;
+};
+
+} // namespace basler
+
+#endif // MODBUS_VIBRATOR_H
@@ -0,0 +1,166 @@
+#ifndef MULTI_PIPELINE_H
+#define MULTI_PIPELINE_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QThread>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "config/settings.h"
+#include "core/detection_controller.h"
+
+namespace basler
+{
+
+    class SourceManager;
+    class DetectionWorker;
+    class DualVibratorManager;
+    class PipelineTelemetry;
+    class YoloInferencePool;
+
+    /**
+     * @brief 單一程序內的多相機檢測引擎
+     *
+     * 每台相機（MultiCameraConfig::cameras 的一項）一條獨立管線：
+     * SourceManager（自己的 FrameRing 與抓取線程）→ DetectionWorker（自己的檢測線程）→ DetectionController（自己的計數）。
+     * 管線之間不共用任何每幀狀態，只共用：
+     * 1. YoloInferencePool：模型只載入 inferenceWorkers 份，各檢測線程排隊取用
+     * 2. 料道彙總：同一料道（lane）的相機計數相加，依 PackagingConfig 的閾值決定該料道震動機速度，
+     *    交給 DualVibratorManager::setLaneSpeed（料道 0 / 1 = 震動機 1 / 2）
+     *
+     * 抓取與檢測線程在啟動時綁定到各自的核心（CameraPipelineConfig 指定，或 autoAssignCores 依序分配）。
+     * 影片來源的播放由 VideoPlayer 自行排程，不綁核。
+     *
+     * 各管線的 DetectionController 不啟用自己的包裝模式；包裝完成與速度變化只在料道層級判斷。
+     * 引擎本身、SourceManager 與 DetectionController 都屬於建立引擎的線程（需有事件循環）。
+     */
+    class MultiPipelineEngine : public QObject
+    {
+        Q_OBJECT
+
+    public:
+        explicit MultiPipelineEngine(QObject *parent = nullptr);
+        ~MultiPipelineEngine();
+
+        // 禁止複製
+        MultiPipelineEngine(const MultiPipelineEngine &) = delete;
+        MultiPipelineEngine &operator=(const MultiPipelineEngine &) = delete;
+
+        /**
+         * @brief 依配置建立所有管線（停止狀態下呼叫；會先釋放現有管線）
+         *
+         * 以序號指定的相機會先列舉一次 detectCameras() 換成索引；找不到的相機略過並發出 pipelineError。
+         * @return 是否至少建立了一條管線
+         */
+        bool configure(const MultiCameraConfig &config);
+
+        /**
+         * @brief 指定料道震動機（外部擁有；nullptr = 只計數不控制）
+         */
+        void setVibratorManager(DualVibratorManager *manager) { m_vibrators = manager; }
+
+        // ===== 狀態查詢 =====
+        bool isRunning() const { return m_running; }
+        int pipelineCount() const { return static_cast<int>(m_pipelines.size()); }
+        int laneTotal() const { return static_cast<int>(m_lanes.size()); }
+
+        SourceManager *source(int pipeline) const;
+        DetectionController *controller(int pipeline) const;
+        DetectionWorker *worker(int pipeline) const;
+        QString pipelineName(int pipeline) const;
+        int pipelineLane(int pipeline) const;
+        int countOf(int pipeline) const;
+
+        int laneCount(int lane) const;
+        VibratorSpeed laneSpeed(int lane) const;
+        int totalCount() const;
+
+        YoloInferencePool *inferencePool() const { return m_inferencePool.get(); }
+
+    public slots:
+        /**
+         * @brief 啟動所有管線（連接相機 / 播放影片、啟動檢測線程）
+         */
+        void start();
+
+        /**
+         * @brief 停止所有管線（檢測線程結束後才停止抓取）
+         */
+        void stop();
+
+        /**
+         * @brief 重置所有管線計數與料道包裝狀態
+         */
+        void resetCounts();
+
+        // 料道包裝控制（目標預設為 PackagingConfig::targetCount）
+        void enablePackagingMode(bool enabled);
+        void setLaneTarget(int lane, int target);
+
+    signals:
+        void pipelineCountChanged(int pipeline, int count);
+        void laneCountChanged(int lane, int count);
+        void totalCountChanged(int total);
+        void laneSpeedChanged(int lane, VibratorSpeed speed);
+        void lanePackagingCompleted(int lane, int count);
+        void pipelineError(int pipeline, const QString &message);
+        void runningStateChanged(bool running);
+
+    private:
+        struct Pipeline
+        {
+            CameraPipelineConfig config;
+            QString name;
+            int cameraIndex = -1; // 解析後的相機索引（影片來源為 -1）
+            int grabCore = -1;    // 實際綁定的核心
+            int detectionCore = -1;
+            int count = 0;        // 最近一次 countChanged（引擎線程）
+
+            // 依宣告反序析構：先結束檢測線程，再釋放控制器與源
+            std::unique_ptr<SourceManager> source;
+            std::unique_ptr<DetectionController> controller;
+            std::unique_ptr<QThread> thread;
+            std::unique_ptr<DetectionWorker> worker;
+            std::unique_ptr<PipelineTelemetry> telemetry; // TelemetryConfig::enabled 時建立
+        };
+
+        struct Lane
+        {
+            int count = 0;
+            int target = 0;
+            VibratorSpeed speed = VibratorSpeed::STOP;
+            bool completed = false;
+        };
+
+        void release();
+        void assignCores(const MultiCameraConfig &config);
+        void createPipeline(Pipeline &pipeline, int index);
+        void onPipelineCount(int index, int count);
+        void updateLaneSpeed(int lane);
+
+        // 推理池需晚於所有 DetectionController 析構（先宣告）
+        std::unique_ptr<YoloInferencePool> m_inferencePool;
+        std::thread m_modelLoader; // 推理池的背景模型載入（release 時等待）
+        std::vector<std::unique_ptr<Pipeline>> m_pipelines;
+        std::vector<Lane> m_lanes;
+
+        DualVibratorManager *m_vibrators = nullptr;
+        bool m_packagingEnabled = false;
+        bool m_running = false;
+    };
+
+    /**
+     * @brief 命令列進入點：--multi-camera [--config <json>] [--source <影片|合成序列> ...] [--duration 秒] [--verbose]
+     *
+     * 依 MultiCameraConfig 啟動所有管線（--source 取代配置中的相機，依序分到料道 0 / 1，無相機時驗證用），
+     * 每秒輸出各管線 / 料道計數，--duration 到期（或全部影片播完）後輸出總結。需已建立 QCoreApplication。
+     * @return 程序結束碼（沒有任何管線可啟動時為 1）
+     */
+    int runMultiCamera(const QStringList &arguments);
+
+} // namespace basler
+
+#endif // MULTI_PIPELINE_H
@@ -0,0 +1,53 @@
+#ifndef OFFLINE_REPLAY_H
+#define OFFLINE_REPLAY_H
+
+#include <QString>
+#include <cstdlib>
+#include <QStringList>
+
+#include "core/stage_profiler.h"
+
+namespace basler
+{
+
+    /**
+     * @brief 單一輸入的離線重播結果
+     */
+    struct ReplayResult
+    {
+        QString input;
+        bool ok = false;
+        QString error;
+        int frames = 0;
+        int count = 0;               // 最終計數
+        int truth = -1;              // 真值穿越數（合成序列；其他輸入為 -1）
+        double decodeSeconds = 0.0;  // 讀取 / 解碼耗時
+        double processSeconds = 0.0; // processFrame 耗時
+        double wallSeconds = 0.0;
+        StageLatencySnapshot latency; // 逐階段延遲（整段合併）
+
+        double processingFps() const { return processSeconds > 0 ? frames / processSeconds : 0.0; }
+        double wallFps() const { return wallSeconds > 0 ? frames / wallSeconds : 0.0; }
+        double accuracy() const { return truth > 0 ? 1.0 - std::abs(count - truth) / static_cast<double>(truth) : 1.0; }
+    };
+
+    /**
+     * @brief 無介面離線重播（批次驗證計數準確度與吞吐量）
+     *
+     * 每個輸入（影片檔、原始擷取目錄或 *.synth.json 合成序列）一個 DetectionController，在呼叫線程以最快速度
+     * 依序處理每一幀，不經 FrameRing / MainWindow。配置取自 Settings（需先載入）。
+     */
+    ReplayResult replayInput(const QString &input);
+
+    /**
+     * @brief 命令列進入點：--replay <影片|原始擷取|合成序列> [--replay ...] [--config <json>] [--jobs N] [--verbose]
+     *
+     * 多個輸入分散到 N 個線程平行處理（預設 = min(輸入數, CPU 核心數)），
+     * 全部完成後輸出每個輸入的計數、幀率與逐階段延遲（合成序列另附真值與準確度）。需已建立 QCoreApplication。
+     * @return 程序結束碼（任一輸入失敗為 1）
+     */
+    int runOfflineReplay(const QStringList &arguments);
+
+} // namespace basler
+
+#endif // OFFLINE_REPLAY_H
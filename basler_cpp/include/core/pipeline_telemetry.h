@@ -0,0 +1,74 @@
+#ifndef PIPELINE_TELEMETRY_H
+#define PIPELINE_TELEMETRY_H
+
+#include <QObject>
+#include <QString>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <string>
+
+#include "core/metrics_server.h"
+#include "core/stage_profiler.h"
+
+namespace basler
+{
+
+    class DetectionController;
+    class DetectionWorker;
+    class SourceManager;
+    struct TelemetryConfig;
+
+    /**
+     * @brief 單一檢測管線的指標（MetricsRegistry 收集器）
+     *
+     * 數值在產生端以直接連接寫入原子變數（計數 / 良率在檢測線程、相機幀率在抓取端），
+     * 逐階段延遲在檢測線程累計後以 seqlock 發布；抓取時只讀這些值與 DetectionWorker / FrameRing 的原子統計，
+     * 不取用 DetectionController 的任何互斥鎖。
+     *
+     * 需在檢測線程結束後、DetectionWorker 析構前釋放。
+     */
+    class PipelineTelemetry : public QObject
+    {
+        Q_OBJECT
+
+    public:
+        PipelineTelemetry(const QString &pipeline, DetectionController *controller, DetectionWorker *worker,
+                          SourceManager *source, QObject *parent = nullptr);
+        ~PipelineTelemetry() override;
+
+        PipelineTelemetry(const PipelineTelemetry &) = delete;
+        PipelineTelemetry &operator=(const PipelineTelemetry &) = delete;
+
+    private:
+        void collect(MetricsWriter &writer) const;
+        void onStageLatency(const StageLatencySnapshot &snapshot);
+
+        const std::string m_pipeline;
+        DetectionController *m_controller;
+        DetectionWorker *m_worker;
+
+        std::atomic<double> m_cameraFps{0.0};
+        std::atomic<double> m_yoloInferenceMs{0.0};
+        std::atomic<int> m_count{0};
+        std::atomic<double> m_passRate{100.0};
+        std::atomic<int> m_passCount{0};
+        std::atomic<int> m_failCount{0};
+        std::atomic<uint64_t> m_packagesCompleted{0};
+
+        // 逐階段累計（只由檢測線程寫入），每個視窗發布一次
+        StageLatencySnapshot m_stageTotals;
+        std::array<SeqlockHistogram, PIPELINE_STAGE_COUNT> m_stages;
+
+        int m_collectorId = -1;
+    };
+
+    /**
+     * @brief 依 TelemetryConfig 啟動指標端點並設定 station 標籤
+     * @return 未啟用或無法監聽時為 nullptr
+     */
+    std::unique_ptr<MetricsServer> startMetricsServer(const TelemetryConfig &config);
+
+} // namespace basler
+
+#endif // PIPELINE_TELEMETRY_H
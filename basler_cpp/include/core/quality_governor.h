@@ -0,0 +1,80 @@
+#ifndef QUALITY_GOVERNOR_H
+#define QUALITY_GOVERNOR_H
+
+#include <QtGlobal>
+
+namespace basler
+{
+
+    /**
+     * @brief 檢測品質等級（數值越大降級越多，依序累加）
+     */
+    enum class QualityLevel
+    {
+        Full = 0,            // 完整品質
+        NoDebugTaps,         // 停止擷取調試中間幀
+        NoOverlay,           // 停止繪製結果 overlay（顯示原始幀）
+        HighSpeedProcessing, // 傳統模式改走 ultraHighSpeedProcessing
+        ReducedWidth,        // 處理寬度減半（面積門檻依縮放比換算；ROI 參數的物理意義隨之改變）
+        Count
+    };
+
+    const char *qualityLevelDescription(QualityLevel level);
+
+    /**
+     * @brief 依檢測延遲與佇列深度自動升降品質的調節器
+     *
+     * 負載 = 處理耗時 EMA × 相機 FPS / 1000（1.0 = 剛好用完幀間隔）：
+     * 1. 負載 > degradeLoad 或落後幀數 > backlogFrames 連續 degradeHoldFrames 幀 → 降一級
+     * 2. 負載 < restoreLoad 且沒有落後連續 restoreHoldFrames 幀 → 升一級
+     * 3. 升級後很快又降級（振盪）時，下一次升級的等待幀數加倍（上限 16 倍）；
+     *    回到完整品質並穩定 restoreHoldFrames 幀後恢復原等待
+     * 4. 每次改變後重新累計，確保新等級的耗時反映到 EMA 後才做下一步
+     *
+     * 相機 FPS 未知（<= 0）時只依落後幀數判斷。
+     * 非線程安全：由檢測線程每幀呼叫。
+     */
+    class QualityGovernor
+    {
+    public:
+        struct Config
+        {
+            bool enabled = true;
+            double degradeLoad = 0.9;
+            double restoreLoad = 0.6;
+            int backlogFrames = 4;
+            int degradeHoldFrames = 30;
+            int restoreHoldFrames = 300;
+        };
+
+        void configure(const Config &config);
+
+        /**
+         * @brief 餵入一幀的觀測值
+         * @param processingMs 本幀檢測耗時
+         * @param backlog 讀取時尚未處理的幀數（FrameRing 最新序號 - 本幀序號）
+         * @param sourceFps 相機 / 影片幀率
+         * @return 等級是否改變
+         */
+        bool update(double processingMs, quint64 backlog, double sourceFps);
+
+        void reset();
+
+        QualityLevel level() const { return m_level; }
+        double load() const { return m_load; }
+
+    private:
+        Config m_config;
+        QualityLevel m_level = QualityLevel::Full;
+        double m_emaMs = 0.0;
+        double m_load = 0.0;
+        bool m_hasSample = false;
+        int m_overloadedFrames = 0;
+        int m_headroomFrames = 0;
+        int m_framesSinceRestore = -1; // -1 = 尚未升級過
+        int m_restoreBackoff = 1;
+    };
+
+} // namespace basler
+
+#endif // QUALITY_GOVERNOR_H
@@ -0,0 +1,156 @@
+#ifndef RAW_CAPTURE_H
+#define RAW_CAPTURE_H
+
+#include <QFile>
+#include <QString>
+#include <memory>
+#include <vector>
+#include <opencv2/core.hpp>
+
+#include "core/frame_ring.h"
+
+namespace basler {
+
+/**
+ * @brief 原始擷取的單幀標頭（64 bytes，緊接在像素之前）
+ */
+struct RawFrameHeader {
+    quint64 sequence = 0;        // FrameRing 序號
+    quint64 blockId = 0;         // 相機區塊 ID（Pylon GetBlockID）
+    quint64 deviceTimestamp = 0; // 相機時間戳（Pylon GetTimeStamp）
+    qint64 hostTimestampUs = 0;  // 主機 steady clock 時間戳
+    float exposureUs = 0.0f;     // 曝光時間
+    quint32 payloadBytes = 0;    // 像素資料長度
+    quint8 reserved[24] = {};
+};
+static_assert(sizeof(RawFrameHeader) == 64, "RawFrameHeader 必須為 64 bytes");
+
+/**
+ * @brief 無損原始擷取寫入器（mono8 / BGR，記憶體映射分段檔）
+ *
+ * 擷取目錄結構（*.rawcap/）：
+ * - seg_00000.bin ...：4KB 分段標頭 + 固定長度紀錄（64B 幀標頭 + 緊密排列像素）
+ *   分段檔在開啟時依 segmentBytes 預先設定長度並整段映射，寫入只是一次 memcpy；
+ *   關閉時截去未用的尾端。幀尺寸改變時開新分段
+ * - index.bin：每幀一筆 32B 索引（分段、紀錄位置、序號、區塊 ID、時間戳），任意幀 O(1) 定位
+ *
+ * 異常中止時分段標頭的 frameCount 已逐幀更新；索引為緩衝寫入，最多遺失尚未寫出的最後數百筆，
+ * 其餘幀仍可讀取。
+ * 非線程安全：由錄影線程獨佔使用。
+ */
+class RawCaptureWriter {
+public:
+    static constexpr const char* EXTENSION = ".rawcap";
+
+    RawCaptureWriter() = default;
+    ~RawCaptureWriter();
+
+    RawCaptureWriter(const RawCaptureWriter&) = delete;
+    RawCaptureWriter& operator=(const RawCaptureWriter&) = delete;
+
+    /**
+     * @brief 建立擷取目錄（已存在則失敗）
+     * @param segmentBytes 單一分段檔的大小上限
+     */
+    bool open(const QString& directory, double fps, qint64 segmentBytes);
+
+    /**
+     * @brief 附加一幀（CV_8UC1 / CV_8UC3）
+     */
+    bool append(const cv::Mat& frame, const FrameMeta& meta);
+
+    void close();
+
+    bool isOpen() const { return m_index.isOpen(); }
+    int frameCount() const { return m_frames; }
+    QString directory() const { return m_directory; }
+    QString errorString() const { return m_error; }
+
+private:
+    bool openSegment(const cv::Mat& frame);
+    void finishSegment();
+
+    QString m_directory;
+    double m_fps = 0.0;
+    qint64 m_segmentBytes = 0;
+
+    std::unique_ptr<QFile> m_segment;
+    uchar* m_map = nullptr;
+    int m_segmentIndex = -1;
+    int m_capacity = 0; // 目前分段的紀錄數上限
+    int m_used = 0;     // 目前分段已寫紀錄數
+    int m_width = 0;
+    int m_height = 0;
+    int m_type = -1;
+    size_t m_rowBytes = 0;
+    size_t m_recordBytes = 0;
+
+    QFile m_index;
+    int m_frames = 0;
+    QString m_error;
+};
+
+/**
+ * @brief 原始擷取讀取器（唯讀映射所有分段與索引）
+ *
+ * frame() 為 O(1) 並回傳指向映射記憶體的 Mat 標頭（不複製），讀取器開啟期間有效。
+ * 開啟後唯讀，可由多個線程同時呼叫 frame()。
+ */
+class RawCaptureReader {
+public:
+    RawCaptureReader() = default;
+    ~RawCaptureReader() { close(); }
+
+    RawCaptureReader(const RawCaptureReader&) = delete;
+    RawCaptureReader& operator=(const RawCaptureReader&) = delete;
+
+    /**
+     * @brief 路徑是否為原始擷取（*.rawcap 目錄或其中的 index.bin）
+     */
+    static bool isRawCapture(const QString& path);
+
+    bool open(const QString& path);
+    void close();
+
+    bool isOpen() const { return m_entries != nullptr; }
+    int frameCount() const { return m_count; }
+    double fps() const { return m_fps; }
+    int width() const { return m_width; }
+    int height() const { return m_height; }
+    QString errorString() const { return m_error; }
+
+    /**
+     * @brief 取得第 index 幀
+     * @param[out] view 指向映射記憶體的幀（不複製）
+     * @param[out] header 幀標頭
+     */
+    bool frame(int index, cv::Mat& view, RawFrameHeader& header) const;
+
+private:
+    struct Segment {
+        std::unique_ptr<QFile> file;
+        const uchar* map = nullptr;
+        qint64 size = 0;
+        int width = 0;
+        int height = 0;
+        int type = 0;
+        size_t rowBytes = 0;
+        size_t recordBytes = 0;
+        int frameCount = 0;
+    };
+
+    bool mapSegment(const QString& directory, int segmentIndex);
+
+    std::vector<Segment> m_segments;
+    QFile m_indexFile;
+    const uchar* m_entries = nullptr;
+    int m_count = 0;
+    double m_fps = 0.0;
+    int m_width = 0;
+    int m_height = 0;
+    QString m_error;
+};
+
+} // namespace basler
+
+#endif // RAW_CAPTURE_H
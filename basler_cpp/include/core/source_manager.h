@@ -7,11 +7,13 @@
 #include <opencv2/core.hpp>
 
 #include "camera_controller.h"
+#include "frame_ring.h"
 
 namespace basler {
 
 // 前向聲明
 class VideoPlayer;
+struct SyntheticConfig;
 
 /**
  * @brief 源類型枚舉
@@ -51,6 +53,20 @@ public:
     CameraController* cameraController() const { return m_cameraController.get(); }
     VideoPlayer* videoPlayer() const { return m_videoPlayer.get(); }
 
+    /**
+     * @brief 共用幀環形緩衝（相機與視頻都寫入這裡）
+     *
+     * 檢測、錄影向它註冊消費者依序讀取，顯示用 readLatest() 取最新幀。
+     */
+    FrameRing* frameRing() const { return m_frameRing.get(); }
+
+    /**
+     * @brief 切換到合成落料序列（經 VideoPlayer 播放，sourceType 為 Video）
+     *
+     * 也可用 useVideo() 載入 *.synth.json 描述檔；真值見 videoPlayer()->syntheticSource()。
+     */
+    bool useSynthetic(const SyntheticConfig& config);
+
 public slots:
     /**
      * @brief 切換到相機模式
@@ -71,6 +87,11 @@ public slots:
      */
     void connectCamera(int index = 0);
 
+    /**
+     * @brief 以序號連接相機（可帶快取 IP 跳過完整列舉，見 CameraController::connectCameraBySerial）
+     */
+    void connectCameraBySerial(const QString& serial, const QString& ipAddress = QString());
+
     /**
      * @brief 斷開相機
      */
@@ -87,7 +108,7 @@ public slots:
     void stopGrabbing();
 
     /**
-     * @brief 獲取當前幀
+     * @brief 獲取當前幀（從 FrameRing 複製最新幀）
      * @return 當前幀（可能為空）
      */
     cv::Mat getFrame();
@@ -108,9 +129,10 @@ signals:
     void grabbingStarted();
     void grabbingStopped();
 
-    // 幀和 FPS
-    void frameReady(const cv::Mat& frame);
+    // 幀和 FPS（幀數據在 frameRing() 中，信號只攜帶序號）
+    void frameReady(quint64 sequence);
     void fpsUpdated(double fps);
+    void framesMissed(quint64 missed, quint64 totalMissed); // 相機區塊 ID 缺口
 
     // 錯誤
     void error(const QString& error);
@@ -121,25 +143,26 @@ private slots:
     void onCameraDisconnected();
     void onCameraGrabbingStarted();
     void onCameraGrabbingStopped();
-    void onCameraFrameReady(const cv::Mat& frame);
+    void onCameraFrameReady(quint64 sequence);
     void onCameraFpsUpdated(double fps);
     void onCameraError(const QString& error);
 
     // 視頻信號處理
-    void onVideoFrameReady(const cv::Mat& frame);
+    void onVideoFrameReady(quint64 sequence);
     void onVideoPlaybackFinished();
 
 private:
     void cleanupCurrentSource();
+    void prepareVideoPlayer(); // 停止相機並建立（或重用）視頻播放器
     void setupCameraConnections();
     void setupVideoConnections();
 
+    // 必須先於相機/視頻宣告，確保最後才析構
+    std::unique_ptr<FrameRing> m_frameRing;
+
     std::unique_ptr<CameraController> m_cameraController;
     std::unique_ptr<VideoPlayer> m_videoPlayer;
     SourceType m_sourceType = SourceType::None;
-
-    cv::Mat m_latestFrame;
-    QMutex m_frameMutex;
 };
 
 } // namespace basler
@@ -0,0 +1,143 @@
+#ifndef SPATIAL_GRID_H
+#define SPATIAL_GRID_H
+
+#include <QtGlobal>
+#include <array>
+#include <utility>
+#include <vector>
+
+namespace basler
+{
+
+    /**
+     * @brief 均勻空間雜湊網格（每幀重建，CSR 排列）
+     *
+     * 取代「每個偵測 × 每個追蹤」的全掃描：
+     * 1. 格子尺寸設為匹配的最大容許偏移，候選只可能落在查詢點周圍 3×3 格
+     * 2. 格座標雜湊到固定數量的桶；碰撞只會多出候選，由呼叫端的距離判斷過濾
+     * 3. insert() 累積項目，build() 以計數排序排成連續陣列；緩衝重用，穩態不配置記憶體
+     */
+    class SpatialGrid
+    {
+    public:
+        explicit SpatialGrid(int bucketBits = 8);
+
+        /**
+         * @brief 設定格子尺寸（像素，最小 1）；需在 insert() 前呼叫
+         */
+        void setCellSize(int cellWidth, int cellHeight);
+
+        void clear();
+        void insert(int item, int x, int y);
+        void build();
+
+        int size() const { return static_cast<int>(m_items.size()); }
+
+        /**
+         * @brief 走訪 (x, y) 周圍 3×3 格內的所有項目（不保證順序，同一項目只走訪一次）
+         */
+        template <typename F>
+        void forEachCandidate(int x, int y, F &&visit) const
+        {
+            std::array<int, 9> buckets;
+            int bucketCount = 0;
+            const int cx = cellX(x);
+            const int cy = cellY(y);
+            for (int dy = -1; dy <= 1; ++dy)
+            {
+                for (int dx = -1; dx <= 1; ++dx)
+                {
+                    const int bucket = bucketOf(cx + dx, cy + dy);
+                    bool seen = false;
+                    for (int i = 0; i < bucketCount; ++i)
+                        seen = seen || buckets[i] == bucket;
+                    if (!seen)
+                        buckets[bucketCount++] = bucket;
+                }
+            }
+
+            for (int i = 0; i < bucketCount; ++i)
+            {
+                const int begin = m_bucketStart[buckets[i]];
+                const int end = m_bucketStart[buckets[i] + 1];
+                for (int k = begin; k < end; ++k)
+                    visit(m_items[k]);
+            }
+        }
+
+    private:
+        int cellX(int x) const { return floorDiv(x, m_cellWidth); }
+        int cellY(int y) const { return floorDiv(y, m_cellHeight); }
+        int bucketOf(int cellX, int cellY) const;
+        static int floorDiv(int value, int divisor);
+
+        int m_bucketMask;
+        int m_cellWidth = 1;
+        int m_cellHeight = 1;
+
+        std::vector<std::pair<int, int>> m_pending; // (bucket, item)，build() 前暫存
+        std::vector<int> m_bucketStart;             // 桶 b 的項目位於 [start[b], start[b+1])
+        std::vector<int> m_items;
+    };
+
+    /**
+     * @brief 近期位置索引（時間序環形緩衝 + 空間雜湊鏈）
+     *
+     * 給「最近 N 幀內是否在附近出現過」的去重複查詢使用（已計數歷史、光柵觸發點）：
+     * 1. 紀錄依時間寫入固定容量環形緩衝，滿了直接覆寫最舊的一筆，沒有 erase
+     * 2. 每個雜湊桶是一條由新到舊的鏈；遇到已被覆寫或超過時間窗的紀錄即停止，
+     *    過期紀錄不需要主動清除（O(1) 過期）
+     * 3. 查詢只走訪半徑涵蓋的幾個格子
+     *
+     * 限制：push() 的幀號必須單調不減（重置計數時一併 clear()）。
+     */
+    class RecentPositionIndex
+    {
+    public:
+        RecentPositionIndex(int capacity, int cellSize, int bucketBits = 6);
+
+        /**
+         * @brief 重新設定容量與格子尺寸（會清空）
+         */
+        void configure(int capacity, int cellSize);
+
+        void clear();
+        void push(int x, int y, int frame);
+
+        int capacity() const { return static_cast<int>(m_entries.size()); }
+
+        /**
+         * @brief 是否有 frame - 紀錄幀 < maxAge 且距離 < radius 的紀錄
+         */
+        bool containsNear(int x, int y, double radius, int frame, int maxAge) const;
+
+    private:
+        struct Link
+        {
+            int index = -1;
+            quint64 serial = 0; // 寫入序號；與 m_entries[index].serial 不同代表已被覆寫
+        };
+
+        struct Entry
+        {
+            int x = 0;
+            int y = 0;
+            int frame = 0;
+            quint64 serial = 0;
+            Link next;
+        };
+
+        int bucketOf(int cellX, int cellY) const;
+        bool isLive(const Link &link) const;
+
+        int m_bucketMask;
+        int m_cellSize = 1;
+        quint64 m_nextSerial = 1;
+        int m_writeIndex = 0;
+        std::vector<Entry> m_entries;
+        std::vector<Link> m_heads;
+    };
+
+} // namespace basler
+
+#endif // SPATIAL_GRID_H
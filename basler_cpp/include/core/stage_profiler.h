@@ -0,0 +1,216 @@
+#ifndef STAGE_PROFILER_H
+#define STAGE_PROFILER_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace basler
+{
+
+    /**
+     * @brief 檢測管線計時階段
+     *
+     * 巢狀關係：Total 包含其餘所有階段；GateCounting 不含 Tracking。
+     * Blur ~ MaskFusion 只在融合管線（fusedStandardPipeline）計時。
+     */
+    enum class PipelineStage
+    {
+        Resize,
+        RoiExtract,
+        BackgroundSubtract,
+        Blur,
+        MedianFilter,
+        MorphOpen,
+        MorphClose,
+        MorphRefine,
+        Canny,
+        AdaptiveThreshold,
+        MaskFusion,
+        PostMorphology,
+        DeviceTransfer, // 裝置管線上傳 / 下載（下載時同步，含裝置上排隊中的運算）
+        BlobExtraction,
+        Tracking,
+        GateCounting,
+        YoloInference,
+        Draw,
+        Total,
+        Count
+    };
+
+    constexpr int PIPELINE_STAGE_COUNT = static_cast<int>(PipelineStage::Count);
+
+    const char *pipelineStageName(PipelineStage stage);
+
+    /**
+     * @brief 對數分桶延遲直方圖（快照值，可合併）
+     *
+     * 以奈秒為單位，每個 2 的冪次區間分 8 桶（相對誤差 <= 12.5%），
+     * 256 桶涵蓋 0 ~ 17 秒；小於 8ns 的值逐一分桶。
+     */
+    struct LatencyHistogram
+    {
+        static constexpr int SUB_BUCKETS = 8;
+        static constexpr int BUCKETS = 256;
+
+        std::array<uint32_t, BUCKETS> counts{};
+        uint64_t count = 0;
+        uint64_t sumNs = 0;
+        uint64_t maxNs = 0;
+
+        static int bucketOf(uint64_t ns);
+        static uint64_t bucketLowerNs(int bucket);
+        static uint64_t bucketWidthNs(int bucket);
+
+        /**
+         * @brief 分位數（q = 0.5 / 0.95 / 0.99），以桶中點近似且不超過最大值
+         */
+        double percentileUs(double q) const;
+        double meanUs() const { return count ? sumNs / 1000.0 / count : 0.0; }
+        double maxUs() const { return maxNs / 1000.0; }
+
+        void merge(const LatencyHistogram &other);
+        void record(uint64_t ns); // 單線程累加（並行記錄請用 StageProfiler）
+    };
+
+    /**
+     * @brief 一個統計窗口內所有階段的直方圖
+     */
+    struct StageLatencySnapshot
+    {
+        double windowMs = 0.0; // 窗口長度（合併後為總長）
+        std::array<LatencyHistogram, PIPELINE_STAGE_COUNT> stages;
+
+        const LatencyHistogram &operator[](PipelineStage stage) const { return stages[static_cast<int>(stage)]; }
+        void merge(const StageLatencySnapshot &other);
+    };
+
+    /**
+     * @brief 常駐的逐階段延遲統計
+     *
+     * 1. record() 只做數個 relaxed 原子加法（無鎖、不配置），每次計時的額外成本約兩次 steady_clock 讀取
+     * 2. collect() 以原子交換取出並清空目前窗口，可在任意線程呼叫；與 record() 並行時
+     *    樣本只會落在相鄰窗口之一，不會遺失
+     * 3. 停用時計時器不讀時鐘
+     */
+    class StageProfiler
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        StageProfiler();
+
+        void setEnabled(bool enabled) { m_enabled.store(enabled, std::memory_order_relaxed); }
+        bool isEnabled() const { return m_enabled.load(std::memory_order_relaxed); }
+
+        void record(PipelineStage stage, uint64_t ns);
+
+        /**
+         * @brief 目前窗口已累積的時間（毫秒）
+         */
+        double windowElapsedMs() const;
+
+        /**
+         * @brief 取出目前窗口並開始新窗口
+         */
+        StageLatencySnapshot collect();
+
+    private:
+        struct AtomicHistogram
+        {
+            std::array<std::atomic<uint32_t>, LatencyHistogram::BUCKETS> counts{};
+            std::atomic<uint64_t> count{0};
+            std::atomic<uint64_t> sumNs{0};
+            std::atomic<uint64_t> maxNs{0};
+        };
+
+        std::array<AtomicHistogram, PIPELINE_STAGE_COUNT> m_stages;
+        std::atomic<bool> m_enabled{true};
+        std::atomic<int64_t> m_windowStartNs{0};
+    };
+
+    /**
+     * @brief 作用域計時：建構到解構（或 stop()）的時間記入指定階段
+     */
+    class ScopedStageTimer
+    {
+    public:
+        ScopedStageTimer(StageProfiler &profiler, PipelineStage stage)
+            : m_profiler(profiler), m_stage(stage), m_active(profiler.isEnabled())
+        {
+            if (m_active)
+            {
+                m_start = StageProfiler::Clock::now();
+            }
+        }
+
+        ~ScopedStageTimer() { stop(); }
+
+        ScopedStageTimer(const ScopedStageTimer &) = delete;
+        ScopedStageTimer &operator=(const ScopedStageTimer &) = delete;
+
+        void stop()
+        {
+            if (!m_active)
+            {
+                return;
+            }
+            m_active = false;
+            const auto elapsed = StageProfiler::Clock::now() - m_start;
+            m_profiler.record(m_stage, static_cast<uint64_t>(
+                                           std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+        }
+
+    private:
+        StageProfiler &m_profiler;
+        PipelineStage m_stage;
+        bool m_active;
+        StageProfiler::Clock::time_point m_start;
+    };
+
+    /**
+     * @brief 連續階段計時：每次 lap() 把上一個分段點到現在的時間記入指定階段（每段只讀一次時鐘）
+     */
+    class StageStopwatch
+    {
+    public:
+        explicit StageStopwatch(StageProfiler &profiler)
+            : m_profiler(profiler), m_active(profiler.isEnabled())
+        {
+            if (m_active)
+            {
+                m_last = StageProfiler::Clock::now();
+            }
+        }
+
+        void lap(PipelineStage stage)
+        {
+            if (!m_active)
+            {
+                return;
+            }
+            const auto now = StageProfiler::Clock::now();
+            m_profiler.record(stage, static_cast<uint64_t>(
+                                         std::chrono::duration_cast<std::chrono::nanoseconds>(now - m_last).count()));
+            m_last = now;
+        }
+
+        // 不計時的分段（例如調試擷取）後重新起算
+        void restart()
+        {
+            if (m_active)
+            {
+                m_last = StageProfiler::Clock::now();
+            }
+        }
+
+    private:
+        StageProfiler &m_profiler;
+        bool m_active;
+        StageProfiler::Clock::time_point m_last;
+    };
+
+} // namespace basler
+
+#endif // STAGE_PROFILER_H
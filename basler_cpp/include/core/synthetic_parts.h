@@ -0,0 +1,135 @@
+#ifndef SYNTHETIC_PARTS_H
+#define SYNTHETIC_PARTS_H
+
+#include <QJsonObject>
+#include <QString>
+#include <vector>
+#include <opencv2/core.hpp>
+
+namespace basler {
+
+struct PartProfile;
+
+/**
+ * @brief 合成落料序列的參數（*.synth.json 的內容）
+ */
+struct SyntheticConfig {
+    int width = 640;
+    int height = 480;
+    double fps = 120.0;
+    int frames = 3600;
+
+    double partsPerMinute = 300.0;    // 平均落料密度（卜瓦松到達）
+    double speedPxPerFrame = 6.0;     // 進入畫面時的平均速度
+    double speedJitter = 0.25;        // 速度隨機範圍（± 比例）
+    double gravityPxPerFrame2 = 0.05; // 下落加速度
+    double partRadius = 4.0;          // 平均半徑（像素）
+    double sizeJitter = 0.3;          // 尺寸隨機範圍（± 比例）
+    double overlapRatio = 0.0;        // 與前一個零件相貼同時落下的比例（相互遮擋 / 黏連）
+
+    double noiseSigma = 3.0;          // 每幀感測器雜訊標準差
+    double flickerAmplitude = 0.0;    // 照明閃爍幅度（整幀亮度 ± 比例）
+    double flickerHz = 100.0;         // 照明閃爍頻率（50Hz 市電 → 100Hz）
+    double reflectiveRatio = 0.0;     // 反光零件比例（高光點 + 逐幀亮度變化）
+    bool circular = false;            // 正圓零件（否則為隨機長寬比與角度的橢圓）
+
+    int backgroundLevel = 40;
+    int partLevel = 200;
+    unsigned seed = 1;
+
+    /**
+     * @brief 依零件配置調整外觀（isReflective → 全部反光，isCircular → 正圓）
+     */
+    void applyPartProfile(const PartProfile& profile);
+
+    QJsonObject toJson() const;
+    static SyntheticConfig fromJson(const QJsonObject& json);
+};
+
+/**
+ * @brief 單一零件的真值軌跡（y(t) = y0 + vy·t + ½·ay·t²，t = 幀 - spawnFrame）
+ */
+struct SyntheticPart {
+    int id = 0;
+    int spawnFrame = 0;
+    int exitFrame = 0; // 完全離開畫面的第一幀
+    float x = 0.0f;
+    float y0 = 0.0f;
+    float vy = 0.0f;
+    float ay = 0.0f;
+    float radiusX = 0.0f;
+    float radiusY = 0.0f;
+    float angle = 0.0f;
+    bool reflective = false;
+
+    float yAt(int frame) const
+    {
+        const float t = static_cast<float>(frame - spawnFrame);
+        return y0 + vy * t + 0.5f * ay * t * t;
+    }
+    bool visibleAt(int frame) const { return frame >= spawnFrame && frame < exitFrame; }
+};
+
+/**
+ * @brief 合成落料影像產生器（已知真值計數與軌跡）
+ *
+ * 1. configure() 依種子預先排定所有零件的出現幀與軌跡，之後每一幀都由幀索引決定：
+ *    render() 可任意順序、多線程同時呼叫（同一索引的輸出逐位元相同），因此能作為可跳轉的播放來源
+ * 2. 預設輸出 mono8；背景為固定紋理，照明閃爍作用於整幀，雜訊逐幀以 seed ^ 幀索引 產生
+ * 3. crossings() 對任意光柵線計算真值穿越次數，供離線重播 / 基準測試比較計數準確度
+ *
+ * VideoPlayer 的 loadVideo() 遇到 *.synth.json 時以本類作為來源。
+ */
+class SyntheticPartsGenerator {
+public:
+    static constexpr const char* EXTENSION = ".synth.json";
+
+    /**
+     * @brief 路徑是否為合成序列描述檔（*.synth.json）
+     */
+    static bool isSyntheticSpec(const QString& path);
+
+    /**
+     * @brief 讀取描述檔並 configure()
+     */
+    bool load(const QString& specPath);
+
+    void configure(const SyntheticConfig& config);
+
+    const SyntheticConfig& config() const { return m_config; }
+    int frameCount() const { return m_config.frames; }
+    double fps() const { return m_config.fps; }
+    int width() const { return m_config.width; }
+    int height() const { return m_config.height; }
+    QString errorString() const { return m_error; }
+
+    /**
+     * @brief 產生第 index 幀（重用 out 的緩衝；超出範圍回傳 false）
+     */
+    bool render(int index, cv::Mat& out) const;
+
+    // ===== 真值 =====
+    const std::vector<SyntheticPart>& parts() const { return m_parts; }
+
+    /**
+     * @brief 第 frame 幀中可見的零件（索引指向 parts()）
+     */
+    void visibleParts(int frame, std::vector<int>& indices) const;
+
+    /**
+     * @brief 中心在 (beginFrame, endFrame) 之間由上往下越過 gateY 的次數
+     * @param endFrame -1 = 到最後一幀
+     */
+    int crossings(int gateY, int beginFrame = 0, int endFrame = -1) const;
+
+private:
+    SyntheticConfig m_config;
+    std::vector<SyntheticPart> m_parts; // 依 spawnFrame 排序
+    int m_maxLifetime = 0;
+    cv::Mat m_background;
+    QString m_error;
+};
+
+} // namespace basler
+
+#endif // SYNTHETIC_PARTS_H
@@ -0,0 +1,118 @@
+#ifndef THREAD_AFFINITY_H
+#define THREAD_AFFINITY_H
+
+#include <string>
+#include <vector>
+
+namespace basler
+{
+
+    /**
+     * @brief 線程優先權等級
+     */
+    enum class ThreadPriority
+    {
+        Normal,  // 作業系統預設
+        High,    // Linux nice -10 / Windows HIGHEST / macOS QoS user-interactive
+        Realtime // Linux SCHED_FIFO / Windows TIME_CRITICAL（同 raiseCurrentThreadToRealtime）
+    };
+
+    /**
+     * @brief 異質核心類型（big.LITTLE、Intel P/E 核心）
+     */
+    enum class CoreClass
+    {
+        Any,
+        Performance,
+        Efficiency
+    };
+
+    /**
+     * @brief 將呼叫線程綁定到單一邏輯核心
+     * @param core 邏輯核心編號（< 0 表示不綁定，直接回傳 true）
+     * @return 是否成功（平台不支援或核心編號超出範圍時為 false，線程維持原排程）
+     *
+     * Linux 使用 pthread_setaffinity_np，Windows 使用 SetThreadAffinityMask；
+     * macOS 沒有硬綁定 API，回傳 false。
+     */
+    bool pinCurrentThreadToCore(int core);
+
+    /**
+     * @brief 將呼叫線程提升為即時排程（控制迴圈等延遲敏感線程）
+     * @return 是否成功（權限不足時為 false，線程維持原排程）
+     *
+     * Linux 使用 SCHED_FIFO（需 CAP_SYS_NICE 或 rtprio 限額），Windows 使用 THREAD_PRIORITY_TIME_CRITICAL。
+     */
+    bool raiseCurrentThreadToRealtime();
+
+    /**
+     * @brief 將呼叫線程限制在一組邏輯核心（空集合不變更）
+     *
+     * Linux 使用 pthread_setaffinity_np，Windows 使用 SetThreadAffinityMask（僅處理器群組 0）；
+     * macOS 不支援，回傳 false。
+     */
+    bool setCurrentThreadAffinity(const std::vector<int> &cores);
+
+    /**
+     * @brief 呼叫線程目前允許執行的邏輯核心（無法查詢時為空）
+     */
+    std::vector<int> currentThreadAffinity();
+
+    /**
+     * @brief 呼叫線程目前所在的邏輯核心（無法查詢時為 -1）
+     */
+    int currentCpu();
+
+    /**
+     * @brief 設定呼叫線程的優先權
+     * @return 是否成功（權限不足時為 false，線程維持原排程）
+     */
+    bool setCurrentThreadPriority(ThreadPriority priority);
+
+    /**
+     * @brief 指定類型的邏輯核心
+     * @return 系統不是異質核心或無法判斷時為空
+     *
+     * Linux 讀取 /sys/devices/cpu_core|cpu_atom/cpus（Intel 混合架構）或 cpu_capacity（ARM big.LITTLE），
+     * Windows 依 GetSystemCpuSetInformation 的 EfficiencyClass 區分。
+     */
+    std::vector<int> coresOfClass(CoreClass coreClass);
+
+    /**
+     * @brief 以作業系統的服務品質類別提示核心類型（macOS 不能綁核，改設 QoS）
+     * @return 平台不支援時為 false（其他平台改以 coresOfClass 限制 affinity）
+     */
+    bool hintCurrentThreadCoreClass(CoreClass coreClass);
+
+    /**
+     * @brief 指定 NUMA 節點的邏輯核心（單節點系統或無法判斷時為空）
+     */
+    std::vector<int> coresOfNumaNode(int node);
+
+    /**
+     * @brief 解析 CPU 列表字串（"0-3,6,8-9"，與 Linux cpulist 格式相同），忽略不合法的項目
+     */
+    std::vector<int> parseCpuList(const std::string &text);
+
+    /**
+     * @brief 將核心集合格式化為 CPU 列表字串（連續核心合併為區間）
+     */
+    std::string formatCpuList(const std::vector<int> &cores);
+
+    /**
+     * @brief 設定呼叫線程的系統名稱（逐線程 CPU 統計、偵錯器與 top -H 顯示）
+     * @param name 線程名稱（Linux 限 15 字元，超過時截斷）
+     *
+     * QThread 會以 objectName 自動命名，此函式供 std::thread 工作線程使用。
+     * Linux / macOS 使用 pthread_setname_np，Windows 使用 SetThreadDescription（Windows 10 1607 起，較舊版本略過）。
+     */
+    void setCurrentThreadName(const char *name);
+
+    /**
+     * @brief 可用的邏輯核心數（至少 1）
+     */
+    int logicalCoreCount();
+
+} // namespace basler
+
+#endif // THREAD_AFFINITY_H
@@ -0,0 +1,91 @@
+#ifndef THREAD_CPU_SAMPLER_H
+#define THREAD_CPU_SAMPLER_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace basler
+{
+
+    /**
+     * @brief 單一線程的累計 CPU 時間
+     */
+    struct ThreadCpuTimes
+    {
+        uint64_t id = 0;  // 系統線程 ID（Linux tid / Windows thread id / macOS thread_id）
+        std::string name; // 系統線程名稱（setCurrentThreadName / QThread objectName；可能為空）
+        uint64_t cpuNs = 0; // user + system
+    };
+
+    /**
+     * @brief 程序記憶體統計（累計值）
+     */
+    struct ProcessMemoryStats
+    {
+        uint64_t residentBytes = 0; // 常駐記憶體（Linux RSS / Windows working set / macOS phys_footprint）
+        uint64_t pageFaults = 0;    // 累計頁面錯誤（新配置的頁面首次存取都會計入，作為配置速率的近似）
+    };
+
+    /**
+     * @brief 列出本程序所有線程的累計 CPU 時間
+     *
+     * Linux 讀 /proc/self/task/<tid>/schedstat（奈秒；無 schedstat 時退回 stat 的 clock tick），
+     * Windows 以 Toolhelp 列舉線程後呼叫 GetThreadTimes（名稱取自 GetThreadDescription），
+     * macOS 以 task_threads + thread_info(THREAD_EXTENDED_INFO)。
+     * @return 平台不支援時為 false
+     */
+    bool readThreadCpuTimes(std::vector<ThreadCpuTimes> &threads);
+
+    bool readProcessMemory(ProcessMemoryStats &stats);
+
+    /**
+     * @brief 線程在取樣間隔內的使用率
+     */
+    struct ThreadCpuUsage
+    {
+        uint64_t id = 0;
+        std::string name;
+        double cpuPercent = 0.0; // 佔單一核心的百分比（0-100）
+        double cpuSeconds = 0.0; // 累計
+    };
+
+    /**
+     * @brief 一次取樣（與上一次取樣的差值）
+     */
+    struct ProcessUsageSample
+    {
+        std::vector<ThreadCpuUsage> threads; // 依 cpuPercent 由高到低
+        double processCpuPercent = 0.0;      // 所有線程合計（單一核心 = 100）
+        double residentMb = 0.0;
+        double residentMbPerSec = 0.0;       // 常駐記憶體成長速率
+        double pageFaultsPerSec = 0.0;
+        double intervalSec = 0.0;            // 0 = 第一次取樣（沒有差值）
+    };
+
+    /**
+     * @brief 逐線程 CPU 取樣器（呼叫端定時呼叫 sample()，非線程安全）
+     *
+     * 線程以系統 ID 對應前後兩次取樣；新出現的線程以本次取樣間隔內的時間計算，已結束的線程自動移除。
+     * 只讀取系統統計，不影響被量測的線程。
+     */
+    class ThreadCpuSampler
+    {
+    public:
+        ProcessUsageSample sample();
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        std::unordered_map<uint64_t, uint64_t> m_lastCpuNs;
+        std::vector<ThreadCpuTimes> m_threads; // 讀取緩衝（重用）
+        ProcessMemoryStats m_lastMemory;
+        Clock::time_point m_lastSample;
+        bool m_hasLast = false;
+    };
+
+} // namespace basler
+
+#endif // THREAD_CPU_SAMPLER_H
@@ -0,0 +1,34 @@
+#ifndef THREAD_SCHEDULING_H
+#define THREAD_SCHEDULING_H
+
+namespace basler
+{
+
+    /**
+     * @brief 管線線程角色（對應 SchedulingConfig 的各區段）
+     */
+    enum class ThreadRole
+    {
+        Grab,      // 相機抓取 / 影片播放發布
+        Detection, // 檢測管線
+        Inference, // YOLO 非同步推理
+        Recording, // 錄影寫檔 / 事件錄影
+        Control,   // 震動機控制迴圈 / Modbus 通訊
+        Ui         // 主線程（事件循環）
+    };
+
+    const char *threadRoleName(ThreadRole role);
+
+    /**
+     * @brief 依 SchedulingConfig 對呼叫線程套用角色排程，並將實際結果寫入日誌
+     * @param pinnedCore 單一核心覆寫（多相機 grabCore / detectionCore、controlThreadCore；-1 = 依配置）
+     *
+     * 允許核心 = affinity ∩ 核心類型 ∩ NUMA 節點（交集為空時忽略提示並警告）。
+     * 於線程啟動時在該線程內呼叫；SchedulingConfig::enabled 為 false 時只套用 pinnedCore。
+     * 主線程應最先呼叫（ThreadRole::Ui），以記下程序原本允許的核心供未設定 affinity 的角色還原。
+     */
+    void applyThreadScheduling(ThreadRole role, int pinnedCore = -1);
+
+} // namespace basler
+
+#endif // THREAD_SCHEDULING_H
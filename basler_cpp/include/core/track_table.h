@@ -0,0 +1,149 @@
+#ifndef TRACK_TABLE_H
+#define TRACK_TABLE_H
+
+#include <QtGlobal>
+#include <array>
+#include <vector>
+
+namespace basler
+{
+
+    /**
+     * @brief 固定容量環形歷史（取代 vector push_back + erase(begin())）
+     */
+    template <typename T, int N>
+    struct RingHistory
+    {
+        std::array<T, N> items{};
+        int head = 0;  // 下一個寫入位置
+        int count = 0; // 有效筆數（<= N）
+
+        void clear()
+        {
+            head = 0;
+            count = 0;
+        }
+
+        void push(const T &value)
+        {
+            items[head] = value;
+            head = (head + 1) % N;
+            if (count < N)
+                ++count;
+        }
+
+        int size() const { return count; }
+
+        // 由新到舊取值：back(0) = 最新，back(1) = 前一筆
+        const T &back(int age = 0) const { return items[(head + N - 1 - age) % N]; }
+    };
+
+    /**
+     * @brief 追蹤點（歷史位置）
+     */
+    struct TrackPoint
+    {
+        int x = 0;
+        int y = 0;
+    };
+
+    /**
+     * @brief 物件追蹤表（結構陣列 SoA）
+     *
+     * 取代 std::map<int, ObjectTrack> 活動 / 失去兩張表，以及每幀重建的 newTracks：
+     * 1. 活動與失去追蹤放在同一張表，以 state 欄位區分；狀態轉移不搬移資料
+     * 2. 每個屬性一個連續陣列，匹配迴圈只掃描用到的幾欄
+     * 3. 槽位依建立順序排列（= trackId 遞增），迭代順序與原本的 map 相同
+     * 4. 移除先標記為 Dead，compact() 一次穩定壓縮；預留容量後穩態不配置記憶體
+     * 5. 位置 / 面積歷史為固定容量環形緩衝
+     */
+    class TrackTable
+    {
+    public:
+        static constexpr int HISTORY_LENGTH = 10;
+
+        enum State : quint8
+        {
+            Active = 0, // 本幀參與匹配與計數
+            Lost = 1,   // 暫時失去，可被恢復
+            Dead = 2    // 待 compact() 移除
+        };
+
+        explicit TrackTable(int reserveCapacity = 256);
+
+        int size() const { return static_cast<int>(trackId.size()); }
+        int count(State s) const;
+        void clear();
+
+        /**
+         * @brief 新增一筆活動追蹤（附加在表尾）
+         * @return 槽位索引
+         */
+        int add(int id, int cx, int cy, int width, int height, int objArea, int frame);
+
+        /**
+         * @brief 以新偵測更新槽位（位置、尺寸、歷史、Y 範圍、ROI 幀數；missedFrames 歸零）
+         */
+        void observe(int slot, int cx, int cy, int width, int height, int objArea, int frame);
+
+        /**
+         * @brief 以最近兩筆歷史位置更新速度與預測位置
+         */
+        void updateVelocity(int slot);
+
+        /**
+         * @brief 移除標記為 Dead 的槽位（穩定壓縮，維持 trackId 遞增順序）
+         */
+        void compact();
+
+        // ===== 欄位（索引 = 槽位）=====
+        std::vector<int> trackId;
+        std::vector<quint8> state;
+        std::vector<quint8> matched; // 本幀已匹配（updateObjectTracks 暫存）
+        std::vector<int> x, y;       // 當前位置
+        std::vector<int> w, h;       // 當前寬高
+        std::vector<int> area;       // 當前面積
+        std::vector<int> firstFrame; // 首次出現幀
+        std::vector<int> lastFrame;  // 最後出現幀
+        std::vector<int> inRoiFrames;
+        std::vector<int> maxY, minY; // Y 軸移動範圍
+        std::vector<int> firstY;     // 首次出現的 Y 位置（用於方向驗證）
+        std::vector<quint8> counted;
+        std::vector<double> velocityX, velocityY;
+        std::vector<double> predictedX, predictedY;
+        std::vector<int> missedFrames; // 連續未匹配幀數
+        std::vector<RingHistory<TrackPoint, HISTORY_LENGTH>> positions;
+        std::vector<RingHistory<int, HISTORY_LENGTH>> areaHistory;
+
+    private:
+        // 對 state 以外的所有欄位執行 f（reserve / clear / compact 共用）
+        template <typename F>
+        void forEachColumn(F &&f)
+        {
+            f(trackId);
+            f(matched);
+            f(x);
+            f(y);
+            f(w);
+            f(h);
+            f(area);
+            f(firstFrame);
+            f(lastFrame);
+            f(inRoiFrames);
+            f(maxY);
+            f(minY);
+            f(firstY);
+            f(counted);
+            f(velocityX);
+            f(velocityY);
+            f(predictedX);
+            f(predictedY);
+            f(missedFrames);
+            f(positions);
+            f(areaHistory);
+        }
+    };
+
+} // namespace basler
+
+#endif // TRACK_TABLE_H
@@ -0,0 +1,181 @@
+#ifndef VIBRATOR_CONTROL_LOOP_H
+#define VIBRATOR_CONTROL_LOOP_H
+
+#include <QObject>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "core/stage_profiler.h"
+
+namespace basler {
+
+class DualVibratorManager;
+class VibratorControllerBase;
+
+/**
+ * @brief 計數事件（檢測線程 → 控制線程）
+ */
+struct CountEvent {
+    int lane = -1;            // -1 = 單一 ROI（兩台震動機同步）；>= 0 = 該料道的震動機
+    int count = 0;            // 計數後的累計值
+    int speedPercent = 0;     // 檢測端依包裝進度決定的速度（VibratorSpeed 的百分比值）
+    int64_t timestampNs = 0;  // 計數成立的時間（steady_clock）
+};
+
+/**
+ * @brief 有界無鎖多生產者 / 單消費者佇列（每槽序號，Vyukov 演算法）
+ *
+ * 生產者為檢測線程（多料道時為 parallel_for_ 工作線程），push() 只做一次 CAS，不配置記憶體；
+ * 佇列滿（或超過 setLimit() 的排隊上限）時回傳 false，由呼叫端計入丟棄數，絕不阻塞檢測。
+ */
+class CountEventQueue {
+public:
+    explicit CountEventQueue(int capacity = 256); // 向上取到 2 的冪次
+
+    CountEventQueue(const CountEventQueue&) = delete;
+    CountEventQueue& operator=(const CountEventQueue&) = delete;
+
+    bool push(const CountEvent& event);
+    bool pop(CountEvent& event); // 只允許單一消費者線程
+    bool empty() const;
+    int capacity() const { return static_cast<int>(m_mask + 1); }
+
+    /**
+     * @brief 可排隊的事件數上限（不超過 capacity()；任意線程，不重新配置）
+     */
+    void setLimit(int limit);
+    int limit() const { return static_cast<int>(m_limit.load(std::memory_order_relaxed)); }
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> sequence{0};
+        CountEvent event;
+    };
+
+    std::unique_ptr<Slot[]> m_slots;
+    uint64_t m_mask = 0;
+    std::atomic<uint64_t> m_limit{0};
+    alignas(64) std::atomic<uint64_t> m_enqueuePos{0};
+    alignas(64) std::atomic<uint64_t> m_dequeuePos{0};
+};
+
+/**
+ * @brief 計數→致動延遲統計（快照值，可合併）
+ */
+struct VibratorLatencySnapshot {
+    LatencyHistogram dispatch;      // 計數 → 控制線程取出
+    LatencyHistogram actuation;     // 計數 → 震動機速度設定完成（只含速度改變的事件）
+    LatencyHistogram stop;          // 計數 → 停止指令完成（actuation 的子集）
+    LatencyHistogram countInterval; // 同一料道相鄰兩次計數的間隔
+    uint64_t droppedEvents = 0;     // 佇列滿而丟棄的事件
+    double windowMs = 0.0;
+
+    void merge(const VibratorLatencySnapshot& other);
+};
+
+/**
+ * @brief 震動機即時控制線程
+ *
+ * 原路徑：updateVibratorSpeed → vibratorSpeedChanged（排隊信號）→ MainWindow → DualVibratorManager::setSpeed，
+ * 停止指令要等 UI 事件循環輪到才送出，延遲沒有上限；超過目標一顆就是一包不良品。
+ *
+ * 本線程由檢測端直接 post() 計數事件（無鎖佇列），取出後立即對 VibratorControllerBase 設定速度：
+ * 1. 佇列空時先自旋 controlSpinUs 微秒，再以條件變數休眠（生產者只在消費者休眠時才通知）
+ * 2. 啟動時依 SchedulingConfig::control 套用排程（預設即時優先權；controlThreadCore 指定時綁定該核心）
+ * 3. 每個事件記錄計數→取出、計數→致動延遲與計數間隔；每 latencyReportIntervalMs 輸出一次，
+ *    並以「advanceStopCount × 計數間隔 p5（較快的落料）」對照最慢的停止延遲，判斷提前停止的餘裕是否足夠
+ *
+ * 執行中時致動只由本線程進行；Qt 信號仍照常發出，供 UI 顯示。
+ */
+class VibratorControlLoop : public QObject {
+    Q_OBJECT
+
+public:
+    explicit VibratorControlLoop(QObject* parent = nullptr);
+    ~VibratorControlLoop();
+
+    VibratorControlLoop(const VibratorControlLoop&) = delete;
+    VibratorControlLoop& operator=(const VibratorControlLoop&) = delete;
+
+    /**
+     * @brief 指定震動機（外部擁有，停止狀態下呼叫）
+     */
+    void setVibrators(DualVibratorManager* manager) { m_vibrators = manager; }
+
+    /**
+     * @brief 依 PackagingConfig 啟動控制線程（realtimeControl 為 false 或沒有震動機時不啟動）
+     * @return 是否在執行中
+     */
+    bool start();
+    void stop();
+    bool isRunning() const { return m_running.load(); }
+
+    /**
+     * @brief 送出計數事件（任意線程，無鎖、不阻塞）
+     * @return false = 未執行或佇列已滿（丟棄並計數）
+     */
+    bool post(int lane, int count, int speedPercent);
+
+    /**
+     * @brief 取出目前窗口並開始新窗口（任意線程）
+     */
+    VibratorLatencySnapshot collect();
+
+    /**
+     * @brief 自啟動以來的累計統計（任意線程）
+     */
+    VibratorLatencySnapshot total() const;
+
+    /**
+     * @brief 計數→致動延遲估計（奈秒；慢速衰減的峰值，0 = 尚無量測；任意線程）
+     */
+    int64_t actuationLatencyNs() const { return m_actuationEstimateNs.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr int MAX_LANES = 2;
+    static constexpr int MAX_QUEUE_CAPACITY = 4096; // 佇列建構時配置的容量（controlQueueCapacity 的上限）
+    static constexpr int LANE_ALL = MAX_LANES; // lastApplied / lastCount 中單一 ROI 的位置
+
+    void controlLoop();
+    bool waitForEvent(int64_t spinNs);
+    void handleEvent(const CountEvent& event, int64_t dequeuedNs);
+    bool applySpeed(int lane, int speedPercent);
+    void logSnapshot(const char* label, const VibratorLatencySnapshot& snapshot) const;
+
+    DualVibratorManager* m_vibrators = nullptr;
+    // 建構時配置一次、之後不再替換：停止後仍可能有檢測端的 post() 正在存取
+    CountEventQueue m_queue{MAX_QUEUE_CAPACITY};
+
+    std::thread m_thread;
+    std::atomic<bool> m_running{false};
+    int m_core = -1;
+    int64_t m_spinNs = 0;
+    int m_reportIntervalMs = 0;
+    int m_advanceStopCount = 0;
+
+    // 休眠 / 喚醒（生產者只在 m_sleeping 時取鎖通知）
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wakeCv;
+    std::atomic<bool> m_sleeping{false};
+
+    // 只由控制線程使用
+    std::array<int, MAX_LANES + 1> m_lastApplied{};    // 最近一次設定的速度（-1 = 尚未設定）
+    std::array<int64_t, MAX_LANES + 1> m_lastCountNs{}; // 最近一次計數時間（0 = 無）
+
+    // 統計（控制線程寫入，collect() / total() 讀取；臨界區只有直方圖累加 / 複製）
+    mutable std::mutex m_statsMutex;
+    VibratorLatencySnapshot m_window;
+    VibratorLatencySnapshot m_total;
+    int64_t m_windowStartNs = 0;
+    std::atomic<uint64_t> m_dropped{0};
+    std::atomic<int64_t> m_actuationEstimateNs{0};
+};
+
+} // namespace basler
+
+#endif // VIBRATOR_CONTROL_LOOP_H
@@ -3,6 +3,7 @@
 
 #include <QObject>
 #include <QString>
+#include <atomic>
 #include <memory>
 
 namespace basler {
@@ -66,8 +67,8 @@ signals:
 
 protected:
     QString m_name;
-    bool m_isRunning = false;
-    int m_speedPercent = 0;
+    std::atomic<bool> m_isRunning{false}; // 即時控制線程與 UI 線程都會設定速度
+    std::atomic<int> m_speedPercent{0};
 };
 
 /**
@@ -113,6 +114,11 @@ public:
     VibratorControllerBase* vibrator1() const { return m_vibrator1.get(); }
     VibratorControllerBase* vibrator2() const { return m_vibrator2.get(); }
 
+    /**
+     * @brief 依料道取得震動機（0 = 震動機1，1 = 震動機2；其他為 nullptr）
+     */
+    VibratorControllerBase* vibrator(int lane) const;
+
     struct DualStatus {
         struct {
             bool isRunning;
@@ -144,9 +150,17 @@ public slots:
      */
     void setSpeedPercent(int percent);
 
+    /**
+     * @brief 只設置單一料道震動機的速度（多相機管線依各料道的包裝進度分別控制）
+     * @param lane 0 或 1
+     * @param speed 速度枚舉
+     */
+    void setLaneSpeed(int lane, VibratorSpeed speed);
+
 signals:
     void runningStateChanged(bool isRunning);
     void speedChanged(VibratorSpeed speed);
+    void laneSpeedChanged(int lane, VibratorSpeed speed);
 
 private:
     std::unique_ptr<VibratorControllerBase> m_vibrator1;
@@ -156,18 +170,20 @@ private:
 
 /**
  * @brief 工廠函數：創建震動機控制器
- * @param type "simulated" 或 "hardware"
+ * @param type "simulated"、"modbus_rtu"、"modbus_tcp" 或 "hardware"（依 vibrator.driver 設定）
  * @param name 控制器名稱
+ * @param index 震動機序號（0 / 1，決定 Modbus 站號 unitId1 / unitId2）
  * @return 控制器指針
  */
 std::unique_ptr<VibratorControllerBase> createVibratorController(
     const QString& type = "simulated",
-    const QString& name = "Vibrator"
+    const QString& name = "Vibrator",
+    int index = 0
 );
 
 /**
  * @brief 工廠函數：創建雙震動機管理器
- * @param controllerType "simulated" 或 "hardware"
+ * @param controllerType 同 createVibratorController 的 type
  * @param name1 震動機1名稱
  * @param name2 震動機2名稱
  * @return 管理器指針
@@ -5,21 +5,90 @@
 #include <QThread>
 #include <QMutex>
 #include <QString>
+#include <algorithm>
 #include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 #include <opencv2/core.hpp>
 #include <opencv2/videoio.hpp>
 
+#include "core/frame_ring.h"
+
 namespace basler {
 
+class RawCaptureReader;
+class SyntheticPartsGenerator;
+struct SyntheticConfig;
+
+/**
+ * @brief 帶快取的影片解碼（關鍵幀感知的單步後退）
+ *
+ * 最近解碼的幀保留在固定容量的 LRU 快取中。往後跳（目標在解碼器位置之前）且未命中時，
+ * 從目標往前 stepBackSpan 幀跳轉一次（解碼器自行落在其前的關鍵幀），正向解碼整段填入快取，
+ * 之後連續後退 stepBackSpan - 1 步都直接命中；正向連續讀取不跳轉。
+ * 非線程安全：播放時由解碼線程使用，停止時由 VideoPlayer 使用。
+ */
+class CachedVideoDecoder {
+public:
+    void reset(cv::VideoCapture* capture, int cacheFrames, int stepBackSpan);
+
+    /**
+     * @brief 取得第 index 幀（複製到 out，重用 out 的緩衝）
+     */
+    bool frameAt(int index, cv::Mat& out);
+
+private:
+    struct Entry {
+        int index = -1;
+        cv::Mat frame;
+        quint64 lastUse = 0;
+    };
+
+    Entry* find(int index);
+    Entry& evictSlot(); // 空槽或最久未用的槽
+
+    cv::VideoCapture* m_capture = nullptr;
+    int m_position = 0; // 解碼器的下一幀
+    int m_stepBackSpan = 30;
+    std::vector<Entry> m_entries;
+    quint64 m_clock = 0;
+};
+
 /**
  * @brief 視頻播放工作線程
+ *
+ * 1. 解碼在內部的預解碼線程進行，放進有界佇列（緩衝循環重用）；播放線程只負責節奏與發布
+ * 2. 節奏以 steady_clock 的絕對時間表排程（第 n 幀 = 起點 + n × 幀間隔），解碼與睡眠誤差不累積；
+ *    落後過多（例如無損消費者長時間未讀）時重新起算，不連續爆發追趕
+ * 3. 解碼後的幀直接寫入 FrameRing，信號只攜帶序號與幀索引
+ * 4. 原始擷取來源不解碼：直接從映射記憶體取幀，並帶回錄製時的區塊 ID / 相機時間戳 / 曝光
+ * 5. 合成來源由 SyntheticPartsGenerator 依幀索引產生（與解碼相同走緩衝循環）
  */
 class VideoPlayWorker : public QObject {
     Q_OBJECT
 
 public:
-    explicit VideoPlayWorker(cv::VideoCapture* capture, double fps, QObject* parent = nullptr);
+    explicit VideoPlayWorker(CachedVideoDecoder* decoder, double fps, FrameRing* ring, QObject* parent = nullptr);
+    ~VideoPlayWorker();
+
+    // 以下需在 startPlaying 前設定
+    void setRawSource(const RawCaptureReader* reader); // 改用原始擷取來源（decoder 不使用）
+    void setSyntheticSource(const SyntheticPartsGenerator* generator); // 改用合成來源（decoder 不使用）
+    void setStartFrame(int frameIndex) { m_startFrame = frameIndex; }
+    void setPrefetchFrames(int frames) { m_prefetchCapacity = std::max(1, frames); }
+
+    /**
+     * @brief 跳轉（任意線程）：丟棄已預解碼的幀並從 frameIndex 重新解碼
+     * @param publishWhilePaused 暫停中也發布該幀一次（單步）
+     */
+    void requestSeek(int frameIndex, bool publishWhilePaused);
+
+    // 最後發布的幀索引（-1 = 尚未發布）
+    int lastPublishedFrame() const { return m_lastPublished.load(); }
 
 public slots:
     void startPlaying(bool loop);
@@ -28,21 +97,52 @@ public slots:
     void resume();
 
 signals:
-    void frameReady(const cv::Mat& frame, int frameIndex);
+    void frameReady(quint64 sequence, int frameIndex);
     void playbackFinished();
     void playError(const QString& error);
 
 private:
-    cv::VideoCapture* m_capture;
+    struct DecodedFrame {
+        cv::Mat image;
+        FrameMeta meta; // 原始擷取的區塊 ID / 時間戳 / 曝光
+        int index = 0;
+        quint64 generation = 0;
+    };
+
+    void decodeLoop(bool loop);
+    void stopDecoding();
+
+    CachedVideoDecoder* m_decoder;
+    const RawCaptureReader* m_raw = nullptr;
+    const SyntheticPartsGenerator* m_synthetic = nullptr;
     double m_fps;
+    FrameRing* m_ring;
+    int m_startFrame = 0;
     std::atomic<bool> m_running{false};
     std::atomic<bool> m_paused{false};
+    std::atomic<int> m_lastPublished{-1};
+
+    // 預解碼佇列
+    std::thread m_decodeThread;
+    std::mutex m_queueMutex;
+    std::condition_variable m_queueNotEmpty;
+    std::condition_variable m_queueNotFull;
+    std::deque<DecodedFrame> m_queue;
+    std::vector<cv::Mat> m_freeBuffers;
+    int m_prefetchCapacity = 16;
+    quint64 m_generation = 0; // 每次跳轉遞增，丟棄跳轉前解碼的幀
+    int m_seekRequest = -1;
+    bool m_stepPending = false;
+    bool m_decodeFinished = false;
 };
 
 /**
  * @brief 視頻文件播放器 - 模擬相機輸入
  *
- * 用於測試模式，無需實體相機即可測試檢測算法
+ * 用於測試模式，無需實體相機即可測試檢測算法。
+ * 也可載入原始擷取（*.rawcap 目錄或其 index.bin），任意幀跳轉為 O(1)；
+ * 或合成落料序列（*.synth.json / loadSynthetic()），真值由 syntheticSource() 取得。
+ * 播放中的跳轉 / 單步交給 VideoPlayWorker 的解碼線程；停止時直接經 CachedVideoDecoder 解碼。
  */
 class VideoPlayer : public QObject {
     Q_OBJECT
@@ -62,7 +162,12 @@ public:
     // 狀態查詢
     bool isPlaying() const { return m_isPlaying.load(); }
     bool isPaused() const { return m_isPaused.load(); }
-    bool isLoaded() const { return m_capture != nullptr && m_capture->isOpened(); }
+    bool isLoaded() const { return isRawCapture() || isSynthetic() || (m_capture != nullptr && m_capture->isOpened()); }
+    bool isRawCapture() const { return m_rawReader != nullptr; }
+    bool isSynthetic() const { return m_synthetic != nullptr; }
+
+    // 合成來源（含真值軌跡；未載入合成序列時為 nullptr）
+    const SyntheticPartsGenerator* syntheticSource() const { return m_synthetic.get(); }
 
     // 視頻信息
     double fps() const { return m_fps; }
@@ -75,6 +180,15 @@ public:
     // 進度
     double progress() const;
 
+    // 幀環形緩衝（需在 startPlaying 前設定；nullptr 則恢復使用內建緩衝）
+    void setFrameRing(FrameRing* ring);
+    FrameRing* frameRing() const { return m_frameRing; }
+
+    /**
+     * @brief 載入合成落料序列（不需描述檔；*.synth.json 經 loadVideo() 載入）
+     */
+    bool loadSynthetic(const SyntheticConfig& config);
+
 public slots:
     /**
      * @brief 加載視頻文件
@@ -127,7 +241,7 @@ public slots:
 
 signals:
     void videoLoaded(const QString& path, int totalFrames, double fps);
-    void frameReady(const cv::Mat& frame);
+    void frameReady(quint64 sequence);  // 新幀已寫入 FrameRing
     void frameChanged(int frameIndex);
     void playingStateChanged(bool isPlaying);
     void playbackFinished();
@@ -135,12 +249,20 @@ signals:
     void playError(const QString& error);
 
 private slots:
-    void onFrameReady(const cv::Mat& frame, int frameIndex);
+    void onFrameReady(quint64 sequence, int frameIndex);
     void onPlaybackFinished();
     void onPlayError(const QString& error);
 
 private:
+    bool loadRawCapture(const QString& path);
+    bool finishSyntheticLoad(const QString& label);
+    bool publishFrameAt(int frameIndex); // 停止時的單步 / 跳轉顯示
+
     std::unique_ptr<cv::VideoCapture> m_capture;
+    std::unique_ptr<RawCaptureReader> m_rawReader;
+    std::unique_ptr<SyntheticPartsGenerator> m_synthetic;
+    CachedVideoDecoder m_decoder;
+    int m_nextFrame = 0; // 停止時下一個要播放 / 單步的幀
     std::unique_ptr<QThread> m_playThread;
     std::unique_ptr<VideoPlayWorker> m_playWorker;
 
@@ -154,8 +276,10 @@ private:
     std::atomic<bool> m_isPlaying{false};
     std::atomic<bool> m_isPaused{false};
 
-    cv::Mat m_latestFrame;
-    QMutex m_frameMutex;
+    // 幀環形緩衝（預設使用內建緩衝，SourceManager 會換成共用緩衝）
+    std::unique_ptr<FrameRing> m_ownedRing;
+    FrameRing* m_frameRing = nullptr;
+    cv::Mat m_stepFrame;  // 單步解碼緩衝（重用，避免每次配置；原始擷取時指向映射記憶體）
 };
 
 } // namespace basler
@@ -6,13 +6,24 @@
 #include <QDateTime>
 #include <QDir>
 #include <QMutex>
+#include <QMetaType>
 #include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 #include <opencv2/core.hpp>
 #include <opencv2/videoio.hpp>
 
+#include "core/frame_overlay.h"
+#include "core/frame_ring.h"
+
 namespace basler {
 
+class RawCaptureWriter;
+
 /**
  * @brief 錄製信息結構
  */
@@ -23,12 +34,28 @@ struct RecordingInfo {
     double duration = 0.0;
     double averageFps = 0.0;
     QString codec;
+
+    // 編碼佇列統計
+    int queueDepth = 0;            // 目前排隊幀數（停止後為 0）
+    int maxQueueDepth = 0;         // 本次錄製的最大排隊幀數
+    int framesDropped = 0;         // 佇列滿而丟棄的幀數
+    double averageEncodeMs = 0.0;  // 單幀編碼平均耗時
+    double maxEncodeMs = 0.0;      // 單幀編碼最大耗時
 };
 
 /**
  * @brief 視頻錄製器
  *
- * 支持多種編碼器自動選擇，線程安全的幀寫入
+ * 支持多種編碼器自動選擇：依 RecordingConfig::encoderBackend 先試硬體編碼器
+ * （QSV / VAAPI 經 OpenCV FFmpeg 硬體加速、NVENC 經 GStreamer、macOS 經 AVFoundation/VideoToolbox），
+ * 開不起來時退回軟體 mp4v / MJPG / XVID。單通道來源以灰階模式開啟編碼器，不先轉成 BGR。
+ * 編碼在專用線程執行：
+ * 1. writeFrame / enqueueFrame 只把幀放進有界佇列（緩衝循環重用，穩態不配置），呼叫端不等編碼
+ * 2. 佇列滿時依 RecordingConfig 丟棄新幀，或等待空位（有上限）後丟棄
+ * 3. 進度以 recordingProgress 節流發出（從錄影線程發出，連接時需指定接收物件）
+ * 4. stopRecording() 等佇列中的幀全部寫完才關閉檔案
+ * 5. RecordingConfig::format == "raw" 時改寫無損原始擷取（RawCaptureWriter），幀的 FrameMeta 一併保存
+ * 6. RecordingConfig::burnInOverlay 時在錄影線程把排入的 FrameOverlay 燒入幀（檢測線程不再為此複製幀）
  */
 class VideoRecorder : public QObject {
     Q_OBJECT
@@ -45,31 +72,60 @@ public:
     // 狀態查詢
     bool isRecording() const { return m_isRecording.load(); }
     int framesRecorded() const { return m_framesRecorded.load(); }
+    int framesDropped() const { return m_framesDropped.load(); }
+    int queueDepth() const { return m_queueDepth.load(); }
+    bool isBurningIn() const { return m_burnIn; } // 本次錄製燒入檢測疊加（RecordingConfig::burnInOverlay）
     double recordingDuration() const;
 
+    /**
+     * @brief 目前錄製的即時統計（任意線程）
+     */
+    RecordingInfo currentInfo() const;
+
     // 輸出目錄
     QString outputDirectory() const { return m_outputPath.path(); }
     void setOutputDirectory(const QString& dir);
 
+    /**
+     * @brief 無損佇列：佇列滿時一律等待空位而不丟幀（覆寫 RecordingConfig 的丟幀策略，錄製前設定）
+     *
+     * 供自行控制節奏的呼叫端（例如事件錄影的預觸發幀），不要在 UI 線程使用。
+     */
+    void setLossless(bool lossless) { m_lossless = lossless; }
+
 public slots:
     /**
-     * @brief 開始錄製
+     * @brief 開始錄製（在呼叫端開啟編碼器，成功後啟動錄影線程）
      * @param frameSize 幀尺寸 (width, height)
      * @param fps 錄製幀率
      * @param filename 自定義文件名（不含副檔名）
+     * @param isColor false = 單通道（mono8）幀
      * @return 是否成功開始錄製
      */
-    bool startRecording(const QSize& frameSize, double fps = 30.0, const QString& filename = QString());
+    bool startRecording(const QSize& frameSize, double fps = 30.0, const QString& filename = QString(),
+                        bool isColor = true);
 
     /**
-     * @brief 寫入一幀
+     * @brief 排入一幀（複製到佇列緩衝）
      * @param frame 要寫入的幀
-     * @return 是否成功寫入
+     * @param meta 幀的來源資訊（原始擷取模式寫入幀標頭）
+     * @return 是否成功排入（未錄製或佇列滿而丟棄時回傳 false）
      */
-    bool writeFrame(const cv::Mat& frame);
+    bool writeFrame(const cv::Mat& frame, const FrameMeta& meta = FrameMeta());
 
     /**
-     * @brief 停止錄製
+     * @brief 排入一幀（不複製：取走 frame 的資料，並換回一個可重用的舊緩衝或空 Mat）
+     * @return 是否成功排入（失敗時 frame 不變）
+     */
+    bool enqueueFrame(cv::Mat& frame, const FrameMeta& meta = FrameMeta());
+
+    /**
+     * @brief 同上，並附上檢測疊加：isBurningIn() 時在錄影線程燒入後再編碼，否則忽略
+     */
+    bool enqueueFrame(cv::Mat& frame, const FrameMeta& meta, const FrameOverlay& overlay);
+
+    /**
+     * @brief 停止錄製（等待已排入的幀寫完）
      * @return 錄製信息
      */
     RecordingInfo stopRecording();
@@ -84,13 +140,36 @@ signals:
     void recordingStopped(const RecordingInfo& info);
     void recordingStateChanged(bool isRecording);
     void recordingError(const QString& error);
-    void frameWritten(int totalFrames);
+    void recordingProgress(const RecordingInfo& info); // 節流（RecordingConfig::progressIntervalMs）
 
 private:
-    bool tryCodec(const QString& codecName, int fourcc, const QString& extension,
-                  const QSize& frameSize, double fps);
-
-    std::unique_ptr<cv::VideoWriter> m_videoWriter;
+    bool openRawCapture(const QString& filename, double fps);
+    struct EncoderCandidate {
+        QString name;
+        int apiPreference;
+        int fourcc;
+        QString extension;
+        std::vector<int> params; // cv::VideoWriter 參數（VIDEOWRITER_PROP_*）
+        QString pipeline;        // GStreamer 管線（%1 = 輸出路徑）；空 = 以檔名開啟
+    };
+
+    static std::vector<EncoderCandidate> encoderCandidates(const QString& backend, bool isColor);
+    bool tryEncoder(const EncoderCandidate& encoder, const QSize& frameSize, double fps, bool isColor);
+
+    // 取得佇列空位（需持有 m_queueMutex）；依策略等待，逾時回傳 false 並計入丟幀
+    bool waitForSpace(std::unique_lock<std::mutex>& lock);
+    void writerLoop();
+    const cv::Mat& composeBurnIn(cv::Mat& image, const FrameOverlay& overlay);
+    void fillStats(RecordingInfo& info) const;
+
+    struct QueuedFrame {
+        cv::Mat image;
+        FrameMeta meta;
+        FrameOverlay overlay; // 只在 m_burnIn 時使用
+    };
+
+    std::unique_ptr<cv::VideoWriter> m_videoWriter; // 錄製期間只由錄影線程使用
+    std::unique_ptr<RawCaptureWriter> m_rawWriter;  // 原始擷取模式（同上）
     QDir m_outputPath;
 
     std::atomic<bool> m_isRecording{false};
@@ -102,9 +181,34 @@ private:
     double m_fps = 30.0;
     QDateTime m_recordingStartTime;
 
-    QMutex m_writerMutex;
+    // 有界編碼佇列（錄影線程消費）
+    std::thread m_writerThread;
+    std::mutex m_queueMutex;
+    std::condition_variable m_frameAvailable;
+    std::condition_variable m_spaceAvailable;
+    std::deque<QueuedFrame> m_queue;
+    std::vector<cv::Mat> m_freeBuffers; // 已寫完、可重用的幀緩衝
+    bool m_stopWriter = false;
+    int m_queueCapacity = 64;
+    bool m_blockWhenFull = false;
+    bool m_lossless = false;
+    bool m_burnIn = false;
+    cv::Mat m_burnInFrame; // 單通道來源燒入用的 BGR 緩衝（錄影線程專用）
+    int m_blockTimeoutMs = 20;
+    int m_progressIntervalMs = 250;
+
+    // 統計（錄影線程寫入，任意線程讀取）
+    std::atomic<int> m_framesDropped{0};
+    std::atomic<int> m_queueDepth{0};
+    std::atomic<int> m_maxQueueDepth{0};
+    std::atomic<double> m_encodeTotalMs{0.0};
+    std::atomic<double> m_maxEncodeMs{0.0};
+
+    QMutex m_controlMutex; // start / stop 互斥
 };
 
 } // namespace basler
 
+Q_DECLARE_METATYPE(basler::RecordingInfo)
+
 #endif // VIDEO_RECORDER_H
@@ -2,24 +2,65 @@
 #define YOLO_DETECTOR_H
 
 #include <opencv2/core.hpp>
-#include <opencv2/dnn.hpp>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
 #include <string>
+#include <thread>
 #include <vector>
 #include <mutex>
 
+#include "core/letterbox_tensor.h"
+#include "core/yolo_postprocess.h"
+
 namespace basler
 {
 
     // 前向聲明（避免循環依賴）
     struct DetectedObject;
+    class InferenceBackend;
+    enum class ModelPrecision;
+
+    /**
+     * @brief 非同步推理的單幀結果（依提交順序交付）
+     */
+    struct YoloFrameResult
+    {
+        uint64_t frameId = 0;                // 提交時的幀 ID
+        std::vector<DetectedObject> objects; // 偵測結果（原圖座標系）
+        double inferenceMs = 0.0;            // 所屬批次的 forward + 後處理耗時
+        int batchSize = 1;                   // 所屬批次的幀數
+        int tileCount = 1;                   // 此幀切成的 tile 數（未啟用 tile 推理時為 1）
+    };
 
     /**
      * @brief YOLO ONNX 推理引擎
      *
-     * 純 C++17 + OpenCV DNN，不依賴 Qt。
+     * 純 C++17 + OpenCV，不依賴 Qt。
      * 支援 ROI 感知推理：ROI 放大 → letterbox → blob → 推理 → NMS → 座標反映射
+     * 「推理」一步由 InferenceBackend 執行（opencv / onnxruntime / openvino），前後處理不變
      *
      * 線程安全：所有公開方法透過 std::mutex 保證線程安全
+     *
+     * 非同步推理（submitAsync / takeResults）：
+     * 1. 呼叫端線程做前處理（ROI → 輸入 tensor），推理線程做 forward → 後處理，兩者重疊
+     * 2. 兩組批次緩衝輪替：推理線程處理一組時，呼叫端填另一組
+     * 3. 推理線程閒置時立即送出（延遲最低）；忙碌時累積到 batchSize 張 ROI 條帶一次 forward
+     * 4. 結果帶原始幀 ID，依提交順序交付
+     * 5. 模型不支援批次（固定 batch=1 匯出）時自動改為逐張 forward
+     *
+     * Tile 推理（setTiling）：
+     * 細長 ROI 條帶（例如 640×120）整條 letterbox 進 640×640 時，放大倍數會被 letterbox 的縮小抵銷，
+     * 且 80% 以上的輸入是填充。啟用後條帶切成數個重疊的方形 tile（邊長 = ROI 高度），
+     * 同一幀的所有 tile 在同一次 batch forward 中推理：
+     * - 每個 tile 只保留中心點落在自己負責區間（重疊區中線為界）的框
+     * - 接縫兩側的框 IoMin > 0.5 視為同一物件（被切斷的一側較小），保留較大者
+     * - inputSize 應與 tile 放大後的邊長相近（ROI 高 120、放大 2 倍 → 以 imgsz=256 匯出的模型）
+     *
+     * 限制：submitAsync / takeResults / discardPendingResults 只能由同一個線程呼叫。
      */
     class YoloDetector
     {
@@ -32,12 +73,31 @@ namespace basler
         YoloDetector &operator=(const YoloDetector &) = delete;
 
         /**
-         * @brief 載入 ONNX 模型
+         * @brief 載入 ONNX 模型並以空白輸入暖機一次（暖機完成後 isModelLoaded() 才為 true）
          * @param modelPath ONNX 檔案路徑
          * @return 是否成功載入
+         *
+         * 可在背景線程呼叫：載入期間 isModelLoaded() 回傳 false，不阻塞檢測線程。
          */
         bool loadModel(const std::string &modelPath);
 
+        /**
+         * @brief 設定推理後端（下一次 loadModel() 生效）
+         * @param backend "opencv" / "onnxruntime" / "openvino"
+         * @param device 裝置提示（"auto" / "cpu" / "cuda" / "tensorrt" / "gpu"）
+         */
+        void setBackend(const std::string &backend, const std::string &device);
+
+        /**
+         * @brief 實際使用中的後端名稱（模型未載入時為設定值）
+         */
+        std::string backendName() const;
+
+        /**
+         * @brief 已載入模型的精度（"fp32" / "fp16" / "int8"，依 export_onnx.py 的檔名後綴判斷）
+         */
+        std::string modelPrecision() const;
+
         /**
          * @brief 是否已載入模型
          */
@@ -54,35 +114,119 @@ namespace basler
         double detect(const cv::Mat &roiImage, int offsetX, int offsetY,
                        std::vector<DetectedObject> &results);
 
+        // ===== 非同步推理 =====
+        /**
+         * @brief 啟動推理線程（已啟動時只更新批次大小）
+         * @param batchSize 每次 forward 最多合併的 ROI 條帶數
+         */
+        void startAsync(int batchSize);
+
+        /**
+         * @brief 停止推理線程（等待進行中的批次結束，未交付的結果捨棄）
+         */
+        void stopAsync();
+
+        bool isAsyncRunning() const { return m_asyncRunning.load(); }
+
+        /**
+         * @brief 提交一幀 ROI（前處理在呼叫端線程完成，呼叫後 roiImage 可立即重用）
+         * @return 是否成功提交（模型未載入或推理線程未啟動時回傳 false）
+         *
+         * 兩組批次都在使用且填充中的批次已滿時，會等待推理線程讓出緩衝。
+         */
+        bool submitAsync(const cv::Mat &roiImage, int offsetX, int offsetY, uint64_t frameId);
+
+        /**
+         * @brief 取出已完成的結果（依提交順序附加到 results；不等待）
+         * @return 取出的筆數
+         */
+        size_t takeResults(std::vector<YoloFrameResult> &results);
+
+        /**
+         * @brief 捨棄所有尚未交付的結果（包含進行中的批次），例如計數重置時
+         */
+        void discardPendingResults();
+
         // 參數設定
         void setConfidenceThreshold(double threshold);
         void setNmsThreshold(double threshold);
         void setRoiUpscaleFactor(double factor);
         void setInputSize(int size);
 
+        /**
+         * @brief 設定 tile 推理
+         * @param enabled 是否將 ROI 條帶切成方形 tile
+         * @param overlap 相鄰 tile 的最小重疊寬度（ROI 像素，應大於最大零件寬度）
+         */
+        void setTiling(bool enabled, int overlap);
+
         double confidenceThreshold() const { return m_confidenceThreshold; }
         double nmsThreshold() const { return m_nmsThreshold; }
         double roiUpscaleFactor() const { return m_roiUpscaleFactor; }
         int inputSize() const { return m_inputSize; }
-        double lastInferenceTimeMs() const { return m_lastInferenceTimeMs; }
+        bool tiledInference() const { return m_tiledInference; }
+        int tileOverlap() const { return m_tileOverlap; }
+        double lastInferenceTimeMs() const { return m_lastInferenceTimeMs.load(); }
 
     private:
+        // 單次推理使用的參數快照（前處理時擷取，後處理沿用，避免持鎖跨越 forward）
+        struct InferenceParams
+        {
+            double confidenceThreshold = 0.25;
+            double nmsThreshold = 0.45;
+            double roiUpscaleFactor = 2.0;
+            int inputSize = 640;
+            bool tiled = false;
+            int tileOverlap = 32;
+        };
+
+        // 批次中單一槽位（一整條 ROI 或其中一個 tile）的反映射資訊
+        struct BatchEntry
+        {
+            uint64_t frameId = 0;
+            uint64_t generation = 0;
+            InferenceParams params;
+            double scaleX = 1.0, scaleY = 1.0;
+            int padX = 0, padY = 0;
+            int offsetX = 0, offsetY = 0; // 含 tile 在 ROI 內的 X 位置
+            int frame = 0;                // 所屬幀在批次內的索引
+            int tile = 0, tileCount = 1;
+            int ownBegin = 0, ownEnd = 0; // 負責的中心點 X 範圍 [ownBegin, ownEnd)（原圖座標）
+            int firstObject = 0;          // 此槽位的框在該幀結果中的起始索引（後處理時填入）
+        };
+
+        // 批次緩衝（呼叫端填充 / 推理線程處理，兩組輪替）
+        struct Batch
+        {
+            LetterboxTensor tensor; // [槽位數, 3, size, size]，同一幀的 tile 連續排列
+            std::vector<BatchEntry> entries;
+            std::vector<int> frameFirstSlot; // 幀 f 的第一個槽位
+            int count = 0;                   // 已填槽位數
+            int frames = 0;                  // 已填幀數
+        };
+
+        InferenceParams snapshotParams() const;
+        static void warmUp(InferenceBackend &backend, int inputSize);
+        void preprocess(const cv::Mat &roiImage, const InferenceParams &params, LetterboxTensor &tensor,
+                        int slot, double &scaleX, double &scaleY, int &padX, int &padY);
+
         /**
-         * @brief Letterbox 前處理：保持長寬比縮放到目標尺寸，灰色填充
-         * @param src 輸入影像
-         * @param dst 輸出影像（targetSize x targetSize）
-         * @param scaleX 輸出：X 軸縮放比
-         * @param scaleY 輸出：Y 軸縮放比
-         * @param padX 輸出：X 軸填充像素
-         * @param padY 輸出：Y 軸填充像素
+         * @brief 將一幀寫入批次（切 tile 後每個 tile 一個槽位）；呼叫端保證批次不被推理線程使用
+         * @param frameCapacity 批次的幀數上限（預留 tensor 槽位用）
          */
-        void letterbox(const cv::Mat &src, cv::Mat &dst,
-                        double &scaleX, double &scaleY,
-                        int &padX, int &padY);
+        void appendFrame(Batch &batch, const cv::Mat &roiImage, int offsetX, int offsetY,
+                         uint64_t frameId, uint64_t generation, const InferenceParams &params,
+                         int frameCapacity);
+        void handOffLocked(); // 需持有 m_asyncMutex
+        void inferenceLoop();
+        void runBatch(Batch &batch, std::vector<YoloFrameResult> &out);
+        void decodeSlot(BatchEntry &entry, const cv::Mat &output, std::vector<DetectedObject> &objects);
+        void mergeTileSeams(const Batch &batch, int firstSlot, std::vector<DetectedObject> &objects);
 
         /**
          * @brief 解析 YOLOv8 輸出 tensor，執行 NMS
          * @param output 模型輸出 tensor
+         * @param params 信心 / NMS 閾值快照
          * @param scaleX letterbox 的 X 縮放比
          * @param scaleY letterbox 的 Y 縮放比
          * @param padX letterbox 的 X 填充
@@ -92,14 +236,17 @@ namespace basler
          * @param offsetY ROI 在原圖的 Y 偏移
          * @param results 輸出偵測結果
          */
-        void postProcess(const cv::Mat &output,
+        void postProcess(const cv::Mat &output, const InferenceParams &params,
                           double scaleX, double scaleY,
                           int padX, int padY,
                           double upscaleRatio,
                           int offsetX, int offsetY,
                           std::vector<DetectedObject> &results);
 
-        cv::dnn::Net m_net;
+        std::unique_ptr<InferenceBackend> m_backend;
+        std::string m_backendName = "opencv";
+        std::string m_device = "auto";
+        ModelPrecision m_precision{};
         bool m_modelLoaded = false;
 
         // 推理參數
@@ -107,11 +254,35 @@ namespace basler
         double m_nmsThreshold = 0.45;
         double m_roiUpscaleFactor = 2.0;
         int m_inputSize = 640;
+        bool m_tiledInference = false;
+        int m_tileOverlap = 32;
 
         // 效能統計
-        double m_lastInferenceTimeMs = 0.0;
+        std::atomic<double> m_lastInferenceTimeMs{0.0};
+
+        mutable std::mutex m_mutex;  // 參數與模型狀態
+        std::mutex m_netMutex;       // m_backend 的 infer（同步與非同步推理共用）
+        bool m_batchUnsupported = false; // 模型只接受 batch=1（批次形狀錯誤且逐張成功時設定；m_netMutex 保護）
+        YoloPostProcessor m_postProcessor; // 後處理緩衝（m_netMutex 保護）
+        std::vector<char> m_seamRemoved;   // 接縫合併的刪除標記（m_netMutex 保護）
+
+        // 同步推理的持久批次（單幀，tile 推理時有多個槽位）
+        std::mutex m_syncMutex;
+        Batch m_syncBatch;
+        std::vector<YoloFrameResult> m_syncResults;
 
-        mutable std::mutex m_mutex;
+        // 非同步推理
+        std::thread m_inferenceThread;
+        std::atomic<bool> m_asyncRunning{false};
+        std::mutex m_asyncMutex;
+        std::condition_variable m_asyncCv;
+        std::array<Batch, 2> m_batches;
+        int m_fillIndex = 0;        // 呼叫端正在填充的批次
+        int m_pendingIndex = -1;    // 已交給推理線程、尚未開始的批次
+        bool m_inferenceBusy = false; // 推理線程正在處理批次
+        int m_batchSize = 1;
+        uint64_t m_generation = 0;  // discardPendingResults() 遞增，舊世代結果不交付
+        std::deque<YoloFrameResult> m_completed;
     };
 
 } // namespace basler
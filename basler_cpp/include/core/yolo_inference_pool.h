@@ -0,0 +1,82 @@
+#ifndef YOLO_INFERENCE_POOL_H
+#define YOLO_INFERENCE_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <opencv2/core.hpp>
+
+namespace basler
+{
+
+    struct DetectedObject;
+    class YoloDetector;
+
+    /**
+     * @brief 多條檢測管線共用的 YOLO 推理池
+     *
+     * 每個 DetectionController 各自持有一個 YoloDetector 時，N 台相機就有 N 份模型權重與推理線程，
+     * 而且彼此搶同一組 CPU / GPU。推理池只建立 workers 個 YoloDetector（模型各載入一次），
+     * 各管線的檢測線程呼叫 detect() 時取用一個閒置的實例做同步推理，全部忙碌時等待：
+     * 1. workers = 1：所有相機排隊共用一個模型（記憶體最少，GPU 後端通常已足夠）
+     * 2. workers = 相機數：等同各自持有，但模型設定與載入集中管理
+     *
+     * YoloDetector 的非同步批次 API 限定單一呼叫線程，無法跨管線共用；
+     * 掛上推理池的 DetectionController 一律走同步推理。
+     *
+     * 線程安全：所有公開方法皆可由任意線程呼叫。
+     */
+    class YoloInferencePool
+    {
+    public:
+        explicit YoloInferencePool(int workers = 1);
+        ~YoloInferencePool();
+
+        // 禁止複製
+        YoloInferencePool(const YoloInferencePool &) = delete;
+        YoloInferencePool &operator=(const YoloInferencePool &) = delete;
+
+        int size() const { return static_cast<int>(m_detectors.size()); }
+
+        /**
+         * @brief 對每個實例套用設定（推理參數 / 後端），等待實例閒置後才呼叫
+         */
+        void configure(const std::function<void(YoloDetector &)> &apply);
+
+        /**
+         * @brief 所有實例載入同一個模型
+         * @return 是否全部載入成功
+         */
+        bool loadModel(const std::string &modelPath);
+
+        bool isModelLoaded() const { return m_modelLoaded.load(); }
+
+        /**
+         * @brief 以閒置實例執行同步推理（參數同 YoloDetector::detect）
+         * @return 推理耗時（毫秒）；模型未載入時為 0 且 results 為空
+         */
+        double detect(const cv::Mat &roiImage, int offsetX, int offsetY,
+                      std::vector<DetectedObject> &results);
+
+        double lastInferenceTimeMs() const { return m_lastInferenceTimeMs.load(); }
+
+    private:
+        YoloDetector *acquire(); // 等待閒置實例
+        void release(YoloDetector *detector);
+
+        std::vector<std::unique_ptr<YoloDetector>> m_detectors;
+        std::vector<YoloDetector *> m_idle;
+        std::mutex m_mutex;
+        std::condition_variable m_idleCv;
+
+        std::atomic<bool> m_modelLoaded{false};
+        std::atomic<double> m_lastInferenceTimeMs{0.0};
+    };
+
+} // namespace basler
+
+#endif // YOLO_INFERENCE_POOL_H
@@ -0,0 +1,69 @@
+#ifndef YOLO_POSTPROCESS_H
+#define YOLO_POSTPROCESS_H
+
+#include <opencv2/core.hpp>
+#include <vector>
+
+namespace basler
+{
+
+    /**
+     * @brief YOLOv8 輸出解碼 + NMS（預配置緩衝）
+     *
+     * 取代「整張輸出 transpose → 逐列純量取最大類別 → push_back → cv::dnn::NMSBoxes」：
+     * 1. 直接讀通道優先的原始輸出 [1, 4 + 類別數, anchors]，不做 transpose
+     * 2. 信心平面以 SIMD 一次比較 4 個 anchor 的最大類別分數，整組低於閾值即跳過（提早淘汰）
+     * 3. 類別數為模板參數（1~4 類各有專用核心，其餘走執行期類別數版本）
+     * 4. NMS 針對小框：已保留的框依 x 分桶（桶寬 = 最大框寬），只比較相鄰桶
+     *
+     * 結果與原本的流程一致：信心須 > 閾值、依分數穩定排序、IoU > nmsThreshold 即抑制。
+     * 非線程安全：每個呼叫線程各自持有或由呼叫端加鎖。
+     */
+    class YoloPostProcessor
+    {
+    public:
+        struct Box
+        {
+            int x, y, w, h; // 放大後再縮回的 ROI 座標（尚未加 ROI 偏移）
+            float score;
+            int classId;
+        };
+
+        /**
+         * @brief 座標反映射參數（letterbox → ROI）
+         */
+        struct Mapping
+        {
+            double scaleX = 1.0;
+            double scaleY = 1.0;
+            int padX = 0;
+            int padY = 0;
+            double upscaleRatio = 1.0;
+        };
+
+        /**
+         * @brief 解碼一張輸出
+         * @param output [1, C, A]（通道優先）或 [1, A, C]（anchor 優先）CV_32F
+         * @return 保留的框（依分數由高到低；下一次 run() 前有效）
+         */
+        const std::vector<Box> &run(const cv::Mat &output, float confThreshold, float nmsThreshold,
+                                    const Mapping &mapping);
+
+    private:
+        template <int NumClasses>
+        void collectChannelMajor(const float *data, int numClasses, int anchors, float confThreshold);
+        void collectAnchorMajor(const float *data, int numFields, int anchors, float confThreshold);
+        void pushCandidate(float cx, float cy, float bw, float bh, float score, int classId);
+        void suppress(float nmsThreshold);
+
+        Mapping m_mapping;
+        std::vector<Box> m_candidates;
+        std::vector<Box> m_kept;
+        std::vector<int> m_order;
+        std::vector<int> m_bucketHead; // 每個 x 桶最新保留框的索引
+        std::vector<int> m_nextInBucket;
+    };
+
+} // namespace basler
+
+#endif // YOLO_POSTPROCESS_H
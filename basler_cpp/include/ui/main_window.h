@@ -12,8 +12,12 @@
 #include "core/camera_controller.h"
 #include "core/source_manager.h"
 #include "core/detection_controller.h"
+#include "core/detection_worker.h"
 #include "core/video_recorder.h"
+#include "core/event_recorder.h"
 #include "core/vibrator_controller.h"
+#include "core/vibrator_control_loop.h"
+#include "core/pipeline_telemetry.h"
 
 // 前向聲明 Widget
 namespace basler
@@ -54,6 +58,7 @@ namespace basler
         // ========== Camera Control ==========
         void onDetectCameras();
         void onDetectCamerasWithRetry();  // Smart scan with auto-retry
+        void onCamerasDetected(const QList<CameraInfo> &cameras);
         void onConnectCamera();
         void onDisconnectCamera();
         void onStartGrabbing();
@@ -67,8 +72,9 @@ namespace basler
         void onCameraError(const QString &error);
 
         // ========== 幀處理 ==========
-        void onFrameReady(const cv::Mat &frame);
+        void onFrameReady(quint64 sequence);
         void onFpsUpdated(double fps);
+        void onFramesMissed(quint64 missed, quint64 totalMissed);
         void updateDisplay();
 
         // ========== 錄製控制 ==========
@@ -109,10 +115,22 @@ namespace basler
         // ========== 選單動作 ==========
         void onLoadVideo();
         void onLoadYoloModel();
+        void onYoloModelLoaded(bool success);
         void onSaveConfig();
         void onLoadConfig();
 
     private:
+        /**
+         * @brief 啟動第二階段（視窗顯示後由事件迴圈執行）：背景載入 YOLO 模型、重新連接上次的相機
+         */
+        void startDeferredStartup();
+        void detectCamerasAsync(int maxRetries, int delayMs);
+
+        /**
+         * @brief 依目前檢測 ROI 重新設定相機的感測器 AOI（CameraConfig::sensorAoi；相機未連線時略過）
+         */
+        void updateSensorAoi();
+
         void setupUi();
         void setupMenuBar();
         void setupStatusBar();
@@ -122,10 +140,14 @@ namespace basler
         void connectPackagingSignals();
         void connectDetectionSignals();
         void connectDebugSignals();
+        void connectEventRecordingSignals();
 
-        void processFrame(const cv::Mat &frame);
+        void applyDetectionResult(const DetectionResult &result);
+        void updateDebugTapSubscription();  // 依調試視圖狀態訂閱 / 取消 DebugTap
+        void drainRecordingFrames();
         void updateButtonStates();
         void exportPackagingReport(int target, int actual, double elapsedSec);
+        void exportStageLatency();          // 匯出本次執行累計的逐階段延遲（CSV）
         void applyTheme(bool isDark);       // 套用 Dark/Light 主題（全局 QSS）
         void applyFontScale(double scale);  // 套用字體縮放比例
 
@@ -133,7 +155,17 @@ namespace basler
         std::unique_ptr<SourceManager> m_sourceManager;
         std::unique_ptr<DetectionController> m_detectionController;
         std::unique_ptr<VideoRecorder> m_videoRecorder;
+        std::unique_ptr<EventRecorder> m_eventRecorder; // 事件觸發錄影（預觸發緩衝）
         std::unique_ptr<DualVibratorManager> m_vibratorManager;
+        std::unique_ptr<VibratorControlLoop> m_vibratorControl; // 即時震動機控制（須先於震動機析構）
+
+        // ========== 檢測管線線程 ==========
+        std::unique_ptr<QThread> m_detectionThread;
+        std::unique_ptr<DetectionWorker> m_detectionWorker;
+
+        // ========== 遙測（依宣告反序析構：先停端點，再移除收集器，最後才釋放 DetectionWorker） ==========
+        std::unique_ptr<PipelineTelemetry> m_telemetry;
+        std::unique_ptr<MetricsServer> m_metricsServer;
 
         // ========== UI 組件 ==========
         QSplitter *m_mainSplitter         = nullptr;
@@ -165,9 +197,17 @@ namespace basler
         QTimer *m_updateTimer = nullptr;
 
         // ========== 幀緩衝 ==========
-        cv::Mat m_latestFrame;
-        cv::Mat m_processedFrame;
+        cv::Mat m_latestFrame;               // 顯示用最新幀（從 FrameRing 讀取，緩衝重用）
+        cv::Mat m_processedFrame;            // 燒入結果的幀（overlayAsData 關閉時）
+        FrameOverlay m_processedOverlay;     // 最新檢測結果的疊加資料（顯示與燒入錄影共用）
         QMutex m_frameMutex;
+        quint64 m_lastDisplayedSequence = 0; // 已顯示的最新 FrameRing 序號
+        int m_recordingConsumerId = -1;      // 錄影的 FrameRing 消費者 ID（-1 = 未錄影）
+        cv::Mat m_recordingFrame;            // 錄影讀取緩衝
+        quint64 m_cameraMissedFrames = 0;    // 相機區塊 ID 缺口累計（本次抓取）
+        bool m_startupReconnect = false;     // 啟動時以快取序號重新連接中（失敗時改為掃描，不彈窗）
+        bool m_userYoloLoad = false;         // 使用者從選單載入模型（失敗時彈窗）
+        StageLatencySnapshot m_latencyTotal; // 逐階段延遲（各窗口合併，匯出用）
 
         // ========== 運行狀態 ==========
         bool m_isDetecting = false;
@@ -181,6 +221,8 @@ namespace basler
 
         // ========== 調試視覺化模式 ==========
         int m_debugViewMode = 0;  // 0=原始, 1=前景遮罩, 2=Canny, 3=三重聯合, 4=最終形態學
+        bool m_debugTapSubscribed = false; // 是否已訂閱檢測中間幀
+        DebugFrames m_debugFrames;         // 最近取得的中間幀（與 DebugTap 交換緩衝）
 
         // ========== 分割顯示狀態 ==========
         bool m_isSplitView = false;  // 是否為分割顯示模式（左：選定視圖，右：互補幀）
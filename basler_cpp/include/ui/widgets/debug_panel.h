@@ -76,6 +76,7 @@ public slots:
 
     // YOLO 狀態更新
     void updateYoloModelStatus(bool loaded);
+    void showYoloModelLoading(const QString& modelPath);   // 背景載入開始
     void updateYoloInferenceTime(double ms);
 
 signals:
@@ -0,0 +1,106 @@
+#ifndef GPU_FRAME_VIEW_H
+#define GPU_FRAME_VIEW_H
+
+#include <QOpenGLWidget>
+#include <QOpenGLExtraFunctions>
+#include <QOpenGLShaderProgram>
+#include <QOpenGLBuffer>
+#include <QOpenGLVertexArrayObject>
+#include <functional>
+#include <memory>
+#include <vector>
+#include <opencv2/core.hpp>
+
+#include "core/frame_overlay.h"
+
+class QPainter;
+
+namespace basler {
+
+/**
+ * @brief VideoDisplayWidget 的 GPU 顯示路徑（OpenGL 3.3 core / ES 3.0）
+ *
+ * 1. mono8 / BGR / BGRA 緩衝原樣上傳為紋理（尺寸不變時 glTexSubImage2D），
+ *    通道順序由紋理 swizzle 處理，不做 cvtColor / QImage 複製
+ * 2. 縮放由紋理取樣完成（GL_LINEAR），CPU 不再產生縮放影像
+ * 3. ROI / 光柵線 / 檢測框以線段頂點繪製（影像座標，於頂點著色器映射到畫面）
+ * 4. 標籤 / 計數摘要、編輯模式提示、HUD 等文字由 overlayPainter 回呼以 QPainter 繪製在 GL 內容之上
+ *
+ * 不處理滑鼠事件（WA_TransparentForMouseEvents），座標換算由 VideoDisplayWidget 負責。
+ * 初始化失敗（無 3.x 上下文或著色器編譯失敗）時發出 unavailable()，由父組件改回 CPU 路徑。
+ */
+class GpuFrameView : public QOpenGLWidget, protected QOpenGLExtraFunctions {
+    Q_OBJECT
+
+public:
+    explicit GpuFrameView(QWidget* parent = nullptr);
+    ~GpuFrameView() override;
+
+    /**
+     * @brief 設定下一次重繪要上傳的幀（複製到重用的上傳緩衝）
+     */
+    void setFrame(const cv::Mat& frame);
+    void clearFrame();
+
+    void setOverlay(const FrameOverlay& overlay);
+
+    /**
+     * @brief 影像在 widget 中的顯示區域（widget 邏輯座標，可超出 widget 範圍）
+     */
+    void setDisplayRect(const QRect& rect);
+
+    /**
+     * @brief GL 內容繪製完成後呼叫，用於 QPainter 文字 / 編輯模式疊加
+     */
+    void setOverlayPainter(std::function<void(QPainter&)> painter) { m_overlayPainter = std::move(painter); }
+
+    bool isAvailable() const { return !m_failed; }
+
+signals:
+    void unavailable(const QString& reason);
+
+protected:
+    void initializeGL() override;
+    void paintGL() override;
+
+private:
+    bool buildPrograms();
+    void uploadPendingFrame();
+    void rebuildOverlayVertices();
+    void fail(const QString& reason);
+
+    bool m_failed = false;
+    bool m_isGles = false;
+
+    // 上傳
+    cv::Mat m_pending;         // 待上傳的幀（緩衝重用）
+    bool m_frameDirty = false;
+    GLuint m_texture = 0;
+    int m_texWidth = 0;
+    int m_texHeight = 0;
+    int m_texChannels = 0;
+
+    // 影像四邊形
+    std::unique_ptr<QOpenGLShaderProgram> m_imageProgram;
+    QOpenGLVertexArrayObject m_imageVao;
+    QOpenGLBuffer m_imageVbo{QOpenGLBuffer::VertexBuffer};
+
+    // 疊加線段
+    std::unique_ptr<QOpenGLShaderProgram> m_lineProgram;
+    QOpenGLVertexArrayObject m_lineVao;
+    QOpenGLBuffer m_lineVbo{QOpenGLBuffer::VertexBuffer};
+    FrameOverlay m_overlay;
+    std::vector<float> m_lineVertices;
+    int m_roiVertexCount = 0;
+    int m_gateVertexCount = 0;
+    int m_boxVertexCount = 0;
+    int m_crossedVertexCount = 0;
+    bool m_overlayDirty = true;
+
+    QRect m_displayRect;
+    std::function<void(QPainter&)> m_overlayPainter;
+};
+
+} // namespace basler
+
+#endif // GPU_FRAME_VIEW_H
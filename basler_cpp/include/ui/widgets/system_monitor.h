@@ -7,12 +7,16 @@
 #include <QProgressBar>
 #include <QTimer>
 
+#include "core/stage_profiler.h"
+#include "core/thread_cpu_sampler.h"
+
 namespace basler {
 
 /**
  * @brief 系統監控組件
  *
- * 顯示 CPU 和記憶體使用率
+ * 顯示 CPU 和記憶體使用率、本程序逐線程 CPU 使用率與記憶體成長速率，
+ * 以及檢測管線逐階段延遲（p50 / p95 / p99 / max）
  */
 class SystemMonitorWidget : public QWidget {
     Q_OBJECT
@@ -27,6 +31,11 @@ public slots:
     void startMonitoring();
     void stopMonitoring();
 
+    /**
+     * @brief 更新檢測管線逐階段延遲（一個統計窗口）
+     */
+    void setStageLatency(const basler::StageLatencySnapshot& snapshot);
+
 private slots:
     void updateStats();
 
@@ -34,12 +43,15 @@ private:
     void initUi();
     double getCpuUsage();
     double getMemoryUsage();
+    void updateThreadStats();
 
     QGroupBox* m_groupBox;
     QLabel* m_cpuLabel;
     QProgressBar* m_cpuBar;
     QLabel* m_memLabel;
     QProgressBar* m_memBar;
+    QLabel* m_threadLabel;
+    QLabel* m_latencyLabel;
 
     QTimer* m_updateTimer;
     int m_updateInterval = 1000;  // 1 秒
@@ -47,6 +59,10 @@ private:
     // CPU 計算用
     qint64 m_lastCpuTime = 0;
     qint64 m_lastIdleTime = 0;
+
+    // 逐線程 CPU（UI 線程取樣）
+    ThreadCpuSampler m_threadSampler;
+    static constexpr int MAX_LISTED_THREADS = 10;
 };
 
 } // namespace basler
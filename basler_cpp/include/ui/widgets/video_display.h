@@ -7,13 +7,22 @@
 #include <QMutex>
 #include <opencv2/core.hpp>
 
+#include "core/frame_overlay.h"
+
+class QPainter;
+
 namespace basler {
 
+class GpuFrameView;
+
 /**
  * @brief 視頻顯示組件
  *
- * 負責將 OpenCV Mat 轉換為 QImage 並顯示
- * 支持縮放和保持長寬比
+ * 支持縮放和保持長寬比。兩條顯示路徑：
+ * - GPU（ui.gpuDisplay 且編譯時有 HAVE_GPU_DISPLAY）：子組件 GpuFrameView 直接上傳 mono / BGR 紋理，
+ *   縮放與 FrameOverlay 都在 GPU 完成
+ * - CPU：轉換為 QImage、縮放後以 QPainter 繪製（GPU 初始化失敗時自動退回）
+ * 編輯模式提示、HUD 與滑鼠座標換算兩條路徑共用（以 m_displayRect 為準）。
  */
 class VideoDisplayWidget : public QWidget {
     Q_OBJECT
@@ -32,9 +41,17 @@ public:
     void setScaleMode(ScaleMode mode) { m_scaleMode = mode; }
     ScaleMode scaleMode() const { return m_scaleMode; }
 
+    /**
+     * @brief cv::Mat（mono8 / BGR / BGRA）轉為深複製的 QImage
+     */
+    static QImage matToQImage(const cv::Mat& mat);
+
     // 當前顯示的圖像尺寸
     QSize imageSize() const { return m_imageSize; }
 
+    // 是否走 GPU 顯示路徑
+    bool isGpuAccelerated() const { return m_gpuView != nullptr; }
+
 public slots:
     /**
      * @brief 更新顯示幀
@@ -86,6 +103,13 @@ public slots:
      */
     void updateHud(int count, double fps, double gateRatio);
 
+    /**
+     * @brief 設定疊加資訊（ROI / 光柵線 / 檢測框 / 標籤 / 計數，影像座標）；空 overlay = 不疊加
+     *
+     * 以顯示頻率繪製，取代在檢測線程燒入幀的做法
+     */
+    void setOverlay(const FrameOverlay& overlay);
+
 signals:
     void clicked(const QPoint& pos);    // 點擊事件（圖像座標）
     void doubleClicked();               // 雙擊事件（觸發全螢幕切換）
@@ -108,13 +132,21 @@ protected:
     void mouseDoubleClickEvent(QMouseEvent* event) override;
 
 private:
-    QImage matToQImage(const cv::Mat& mat);
-    void updateScaledImage();
+    void updateDisplayRect();                   // 依影像尺寸 / 縮放模式計算 m_displayRect（CPU 路徑同時重建縮放影像）
+    void paintFrameOverlay(QPainter& painter);  // CPU 路徑的 FrameOverlay 框線
+    void paintOverlayLabels(QPainter& painter); // FrameOverlay 標籤與計數摘要（兩條路徑共用）
+    void paintOverlays(QPainter& painter);      // 訊息 / 編輯模式 / HUD / 拖拽框（兩條路徑共用）
+    void requestRepaint();
+    void enableGpuView();
+    void disableGpuView(const QString& reason);
 
     QImage m_currentImage;
     QImage m_scaledImage;
     QString m_message;
     QSize m_imageSize;
+    QRect m_displayRect;  // 影像在 widget 中的顯示區域（widget 座標）
+    FrameOverlay m_overlay;
+    GpuFrameView* m_gpuView = nullptr;
     ScaleMode m_scaleMode = ScaleMode::KeepAspectRatio;
     QMutex m_mutex;
 
@@ -1,94 +1,100 @@
 #!/bin/bash
-# 效能對比測試腳本 - C++ vs Python
+# 檢測管線基準測試 - 產生機器可讀結果並與基準版本比較
+#
+# 用法:
+#   scripts/benchmark.sh [基準結果.json] [其他 Google Benchmark 參數...]
+#
+# 環境變數:
+#   BUILD_DIR                 建構目錄（預設 build-bench，不存在時以 -DBUILD_BENCHMARKS=ON 建構）
+#   BASLER_BENCH_YOLO_MODEL   YOLO ONNX 模型（未設定時略過 BM_YoloDetect）
+#   BENCH_REPETITIONS         每個基準重複次數（預設 5，結果含 mean / median / stddev）
+
+set -e
 
 SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
-PROJECT_ROOT="$(dirname "$(dirname "$SCRIPT_DIR")")"
+PROJECT_DIR="$(dirname "$SCRIPT_DIR")"
+BUILD_DIR="${BUILD_DIR:-$PROJECT_DIR/build-bench}"
+RESULTS_DIR="$PROJECT_DIR/benchmarks/results"
+REPETITIONS="${BENCH_REPETITIONS:-5}"
 
-CPP_APP="$SCRIPT_DIR/../build/BaslerVisionSystem.app/Contents/MacOS/BaslerVisionSystem"
-PY_SCRIPT="$PROJECT_ROOT/basler_pyqt6/main.py"
+BASELINE=""
+if [ -n "$1" ] && [ -f "$1" ]; then
+    BASELINE="$1"
+    shift
+fi
 
 echo "=========================================="
-echo "Basler Vision System - 效能對比測試"
+echo "Basler Vision System - 檢測管線基準測試"
 echo "=========================================="
 
 # ========================
-# 1. 應用大小對比
+# 1. 建構
 # ========================
-echo ""
-echo ">>> 1. 應用大小對比"
-echo "-------------------------------------------"
-
-CPP_SIZE=$(du -sh "$SCRIPT_DIR/../build/BaslerVisionSystem.app" 2>/dev/null | cut -f1)
-echo "C++ 版本 (App Bundle): ${CPP_SIZE:-N/A}"
-
-# Python 專案大小
-PY_SIZE=$(du -sh "$PROJECT_ROOT/basler_pyqt6" 2>/dev/null | cut -f1)
-echo "Python 版本 (源碼): ${PY_SIZE:-N/A}"
-
-# ========================
-# 2. 啟動時間測試
-# ========================
-echo ""
-echo ">>> 2. 啟動時間測試 (5次平均)"
-echo "-------------------------------------------"
+if [ ! -f "$BUILD_DIR/CMakeCache.txt" ]; then
+    cmake -S "$PROJECT_DIR" -B "$BUILD_DIR" -DCMAKE_BUILD_TYPE=Release -DBUILD_BENCHMARKS=ON
+fi
+cmake --build "$BUILD_DIR" --target detection_benchmark -j"$(getconf _NPROCESSORS_ONLN 2>/dev/null || echo 4)"
 
-# C++ 版本啟動時間
-if [ -f "$CPP_APP" ]; then
-    echo "測試 C++ 版本..."
-    CPP_TIMES=()
-    
-    for i in {1..5}; do
-        START=$(python3 -c "import time; print(int(time.time() * 1000))")
-        "$CPP_APP" --test-startup &
-        PID=$!
-        sleep 2  # 等待啟動
-        kill $PID 2>/dev/null
-        wait $PID 2>/dev/null
-        END=$(python3 -c "import time; print(int(time.time() * 1000))")
-        DIFF=$((END - START))
-        CPP_TIMES+=($DIFF)
-    done
-    
-    CPP_AVG=$(echo "${CPP_TIMES[@]}" | tr ' ' '\n' | awk '{sum+=$1} END {print int(sum/NR)}')
-    echo "C++ 平均啟動時間: ${CPP_AVG}ms"
+BENCH_BIN="$BUILD_DIR/detection_benchmark"
+if [ ! -x "$BENCH_BIN" ]; then
+    echo "找不到 $BENCH_BIN"
+    exit 1
 fi
 
 # ========================
-# 3. 記憶體使用
+# 2. 執行（JSON 結果以版本 + commit 命名）
 # ========================
-echo ""
-echo ">>> 3. 記憶體使用對比"
-echo "-------------------------------------------"
+VERSION=$(grep -m1 -oE 'project\(BaslerVisionSystem VERSION [0-9.]+' "$PROJECT_DIR/CMakeLists.txt" | awk '{print $3}')
+COMMIT=$(git -C "$PROJECT_DIR" rev-parse --short HEAD 2>/dev/null || echo "nogit")
+mkdir -p "$RESULTS_DIR"
+RESULT="$RESULTS_DIR/${VERSION:-dev}-${COMMIT}.json"
 
-# 檢查當前運行中的應用
-CPP_MEM=$(ps aux | grep "BaslerVisionSystem" | grep -v grep | awk '{sum+=$6} END {print sum}')
-PY_MEM=$(ps aux | grep "python.*main" | grep -v grep | awk '{sum+=$6} END {print sum}')
+"$BENCH_BIN" \
+    --benchmark_repetitions="$REPETITIONS" \
+    --benchmark_report_aggregates_only=true \
+    --benchmark_out="$RESULT" \
+    --benchmark_out_format=json \
+    --benchmark_context=commit="$COMMIT" \
+    "$@"
 
-if [ -n "$CPP_MEM" ] && [ "$CPP_MEM" -gt 0 ]; then
-    echo "C++ 版本記憶體使用: $((CPP_MEM / 1024)) MB"
-else
-    echo "C++ 版本: 未運行"
-fi
-
-if [ -n "$PY_MEM" ] && [ "$PY_MEM" -gt 0 ]; then
-    echo "Python 版本記憶體使用: $((PY_MEM / 1024)) MB"
-else
-    echo "Python 版本: 未運行"
-fi
+echo ""
+echo "結果: $RESULT"
 
 # ========================
-# 4. 編譯資訊
+# 3. 與基準版本比較（median real_time，變慢超過 5% 標記為回歸）
 # ========================
-echo ""
-echo ">>> 4. C++ 編譯資訊"
-echo "-------------------------------------------"
+if [ -n "$BASELINE" ]; then
+    echo ""
+    echo ">>> 與 $(basename "$BASELINE") 比較"
+    echo "-------------------------------------------"
+    python3 - "$BASELINE" "$RESULT" <<'EOF'
+import json
+import sys
 
-if [ -f "$CPP_APP" ]; then
-    echo "執行檔大小: $(ls -lh "$CPP_APP" | awk '{print $5}')"
-    echo "架構: $(file "$CPP_APP" | grep -o 'arm64\|x86_64')"
-fi
+def medians(path):
+    with open(path) as f:
+        data = json.load(f)
+    out = {}
+    for b in data.get("benchmarks", []):
+        if b.get("aggregate_name", "median") == "median" and not b.get("error_occurred"):
+            out[b.get("run_name", b["name"])] = b
+    return out
 
-echo ""
-echo "=========================================="
-echo "測試完成"
-echo "=========================================="
+base, cur = medians(sys.argv[1]), medians(sys.argv[2])
+regressions = 0
+print(f"{'benchmark':60s} {'base':>12s} {'current':>12s} {'change':>8s}")
+for name, b in cur.items():
+    if name not in base:
+        continue
+    old, new = base[name]["real_time"], b["real_time"]
+    change = (new - old) / old * 100 if old else 0.0
+    mark = "  <-- 回歸" if change > 5 else ""
+    regressions += change > 5
+    print(f"{name:60s} {old:12.2f} {new:12.2f} {change:+7.1f}%{mark}")
+    for key in ("accuracy",):
+        if key in b and key in base[name] and b[key] < base[name][key]:
+            print(f"{'':60s} {key}: {base[name][key]:.3f} -> {b[key]:.3f}  <-- 準確度下降")
+            regressions += 1
+sys.exit(1 if regressions else 0)
+EOF
+fi
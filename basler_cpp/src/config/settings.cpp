@@ -22,6 +22,7 @@ QJsonObject DetectionConfig::toJson() const
         {"bgVarThreshold", bgVarThreshold},
         {"detectShadows", detectShadows},
         {"bgLearningRate", bgLearningRate},
+        {"bgModel", bgModel},
         {"gaussianBlurKernelSize", gaussianBlurKernelSize},
         {"cannyLowThreshold", cannyLowThreshold},
         {"cannyHighThreshold", cannyHighThreshold},
@@ -42,6 +43,7 @@ QJsonObject DetectionConfig::toJson() const
         {"targetFps", targetFps},
         {"highSpeedBgHistory", highSpeedBgHistory},
         {"highSpeedBgVarThreshold", highSpeedBgVarThreshold},
+        {"highSpeedBgModel", highSpeedBgModel},
         {"highSpeedMinArea", highSpeedMinArea},
         {"highSpeedMaxArea", highSpeedMaxArea},
         {"highSpeedBinaryThreshold", highSpeedBinaryThreshold}
@@ -61,6 +63,7 @@ DetectionConfig DetectionConfig::fromJson(const QJsonObject& json)
     config.bgVarThreshold = json.value("bgVarThreshold").toInt(config.bgVarThreshold);
     config.detectShadows = json.value("detectShadows").toBool(config.detectShadows);
     config.bgLearningRate = json.value("bgLearningRate").toDouble(config.bgLearningRate);
+    config.bgModel = json.value("bgModel").toString(config.bgModel);
     config.roiEnabled = json.value("roiEnabled").toBool(config.roiEnabled);
     config.roiX      = json.value("roiX").toInt(config.roiX);
     config.roiWidth  = json.value("roiWidth").toInt(config.roiWidth);
@@ -68,6 +71,7 @@ DetectionConfig DetectionConfig::fromJson(const QJsonObject& json)
     config.roiPositionRatio = json.value("roiPositionRatio").toDouble(config.roiPositionRatio);
     config.ultraHighSpeedMode = json.value("ultraHighSpeedMode").toBool(config.ultraHighSpeedMode);
     config.targetFps = json.value("targetFps").toInt(config.targetFps);
+    config.highSpeedBgModel = json.value("highSpeedBgModel").toString(config.highSpeedBgModel);
     return config;
 }
 
@@ -79,7 +83,17 @@ QJsonObject CameraConfig::toJson() const
 {
     return QJsonObject{
         {"targetFps", targetFps},
-        {"exposureTimeUs", exposureTimeUs}
+        {"exposureTimeUs", exposureTimeUs},
+        {"zeroCopyGrab", zeroCopyGrab},
+        {"grabBufferCount", grabBufferCount},
+        {"losslessCounting", losslessCounting},
+        {"losslessBufferCount", losslessBufferCount},
+        {"autoConnectLastCamera", autoConnectLastCamera},
+        {"sensorAoi", sensorAoi},
+        {"sensorAoiMarginRows", sensorAoiMarginRows},
+        {"sensorAoiMarginCols", sensorAoiMarginCols},
+        {"sensorAoiCropWidth", sensorAoiCropWidth},
+        {"sensorBinning", sensorBinning}
     };
 }
 
@@ -88,6 +102,101 @@ CameraConfig CameraConfig::fromJson(const QJsonObject& json)
     CameraConfig config;
     config.targetFps = json.value("targetFps").toDouble(config.targetFps);
     config.exposureTimeUs = json.value("exposureTimeUs").toDouble(config.exposureTimeUs);
+    config.zeroCopyGrab = json.value("zeroCopyGrab").toBool(config.zeroCopyGrab);
+    config.grabBufferCount = json.value("grabBufferCount").toInt(config.grabBufferCount);
+    config.losslessCounting = json.value("losslessCounting").toBool(config.losslessCounting);
+    config.losslessBufferCount = json.value("losslessBufferCount").toInt(config.losslessBufferCount);
+    config.autoConnectLastCamera = json.value("autoConnectLastCamera").toBool(config.autoConnectLastCamera);
+    config.sensorAoi = json.value("sensorAoi").toBool(config.sensorAoi);
+    config.sensorAoiMarginRows = json.value("sensorAoiMarginRows").toInt(config.sensorAoiMarginRows);
+    config.sensorAoiMarginCols = json.value("sensorAoiMarginCols").toInt(config.sensorAoiMarginCols);
+    config.sensorAoiCropWidth = json.value("sensorAoiCropWidth").toBool(config.sensorAoiCropWidth);
+    config.sensorBinning = json.value("sensorBinning").toInt(config.sensorBinning);
+    return config;
+}
+
+// ============================================================================
+// MultiCameraConfig
+// ============================================================================
+
+QJsonObject CameraPipelineConfig::toJson() const
+{
+    return QJsonObject{
+        {"serial", serial},
+        {"cameraIndex", cameraIndex},
+        {"source", source},
+        {"lane", lane},
+        {"grabCore", grabCore},
+        {"detectionCore", detectionCore}
+    };
+}
+
+CameraPipelineConfig CameraPipelineConfig::fromJson(const QJsonObject& json)
+{
+    CameraPipelineConfig config;
+    config.serial = json.value("serial").toString(config.serial);
+    config.cameraIndex = json.value("cameraIndex").toInt(config.cameraIndex);
+    config.source = json.value("source").toString(config.source);
+    config.lane = json.value("lane").toInt(config.lane);
+    config.grabCore = json.value("grabCore").toInt(config.grabCore);
+    config.detectionCore = json.value("detectionCore").toInt(config.detectionCore);
+    return config;
+}
+
+QJsonObject MultiCameraConfig::toJson() const
+{
+    QJsonArray camerasArray;
+    for (const auto& camera : cameras) {
+        camerasArray.append(camera.toJson());
+    }
+
+    return QJsonObject{
+        {"cameras", camerasArray},
+        {"inferenceWorkers", inferenceWorkers},
+        {"autoAssignCores", autoAssignCores}
+    };
+}
+
+MultiCameraConfig MultiCameraConfig::fromJson(const QJsonObject& json)
+{
+    MultiCameraConfig config;
+    for (const auto& cameraVal : json.value("cameras").toArray()) {
+        config.cameras.push_back(CameraPipelineConfig::fromJson(cameraVal.toObject()));
+    }
+    config.inferenceWorkers = json.value("inferenceWorkers").toInt(config.inferenceWorkers);
+    config.autoAssignCores = json.value("autoAssignCores").toBool(config.autoAssignCores);
+    return config;
+}
+
+// ============================================================================
+// RecordingConfig
+// ============================================================================
+
+QJsonObject RecordingConfig::toJson() const
+{
+    return QJsonObject{
+        {"queueFrames", queueFrames},
+        {"blockWhenFull", blockWhenFull},
+        {"blockTimeoutMs", blockTimeoutMs},
+        {"progressIntervalMs", progressIntervalMs},
+        {"format", format},
+        {"encoderBackend", encoderBackend},
+        {"rawSegmentMegabytes", rawSegmentMegabytes},
+        {"burnInOverlay", burnInOverlay}
+    };
+}
+
+RecordingConfig RecordingConfig::fromJson(const QJsonObject& json)
+{
+    RecordingConfig config;
+    config.queueFrames = json.value("queueFrames").toInt(config.queueFrames);
+    config.blockWhenFull = json.value("blockWhenFull").toBool(config.blockWhenFull);
+    config.blockTimeoutMs = json.value("blockTimeoutMs").toInt(config.blockTimeoutMs);
+    config.progressIntervalMs = json.value("progressIntervalMs").toInt(config.progressIntervalMs);
+    config.format = json.value("format").toString(config.format);
+    config.encoderBackend = json.value("encoderBackend").toString(config.encoderBackend);
+    config.rawSegmentMegabytes = json.value("rawSegmentMegabytes").toInt(config.rawSegmentMegabytes);
+    config.burnInOverlay = json.value("burnInOverlay").toBool(config.burnInOverlay);
     return config;
 }
 
@@ -101,7 +210,9 @@ QJsonObject GateConfig::toJson() const
         {"enableGateCounting", enableGateCounting},
         {"gateLinePositionRatio", gateLinePositionRatio},
         {"gateTriggerRadius", gateTriggerRadius},
-        {"gateHistoryFrames", gateHistoryFrames}
+        {"gateHistoryFrames", gateHistoryFrames},
+        {"optimalAssignment", optimalAssignment},
+        {"assignmentBudgetMs", assignmentBudgetMs}
     };
 }
 
@@ -112,6 +223,8 @@ GateConfig GateConfig::fromJson(const QJsonObject& json)
     config.gateLinePositionRatio = json.value("gateLinePositionRatio").toDouble(config.gateLinePositionRatio);
     config.gateTriggerRadius = json.value("gateTriggerRadius").toInt(config.gateTriggerRadius);
     config.gateHistoryFrames = json.value("gateHistoryFrames").toInt(config.gateHistoryFrames);
+    config.optimalAssignment = json.value("optimalAssignment").toBool(config.optimalAssignment);
+    config.assignmentBudgetMs = json.value("assignmentBudgetMs").toDouble(config.assignmentBudgetMs);
     return config;
 }
 
@@ -133,6 +246,17 @@ QJsonObject PackagingConfig::toJson() const
         {"vibratorSpeedCreep", vibratorSpeedCreep},
         {"stopDelayFrames", stopDelayFrames},
         {"advanceStopCount", advanceStopCount},
+        {"speedControlMode", speedControlMode},
+        {"flowSettleMs", flowSettleMs},
+        {"actuationLatencyMs", actuationLatencyMs},
+        {"flowSafetyFactor", flowSafetyFactor},
+        {"flowRateAlpha", flowRateAlpha},
+        {"flowMinSamples", flowMinSamples},
+        {"realtimeControl", realtimeControl},
+        {"controlThreadCore", controlThreadCore},
+        {"controlQueueCapacity", controlQueueCapacity},
+        {"controlSpinUs", controlSpinUs},
+        {"latencyReportIntervalMs", latencyReportIntervalMs},
         {"enableSoundAlert", enableSoundAlert},
         {"alertOnTargetReached", alertOnTargetReached},
         {"alertOnSpeedChange", alertOnSpeedChange}
@@ -148,6 +272,140 @@ PackagingConfig PackagingConfig::fromJson(const QJsonObject& json)
     config.speedMediumThreshold = json.value("speedMediumThreshold").toDouble(config.speedMediumThreshold);
     config.speedSlowThreshold = json.value("speedSlowThreshold").toDouble(config.speedSlowThreshold);
     config.advanceStopCount = json.value("advanceStopCount").toInt(config.advanceStopCount);
+    config.speedControlMode = json.value("speedControlMode").toString(config.speedControlMode);
+    config.flowSettleMs = json.value("flowSettleMs").toInt(config.flowSettleMs);
+    config.actuationLatencyMs = json.value("actuationLatencyMs").toInt(config.actuationLatencyMs);
+    config.flowSafetyFactor = json.value("flowSafetyFactor").toDouble(config.flowSafetyFactor);
+    config.flowRateAlpha = json.value("flowRateAlpha").toDouble(config.flowRateAlpha);
+    config.flowMinSamples = json.value("flowMinSamples").toInt(config.flowMinSamples);
+    config.realtimeControl = json.value("realtimeControl").toBool(config.realtimeControl);
+    config.controlThreadCore = json.value("controlThreadCore").toInt(config.controlThreadCore);
+    config.controlQueueCapacity = json.value("controlQueueCapacity").toInt(config.controlQueueCapacity);
+    config.controlSpinUs = json.value("controlSpinUs").toInt(config.controlSpinUs);
+    config.latencyReportIntervalMs = json.value("latencyReportIntervalMs").toInt(config.latencyReportIntervalMs);
+    return config;
+}
+
+// ============================================================================
+// VibratorConfig
+// ============================================================================
+
+QJsonObject VibratorConfig::toJson() const
+{
+    return QJsonObject{
+        {"driver", driver},
+        {"serialPort", serialPort},
+        {"baudRate", baudRate},
+        {"parity", parity},
+        {"stopBits", stopBits},
+        {"host", host},
+        {"tcpPort", tcpPort},
+        {"unitId1", unitId1},
+        {"unitId2", unitId2},
+        {"speedRegister", speedRegister},
+        {"runRegister", runRegister},
+        {"speedFullScale", speedFullScale},
+        {"responseTimeoutMs", responseTimeoutMs},
+        {"maxRetries", maxRetries},
+        {"retryBackoffMs", retryBackoffMs},
+        {"refreshIntervalMs", refreshIntervalMs}
+    };
+}
+
+VibratorConfig VibratorConfig::fromJson(const QJsonObject& json)
+{
+    VibratorConfig config;
+    config.driver = json.value("driver").toString(config.driver);
+    config.serialPort = json.value("serialPort").toString(config.serialPort);
+    config.baudRate = json.value("baudRate").toInt(config.baudRate);
+    config.parity = json.value("parity").toString(config.parity);
+    config.stopBits = json.value("stopBits").toInt(config.stopBits);
+    config.host = json.value("host").toString(config.host);
+    config.tcpPort = json.value("tcpPort").toInt(config.tcpPort);
+    config.unitId1 = json.value("unitId1").toInt(config.unitId1);
+    config.unitId2 = json.value("unitId2").toInt(config.unitId2);
+    config.speedRegister = json.value("speedRegister").toInt(config.speedRegister);
+    config.runRegister = json.value("runRegister").toInt(config.runRegister);
+    config.speedFullScale = json.value("speedFullScale").toInt(config.speedFullScale);
+    config.responseTimeoutMs = json.value("responseTimeoutMs").toInt(config.responseTimeoutMs);
+    config.maxRetries = json.value("maxRetries").toInt(config.maxRetries);
+    config.retryBackoffMs = json.value("retryBackoffMs").toInt(config.retryBackoffMs);
+    config.refreshIntervalMs = json.value("refreshIntervalMs").toInt(config.refreshIntervalMs);
+    return config;
+}
+
+// ============================================================================
+// TelemetryConfig
+// ============================================================================
+
+QJsonObject TelemetryConfig::toJson() const
+{
+    return QJsonObject{
+        {"enabled", enabled},
+        {"bindAddress", bindAddress},
+        {"port", port},
+        {"station", station}
+    };
+}
+
+TelemetryConfig TelemetryConfig::fromJson(const QJsonObject& json)
+{
+    TelemetryConfig config;
+    config.enabled = json.value("enabled").toBool(config.enabled);
+    config.bindAddress = json.value("bindAddress").toString(config.bindAddress);
+    config.port = json.value("port").toInt(config.port);
+    config.station = json.value("station").toString(config.station);
+    return config;
+}
+
+// ============================================================================
+// SchedulingConfig
+// ============================================================================
+
+QJsonObject ThreadSchedulingConfig::toJson() const
+{
+    return QJsonObject{
+        {"affinity", affinity},
+        {"priority", priority},
+        {"coreClass", coreClass},
+        {"numaNode", numaNode}
+    };
+}
+
+ThreadSchedulingConfig ThreadSchedulingConfig::fromJson(const QJsonObject& json,
+                                                        const ThreadSchedulingConfig& defaults)
+{
+    ThreadSchedulingConfig config = defaults;
+    config.affinity = json.value("affinity").toString(config.affinity);
+    config.priority = json.value("priority").toString(config.priority);
+    config.coreClass = json.value("coreClass").toString(config.coreClass);
+    config.numaNode = json.value("numaNode").toInt(config.numaNode);
+    return config;
+}
+
+QJsonObject SchedulingConfig::toJson() const
+{
+    return QJsonObject{
+        {"enabled", enabled},
+        {"grab", grab.toJson()},
+        {"detection", detection.toJson()},
+        {"inference", inference.toJson()},
+        {"recording", recording.toJson()},
+        {"control", control.toJson()},
+        {"ui", ui.toJson()}
+    };
+}
+
+SchedulingConfig SchedulingConfig::fromJson(const QJsonObject& json)
+{
+    SchedulingConfig config;
+    config.enabled = json.value("enabled").toBool(config.enabled);
+    config.grab = ThreadSchedulingConfig::fromJson(json.value("grab").toObject(), config.grab);
+    config.detection = ThreadSchedulingConfig::fromJson(json.value("detection").toObject(), config.detection);
+    config.inference = ThreadSchedulingConfig::fromJson(json.value("inference").toObject(), config.inference);
+    config.recording = ThreadSchedulingConfig::fromJson(json.value("recording").toObject(), config.recording);
+    config.control = ThreadSchedulingConfig::fromJson(json.value("control").toObject(), config.control);
+    config.ui = ThreadSchedulingConfig::fromJson(json.value("ui").toObject(), config.ui);
     return config;
 }
 
@@ -163,7 +421,13 @@ QJsonObject YoloConfig::toJson() const
         {"nmsThreshold", nmsThreshold},
         {"roiUpscaleFactor", roiUpscaleFactor},
         {"inputSize", inputSize},
-        {"enabled", enabled}
+        {"enabled", enabled},
+        {"asyncInference", asyncInference},
+        {"batchSize", batchSize},
+        {"backend", backend},
+        {"device", device},
+        {"tiledInference", tiledInference},
+        {"tileOverlap", tileOverlap}
     };
 }
 
@@ -176,6 +440,12 @@ YoloConfig YoloConfig::fromJson(const QJsonObject& json)
     config.roiUpscaleFactor = json.value("roiUpscaleFactor").toDouble(config.roiUpscaleFactor);
     config.inputSize = json.value("inputSize").toInt(config.inputSize);
     config.enabled = json.value("enabled").toBool(config.enabled);
+    config.asyncInference = json.value("asyncInference").toBool(config.asyncInference);
+    config.batchSize = json.value("batchSize").toInt(config.batchSize);
+    config.backend = json.value("backend").toString(config.backend);
+    config.device = json.value("device").toString(config.device);
+    config.tiledInference = json.value("tiledInference").toBool(config.tiledInference);
+    config.tileOverlap = json.value("tileOverlap").toInt(config.tileOverlap);
     return config;
 }
 
@@ -188,6 +458,23 @@ QJsonObject PerformanceConfig::toJson() const
     return QJsonObject{
         {"targetProcessingWidth", targetProcessingWidth},
         {"skipFrames", skipFrames},
+        {"frameRingCapacity", frameRingCapacity},
+        {"fusedStandardPipeline", fusedStandardPipeline},
+        {"verifyFusedPipeline", verifyFusedPipeline},
+        {"cropBeforeResize", cropBeforeResize},
+        {"classicalDevice", classicalDevice},
+        {"bgSubtractorBands", bgSubtractorBands},
+        {"runLengthBlobs", runLengthBlobs},
+        {"adaptiveQuality", adaptiveQuality},
+        {"governorDegradeLoad", governorDegradeLoad},
+        {"governorRestoreLoad", governorRestoreLoad},
+        {"governorBacklogFrames", governorBacklogFrames},
+        {"stageProfiling", stageProfiling},
+        {"stageProfilingIntervalMs", stageProfilingIntervalMs},
+        {"overlayAsData", overlayAsData},
+        {"videoPrefetchFrames", videoPrefetchFrames},
+        {"videoFrameCacheFrames", videoFrameCacheFrames},
+        {"videoStepBackSpan", videoStepBackSpan},
         {"showGray", showGray},
         {"showBinary", showBinary},
         {"showEdges", showEdges},
@@ -201,24 +488,56 @@ PerformanceConfig PerformanceConfig::fromJson(const QJsonObject& json)
     PerformanceConfig config;
     config.targetProcessingWidth = json.value("targetProcessingWidth").toInt(config.targetProcessingWidth);
     config.skipFrames = json.value("skipFrames").toInt(config.skipFrames);
+    config.frameRingCapacity = json.value("frameRingCapacity").toInt(config.frameRingCapacity);
+    config.fusedStandardPipeline = json.value("fusedStandardPipeline").toBool(config.fusedStandardPipeline);
+    config.verifyFusedPipeline = json.value("verifyFusedPipeline").toBool(config.verifyFusedPipeline);
+    config.cropBeforeResize = json.value("cropBeforeResize").toBool(config.cropBeforeResize);
+    config.classicalDevice = json.value("classicalDevice").toString(config.classicalDevice);
+    config.bgSubtractorBands = json.value("bgSubtractorBands").toInt(config.bgSubtractorBands);
+    config.runLengthBlobs = json.value("runLengthBlobs").toBool(config.runLengthBlobs);
+    config.adaptiveQuality = json.value("adaptiveQuality").toBool(config.adaptiveQuality);
+    config.governorDegradeLoad = json.value("governorDegradeLoad").toDouble(config.governorDegradeLoad);
+    config.governorRestoreLoad = json.value("governorRestoreLoad").toDouble(config.governorRestoreLoad);
+    config.governorBacklogFrames = json.value("governorBacklogFrames").toInt(config.governorBacklogFrames);
+    config.stageProfiling = json.value("stageProfiling").toBool(config.stageProfiling);
+    config.stageProfilingIntervalMs = json.value("stageProfilingIntervalMs").toInt(config.stageProfilingIntervalMs);
+    config.overlayAsData = json.value("overlayAsData").toBool(config.overlayAsData);
+    config.videoPrefetchFrames = json.value("videoPrefetchFrames").toInt(config.videoPrefetchFrames);
+    config.videoFrameCacheFrames = json.value("videoFrameCacheFrames").toInt(config.videoFrameCacheFrames);
+    config.videoStepBackSpan = json.value("videoStepBackSpan").toInt(config.videoStepBackSpan);
     return config;
 }
 
 QJsonObject DebugConfig::toJson() const
 {
     return QJsonObject{
-        {"debugSaveEnabled", debugSaveEnabled},
-        {"debugSaveDir", debugSaveDir},
-        {"maxDebugFrames", maxDebugFrames}
+        {"eventRecordingEnabled", eventRecordingEnabled},
+        {"eventRecordingDir", eventRecordingDir},
+        {"preTriggerSeconds", preTriggerSeconds},
+        {"postTriggerSeconds", postTriggerSeconds},
+        {"jpegQuality", jpegQuality},
+        {"maxBufferMegabytes", maxBufferMegabytes},
+        {"gateBurstCount", gateBurstCount},
+        {"gateBurstWindowMs", gateBurstWindowMs},
+        {"triggerOnPackagingMismatch", triggerOnPackagingMismatch},
+        {"triggerOnQualityDegrade", triggerOnQualityDegrade}
     };
 }
 
 DebugConfig DebugConfig::fromJson(const QJsonObject& json)
 {
     DebugConfig config;
-    config.debugSaveEnabled = json.value("debugSaveEnabled").toBool(config.debugSaveEnabled);
-    config.debugSaveDir = json.value("debugSaveDir").toString(config.debugSaveDir);
-    config.maxDebugFrames = json.value("maxDebugFrames").toInt(config.maxDebugFrames);
+    config.eventRecordingEnabled = json.value("eventRecordingEnabled").toBool(config.eventRecordingEnabled);
+    config.eventRecordingDir = json.value("eventRecordingDir").toString(config.eventRecordingDir);
+    config.preTriggerSeconds = json.value("preTriggerSeconds").toDouble(config.preTriggerSeconds);
+    config.postTriggerSeconds = json.value("postTriggerSeconds").toDouble(config.postTriggerSeconds);
+    config.jpegQuality = json.value("jpegQuality").toInt(config.jpegQuality);
+    config.maxBufferMegabytes = json.value("maxBufferMegabytes").toInt(config.maxBufferMegabytes);
+    config.gateBurstCount = json.value("gateBurstCount").toInt(config.gateBurstCount);
+    config.gateBurstWindowMs = json.value("gateBurstWindowMs").toInt(config.gateBurstWindowMs);
+    config.triggerOnPackagingMismatch =
+        json.value("triggerOnPackagingMismatch").toBool(config.triggerOnPackagingMismatch);
+    config.triggerOnQualityDegrade = json.value("triggerOnQualityDegrade").toBool(config.triggerOnQualityDegrade);
     return config;
 }
 
@@ -231,13 +550,16 @@ QJsonObject UIConfig::toJson() const
         {"maxAreaRangeMin", maxAreaRangeMin},
         {"maxAreaRangeMax", maxAreaRangeMax},
         {"maxAreaDefault", maxAreaDefault},
-        {"bgVarThresholdDefault", bgVarThresholdDefault}
+        {"bgVarThresholdDefault", bgVarThresholdDefault},
+        {"gpuDisplay", gpuDisplay}
     };
 }
 
-UIConfig UIConfig::fromJson(const QJsonObject& /*json*/)
+UIConfig UIConfig::fromJson(const QJsonObject& json)
 {
-    return UIConfig{};
+    UIConfig config;
+    config.gpuDisplay = json.value("gpuDisplay").toBool(config.gpuDisplay);
+    return config;
 }
 
 // ============================================================================
@@ -266,6 +588,28 @@ DetectionMethodConfig DetectionMethodConfig::fromJson(const QJsonObject& json)
     return method;
 }
 
+QJsonObject LaneConfig::toJson() const
+{
+    return QJsonObject{
+        {"name", name},
+        {"roiX", roiX},
+        {"roiWidth", roiWidth},
+        {"targetCount", targetCount},
+        {"gateLinePositionRatio", gateLinePositionRatio}
+    };
+}
+
+LaneConfig LaneConfig::fromJson(const QJsonObject& json)
+{
+    LaneConfig lane;
+    lane.name = json.value("name").toString(lane.name);
+    lane.roiX = json.value("roiX").toInt(lane.roiX);
+    lane.roiWidth = json.value("roiWidth").toInt(lane.roiWidth);
+    lane.targetCount = json.value("targetCount").toInt(lane.targetCount);
+    lane.gateLinePositionRatio = json.value("gateLinePositionRatio").toDouble(lane.gateLinePositionRatio);
+    return lane;
+}
+
 QJsonObject PartProfile::toJson() const
 {
     QJsonArray methodsArray;
@@ -273,6 +617,11 @@ QJsonObject PartProfile::toJson() const
         methodsArray.append(method.toJson());
     }
 
+    QJsonArray lanesArray;
+    for (const auto& lane : lanes) {
+        lanesArray.append(lane.toJson());
+    }
+
     return QJsonObject{
         {"partId", partId},
         {"partName", partName},
@@ -282,7 +631,8 @@ QJsonObject PartProfile::toJson() const
         {"isReflective", isReflective},
         {"requiresHighSpeed", requiresHighSpeed},
         {"availableMethods", methodsArray},
-        {"currentMethodId", currentMethodId}
+        {"currentMethodId", currentMethodId},
+        {"lanes", lanesArray}
     };
 }
 
@@ -303,6 +653,10 @@ PartProfile PartProfile::fromJson(const QJsonObject& json)
         profile.availableMethods.push_back(DetectionMethodConfig::fromJson(methodVal.toObject()));
     }
 
+    for (const auto& laneVal : json.value("lanes").toArray()) {
+        profile.lanes.push_back(LaneConfig::fromJson(laneVal.toObject()));
+    }
+
     return profile;
 }
 
@@ -434,10 +788,15 @@ bool AppConfig::load(const QString& filePath)
     QJsonObject root = doc.object();
 
     m_camera = CameraConfig::fromJson(root.value("camera").toObject());
+    m_multiCamera = MultiCameraConfig::fromJson(root.value("multiCamera").toObject());
     m_detection = DetectionConfig::fromJson(root.value("detection").toObject());
     m_gate = GateConfig::fromJson(root.value("gate").toObject());
     m_packaging = PackagingConfig::fromJson(root.value("packaging").toObject());
+    m_vibrator = VibratorConfig::fromJson(root.value("vibrator").toObject());
     m_performance = PerformanceConfig::fromJson(root.value("performance").toObject());
+    m_telemetry = TelemetryConfig::fromJson(root.value("telemetry").toObject());
+    m_scheduling = SchedulingConfig::fromJson(root.value("scheduling").toObject());
+    m_recording = RecordingConfig::fromJson(root.value("recording").toObject());
     m_debug = DebugConfig::fromJson(root.value("debug").toObject());
     m_ui = UIConfig::fromJson(root.value("ui").toObject());
     m_yolo = YoloConfig::fromJson(root.value("yolo").toObject());
@@ -477,10 +836,15 @@ bool AppConfig::save(const QString& filePath) const
 
     QJsonObject root;
     root["camera"] = m_camera.toJson();
+    root["multiCamera"] = m_multiCamera.toJson();
     root["detection"] = m_detection.toJson();
     root["gate"] = m_gate.toJson();
     root["packaging"] = m_packaging.toJson();
+    root["vibrator"] = m_vibrator.toJson();
     root["performance"] = m_performance.toJson();
+    root["telemetry"] = m_telemetry.toJson();
+    root["scheduling"] = m_scheduling.toJson();
+    root["recording"] = m_recording.toJson();
     root["debug"] = m_debug.toJson();
     root["ui"] = m_ui.toJson();
     root["yolo"] = m_yolo.toJson();
@@ -505,10 +869,15 @@ bool AppConfig::save(const QString& filePath) const
 void AppConfig::resetToDefault()
 {
     m_camera = CameraConfig();
+    m_multiCamera = MultiCameraConfig();
     m_detection = DetectionConfig();
     m_gate = GateConfig();
     m_packaging = PackagingConfig();
+    m_vibrator = VibratorConfig();
     m_performance = PerformanceConfig();
+    m_telemetry = TelemetryConfig();
+    m_scheduling = SchedulingConfig();
+    m_recording = RecordingConfig();
     m_debug = DebugConfig();
     m_ui = UIConfig();
     m_yolo = YoloConfig();
@@ -0,0 +1,267 @@
+#include "core/assignment_solver.h"
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <numeric>
+
+namespace basler
+{
+
+    AssignmentSolver::Stats AssignmentSolver::solve(std::vector<AssignmentCandidate> &candidates,
+                                                    int trackCount, int objectCount, double budgetMs,
+                                                    std::vector<std::pair<int, int>> &assignments)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        auto elapsedMs = [&start]()
+        {
+            return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        };
+
+        Stats stats;
+        assignments.clear();
+        if (candidates.empty())
+        {
+            return stats;
+        }
+
+        // 第一步：聯集-查找拆出連通分量
+        m_trackCount = trackCount;
+        const int nodeCount = trackCount + objectCount;
+        m_parent.resize(nodeCount);
+        std::iota(m_parent.begin(), m_parent.end(), 0);
+        for (const auto &c : candidates)
+        {
+            int a = findRoot(c.track);
+            int b = findRoot(trackCount + c.object);
+            if (a != b)
+            {
+                m_parent[b] = a;
+            }
+        }
+
+        // 第二步：依分量排序，分量內依分數由高到低（貪婪求解直接使用此順序）
+        m_componentOf.resize(candidates.size());
+        for (size_t i = 0; i < candidates.size(); ++i)
+        {
+            m_componentOf[i] = findRoot(candidates[i].track);
+        }
+        m_order.resize(candidates.size());
+        std::iota(m_order.begin(), m_order.end(), 0);
+        std::sort(m_order.begin(), m_order.end(),
+                  [&](int a, int b)
+                  {
+                      const auto &ca = candidates[a];
+                      const auto &cb = candidates[b];
+                      if (m_componentOf[a] != m_componentOf[b])
+                          return m_componentOf[a] < m_componentOf[b];
+                      if (ca.score != cb.score)
+                          return ca.score > cb.score;
+                      if (ca.track != cb.track)
+                          return ca.track < cb.track;
+                      return ca.object < cb.object;
+                  });
+        m_sorted.clear();
+        for (int &idx : m_order)
+        {
+            m_sorted.push_back(candidates[idx]);
+            idx = m_componentOf[idx]; // m_order 改存排序後各候選的分量，與 m_sorted 對齊
+        }
+        candidates.swap(m_sorted);
+
+        m_localIndex.assign(nodeCount, -1);
+        m_used.assign(nodeCount, 0);
+
+        // 第三步：逐分量求解
+        size_t begin = 0;
+        while (begin < candidates.size())
+        {
+            size_t end = begin + 1;
+            while (end < candidates.size() && m_order[end] == m_order[begin])
+            {
+                ++end;
+            }
+
+            const AssignmentCandidate *first = candidates.data() + begin;
+            const AssignmentCandidate *last = candidates.data() + end;
+
+            if (end - begin == 1)
+            {
+                // 單一候選：唯一解
+                assignments.emplace_back(first->track, first->object);
+                stats.optimalComponents++;
+            }
+            else if (budgetMs > 0.0 && elapsedMs() > budgetMs)
+            {
+                stats.budgetExceeded = true;
+                stats.greedyComponents++;
+                solveGreedy(first, last, assignments);
+            }
+            else
+            {
+                // 分量內局部編號
+                m_rowNodes.clear();
+                m_colNodes.clear();
+                for (const auto *c = first; c != last; ++c)
+                {
+                    if (m_localIndex[c->track] < 0)
+                    {
+                        m_localIndex[c->track] = static_cast<int>(m_rowNodes.size());
+                        m_rowNodes.push_back(c->track);
+                    }
+                    const int objNode = trackCount + c->object;
+                    if (m_localIndex[objNode] < 0)
+                    {
+                        m_localIndex[objNode] = static_cast<int>(m_colNodes.size());
+                        m_colNodes.push_back(c->object);
+                    }
+                }
+
+                const int tracks = static_cast<int>(m_rowNodes.size());
+                const int objects = static_cast<int>(m_colNodes.size());
+                if (std::max(tracks, objects) > MAX_DENSE_SIZE)
+                {
+                    stats.greedyComponents++;
+                    solveGreedy(first, last, assignments);
+                }
+                else
+                {
+                    stats.optimalComponents++;
+                    // Hungarian 要求列數 <= 行數：追蹤較多時轉置
+                    const bool transposed = tracks > objects;
+                    solveHungarian(first, last, transposed ? objects : tracks,
+                                   transposed ? tracks : objects, transposed, assignments);
+                }
+
+                for (int track : m_rowNodes)
+                {
+                    m_localIndex[track] = -1;
+                }
+                for (int object : m_colNodes)
+                {
+                    m_localIndex[trackCount + object] = -1;
+                }
+            }
+
+            begin = end;
+        }
+
+        stats.elapsedMs = elapsedMs();
+        return stats;
+    }
+
+    int AssignmentSolver::findRoot(int node)
+    {
+        while (m_parent[node] != node)
+        {
+            m_parent[node] = m_parent[m_parent[node]]; // 路徑減半
+            node = m_parent[node];
+        }
+        return node;
+    }
+
+    void AssignmentSolver::solveGreedy(const AssignmentCandidate *begin, const AssignmentCandidate *end,
+                                       std::vector<std::pair<int, int>> &assignments)
+    {
+        // 候選已依分數由高到低排序；兩端都未使用才配對
+        for (const auto *c = begin; c != end; ++c)
+        {
+            const int objNode = m_trackCount + c->object;
+            if (m_used[c->track] || m_used[objNode])
+            {
+                continue;
+            }
+            m_used[c->track] = 1;
+            m_used[objNode] = 1;
+            assignments.emplace_back(c->track, c->object);
+        }
+    }
+
+    void AssignmentSolver::solveHungarian(const AssignmentCandidate *begin, const AssignmentCandidate *end,
+                                          int rows, int cols, bool transposed,
+                                          std::vector<std::pair<int, int>> &assignments)
+    {
+        // 成本 = -score；無候選的組合成本 0（等同不配對），求最小成本 = 總分最大
+        const int stride = cols + 1;
+        m_cost.assign(static_cast<size_t>(rows + 1) * stride, 0.0);
+        for (const auto *c = begin; c != end; ++c)
+        {
+            const int trackLocal = m_localIndex[c->track];
+            const int objLocal = m_localIndex[m_trackCount + c->object];
+            const int r = transposed ? objLocal : trackLocal;
+            const int col = transposed ? trackLocal : objLocal;
+            m_cost[(r + 1) * stride + (col + 1)] = -c->score;
+        }
+
+        const double INF = std::numeric_limits<double>::infinity();
+        m_u.assign(rows + 1, 0.0);
+        m_v.assign(cols + 1, 0.0);
+        m_match.assign(cols + 1, 0);
+        m_way.assign(cols + 1, 0);
+
+        for (int i = 1; i <= rows; ++i)
+        {
+            m_match[0] = i;
+            int j0 = 0;
+            m_minv.assign(cols + 1, INF);
+            m_visited.assign(cols + 1, 0);
+            do
+            {
+                m_visited[j0] = 1;
+                const int i0 = m_match[j0];
+                double delta = INF;
+                int j1 = 0;
+                for (int j = 1; j <= cols; ++j)
+                {
+                    if (m_visited[j])
+                        continue;
+                    const double cur = m_cost[i0 * stride + j] - m_u[i0] - m_v[j];
+                    if (cur < m_minv[j])
+                    {
+                        m_minv[j] = cur;
+                        m_way[j] = j0;
+                    }
+                    if (m_minv[j] < delta)
+                    {
+                        delta = m_minv[j];
+                        j1 = j;
+                    }
+                }
+                for (int j = 0; j <= cols; ++j)
+                {
+                    if (m_visited[j])
+                    {
+                        m_u[m_match[j]] += delta;
+                        m_v[j] -= delta;
+                    }
+                    else
+                    {
+                        m_minv[j] -= delta;
+                    }
+                }
+                j0 = j1;
+            } while (m_match[j0] != 0);
+
+            do
+            {
+                const int j1 = m_way[j0];
+                m_match[j0] = m_match[j1];
+                j0 = j1;
+            } while (j0 != 0);
+        }
+
+        // 只輸出實際有候選（成本 < 0）的配對
+        for (int j = 1; j <= cols; ++j)
+        {
+            const int i = m_match[j];
+            if (i == 0 || m_cost[i * stride + j] >= 0.0)
+                continue;
+
+            const int r = i - 1;
+            const int col = j - 1;
+            const int track = transposed ? m_rowNodes[col] : m_rowNodes[r];
+            const int object = transposed ? m_colNodes[r] : m_colNodes[col];
+            assignments.emplace_back(track, object);
+        }
+    }
+
+} // namespace basler
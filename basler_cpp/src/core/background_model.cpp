@@ -0,0 +1,123 @@
+#include "core/background_model.h"
+#include "core/gaussian_background.h"
+#include <algorithm>
+
+namespace basler
+{
+
+    BackgroundEngine backgroundEngineFromName(const std::string &name)
+    {
+        return name == "gaussian" ? BackgroundEngine::Gaussian : BackgroundEngine::MOG2;
+    }
+
+    const char *backgroundEngineName(BackgroundEngine engine)
+    {
+        return engine == BackgroundEngine::Gaussian ? "gaussian" : "mog2";
+    }
+
+    void BackgroundModel::reset(BackgroundEngine engine, int history, double varThreshold, bool detectShadows,
+                                int bands)
+    {
+        m_engine = engine;
+        m_history = history;
+        m_varThreshold = varThreshold;
+        m_detectShadows = detectShadows;
+        m_requestedBands = std::max(1, bands);
+
+        // 影像尺寸未知：下一次 apply() 依列數分帶並建立各帶模型
+        release();
+    }
+
+    void BackgroundModel::release()
+    {
+        m_bands.clear();
+        m_size = cv::Size();
+    }
+
+    void BackgroundModel::layoutBands(int rows, int maxBands)
+    {
+        const int count = std::clamp(rows / MIN_BAND_ROWS, 1, maxBands);
+
+        m_bands.resize(count);
+        for (int i = 0; i < count; ++i)
+        {
+            Band &band = m_bands[i];
+            band.rowBegin = rows * i / count;
+            band.rowEnd = rows * (i + 1) / count;
+            band.subtractor = createSubtractor();
+        }
+    }
+
+    cv::Ptr<cv::BackgroundSubtractor> BackgroundModel::createSubtractor() const
+    {
+        if (m_engine == BackgroundEngine::Gaussian)
+        {
+            return createGaussianBackgroundSubtractor(m_history, m_varThreshold);
+        }
+        return cv::createBackgroundSubtractorMOG2(m_history, m_varThreshold, m_detectShadows);
+    }
+
+    void BackgroundModel::apply(const cv::Mat &image, cv::Mat &fgMask, double learningRate)
+    {
+        CV_Assert(!image.empty());
+
+        if (m_bands.empty() || image.size() != m_size || m_onDevice)
+        {
+            // 尺寸改變：MOG2 本身也會重新初始化，這裡同時重新分帶
+            layoutBands(image.rows, m_requestedBands);
+            m_size = image.size();
+            m_onDevice = false;
+        }
+
+        if (m_bands.size() == 1)
+        {
+            m_bands[0].subtractor->apply(image, fgMask, learningRate);
+            return;
+        }
+
+        fgMask.create(image.size(), CV_8UC1);
+        cv::parallel_for_(cv::Range(0, static_cast<int>(m_bands.size())), [&](const cv::Range &range)
+                          {
+                              for (int i = range.start; i < range.end; ++i)
+                              {
+                                  Band &band = m_bands[i];
+                                  const cv::Range rows(band.rowBegin, band.rowEnd);
+                                  cv::Mat bandMask = fgMask.rowRange(rows);
+                                  uchar *target = bandMask.data;
+
+                                  // 遮罩子區塊尺寸與型別已正確，apply() 直接寫入原位
+                                  band.subtractor->apply(image.rowRange(rows), bandMask, learningRate);
+                                  if (bandMask.data != target)
+                                  {
+                                      bandMask.copyTo(fgMask.rowRange(rows));
+                                  }
+                              } });
+    }
+
+    void BackgroundModel::apply(const cv::UMat &image, cv::UMat &fgMask, double learningRate)
+    {
+        CV_Assert(!image.empty());
+
+        if (m_engine != BackgroundEngine::MOG2)
+        {
+            // 單高斯引擎只有主機端實作：下載影像、更新模型、上傳遮罩
+            cv::Mat hostMask;
+            {
+                const cv::Mat hostImage = image.getMat(cv::ACCESS_READ);
+                apply(hostImage, hostMask, learningRate);
+            }
+            hostMask.copyTo(fgMask);
+            return;
+        }
+
+        if (m_bands.empty() || image.size() != m_size || !m_onDevice)
+        {
+            layoutBands(image.rows, 1);
+            m_size = image.size();
+            m_onDevice = true;
+        }
+        // UMat 輸入時 MOG2 走 OpenCL 實作，高斯混合模型保存在裝置記憶體
+        m_bands[0].subtractor->apply(image, fgMask, learningRate);
+    }
+
+} // namespace basler
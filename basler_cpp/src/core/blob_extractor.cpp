@@ -0,0 +1,207 @@
+#include "core/blob_extractor.h"
+#include <opencv2/core/hal/intrin.hpp>
+#include <algorithm>
+#include <limits>
+
+namespace basler
+{
+
+    void RunLengthBlobExtractor::scanRow(const uchar *row, int width, std::vector<Run> &runs)
+    {
+        runs.clear();
+        int x = 0;
+        while (x < width)
+        {
+#if CV_SIMD128
+            // 全背景區段 16 像素一組跳過（遮罩絕大部分為 0）
+            const cv::v_uint8x16 vZero = cv::v_setzero_u8();
+            while (x <= width - 16 && !cv::v_check_any(cv::v_load(row + x) != vZero))
+            {
+                x += 16;
+            }
+#endif
+            while (x < width && row[x] == 0)
+            {
+                ++x;
+            }
+            if (x >= width)
+            {
+                break;
+            }
+
+            const int start = x;
+            while (x < width && row[x] != 0)
+            {
+                ++x;
+            }
+            runs.push_back({start, x, -1});
+        }
+    }
+
+    void RunLengthBlobExtractor::dilateRuns(const std::vector<Run> &above, const std::vector<Run> &current,
+                                            int width, std::vector<Run> &out)
+    {
+        // 2×2 核、錨點 (1, 1)：dst(x, y) = max(src(x-1..x, y-1..y))
+        // → 兩列行程取聯集，每段右端延伸 1（夾在影像寬度內），相接的段合併
+        out.clear();
+        size_t i = 0, j = 0;
+        while (i < above.size() || j < current.size())
+        {
+            const Run &next = (j >= current.size() || (i < above.size() && above[i].x0 < current[j].x0))
+                                  ? above[i++]
+                                  : current[j++];
+            const int x1 = std::min(next.x1 + 1, width);
+            if (!out.empty() && next.x0 <= out.back().x1)
+            {
+                out.back().x1 = std::max(out.back().x1, x1);
+            }
+            else
+            {
+                out.push_back({next.x0, x1, -1});
+            }
+        }
+    }
+
+    int RunLengthBlobExtractor::newLabel()
+    {
+        const int label = static_cast<int>(m_parent.size());
+        m_parent.push_back(label);
+        m_accum.push_back({std::numeric_limits<int>::max(), std::numeric_limits<int>::max(), -1, -1, 0, 0, 0});
+        return label;
+    }
+
+    int RunLengthBlobExtractor::find(int label)
+    {
+        while (m_parent[label] != label)
+        {
+            m_parent[label] = m_parent[m_parent[label]]; // 路徑減半
+            label = m_parent[label];
+        }
+        return label;
+    }
+
+    void RunLengthBlobExtractor::unite(int a, int b)
+    {
+        a = find(a);
+        b = find(b);
+        // 較小（較早建立）的標籤為根：輸出順序 = 首個像素的光柵順序
+        if (a < b)
+        {
+            m_parent[b] = a;
+        }
+        else if (b < a)
+        {
+            m_parent[a] = b;
+        }
+    }
+
+    void RunLengthBlobExtractor::accumulate(int label, const Run &run, int y)
+    {
+        Accumulator &acc = m_accum[label];
+        const int64_t length = run.x1 - run.x0;
+        acc.minX = std::min(acc.minX, run.x0);
+        acc.maxX = std::max(acc.maxX, run.x1 - 1);
+        acc.minY = std::min(acc.minY, y);
+        acc.maxY = std::max(acc.maxY, y);
+        acc.area += length;
+        acc.sumX += (static_cast<int64_t>(run.x0) + run.x1 - 1) * length / 2;
+        acc.sumY += static_cast<int64_t>(y) * length;
+    }
+
+    const std::vector<RunLengthBlobExtractor::Blob> &RunLengthBlobExtractor::extract(const cv::Mat &mask,
+                                                                                 int connectivity,
+                                                                                 bool dilate2x2)
+    {
+        CV_Assert(mask.type() == CV_8UC1);
+
+        m_blobs.clear();
+        m_parent.clear();
+        m_accum.clear();
+        m_prev.clear();
+        m_rawPrev.clear();
+
+        // 8 連通：對角相鄰也算重疊（區間端點允許相差 1）
+        const int reach = connectivity == 8 ? 1 : 0;
+        const int width = mask.cols;
+
+        for (int y = 0; y < mask.rows; ++y)
+        {
+            if (dilate2x2)
+            {
+                scanRow(mask.ptr<uchar>(y), width, m_rawCur);
+                dilateRuns(m_rawPrev, m_rawCur, width, m_cur);
+                std::swap(m_rawPrev, m_rawCur);
+            }
+            else
+            {
+                scanRow(mask.ptr<uchar>(y), width, m_cur);
+            }
+
+            // 與上一列的行程（皆依 x 排序）雙指標比對
+            size_t p = 0;
+            for (Run &run : m_cur)
+            {
+                while (p < m_prev.size() && m_prev[p].x1 + reach <= run.x0)
+                {
+                    ++p;
+                }
+                for (size_t q = p; q < m_prev.size() && m_prev[q].x0 < run.x1 + reach; ++q)
+                {
+                    if (run.label < 0)
+                    {
+                        run.label = m_prev[q].label;
+                    }
+                    else
+                    {
+                        unite(run.label, m_prev[q].label);
+                    }
+                }
+                if (run.label < 0)
+                {
+                    run.label = newLabel();
+                }
+                accumulate(run.label, run, y);
+            }
+            std::swap(m_prev, m_cur);
+        }
+
+        // 依根節點合併統計量；根依建立順序遍歷即為光柵順序
+        const int labels = static_cast<int>(m_parent.size());
+        for (int label = 0; label < labels; ++label)
+        {
+            const int root = find(label);
+            if (root != label)
+            {
+                Accumulator &dst = m_accum[root];
+                const Accumulator &src = m_accum[label];
+                dst.minX = std::min(dst.minX, src.minX);
+                dst.minY = std::min(dst.minY, src.minY);
+                dst.maxX = std::max(dst.maxX, src.maxX);
+                dst.maxY = std::max(dst.maxY, src.maxY);
+                dst.area += src.area;
+                dst.sumX += src.sumX;
+                dst.sumY += src.sumY;
+            }
+        }
+
+        for (int label = 0; label < labels; ++label)
+        {
+            if (m_parent[label] != label)
+            {
+                continue;
+            }
+            const Accumulator &acc = m_accum[label];
+            Blob blob;
+            blob.left = acc.minX;
+            blob.top = acc.minY;
+            blob.width = acc.maxX - acc.minX + 1;
+            blob.height = acc.maxY - acc.minY + 1;
+            blob.area = static_cast<int>(acc.area);
+            blob.centroidX = static_cast<double>(acc.sumX) / acc.area;
+            blob.centroidY = static_cast<double>(acc.sumY) / acc.area;
+            m_blobs.push_back(blob);
+        }
+        return m_blobs;
+    }
+
+} // namespace basler
@@ -1,8 +1,13 @@
 #include "core/camera_controller.h"
+#include "core/frame_ring.h"
+#include "core/thread_scheduling.h"
 #include "config/settings.h"
 #include <QDebug>
 #include <QDateTime>
 #include <QtConcurrent>
+#include <algorithm>
+#include <climits>
+#include <limits>
 
 #ifndef NO_PYLON_SDK
 
@@ -12,12 +17,103 @@ namespace basler
     // Pylon 全局初始化（RAII 模式）
     Pylon::PylonAutoInitTerm CameraController::s_pylonInit;
 
+    namespace
+    {
+        /**
+         * @brief 以 CGrabResultPtr 決定像素緩衝生命週期的 cv::Mat 配置器
+         *
+         * UMatData::userdata 持有一份 CGrabResultPtr，最後一個引用該 Mat 的物件釋放時
+         * 才把緩衝交還 Pylon。新配置（create / clone 目標）一律交給 OpenCV 預設配置器。
+         */
+        class GrabResultAllocator : public cv::MatAllocator
+        {
+        public:
+            cv::UMatData *allocate(int dims, const int *sizes, int type, void *data, size_t *step,
+                                   cv::AccessFlag flags, cv::UMatUsageFlags usageFlags) const override
+            {
+                return cv::Mat::getStdAllocator()->allocate(dims, sizes, type, data, step, flags, usageFlags);
+            }
+
+            bool allocate(cv::UMatData *data, cv::AccessFlag accessFlags, cv::UMatUsageFlags usageFlags) const override
+            {
+                return cv::Mat::getStdAllocator()->allocate(data, accessFlags, usageFlags);
+            }
+
+            void deallocate(cv::UMatData *u) const override
+            {
+                if (!u)
+                {
+                    return;
+                }
+                delete static_cast<Pylon::CGrabResultPtr *>(u->userdata);
+                delete u;
+            }
+        };
+
+        /**
+         * @brief 零拷貝包裝 Pylon 抓取緩衝
+         * @return 直接指向 Pylon 緩衝的 cv::Mat；其引用計數持有 grabResult
+         */
+        cv::Mat wrapGrabResult(const Pylon::CGrabResultPtr &grabResult, int cvType, size_t step)
+        {
+            static GrabResultAllocator allocator;
+
+            uchar *buffer = static_cast<uchar *>(grabResult->GetBuffer());
+            const int rows = static_cast<int>(grabResult->GetHeight());
+            cv::Mat frame(rows, static_cast<int>(grabResult->GetWidth()), cvType, buffer, step);
+
+            cv::UMatData *u = new cv::UMatData(&allocator);
+            u->data = u->origdata = buffer;
+            u->size = step * rows;
+            u->userdata = new Pylon::CGrabResultPtr(grabResult);
+            u->refcount = 1;
+            frame.u = u;
+            return frame;
+        }
+
+        CameraInfo cameraInfoFrom(const Pylon::CDeviceInfo &device, int index)
+        {
+            CameraInfo info;
+            info.index = index;
+            info.model = QString::fromStdString(device.GetModelName().c_str());
+            info.serial = QString::fromStdString(device.GetSerialNumber().c_str());
+            info.friendlyName = QString::fromStdString(device.GetFriendlyName().c_str());
+            if (device.IsIpAddressAvailable())
+            {
+                info.ipAddress = QString::fromStdString(device.GetIpAddress().c_str());
+            }
+            info.isTargetModel = info.model.contains("acA640-300gm");
+            return info;
+        }
+
+        /**
+         * @brief 將感測器上的 [first, last] 區間對齊到相機的 Offset / 尺寸步進，且不超出感測器
+         * @return (offset, size)；Offset 節點不存在時區間從 0 開始
+         */
+        std::pair<int, int> alignAoiRange(GenApi::INodeMap &nodemap, const char *offsetName, const char *sizeName,
+                                          int first, int last, int sensorSize)
+        {
+            GenApi::CIntegerPtr offset(nodemap.GetNode(offsetName));
+            GenApi::CIntegerPtr size(nodemap.GetNode(sizeName));
+            const int offsetInc = offset.IsValid() ? std::max(1, static_cast<int>(offset->GetInc())) : 1;
+            const int sizeInc = size.IsValid() ? std::max(1, static_cast<int>(size->GetInc())) : 1;
+            const int sizeMin = size.IsValid() ? static_cast<int>(size->GetMin()) : 1;
+
+            first = offset.IsValid() ? std::max(0, first) : 0;
+            last = std::min(sensorSize - 1, last);
+            int length = std::max(sizeMin, last - first + 1);
+            length = std::min(sensorSize, (length + sizeInc - 1) / sizeInc * sizeInc);
+            const int start = std::min(first, sensorSize - length) / offsetInc * offsetInc;
+            return {start, length};
+        }
+    }
+
     // ============================================================================
     // GrabWorker 實現
     // ============================================================================
 
-    GrabWorker::GrabWorker(Pylon::CInstantCamera *camera, QObject *parent)
-        : QObject(parent), m_camera(camera)
+    GrabWorker::GrabWorker(Pylon::CInstantCamera *camera, FrameRing *ring, QObject *parent)
+        : QObject(parent), m_camera(camera), m_ring(ring)
     {
     }
 
@@ -38,11 +134,14 @@ namespace basler
 
         try
         {
-            // 增加接收緩衝區（防止 GigE 緩衝區不足）
-            m_camera->MaxNumBuffer = 10;
+            configureBuffers();
+            m_lastBlockId = 0;
 
-            // 配置抓取策略：只保留最新幀，丟棄中間幀
-            m_camera->StartGrabbing(Pylon::GrabStrategy_LatestImageOnly);
+            // 配置抓取策略：
+            // - 一般模式：只保留最新幀，丟棄中間幀
+            // - 無損計數：依序取出每一幀，檢測跟不上時由 Pylon 緩衝排隊
+            m_camera->StartGrabbing(m_lossless ? Pylon::GrabStrategy_OneByOne
+                                               : Pylon::GrabStrategy_LatestImageOnly);
 
             Pylon::CGrabResultPtr grabResult;
             int frameCount = 0;
@@ -56,6 +155,8 @@ namespace basler
                     if (grabResult->GrabSucceeded())
                     {
                         errorCount = 0; // 重置錯誤計數
+                        const quint64 blockId = grabResult->GetBlockID();
+                        trackBlockId(blockId);
 
                         // 根據像素格式決定 Mat 類型
                         int cvType = CV_8UC1;
@@ -65,22 +166,47 @@ namespace basler
                             cvType = CV_8UC3;
                         }
 
-                        cv::Mat frame(
-                            grabResult->GetHeight(),
-                            grabResult->GetWidth(),
-                            cvType,
-                            grabResult->GetBuffer());
+                        const size_t step = grabResult->GetWidth() * CV_ELEM_SIZE(cvType) +
+                                            grabResult->GetPaddingX();
+
+                        // 零拷貝：槽位直接引用 Pylon 緩衝（引用計數持有 grabResult）；
+                        // 否則複製進環形緩衝的預配置槽位（grabResult 會被復用）。信號只傳序號
+                        cv::Mat frame = m_zeroCopy
+                                            ? wrapGrabResult(grabResult, cvType, step)
+                                            : cv::Mat(grabResult->GetHeight(), grabResult->GetWidth(),
+                                                      cvType, grabResult->GetBuffer(), step);
+                        // 無損計數：等檢測讀完再發布，絕不覆寫未處理的幀（期間新幀在 Pylon 緩衝排隊）
+                        if (m_lossless)
+                        {
+                            while (m_running.load() && !m_ring->waitForSpace(100))
+                            {
+                            }
+                            if (!m_running.load())
+                            {
+                                break;
+                            }
+                        }
 
-                        // 深拷貝一份發送（因為 grabResult 會被復用）
                         qint64 timestamp = QDateTime::currentMSecsSinceEpoch();
-                        cv::Mat frameCopy = frame.clone();
-                        emit frameGrabbed(frameCopy, timestamp);
+                        const qint64 timestampUs = FrameRing::steadyTimestampUs();
+                        const quint64 deviceTimestamp = grabResult->GetTimeStamp();
+                        const float exposureUs = m_exposureUs.load(std::memory_order_relaxed);
+                        // AOI 原點取自幀本身（而非目前設定），AOI 重新套用前後的幀都能正確換算
+                        const SensorWindow window{static_cast<int>(grabResult->GetOffsetX()),
+                                                  static_cast<int>(grabResult->GetOffsetY()),
+                                                  m_sensorWidth, m_sensorHeight};
+                        quint64 sequence = m_zeroCopy
+                                               ? m_ring->publishShared(frame, timestampUs, blockId,
+                                                                       deviceTimestamp, exposureUs, window)
+                                               : m_ring->publish(frame, timestampUs, blockId,
+                                                                 deviceTimestamp, exposureUs, window);
+                        emit frameGrabbed(sequence, timestamp);
 
                         frameCount++;
                         if (frameCount == 1 || frameCount % 100 == 0)
                         {
                             qDebug() << "[GrabWorker] 已抓取" << frameCount << "幀, 尺寸:"
-                                     << frameCopy.cols << "x" << frameCopy.rows;
+                                     << frame.cols << "x" << frame.rows;
                         }
                     }
                     else
@@ -108,6 +234,12 @@ namespace basler
 
         m_running.store(false);
 
+        // 停止前歸還 FrameRing 持有的 Pylon 緩衝（最新幀轉存為自有緩衝，畫面不會消失）
+        if (m_zeroCopy)
+        {
+            m_ring->detachSharedFrames();
+        }
+
         // 確保停止相機抓取
         if (m_camera->IsGrabbing())
         {
@@ -118,6 +250,74 @@ namespace basler
         qDebug() << "[GrabWorker] 抓取循環結束";
     }
 
+    void GrabWorker::trackBlockId(quint64 blockId)
+    {
+        // 不支援區塊 ID 的傳輸層回傳 0 或 UINT64_MAX
+        if (blockId == 0 || blockId == std::numeric_limits<quint64>::max())
+        {
+            return;
+        }
+
+        // 區塊 ID 變小視為回繞（GigE Vision 1.x 為 16-bit，65535 之後回到 1）或相機重啟，不計缺口
+        if (m_lastBlockId != 0 && blockId > m_lastBlockId + 1)
+        {
+            emit blockGap(blockId - m_lastBlockId - 1, blockId);
+        }
+        m_lastBlockId = blockId;
+    }
+
+    void GrabWorker::configureBuffers()
+    {
+        const auto &camCfg = Settings::instance().camera();
+        m_lossless = camCfg.losslessCounting;
+        m_zeroCopy = camCfg.zeroCopyGrab;
+
+        // 無損模式需要足夠的排隊緩衝吸收檢測延遲尖峰
+        const int queueBuffers = m_lossless ? std::max(camCfg.grabBufferCount, camCfg.losslessBufferCount)
+                                            : camCfg.grabBufferCount;
+        int bufferCount = std::max(1, queueBuffers);
+
+        if (m_zeroCopy)
+        {
+            // 零拷貝時 FrameRing 每個槽位都持有一個 Pylon 緩衝，另需餘量給延遲釋放與正在接收的幀，
+            // 否則 Pylon 沒有空緩衝可用，抓取會停住
+            const int required = m_ring->capacity() + ZERO_COPY_BUFFER_HEADROOM +
+                                 (m_lossless ? bufferCount : 0);
+            const int maxBuffers = static_cast<int>(
+                std::min<int64_t>(m_camera->MaxNumBuffer.GetMax(), INT_MAX));
+            if (required > maxBuffers)
+            {
+                qWarning() << "[GrabWorker] Pylon 緩衝上限" << maxBuffers << "不足以零拷貝（需要"
+                           << required << "），改用複製模式";
+                m_zeroCopy = false;
+            }
+            else if (bufferCount < required)
+            {
+                qDebug() << "[GrabWorker] 零拷貝模式：MaxNumBuffer" << bufferCount << "→" << required;
+                bufferCount = required;
+            }
+        }
+
+        // 增加接收緩衝區（防止 GigE 緩衝區不足）
+        m_camera->MaxNumBuffer = bufferCount;
+
+        if (!m_zeroCopy)
+        {
+            // 複製模式：依相機目前解析度預先配置所有槽位（configureCamera 固定 Mono8）
+            GenApi::INodeMap &nodemap = m_camera->GetNodeMap();
+            GenApi::CIntegerPtr width(nodemap.GetNode("Width"));
+            GenApi::CIntegerPtr height(nodemap.GetNode("Height"));
+            if (width.IsValid() && height.IsValid())
+            {
+                m_ring->reserve(static_cast<int>(height->GetValue()), static_cast<int>(width->GetValue()), CV_8UC1);
+            }
+        }
+
+        qDebug() << "[GrabWorker] MaxNumBuffer:" << bufferCount
+                 << ", 模式:" << (m_zeroCopy ? "零拷貝" : "複製")
+                 << (m_lossless ? "+ 無損計數" : "");
+    }
+
     void GrabWorker::stopGrabbing()
     {
         qDebug() << "[GrabWorker] 收到停止請求";
@@ -136,6 +336,9 @@ namespace basler
         qRegisterMetaType<CameraInfo>("CameraInfo");
         qRegisterMetaType<cv::Mat>("cv::Mat");
 
+        m_ownedRing = std::make_unique<FrameRing>(Settings::instance().performance().frameRingCapacity);
+        m_frameRing = m_ownedRing.get();
+
         qDebug() << "[CameraController] 初始化完成";
     }
 
@@ -287,13 +490,7 @@ namespace basler
 
             for (size_t i = 0; i < devices.size(); ++i)
             {
-                CameraInfo info;
-                info.index = static_cast<int>(i);
-                info.model = QString::fromStdString(devices[i].GetModelName().c_str());
-                info.serial = QString::fromStdString(devices[i].GetSerialNumber().c_str());
-                info.friendlyName = QString::fromStdString(devices[i].GetFriendlyName().c_str());
-                info.isTargetModel = info.model.contains("acA640-300gm");
-
+                CameraInfo info = cameraInfoFrom(devices[i], static_cast<int>(i));
                 cameras.append(info);
                 qDebug() << "[CameraController] Found camera:" << info.model;
             }
@@ -341,10 +538,73 @@ namespace basler
         return cameras;
     }
 
+    void CameraController::detectCamerasAsync(int maxRetries, int delayMs)
+    {
+        // 列舉（含重試等待）在背景線程執行，結果在主線程以 camerasDetected 送出
+        QThreadPool::globalInstance()->start([this, maxRetries, delayMs]()
+                                             {
+        const QList<CameraInfo> cameras = detectCamerasWithRetry(maxRetries, delayMs);
+        QMetaObject::invokeMethod(this, [this, cameras]() {
+            emit camerasDetected(cameras);
+        }, Qt::QueuedConnection); });
+    }
+
     void CameraController::connectCamera(int cameraIndex)
+    {
+        connectDevice([cameraIndex](Pylon::CTlFactory &factory, CameraInfo &info)
+                      {
+            Pylon::DeviceInfoList_t devices;
+            factory.EnumerateDevices(devices);
+
+            if (cameraIndex >= static_cast<int>(devices.size())) {
+                throw std::runtime_error("相機索引超出範圍");
+            }
+
+            info = cameraInfoFrom(devices[cameraIndex], cameraIndex);
+            return factory.CreateDevice(devices[cameraIndex]); });
+    }
+
+    void CameraController::connectCameraBySerial(const QString &serial, const QString &ipAddress)
+    {
+        connectDevice([serial, ipAddress](Pylon::CTlFactory &factory, CameraInfo &info)
+                      {
+            // 已知 IP 的 GigE 相機：以 IP 直接建立裝置（單播探詢），不做完整的廣播列舉
+            if (!ipAddress.isEmpty()) {
+                try {
+                    Pylon::CDeviceInfo known;
+                    known.SetDeviceClass(Pylon::BaslerGigEDeviceClass);
+                    known.SetIpAddress(ipAddress.toStdString().c_str());
+                    Pylon::IPylonDevice* device = factory.CreateDevice(known);
+                    const CameraInfo found = cameraInfoFrom(device->GetDeviceInfo(), -1);
+                    if (found.serial == serial) {
+                        info = found;
+                        qDebug() << "[CameraController] 以快取 IP 直接連接:" << ipAddress;
+                        return device;
+                    }
+                    qWarning() << "[CameraController]" << ipAddress << "上的相機序號為" << found.serial
+                               << "，與快取的" << serial << "不符，改為完整列舉";
+                    factory.DestroyDevice(device);
+                }
+                catch (const Pylon::GenericException& e) {
+                    qDebug() << "[CameraController] 快取 IP 無法直接連接，改為完整列舉:" << e.GetDescription();
+                }
+            }
+
+            Pylon::DeviceInfoList_t devices;
+            factory.EnumerateDevices(devices);
+            for (size_t i = 0; i < devices.size(); ++i) {
+                if (QString::fromStdString(devices[i].GetSerialNumber().c_str()) == serial) {
+                    info = cameraInfoFrom(devices[i], static_cast<int>(i));
+                    return factory.CreateDevice(devices[i]);
+                }
+            }
+            throw std::runtime_error(QString("找不到序號為 %1 的相機").arg(serial).toStdString()); });
+    }
+
+    void CameraController::connectDevice(const DeviceFactory &createDevice)
     {
         // 使用 QThreadPool::start 在背景線程執行，不阻塞 UI
-        QThreadPool::globalInstance()->start([this, cameraIndex]()
+        QThreadPool::globalInstance()->start([this, createDevice]()
                                              {
         // 使用 QMetaObject::invokeMethod 確保狀態轉換在主線程執行
         bool transitionOk = false;
@@ -361,17 +621,10 @@ namespace basler
 
         try {
             Pylon::CTlFactory& factory = Pylon::CTlFactory::GetInstance();
-            Pylon::DeviceInfoList_t devices;
-            factory.EnumerateDevices(devices);
-
-            if (cameraIndex >= static_cast<int>(devices.size())) {
-                throw std::runtime_error("相機索引超出範圍");
-            }
 
-            // 創建相機實例
-            m_camera = std::make_unique<Pylon::CInstantCamera>(
-                factory.CreateDevice(devices[cameraIndex])
-            );
+            // 創建相機實例（同時取得相機資訊）
+            CameraInfo info{};
+            m_camera = std::make_unique<Pylon::CInstantCamera>(createDevice(factory, info));
 
             // 打開相機
             m_camera->Open();
@@ -379,12 +632,6 @@ namespace basler
             // 配置相機參數
             configureCamera();
 
-            // 準備相機資訊
-            CameraInfo info;
-            info.index = cameraIndex;
-            info.model = QString::fromStdString(devices[cameraIndex].GetModelName().c_str());
-            info.serial = QString::fromStdString(devices[cameraIndex].GetSerialNumber().c_str());
-
             // 使用 QMetaObject::invokeMethod 確保狀態更新和信號發射在主線程
             QMetaObject::invokeMethod(this, [this, info]() {
                 setState(CameraState::Connected);
@@ -475,8 +722,18 @@ namespace basler
 
         // 創建抓取線程
         m_grabThread = std::make_unique<QThread>();
-        m_grabWorker = std::make_unique<GrabWorker>(m_camera.get());
+        m_grabWorker = std::make_unique<GrabWorker>(m_camera.get(), m_frameRing);
+        m_grabWorker->setExposureUs(m_exposureTime);
+        m_grabWorker->setSensorSize(m_sensorWidth, m_sensorHeight);
         m_grabWorker->moveToThread(m_grabThread.get());
+        m_grabThread->setObjectName("GrabThread");
+
+        // 先在抓取線程內套用排程（直接連接，於 startGrabbing 被排入之前執行）；
+        // 多相機管線指定的 grabCore 優先於 SchedulingConfig::grab.affinity
+        const int core = m_grabCore;
+        connect(m_grabThread.get(), &QThread::started, m_grabThread.get(), [core]()
+                { applyThreadScheduling(ThreadRole::Grab, core); },
+                Qt::DirectConnection);
 
         // 連接信號（明確使用 Qt::QueuedConnection 確保跨線程安全）
         connect(m_grabThread.get(), &QThread::started,
@@ -491,9 +748,13 @@ namespace basler
         connect(m_grabWorker.get(), &GrabWorker::grabStopped,
                 this, &CameraController::onGrabStopped,
                 Qt::QueuedConnection);
+        connect(m_grabWorker.get(), &GrabWorker::blockGap,
+                this, &CameraController::onBlockGap,
+                Qt::QueuedConnection);
 
         // 重置統計
         m_totalFrames.store(0);
+        m_missedFrames.store(0);
         m_currentFps.store(0.0);
         {
             QMutexLocker locker(&m_statsMutex);
@@ -536,6 +797,10 @@ namespace basler
         try
         {
             m_exposureTime = exposureUs;
+            if (m_grabWorker)
+            {
+                m_grabWorker->setExposureUs(exposureUs);
+            }
 
             // 確保手動曝光模式
             GenApi::INodeMap &nodemap = m_camera->GetNodeMap();
@@ -560,11 +825,124 @@ namespace basler
         }
     }
 
+    void CameraController::setSensorAoi(const QRect &roi)
+    {
+        m_requestedAoi = roi;
+        if (!m_camera || !m_camera->IsOpen() || m_sensorWidth <= 0)
+        {
+            return; // 尚未連線：呼叫端於 connected() 後重新設定
+        }
+
+        const QRect aoi = targetSensorAoi();
+        if (aoi.isEmpty() || aoi == m_currentAoi)
+        {
+            return;
+        }
+
+        const CameraState current = state();
+        if (current == CameraState::Connected)
+        {
+            applySensorAoi(aoi, false);
+        }
+        else if (current == CameraState::Grabbing)
+        {
+            // 尺寸不變（ROI 只上下 / 左右移動）時多數相機可在抓取中直接移動原點
+            if (aoi.size() == m_currentAoi.size() && applySensorAoi(aoi, true))
+            {
+                return;
+            }
+            // Width / Height 在抓取中鎖定：停止 → onGrabStopped 套用 → 重新開始
+            qDebug() << "[CameraController] 感測器 AOI 尺寸改變，重新啟動抓取";
+            m_aoiRestartPending = true;
+            stopGrabbing();
+        }
+        // 其他過渡狀態：保留要求，抓取停止時（onGrabStopped）套用
+    }
+
+    QRect CameraController::targetSensorAoi() const
+    {
+        const QRect sensor(0, 0, m_sensorWidth, m_sensorHeight);
+        const CameraConfig &camCfg = Settings::instance().camera();
+        if (!camCfg.sensorAoi || m_requestedAoi.isEmpty())
+        {
+            return sensor;
+        }
+
+        const int marginRows = std::max(0, camCfg.sensorAoiMarginRows);
+        const int marginCols = std::max(0, camCfg.sensorAoiMarginCols);
+        GenApi::INodeMap &nodemap = m_camera->GetNodeMap();
+        const auto rows = alignAoiRange(nodemap, "OffsetY", "Height",
+                                        m_requestedAoi.top() - marginRows, m_requestedAoi.bottom() + marginRows,
+                                        m_sensorHeight);
+        const auto cols = camCfg.sensorAoiCropWidth
+                              ? alignAoiRange(nodemap, "OffsetX", "Width",
+                                              m_requestedAoi.left() - marginCols,
+                                              m_requestedAoi.right() + marginCols, m_sensorWidth)
+                              : std::make_pair(0, m_sensorWidth);
+        return QRect(cols.first, rows.first, cols.second, rows.second);
+    }
+
+    bool CameraController::applySensorAoi(const QRect &aoi, bool live)
+    {
+        try
+        {
+            GenApi::INodeMap &nodemap = m_camera->GetNodeMap();
+            GenApi::CIntegerPtr offsetX(nodemap.GetNode("OffsetX"));
+            GenApi::CIntegerPtr offsetY(nodemap.GetNode("OffsetY"));
+            GenApi::CIntegerPtr width(nodemap.GetNode("Width"));
+            GenApi::CIntegerPtr height(nodemap.GetNode("Height"));
+            if (!width.IsValid() || !height.IsValid())
+            {
+                return false;
+            }
+
+            if (live)
+            {
+                // 抓取中只移動原點：尺寸不變，新原點一定在 Offset 上限內
+                if ((offsetX.IsValid() && !GenApi::IsWritable(offsetX)) ||
+                    (offsetY.IsValid() && !GenApi::IsWritable(offsetY)))
+                {
+                    return false;
+                }
+                if (offsetX.IsValid()) offsetX->SetValue(aoi.x());
+                if (offsetY.IsValid()) offsetY->SetValue(aoi.y());
+            }
+            else
+            {
+                // 順序與 configureCamera 相同：Offset 歸零 → 尺寸 → Offset，過程中不超出感測器邊界
+                if (offsetX.IsValid()) offsetX->SetValue(0);
+                if (offsetY.IsValid()) offsetY->SetValue(0);
+                width->SetValue(aoi.width());
+                height->SetValue(aoi.height());
+                if (offsetX.IsValid()) offsetX->SetValue(aoi.x());
+                if (offsetY.IsValid()) offsetY->SetValue(aoi.y());
+            }
+
+            m_currentAoi = QRect(offsetX.IsValid() ? static_cast<int>(offsetX->GetValue()) : 0,
+                                 offsetY.IsValid() ? static_cast<int>(offsetY->GetValue()) : 0,
+                                 static_cast<int>(width->GetValue()), static_cast<int>(height->GetValue()));
+            qDebug() << "[CameraController] 感測器 AOI:" << m_currentAoi << (live ? "（抓取中套用）" : "")
+                     << "感測器:" << m_sensorWidth << "x" << m_sensorHeight;
+            emit sensorAoiChanged(m_currentAoi);
+            return true;
+        }
+        catch (const Pylon::GenericException &e)
+        {
+            qWarning() << "[CameraController] 設置感測器 AOI 失敗:" << e.GetDescription();
+            return false;
+        }
+    }
+
     // ============================================================================
     // 私有槽函數
     // ============================================================================
 
-    void CameraController::onFrameGrabbed(const cv::Mat &frame, qint64 timestamp)
+    void CameraController::setFrameRing(FrameRing *ring)
+    {
+        m_frameRing = ring ? ring : m_ownedRing.get();
+    }
+
+    void CameraController::onFrameGrabbed(quint64 sequence, qint64 timestamp)
     {
         static int grabCount = 0;
         grabCount++;
@@ -599,8 +977,16 @@ namespace basler
             }
         }
 
-        // 發送幀給 UI
-        emit frameReady(frame);
+        // 通知新幀序號（幀數據由消費者自行從 FrameRing 讀取）
+        emit frameReady(sequence);
+    }
+
+    void CameraController::onBlockGap(quint64 missed, quint64 blockId)
+    {
+        const quint64 total = m_missedFrames.fetch_add(missed) + missed;
+        qWarning() << "[CameraController] 區塊 ID 缺口：遺失" << missed << "幀（於 #" << blockId
+                   << "之前），累計:" << total;
+        emit framesMissed(missed, total);
     }
 
     void CameraController::onGrabError(const QString &error)
@@ -623,6 +1009,22 @@ namespace basler
         emit grabbingStopped();
 
         qDebug() << "[CameraController] 抓取已停止";
+
+        // 抓取中無法套用的感測器 AOI（尺寸改變）在此補上；由 setSensorAoi 觸發的停止會重新開始抓取
+        const bool restart = m_aoiRestartPending;
+        m_aoiRestartPending = false;
+        if (m_camera && m_camera->IsOpen() && m_sensorWidth > 0)
+        {
+            const QRect aoi = targetSensorAoi();
+            if (aoi != m_currentAoi)
+            {
+                applySensorAoi(aoi, false);
+            }
+        }
+        if (restart)
+        {
+            startGrabbing();
+        }
     }
 
     // ============================================================================
@@ -651,6 +1053,22 @@ namespace basler
                 if (offsetX.IsValid()) offsetX->SetValue(0);
                 if (offsetY.IsValid()) offsetY->SetValue(0);
 
+                // Binning 會改變 Width/Height 的上限，必須在重置解析度之前設定（1 = 關閉）
+                const char *binningNodes[] = {"BinningHorizontal", "BinningVertical"};
+                for (const char *name : binningNodes)
+                {
+                    GenApi::CIntegerPtr binning(nodemap.GetNode(name));
+                    if (binning.IsValid() && GenApi::IsWritable(binning))
+                    {
+                        const int64_t factor = std::max<int64_t>(1, camCfg.sensorBinning);
+                        binning->SetValue(std::max(binning->GetMin(), std::min(factor, binning->GetMax())));
+                    }
+                    else if (camCfg.sensorBinning > 1)
+                    {
+                        qWarning() << "[CameraController] 相機不支援" << name << "，binning 設定未生效";
+                    }
+                }
+
                 GenApi::CIntegerPtr w(nodemap.GetNode("Width"));
                 GenApi::CIntegerPtr h(nodemap.GetNode("Height"));
                 if (w.IsValid() && h.IsValid())
@@ -659,6 +1077,11 @@ namespace basler
                     h->SetValue(h->GetMax());
                     qDebug() << "[CameraController] 解析度已重置為硬體最大值:"
                              << w->GetValue() << "x" << h->GetValue();
+
+                    // 完整感測器尺寸（AOI 以此為基準；連線後由 setSensorAoi 依檢測 ROI 裁切）
+                    m_sensorWidth = static_cast<int>(w->GetValue());
+                    m_sensorHeight = static_cast<int>(h->GetValue());
+                    m_currentAoi = QRect(0, 0, m_sensorWidth, m_sensorHeight);
                 }
             }
 
@@ -783,6 +1206,8 @@ namespace basler
         qRegisterMetaType<CameraState>("CameraState");
         qRegisterMetaType<CameraInfo>("CameraInfo");
         qRegisterMetaType<cv::Mat>("cv::Mat");
+        m_ownedRing = std::make_unique<FrameRing>(Settings::instance().performance().frameRingCapacity);
+        m_frameRing = m_ownedRing.get();
         qDebug() << "[CameraController] 初始化完成 (NO_PYLON_SDK stub)";
     }
 
@@ -823,6 +1248,16 @@ namespace basler
         return QList<CameraInfo>();
     }
 
+    void CameraController::detectCamerasAsync(int maxRetries, int delayMs)
+    {
+        Q_UNUSED(maxRetries);
+        Q_UNUSED(delayMs);
+        qWarning() << "[CameraController] Pylon SDK not available - no cameras detected (async)";
+        QMetaObject::invokeMethod(this, [this]() {
+            emit camerasDetected(QList<CameraInfo>());
+        }, Qt::QueuedConnection);
+    }
+
     void CameraController::connectCamera(int cameraIndex)
     {
         Q_UNUSED(cameraIndex);
@@ -830,6 +1265,14 @@ namespace basler
         emit connectionError("Pylon SDK not available (NO_PYLON_SDK build)");
     }
 
+    void CameraController::connectCameraBySerial(const QString &serial, const QString &ipAddress)
+    {
+        Q_UNUSED(serial);
+        Q_UNUSED(ipAddress);
+        qWarning() << "[CameraController] Pylon SDK not available - cannot connect";
+        emit connectionError("Pylon SDK not available (NO_PYLON_SDK build)");
+    }
+
     void CameraController::disconnectCamera()
     {
         setState(CameraState::Disconnected);
@@ -853,12 +1296,28 @@ namespace basler
         qWarning() << "[CameraController] Pylon SDK not available - cannot set exposure";
     }
 
-    void CameraController::onFrameGrabbed(const cv::Mat &frame, qint64 timestamp)
+    void CameraController::setSensorAoi(const QRect &roi)
+    {
+        m_requestedAoi = roi;
+    }
+
+    void CameraController::setFrameRing(FrameRing *ring)
     {
-        Q_UNUSED(frame);
+        m_frameRing = ring ? ring : m_ownedRing.get();
+    }
+
+    void CameraController::onFrameGrabbed(quint64 sequence, qint64 timestamp)
+    {
+        Q_UNUSED(sequence);
         Q_UNUSED(timestamp);
     }
 
+    void CameraController::onBlockGap(quint64 missed, quint64 blockId)
+    {
+        Q_UNUSED(missed);
+        Q_UNUSED(blockId);
+    }
+
     void CameraController::onGrabError(const QString &error)
     {
         emit grabError(error);
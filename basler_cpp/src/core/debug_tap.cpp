@@ -0,0 +1,71 @@
+#include "core/debug_tap.h"
+#include <QDebug>
+#include <QMutexLocker>
+#include <algorithm>
+#include <utility>
+
+namespace basler
+{
+
+    namespace
+    {
+        // 引用計數 > 1 代表 UI 還保留這份像素的淺拷貝：放棄重用，讓下一次 copyTo 重新配置。
+        // 計數只可能由外部持有者減少（沒有引用就無法再增加），讀到 1 時重用是安全的
+        void detachShared(cv::Mat &buffer)
+        {
+            if (buffer.u && buffer.u->refcount > 1)
+            {
+                buffer.release();
+            }
+        }
+    }
+
+    void DebugTap::subscribe()
+    {
+        int subscribers = m_subscribers.fetch_add(1) + 1;
+        qDebug() << "[DebugTap] 訂閱中間幀，訂閱數:" << subscribers;
+    }
+
+    void DebugTap::unsubscribe()
+    {
+        int subscribers = m_subscribers.load();
+        while (subscribers > 0 && !m_subscribers.compare_exchange_weak(subscribers, subscribers - 1))
+        {
+        }
+        qDebug() << "[DebugTap] 取消訂閱中間幀，訂閱數:" << std::max(0, subscribers - 1);
+    }
+
+    bool DebugTap::wantsCapture() const
+    {
+        return isActive() && !m_pending.load(std::memory_order_acquire);
+    }
+
+    void DebugTap::beginCapture()
+    {
+        detachShared(m_back.fgMask);
+        detachShared(m_back.cannyEdges);
+        detachShared(m_back.combined);
+        detachShared(m_back.finalMask);
+    }
+
+    void DebugTap::publish()
+    {
+        QMutexLocker locker(&m_swapMutex);
+        std::swap(m_back, m_ready);
+        m_pending.store(true, std::memory_order_release);
+    }
+
+    bool DebugTap::take(DebugFrames &frames)
+    {
+        if (!m_pending.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+
+        QMutexLocker locker(&m_swapMutex);
+        std::swap(frames, m_ready);
+        m_pending.store(false, std::memory_order_release);
+        return true;
+    }
+
+} // namespace basler
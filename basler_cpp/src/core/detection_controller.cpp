@@ -1,17 +1,89 @@
 #include "core/detection_controller.h"
+#include "core/detection_kernels.h"
+#include "core/thread_affinity.h"
 #include "core/yolo_detector.h"
+#include "core/yolo_inference_pool.h"
+#include "core/vibrator_control_loop.h"
 #include "config/settings.h"
 #include <QDebug>
+#include <QElapsedTimer>
+#include <opencv2/core/ocl.hpp>
+#include <opencv2/core/utility.hpp>
 #include <opencv2/imgproc.hpp>
+#include <chrono>
 #include <cmath>
-#include <set>
 #include <algorithm>
 
 namespace basler
 {
 
+    namespace
+    {
+        ClassicalDevice classicalDeviceFromName(const QString &name)
+        {
+            if (name == "opencl")
+            {
+                return ClassicalDevice::OpenCl;
+            }
+            if (name == "auto")
+            {
+                return ClassicalDevice::Auto;
+            }
+            if (name != "cpu")
+            {
+                qWarning() << "[DetectionController] 未知的傳統管線裝置:" << name << "，使用 cpu";
+            }
+            return ClassicalDevice::Cpu;
+        }
+
+        // PerformanceConfig 中檢測每幀使用的項目
+        void loadPerformanceParams(DetectionParams &params, const PerformanceConfig &perf)
+        {
+            params.targetProcessingWidth = perf.targetProcessingWidth;
+            params.stageProfilingIntervalMs = perf.stageProfilingIntervalMs;
+            params.fusedStandardPipeline = perf.fusedStandardPipeline;
+            params.verifyFusedPipeline = perf.verifyFusedPipeline;
+            params.cropBeforeResize = perf.cropBeforeResize;
+            params.classicalDevice = classicalDeviceFromName(perf.classicalDevice);
+            params.runLengthBlobs = perf.runLengthBlobs;
+            params.bgSubtractorBands = perf.bgSubtractorBands;
+        }
+    }
+
+    VibratorSpeed packagingSpeedFor(int count, int target, int advanceStopCount,
+                                    double fullThreshold, double mediumThreshold, double slowThreshold)
+    {
+        // 計算完成度
+        const int effectiveTarget = std::max(1, target - advanceStopCount);
+        const double effectiveProgress = static_cast<double>(count) / effectiveTarget;
+
+        if (effectiveProgress >= slowThreshold)
+        {
+            return VibratorSpeed::CREEP;
+        }
+        if (effectiveProgress >= mediumThreshold)
+        {
+            return VibratorSpeed::SLOW;
+        }
+        if (effectiveProgress >= fullThreshold)
+        {
+            return VibratorSpeed::MEDIUM;
+        }
+        return VibratorSpeed::FULL;
+    }
+
     DetectionController::DetectionController(QObject *parent)
-        : QObject(parent)
+        : DetectionController(nullptr, parent)
+    {
+    }
+
+    DetectionController::DetectionController(YoloInferencePool *sharedYolo, QObject *parent)
+        : DetectionController(sharedYolo, false, parent)
+    {
+    }
+
+    DetectionController::DetectionController(YoloInferencePool *sharedYolo, bool isLane, QObject *parent)
+        : QObject(parent), m_yoloPool(sharedYolo), m_isLane(isLane)
     {
         // 從配置載入參數
         const auto &config = Settings::instance();
@@ -19,86 +91,138 @@ namespace basler
         const auto &gate = config.gate();
         const auto &pkg = config.packaging();
 
+        // 可調參數（之後由 setter 發布新快照）
+        DetectionParams params;
         // 檢測參數
-        m_minArea = det.minArea;
-        m_maxArea = det.maxArea;
-        m_minAspectRatio = det.minAspectRatio;
-        m_maxAspectRatio = det.maxAspectRatio;
-        m_minExtent = det.minExtent;
-        m_maxSolidity = det.maxSolidity;
-        m_bgHistory = det.bgHistory;
-        m_bgVarThreshold = det.bgVarThreshold;
-        m_detectShadows = det.detectShadows;
-        m_bgLearningRate = det.bgLearningRate;
-        m_connectivity = det.connectivity;
+        params.minArea = det.minArea;
+        params.maxArea = det.maxArea;
+        params.minAspectRatio = det.minAspectRatio;
+        params.maxAspectRatio = det.maxAspectRatio;
+        params.minExtent = det.minExtent;
+        params.maxSolidity = det.maxSolidity;
+        params.bgHistory = det.bgHistory;
+        params.bgVarThreshold = det.bgVarThreshold;
+        params.detectShadows = det.detectShadows;
+        params.bgLearningRate = det.bgLearningRate;
+        params.bgEngine = backgroundEngineFromName(det.bgModel.toStdString());
+        params.connectivity = det.connectivity;
 
         // 邊緣檢測參數
-        m_gaussianBlurKernelSize = det.gaussianBlurKernelSize;
-        m_cannyLowThreshold = det.cannyLowThreshold;
-        m_cannyHighThreshold = det.cannyHighThreshold;
-        m_binaryThreshold = det.binaryThreshold;
+        params.gaussianBlurKernelSize = det.gaussianBlurKernelSize;
+        params.cannyLowThreshold = det.cannyLowThreshold;
+        params.cannyHighThreshold = det.cannyHighThreshold;
+        params.binaryThreshold = det.binaryThreshold;
 
         // 形態學參數
-        m_dilateKernelSize = det.dilateKernelSize;
-        m_dilateIterations = det.dilateIterations;
-        m_closeKernelSize = det.closeKernelSize;
-        m_openingKernelSize = det.openingKernelSize;
-        m_openingIterations = det.openingIterations;
+        params.dilateKernelSize = det.dilateKernelSize;
+        params.dilateIterations = det.dilateIterations;
+        params.closeKernelSize = det.closeKernelSize;
+        params.openingKernelSize = det.openingKernelSize;
+        params.openingIterations = det.openingIterations;
 
         // ROI 參數
-        m_roiEnabled = det.roiEnabled;
-        m_roiX = det.roiX;
-        m_roiWidth = det.roiWidth;
-        m_roiHeight = det.roiHeight;
-        m_roiPositionRatio = det.roiPositionRatio;
+        params.roiEnabled = det.roiEnabled;
+        params.roiX = det.roiX;
+        params.roiWidth = det.roiWidth;
+        params.roiHeight = det.roiHeight;
+        params.roiPositionRatio = det.roiPositionRatio;
 
         // 高速模式參數
-        m_ultraHighSpeedMode = det.ultraHighSpeedMode;
-        m_targetFps = det.targetFps;
-        m_highSpeedBgHistory = det.highSpeedBgHistory;
-        m_highSpeedBgVarThreshold = det.highSpeedBgVarThreshold;
-        m_highSpeedMinArea = det.highSpeedMinArea;
-        m_highSpeedMaxArea = det.highSpeedMaxArea;
+        params.ultraHighSpeedMode = det.ultraHighSpeedMode;
+        params.targetFps = det.targetFps;
+        params.highSpeedBgHistory = det.highSpeedBgHistory;
+        params.highSpeedBgVarThreshold = det.highSpeedBgVarThreshold;
+        params.highSpeedBgEngine = backgroundEngineFromName(det.highSpeedBgModel.toStdString());
+        params.highSpeedMinArea = det.highSpeedMinArea;
+        params.highSpeedMaxArea = det.highSpeedMaxArea;
 
         // 虛擬光柵參數
-        m_enableGateCounting = gate.enableGateCounting;
-        m_gateLinePositionRatio = gate.gateLinePositionRatio;
-        m_gateTriggerRadius = gate.gateTriggerRadius;
-        m_gateHistoryFrames = gate.gateHistoryFrames;
+        params.enableGateCounting = gate.enableGateCounting;
+        params.gateLinePositionRatio = gate.gateLinePositionRatio;
+        params.gateTriggerRadius = gate.gateTriggerRadius;
+        params.gateHistoryFrames = gate.gateHistoryFrames;
+        params.optimalAssignment = gate.optimalAssignment;
+        params.assignmentBudgetMs = gate.assignmentBudgetMs;
+
+        // 每幀使用的效能配置
+        loadPerformanceParams(params, config.performance());
+
+        m_publishedParams.update([&params](DetectionParams &next)
+                                 { next = params; });
+        m_params = params;
+        m_paramsVersion = m_publishedParams.version();
+        m_gateTriggers.configure(GATE_TRIGGER_CAPACITY, m_params.gateTriggerRadius);
 
         // 包裝控制參數
-        m_targetCount = pkg.targetCount;
+        m_targetCount.store(pkg.targetCount, std::memory_order_relaxed);
         m_advanceStopCount = pkg.advanceStopCount;
-        m_speedFullThreshold = pkg.speedFullThreshold;
-        m_speedMediumThreshold = pkg.speedMediumThreshold;
-        m_speedSlowThreshold = pkg.speedSlowThreshold;
+        m_speedFullThreshold.store(pkg.speedFullThreshold, std::memory_order_relaxed);
+        m_speedMediumThreshold.store(pkg.speedMediumThreshold, std::memory_order_relaxed);
+        m_speedSlowThreshold.store(pkg.speedSlowThreshold, std::memory_order_relaxed);
+        m_predictiveSpeed = (pkg.speedControlMode == "predictive");
+        m_flowSettleMs = pkg.flowSettleMs;
+        m_actuationLatencyMs = pkg.actuationLatencyMs;
+        m_flowSafetyFactor = pkg.flowSafetyFactor;
+        m_flowEstimator.configure(pkg.flowRateAlpha, pkg.flowSettleMs, pkg.flowMinSamples);
+
+        // 追蹤暫存預留容量（穩態每幀不配置記憶體）
+        m_trackMatches.reserve(256);
+        m_objectUsed.reserve(256);
+        m_yoloTracks.reserve(128);
 
         // 初始化背景減除器
         resetBackgroundSubtractor();
 
-        // 初始化 YOLO 偵測器
-        m_yoloDetector = std::make_unique<YoloDetector>();
+        // 初始化 YOLO 偵測器（使用共用推理池時由推理池持有模型；料道只做傳統檢測，都不建立）
         const auto &yoloCfg = config.yolo();
-        m_yoloDetector->setConfidenceThreshold(yoloCfg.confidenceThreshold);
-        m_yoloDetector->setNmsThreshold(yoloCfg.nmsThreshold);
-        m_yoloDetector->setRoiUpscaleFactor(yoloCfg.roiUpscaleFactor);
-        m_yoloDetector->setInputSize(yoloCfg.inputSize);
-
-        // 自動載入模型（如果配置中有路徑）
-        if (!yoloCfg.modelPath.isEmpty())
+        if (!m_yoloPool && !m_isLane)
         {
-            m_yoloDetector->loadModel(yoloCfg.modelPath.toStdString());
+            m_yoloDetector = std::make_unique<YoloDetector>();
+            m_yoloDetector->setConfidenceThreshold(yoloCfg.confidenceThreshold);
+            m_yoloDetector->setNmsThreshold(yoloCfg.nmsThreshold);
+            m_yoloDetector->setRoiUpscaleFactor(yoloCfg.roiUpscaleFactor);
+            m_yoloDetector->setInputSize(yoloCfg.inputSize);
+            m_yoloDetector->setBackend(yoloCfg.backend.toStdString(), yoloCfg.device.toStdString());
+            m_yoloDetector->setTiling(yoloCfg.tiledInference, yoloCfg.tileOverlap);
         }
+        m_yoloAsync = yoloCfg.asyncInference && !m_yoloPool;
+        m_yoloBatchSize = yoloCfg.batchSize;
+
+        qRegisterMetaType<StageLatencySnapshot>("basler::StageLatencySnapshot");
+        m_profiler.setEnabled(config.performance().stageProfiling && !m_isLane); // 料道的階段由父控制器量測
+
+        // 模型不在建構時載入（啟動不等待 ONNX 載入）：由 loadConfiguredYoloModel() 依偵測模式延遲載入
 
         // 設定偵測模式
+        if (m_isLane)
+        {
+            m_detectionMode = DetectionMode::Classical;
+            return;
+        }
         m_detectionMode = yoloCfg.enabled ? DetectionMode::YOLO : DetectionMode::Auto;
 
         qDebug() << "[DetectionController] 初始化完成 - 雙模式偵測（傳統 + YOLO）";
-        qDebug() << "[DetectionController] 配置: minArea=" << m_minArea
-                 << ", maxArea=" << m_maxArea
-                 << ", bgVarThreshold=" << m_bgVarThreshold;
-        qDebug() << "[DetectionController] YOLO 模型:" << (m_yoloDetector->isModelLoaded() ? "已載入" : "未載入")
-                 << ", 偵測模式:" << static_cast<int>(m_detectionMode);
+        qDebug() << "[DetectionController] 配置: minArea=" << m_params.minArea
+                 << ", maxArea=" << m_params.maxArea
+                 << ", bgVarThreshold=" << m_params.bgVarThreshold;
+        if (m_yoloDetector)
+        {
+            qDebug() << "[DetectionController] YOLO 模型:" << (m_yoloDetector->isModelLoaded() ? "已載入" : "未載入")
+                     << ", 後端:" << QString::fromStdString(m_yoloDetector->backendName())
+                     << ", 精度:" << QString::fromStdString(m_yoloDetector->modelPrecision())
+                     << ", 偵測模式:" << static_cast<int>(m_detectionMode);
+        }
+        else
+        {
+            qDebug() << "[DetectionController] YOLO 使用共用推理池（" << m_yoloPool->size() << "個實例），模型:"
+                     << (m_yoloPool->isModelLoaded() ? "已載入" : "未載入")
+                     << ", 偵測模式:" << static_cast<int>(m_detectionMode);
+        }
+
+        // 多料道跟隨目前零件配置
+        applyPartLanes(config.currentPartId());
+        connect(&Settings::instance(), &AppConfig::partChanged, this, &DetectionController::applyPartLanes);
+        connect(&Settings::instance(), &AppConfig::configChanged, this, &DetectionController::reloadPerformanceParams);
     }
 
     DetectionController::~DetectionController()
@@ -106,235 +230,780 @@ namespace basler
         // 清理資源 - 確保所有容器被清空
         {
             QMutexLocker locker(&m_mutex);
-            m_objectTracks.clear();
-            m_lostTracks.clear();
+            m_tracks.clear();
             m_yoloTracks.clear();
-            m_countedObjectsHistory.clear();
-            m_triggeredPositions.clear();
+            m_countedHistory.clear();
+            m_gateTriggers.clear();
         }
 
-        // YOLO 偵測器由 unique_ptr 自動清理
+        // 等待背景模型載入結束，再由 unique_ptr 清理 YOLO 偵測器（解構時停止推理線程）
+        if (m_yoloLoadThread.joinable())
+        {
+            m_yoloLoadThread.join();
+        }
         m_yoloDetector.reset();
 
-        // 背景減除器由 cv::Ptr 自動清理
+        // 釋放各帶背景模型
         m_bgSubtractor.release();
 
-        qDebug() << "[DetectionController] 資源已清理";
+        m_laneControllers.clear();
+
+        if (!m_isLane)
+        {
+            qDebug() << "[DetectionController] 資源已清理";
+        }
     }
 
     void DetectionController::resetBackgroundSubtractor()
     {
-        int history = m_ultraHighSpeedMode ? m_highSpeedBgHistory : m_bgHistory;
-        int varThreshold = m_ultraHighSpeedMode ? m_highSpeedBgVarThreshold : m_bgVarThreshold;
+        const int history = m_params.effectiveBgHistory();
+        const int varThreshold = m_params.effectiveBgVarThreshold();
+        const BackgroundEngine engine = m_params.effectiveBgEngine();
+        const int bands = m_params.bgSubtractorBands;
 
-        m_bgSubtractor = cv::createBackgroundSubtractorMOG2(
-            history, varThreshold, m_detectShadows);
-        m_currentLearningRate = m_bgLearningRate;
+        m_bgSubtractor.reset(engine, history, varThreshold, m_params.detectShadows, bands);
+        if (m_regionVerifyActive)
+        {
+            // 驗證用的第二份背景模型與主模型同步重建，兩者才能逐幀比對
+            m_verifyBgSubtractor.reset(engine, history, varThreshold, m_params.detectShadows, bands);
+        }
+        m_currentLearningRate = m_params.bgLearningRate;
 
-        qDebug() << "[DetectionController] 背景減除器已重置: history=" << history
-                 << ", varThreshold=" << varThreshold;
+        qDebug() << "[DetectionController] 背景減除器已重置:" << backgroundEngineName(engine)
+                 << ", history=" << history << ", varThreshold=" << varThreshold << ", bands=" << bands;
+    }
+
+    void DetectionController::refreshParams()
+    {
+        // 版本號未變（絕大多數幀）時只有一次原子讀取
+        const uint64_t version = m_publishedParams.version();
+        if (version == m_paramsVersion)
+        {
+            return;
+        }
+        const std::shared_ptr<const DetectionParams> next = m_publishedParams.load();
+        m_paramsVersion = version;
+
+        const bool rebuildBackground = next->backgroundDiffers(m_params);
+        const bool learningRateChanged = next->bgLearningRate != m_params.bgLearningRate;
+        const bool gateRadiusChanged = next->gateTriggerRadius != m_params.gateTriggerRadius;
+        m_params = *next;
+        m_fusedStages = nullptr; // 啟用階段可能改變，下一次融合管線重新選擇特化
+
+        // 需要重建的狀態在檢測線程處理，UI 線程的 setter 不必等待當前幀
+        if (rebuildBackground)
+        {
+            resetBackgroundSubtractor();
+        }
+        else if (learningRateChanged)
+        {
+            m_currentLearningRate = m_params.bgLearningRate;
+        }
+        if (gateRadiusChanged)
+        {
+            m_gateTriggers.configure(GATE_TRIGGER_CAPACITY, m_params.gateTriggerRadius); // 格子尺寸跟隨半徑
+        }
+    }
+
+    void DetectionController::selectClassicalDevice()
+    {
+        // 在檢測線程選擇（第一幀或設定變更時）：OpenCL 佇列屬於呼叫線程，之後的裝置運算都在此線程排入
+        const ClassicalDevice requested = m_params.classicalDevice;
+        m_selectedDevice = requested;
+        m_deviceSelected = true;
+        m_deviceActive = false;
+        m_deviceBuffers = DeviceBuffers(); // 釋放裝置記憶體
+        if (requested == ClassicalDevice::Cpu)
+        {
+            return;
+        }
+
+        if (!cv::ocl::haveOpenCL())
+        {
+            qWarning() << "[DetectionController] 找不到 OpenCL 執行環境，傳統管線使用 CPU";
+            return;
+        }
+        cv::ocl::setUseOpenCL(true);
+        const cv::ocl::Device &device = cv::ocl::Device::getDefault();
+        if (!cv::ocl::useOpenCL() || !device.available())
+        {
+            qWarning() << "[DetectionController] 沒有可用的 OpenCL 裝置，傳統管線使用 CPU";
+            return;
+        }
+        if (requested == ClassicalDevice::Auto && (device.type() & cv::ocl::Device::TYPE_GPU) == 0)
+        {
+            // auto 不使用 CPU 型 OpenCL 裝置：與主機端管線搶同一組核心，只多了上傳 / 下載
+            qDebug() << "[DetectionController] 預設 OpenCL 裝置不是 GPU:"
+                     << QString::fromStdString(device.name()) << "，傳統管線使用 CPU";
+            return;
+        }
+
+        m_deviceActive = true;
+        qDebug() << "[DetectionController] 傳統管線使用 OpenCL 裝置:" << QString::fromStdString(device.name());
+    }
+
+    void DetectionController::reloadPerformanceParams()
+    {
+        const PerformanceConfig perf = Settings::instance().performance();
+        publishParams([&perf](DetectionParams &params)
+                      { loadPerformanceParams(params, perf); });
+        forEachLane([](DetectionController &lane)
+                    { lane.reloadPerformanceParams(); });
     }
 
     cv::Mat DetectionController::processFrame(const cv::Mat &frame, std::vector<DetectedObject> &detectedObjects)
+    {
+        FrameOverlay overlay;
+        cv::Mat annotated;
+        processFrame(frame, detectedObjects, overlay, &annotated);
+        return annotated.empty() ? frame : annotated;
+    }
+
+    bool DetectionController::processFrame(const cv::Mat &frame, std::vector<DetectedObject> &detectedObjects,
+                                           FrameOverlay &overlay, cv::Mat *annotated, const SensorWindow &window)
     {
         detectedObjects.clear();
+        overlay = FrameOverlay();
 
         if (frame.empty() || !m_enabled)
         {
-            return frame;
+            return false;
         }
 
-        // 只在讀取配置時短暫鎖定
-        bool roiEnabled;
-        int roiX;
-        int roiWidth;
-        int roiHeight;
-        double roiPositionRatio;
-        bool ultraHighSpeedMode;
-        bool enableGateCounting;
+        // 整幀處理期間持有管線鎖（背景模型、追蹤與計數狀態只在此鎖內變動）
+        QMutexLocker pipelineLocker(&m_pipelineMutex);
+        refreshParams(); // 本幀使用的參數（整幀不變）
+        const QualityLevel quality = qualityLevel();
+
+        // 延遲統計窗口到期時發出（在本幀計時之前，窗口不含本幀）
+        if (m_profiler.isEnabled() && m_profiler.windowElapsedMs() >= m_params.stageProfilingIntervalMs)
         {
-            QMutexLocker locker(&m_mutex);
-            roiEnabled = m_roiEnabled;
-            roiX = m_roiX;
-            roiWidth = m_roiWidth;
-            roiHeight = m_roiHeight;
-            roiPositionRatio = m_roiPositionRatio;
-            ultraHighSpeedMode = m_ultraHighSpeedMode;
-            enableGateCounting = m_enableGateCounting;
-            m_totalProcessedFrames++;
+            emit stageLatencyUpdated(m_profiler.collect());
         }
+        ScopedStageTimer totalTimer(m_profiler, PipelineStage::Total);
 
         try
         {
             const int origW = frame.cols;
-            const int origH = frame.rows;
+            // 相機端 AOI 裁切時以完整感測器寬度為基準，ROI 參數的意義不隨 AOI 改變
+            const int baseW = window.isValid() ? window.sensorWidth : origW;
 
-            // ========== 解析度縮放 ==========
+            // ========== 解析度縮放比例 ==========
             // 根據 targetProcessingWidth 計算縮放比例，使處理影像寬度恆為目標值。
             // 目的：讓檢測參數（minArea / roiHeight 等）在任何相機解析度下都有一致的物理意義。
-            int targetW = Settings::instance().performance().targetProcessingWidth;
-            double scale = (targetW > 0 && origW > targetW)
-                               ? static_cast<double>(targetW) / origW
-                               : 1.0;
+            // 這裡只決定比例：ROI 仍在縮放座標計算，實際只縮放 ROI 條帶（processScaled）。
+            double scale = 1.0;
+            {
+                int targetW = m_params.targetProcessingWidth;
+                if (quality >= QualityLevel::ReducedWidth)
+                {
+                    // 降級：處理寬度減半（相機寬度小於目標寬度時以相機寬度為基準）
+                    targetW = std::max(1, (targetW > 0 ? std::min(targetW, baseW) : baseW) / 2);
+                }
+                scale = (targetW > 0 && baseW > targetW)
+                            ? static_cast<double>(targetW) / baseW
+                            : 1.0;
+            }
 
-            cv::Mat workFrame; // 實際用於檢測的縮放幀
-            if (scale < 1.0)
+            const bool multiLane = !m_laneControllers.empty();
+            if (multiLane)
             {
-                int scaledW = static_cast<int>(origW * scale);
-                int scaledH = static_cast<int>(origH * scale);
-                cv::resize(frame, workFrame, cv::Size(scaledW, scaledH), 0, 0, cv::INTER_LINEAR);
+                if (!processLanes(frame, scale, window, quality, detectedObjects))
+                {
+                    return false;
+                }
             }
             else
             {
-                workFrame = frame; // 不需要縮放（相機解析度已 ≤ 目標寬度）
+                processScaled(frame, scale, window, quality, detectedObjects);
             }
 
-            const int frameWidth  = workFrame.cols;
-            const int frameHeight = workFrame.rows;
-            int currentRoiX = 0;
-            int currentRoiY = 0;
-            int currentRoiW = frameWidth;
-            int currentRoiHeight = frameHeight;
+            // 繪製結果（降級時略過，呼叫端顯示原始幀）
+            if (quality >= QualityLevel::NoOverlay)
+            {
+                return true;
+            }
+            ScopedStageTimer drawTimer(m_profiler, PipelineStage::Draw);
+            overlay = multiLane ? buildLaneOverlay() : buildOverlay(detectedObjects);
 
-            // ROI 區域提取（在縮放幀上操作）
-            cv::Mat processRegion;
-            if (roiEnabled)
+            // 只有呼叫端明確要求時才複製整幀並燒入
+            if (annotated)
             {
-                // X 方向：roiX + roiWidth（0 = 全幀寬度）
-                currentRoiX = std::max(0, std::min(roiX, frameWidth - 1));
-                currentRoiW = (roiWidth > 0)
-                    ? std::min(roiWidth, frameWidth - currentRoiX)
-                    : (frameWidth - currentRoiX);
+                frame.copyTo(*annotated);
+                burnInOverlay(*annotated, overlay);
+            }
+            return true;
+        }
+        catch (const std::exception &e)
+        {
+            qWarning() << "[DetectionController] 檢測失敗:" << e.what();
+            return false;
+        }
+    }
 
-                // Y 方向：依比例定位
-                currentRoiY = static_cast<int>(frameHeight * roiPositionRatio);
-                currentRoiHeight = std::min(roiHeight, frameHeight - currentRoiY);
+    void DetectionController::processScaled(const cv::Mat &frame, double scale, const SensorWindow &window,
+                                            QualityLevel quality, std::vector<DetectedObject> &detectedObjects)
+    {
+        // 參數讀本幀工作副本（processFrame 開始時 refreshParams 已取用最新快照），不需加鎖
+        const bool roiEnabled = m_params.roiEnabled;
+        const int roiX = m_params.roiX;
+        const int roiWidth = m_params.roiWidth;
+        const int roiHeight = m_params.roiHeight;
+        const double roiPositionRatio = m_params.roiPositionRatio;
+        const bool ultraHighSpeedMode = m_params.ultraHighSpeedMode;
+        const bool enableGateCounting = m_params.enableGateCounting;
+        const int totalFrames = ++m_totalProcessedFrames;
+
+        // AOI 原點改變（ROI 編輯後相機重新套用 AOI）：幀座標整體平移，舊的光柵觸發點與軌跡不再對應
+        if (window != m_frameWindow)
+        {
+            m_frameWindow = window;
+            m_gateTriggers.clear();
+            m_yoloTracks.clear();
+        }
 
-                if (currentRoiHeight > 0 && currentRoiY < frameHeight && currentRoiW > 0)
-                {
-                    processRegion = workFrame(cv::Rect(currentRoiX, currentRoiY,
-                                                       currentRoiW, currentRoiHeight));
-                }
-                else
-                {
-                    processRegion = workFrame;
-                    currentRoiX = 0;
-                    currentRoiY = 0;
-                    currentRoiW = frameWidth;
-                    currentRoiHeight = frameHeight;
-                }
+        StageStopwatch stopwatch(m_profiler);
+        const int origW = frame.cols;
+        const int origH = frame.rows;
+        // 縮放幀尺寸（與整幀 cv::resize 相同的取整）；ROI 在此座標計算，實際只縮放 ROI 條帶
+        const cv::Size scaledSize = scale < 1.0
+            ? cv::Size(static_cast<int>(origW * scale), static_cast<int>(origH * scale))
+            : frame.size();
+        const int frameWidth  = scaledSize.width;
+        const int frameHeight = scaledSize.height;
+        int currentRoiX = 0;
+        int currentRoiY = 0;
+        int currentRoiW = frameWidth;
+        int currentRoiHeight = frameHeight;
+        int roiAnchorY = 0; // ROI 未裁切前的頂端（光柵線以此定位，AOI 過渡幀裁掉頂端時不跟著移動）
+
+        // ROI 區域（縮放幀座標）
+        if (roiEnabled)
+        {
+            // ROI 參數以完整感測器（縮放後）為基準；相機端 AOI 裁切時扣掉 AOI 原點換算到本幀
+            const int windowX = window.isValid() ? static_cast<int>(window.offsetX * scale) : 0;
+            const int windowY = window.isValid() ? static_cast<int>(window.offsetY * scale) : 0;
+            const int sensorHeight = window.isValid() ? static_cast<int>(window.sensorHeight * scale) : frameHeight;
+
+            // X 方向：roiX + roiWidth（0 = 全幀寬度）
+            const int roiLeft = roiX - windowX;
+            currentRoiX = std::max(0, std::min(roiLeft, frameWidth - 1));
+            currentRoiW = (roiWidth > 0)
+                ? std::min(roiWidth - (currentRoiX - roiLeft), frameWidth - currentRoiX)
+                : (frameWidth - currentRoiX);
+
+            // Y 方向：依比例定位（AOI 未涵蓋 ROI 頂端時裁到幀內，例如 AOI 重新套用的過渡幀）
+            const int roiTop = static_cast<int>(sensorHeight * roiPositionRatio) - windowY;
+            currentRoiY = std::max(0, roiTop);
+            currentRoiHeight = std::min(roiHeight - (currentRoiY - roiTop), frameHeight - currentRoiY);
+            roiAnchorY = roiTop;
+
+            if (currentRoiHeight <= 0 || currentRoiY >= frameHeight || currentRoiW <= 0)
+            {
+                // ROI 無效：處理整幀
+                currentRoiX = 0;
+                currentRoiY = 0;
+                roiAnchorY = 0;
+                currentRoiW = frameWidth;
+                currentRoiHeight = frameHeight;
+            }
+        }
+
+        // 光柵線位置（座標在原始解析度空間）
+        // roiHeight 是處理解析度下的像素值，需除以 scale 換算回原始空間
+        const int roiYOrig = static_cast<int>(currentRoiY / scale);
+        const int gateLineY = roiEnabled
+            ? static_cast<int>(roiAnchorY / scale) + static_cast<int>((scale > 0.0 ? roiHeight / scale : roiHeight) * m_params.gateLinePositionRatio)
+            : static_cast<int>(origH * 0.5);
+
+        // 更新共享變量（存原始解析度座標，供 buildOverlay 使用）；每幀只取一次鎖
+        {
+            QMutexLocker locker(&m_mutex);
+            m_frameHeight = origH;
+            m_frameWidth  = origW;
+            m_processingScale = scale;
+            // ROI 座標映射回原始解析度
+            m_currentRoiX      = static_cast<int>(currentRoiX / scale);
+            m_currentRoiY      = roiYOrig;
+            m_currentRoiWidth  = static_cast<int>(currentRoiW / scale);
+            m_currentRoiHeight = static_cast<int>(currentRoiHeight / scale);
+            m_gateLineY = gateLineY;
+        }
+        stopwatch.lap(PipelineStage::RoiExtract);
+
+        // 先裁切再縮放：只縮放 ROI 條帶，取樣網格與整幀縮放後裁切相同（參數語意不變）
+        // 條帶外保留濾波半徑的邊界，處理區域仍是子矩陣，濾波看到的鄰域與整幀縮放時相同
+        const cv::Rect roiRect(currentRoiX, currentRoiY, currentRoiW, currentRoiHeight);
+        cv::Mat processRegion;
+        if (m_params.cropBeforeResize)
+        {
+            resizeRegion(frame, scaledSize, roiRect, filterMargin(), m_regionBuffer, processRegion);
+        }
+        else
+        {
+            // 參考路徑：整幀縮放後裁切
+            if (scaledSize != frame.size())
+            {
+                cv::resize(frame, m_regionBuffer, scaledSize, 0, 0, cv::INTER_LINEAR);
+                processRegion = m_regionBuffer(roiRect);
             }
             else
             {
-                processRegion = workFrame;
+                processRegion = frame(roiRect);
             }
+        }
+        stopwatch.lap(PipelineStage::Resize);
 
-            // 更新共享變量（存原始解析度座標，供 drawDetectionResults 使用）
+        // 驗證先裁切再縮放：以整幀縮放後裁切的參考條帶重跑一次，比對最終遮罩與物件清單
+        // （參考條帶有自己的背景模型；開始驗證時兩份模型一起重建）
+        const bool verifyRegion = m_params.cropBeforeResize && m_params.verifyFusedPipeline &&
+                                  scaledSize != frame.size() && !m_deviceActive;
+        if (verifyRegion != m_regionVerifyActive)
+        {
+            m_regionVerifyActive = verifyRegion;
+            if (verifyRegion)
+            {
+                resetBackgroundSubtractor();
+            }
+            else
             {
-                QMutexLocker locker(&m_mutex);
-                m_frameHeight = origH;
-                m_frameWidth  = origW;
-                m_processingScale = scale;
-                // ROI 座標映射回原始解析度
-                m_currentRoiX      = static_cast<int>(currentRoiX / scale);
-                m_currentRoiY      = static_cast<int>(currentRoiY / scale);
-                m_currentRoiWidth  = static_cast<int>(currentRoiW / scale);
-                m_currentRoiHeight = static_cast<int>(currentRoiHeight / scale);
+                m_verifyBgSubtractor.release();
             }
+        }
 
-            // 根據偵測模式執行不同的處理流程
-            bool useYolo = shouldUseYolo();
+        // 根據偵測模式執行不同的處理流程
+        bool useYolo = shouldUseYolo();
 
-            if (useYolo)
+        if (useYolo)
+        {
+            // YOLO 模式：直接用深度學習偵測物件（輸入像素相同即結果相同）
+            if (verifyRegion)
             {
-                // YOLO 模式：直接用深度學習偵測物件
-                detectedObjects = yoloProcessing(processRegion, currentRoiY);
+                verifyRegionPixels(frame, scaledSize, roiRect, processRegion);
+            }
+            ScopedStageTimer yoloTimer(m_profiler, PipelineStage::YoloInference);
+            detectedObjects = m_yoloAsync ? yoloProcessingAsync(processRegion, currentRoiY)
+                                          : yoloProcessing(processRegion, currentRoiY);
+        }
+        else
+        {
+            // 傳統模式：背景減除 + 連通組件分析
+            const bool highSpeed = ultraHighSpeedMode || quality >= QualityLevel::HighSpeedProcessing;
+
+            // 面積門檻以 targetProcessingWidth 下的像素為準；品質調節降低處理寬度時依縮放比的平方換算
+            const int baseW = window.isValid() ? window.sensorWidth : origW;
+            const int targetW = m_params.targetProcessingWidth;
+            const double nominalScale = (targetW > 0 && baseW > targetW) ? static_cast<double>(targetW) / baseW : 1.0;
+            m_areaScale = scale < nominalScale ? (scale / nominalScale) * (scale / nominalScale) : 1.0;
+
+            cv::Mat processed;
+            if (highSpeed)
+            {
+                processed = ultraHighSpeedProcessing(processRegion);
             }
             else
             {
-                // 傳統模式：背景減除 + 連通組件分析
-                cv::Mat processed;
-                if (ultraHighSpeedMode)
-                {
-                    processed = ultraHighSpeedProcessing(processRegion);
-                }
-                else
-                {
-                    processed = standardProcessing(processRegion);
-                }
-                detectedObjects = detectObjects(processed);
+                processed = standardProcessing(processRegion);
+            }
+            {
+                ScopedStageTimer blobTimer(m_profiler, PipelineStage::BlobExtraction);
+                detectedObjects = detectObjects(processed, highSpeed);
+            }
+            // 本幀才切到裝置管線時（第一次選擇裝置）模型已不同步，由下一幀停用驗證
+            if (verifyRegion && !m_deviceActive)
+            {
+                verifyRegionResult(frame, scaledSize, roiRect, highSpeed, processed, detectedObjects);
             }
+        }
 
-            // 始終計算光柵線位置（座標在原始解析度空間）
-            // m_roiHeight 是處理解析度下的像素值，需除以 processingScale 換算回原始空間
-            int gateLineY = 0;
+        // 診斷報告（每 500 幀）
+        if (totalFrames % 500 == 0)
+        {
+            qDebug() << "========================================";
+            qDebug() << "[DetectionController] 診斷報告 - 幀" << totalFrames;
+            qDebug() << "檢測物件數:" << detectedObjects.size()
+                     << ", 光柵線Y=" << gateLineY
+                     << ", 計數:" << m_crossingCounter.load(std::memory_order_relaxed);
+            qDebug() << "========================================";
+        }
+
+        // 虛擬光柵計數（根據模式選擇不同的計數邏輯）
+        if (useYolo && m_yoloAsync)
+        {
+            // 非同步：本幀交付的每筆結果依原始幀順序各計數一次
+            if (enableGateCounting)
             {
-                QMutexLocker locker(&m_mutex);
-                if (m_roiEnabled)
-                {
-                    double roiHeightOrig = (m_processingScale > 0.0)
-                                              ? m_roiHeight / m_processingScale
-                                              : m_roiHeight;
-                    gateLineY = m_currentRoiY + static_cast<int>(roiHeightOrig * m_gateLinePositionRatio);
-                }
-                else
+                ScopedStageTimer countingTimer(m_profiler, PipelineStage::GateCounting);
+                for (const auto &result : m_yoloResults)
                 {
-                    gateLineY = static_cast<int>(m_frameHeight * 0.5);
+                    if (!result.objects.empty())
+                    {
+                        yoloBasedCounting(result.objects);
+                    }
                 }
-                m_gateLineY = gateLineY;
             }
+        }
+        else if (enableGateCounting && !detectedObjects.empty())
+        {
+            if (useYolo)
+            {
+                ScopedStageTimer countingTimer(m_profiler, PipelineStage::GateCounting);
+                yoloBasedCounting(detectedObjects);
+            }
+            else
+            {
+                virtualGateCounting(detectedObjects);
+            }
+        }
+    }
 
-            // 診斷報告（每 500 幀）
-            int totalFrames;
+    // ===== 多料道 =====
+
+    void DetectionController::setLanes(const std::vector<LaneConfig> &lanes)
+    {
+        QMutexLocker pipelineLocker(&m_pipelineMutex);
+        if (lanes.empty() && m_laneControllers.empty())
+        {
+            return;
+        }
+
+        m_laneControllers.clear();
+        m_laneTargetOverride.clear();
+        m_laneGateOverride.clear();
+        for (size_t i = 0; i < lanes.size(); ++i)
+        {
+            const LaneConfig &config = lanes[i];
+            const int index = static_cast<int>(i);
+
+            std::unique_ptr<DetectionController> lane(new DetectionController(nullptr, true, nullptr));
+            copyParametersTo(*lane);
+            lane->m_laneIndex = index;
+            lane->m_controlLoop.store(m_controlLoop.load());
+            lane->publishParams([&config](DetectionParams &params)
+                                {
+                                    params.roiEnabled = true;
+                                    params.roiX = config.roiX;
+                                    params.roiWidth = config.roiWidth;
+                                    if (config.gateLinePositionRatio >= 0.0)
+                                    {
+                                        params.gateLinePositionRatio = config.gateLinePositionRatio;
+                                    }
+                                });
+            lane->refreshParams(); // 尚未開始處理，直接取用（需要時重建背景模型與光柵索引）
+            if (config.targetCount > 0)
             {
-                QMutexLocker locker(&m_mutex);
-                totalFrames = m_totalProcessedFrames;
+                lane->m_targetCount.store(config.targetCount, std::memory_order_relaxed);
             }
-            if (totalFrames % 500 == 0)
+
+            // 料道在檢測線程（parallel_for_ 工作線程）發出，直接轉發
+            connect(lane.get(), &DetectionController::countChanged, this, [this, index](int count)
+                    { emit laneCountChanged(index, count); }, Qt::DirectConnection);
+            connect(lane.get(), &DetectionController::vibratorSpeedChanged, this, [this, index](VibratorSpeed speed)
+                    { emit laneVibratorSpeedChanged(index, speed); }, Qt::DirectConnection);
+            connect(lane.get(), &DetectionController::packagingCompleted, this, [this, index]()
+                    { emit lanePackagingCompleted(index); }, Qt::DirectConnection);
+
+            m_laneControllers.push_back(std::move(lane));
+            m_laneTargetOverride.push_back(std::max(0, config.targetCount));
+            m_laneGateOverride.push_back(config.gateLinePositionRatio);
+        }
+        m_laneObjects.assign(m_laneControllers.size(), std::vector<DetectedObject>());
+
+        // 料道配置改變後計數重新開始
+        {
+            QMutexLocker locker(&m_mutex);
+            m_crossingCounter.store(0, std::memory_order_relaxed);
+            m_packagingCompleted.store(false, std::memory_order_relaxed);
+            m_defectPassCount = 0;
+            m_defectFailCount = 0;
+        }
+        emit countChanged(0);
+
+        qDebug() << "[DetectionController] 料道數:" << m_laneControllers.size();
+        for (size_t i = 0; i < lanes.size(); ++i)
+        {
+            qDebug() << "[DetectionController]   料道" << i << lanes[i].name
+                     << ": roiX=" << lanes[i].roiX << ", roiWidth=" << lanes[i].roiWidth
+                     << ", 目標=" << m_laneControllers[i]->m_targetCount.load(std::memory_order_relaxed);
+        }
+    }
+
+    void DetectionController::applyPartLanes(const QString &partId)
+    {
+        const PartProfile *profile = Settings::instance().getPartProfile(partId);
+        setLanes(profile ? profile->lanes : std::vector<LaneConfig>());
+    }
+
+    void DetectionController::copyParametersTo(DetectionController &lane) const
+    {
+        // 檢測、ROI 垂直方向、高速模式與光柵參數：沿用目前發布的整份快照（ROI 水平方向由料道覆寫）
+        const std::shared_ptr<const DetectionParams> params = m_publishedParams.load();
+        lane.publishParams([&params](DetectionParams &next)
+                           { next = *params; });
+
+        // 包裝控制參數
+        lane.m_packagingEnabled.store(m_packagingEnabled.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        lane.m_targetCount.store(m_targetCount.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        lane.m_advanceStopCount = m_advanceStopCount;
+        lane.m_speedFullThreshold.store(m_speedFullThreshold.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        lane.m_speedMediumThreshold.store(m_speedMediumThreshold.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        lane.m_speedSlowThreshold.store(m_speedSlowThreshold.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        lane.m_predictiveSpeed = m_predictiveSpeed;
+        lane.m_flowSettleMs = m_flowSettleMs;
+        lane.m_actuationLatencyMs = m_actuationLatencyMs;
+        lane.m_flowSafetyFactor = m_flowSafetyFactor;
+    }
+
+    void DetectionController::processLane(const cv::Mat &frame, double scale, const SensorWindow &window,
+                                          QualityLevel quality, std::vector<DetectedObject> &detectedObjects)
+    {
+        QMutexLocker pipelineLocker(&m_pipelineMutex);
+        refreshParams();
+        detectedObjects.clear();
+        processScaled(frame, scale, window, quality, detectedObjects);
+    }
+
+    bool DetectionController::processLanes(const cv::Mat &frame, double scale, const SensorWindow &window,
+                                           QualityLevel quality, std::vector<DetectedObject> &detectedObjects)
+    {
+        {
+            QMutexLocker locker(&m_mutex);
+            m_frameWidth = frame.cols;
+            m_frameHeight = frame.rows;
+            m_processingScale = scale;
+            m_totalProcessedFrames++;
+        }
+
+        // 各料道只讀原始幀、各自縮放自己的 ROI 條帶並寫自己的狀態，彼此獨立
+        const int laneCount = static_cast<int>(m_laneControllers.size());
+        std::atomic<bool> failed{false};
+        cv::parallel_for_(cv::Range(0, laneCount), [&](const cv::Range &range)
+                          {
+                              for (int i = range.start; i < range.end; ++i)
+                              {
+                                  try
+                                  {
+                                      m_laneControllers[i]->processLane(frame, scale, window, quality,
+                                                                        m_laneObjects[i]);
+                                  }
+                                  catch (const std::exception &e)
+                                  {
+                                      qWarning() << "[DetectionController] 料道" << i << "檢測失敗:" << e.what();
+                                      m_laneObjects[i].clear();
+                                      failed = true;
+                                  }
+                              }
+                          });
+
+        // 合併結果（座標已在原始解析度空間）
+        size_t objectTotal = 0;
+        for (const auto &objects : m_laneObjects)
+        {
+            objectTotal += objects.size();
+        }
+        detectedObjects.reserve(objectTotal);
+        for (const auto &objects : m_laneObjects)
+        {
+            detectedObjects.insert(detectedObjects.end(), objects.begin(), objects.end());
+        }
+
+        int total = 0;
+        int passCount = 0;
+        int failCount = 0;
+        bool allCompleted = m_packagingEnabled.load(std::memory_order_relaxed);
+        for (const auto &lane : m_laneControllers)
+        {
+            total += lane->m_crossingCounter.load(std::memory_order_relaxed);
+            passCount += lane->m_defectPassCount;
+            failCount += lane->m_defectFailCount;
+            allCompleted = allCompleted && lane->m_packagingCompleted.load(std::memory_order_relaxed);
+        }
+
+        int previous;
+        bool defectChanged;
+        bool completedNow;
+        {
+            QMutexLocker locker(&m_mutex);
+            previous = m_crossingCounter.exchange(total, std::memory_order_relaxed);
+            defectChanged = passCount != m_defectPassCount || failCount != m_defectFailCount;
+            m_defectPassCount = passCount;
+            m_defectFailCount = failCount;
+            completedNow = allCompleted && !m_packagingCompleted.load(std::memory_order_relaxed);
+            if (completedNow)
             {
-                QMutexLocker locker(&m_mutex);
-                qDebug() << "========================================";
-                qDebug() << "[DetectionController] 診斷報告 - 幀" << totalFrames;
-                qDebug() << "檢測物件數:" << detectedObjects.size()
-                         << ", 光柵線Y=" << m_gateLineY
-                         << ", 計數:" << m_crossingCounter;
-                qDebug() << "========================================";
+                m_packagingCompleted.store(true, std::memory_order_relaxed);
+                m_currentSpeed.store(VibratorSpeed::STOP, std::memory_order_relaxed);
             }
+        }
 
-            // 虛擬光柵計數（根據模式選擇不同的計數邏輯）
-            if (enableGateCounting && !detectedObjects.empty())
+        if (total != previous)
+        {
+            emit countChanged(total);
+            if (total > previous)
             {
-                if (useYolo)
+                emit objectsCrossedGate(total);
+            }
+        }
+        if (defectChanged)
+        {
+            const int inspected = passCount + failCount;
+            const double passRate = (inspected > 0) ? (static_cast<double>(passCount) / inspected * 100.0) : 100.0;
+            emit defectStatsUpdated(passRate, passCount, failCount);
+        }
+        if (completedNow)
+        {
+            emit vibratorSpeedChanged(VibratorSpeed::STOP);
+            emit packagingCompleted();
+            qDebug() << "[DetectionController] 全部料道包裝完成！合計" << total;
+        }
+
+        return !failed;
+    }
+
+    FrameOverlay DetectionController::buildLaneOverlay() const
+    {
+        FrameOverlay overlay;
+        overlay.frameWidth = m_frameWidth;
+        overlay.lanes.reserve(m_laneControllers.size());
+
+        for (size_t i = 0; i < m_laneControllers.size(); ++i)
+        {
+            const DetectionController &lane = *m_laneControllers[i];
+            FrameOverlay laneOverlay = lane.buildOverlay(m_laneObjects[i]);
+
+            FrameOverlay::Lane entry;
+            entry.roi = laneOverlay.roi;
+            entry.gateLineY = laneOverlay.showGateLine ? laneOverlay.gateLineY : -1;
+            entry.counted = laneOverlay.counted;
+            entry.targetCount = lane.m_packagingEnabled.load(std::memory_order_relaxed) ? lane.m_targetCount.load(std::memory_order_relaxed) : 0;
+            overlay.lanes.push_back(entry);
+
+            overlay.boxes.insert(overlay.boxes.end(), laneOverlay.boxes.begin(), laneOverlay.boxes.end());
+            overlay.detections += laneOverlay.detections;
+        }
+
+        overlay.mode = QStringLiteral("Classical");
+        overlay.counted = m_crossingCounter.load(std::memory_order_relaxed);
+        return overlay;
+    }
+
+    int DetectionController::laneCount(int lane) const
+    {
+        if (lane < 0 || lane >= laneTotal())
+        {
+            return 0;
+        }
+        return m_laneControllers[lane]->count();
+    }
+
+    PackagingStatus DetectionController::lanePackagingStatus(int lane) const
+    {
+        if (lane < 0 || lane >= laneTotal())
+        {
+            return PackagingStatus();
+        }
+        return m_laneControllers[lane]->getPackagingStatus();
+    }
+
+    QRect DetectionController::sensorRoi(int sensorWidth, int sensorHeight) const
+    {
+        if (m_laneControllers.empty())
+        {
+            return sensorRoiOf(*m_publishedParams.load(), sensorWidth, sensorHeight);
+        }
+        QRect united;
+        for (const auto &lane : m_laneControllers)
+        {
+            united |= sensorRoiOf(*lane->m_publishedParams.load(), sensorWidth, sensorHeight);
+        }
+        return united;
+    }
+
+    QRect DetectionController::sensorRoiOf(const DetectionParams &params, int sensorWidth, int sensorHeight)
+    {
+        const QRect sensor(0, 0, sensorWidth, sensorHeight);
+        if (!params.roiEnabled || sensorWidth <= 0 || sensorHeight <= 0)
+        {
+            return sensor;
+        }
+
+        // 與 processFrame 相同的縮放比例（品質降級的寬度減半不計入，降級時 ROI 裁在 AOI 內）
+        const int targetW = params.targetProcessingWidth;
+        const double scale = (targetW > 0 && sensorWidth > targetW)
+                                 ? static_cast<double>(targetW) / sensorWidth
+                                 : 1.0;
+        const int x = static_cast<int>(params.roiX / scale);
+        const int width = params.roiWidth > 0 ? static_cast<int>(std::ceil(params.roiWidth / scale))
+                                              : sensorWidth - x;
+        const int y = static_cast<int>(static_cast<int>(sensorHeight * scale * params.roiPositionRatio) / scale);
+        const int height = static_cast<int>(std::ceil(params.roiHeight / scale));
+        return QRect(x, y, width, height).intersected(sensor);
+    }
+
+    cv::Mat DetectionController::standardProcessing(const cv::Mat &processRegion)
+    {
+        // 調試中間幀只在有訂閱者、且 UI 已取走上一份時擷取（頻率跟隨顯示）
+        m_captureDebug = qualityLevel() < QualityLevel::NoDebugTaps && m_debugTap.wantsCapture();
+        if (m_captureDebug)
+        {
+            m_debugTap.beginCapture();
+        }
+
+        if (!m_deviceSelected || m_selectedDevice != m_params.classicalDevice)
+        {
+            selectClassicalDevice();
+        }
+
+        cv::Mat result;
+        if (!m_deviceActive || !standardStagesDevice(processRegion, result))
+        {
+            // 1. 背景減除獲得前景遮罩（有狀態，每幀只做一次，兩種實作共用同一遮罩）
+            cv::Mat &fgMask = m_stdBuffers.fgMask;
+            {
+                ScopedStageTimer bgTimer(m_profiler, PipelineStage::BackgroundSubtract);
+                m_bgSubtractor.apply(processRegion, fgMask, m_currentLearningRate);
+            }
+
+            if (!m_params.fusedStandardPipeline)
+            {
+                result = standardStagesReference(processRegion, fgMask);
+            }
+            else
+            {
+                const bool color = processRegion.channels() == 3;
+                if (!m_fusedStages || color != m_fusedStagesColor)
+                {
+                    m_fusedStages = selectFusedStages(color);
+                    m_fusedStagesColor = color;
+                }
+                if (m_params.verifyFusedPipeline)
                 {
-                    yoloBasedCounting(detectedObjects);
+                    cv::Mat reference = standardStagesReference(processRegion, fgMask);
+                    result = (this->*m_fusedStages)(processRegion, fgMask);
+                    verifyFusedStages(result, reference);
                 }
                 else
                 {
-                    virtualGateCounting(detectedObjects);
+                    result = (this->*m_fusedStages)(processRegion, fgMask);
                 }
             }
-
-            // 繪製結果
-            cv::Mat resultFrame = drawDetectionResults(frame.clone(), detectedObjects);
-
-            return resultFrame;
         }
-        catch (const std::exception &e)
+
+        if (m_captureDebug)
         {
-            qWarning() << "[DetectionController] 檢測失敗:" << e.what();
-            return frame;
+            m_debugTap.backBuffer().frameNumber = m_totalProcessedFrames;
+            m_debugTap.publish();
+            m_captureDebug = false;
         }
+        return result;
     }
 
-    cv::Mat DetectionController::standardProcessing(const cv::Mat &processRegion)
+    cv::Mat DetectionController::standardStagesReference(const cv::Mat &processRegion, const cv::Mat &fgMask)
     {
-        // 1. 背景減除獲得前景遮罩
-        cv::Mat fgMask;
-        m_bgSubtractor->apply(processRegion, fgMask, m_currentLearningRate);
-
+        // 原始逐步實作：保留為參考路徑（fusedStandardPipeline = false 或 verifyFusedPipeline 比對用）
         // 2. 高斯模糊減少噪聲（使用配置參數，預設 1x1 等同跳過，保留小零件細節）
         cv::Mat blurred;
-        int blurSize = m_gaussianBlurKernelSize | 1; // 確保為奇數
+        int blurSize = m_params.gaussianBlurKernelSize | 1; // 確保為奇數
         cv::GaussianBlur(processRegion, blurred, cv::Size(blurSize, blurSize), 0);
 
         // 3. 增強前景遮罩濾波
@@ -356,15 +1025,17 @@ namespace basler
         cv::Mat fgCleaned;
         cv::morphologyEx(fgStep2, fgCleaned, cv::MORPH_OPEN, finalKernel, cv::Point(-1, -1), 1);
 
-        // 儲存前景遮罩中間幀（步驟 3 完成後）
-        m_lastFgMask = fgCleaned.clone();
+        // 擷取前景遮罩中間幀（步驟 3 完成後，只在調試視圖訂閱時）
+        if (m_captureDebug)
+            fgCleaned.copyTo(m_debugTap.backBuffer().fgMask);
 
         // 4. Canny 邊緣檢測 - 使用敏感邊緣（Python: canny_low//2, canny_high//2）
         cv::Mat sensitiveEdges;
-        cv::Canny(blurred, sensitiveEdges, m_cannyLowThreshold / 2, m_cannyHighThreshold / 2);
+        cv::Canny(blurred, sensitiveEdges, m_params.cannyLowThreshold / 2, m_params.cannyHighThreshold / 2);
 
-        // 儲存 Canny 邊緣中間幀
-        m_lastCannyEdges = sensitiveEdges.clone();
+        // 擷取 Canny 邊緣中間幀
+        if (m_captureDebug)
+            sensitiveEdges.copyTo(m_debugTap.backBuffer().cannyEdges);
 
         // 5. 自適應閾值檢測
         cv::Mat grayRoi;
@@ -397,106 +1068,473 @@ namespace basler
         cv::Mat combined;
         cv::bitwise_or(tempCombined, adaptiveThreshClean, combined);
 
-        // 儲存三重聯合結果中間幀
-        m_lastCombined = combined.clone();
+        // 擷取三重聯合結果中間幀
+        if (m_captureDebug)
+            combined.copyTo(m_debugTap.backBuffer().combined);
 
         // 8. 後聯合形態學處理（參考 Python basler_mvc，預設跳過，可由 UI 調整啟用）
         cv::Mat postProcessed = combined;
 
         // 開運算（如果 kernel > 1 且 iterations > 0）
-        if (m_openingKernelSize > 1 && m_openingIterations > 0)
+        if (m_params.openingKernelSize > 1 && m_params.openingIterations > 0)
         {
             cv::Mat openKernel = cv::getStructuringElement(
-                cv::MORPH_ELLIPSE, cv::Size(m_openingKernelSize, m_openingKernelSize));
+                cv::MORPH_ELLIPSE, cv::Size(m_params.openingKernelSize, m_params.openingKernelSize));
             cv::morphologyEx(postProcessed, postProcessed, cv::MORPH_OPEN,
-                             openKernel, cv::Point(-1, -1), m_openingIterations);
+                             openKernel, cv::Point(-1, -1), m_params.openingIterations);
         }
 
         // 膨脹（如果 kernel > 1 且 iterations > 0）
-        if (m_dilateKernelSize > 1 && m_dilateIterations > 0)
+        if (m_params.dilateKernelSize > 1 && m_params.dilateIterations > 0)
         {
-            cv::Mat dilateKernel = cv::Mat::ones(m_dilateKernelSize, m_dilateKernelSize, CV_8U);
+            cv::Mat dilateKernel = cv::Mat::ones(m_params.dilateKernelSize, m_params.dilateKernelSize, CV_8U);
             cv::dilate(postProcessed, postProcessed, dilateKernel,
-                       cv::Point(-1, -1), m_dilateIterations);
+                       cv::Point(-1, -1), m_params.dilateIterations);
         }
 
         // 閉合（如果 kernel > 1）
-        if (m_closeKernelSize > 1)
+        if (m_params.closeKernelSize > 1)
         {
             cv::Mat closeK = cv::getStructuringElement(
-                cv::MORPH_ELLIPSE, cv::Size(m_closeKernelSize, m_closeKernelSize));
+                cv::MORPH_ELLIPSE, cv::Size(m_params.closeKernelSize, m_params.closeKernelSize));
             cv::morphologyEx(postProcessed, postProcessed, cv::MORPH_CLOSE, closeK);
         }
 
-        // 儲存最終二值化遮罩供調試視圖使用（無需加鎖，processFrame 在主線程）
-        m_lastDebugFrame = postProcessed.clone();
+        // 擷取最終二值化遮罩供調試視圖使用（back 槽只由檢測線程存取，無需加鎖）
+        if (m_captureDebug)
+            postProcessed.copyTo(m_debugTap.backBuffer().finalMask);
+
+        return postProcessed;
+    }
+
+    template <bool Color, unsigned Stages>
+    cv::Mat DetectionController::standardStagesFused(const cv::Mat &processRegion, const cv::Mat &fgMask)
+    {
+        // 與 standardStagesReference 逐位元一致；差異只在緩衝重用、結構元素快取、逐像素步驟融合，
+        // 以及未啟用階段（Stages）與像素格式分支（Color）在編譯期移除
+        StandardBuffers &buf = m_stdBuffers;
+        MorphKernels &k = m_morphKernels;
+
+        // 2. 模糊輸入。未啟用（1x1 等同複製）時，ROI 子矩陣仍需複製到獨立緩衝，
+        //    因為 Canny 對子矩陣會讀取 ROI 外的像素當邊界；已是獨立矩陣時直接使用
+        StageStopwatch stopwatch(m_profiler);
+        const cv::Mat *cannyInput = &processRegion;
+        if constexpr ((Stages & FUSED_STAGE_BLUR) != 0)
+        {
+            const int blurSize = m_params.gaussianBlurKernelSize | 1; // 確保為奇數
+            cv::GaussianBlur(processRegion, buf.blurred, cv::Size(blurSize, blurSize), 0);
+            cannyInput = &buf.blurred;
+        }
+        else if (processRegion.isSubmatrix())
+        {
+            processRegion.copyTo(buf.blurred);
+            cannyInput = &buf.blurred;
+        }
+        stopwatch.lap(PipelineStage::Blur);
+
+        // 3. 增強前景遮罩濾波（中值 + 開 / 閉 / 開）
+        cv::medianBlur(fgMask, buf.fgMedian, 5);
+        stopwatch.lap(PipelineStage::MedianFilter);
+        cv::morphologyEx(buf.fgMedian, buf.fgStep1, cv::MORPH_OPEN,
+                         cachedKernel(k.ellipse5, cv::MORPH_ELLIPSE, 5), cv::Point(-1, -1), 1);
+        stopwatch.lap(PipelineStage::MorphOpen);
+        cv::morphologyEx(buf.fgStep1, buf.fgStep2, cv::MORPH_CLOSE,
+                         cachedKernel(k.ellipse7, cv::MORPH_ELLIPSE, 7), cv::Point(-1, -1), 1);
+        stopwatch.lap(PipelineStage::MorphClose);
+        cv::morphologyEx(buf.fgStep2, buf.fgCleaned, cv::MORPH_OPEN,
+                         cachedKernel(k.ellipse3, cv::MORPH_ELLIPSE, 3), cv::Point(-1, -1), 1);
+        stopwatch.lap(PipelineStage::MorphRefine);
+        if (m_captureDebug)
+        {
+            buf.fgCleaned.copyTo(m_debugTap.backBuffer().fgMask);
+            stopwatch.restart();
+        }
+
+        // 4. Canny 敏感邊緣
+        cv::Canny(*cannyInput, buf.edges, m_params.cannyLowThreshold / 2, m_params.cannyHighThreshold / 2);
+        stopwatch.lap(PipelineStage::Canny);
+        if (m_captureDebug)
+        {
+            buf.edges.copyTo(m_debugTap.backBuffer().cannyEdges);
+            stopwatch.restart();
+        }
+
+        // 5. 自適應閾值（Mono8 直接使用 ROI，BGR8 先轉灰階）
+        const cv::Mat *grayRoi = &processRegion;
+        if constexpr (Color)
+        {
+            cv::cvtColor(processRegion, buf.gray, cv::COLOR_BGR2GRAY);
+            grayRoi = &buf.gray;
+        }
+        cv::adaptiveThreshold(*grayRoi, buf.adaptive, 255,
+                              cv::ADAPTIVE_THRESH_GAUSSIAN_C, cv::THRESH_BINARY, 11, 2);
+        stopwatch.lap(PipelineStage::AdaptiveThreshold);
+
+        // 6 + 7. 遮罩 AND、兩次 threshold、兩次 OR 融合為單次 SIMD 掃描
+        fuseTripleMask(buf.fgCleaned, buf.edges, buf.adaptive, buf.combined);
+        stopwatch.lap(PipelineStage::MaskFusion);
+        if (m_captureDebug)
+        {
+            buf.combined.copyTo(m_debugTap.backBuffer().combined);
+            stopwatch.restart();
+        }
+
+        // 8. 後聯合形態學處理（預設全部未啟用，整段在編譯期移除）
+        cv::Mat postProcessed = buf.combined;
+        if constexpr ((Stages & FUSED_STAGE_OPEN) != 0)
+        {
+            cv::morphologyEx(postProcessed, postProcessed, cv::MORPH_OPEN,
+                             cachedKernel(k.opening, cv::MORPH_ELLIPSE, m_params.openingKernelSize),
+                             cv::Point(-1, -1), m_params.openingIterations);
+        }
+        if constexpr ((Stages & FUSED_STAGE_DILATE) != 0)
+        {
+            cv::dilate(postProcessed, postProcessed,
+                       cachedKernel(k.dilate, cv::MORPH_RECT, m_params.dilateKernelSize),
+                       cv::Point(-1, -1), m_params.dilateIterations);
+        }
+        if constexpr ((Stages & FUSED_STAGE_CLOSE) != 0)
+        {
+            cv::morphologyEx(postProcessed, postProcessed, cv::MORPH_CLOSE,
+                             cachedKernel(k.close, cv::MORPH_ELLIPSE, m_params.closeKernelSize));
+        }
+        if constexpr ((Stages & (FUSED_STAGE_OPEN | FUSED_STAGE_DILATE | FUSED_STAGE_CLOSE)) != 0)
+        {
+            stopwatch.lap(PipelineStage::PostMorphology);
+        }
 
+        if (m_captureDebug)
+            postProcessed.copyTo(m_debugTap.backBuffer().finalMask);
         return postProcessed;
     }
 
+    template <std::size_t... Index>
+    std::array<DetectionController::FusedStagesFn, sizeof...(Index)>
+    DetectionController::fusedStagesTable(std::index_sequence<Index...>)
+    {
+        // 索引 = Color × FUSED_STAGE_COMBINATIONS + Stages
+        return {{&DetectionController::standardStagesFused<(Index >= FUSED_STAGE_COMBINATIONS),
+                                                           static_cast<unsigned>(Index % FUSED_STAGE_COMBINATIONS)>...}};
+    }
+
+    DetectionController::FusedStagesFn DetectionController::selectFusedStages(bool color) const
+    {
+        static const auto table = fusedStagesTable(std::make_index_sequence<2 * FUSED_STAGE_COMBINATIONS>());
+
+        unsigned stages = 0;
+        if ((m_params.gaussianBlurKernelSize | 1) > 1)
+        {
+            stages |= FUSED_STAGE_BLUR;
+        }
+        if (m_params.openingKernelSize > 1 && m_params.openingIterations > 0)
+        {
+            stages |= FUSED_STAGE_OPEN;
+        }
+        if (m_params.dilateKernelSize > 1 && m_params.dilateIterations > 0)
+        {
+            stages |= FUSED_STAGE_DILATE;
+        }
+        if (m_params.closeKernelSize > 1)
+        {
+            stages |= FUSED_STAGE_CLOSE;
+        }
+        return table[(color ? FUSED_STAGE_COMBINATIONS : 0u) + stages];
+    }
+
+    bool DetectionController::standardStagesDevice(const cv::Mat &processRegion, cv::Mat &result)
+    {
+        // 與 standardStagesFused 相同的階段順序與參數，但全程使用 cv::UMat（OpenCL T-API）：
+        // ROI 上傳一次，中間結果留在裝置上，只下載最終遮罩（與訂閱中的調試中間幀）。
+        // OpenCL 運算非同步排入佇列，各階段計時大多只含排入時間，實際執行時間落在最終下載（DeviceTransfer）
+        DeviceBuffers &dev = m_deviceBuffers;
+        MorphKernels &k = m_morphKernels;
+        try
+        {
+            StageStopwatch stopwatch(m_profiler);
+            // 上傳為獨立矩陣：Canny 不會讀到 ROI 外的像素（等同融合管線的 blurred 複製）；
+            // 上傳時間計入背景減除，DeviceTransfer 每幀只記錄下載一個樣本
+            processRegion.copyTo(dev.region);
+
+            // 1. 背景減除（MOG2 模型保存在裝置上）
+            m_bgSubtractor.apply(dev.region, dev.fgMask, m_currentLearningRate);
+            stopwatch.lap(PipelineStage::BackgroundSubtract);
+
+            // 2. 模糊輸入（1x1 等同跳過，直接使用上傳的 ROI）
+            const int blurSize = m_params.gaussianBlurKernelSize | 1; // 確保為奇數
+            const cv::UMat *blurred = &dev.region;
+            if (blurSize > 1)
+            {
+                cv::GaussianBlur(dev.region, dev.blurred, cv::Size(blurSize, blurSize), 0);
+                blurred = &dev.blurred;
+            }
+            stopwatch.lap(PipelineStage::Blur);
+
+            // 3. 增強前景遮罩濾波（中值 + 開 / 閉 / 開）
+            cv::medianBlur(dev.fgMask, dev.fgMedian, 5);
+            stopwatch.lap(PipelineStage::MedianFilter);
+            cv::morphologyEx(dev.fgMedian, dev.fgStep1, cv::MORPH_OPEN,
+                             cachedKernel(k.ellipse5, cv::MORPH_ELLIPSE, 5), cv::Point(-1, -1), 1);
+            stopwatch.lap(PipelineStage::MorphOpen);
+            cv::morphologyEx(dev.fgStep1, dev.fgStep2, cv::MORPH_CLOSE,
+                             cachedKernel(k.ellipse7, cv::MORPH_ELLIPSE, 7), cv::Point(-1, -1), 1);
+            stopwatch.lap(PipelineStage::MorphClose);
+            cv::morphologyEx(dev.fgStep2, dev.fgCleaned, cv::MORPH_OPEN,
+                             cachedKernel(k.ellipse3, cv::MORPH_ELLIPSE, 3), cv::Point(-1, -1), 1);
+            stopwatch.lap(PipelineStage::MorphRefine);
+            if (m_captureDebug)
+            {
+                dev.fgCleaned.copyTo(m_debugTap.backBuffer().fgMask);
+                stopwatch.restart();
+            }
+
+            // 4. Canny 敏感邊緣
+            cv::Canny(*blurred, dev.edges, m_params.cannyLowThreshold / 2, m_params.cannyHighThreshold / 2);
+            stopwatch.lap(PipelineStage::Canny);
+            if (m_captureDebug)
+            {
+                dev.edges.copyTo(m_debugTap.backBuffer().cannyEdges);
+                stopwatch.restart();
+            }
+
+            // 5. 自適應閾值
+            const cv::UMat *gray = &dev.region;
+            if (dev.region.channels() == 3)
+            {
+                cv::cvtColor(dev.region, dev.gray, cv::COLOR_BGR2GRAY);
+                gray = &dev.gray;
+            }
+            cv::adaptiveThreshold(*gray, dev.adaptive, 255,
+                                  cv::ADAPTIVE_THRESH_GAUSSIAN_C, cv::THRESH_BINARY, 11, 2);
+            stopwatch.lap(PipelineStage::AdaptiveThreshold);
+
+            // 6 + 7. 三重聯合：fg | ((edges | adaptive) & (fg != 0))（邊緣 / 閾值輸出只有 0 / 255，
+            //        與參考管線的遮罩 AND + threshold + OR 等價）
+            dev.edgeOrAdaptive.create(dev.fgCleaned.size(), CV_8UC1);
+            dev.edgeOrAdaptive.setTo(cv::Scalar::all(0));
+            cv::bitwise_or(dev.edges, dev.adaptive, dev.edgeOrAdaptive, dev.fgCleaned);
+            cv::bitwise_or(dev.fgCleaned, dev.edgeOrAdaptive, dev.combined);
+            stopwatch.lap(PipelineStage::MaskFusion);
+            if (m_captureDebug)
+            {
+                dev.combined.copyTo(m_debugTap.backBuffer().combined);
+                stopwatch.restart();
+            }
+
+            // 8. 後聯合形態學處理（預設跳過）
+            if (m_params.openingKernelSize > 1 && m_params.openingIterations > 0)
+            {
+                cv::morphologyEx(dev.combined, dev.combined, cv::MORPH_OPEN,
+                                 cachedKernel(k.opening, cv::MORPH_ELLIPSE, m_params.openingKernelSize),
+                                 cv::Point(-1, -1), m_params.openingIterations);
+            }
+            if (m_params.dilateKernelSize > 1 && m_params.dilateIterations > 0)
+            {
+                cv::dilate(dev.combined, dev.combined,
+                           cachedKernel(k.dilate, cv::MORPH_RECT, m_params.dilateKernelSize),
+                           cv::Point(-1, -1), m_params.dilateIterations);
+            }
+            if (m_params.closeKernelSize > 1)
+            {
+                cv::morphologyEx(dev.combined, dev.combined, cv::MORPH_CLOSE,
+                                 cachedKernel(k.close, cv::MORPH_ELLIPSE, m_params.closeKernelSize));
+            }
+            stopwatch.lap(PipelineStage::PostMorphology);
+
+            // 只下載最終遮罩（同步點：等待佇列中的所有運算完成）
+            dev.combined.copyTo(m_stdBuffers.postProcessed);
+            result = m_stdBuffers.postProcessed;
+            stopwatch.lap(PipelineStage::DeviceTransfer);
+
+            if (m_captureDebug)
+                result.copyTo(m_debugTap.backBuffer().finalMask);
+
+            if (m_params.verifyFusedPipeline)
+            {
+                // 以同一份前景遮罩執行主機端參考管線比對（背景模型只在裝置上更新一次）
+                dev.fgMask.copyTo(m_stdBuffers.fgMask);
+                verifyFusedStages(result, standardStagesReference(processRegion, m_stdBuffers.fgMask));
+            }
+            return true;
+        }
+        catch (const cv::Exception &e)
+        {
+            // 裝置執行失敗（驅動錯誤、記憶體不足等）：回退 CPU，直到 classicalDevice 變更
+            qWarning() << "[DetectionController] OpenCL 傳統管線失敗，回退 CPU:" << e.what();
+            m_deviceActive = false;
+            m_deviceBuffers = DeviceBuffers();
+            return false;
+        }
+    }
+
+    void DetectionController::verifyFusedStages(const cv::Mat &fused, const cv::Mat &reference)
+    {
+        cv::Mat diff;
+        cv::compare(fused, reference, diff, cv::CMP_NE);
+        const int mismatched = cv::countNonZero(diff);
+        if (mismatched == 0)
+        {
+            return;
+        }
+
+        m_fusedMismatchFrames++;
+        if (m_fusedMismatchFrames == 1 || m_fusedMismatchFrames % 100 == 0)
+        {
+            qWarning() << "[DetectionController] 融合管線與參考管線不一致：" << mismatched
+                       << "像素，累計" << m_fusedMismatchFrames << "幀";
+        }
+    }
+
+    const cv::Mat &DetectionController::cachedKernel(cv::Mat &cache, int shape, int size)
+    {
+        // 結構元素快取：只在核尺寸變更時重建（每個快取槽固定一種形狀）
+        if (cache.empty() || cache.rows != size)
+        {
+            cache = cv::getStructuringElement(shape, cv::Size(size, size));
+        }
+        return cache;
+    }
+
     cv::Mat DetectionController::ultraHighSpeedProcessing(const cv::Mat &processRegion)
     {
-        cv::Mat fgMask;
-        m_bgSubtractor->apply(processRegion, fgMask, m_currentLearningRate);
+        StageStopwatch stopwatch(m_profiler);
+        m_bgSubtractor.apply(processRegion, m_stdBuffers.fgMask, m_currentLearningRate);
+        stopwatch.lap(PipelineStage::BackgroundSubtract);
 
-        cv::Mat kernel = cv::Mat::ones(3, 3, CV_8U);
-        cv::Mat processed;
-        cv::morphologyEx(fgMask, processed, cv::MORPH_OPEN, kernel, cv::Point(-1, -1), 1);
-        cv::dilate(processed, processed, kernel, cv::Point(-1, -1), 1);
+        cv::Mat &processed = m_stdBuffers.postProcessed;
+        highSpeedMorphology(m_stdBuffers.fgMask, processed);
+        stopwatch.lap(PipelineStage::PostMorphology);
 
         return processed;
     }
 
-    std::vector<DetectedObject> DetectionController::detectObjects(const cv::Mat &processed)
+    void DetectionController::highSpeedMorphology(const cv::Mat &fgMask, cv::Mat &out)
     {
-        std::vector<DetectedObject> objects;
+        const cv::Mat &kernel = cachedKernel(m_morphKernels.rect3, cv::MORPH_RECT, 3);
+        cv::morphologyEx(fgMask, out, cv::MORPH_OPEN, kernel, cv::Point(-1, -1), 1);
+        cv::dilate(out, out, kernel, cv::Point(-1, -1), 1);
+    }
 
-        if (processed.empty())
+    int DetectionController::filterMargin() const
+    {
+        // 傳統管線空間濾波的最大半徑（縮放像素）：高斯模糊、自適應閾值 11x11、Canny 3x3、
+        // 中值 5x5、開 / 閉 / 開（最大 7x7 橢圓）與後聯合形態學（核半徑 × 迭代次數）
+        int margin = std::max({(m_params.gaussianBlurKernelSize | 1) / 2, 11 / 2, 1, 5 / 2, 7 / 2});
+        if (m_params.openingKernelSize > 1 && m_params.openingIterations > 0)
         {
-            return objects;
+            margin = std::max(margin, m_params.openingKernelSize / 2 * m_params.openingIterations * 2);
         }
+        if (m_params.dilateKernelSize > 1 && m_params.dilateIterations > 0)
+        {
+            margin = std::max(margin, m_params.dilateKernelSize / 2 * m_params.dilateIterations);
+        }
+        if (m_params.closeKernelSize > 1)
+        {
+            margin = std::max(margin, m_params.closeKernelSize / 2 * 2);
+        }
+        return margin;
+    }
 
-        // 小零件增強預處理：2x2 微膨脹使極小零件更容易被檢測（參考 Python basler_mvc）
-        cv::Mat enhanced = processed;
-        if (!m_ultraHighSpeedMode)
+    void DetectionController::verifyRegionPixels(const cv::Mat &frame, const cv::Size &scaledSize,
+                                                 const cv::Rect &roiRect, const cv::Mat &processRegion)
+    {
+        cv::resize(frame, m_verifyScaled, scaledSize, 0, 0, cv::INTER_LINEAR);
+        cv::Mat diff;
+        cv::compare(processRegion, m_verifyScaled(roiRect), diff, cv::CMP_NE);
+        const int mismatched = cv::countNonZero(diff.reshape(1));
+        if (mismatched > 0 && (++m_regionMismatchFrames == 1 || m_regionMismatchFrames % 100 == 0))
         {
-            cv::Mat tinyKernel = cv::Mat::ones(2, 2, CV_8U);
-            cv::dilate(processed, enhanced, tinyKernel, cv::Point(-1, -1), 1);
+            qWarning() << "[DetectionController] ROI 條帶縮放與整幀縮放不一致：" << mismatched
+                       << "像素，累計" << m_regionMismatchFrames << "幀";
         }
+    }
 
-        // 連通組件分析
-        cv::Mat labels, stats, centroids;
-        int numLabels = cv::connectedComponentsWithStats(
-            enhanced, labels, stats, centroids, m_connectivity);
+    void DetectionController::verifyRegionResult(const cv::Mat &frame, const cv::Size &scaledSize,
+                                                 const cv::Rect &roiRect, bool highSpeed, const cv::Mat &processed,
+                                                 const std::vector<DetectedObject> &objects)
+    {
+        // 參考：整幀縮放後取子矩陣，背景模型、濾波與連通元件全部重跑一次
+        cv::resize(frame, m_verifyScaled, scaledSize, 0, 0, cv::INTER_LINEAR);
+        const cv::Mat referenceRegion = m_verifyScaled(roiRect);
+        m_verifyBgSubtractor.apply(referenceRegion, m_verifyFgMask, m_currentLearningRate);
+        cv::Mat referenceMask;
+        if (highSpeed)
+        {
+            highSpeedMorphology(m_verifyFgMask, m_verifyProcessed);
+            referenceMask = m_verifyProcessed;
+        }
+        else
+        {
+            referenceMask = standardStagesReference(referenceRegion, m_verifyFgMask);
+        }
+
+        cv::Mat diff;
+        cv::compare(processed, referenceMask, diff, cv::CMP_NE);
+        const int mismatched = cv::countNonZero(diff);
+        const std::vector<DetectedObject> reference = detectObjects(referenceMask, highSpeed);
+        const bool sameObjects = std::equal(objects.begin(), objects.end(), reference.begin(), reference.end(),
+                                            [](const DetectedObject &a, const DetectedObject &b)
+                                            {
+                                                return a.x == b.x && a.y == b.y && a.w == b.w && a.h == b.h &&
+                                                       a.cx == b.cx && a.cy == b.cy && a.area == b.area;
+                                            });
+        if (mismatched == 0 && sameObjects)
+        {
+            return;
+        }
 
-        int minArea = m_ultraHighSpeedMode ? m_highSpeedMinArea : m_minArea;
-        int maxArea = m_ultraHighSpeedMode ? m_highSpeedMaxArea : m_maxArea;
+        m_regionMismatchFrames++;
+        if (m_regionMismatchFrames == 1 || m_regionMismatchFrames % 100 == 0)
+        {
+            qWarning() << "[DetectionController] 先裁切再縮放與整幀縮放結果不一致：遮罩" << mismatched
+                       << "像素，物件" << objects.size() << "/" << reference.size()
+                       << (sameObjects ? "（清單相同）" : "（清單不同）")
+                       << "，累計" << m_regionMismatchFrames << "幀";
+        }
+    }
 
-        for (int i = 1; i < numLabels; ++i)
-        { // 跳過背景 (label 0)
-            int area = stats.at<int>(i, cv::CC_STAT_AREA);
+    std::vector<DetectedObject> DetectionController::detectObjects(const cv::Mat &processed, bool highSpeed)
+    {
+        std::vector<DetectedObject> objects;
+
+        if (processed.empty())
+        {
+            return objects;
+        }
+
+        // 面積門檻依本幀實際的處理層級（高速流程由設定或品質調節選中）選擇，再換算到實際處理寬度
+        const int nominalMin = highSpeed ? m_params.highSpeedMinArea : m_params.minArea;
+        const int nominalMax = highSpeed ? m_params.highSpeedMaxArea : m_params.maxArea;
+        int minArea = nominalMin;
+        int maxArea = nominalMax;
+        if (m_areaScale < 1.0)
+        {
+            minArea = std::max(std::min(nominalMin, 1), static_cast<int>(std::lround(nominalMin * m_areaScale)));
+            maxArea = std::max(minArea, static_cast<int>(std::lround(nominalMax * m_areaScale)));
+        }
+        double invScale = (m_processingScale > 0.0) ? (1.0 / m_processingScale) : 1.0;
 
+        auto addBlob = [&](int left, int top, int width, int height, int area, double centroidX, double centroidY)
+        {
             // 面積過濾
             if (area < minArea || area > maxArea)
             {
-                continue;
+                return;
             }
 
             // 座標由縮放空間映射回原始相機解析度（供 overlay 繪製與光柵計數使用）
             // 注意：processRegion 是 ROI 子圖，所以需加回 ROI 原點偏移
-            double invScale = (m_processingScale > 0.0) ? (1.0 / m_processingScale) : 1.0;
-            int x = static_cast<int>(stats.at<int>(i, cv::CC_STAT_LEFT)  * invScale) + m_currentRoiX;
-            int y = static_cast<int>(stats.at<int>(i, cv::CC_STAT_TOP)   * invScale) + m_currentRoiY;
-            int w = static_cast<int>(stats.at<int>(i, cv::CC_STAT_WIDTH)  * invScale);
-            int h = static_cast<int>(stats.at<int>(i, cv::CC_STAT_HEIGHT) * invScale);
+            int x = static_cast<int>(left * invScale) + m_currentRoiX;
+            int y = static_cast<int>(top * invScale) + m_currentRoiY;
+            int w = static_cast<int>(width * invScale);
+            int h = static_cast<int>(height * invScale);
 
-            int cx = static_cast<int>(centroids.at<double>(i, 0) * invScale) + m_currentRoiX;
-            int cy = static_cast<int>(centroids.at<double>(i, 1) * invScale) + m_currentRoiY;
+            int cx = static_cast<int>(centroidX * invScale) + m_currentRoiX;
+            int cy = static_cast<int>(centroidY * invScale) + m_currentRoiY;
 
             // 形狀驗證
             if (!validateShape(w, h, area))
             {
-                continue;
+                return;
             }
 
             DetectedObject obj;
@@ -509,6 +1547,40 @@ namespace basler
             obj.area = area;
 
             objects.push_back(obj);
+        };
+
+        // 小零件增強預處理：2x2 微膨脹使極小零件更容易被檢測（參考 Python basler_mvc）
+        const bool tinyDilate = !highSpeed;
+
+        if (m_params.runLengthBlobs)
+        {
+            // 行程編碼連通元件：膨脹折進行程擷取，不產生膨脹影像、labels 與 centroids
+            const auto &blobs = m_blobExtractor.extract(processed, m_params.connectivity, tinyDilate);
+            objects.reserve(blobs.size());
+            for (const auto &blob : blobs)
+            {
+                addBlob(blob.left, blob.top, blob.width, blob.height, blob.area, blob.centroidX, blob.centroidY);
+            }
+            return objects;
+        }
+
+        cv::Mat enhanced = processed;
+        if (tinyDilate)
+        {
+            cv::Mat tinyKernel = cv::Mat::ones(2, 2, CV_8U);
+            cv::dilate(processed, enhanced, tinyKernel, cv::Point(-1, -1), 1);
+        }
+
+        // 連通組件分析
+        cv::Mat labels, stats, centroids;
+        int numLabels = cv::connectedComponentsWithStats(
+            enhanced, labels, stats, centroids, m_params.connectivity);
+
+        for (int i = 1; i < numLabels; ++i)
+        { // 跳過背景 (label 0)
+            addBlob(stats.at<int>(i, cv::CC_STAT_LEFT), stats.at<int>(i, cv::CC_STAT_TOP),
+                    stats.at<int>(i, cv::CC_STAT_WIDTH), stats.at<int>(i, cv::CC_STAT_HEIGHT),
+                    stats.at<int>(i, cv::CC_STAT_AREA), centroids.at<double>(i, 0), centroids.at<double>(i, 1));
         }
 
         return objects;
@@ -526,14 +1598,14 @@ namespace basler
                                  ? static_cast<double>(height) / width
                                  : static_cast<double>(width) / height;
 
-        if (aspectRatio < m_minAspectRatio || aspectRatio > m_maxAspectRatio)
+        if (aspectRatio < m_params.minAspectRatio || aspectRatio > m_params.maxAspectRatio)
         {
             return false;
         }
 
         // 填充度
         double extent = static_cast<double>(area) / (width * height);
-        if (extent < m_minExtent)
+        if (extent < m_params.minExtent)
         {
             return false;
         }
@@ -546,65 +1618,65 @@ namespace basler
         m_currentFrameCount++;
 
         // 更新物件追蹤
-        updateObjectTracks(objects);
+        {
+            ScopedStageTimer trackingTimer(m_profiler, PipelineStage::Tracking);
+            updateObjectTracks(objects);
+        }
+        ScopedStageTimer countingTimer(m_profiler, PipelineStage::GateCounting);
 
-        // 檢查每個追蹤是否滿足計數條件
-        for (auto &[trackId, track] : m_objectTracks)
+        // 檢查每個活動追蹤是否滿足計數條件
+        TrackTable &tracks = m_tracks;
+        for (int slot = 0; slot < tracks.size(); ++slot)
         {
-            // 如果已計數或幀數不足，跳過
-            if (track.counted || track.inRoiFrames < m_minTrackFrames)
+            // 如果非活動、已計數或幀數不足，跳過
+            if (tracks.state[slot] != TrackTable::Active || tracks.counted[slot] ||
+                tracks.inRoiFrames[slot] < m_minTrackFrames)
             {
                 continue;
             }
 
             // 計算 Y 軸移動距離
-            int yTravel = track.maxY - track.minY;
+            int yTravel = tracks.maxY[slot] - tracks.minY[slot];
 
             // 檢查是否為重複計數
-            if (checkDuplicateCount(track))
+            if (checkDuplicateCount(tracks.x[slot], tracks.y[slot]))
             {
                 continue;
             }
 
             // 方向驗證（簡化版）：只要求整體向下移動（currentY > firstY）
             // 灰塵隨機移動不會持續向下，真實零件掉落必定向下
-            bool movedDownward = (track.y > track.firstY);
+            bool movedDownward = (tracks.y[slot] > tracks.firstY[slot]);
 
             // 綜合計數條件
             bool validCrossing = (yTravel >= m_minYTravel &&
-                                  track.inRoiFrames >= m_minTrackFrames &&
+                                  tracks.inRoiFrames[slot] >= m_minTrackFrames &&
                                   movedDownward);
 
             // 額外調試：記錄接近計數但未計數的情況（每 20 幀記錄一次）
-            if (m_currentFrameCount % 20 == 0 && yTravel >= 1 && track.inRoiFrames >= 1 && !validCrossing)
+            if (m_currentFrameCount % 20 == 0 && yTravel >= 1 && tracks.inRoiFrames[slot] >= 1 && !validCrossing)
             {
-                qDebug() << "[Debug] 接近計數 Track" << trackId
+                qDebug() << "[Debug] 接近計數 Track" << tracks.trackId[slot]
                          << ": Y移動=" << yTravel << "px (需要>=" << m_minYTravel << ")"
-                         << ", ROI幀數=" << track.inRoiFrames << "(需要>=" << m_minTrackFrames << ")"
+                         << ", ROI幀數=" << tracks.inRoiFrames[slot] << "(需要>=" << m_minTrackFrames << ")"
                          << ", 向下移動=" << movedDownward;
             }
 
             if (validCrossing)
             {
-                // 記錄到歷史中防止重複
-                m_countedObjectsHistory.push_back({{track.x, track.y}, m_currentFrameCount});
-
-                // 維護歷史長度
-                if (m_countedObjectsHistory.size() > static_cast<size_t>(m_historyLength))
-                {
-                    m_countedObjectsHistory.erase(m_countedObjectsHistory.begin());
-                }
+                // 記錄到歷史中防止重複（環形緩衝滿時覆寫最舊的一筆）
+                m_countedHistory.push(tracks.x[slot], tracks.y[slot], m_currentFrameCount);
 
-                m_crossingCounter++;
-                track.counted = true;
+                const int counted = m_crossingCounter.fetch_add(1, std::memory_order_relaxed) + 1;
+                tracks.counted[slot] = 1;
 
-                qDebug() << "[DetectionController] ✅ 成功計數 #" << m_crossingCounter
-                         << " - Track" << trackId
+                qDebug() << "[DetectionController] ✅ 成功計數 #" << counted
+                         << " - Track" << tracks.trackId[slot]
                          << " (Y移動: " << yTravel << "px)"
                          << ", 幀:" << m_currentFrameCount;
 
-                emit countChanged(m_crossingCounter);
-                emit objectsCrossedGate(m_crossingCounter);
+                emit countChanged(counted);
+                emit objectsCrossedGate(counted);
 
                 // 瑕疵統計：目前全部計為合格（未來可在此接入實際瑕疵判斷結果）
                 m_defectPassCount++;
@@ -613,170 +1685,164 @@ namespace basler
                 emit defectStatsUpdated(passRate, m_defectPassCount, m_defectFailCount);
 
                 // 自動包裝模式：更新震動機速度
-                if (m_packagingEnabled)
+                if (m_packagingEnabled.load(std::memory_order_relaxed))
                 {
                     updateVibratorSpeed();
                 }
             }
         }
 
-        // 清理過期的歷史記錄
-        m_countedObjectsHistory.erase(
-            std::remove_if(m_countedObjectsHistory.begin(), m_countedObjectsHistory.end(),
-                           [this](const auto &entry)
-                           {
-                               return m_currentFrameCount - entry.second > m_historyLength;
-                           }),
-            m_countedObjectsHistory.end());
-
         // 診斷報告（每 50 幀）
         if (m_currentFrameCount % 50 == 0)
         {
-            qDebug() << "[DetectionController] 追蹤狀態: 總追蹤=" << m_objectTracks.size()
-                     << ", 失去追蹤=" << m_lostTracks.size()
-                     << ", 計數=" << m_crossingCounter
+            qDebug() << "[DetectionController] 追蹤狀態: 總追蹤=" << m_tracks.count(TrackTable::Active)
+                     << ", 失去追蹤=" << m_tracks.count(TrackTable::Lost)
+                     << ", 計數=" << m_crossingCounter.load(std::memory_order_relaxed)
                      << ", 幀=" << m_currentFrameCount;
         }
     }
 
     bool DetectionController::checkGateTriggerDuplicate(int cx, int cy)
     {
-        for (const auto &[pos, frameNum] : m_triggeredPositions)
-        {
-            double distance = std::sqrt(
-                std::pow(cx - pos.first, 2) + std::pow(cy - pos.second, 2));
-
-            if (distance < m_gateTriggerRadius)
-            {
-                return true; // 重複觸發
-            }
-        }
-        return false;
+        // 只查觸發半徑涵蓋的格子，超過 m_params.gateHistoryFrames 的觸發點自然過期
+        return m_gateTriggers.containsNear(cx, cy, m_params.gateTriggerRadius,
+                                           m_currentFrameCount, m_params.gateHistoryFrames);
     }
 
-    cv::Mat DetectionController::drawDetectionResults(cv::Mat frame, const std::vector<DetectedObject> &objects)
+    FrameOverlay DetectionController::buildOverlay(const std::vector<DetectedObject> &objects) const
     {
-        // 繪製 ROI 區域
-        if (m_roiEnabled)
-        {
-            cv::rectangle(frame,
-                          cv::Point(m_currentRoiX, m_currentRoiY),
-                          cv::Point(m_currentRoiX + m_currentRoiWidth, m_currentRoiY + m_currentRoiHeight),
-                          cv::Scalar(255, 255, 0), 2);
-        }
+        FrameOverlay overlay;
 
-        // 繪製虛擬光柵線
-        if (m_enableGateCounting && m_gateLineY > 0)
+        // ROI 區域
+        if (m_params.roiEnabled)
         {
-            cv::line(frame,
-                     cv::Point(0, m_gateLineY),
-                     cv::Point(m_frameWidth, m_gateLineY),
-                     cv::Scalar(0, 0, 255), 3);
-
-            std::string gateText = "GATE LINE (Y=" + std::to_string(m_gateLineY) + ")";
-            cv::putText(frame, gateText,
-                        cv::Point(10, m_gateLineY - 10),
-                        cv::FONT_HERSHEY_SIMPLEX, 0.6, cv::Scalar(0, 0, 255), 2);
+            overlay.roi = QRect(m_currentRoiX, m_currentRoiY, m_currentRoiWidth, m_currentRoiHeight);
         }
 
-        // 繪製檢測到的物件
+        // 虛擬光柵線
+        overlay.gateLineY = m_gateLineY;
+        overlay.showGateLine = m_params.enableGateCounting && m_gateLineY > 0;
+        overlay.frameWidth = m_frameWidth;
+
+        // 檢測到的物件
+        overlay.boxes.reserve(objects.size());
         for (const auto &obj : objects)
         {
-            cv::Scalar boxColor = (obj.cy >= m_gateLineY)
-                                      ? cv::Scalar(0, 255, 255) // 黃色：已穿越
-                                      : cv::Scalar(0, 255, 0);  // 綠色：未穿越
-
-            cv::rectangle(frame,
-                          cv::Point(obj.x, obj.y),
-                          cv::Point(obj.x + obj.w, obj.y + obj.h),
-                          boxColor, 2);
-
-            cv::circle(frame, cv::Point(obj.cx, obj.cy), 3, cv::Scalar(255, 0, 0), -1);
-
-            cv::putText(frame, std::to_string(obj.area),
-                        cv::Point(obj.x, obj.y - 10),
-                        cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(255, 255, 255), 1);
+            FrameOverlay::Box box;
+            box.rect = QRect(obj.x, obj.y, obj.w, obj.h);
+            box.center = QPoint(obj.cx, obj.cy);
+            box.area = obj.area;
+            box.crossed = obj.cy >= m_gateLineY;
+            overlay.boxes.push_back(box);
         }
 
-        // 顯示統計信息
-        std::string modeStr = shouldUseYolo() ? "YOLO" : "Classical";
-        std::string infoText = "[" + modeStr + "] Detections: " + std::to_string(objects.size()) +
-                               " | Counted: " + std::to_string(m_crossingCounter) +
-                               " | Gate: Y=" + std::to_string(m_gateLineY);
-        cv::putText(frame, infoText,
-                    cv::Point(10, 30),
-                    cv::FONT_HERSHEY_SIMPLEX, 0.6, cv::Scalar(0, 255, 255), 2);
-
-        // YOLO 模式顯示推理時間
-        if (shouldUseYolo() && m_yoloDetector)
+        // 統計信息
+        const bool yolo = shouldUseYolo();
+        overlay.mode = yolo ? QStringLiteral("YOLO") : QStringLiteral("Classical");
+        overlay.detections = static_cast<int>(objects.size());
+        overlay.counted = m_crossingCounter.load(std::memory_order_relaxed);
+        if (yolo)
         {
-            char timeStr[64];
-            snprintf(timeStr, sizeof(timeStr), "YOLO: %.1f ms", m_yoloDetector->lastInferenceTimeMs());
-            cv::putText(frame, timeStr,
-                        cv::Point(10, 55),
-                        cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(0, 200, 255), 1);
+            overlay.yoloInferenceMs = m_yoloPool ? m_yoloPool->lastInferenceTimeMs()
+                                                 : m_yoloDetector->lastInferenceTimeMs();
         }
 
-        return frame;
+        return overlay;
     }
 
     void DetectionController::updateVibratorSpeed()
     {
-        if (!m_packagingEnabled)
-        {
-            return;
-        }
-
-        int currentCount = m_crossingCounter;
-        int target = m_targetCount;
-
-        // 檢查是否已完成
-        if (currentCount >= target)
+        if (!m_packagingEnabled.load(std::memory_order_relaxed))
         {
-            if (!m_packagingCompleted)
-            {
-                m_packagingCompleted = true;
-                m_currentSpeed = VibratorSpeed::STOP;
-                emit vibratorSpeedChanged(m_currentSpeed);
-                emit packagingCompleted();
-                qDebug() << "[DetectionController] 包裝完成！" << currentCount << "/" << target;
-            }
             return;
         }
 
-        // 計算完成度
-        int effectiveTarget = target - m_advanceStopCount;
-        double effectiveProgress = static_cast<double>(currentCount) / effectiveTarget;
+        int currentCount = m_crossingCounter.load(std::memory_order_relaxed);
+        int target = m_targetCount.load(std::memory_order_relaxed);
 
-        // 根據進度調整速度
-        VibratorSpeed newSpeed = m_currentSpeed;
+        // 每次計數都餵給落料速率估計（檔位 = 目前指令速度）
+        const int64_t nowNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                  std::chrono::steady_clock::now().time_since_epoch())
+                                  .count();
+        m_flowEstimator.recordCrossing(nowNs);
 
-        if (effectiveProgress >= m_speedSlowThreshold)
+        // 根據進度決定速度（達標 = 停止）
+        const bool reached = currentCount >= target;
+        VibratorSpeed newSpeed = VibratorSpeed::STOP;
+        double timeToTargetSec = -1.0;
+        if (!reached && m_predictiveSpeed && m_flowEstimator.ready())
         {
-            newSpeed = VibratorSpeed::CREEP;
+            // 預測式：過渡期 = 實測計數→致動延遲（無即時控制線程時用設定值）+ 流量穩定時間
+            const VibratorControlLoop *loop = m_controlLoop.load(std::memory_order_acquire);
+            const int64_t measuredNs = loop ? loop->actuationLatencyNs() : 0;
+            const double actuationSec = measuredNs > 0 ? measuredNs / 1e9 : m_actuationLatencyMs / 1000.0;
+            const PredictiveSpeedPlan plan = predictiveSpeedFor(m_flowEstimator, currentCount, target,
+                                                                m_advanceStopCount,
+                                                                actuationSec + m_flowSettleMs / 1000.0,
+                                                                m_flowSafetyFactor);
+            // 同一包內只降速不升速（估計值更新造成的來回切換沒有意義）
+            const VibratorSpeed currentSpeed = m_currentSpeed.load(std::memory_order_relaxed);
+            newSpeed = (currentSpeed == VibratorSpeed::STOP) ? plan.speed : std::min(plan.speed, currentSpeed);
+            timeToTargetSec = plan.timeToTargetSec;
         }
-        else if (effectiveProgress >= m_speedMediumThreshold)
+        else if (!reached)
         {
-            newSpeed = VibratorSpeed::SLOW;
+            newSpeed = packagingSpeedFor(currentCount, target, m_advanceStopCount,
+                                         m_speedFullThreshold.load(std::memory_order_relaxed),
+                                         m_speedMediumThreshold.load(std::memory_order_relaxed),
+                                         m_speedSlowThreshold.load(std::memory_order_relaxed));
         }
-        else if (effectiveProgress >= m_speedFullThreshold)
+
+        // 即時控制：先直接送給控制線程（每次計數都送，供延遲統計），再發 Qt 信號
+        if (VibratorControlLoop *loop = m_controlLoop.load(std::memory_order_acquire))
         {
-            newSpeed = VibratorSpeed::MEDIUM;
+            loop->post(m_laneIndex, currentCount, static_cast<int>(newSpeed));
         }
-        else
+
+        // 檢查是否已完成
+        if (reached)
         {
-            newSpeed = VibratorSpeed::FULL;
+            if (!m_packagingCompleted.load(std::memory_order_relaxed))
+            {
+                m_packagingCompleted.store(true, std::memory_order_relaxed);
+                m_currentSpeed.store(VibratorSpeed::STOP, std::memory_order_relaxed);
+                m_flowEstimator.setSpeed(VibratorSpeed::STOP, nowNs);
+                m_flowEstimator.resetRun();
+                emit vibratorSpeedChanged(VibratorSpeed::STOP);
+                emit packagingCompleted();
+                qDebug() << "[DetectionController] 包裝完成！" << currentCount << "/" << target;
+            }
+            return;
         }
 
-        if (newSpeed != m_currentSpeed)
+        if (newSpeed != m_currentSpeed.load(std::memory_order_relaxed))
         {
-            m_currentSpeed = newSpeed;
-            emit vibratorSpeedChanged(m_currentSpeed);
-            qDebug() << "[DetectionController] 速度調整:" << static_cast<int>(m_currentSpeed)
-                     << "% (" << currentCount << "/" << target << ")";
+            m_currentSpeed.store(newSpeed, std::memory_order_relaxed);
+            m_flowEstimator.setSpeed(newSpeed, nowNs);
+            emit vibratorSpeedChanged(newSpeed);
+            if (timeToTargetSec >= 0.0)
+            {
+                qDebug() << "[DetectionController] 速度調整（預測）:" << static_cast<int>(newSpeed)
+                         << "% (" << currentCount << "/" << target << "), 速率"
+                         << m_flowEstimator.rate(newSpeed) << "顆/秒, 預估剩餘"
+                         << timeToTargetSec << "秒";
+            }
+            else
+            {
+                qDebug() << "[DetectionController] 速度調整:" << static_cast<int>(newSpeed)
+                         << "% (" << currentCount << "/" << target << ")";
+            }
         }
     }
 
+    void DetectionController::setControlLoop(VibratorControlLoop *loop)
+    {
+        QMutexLocker pipelineLocker(&m_pipelineMutex);
+        m_controlLoop.store(loop, std::memory_order_release);
+        forEachLane([loop](DetectionController &lane)
+                    { lane.m_controlLoop.store(loop, std::memory_order_release); });
+    }
+
     // ===== 公開槽函數 =====
 
     void DetectionController::setEnabled(bool enabled)
@@ -786,6 +1852,8 @@ namespace basler
             m_enabled = enabled;
             if (enabled)
             {
+                QMutexLocker pipelineLocker(&m_pipelineMutex);
+                refreshParams();
                 resetBackgroundSubtractor();
             }
             emit enabledChanged(enabled);
@@ -795,21 +1863,33 @@ namespace basler
 
     void DetectionController::reset()
     {
+        QMutexLocker pipelineLocker(&m_pipelineMutex);
         QMutexLocker locker(&m_mutex);
 
-        m_crossingCounter = 0;
-        m_triggeredPositions.clear();
+        m_crossingCounter.store(0, std::memory_order_relaxed);
+        m_gateTriggers.clear();
+        m_countedHistory.clear(); // 幀號歸零，時間序歷史必須一併清空
         m_currentFrameCount = 0;
         m_totalProcessedFrames = 0;
         m_gateLineY = 0;
+        refreshParams();
         resetBackgroundSubtractor();
 
-        // 清理 YOLO 追蹤狀態
+        // 清理 YOLO 追蹤狀態（推理中的舊幀結果不再交付）
         m_yoloTracks.clear();
         m_nextYoloTrackId = 1;
+        m_lastYoloObjects.clear();
+        if (m_yoloDetector)
+        {
+            m_yoloDetector->discardPendingResults();
+        }
 
         m_defectPassCount = 0;
         m_defectFailCount = 0;
+        m_flowEstimator.resetRun(); // 已學到的落料速率保留給下一包
+
+        forEachLane([](DetectionController &lane)
+                    { lane.resetPackaging(); });
 
         emit countChanged(0);
         emit defectStatsUpdated(100.0, 0, 0);
@@ -821,137 +1901,246 @@ namespace basler
         QMutexLocker locker(&m_mutex);
         m_defectPassCount = 0;
         m_defectFailCount = 0;
+        forEachLane([](DetectionController &lane)
+                    { lane.resetDefectStats(); });
         emit defectStatsUpdated(100.0, 0, 0);
         qDebug() << "[DetectionController] 瑕疵統計已重置";
     }
 
+    // 以下 setter 只發布新參數快照，不等待當前幀；檢測線程下一幀開始時取用
+    // （背景模型與光柵索引的重建由 refreshParams 在檢測線程完成）
+
     void DetectionController::setMinArea(int area)
     {
-        m_minArea = area;
+        publishParams([area](DetectionParams &params)
+                      { params.minArea = area; });
+        forEachLane([&](DetectionController &lane)
+                    { lane.setMinArea(area); });
     }
 
     void DetectionController::setMaxArea(int area)
     {
-        m_maxArea = area;
+        publishParams([area](DetectionParams &params)
+                      { params.maxArea = area; });
+        forEachLane([&](DetectionController &lane)
+                    { lane.setMaxArea(area); });
     }
 
     void DetectionController::setBgVarThreshold(int threshold)
     {
-        m_bgVarThreshold = threshold;
-        resetBackgroundSubtractor();
+        publishParams([threshold](DetectionParams &params)
+                      { params.bgVarThreshold = threshold; });
+        forEachLane([&](DetectionController &lane)
+                    { lane.setBgVarThreshold(threshold); });
     }
 
     void DetectionController::setBgLearningRate(double rate)
     {
-        m_bgLearningRate = rate;
-        m_currentLearningRate = rate;
+        publishParams([rate](DetectionParams &params)
+                      { params.bgLearningRate = rate; });
+        forEachLane([&](DetectionController &lane)
+                    { lane.setBgLearningRate(rate); });
     }
 
     void DetectionController::setRoiEnabled(bool enabled)
     {
-        m_roiEnabled = enabled;
+        publishParams([enabled](DetectionParams &params)
+                      { params.roiEnabled = enabled; });
     }
 
     void DetectionController::setRoiX(int x)
     {
-        m_roiX = x;
+        publishParams([x](DetectionParams &params)
+                      { params.roiX = x; });
     }
 
     void DetectionController::setRoiWidth(int width)
     {
-        m_roiWidth = width; // 0 = 自動使用全幀寬度
+        publishParams([width](DetectionParams &params)
+                      { params.roiWidth = width; }); // 0 = 自動使用全幀寬度
     }
 
     void DetectionController::setRoiHeight(int height)
     {
-        m_roiHeight = height;
+        publishParams([height](DetectionParams &params)
+                      { params.roiHeight = height; });
+        forEachLane([&](DetectionController &lane)
+                    { lane.setRoiHeight(height); });
     }
 
     void DetectionController::setRoiPositionRatio(double ratio)
     {
-        m_roiPositionRatio = ratio;
+        publishParams([ratio](DetectionParams &params)
+                      { params.roiPositionRatio = ratio; });
+        forEachLane([&](DetectionController &lane)
+                    { lane.setRoiPositionRatio(ratio); });
     }
 
     void DetectionController::setGateTriggerRadius(int radius)
     {
-        m_gateTriggerRadius = radius;
+        publishParams([radius](DetectionParams &params)
+                      { params.gateTriggerRadius = radius; });
+        forEachLane([&](DetectionController &lane)
+                    { lane.setGateTriggerRadius(radius); });
     }
 
     void DetectionController::setGateHistoryFrames(int frames)
     {
-        m_gateHistoryFrames = frames;
+        publishParams([frames](DetectionParams &params)
+                      { params.gateHistoryFrames = frames; });
+        forEachLane([&](DetectionController &lane)
+                    { lane.setGateHistoryFrames(frames); });
     }
 
     void DetectionController::setGateLinePositionRatio(double ratio)
     {
-        m_gateLinePositionRatio = ratio;
+        publishParams([ratio](DetectionParams &params)
+                      { params.gateLinePositionRatio = ratio; });
+        for (size_t i = 0; i < m_laneControllers.size(); ++i)
+        {
+            if (m_laneGateOverride[i] < 0.0)
+            {
+                m_laneControllers[i]->setGateLinePositionRatio(ratio);
+            }
+        }
+    }
+
+    void DetectionController::setOptimalAssignment(bool enabled, double budgetMs)
+    {
+        publishParams([enabled, budgetMs](DetectionParams &params)
+                      {
+                          params.optimalAssignment = enabled;
+                          params.assignmentBudgetMs = budgetMs;
+                      });
+        qDebug() << "[DetectionController] 追蹤匹配:" << (enabled ? "全域最佳指派" : "貪婪")
+                 << "，預算" << budgetMs << "ms";
+        forEachLane([&](DetectionController &lane)
+                    { lane.setOptimalAssignment(enabled, budgetMs); });
     }
 
     void DetectionController::setUltraHighSpeedMode(bool enabled, int targetFps)
     {
-        m_ultraHighSpeedMode = enabled;
-        m_targetFps = targetFps;
-        resetBackgroundSubtractor();
+        publishParams([enabled, targetFps](DetectionParams &params)
+                      {
+                          params.ultraHighSpeedMode = enabled;
+                          params.targetFps = targetFps;
+                      });
+        forEachLane([&](DetectionController &lane)
+                    { lane.setUltraHighSpeedMode(enabled, targetFps); });
     }
 
     void DetectionController::setBgHistory(int history)
     {
-        m_bgHistory = history;
-        resetBackgroundSubtractor();
+        publishParams([history](DetectionParams &params)
+                      { params.bgHistory = history; });
+        forEachLane([&](DetectionController &lane)
+                    { lane.setBgHistory(history); });
+    }
+
+    void DetectionController::setBackgroundEngine(BackgroundEngine engine, bool highSpeed)
+    {
+        publishParams([engine, highSpeed](DetectionParams &params)
+                      { (highSpeed ? params.highSpeedBgEngine : params.bgEngine) = engine; });
+        forEachLane([&](DetectionController &lane)
+                    { lane.setBackgroundEngine(engine, highSpeed); });
     }
 
     void DetectionController::setCannyThresholds(int low, int high)
     {
-        m_cannyLowThreshold = low;
-        m_cannyHighThreshold = high;
+        publishParams([low, high](DetectionParams &params)
+                      {
+                          params.cannyLowThreshold = low;
+                          params.cannyHighThreshold = high;
+                      });
+        forEachLane([&](DetectionController &lane)
+                    { lane.setCannyThresholds(low, high); });
     }
 
     void DetectionController::setMorphParams(int kernelSize, int iterations)
     {
-        m_dilateKernelSize = kernelSize;
-        m_dilateIterations = iterations;
+        publishParams([kernelSize, iterations](DetectionParams &params)
+                      {
+                          params.dilateKernelSize = kernelSize;
+                          params.dilateIterations = iterations;
+                      });
+        forEachLane([&](DetectionController &lane)
+                    { lane.setMorphParams(kernelSize, iterations); });
     }
 
     void DetectionController::enablePackagingMode(bool enabled)
     {
-        m_packagingEnabled = enabled;
+        m_packagingEnabled.store(enabled, std::memory_order_relaxed);
         if (enabled)
         {
-            m_packagingCompleted = false;
+            m_packagingCompleted.store(false, std::memory_order_relaxed);
         }
+        forEachLane([&](DetectionController &lane)
+                    { lane.enablePackagingMode(enabled); });
     }
 
     void DetectionController::setTargetCount(int count)
     {
-        m_targetCount = count;
-        m_packagingCompleted = false;
+        m_targetCount.store(count, std::memory_order_relaxed);
+        m_packagingCompleted.store(false, std::memory_order_relaxed);
+        for (size_t i = 0; i < m_laneControllers.size(); ++i)
+        {
+            if (m_laneTargetOverride[i] <= 0)
+            {
+                m_laneControllers[i]->setTargetCount(count);
+            }
+        }
     }
 
     void DetectionController::setSpeedThresholds(double full, double medium, double slow)
     {
-        m_speedFullThreshold = full;
-        m_speedMediumThreshold = medium;
-        m_speedSlowThreshold = slow;
+        m_speedFullThreshold.store(full, std::memory_order_relaxed);
+        m_speedMediumThreshold.store(medium, std::memory_order_relaxed);
+        m_speedSlowThreshold.store(slow, std::memory_order_relaxed);
+        forEachLane([&](DetectionController &lane)
+                    { lane.setSpeedThresholds(full, medium, slow); });
     }
 
     void DetectionController::resetPackaging()
     {
         reset();
-        m_packagingCompleted = false;
-        m_currentSpeed = VibratorSpeed::STOP;
+
+        // 落料速率估計不是原子狀態，檢測線程在 updateVibratorSpeed 中同樣會修改：在管線鎖內歸零
+        QMutexLocker pipelineLocker(&m_pipelineMutex);
+        m_packagingCompleted.store(false, std::memory_order_relaxed);
+        m_currentSpeed.store(VibratorSpeed::STOP, std::memory_order_relaxed);
+        m_flowEstimator.setSpeed(VibratorSpeed::STOP, 0);
     }
 
     PackagingStatus DetectionController::getPackagingStatus() const
     {
+        if (!m_laneControllers.empty())
+        {
+            // 多料道：計數與目標為各料道合計，速度取最快的料道
+            PackagingStatus status;
+            status.enabled = m_packagingEnabled.load(std::memory_order_relaxed);
+            status.completed = m_packagingCompleted.load(std::memory_order_relaxed);
+            for (const auto &lane : m_laneControllers)
+            {
+                status.currentCount += lane->m_crossingCounter.load(std::memory_order_relaxed);
+                status.targetCount += lane->m_targetCount.load(std::memory_order_relaxed);
+                status.vibratorSpeed = std::max(status.vibratorSpeed,
+                                                lane->m_currentSpeed.load(std::memory_order_relaxed));
+            }
+            status.progressPercent = (status.targetCount > 0)
+                                         ? (static_cast<double>(status.currentCount) / status.targetCount * 100.0)
+                                         : 0.0;
+            return status;
+        }
+
         PackagingStatus status;
-        status.enabled = m_packagingEnabled;
-        status.currentCount = m_crossingCounter;
-        status.targetCount = m_targetCount;
-        status.progressPercent = (m_targetCount > 0)
-                                     ? (static_cast<double>(m_crossingCounter) / m_targetCount * 100.0)
+        status.enabled = m_packagingEnabled.load(std::memory_order_relaxed);
+        status.currentCount = m_crossingCounter.load(std::memory_order_relaxed); // 同一份快照算進度
+        status.targetCount = m_targetCount.load(std::memory_order_relaxed);
+        status.progressPercent = (status.targetCount > 0)
+                                     ? (static_cast<double>(status.currentCount) / status.targetCount * 100.0)
                                      : 0.0;
-        status.vibratorSpeed = m_currentSpeed;
-        status.completed = m_packagingCompleted;
+        status.vibratorSpeed = m_currentSpeed.load(std::memory_order_relaxed);
+        status.completed = m_packagingCompleted.load(std::memory_order_relaxed);
         return status;
     }
 
@@ -959,239 +2148,277 @@ namespace basler
 
     void DetectionController::updateObjectTracks(const std::vector<DetectedObject> &objects)
     {
-        std::map<int, ObjectTrack> newTracks;
-        std::set<int>    usedTrackIds;
-        std::set<size_t> usedObjectIds;  // 與 objIdx(size_t) 型別一致，消除 C4267 警告
+        // 活動與失去追蹤共用一張表：狀態轉移只改 state 欄位，移除延後到 compact() 一次完成
+        TrackTable &tracks = m_tracks;
+        const int existingTracks = tracks.size(); // 本幀新增的追蹤附加在其後
 
         // 第一階段：為現有追蹤更新速度和預測
-        for (auto &[trackId, track] : m_objectTracks)
+        for (int slot = 0; slot < existingTracks; ++slot)
         {
-            updateTrackVelocity(track);
-            track.missedFrames++;
+            tracks.matched[slot] = 0;
+            if (tracks.state[slot] == TrackTable::Active)
+            {
+                tracks.updateVelocity(slot);
+                tracks.missedFrames[slot]++;
+            }
         }
 
-        // 第二階段：使用多特徵匹配尋找最佳配對
-        std::vector<std::tuple<int, int, double>> matches; // (trackId, objIdx, score)
-
-        for (size_t objIdx = 0; objIdx < objects.size(); ++objIdx)
+        // 建立追蹤位置網格：calculateMatchScore 的硬性限制為當前位置 ±2 倍容錯，
+        // 格子取同尺寸，候選只會在相鄰 3×3 格內（失去追蹤的位置本幀不變，恢復階段共用）
+        m_trackGrid.setCellSize(m_crossingToleranceX * 2, m_crossingToleranceY * 2);
+        m_trackGrid.clear();
+        for (int slot = 0; slot < existingTracks; ++slot)
         {
-            const auto &obj = objects[objIdx];
-            double bestScore = 0.0;
-            int trackId = findMatchingTrack(obj, bestScore);
-
-            if (trackId != -1 && bestScore >= m_matchThreshold)
-            {
-                matches.push_back({trackId, static_cast<int>(objIdx), bestScore});
-            }
+            m_trackGrid.insert(slot, tracks.x[slot], tracks.y[slot]);
         }
+        m_trackGrid.build();
 
-        // 按評分排序，優先處理高分匹配
-        std::sort(matches.begin(), matches.end(),
-                  [](const auto &a, const auto &b)
-                  { return std::get<2>(a) > std::get<2>(b); });
+        // 第二、三階段：多特徵匹配並更新追蹤（貪婪或全域最佳指派），同時量測匹配耗時
+        m_objectUsed.assign(objects.size(), 0);
+        const auto matchStart = std::chrono::steady_clock::now();
+        if (m_params.optimalAssignment)
+        {
+            matchTracksOptimal(objects, existingTracks);
+        }
+        else
+        {
+            matchTracksGreedy(objects);
+        }
+        const double matchMs = std::chrono::duration<double, std::milli>(
+                                   std::chrono::steady_clock::now() - matchStart)
+                                   .count();
+        m_lastMatcherLatencyMs.store(matchMs, std::memory_order_relaxed);
+        if (m_currentFrameCount % 10 == 0)
+        {
+            emit trackMatcherTimeUpdated(matchMs);
+        }
 
-        // 第三階段：應用匹配並更新追蹤
-        for (const auto &[trackId, objIdx, score] : matches)
+        // 第四階段：嘗試從失去的追蹤中恢復
+        for (size_t objIdx = 0; objIdx < objects.size(); ++objIdx)
         {
-            if (usedTrackIds.find(trackId) != usedTrackIds.end() ||
-                usedObjectIds.find(objIdx) != usedObjectIds.end())
+            if (m_objectUsed[objIdx])
             {
-                continue; // 已被使用
+                continue;
             }
 
             const auto &obj = objects[objIdx];
-            const auto &oldTrack = m_objectTracks[trackId];
-
-            ObjectTrack updatedTrack = oldTrack;
-            updatedTrack.x = obj.cx;
-            updatedTrack.y = obj.cy;
-            updatedTrack.w = obj.w;
-            updatedTrack.h = obj.h;
-            updatedTrack.area = obj.area;
-            updatedTrack.lastFrame = m_currentFrameCount;
-            updatedTrack.positions.push_back({obj.cx, obj.cy});
-            updatedTrack.areaHistory.push_back(obj.area);
-            updatedTrack.inRoiFrames++;
-            updatedTrack.maxY = std::max(updatedTrack.maxY, obj.cy);
-            updatedTrack.minY = std::min(updatedTrack.minY, obj.cy);
-            updatedTrack.missedFrames = 0;
+            int recoveredSlot = -1;
+            double bestScore = 0.0;
 
-            // 限制歷史長度
-            if (updatedTrack.positions.size() > 10)
+            m_trackGrid.forEachCandidate(obj.cx, obj.cy, [&](int slot)
+                                         {
+                                             if (tracks.state[slot] != TrackTable::Lost)
+                                                 return;
+
+                                             double score = calculateMatchScore(obj, slot);
+                                             if (score < m_matchThreshold * 0.7) // 恢復閾值適度收緊，防止錯誤恢復
+                                                 return;
+                                             // 同分取較小槽位，與依 trackId 順序掃描的結果一致
+                                             if (score > bestScore || (score == bestScore && slot < recoveredSlot))
+                                             {
+                                                 bestScore = score;
+                                                 recoveredSlot = slot;
+                                             }
+                                         });
+
+            if (recoveredSlot != -1)
             {
-                updatedTrack.positions.erase(updatedTrack.positions.begin());
-                updatedTrack.areaHistory.erase(updatedTrack.areaHistory.begin());
+                tracks.state[recoveredSlot] = TrackTable::Active;
+                tracks.observe(recoveredSlot, obj.cx, obj.cy, obj.w, obj.h, obj.area, m_currentFrameCount);
+                tracks.matched[recoveredSlot] = 1;
+                m_objectUsed[objIdx] = 1;
             }
-
-            newTracks[trackId] = updatedTrack;
-            usedTrackIds.insert(trackId);
-            usedObjectIds.insert(objIdx);
         }
 
-        // 第四階段：嘗試從失去的追蹤中恢復
+        // 第五階段：為未匹配的物件創建新追蹤（首次位置用於方向驗證）
         for (size_t objIdx = 0; objIdx < objects.size(); ++objIdx)
         {
-            if (usedObjectIds.find(objIdx) != usedObjectIds.end())
+            if (m_objectUsed[objIdx])
             {
                 continue;
             }
 
             const auto &obj = objects[objIdx];
-            int recoveredTrackId = -1;
-            double bestScore = 0.0;
+            tracks.add(m_nextTrackId++, obj.cx, obj.cy, obj.w, obj.h, obj.area, m_currentFrameCount);
+        }
 
-            for (const auto &[lostId, lostTrack] : m_lostTracks)
+        // 第六階段：未更新的活動追蹤轉為失去，並清理過期的失去追蹤
+        for (int slot = 0; slot < existingTracks; ++slot)
+        {
+            if (tracks.state[slot] == TrackTable::Active && !tracks.matched[slot])
             {
-                double score = calculateMatchScore(obj, lostTrack);
-                if (score > bestScore && score >= m_matchThreshold * 0.7) // 恢復閾值適度收緊，防止錯誤恢復
-                {
-                    bestScore = score;
-                    recoveredTrackId = lostId;
-                }
+                tracks.state[slot] = (tracks.missedFrames[slot] < m_maxMissedFrames)
+                                         ? TrackTable::Lost
+                                         : TrackTable::Dead;
             }
 
-            if (recoveredTrackId != -1)
+            if (tracks.state[slot] == TrackTable::Lost)
             {
-                ObjectTrack recoveredTrack = m_lostTracks[recoveredTrackId];
-                recoveredTrack.x = obj.cx;
-                recoveredTrack.y = obj.cy;
-                recoveredTrack.w = obj.w;
-                recoveredTrack.h = obj.h;
-                recoveredTrack.area = obj.area;
-                recoveredTrack.lastFrame = m_currentFrameCount;
-                recoveredTrack.positions.push_back({obj.cx, obj.cy});
-                recoveredTrack.areaHistory.push_back(obj.area);
-                recoveredTrack.inRoiFrames++;
-                recoveredTrack.maxY = std::max(recoveredTrack.maxY, obj.cy);
-                recoveredTrack.minY = std::min(recoveredTrack.minY, obj.cy);
-                recoveredTrack.missedFrames = 0;
-
-                newTracks[recoveredTrackId] = recoveredTrack;
-                m_lostTracks.erase(recoveredTrackId);
-                usedObjectIds.insert(objIdx);
+                tracks.missedFrames[slot]++; // 增加失蹤計數
+                if (tracks.missedFrames[slot] >= m_maxMissedFrames)
+                {
+                    tracks.state[slot] = TrackTable::Dead;
+                }
             }
         }
 
-        // 第五階段：為未匹配的物件創建新追蹤
-        for (size_t objIdx = 0; objIdx < objects.size(); ++objIdx)
+        // 防止追蹤表過度增長（硬性上限）
+        static constexpr int MAX_ACTIVE_TRACKS = 100;
+        static constexpr int MAX_LOST_TRACKS = 50;
+
+        int activeCount = tracks.count(TrackTable::Active);
+        if (activeCount > MAX_ACTIVE_TRACKS)
         {
-            if (usedObjectIds.find(objIdx) != usedObjectIds.end())
+            qWarning() << "[DetectionController] 警告：活動追蹤數超限，清理最舊追蹤";
+            // 移除最舊的追蹤（按 firstFrame 排序）
+            while (activeCount > MAX_ACTIVE_TRACKS)
             {
-                continue;
+                int oldest = -1;
+                for (int slot = 0; slot < tracks.size(); ++slot)
+                {
+                    if (tracks.state[slot] == TrackTable::Active &&
+                        (oldest == -1 || tracks.firstFrame[slot] < tracks.firstFrame[oldest]))
+                    {
+                        oldest = slot;
+                    }
+                }
+                tracks.state[oldest] = TrackTable::Dead;
+                activeCount--;
             }
-
-            const auto &obj = objects[objIdx];
-            ObjectTrack newTrack;
-            newTrack.trackId = m_nextTrackId++;
-            newTrack.x = obj.cx;
-            newTrack.y = obj.cy;
-            newTrack.w = obj.w;
-            newTrack.h = obj.h;
-            newTrack.area = obj.area;
-            newTrack.firstFrame = m_currentFrameCount;
-            newTrack.lastFrame = m_currentFrameCount;
-            newTrack.inRoiFrames = 1;
-            newTrack.maxY = obj.cy;
-            newTrack.minY = obj.cy;
-            newTrack.firstY = obj.cy; // 記錄首次出現位置（用於方向驗證）
-            newTrack.counted = false;
-            newTrack.positions.push_back({obj.cx, obj.cy});
-            newTrack.areaHistory.push_back(obj.area);
-            newTrack.velocityX = 0;
-            newTrack.velocityY = 0;
-            newTrack.predictedX = obj.cx;
-            newTrack.predictedY = obj.cy;
-            newTrack.missedFrames = 0;
-
-            newTracks[newTrack.trackId] = newTrack;
         }
 
-        // 第六階段：將未更新的追蹤移至 lostTracks
-        for (const auto &[trackId, track] : m_objectTracks)
+        if (tracks.count(TrackTable::Lost) > MAX_LOST_TRACKS)
         {
-            if (newTracks.find(trackId) == newTracks.end())
+            // 太多失蹤追蹤，直接清空
+            for (int slot = 0; slot < tracks.size(); ++slot)
             {
-                if (track.missedFrames < m_maxMissedFrames)
+                if (tracks.state[slot] == TrackTable::Lost)
                 {
-                    m_lostTracks[trackId] = track;
+                    tracks.state[slot] = TrackTable::Dead;
                 }
             }
         }
 
-        // 清理過期的 lostTracks
-        for (auto it = m_lostTracks.begin(); it != m_lostTracks.end();)
+        tracks.compact();
+    }
+
+    void DetectionController::matchTracksGreedy(const std::vector<DetectedObject> &objects)
+    {
+        TrackTable &tracks = m_tracks;
+
+        // 每個偵測各挑最佳追蹤
+        m_trackMatches.clear();
+
+        for (size_t objIdx = 0; objIdx < objects.size(); ++objIdx)
         {
-            it->second.missedFrames++; // 增加失蹤計數
-            if (it->second.missedFrames >= m_maxMissedFrames)
+            const auto &obj = objects[objIdx];
+            double bestScore = 0.0;
+            int slot = findMatchingTrack(obj, bestScore);
+
+            if (slot != -1 && bestScore >= m_matchThreshold)
             {
-                it = m_lostTracks.erase(it);
+                m_trackMatches.emplace_back(slot, static_cast<int>(objIdx), bestScore);
             }
-            else
+        }
+
+        // 按評分排序，優先處理高分匹配
+        std::sort(m_trackMatches.begin(), m_trackMatches.end(),
+                  [](const auto &a, const auto &b)
+                  { return std::get<2>(a) > std::get<2>(b); });
+
+        // 應用匹配並更新追蹤
+        for (const auto &[slot, objIdx, score] : m_trackMatches)
+        {
+            if (tracks.matched[slot] || m_objectUsed[objIdx])
             {
-                ++it;
+                continue; // 已被使用
             }
+
+            const auto &obj = objects[objIdx];
+            tracks.observe(slot, obj.cx, obj.cy, obj.w, obj.h, obj.area, m_currentFrameCount);
+            tracks.matched[slot] = 1;
+            m_objectUsed[objIdx] = 1;
         }
+    }
 
-        // 更新追蹤狀態
-        m_objectTracks = newTracks;
+    void DetectionController::matchTracksOptimal(const std::vector<DetectedObject> &objects, int trackCount)
+    {
+        TrackTable &tracks = m_tracks;
 
-        // 防止追蹤 map 過度增長（硬性上限）
-        static constexpr size_t MAX_ACTIVE_TRACKS = 100;
-        static constexpr size_t MAX_LOST_TRACKS = 50;
+        // 收集所有通過閾值的候選配對（網格相鄰格內，評分沿用 calculateMatchScore 權重）
+        m_assignmentCandidates.clear();
+        for (size_t objIdx = 0; objIdx < objects.size(); ++objIdx)
+        {
+            const auto &obj = objects[objIdx];
+            m_trackGrid.forEachCandidate(obj.cx, obj.cy, [&](int slot)
+                                         {
+                                             if (tracks.state[slot] != TrackTable::Active)
+                                                 return;
+                                             double score = calculateMatchScore(obj, slot);
+                                             if (score >= m_matchThreshold)
+                                                 m_assignmentCandidates.push_back({slot, static_cast<int>(objIdx), score});
+                                         });
+        }
 
-        if (m_objectTracks.size() > MAX_ACTIVE_TRACKS)
+        // 總分最大的指派；超出預算的分量由求解器改用貪婪
+        const auto stats = m_assignmentSolver.solve(m_assignmentCandidates, trackCount,
+                                                    static_cast<int>(objects.size()),
+                                                    m_params.assignmentBudgetMs, m_assignments);
+        if (stats.budgetExceeded)
         {
-            qWarning() << "[DetectionController] 警告：活動追蹤數超限，清理最舊追蹤";
-            // 移除最舊的追蹤（按 firstFrame 排序）
-            while (m_objectTracks.size() > MAX_ACTIVE_TRACKS)
+            quint64 exceeded = ++m_assignmentBudgetExceeded;
+            if (exceeded == 1 || exceeded % 100 == 0)
             {
-                auto oldest = std::min_element(
-                    m_objectTracks.begin(), m_objectTracks.end(),
-                    [](const auto &a, const auto &b)
-                    { return a.second.firstFrame < b.second.firstFrame; });
-                if (oldest != m_objectTracks.end())
-                {
-                    m_objectTracks.erase(oldest);
-                }
+                qWarning() << "[DetectionController] 追蹤指派超出時間預算" << m_params.assignmentBudgetMs << "ms，"
+                           << stats.greedyComponents << "個分量改用貪婪匹配（累計" << exceeded << "幀）";
             }
         }
 
-        if (m_lostTracks.size() > MAX_LOST_TRACKS)
+        for (const auto &[slot, objIdx] : m_assignments)
         {
-            m_lostTracks.clear(); // 太多失蹤追蹤，直接清空
+            const auto &obj = objects[objIdx];
+            tracks.observe(slot, obj.cx, obj.cy, obj.w, obj.h, obj.area, m_currentFrameCount);
+            tracks.matched[slot] = 1;
+            m_objectUsed[objIdx] = 1;
         }
     }
 
-    int DetectionController::findMatchingTrack(const DetectedObject &obj, double &outScore)
+    int DetectionController::findMatchingTrack(const DetectedObject &obj, double &outScore) const
     {
-        int bestTrackId = -1;
+        int bestSlot = -1;
         double bestScore = 0.0;
 
-        for (const auto &[trackId, track] : m_objectTracks)
-        {
-            double score = calculateMatchScore(obj, track);
-
-            if (score > bestScore)
-            {
-                bestScore = score;
-                bestTrackId = trackId;
-            }
-        }
+        // 只評分相鄰格內的活動追蹤（網格外的追蹤必定被硬性距離限制排除）
+        m_trackGrid.forEachCandidate(obj.cx, obj.cy, [&](int slot)
+                                     {
+                                         if (m_tracks.state[slot] != TrackTable::Active)
+                                             return;
+
+                                         double score = calculateMatchScore(obj, slot);
+                                         // 同分取較小槽位，與依 trackId 順序掃描的結果一致
+                                         if (score > bestScore || (score > 0.0 && score == bestScore && slot < bestSlot))
+                                         {
+                                             bestScore = score;
+                                             bestSlot = slot;
+                                         }
+                                     });
 
         outScore = bestScore;
-        return bestTrackId;
+        return bestSlot;
     }
 
-    double DetectionController::calculateMatchScore(const DetectedObject &obj, const ObjectTrack &track)
+    double DetectionController::calculateMatchScore(const DetectedObject &obj, int slot) const
     {
+        const TrackTable &track = m_tracks;
+
         // 距離匹配（帶速度預測 + 當前位置雙重比較）
-        double dx = obj.cx - track.predictedX;
-        double dy = obj.cy - track.predictedY;
+        double dx = obj.cx - track.predictedX[slot];
+        double dy = obj.cy - track.predictedY[slot];
         double distance = std::sqrt(dx * dx + dy * dy);
 
         // 也計算與當前位置的距離，取較小值
-        double dxCur = obj.cx - track.x;
-        double dyCur = obj.cy - track.y;
+        double dxCur = obj.cx - track.x[slot];
+        double dyCur = obj.cy - track.y[slot];
         double distanceCur = std::sqrt(dxCur * dxCur + dyCur * dyCur);
         distance = std::min(distance, distanceCur);
 
@@ -1209,10 +2436,11 @@ namespace basler
 
         // 面積相似度：min/max 比值（0~1，完全相同為 1）
         double areaSimilarity = 0.0;
-        if (track.area > 0 && obj.area > 0)
+        const int trackArea = track.area[slot];
+        if (trackArea > 0 && obj.area > 0)
         {
-            double minA = std::min(static_cast<double>(obj.area), static_cast<double>(track.area));
-            double maxA = std::max(static_cast<double>(obj.area), static_cast<double>(track.area));
+            double minA = std::min(static_cast<double>(obj.area), static_cast<double>(trackArea));
+            double maxA = std::max(static_cast<double>(obj.area), static_cast<double>(trackArea));
             areaSimilarity = minA / maxA;
         }
 
@@ -1241,46 +2469,12 @@ namespace basler
         return (unionArea > 0) ? static_cast<double>(intersectionArea) / unionArea : 0.0;
     }
 
-    void DetectionController::updateTrackVelocity(ObjectTrack &track)
-    {
-        if (track.positions.size() >= 2)
-        {
-            // 使用最近兩個位置計算速度
-            size_t size = track.positions.size();
-            auto &recent = track.positions[size - 1];
-            auto &previous = track.positions[size - 2];
-
-            track.velocityX = recent.first - previous.first;
-            track.velocityY = recent.second - previous.second;
-
-            // 預測下一幀位置
-            track.predictedX = recent.first + track.velocityX;
-            track.predictedY = recent.second + track.velocityY;
-        }
-        else
-        {
-            // 沒有足夠歷史，使用當前位置
-            track.predictedX = track.x;
-            track.predictedY = track.y;
-        }
-    }
-
-    bool DetectionController::checkDuplicateCount(const ObjectTrack &track)
+    bool DetectionController::checkDuplicateCount(int x, int y) const
     {
-        for (const auto &entry : m_countedObjectsHistory)
-        {
-            const auto &[pos, frame] = entry;
-            double distance = std::sqrt(std::pow(track.x - pos.first, 2) +
-                                        std::pow(track.y - pos.second, 2));
-            int temporalDistance = m_currentFrameCount - frame;
-
-            if (distance < m_duplicateDistanceThreshold &&
-                temporalDistance < m_temporalTolerance)
-            {
-                return true; // 重複計數
-            }
-        }
-        return false;
+        // 歷史超過 m_historyLength 幀視為過期，與時間容錯取較嚴者
+        const int maxAge = std::min(m_temporalTolerance, m_historyLength + 1);
+        return m_countedHistory.containsNear(x, y, m_duplicateDistanceThreshold,
+                                             m_currentFrameCount, maxAge);
     }
 
     // ===== YOLO 偵測相關實作 =====
@@ -1290,9 +2484,9 @@ namespace basler
         switch (m_detectionMode)
         {
         case DetectionMode::YOLO:
-            return m_yoloDetector && m_yoloDetector->isModelLoaded();
+            return isYoloModelLoaded();
         case DetectionMode::Auto:
-            return m_yoloDetector && m_yoloDetector->isModelLoaded();
+            return isYoloModelLoaded();
         case DetectionMode::Classical:
         default:
             return false;
@@ -1301,6 +2495,10 @@ namespace basler
 
     bool DetectionController::isYoloModelLoaded() const
     {
+        if (m_yoloPool)
+        {
+            return m_yoloPool->isModelLoaded();
+        }
         return m_yoloDetector && m_yoloDetector->isModelLoaded();
     }
 
@@ -1308,12 +2506,14 @@ namespace basler
     {
         std::vector<DetectedObject> results;
 
-        if (!m_yoloDetector || !m_yoloDetector->isModelLoaded())
+        if (!isYoloModelLoaded())
         {
             return results;
         }
 
-        double inferenceTime = m_yoloDetector->detect(roiImage, 0, roiY, results);
+        // 共用推理池：等待閒置實例（其他管線的推理進行中時會在此排隊）
+        double inferenceTime = m_yoloPool ? m_yoloPool->detect(roiImage, 0, roiY, results)
+                                          : m_yoloDetector->detect(roiImage, 0, roiY, results);
 
         // 發射推理時間信號（限制頻率，每 10 幀更新一次）
         if (m_totalProcessedFrames % 10 == 0)
@@ -1324,24 +2524,58 @@ namespace basler
         return results;
     }
 
+    std::vector<DetectedObject> DetectionController::yoloProcessingAsync(const cv::Mat &roiImage, int roiY)
+    {
+        m_yoloResults.clear();
+
+        if (!m_yoloDetector || !m_yoloDetector->isModelLoaded())
+        {
+            return {};
+        }
+
+        if (!m_yoloDetector->isAsyncRunning())
+        {
+            m_yoloDetector->startAsync(m_yoloBatchSize);
+        }
+
+        // 提交本幀（前處理在此完成），再取回已完成的幀；結果落後管線深度（通常 1~2 幀）
+        m_yoloDetector->submitAsync(roiImage, 0, roiY, static_cast<uint64_t>(m_totalProcessedFrames));
+        if (m_yoloDetector->takeResults(m_yoloResults) > 0)
+        {
+            m_lastYoloObjects = m_yoloResults.back().objects;
+
+            if (m_totalProcessedFrames % 10 == 0)
+            {
+                emit yoloInferenceTimeUpdated(m_yoloResults.back().inferenceMs);
+            }
+        }
+
+        return m_lastYoloObjects;
+    }
+
     void DetectionController::yoloBasedCounting(const std::vector<DetectedObject> &objects)
     {
         // YOLO 簡化計數：純距離匹配追蹤 + 方向判定
         m_currentFrameCount++;
 
-        std::set<int> matchedTrackIds;
-        std::set<size_t> matchedObjIndices;
+        for (auto &track : m_yoloTracks)
+        {
+            track.matched = false;
+        }
+        m_objectUsed.assign(objects.size(), 0);
 
-        // 匹配現有追蹤與當前偵測
+        // 匹配現有追蹤與當前偵測（新追蹤在匹配完成後才附加）
+        const size_t existingTracks = m_yoloTracks.size();
         for (size_t objIdx = 0; objIdx < objects.size(); ++objIdx)
         {
             const auto &obj = objects[objIdx];
-            int bestTrackId = -1;
+            int bestIdx = -1;
             double bestDist = 1e9;
 
-            for (const auto &[trackId, track] : m_yoloTracks)
+            for (size_t trackIdx = 0; trackIdx < existingTracks; ++trackIdx)
             {
-                if (matchedTrackIds.count(trackId))
+                const auto &track = m_yoloTracks[trackIdx];
+                if (track.matched)
                     continue;
 
                 double dx = obj.cx - track.cx;
@@ -1352,54 +2586,37 @@ namespace basler
                 if (dist < bestDist && dist < 50.0)
                 {
                     bestDist = dist;
-                    bestTrackId = trackId;
+                    bestIdx = static_cast<int>(trackIdx);
                 }
             }
 
-            if (bestTrackId != -1)
+            if (bestIdx != -1)
             {
                 // 更新現有追蹤
-                auto &track = m_yoloTracks[bestTrackId];
+                auto &track = m_yoloTracks[bestIdx];
                 track.cx = obj.cx;
                 track.cy = obj.cy;
                 track.lastFrame = m_currentFrameCount;
-                matchedTrackIds.insert(bestTrackId);
-                matchedObjIndices.insert(objIdx);
+                track.matched = true;
+                m_objectUsed[objIdx] = 1;
 
                 // 計數判定：向下移動且未計數
                 if (!track.counted && track.cy > track.firstY + m_minYTravel)
                 {
                     // 時空去重複
-                    bool isDuplicate = false;
-                    for (const auto &entry : m_countedObjectsHistory)
+                    if (!checkDuplicateCount(track.cx, track.cy))
                     {
-                        double d = std::sqrt(std::pow(track.cx - entry.first.first, 2) +
-                                             std::pow(track.cy - entry.first.second, 2));
-                        if (d < m_duplicateDistanceThreshold &&
-                            m_currentFrameCount - entry.second < m_temporalTolerance)
-                        {
-                            isDuplicate = true;
-                            break;
-                        }
-                    }
-
-                    if (!isDuplicate)
-                    {
-                        m_countedObjectsHistory.push_back({{track.cx, track.cy}, m_currentFrameCount});
-                        if (m_countedObjectsHistory.size() > static_cast<size_t>(m_historyLength))
-                        {
-                            m_countedObjectsHistory.erase(m_countedObjectsHistory.begin());
-                        }
+                        m_countedHistory.push(track.cx, track.cy, m_currentFrameCount);
 
-                        m_crossingCounter++;
+                        const int counted = m_crossingCounter.fetch_add(1, std::memory_order_relaxed) + 1;
                         track.counted = true;
 
-                        qDebug() << "[YOLO] 計數 #" << m_crossingCounter
+                        qDebug() << "[YOLO] 計數 #" << counted
                                  << " Track" << track.trackId
                                  << " Y移動:" << (track.cy - track.firstY) << "px";
 
-                        emit countChanged(m_crossingCounter);
-                        emit objectsCrossedGate(m_crossingCounter);
+                        emit countChanged(counted);
+                        emit objectsCrossedGate(counted);
 
                         // 瑕疵統計：YOLO 模式下同步更新（目前全部計為合格）
                         m_defectPassCount++;
@@ -1407,7 +2624,7 @@ namespace basler
                         double passRate = (total > 0) ? (static_cast<double>(m_defectPassCount) / total * 100.0) : 100.0;
                         emit defectStatsUpdated(passRate, m_defectPassCount, m_defectFailCount);
 
-                        if (m_packagingEnabled)
+                        if (m_packagingEnabled.load(std::memory_order_relaxed))
                         {
                             updateVibratorSpeed();
                         }
@@ -1419,7 +2636,7 @@ namespace basler
         // 為未匹配的偵測建立新追蹤
         for (size_t objIdx = 0; objIdx < objects.size(); ++objIdx)
         {
-            if (matchedObjIndices.count(objIdx))
+            if (m_objectUsed[objIdx])
                 continue;
 
             const auto &obj = objects[objIdx];
@@ -1430,45 +2647,103 @@ namespace basler
             newTrack.firstY = obj.cy;
             newTrack.lastFrame = m_currentFrameCount;
             newTrack.counted = false;
+            newTrack.matched = true;
 
-            m_yoloTracks[newTrack.trackId] = newTrack;
+            m_yoloTracks.push_back(newTrack);
         }
 
-        // 清理過期追蹤（超過 15 幀未出現）
-        for (auto it = m_yoloTracks.begin(); it != m_yoloTracks.end();)
-        {
-            if (m_currentFrameCount - it->second.lastFrame > 15)
-            {
-                it = m_yoloTracks.erase(it);
-            }
-            else
-            {
-                ++it;
-            }
-        }
+        // 清理過期追蹤（超過 15 幀未出現；穩定移除，保持 trackId 遞增順序）
+        m_yoloTracks.erase(
+            std::remove_if(m_yoloTracks.begin(), m_yoloTracks.end(),
+                           [this](const YoloTrack &track)
+                           {
+                               return m_currentFrameCount - track.lastFrame > 15;
+                           }),
+            m_yoloTracks.end());
     }
 
     bool DetectionController::loadYoloModel(const QString &modelPath)
     {
-        if (!m_yoloDetector)
+        if (!m_yoloDetector && !m_yoloPool)
         {
             return false;
         }
 
-        bool success = m_yoloDetector->loadModel(modelPath.toStdString());
-        emit yoloModelLoaded(success);
+        const bool success = loadYoloModelNow(modelPath);
+        finishYoloModelLoad(modelPath, success);
+        return success;
+    }
 
-        if (success)
+    void DetectionController::loadYoloModelAsync(const QString &modelPath)
+    {
+        if (!m_yoloDetector && !m_yoloPool)
         {
-            // 更新配置
-            auto &config = Settings::instance();
-            config.yolo().modelPath = modelPath;
-            qDebug() << "[DetectionController] YOLO 模型已載入:" << modelPath;
+            emit yoloModelLoaded(false);
+            return;
+        }
+        if (m_yoloLoading.exchange(true))
+        {
+            qWarning() << "[DetectionController] YOLO 模型載入中，忽略:" << modelPath;
+            return;
+        }
+        if (m_yoloLoadThread.joinable())
+        {
+            m_yoloLoadThread.join(); // 上一次載入已結束（m_yoloLoading 已清除）
+        }
+
+        emit yoloModelLoading(modelPath);
+        m_yoloLoadThread = std::thread([this, modelPath]()
+                                       {
+                                           setCurrentThreadName("YoloLoad");
+                                           const bool success = loadYoloModelNow(modelPath);
+                                           m_yoloLoading = false;
+                                           // 配置更新與信號回到本物件所在線程（物件已解構時不執行）
+                                           QMetaObject::invokeMethod(this, [this, modelPath, success]()
+                                                                     { finishYoloModelLoad(modelPath, success); },
+                                                                     Qt::QueuedConnection);
+                                       });
+    }
+
+    void DetectionController::loadConfiguredYoloModel(bool async)
+    {
+        // 延遲載入：傳統模式用不到模型，切換到 YOLO / 自動模式時才載入
+        const QString modelPath = Settings::instance().yolo().modelPath;
+        if (m_detectionMode == DetectionMode::Classical || modelPath.isEmpty() ||
+            m_yoloLoading || isYoloModelLoaded())
+        {
+            return;
+        }
+        if (async)
+        {
+            loadYoloModelAsync(modelPath);
+        }
+        else
+        {
+            loadYoloModel(modelPath);
         }
+    }
 
+    bool DetectionController::loadYoloModelNow(const QString &modelPath)
+    {
+        QElapsedTimer timer;
+        timer.start();
+        const bool success = m_yoloPool ? m_yoloPool->loadModel(modelPath.toStdString())
+                                        : m_yoloDetector->loadModel(modelPath.toStdString());
+        qDebug() << "[DetectionController] YOLO 模型" << (success ? "已載入（含暖機）:" : "載入失敗:") << modelPath
+                 << "，耗時" << timer.elapsed() << "ms";
         return success;
     }
 
+    void DetectionController::finishYoloModelLoad(const QString &modelPath, bool success)
+    {
+        if (success)
+        {
+            // 更新配置
+            Settings::instance().yolo().modelPath = modelPath;
+        }
+        emit yoloModelLoaded(success);
+    }
+
     void DetectionController::setDetectionMode(DetectionMode mode)
     {
         if (m_detectionMode != mode)
@@ -1476,6 +2751,7 @@ namespace basler
             m_detectionMode = mode;
             emit detectionModeChanged(mode);
             qDebug() << "[DetectionController] 偵測模式切換:" << static_cast<int>(mode);
+            loadConfiguredYoloModel(); // 離開傳統模式時才背景載入配置中的模型
         }
     }
 
@@ -1485,6 +2761,11 @@ namespace basler
         {
             m_yoloDetector->setConfidenceThreshold(threshold);
         }
+        else if (m_yoloPool)
+        {
+            m_yoloPool->configure([=](YoloDetector &detector)
+                                  { detector.setConfidenceThreshold(threshold); });
+        }
     }
 
     void DetectionController::setYoloNmsThreshold(double threshold)
@@ -1493,6 +2774,11 @@ namespace basler
         {
             m_yoloDetector->setNmsThreshold(threshold);
         }
+        else if (m_yoloPool)
+        {
+            m_yoloPool->configure([=](YoloDetector &detector)
+                                  { detector.setNmsThreshold(threshold); });
+        }
     }
 
     void DetectionController::setYoloRoiUpscale(double factor)
@@ -1501,6 +2787,11 @@ namespace basler
         {
             m_yoloDetector->setRoiUpscaleFactor(factor);
         }
+        else if (m_yoloPool)
+        {
+            m_yoloPool->configure([=](YoloDetector &detector)
+                                  { detector.setRoiUpscaleFactor(factor); });
+        }
     }
 
 } // namespace basler
@@ -0,0 +1,105 @@
+#include "core/detection_kernels.h"
+#include <opencv2/core/hal/intrin.hpp>
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <numeric>
+
+namespace basler
+{
+
+    namespace
+    {
+        /**
+         * @brief 單軸對齊：縮放幀 [start, start + length) 外擴到 q 的倍數
+         *
+         * 原始 / 縮放長度約分為 p / q 後，縮放座標為 q 的倍數處正好對應整數原始像素 (× p / q)，
+         * 從該處裁切再以相同比例縮放，每個輸出像素的取樣位置與整幀縮放相同。
+         * 縮放長度本身是 q 的倍數，最壞情況外擴到整軸（等同整幀縮放），因此一定能對齊。
+         */
+        void alignSpan(int origLen, int scaledLen, int start, int length,
+                       int &dstStart, int &dstLen, int &srcStart, int &srcLen)
+        {
+            const int g = std::gcd(origLen, scaledLen);
+            const int p = origLen / g;
+            const int q = scaledLen / g;
+            const int dstEnd = std::min(scaledLen, (start + length + q - 1) / q * q);
+            dstStart = start / q * q;
+            dstLen = dstEnd - dstStart;
+            srcStart = dstStart / q * p;
+            srcLen = dstLen / q * p;
+        }
+    }
+
+    void fuseTripleMask(const cv::Mat &fg, const cv::Mat &edges, const cv::Mat &adaptive, cv::Mat &out)
+    {
+        CV_Assert(fg.type() == CV_8UC1 && edges.type() == CV_8UC1 && adaptive.type() == CV_8UC1);
+        CV_Assert(fg.size() == edges.size() && fg.size() == adaptive.size());
+
+        out.create(fg.size(), CV_8UC1);
+
+        int rows = fg.rows;
+        int cols = fg.cols;
+        if (fg.isContinuous() && edges.isContinuous() && adaptive.isContinuous() && out.isContinuous())
+        {
+            cols *= rows;
+            rows = 1;
+        }
+
+        for (int y = 0; y < rows; ++y)
+        {
+            const uchar *f = fg.ptr<uchar>(y);
+            const uchar *e = edges.ptr<uchar>(y);
+            const uchar *a = adaptive.ptr<uchar>(y);
+            uchar *o = out.ptr<uchar>(y);
+
+            int x = 0;
+#if CV_SIMD128
+            const cv::v_uint8x16 vZero = cv::v_setzero_u8();
+            const cv::v_uint8x16 vEdgeThresh = cv::v_setall_u8(1);
+            const cv::v_uint8x16 vAdaptiveThresh = cv::v_setall_u8(127);
+            for (; x <= cols - 16; x += 16)
+            {
+                const cv::v_uint8x16 vf = cv::v_load(f + x);
+                const cv::v_uint8x16 ve = cv::v_load(e + x);
+                const cv::v_uint8x16 va = cv::v_load(a + x);
+
+                // 比較結果為 0x00 / 0xFF 遮罩，正好對應 threshold 的 0 / 255 輸出
+                const cv::v_uint8x16 extra = (ve > vEdgeThresh) | (va > vAdaptiveThresh);
+                cv::v_store(o + x, vf | ((vf != vZero) & extra));
+            }
+#endif
+            for (; x < cols; ++x)
+            {
+                const uchar fv = f[x];
+                const uchar extra = (e[x] > 1 || a[x] > 127) ? 255 : 0;
+                o[x] = fv | (fv ? extra : 0);
+            }
+        }
+    }
+
+    void resizeRegion(const cv::Mat &frame, const cv::Size &scaledSize, const cv::Rect &region, int margin,
+                      cv::Mat &buffer, cv::Mat &out)
+    {
+        CV_Assert(region.x >= 0 && region.y >= 0 && region.width > 0 && region.height > 0 &&
+                  region.x + region.width <= scaledSize.width && region.y + region.height <= scaledSize.height);
+
+        if (scaledSize == frame.size())
+        {
+            out = frame(region); // 不縮放：直接取 ROI 視圖
+            return;
+        }
+
+        // 外擴 margin（裁到縮放幀內）後對齊：濾波讀到的 ROI 外像素與整幀縮放後取子矩陣時相同，
+        // 緩衝邊緣不足 margin 處必為縮放幀邊緣（邊界外插與整幀時一致）
+        const cv::Rect padded = cv::Rect(region.x - margin, region.y - margin,
+                                         region.width + 2 * margin, region.height + 2 * margin) &
+                                cv::Rect(cv::Point(0, 0), scaledSize);
+        int dstX, dstW, srcX, srcW;
+        int dstY, dstH, srcY, srcH;
+        alignSpan(frame.cols, scaledSize.width, padded.x, padded.width, dstX, dstW, srcX, srcW);
+        alignSpan(frame.rows, scaledSize.height, padded.y, padded.height, dstY, dstH, srcY, srcH);
+        cv::resize(frame(cv::Rect(srcX, srcY, srcW, srcH)), buffer, cv::Size(dstW, dstH), 0, 0, cv::INTER_LINEAR);
+        out = buffer(cv::Rect(region.x - dstX, region.y - dstY, region.width, region.height));
+    }
+
+} // namespace basler
@@ -0,0 +1,183 @@
+#include "core/detection_worker.h"
+#include "config/settings.h"
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QMutexLocker>
+#include <algorithm>
+
+namespace basler
+{
+
+    DetectionWorker::DetectionWorker(DetectionController *controller, FrameRing *ring, QObject *parent)
+        : QObject(parent), m_controller(controller), m_ring(ring)
+    {
+    }
+
+    void DetectionWorker::run()
+    {
+        if (m_running.load() || !m_controller || !m_ring)
+        {
+            return;
+        }
+
+        // 無損計數模式：生產者等待檢測讀完，檢測依序處理每一幀
+        const bool lossless = Settings::instance().camera().losslessCounting;
+        m_consumerId = m_ring->registerConsumer("detection", lossless);
+        if (m_consumerId < 0)
+        {
+            qWarning() << "[DetectionWorker] 無法註冊 FrameRing 消費者，檢測線程未啟動";
+            return;
+        }
+
+        const PerformanceConfig &perf = Settings::instance().performance();
+        QualityGovernor::Config governorConfig;
+        governorConfig.enabled = perf.adaptiveQuality;
+        governorConfig.degradeLoad = perf.governorDegradeLoad;
+        governorConfig.restoreLoad = perf.governorRestoreLoad;
+        governorConfig.backlogFrames = perf.governorBacklogFrames;
+        m_governor.configure(governorConfig);
+        m_governor.reset();
+        m_controller->setQualityLevel(QualityLevel::Full);
+
+        m_running.store(true);
+        qDebug() << "[DetectionWorker] 檢測循環開始" << (lossless ? "（無損計數）" : "");
+
+        quint64 reportedDrops = 0;
+        int pendingSkips = 0;
+        bool skipIgnoredWarned = false;
+        FrameMeta meta;
+        while (m_running.load())
+        {
+            if (!m_ring->waitForFrame(m_consumerId, 50))
+            {
+                continue;
+            }
+
+            // 降頻：每處理一幀後略過 skipFrames 幀（不複製、不計丟幀）
+            if (pendingSkips > 0 && m_ring->skipFrame(m_consumerId))
+            {
+                pendingSkips--;
+                continue;
+            }
+
+            // 檢測停用時只跟上最新位置（不複製、不計丟幀）
+            if (!m_controller->isEnabled())
+            {
+                m_ring->skipToLatest(m_consumerId);
+                continue;
+            }
+
+            if (!m_ring->read(m_consumerId, m_frame, meta))
+            {
+                continue;
+            }
+
+            processFrame(m_frame, meta);
+
+            // 無損計數必須逐幀處理完整序列：略過的幀不計丟幀，會讓計數靜默漏掉
+            const int skipFrames = std::max(0, Settings::instance().performance().skipFrames);
+            if (lossless && skipFrames > 0 && !skipIgnoredWarned)
+            {
+                qWarning() << "[DetectionWorker] 無損計數模式忽略 skipFrames =" << skipFrames;
+                skipIgnoredWarned = true;
+            }
+            pendingSkips = lossless ? 0 : skipFrames;
+
+            quint64 drops = m_ring->droppedFrames(m_consumerId);
+            if (drops >= reportedDrops + 100 || (reportedDrops == 0 && drops > 0))
+            {
+                qWarning() << "[DetectionWorker] 檢測跟不上輸入幀率，累計丟幀:" << drops;
+                reportedDrops = drops;
+            }
+        }
+
+        m_ring->unregisterConsumer(m_consumerId);
+        m_consumerId = -1;
+        qDebug() << "[DetectionWorker] 檢測循環結束，已處理" << m_processedFrames.load() << "幀";
+    }
+
+    void DetectionWorker::stop()
+    {
+        m_running.store(false);
+    }
+
+    void DetectionWorker::processFrame(const cv::Mat &frame, const FrameMeta &meta)
+    {
+        QElapsedTimer timer;
+        timer.start();
+
+        DetectionResult result;
+        if (Settings::instance().performance().overlayAsData)
+        {
+            m_controller->processFrame(frame, result.objects, result.overlay, nullptr, meta.window);
+        }
+        else
+        {
+            m_controller->processFrame(frame, result.objects, result.overlay, &result.annotatedFrame, meta.window);
+
+            // 未燒入（失敗或 NoOverlay 降級）時顯示原始幀；frame 是下一次讀取會覆寫的緩衝，需複製
+            if (result.annotatedFrame.empty())
+            {
+                result.annotatedFrame = frame.clone();
+            }
+        }
+
+        result.sequence = meta.sequence;
+        result.timestampUs = meta.timestampUs;
+        result.count = m_controller->count();
+        result.frameWidth = frame.cols;
+        result.processingMs = timer.nsecsElapsed() / 1e6;
+        m_processedFrames++;
+        m_lastProcessingMs.store(result.processingMs, std::memory_order_relaxed);
+
+        updateQuality(result.processingMs, meta);
+
+        QMutexLocker locker(&m_resultMutex);
+        m_latestResult = std::move(result);
+        m_hasNewResult = true;
+    }
+
+    void DetectionWorker::updateQuality(double processingMs, const FrameMeta &meta)
+    {
+        const quint64 latest = m_ring->latestSequence();
+        const quint64 backlog = latest > meta.sequence ? latest - meta.sequence : 0;
+        m_backlogFrames.store(backlog, std::memory_order_relaxed);
+        if (!m_governor.update(processingMs, backlog, m_sourceFps.load(std::memory_order_relaxed)))
+        {
+            return;
+        }
+
+        const QualityLevel level = m_governor.level();
+        m_controller->setQualityLevel(level);
+        const QString description = QString::fromUtf8(qualityLevelDescription(level));
+        qWarning() << "[DetectionWorker] 品質等級 →" << static_cast<int>(level) << description
+                   << "負載:" << m_governor.load() << "落後:" << backlog << "幀";
+        emit qualityLevelChanged(static_cast<int>(level), description);
+    }
+
+    bool DetectionWorker::takeLatestResult(DetectionResult &result)
+    {
+        QMutexLocker locker(&m_resultMutex);
+        if (!m_hasNewResult)
+        {
+            return false;
+        }
+        result = m_latestResult;
+        m_hasNewResult = false;
+        return true;
+    }
+
+    void DetectionWorker::clearLatestResult()
+    {
+        QMutexLocker locker(&m_resultMutex);
+        m_latestResult = DetectionResult();
+        m_hasNewResult = false;
+    }
+
+    quint64 DetectionWorker::droppedFrames() const
+    {
+        int consumerId = m_consumerId.load();
+        return (m_ring && consumerId >= 0) ? m_ring->droppedFrames(consumerId) : 0;
+    }
+
+} // namespace basler
@@ -0,0 +1,279 @@
+#include "core/event_recorder.h"
+#include "core/thread_affinity.h"
+#include "core/thread_scheduling.h"
+#include "core/video_recorder.h"
+#include "config/settings.h"
+#include <QDateTime>
+#include <QDebug>
+#include <QSize>
+#include <algorithm>
+#include <opencv2/imgcodecs.hpp>
+
+namespace basler {
+
+const char* eventTriggerTag(EventTrigger trigger)
+{
+    switch (trigger) {
+    case EventTrigger::Manual:
+        return "manual";
+    case EventTrigger::GateBurst:
+        return "gate_burst";
+    case EventTrigger::PackagingMismatch:
+        return "count_mismatch";
+    case EventTrigger::QualityDegrade:
+        return "degraded";
+    }
+    return "event";
+}
+
+EventRecorder::EventRecorder(FrameRing* ring, QObject* parent)
+    : QObject(parent)
+    , m_ring(ring)
+{
+    qRegisterMetaType<EventTrigger>("basler::EventTrigger");
+}
+
+EventRecorder::~EventRecorder()
+{
+    stop();
+}
+
+bool EventRecorder::start()
+{
+    if (m_running.load()) {
+        return true;
+    }
+
+    const DebugConfig& config = Settings::instance().debug();
+    if (!config.eventRecordingEnabled || !m_ring) {
+        return false;
+    }
+
+    m_consumerId = m_ring->registerConsumer("event_recording");
+    if (m_consumerId < 0) {
+        qWarning() << "[EventRecorder] 無法註冊 FrameRing 消費者，事件錄影未啟動";
+        return false;
+    }
+
+    m_preTriggerUs = static_cast<qint64>(std::max(0.0, config.preTriggerSeconds) * 1e6);
+    m_postTriggerUs = static_cast<qint64>(std::max(0.0, config.postTriggerSeconds) * 1e6);
+    m_maxBufferBytes = static_cast<size_t>(std::max(1, config.maxBufferMegabytes)) * 1024 * 1024;
+    m_jpegParams = {cv::IMWRITE_JPEG_QUALITY, std::clamp(config.jpegQuality, 10, 100)};
+
+    // 片段用獨立的錄影器：佇列無損，預觸發幀一次排入時等待錄影線程而不丟幀
+    m_writer = std::make_unique<VideoRecorder>(config.eventRecordingDir);
+    m_writer->setLossless(true);
+    connect(m_writer.get(), &VideoRecorder::recordingError, this, &EventRecorder::eventError);
+
+    {
+        std::lock_guard<std::mutex> lock(m_triggerMutex);
+        m_triggerPending = false;
+    }
+    m_gateCrossingsMs.clear();
+    m_running.store(true);
+    m_thread = std::thread(&EventRecorder::captureLoop, this);
+
+    qDebug() << "[EventRecorder] 啟動: 預觸發" << config.preTriggerSeconds << "秒, 後觸發"
+             << config.postTriggerSeconds << "秒, 緩衝上限" << config.maxBufferMegabytes << "MB";
+    return true;
+}
+
+void EventRecorder::stop()
+{
+    if (!m_running.exchange(false)) {
+        return;
+    }
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+    if (m_consumerId >= 0) {
+        m_ring->unregisterConsumer(m_consumerId);
+        m_consumerId = -1;
+    }
+    clearBuffer();
+    m_spareJpeg.clear();
+    m_writer.reset();
+
+    qDebug() << "[EventRecorder] 已停止";
+}
+
+void EventRecorder::trigger(EventTrigger trigger, const QString& detail)
+{
+    if (!m_running.load()) {
+        return;
+    }
+
+    const QString tag = eventTriggerTag(trigger);
+    {
+        std::lock_guard<std::mutex> lock(m_triggerMutex);
+        m_triggerPending = true;
+        m_pendingReason = detail.isEmpty() ? tag : QString("%1: %2").arg(tag, detail);
+        m_pendingTag = tag;
+    }
+    qDebug() << "[EventRecorder] 觸發事件:" << tag << detail;
+}
+
+void EventRecorder::noteGateCrossing()
+{
+    const DebugConfig& config = Settings::instance().debug();
+    if (!m_running.load() || config.gateBurstCount <= 0) {
+        return;
+    }
+
+    const qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
+    m_gateCrossingsMs.push_back(nowMs);
+    while (!m_gateCrossingsMs.empty() && nowMs - m_gateCrossingsMs.front() > config.gateBurstWindowMs) {
+        m_gateCrossingsMs.pop_front();
+    }
+
+    if (static_cast<int>(m_gateCrossingsMs.size()) >= config.gateBurstCount) {
+        const int burst = static_cast<int>(m_gateCrossingsMs.size());
+        m_gateCrossingsMs.clear();
+        trigger(EventTrigger::GateBurst, QString("%1 次 / %2 ms").arg(burst).arg(config.gateBurstWindowMs));
+    }
+}
+
+void EventRecorder::captureLoop()
+{
+    setCurrentThreadName("EventRecorder");
+    applyThreadScheduling(ThreadRole::Recording);
+    cv::Mat frame;
+    FrameMeta meta;
+
+    while (m_running.load()) {
+        if (!m_ring->waitForFrame(m_consumerId, 50) || !m_ring->read(m_consumerId, frame, meta)) {
+            continue;
+        }
+
+        QString reason;
+        QString tag;
+        bool triggered = false;
+        {
+            std::lock_guard<std::mutex> lock(m_triggerMutex);
+            if (m_triggerPending) {
+                m_triggerPending = false;
+                triggered = true;
+                reason = m_pendingReason;
+                tag = m_pendingTag;
+            }
+        }
+
+        if (triggered) {
+            if (m_capturing.load()) {
+                m_postUntilUs = meta.timestampUs + m_postTriggerUs;
+                qDebug() << "[EventRecorder] 片段延長:" << reason;
+            } else {
+                beginEvent(frame, meta, reason, tag);
+            }
+        }
+
+        if (m_capturing.load()) {
+            // 後觸發幀不壓縮，直接交換緩衝排入錄影線程
+            m_writer->enqueueFrame(frame, meta);
+            if (meta.timestampUs >= m_postUntilUs) {
+                finishEvent();
+            }
+        } else {
+            bufferFrame(frame, meta);
+        }
+    }
+
+    if (m_capturing.load()) {
+        finishEvent();
+    }
+}
+
+void EventRecorder::bufferFrame(const cv::Mat& frame, const FrameMeta& meta)
+{
+    if (frame.empty()) {
+        return;
+    }
+
+    BufferedFrame buffered;
+    if (!m_spareJpeg.empty()) {
+        buffered.jpeg = std::move(m_spareJpeg.back());
+        m_spareJpeg.pop_back();
+    }
+    if (!cv::imencode(".jpg", frame, buffered.jpeg, m_jpegParams)) {
+        return;
+    }
+    buffered.meta = meta;
+    m_bufferBytes += buffered.jpeg.size();
+    m_buffer.push_back(std::move(buffered));
+
+    // 淘汰超出時間窗口或記憶體上限的最舊幀（至少保留最新一幀）
+    while (m_buffer.size() > 1 &&
+           (meta.timestampUs - m_buffer.front().meta.timestampUs > m_preTriggerUs || m_bufferBytes > m_maxBufferBytes)) {
+        m_bufferBytes -= m_buffer.front().jpeg.size();
+        if (m_spareJpeg.size() < 4) {
+            m_spareJpeg.push_back(std::move(m_buffer.front().jpeg));
+        }
+        m_buffer.pop_front();
+    }
+
+    m_bufferedUs.store(meta.timestampUs - m_buffer.front().meta.timestampUs);
+    m_bufferedFrames.store(static_cast<int>(m_buffer.size()));
+}
+
+double EventRecorder::bufferFps() const
+{
+    if (m_buffer.size() < 2) {
+        return 30.0;
+    }
+    const qint64 spanUs = m_buffer.back().meta.timestampUs - m_buffer.front().meta.timestampUs;
+    return spanUs > 0 ? (m_buffer.size() - 1) * 1e6 / spanUs : 30.0;
+}
+
+void EventRecorder::beginEvent(const cv::Mat& frame, const FrameMeta& meta, const QString& reason, const QString& tag)
+{
+    const QString filename = QString("event_%1_%2")
+                                 .arg(QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss_zzz"), tag);
+    if (!m_writer->startRecording(QSize(frame.cols, frame.rows), bufferFps(), filename, frame.channels() != 1)) {
+        qWarning() << "[EventRecorder] 無法開始事件片段:" << reason;
+        return;
+    }
+
+    m_capturing.store(true);
+    m_postUntilUs = meta.timestampUs + m_postTriggerUs;
+    m_eventPath = m_writer->currentInfo().fullPath;
+    emit eventStarted(reason, m_eventPath);
+
+    // 預觸發幀依序解碼排入（尺寸不同的舊幀略過，例如觸發前剛切換過 AOI）
+    m_eventPreFrames = 0;
+    cv::Mat decoded;
+    for (BufferedFrame& buffered : m_buffer) {
+        cv::imdecode(buffered.jpeg, cv::IMREAD_UNCHANGED, &decoded);
+        if (decoded.size() == frame.size() && decoded.type() == frame.type() &&
+            m_writer->enqueueFrame(decoded, buffered.meta)) {
+            ++m_eventPreFrames;
+        }
+    }
+    clearBuffer();
+
+    qDebug() << "[EventRecorder] 事件片段開始:" << reason << "," << m_eventPreFrames << "預觸發幀 →" << m_eventPath;
+}
+
+void EventRecorder::finishEvent()
+{
+    const RecordingInfo info = m_writer->stopRecording();
+    m_capturing.store(false);
+    emit eventSaved(m_eventPath, info.framesRecorded, m_eventPreFrames);
+
+    qDebug() << "[EventRecorder] 事件片段完成:" << m_eventPath << "," << info.framesRecorded << "幀";
+}
+
+void EventRecorder::clearBuffer()
+{
+    for (BufferedFrame& buffered : m_buffer) {
+        if (m_spareJpeg.size() >= 4) {
+            break;
+        }
+        m_spareJpeg.push_back(std::move(buffered.jpeg));
+    }
+    m_buffer.clear();
+    m_bufferBytes = 0;
+    m_bufferedUs.store(0);
+    m_bufferedFrames.store(0);
+}
+
+} // namespace basler
@@ -0,0 +1,152 @@
+#include "core/flow_rate_estimator.h"
+#include "core/detection_controller.h" // for VibratorSpeed enum
+#include <algorithm>
+#include <cmath>
+
+namespace basler
+{
+
+    namespace
+    {
+        // 檔位由快到慢
+        constexpr std::array<VibratorSpeed, FlowRateEstimator::LEVELS> LEVEL_SPEEDS = {
+            VibratorSpeed::FULL, VibratorSpeed::MEDIUM, VibratorSpeed::SLOW, VibratorSpeed::CREEP};
+
+        constexpr int CREEP_LEVEL = FlowRateEstimator::LEVELS - 1;
+    } // namespace
+
+    int FlowRateEstimator::levelOf(VibratorSpeed speed)
+    {
+        for (int i = 0; i < LEVELS; ++i)
+        {
+            if (LEVEL_SPEEDS[i] == speed)
+            {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    void FlowRateEstimator::configure(double alpha, int settleMs, int minSamples)
+    {
+        m_alpha = std::clamp(alpha, 0.01, 1.0);
+        m_settleNs = static_cast<int64_t>(std::max(0, settleMs)) * 1000000;
+        m_minSamples = std::max(1, minSamples);
+    }
+
+    void FlowRateEstimator::setSpeed(VibratorSpeed speed, int64_t timestampNs)
+    {
+        const int level = levelOf(speed);
+        if (level == m_level)
+        {
+            return;
+        }
+        m_level = level;
+        m_levelSinceNs = timestampNs;
+    }
+
+    void FlowRateEstimator::recordCrossing(int64_t timestampNs)
+    {
+        // 兩筆計數都在同一檔位、且都在流量穩定之後，間隔才代表該檔位的速率
+        const bool settled = m_level >= 0 && m_lastCrossingLevel == m_level && m_lastCrossingNs > 0 &&
+                             m_lastCrossingNs >= m_levelSinceNs + m_settleNs && timestampNs > m_lastCrossingNs;
+        if (settled)
+        {
+            const double intervalSec = (timestampNs - m_lastCrossingNs) / 1e9;
+            double &ewma = m_intervalSec[m_level];
+            ewma = (m_samples[m_level] == 0) ? intervalSec : ewma + m_alpha * (intervalSec - ewma);
+            m_samples[m_level]++;
+        }
+
+        m_lastCrossingNs = timestampNs;
+        m_lastCrossingLevel = m_level;
+    }
+
+    void FlowRateEstimator::resetRun()
+    {
+        m_lastCrossingNs = 0;
+        m_lastCrossingLevel = -1;
+    }
+
+    void FlowRateEstimator::clear()
+    {
+        m_intervalSec.fill(0.0);
+        m_samples.fill(0);
+        m_level = -1;
+        m_levelSinceNs = 0;
+        resetRun();
+    }
+
+    double FlowRateEstimator::rate(VibratorSpeed speed) const
+    {
+        const int level = levelOf(speed);
+        if (level < 0)
+        {
+            return 0.0;
+        }
+
+        for (int known = level; known >= 0; --known)
+        {
+            if (m_samples[known] >= m_minSamples && m_intervalSec[known] > 0.0)
+            {
+                const double measured = 1.0 / m_intervalSec[known];
+                return measured * static_cast<int>(speed) / static_cast<int>(LEVEL_SPEEDS[known]);
+            }
+        }
+        return 0.0;
+    }
+
+    bool FlowRateEstimator::ready() const
+    {
+        return m_samples[0] >= m_minSamples && m_intervalSec[0] > 0.0;
+    }
+
+    int FlowRateEstimator::samples(VibratorSpeed speed) const
+    {
+        const int level = levelOf(speed);
+        return level < 0 ? 0 : m_samples[level];
+    }
+
+    PredictiveSpeedPlan predictiveSpeedFor(const FlowRateEstimator &estimator, int count, int target,
+                                           int creepReserve, double leadSec, double safetyFactor)
+    {
+        const double remaining = std::max(0, target - count);
+        const double reserve = std::max(0, creepReserve);
+        const double lead = std::max(0.0, leadSec) * std::max(1.0, safetyFactor);
+
+        std::array<double, FlowRateEstimator::LEVELS> rates{};
+        std::array<double, FlowRateEstimator::LEVELS> switchAt{}; // 剩餘數降到此值即須離開該檔位
+        for (int i = 0; i < FlowRateEstimator::LEVELS; ++i)
+        {
+            rates[i] = estimator.rate(LEVEL_SPEEDS[i]);
+            switchAt[i] = (i == CREEP_LEVEL) ? 0.0 : rates[i] * lead + reserve;
+        }
+
+        int chosen = CREEP_LEVEL;
+        for (int i = 0; i < CREEP_LEVEL; ++i)
+        {
+            if (rates[i] > 0.0 && remaining > switchAt[i])
+            {
+                chosen = i;
+                break;
+            }
+        }
+
+        // 預估剩餘時間：依序在各檔位落到切換點，最後以 CREEP 完成
+        PredictiveSpeedPlan plan;
+        plan.speed = LEVEL_SPEEDS[chosen];
+        double left = remaining;
+        for (int i = chosen; i < FlowRateEstimator::LEVELS && left > 0.0; ++i)
+        {
+            if (rates[i] <= 0.0)
+            {
+                continue;
+            }
+            const double atLevel = (i == CREEP_LEVEL) ? left : std::max(0.0, left - std::floor(switchAt[i]));
+            plan.timeToTargetSec += atLevel / rates[i];
+            left -= atLevel;
+        }
+        return plan;
+    }
+
+} // namespace basler
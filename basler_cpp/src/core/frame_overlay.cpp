@@ -0,0 +1,94 @@
+#include "core/frame_overlay.h"
+#include <cstdio>
+#include <string>
+#include <opencv2/imgproc.hpp>
+
+namespace basler {
+
+void burnInOverlay(cv::Mat& frame, const FrameOverlay& overlay)
+{
+    // 繪製 ROI 區域
+    if (!overlay.roi.isEmpty()) {
+        const QRect& roi = overlay.roi;
+        cv::rectangle(frame,
+                      cv::Point(roi.x(), roi.y()),
+                      cv::Point(roi.x() + roi.width(), roi.y() + roi.height()),
+                      cv::Scalar(255, 255, 0), 2);
+    }
+
+    // 繪製虛擬光柵線
+    if (overlay.showGateLine) {
+        cv::line(frame,
+                 cv::Point(0, overlay.gateLineY),
+                 cv::Point(overlay.frameWidth, overlay.gateLineY),
+                 cv::Scalar(0, 0, 255), 3);
+
+        std::string gateText = "GATE LINE (Y=" + std::to_string(overlay.gateLineY) + ")";
+        cv::putText(frame, gateText,
+                    cv::Point(10, overlay.gateLineY - 10),
+                    cv::FONT_HERSHEY_SIMPLEX, 0.6, cv::Scalar(0, 0, 255), 2);
+    }
+
+    // 多料道：各料道 ROI 與光柵線（光柵線只橫跨該料道）
+    for (const auto& lane : overlay.lanes) {
+        const QRect& roi = lane.roi;
+        cv::rectangle(frame,
+                      cv::Point(roi.x(), roi.y()),
+                      cv::Point(roi.x() + roi.width(), roi.y() + roi.height()),
+                      cv::Scalar(255, 255, 0), 2);
+        if (lane.gateLineY > 0) {
+            cv::line(frame,
+                     cv::Point(roi.x(), lane.gateLineY),
+                     cv::Point(roi.x() + roi.width(), lane.gateLineY),
+                     cv::Scalar(0, 0, 255), 3);
+        }
+
+        std::string laneText = std::to_string(lane.counted);
+        if (lane.targetCount > 0) {
+            laneText += "/" + std::to_string(lane.targetCount);
+        }
+        cv::putText(frame, laneText,
+                    cv::Point(roi.x() + 4, roi.y() - 6),
+                    cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(255, 255, 0), 1);
+    }
+
+    // 繪製檢測到的物件
+    for (const auto& box : overlay.boxes) {
+        cv::Scalar boxColor = box.crossed
+                                  ? cv::Scalar(0, 255, 255) // 黃色：已穿越
+                                  : cv::Scalar(0, 255, 0);  // 綠色：未穿越
+
+        cv::rectangle(frame,
+                      cv::Point(box.rect.x(), box.rect.y()),
+                      cv::Point(box.rect.x() + box.rect.width(), box.rect.y() + box.rect.height()),
+                      boxColor, 2);
+
+        cv::circle(frame, cv::Point(box.center.x(), box.center.y()), 3, cv::Scalar(255, 0, 0), -1);
+
+        cv::putText(frame, std::to_string(box.area),
+                    cv::Point(box.rect.x(), box.rect.y() - 10),
+                    cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(255, 255, 255), 1);
+    }
+
+    // 顯示統計信息
+    if (!overlay.mode.isEmpty()) {
+        std::string infoText = "[" + overlay.mode.toStdString() + "] Detections: " +
+                               std::to_string(overlay.detections) +
+                               " | Counted: " + std::to_string(overlay.counted) +
+                               " | Gate: Y=" + std::to_string(overlay.gateLineY);
+        cv::putText(frame, infoText,
+                    cv::Point(10, 30),
+                    cv::FONT_HERSHEY_SIMPLEX, 0.6, cv::Scalar(0, 255, 255), 2);
+    }
+
+    // YOLO 模式顯示推理時間
+    if (overlay.yoloInferenceMs >= 0.0) {
+        char timeStr[64];
+        snprintf(timeStr, sizeof(timeStr), "YOLO: %.1f ms", overlay.yoloInferenceMs);
+        cv::putText(frame, timeStr,
+                    cv::Point(10, 55),
+                    cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(0, 200, 255), 1);
+    }
+}
+
+} // namespace basler
@@ -0,0 +1,547 @@
+#include "core/frame_ring.h"
+#include <QDebug>
+#include <QMutexLocker>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+namespace basler
+{
+
+    FrameRing::FrameRing(int capacity)
+        : m_capacity(std::max(2, capacity)), m_slots(new Slot[std::max(2, capacity)])
+    {
+        m_deferredReleases.reserve(m_capacity);
+        qDebug() << "[FrameRing] 初始化完成，容量:" << m_capacity;
+    }
+
+    // ============================================================================
+    // 生產者
+    // ============================================================================
+
+    quint64 FrameRing::publish(const cv::Mat &frame, qint64 timestampUs, quint64 blockId,
+                               quint64 deviceTimestamp, float exposureUs, const SensorWindow &window)
+    {
+        if (frame.empty())
+        {
+            return 0;
+        }
+
+        const quint64 sequence = m_head.load(std::memory_order_relaxed) + 1;
+        Slot &slot = m_slots[sequence % m_capacity];
+        const quint64 version = beginWrite(slot);
+
+        const size_t rowBytes = frame.cols * frame.elemSize();
+        const size_t totalBytes = rowBytes * frame.rows;
+        uchar *dst = ensureStorage(slot, totalBytes);
+        if (frame.isContinuous())
+        {
+            std::memcpy(dst, frame.data, totalBytes);
+        }
+        else
+        {
+            for (int y = 0; y < frame.rows; ++y)
+            {
+                std::memcpy(dst + y * rowBytes, frame.ptr(y), rowBytes);
+            }
+        }
+
+        // 槽位改回自有緩衝，原本的零拷貝引用（若有）交給延遲釋放
+        cv::Mat previous = std::move(slot.shared);
+        commitWrite(slot, version, FrameMeta{sequence, timestampUs, blockId, deviceTimestamp, exposureUs, window},
+                    frame.rows, frame.cols, frame.type(), dst, rowBytes);
+        m_head.store(sequence, std::memory_order_release);
+
+        releaseShared(std::move(previous));
+        return sequence;
+    }
+
+    quint64 FrameRing::publishShared(const cv::Mat &frame, qint64 timestampUs, quint64 blockId,
+                                     quint64 deviceTimestamp, float exposureUs, const SensorWindow &window)
+    {
+        if (frame.empty())
+        {
+            return 0;
+        }
+
+        const quint64 sequence = m_head.load(std::memory_order_relaxed) + 1;
+        Slot &slot = m_slots[sequence % m_capacity];
+        const quint64 version = beginWrite(slot);
+
+        cv::Mat previous = std::move(slot.shared);
+        slot.shared = frame;
+        commitWrite(slot, version, FrameMeta{sequence, timestampUs, blockId, deviceTimestamp, exposureUs, window},
+                    frame.rows, frame.cols, frame.type(), frame.data, frame.step[0]);
+        m_head.store(sequence, std::memory_order_release);
+
+        releaseShared(std::move(previous));
+        return sequence;
+    }
+
+    bool FrameRing::waitForSpace(int timeoutMs) const
+    {
+        // 發布序號 s 後，消費者可安全讀取的最舊序號是 s + 2 - capacity（見 read()），
+        // 因此無損消費者的游標 cursor 必須滿足 cursor + capacity >= s + 2
+        const quint64 cap = static_cast<quint64>(m_capacity);
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+        while (true)
+        {
+            const quint64 next = m_head.load(std::memory_order_relaxed) + 1;
+            bool hasSpace = true;
+            for (const Consumer &consumer : m_consumers)
+            {
+                if (consumer.active.load(std::memory_order_acquire) &&
+                    consumer.lossless.load(std::memory_order_relaxed) &&
+                    consumer.cursor.load(std::memory_order_acquire) + cap < next + 2)
+                {
+                    hasSpace = false;
+                    break;
+                }
+            }
+            if (hasSpace)
+            {
+                return true;
+            }
+            if (std::chrono::steady_clock::now() >= deadline)
+            {
+                return false;
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    }
+
+    void FrameRing::reserve(int rows, int cols, int type)
+    {
+        if (rows <= 0 || cols <= 0)
+        {
+            return;
+        }
+
+        const size_t totalBytes = static_cast<size_t>(rows) * cols * CV_ELEM_SIZE(type);
+        for (int i = 0; i < m_capacity; ++i)
+        {
+            // 只換掉緩衝本身，槽位內容不變，不需要進入寫入狀態
+            Slot &slot = m_slots[i];
+            if (slot.storage.size() < totalBytes)
+            {
+                if (!slot.storage.empty())
+                {
+                    m_retiredStorage.push_back(std::move(slot.storage));
+                }
+                slot.storage = std::vector<uchar>(totalBytes);
+            }
+        }
+        qDebug() << "[FrameRing] 預配置" << m_capacity << "個槽位，每槽" << totalBytes << "bytes";
+    }
+
+    void FrameRing::detachSharedFrames()
+    {
+        int detached = 0;
+        for (int i = 0; i < m_capacity; ++i)
+        {
+            Slot &slot = m_slots[i];
+            if (slot.shared.empty())
+            {
+                continue;
+            }
+
+            const quint64 version = beginWrite(slot);
+            const cv::Mat &src = slot.shared;
+            const size_t rowBytes = src.cols * src.elemSize();
+            uchar *dst = ensureStorage(slot, rowBytes * src.rows);
+            for (int y = 0; y < src.rows; ++y)
+            {
+                std::memcpy(dst + y * rowBytes, src.ptr(y), rowBytes);
+            }
+
+            const FrameMeta meta{slot.sequence.load(std::memory_order_relaxed),
+                                 slot.timestampUs.load(std::memory_order_relaxed),
+                                 slot.blockId.load(std::memory_order_relaxed),
+                                 slot.deviceTimestamp.load(std::memory_order_relaxed),
+                                 slot.exposureUs.load(std::memory_order_relaxed),
+                                 SensorWindow{slot.windowOffsetX.load(std::memory_order_relaxed),
+                                              slot.windowOffsetY.load(std::memory_order_relaxed),
+                                              slot.sensorWidth.load(std::memory_order_relaxed),
+                                              slot.sensorHeight.load(std::memory_order_relaxed)}};
+            commitWrite(slot, version, meta, src.rows, src.cols, src.type(), dst, rowBytes);
+            m_deferredReleases.push_back(std::move(slot.shared));
+            detached++;
+        }
+
+        // 來源緩衝即將真正釋放，必須等所有進行中的讀取結束
+        waitForReaders();
+        m_deferredReleases.clear();
+        dropRetiredStorage();
+
+        if (detached > 0)
+        {
+            qDebug() << "[FrameRing] 已釋放" << detached << "個零拷貝引用";
+        }
+    }
+
+    quint64 FrameRing::beginWrite(Slot &slot)
+    {
+        // seqlock 進入寫入狀態（版本號變為奇數）
+        const quint64 version = slot.version.load(std::memory_order_relaxed);
+        slot.version.store(version + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        return version;
+    }
+
+    void FrameRing::commitWrite(Slot &slot, quint64 version, const FrameMeta &meta,
+                                int rows, int cols, int type, uchar *data, size_t step)
+    {
+        slot.rows.store(rows, std::memory_order_relaxed);
+        slot.cols.store(cols, std::memory_order_relaxed);
+        slot.type.store(type, std::memory_order_relaxed);
+        slot.step.store(step, std::memory_order_relaxed);
+        slot.data.store(data, std::memory_order_relaxed);
+        slot.sequence.store(meta.sequence, std::memory_order_relaxed);
+        slot.timestampUs.store(meta.timestampUs, std::memory_order_relaxed);
+        slot.blockId.store(meta.blockId, std::memory_order_relaxed);
+        slot.deviceTimestamp.store(meta.deviceTimestamp, std::memory_order_relaxed);
+        slot.exposureUs.store(meta.exposureUs, std::memory_order_relaxed);
+        slot.windowOffsetX.store(meta.window.offsetX, std::memory_order_relaxed);
+        slot.windowOffsetY.store(meta.window.offsetY, std::memory_order_relaxed);
+        slot.sensorWidth.store(meta.window.sensorWidth, std::memory_order_relaxed);
+        slot.sensorHeight.store(meta.window.sensorHeight, std::memory_order_relaxed);
+
+        // 寫入完成（版本號回到偶數）
+        slot.version.store(version + 2, std::memory_order_release);
+    }
+
+    uchar *FrameRing::ensureStorage(Slot &slot, size_t totalBytes)
+    {
+        // 只在需要擴容時重新配置，舊緩衝保留給可能仍在讀取的消費者
+        if (slot.storage.size() < totalBytes)
+        {
+            if (!slot.storage.empty())
+            {
+                m_retiredStorage.push_back(std::move(slot.storage));
+            }
+            slot.storage = std::vector<uchar>(totalBytes);
+        }
+        return slot.storage.data();
+    }
+
+    void FrameRing::releaseShared(cv::Mat &&frame)
+    {
+        // 與 copySlot 的讀者計數構成配對：此處看不到的讀者，必然已讀到新的 data 指標
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_activeReaders.load(std::memory_order_seq_cst) == 0)
+        {
+            m_deferredReleases.clear();
+            frame.release();
+            dropRetiredStorage();
+        }
+        else if (!frame.empty())
+        {
+            m_deferredReleases.push_back(std::move(frame));
+
+            // 延遲數量有上限：來源緩衝池（Pylon）有限，持續累積會讓生產者無緩衝可用。
+            // 單次讀取只是一次 memcpy，短暫等待即可
+            if (static_cast<int>(m_deferredReleases.size()) > MAX_DEFERRED_RELEASES)
+            {
+                waitForReaders();
+                m_deferredReleases.clear();
+                dropRetiredStorage();
+            }
+        }
+    }
+
+    void FrameRing::dropRetiredStorage()
+    {
+        // 呼叫端保證沒有進行中的讀取；之後開始的讀取只會讀到槽位目前的 data 指標。
+        // reserve() 換掉緩衝但尚未覆寫的槽位仍指向舊緩衝，這些保留到該槽位下一次寫入
+        if (m_retiredStorage.empty())
+        {
+            return;
+        }
+
+        auto referenced = [this](const std::vector<uchar> &buffer)
+        {
+            for (int i = 0; i < m_capacity; ++i)
+            {
+                if (m_slots[i].data.load(std::memory_order_relaxed) == buffer.data())
+                {
+                    return true;
+                }
+            }
+            return false;
+        };
+        m_retiredStorage.erase(std::remove_if(m_retiredStorage.begin(), m_retiredStorage.end(),
+                                              [&referenced](const std::vector<uchar> &buffer)
+                                              { return !referenced(buffer); }),
+                               m_retiredStorage.end());
+    }
+
+    void FrameRing::waitForReaders() const
+    {
+        while (m_activeReaders.load(std::memory_order_seq_cst) != 0)
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    qint64 FrameRing::steadyTimestampUs()
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+
+    // ============================================================================
+    // 消費者
+    // ============================================================================
+
+    int FrameRing::registerConsumer(const QString &name, bool lossless)
+    {
+        QMutexLocker locker(&m_registryMutex);
+        for (int i = 0; i < MAX_CONSUMERS; ++i)
+        {
+            Consumer &consumer = m_consumers[i];
+            if (!consumer.active.load())
+            {
+                consumer.name = name;
+                consumer.cursor.store(m_head.load(std::memory_order_acquire) + 1);
+                consumer.dropped.store(0);
+                consumer.consumed.store(0);
+                consumer.lossless.store(lossless);
+                consumer.active.store(true);
+                qDebug() << "[FrameRing] 註冊消費者" << i << ":" << name << (lossless ? "（無損）" : "");
+                return i;
+            }
+        }
+        qWarning() << "[FrameRing] 消費者槽位已滿，無法註冊:" << name;
+        return -1;
+    }
+
+    void FrameRing::unregisterConsumer(int consumerId)
+    {
+        if (!isValidConsumer(consumerId))
+        {
+            return;
+        }
+        QMutexLocker locker(&m_registryMutex);
+        Consumer &consumer = m_consumers[consumerId];
+        qDebug() << "[FrameRing] 註銷消費者" << consumerId << ":" << consumer.name
+                 << ", 已讀:" << consumer.consumed.load()
+                 << ", 丟幀:" << consumer.dropped.load();
+        consumer.active.store(false);
+    }
+
+    bool FrameRing::read(int consumerId, cv::Mat &out, FrameMeta &meta)
+    {
+        if (!isValidConsumer(consumerId))
+        {
+            return false;
+        }
+
+        Consumer &consumer = m_consumers[consumerId];
+
+        // 讀取期間被覆寫時重新定位後再試，最多數次
+        for (int attempt = 0; attempt < 4; ++attempt)
+        {
+            const quint64 head = m_head.load(std::memory_order_acquire);
+            quint64 next = consumer.cursor.load(std::memory_order_relaxed);
+            if (next > head)
+            {
+                return false;
+            }
+
+            // 生產者下一次寫入會覆寫 (head + 1 - capacity)，因此最舊可安全讀取的是 head + 2 - capacity
+            const quint64 cap = static_cast<quint64>(m_capacity);
+            const quint64 oldest = (head + 2 > cap) ? head + 2 - cap : 1;
+            if (next < oldest)
+            {
+                consumer.dropped.fetch_add(oldest - next, std::memory_order_relaxed);
+                next = oldest;
+            }
+
+            if (copySlot(next, out, meta))
+            {
+                consumer.cursor.store(next + 1, std::memory_order_release);
+                consumer.consumed.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+
+            // 該幀在複製途中被覆寫，計為丟幀
+            consumer.dropped.fetch_add(1, std::memory_order_relaxed);
+            consumer.cursor.store(next + 1, std::memory_order_release);
+        }
+        return false;
+    }
+
+    bool FrameRing::waitForFrame(int consumerId, int timeoutMs) const
+    {
+        if (!isValidConsumer(consumerId))
+        {
+            return false;
+        }
+
+        const Consumer &consumer = m_consumers[consumerId];
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+        while (m_head.load(std::memory_order_acquire) < consumer.cursor.load(std::memory_order_relaxed))
+        {
+            if (std::chrono::steady_clock::now() >= deadline)
+            {
+                return false;
+            }
+            // 100µs 輪詢：相對 300fps 的 3.3ms 幀間隔足夠即時，且不需要生產者端喚醒（無鎖）
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+        return true;
+    }
+
+    void FrameRing::skipToLatest(int consumerId)
+    {
+        if (!isValidConsumer(consumerId))
+        {
+            return;
+        }
+        m_consumers[consumerId].cursor.store(m_head.load(std::memory_order_acquire) + 1,
+                                             std::memory_order_release);
+    }
+
+    bool FrameRing::skipFrame(int consumerId)
+    {
+        if (!isValidConsumer(consumerId))
+        {
+            return false;
+        }
+        Consumer &consumer = m_consumers[consumerId];
+        const quint64 next = consumer.cursor.load(std::memory_order_relaxed);
+        if (next > m_head.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+        consumer.cursor.store(next + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool FrameRing::readLatest(cv::Mat &out, FrameMeta &meta, quint64 afterSequence) const
+    {
+        for (int attempt = 0; attempt < 4; ++attempt)
+        {
+            const quint64 head = m_head.load(std::memory_order_acquire);
+            if (head == 0 || head <= afterSequence)
+            {
+                return false;
+            }
+            if (copySlot(head, out, meta))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool FrameRing::copySlot(quint64 sequence, cv::Mat &out, FrameMeta &meta) const
+    {
+        // 讀者計數：生產者據此判斷被覆寫的零拷貝引用能否立即釋放
+        struct ReaderGuard
+        {
+            std::atomic<int> &readers;
+            explicit ReaderGuard(std::atomic<int> &r) : readers(r)
+            {
+                readers.fetch_add(1, std::memory_order_seq_cst);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+            }
+            ~ReaderGuard() { readers.fetch_sub(1, std::memory_order_release); }
+        } guard(m_activeReaders);
+
+        const Slot &slot = m_slots[sequence % m_capacity];
+
+        const quint64 begin = slot.version.load(std::memory_order_acquire);
+        if ((begin & 1) != 0 || slot.sequence.load(std::memory_order_relaxed) != sequence)
+        {
+            return false;
+        }
+
+        const int rows = slot.rows.load(std::memory_order_relaxed);
+        const int cols = slot.cols.load(std::memory_order_relaxed);
+        const int type = slot.type.load(std::memory_order_relaxed);
+        const size_t step = slot.step.load(std::memory_order_relaxed);
+        const uchar *data = slot.data.load(std::memory_order_relaxed);
+        const qint64 timestampUs = slot.timestampUs.load(std::memory_order_relaxed);
+        const quint64 blockId = slot.blockId.load(std::memory_order_relaxed);
+        const quint64 deviceTimestamp = slot.deviceTimestamp.load(std::memory_order_relaxed);
+        const float exposureUs = slot.exposureUs.load(std::memory_order_relaxed);
+        const SensorWindow window{slot.windowOffsetX.load(std::memory_order_relaxed),
+                                  slot.windowOffsetY.load(std::memory_order_relaxed),
+                                  slot.sensorWidth.load(std::memory_order_relaxed),
+                                  slot.sensorHeight.load(std::memory_order_relaxed)};
+
+        // 先確認標頭一致，才能安全地依 rows/cols 複製像素
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.version.load(std::memory_order_relaxed) != begin || !data)
+        {
+            return false;
+        }
+
+        out.create(rows, cols, type);
+        const size_t rowBytes = cols * CV_ELEM_SIZE(type);
+        if (out.isContinuous() && step == rowBytes)
+        {
+            std::memcpy(out.data, data, rowBytes * rows);
+        }
+        else
+        {
+            for (int y = 0; y < rows; ++y)
+            {
+                std::memcpy(out.ptr(y), data + y * step, rowBytes);
+            }
+        }
+
+        // 複製期間若被覆寫，版本號會改變
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.version.load(std::memory_order_relaxed) != begin)
+        {
+            return false;
+        }
+
+        meta.sequence = sequence;
+        meta.timestampUs = timestampUs;
+        meta.blockId = blockId;
+        meta.deviceTimestamp = deviceTimestamp;
+        meta.exposureUs = exposureUs;
+        meta.window = window;
+        return true;
+    }
+
+    // ============================================================================
+    // 統計
+    // ============================================================================
+
+    quint64 FrameRing::droppedFrames(int consumerId) const
+    {
+        return isValidConsumer(consumerId) ? m_consumers[consumerId].dropped.load() : 0;
+    }
+
+    quint64 FrameRing::consumedFrames(int consumerId) const
+    {
+        return isValidConsumer(consumerId) ? m_consumers[consumerId].consumed.load() : 0;
+    }
+
+    QString FrameRing::consumerName(int consumerId) const
+    {
+        if (!isValidConsumer(consumerId))
+        {
+            return QString();
+        }
+        QMutexLocker locker(&m_registryMutex);
+        return m_consumers[consumerId].name;
+    }
+
+    bool FrameRing::isConsumerActive(int consumerId) const
+    {
+        return isValidConsumer(consumerId) && m_consumers[consumerId].active.load();
+    }
+
+    bool FrameRing::isValidConsumer(int consumerId) const
+    {
+        return consumerId >= 0 && consumerId < MAX_CONSUMERS;
+    }
+
+} // namespace basler
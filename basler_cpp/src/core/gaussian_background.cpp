@@ -0,0 +1,156 @@
+#include "core/gaussian_background.h"
+#include <opencv2/core/hal/intrin.hpp>
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <cmath>
+
+namespace basler
+{
+
+    namespace
+    {
+        constexpr int RATE_SHIFT = 15;
+        constexpr int RATE_ONE = 1 << RATE_SHIFT;
+        constexpr int RATE_ROUND = 1 << (RATE_SHIFT - 1);
+
+        // 單列更新：mean / var 為 Q8.8，rate 為 Q0.15
+        // 溢位上界：|mean 差| <= 65280、|var 差| <= 65535，乘以 rate <= 32768 仍 < 2^31
+        // Learn = false（learningRate = 0）：只輸出遮罩，模型完全凍結
+        template <bool Learn>
+        void updateRow(const uchar *src, ushort *mean, ushort *var, uchar *mask, int cols,
+                       int thresholdQ8, int rate)
+        {
+            const int varMin = GaussianBackgroundSubtractor::VAR_MIN << 8;
+            const int varMax = GaussianBackgroundSubtractor::VAR_MAX << 8;
+
+            int x = 0;
+#if CV_SIMD128
+            const cv::v_int32x4 vRate = cv::v_setall_s32(rate);
+            const cv::v_int32x4 vRound = cv::v_setall_s32(RATE_ROUND);
+            const cv::v_int32x4 vHalf = cv::v_setall_s32(128);
+            const cv::v_int32x4 vThreshold = cv::v_setall_s32(thresholdQ8);
+            const cv::v_int32x4 vVarMin = cv::v_setall_s32(varMin);
+            const cv::v_int32x4 vVarMax = cv::v_setall_s32(varMax);
+            const cv::v_int32x4 vD2Max = cv::v_setall_s32(65535);
+            const cv::v_int32x4 vFg = cv::v_setall_s32(255);
+            const cv::v_int32x4 vZero = cv::v_setzero_s32();
+
+            auto step = [&](const uchar *s, ushort *m, ushort *v) -> cv::v_int32x4
+            {
+                const cv::v_int32x4 p = cv::v_reinterpret_as_s32(cv::v_load_expand_q(s));
+                cv::v_int32x4 mu = cv::v_reinterpret_as_s32(cv::v_load_expand(m));
+                cv::v_int32x4 sigma2 = cv::v_reinterpret_as_s32(cv::v_load_expand(v));
+
+                const cv::v_int32x4 diff = p - ((mu + vHalf) >> 8); // 整數灰階差
+                const cv::v_int32x4 d2 = diff * diff;
+                const cv::v_int32x4 fg = (d2 << 8) > ((vThreshold * sigma2) >> 8);
+
+                if constexpr (Learn)
+                {
+                    mu = mu + ((((p << 8) - mu) * vRate + vRound) >> RATE_SHIFT);
+                    const cv::v_int32x4 d2q = cv::v_min(d2 << 8, vD2Max);
+                    sigma2 = sigma2 + (((d2q - sigma2) * vRate + vRound) >> RATE_SHIFT);
+                    sigma2 = cv::v_min(cv::v_max(sigma2, vVarMin), vVarMax);
+
+                    cv::v_pack_store(m, cv::v_reinterpret_as_u32(mu));
+                    cv::v_pack_store(v, cv::v_reinterpret_as_u32(sigma2));
+                }
+                return cv::v_select(fg, vFg, vZero);
+            };
+
+            for (; x <= cols - 8; x += 8)
+            {
+                const cv::v_int32x4 lo = step(src + x, mean + x, var + x);
+                const cv::v_int32x4 hi = step(src + x + 4, mean + x + 4, var + x + 4);
+                cv::v_pack_u_store(mask + x, cv::v_pack(lo, hi));
+            }
+#endif
+            for (; x < cols; ++x)
+            {
+                const int p = src[x];
+                int mu = mean[x];
+                int sigma2 = var[x];
+
+                const int diff = p - ((mu + 128) >> 8);
+                const int d2 = diff * diff;
+                mask[x] = (d2 << 8) > ((thresholdQ8 * sigma2) >> 8) ? 255 : 0;
+                if constexpr (!Learn)
+                {
+                    continue;
+                }
+
+                mu += (((p << 8) - mu) * rate + RATE_ROUND) >> RATE_SHIFT;
+                const int d2q = std::min(d2 << 8, 65535);
+                sigma2 += ((d2q - sigma2) * rate + RATE_ROUND) >> RATE_SHIFT;
+                sigma2 = std::clamp(sigma2, varMin, varMax);
+
+                mean[x] = static_cast<ushort>(mu);
+                var[x] = static_cast<ushort>(sigma2);
+            }
+        }
+    }
+
+    GaussianBackgroundSubtractor::GaussianBackgroundSubtractor(int history, double varThreshold)
+        : m_history(std::max(1, history)),
+          m_thresholdQ8(std::clamp(static_cast<int>(std::lround(varThreshold * 256.0)), 0, 100 << 8))
+    {
+    }
+
+    void GaussianBackgroundSubtractor::initialize(const cv::Mat &gray)
+    {
+        gray.convertTo(m_mean, CV_16U, 256.0);
+        m_var.create(gray.size(), CV_16UC1);
+        m_var.setTo(cv::Scalar(VAR_INIT << 8));
+    }
+
+    void GaussianBackgroundSubtractor::apply(cv::InputArray image, cv::OutputArray fgmask, double learningRate)
+    {
+        cv::Mat input = image.getMat();
+        CV_Assert(input.depth() == CV_8U && !input.empty());
+
+        if (input.channels() != 1)
+        {
+            cv::cvtColor(input, m_gray, input.channels() == 4 ? cv::COLOR_BGRA2GRAY : cv::COLOR_BGR2GRAY);
+            input = m_gray;
+        }
+
+        fgmask.create(input.size(), CV_8UC1);
+        cv::Mat mask = fgmask.getMat();
+
+        if (m_mean.size() != input.size())
+        {
+            initialize(input);
+            mask.setTo(cv::Scalar(0));
+            return;
+        }
+
+        // learningRate = 0 凍結模型（與 MOG2 相同）；正值至少 1/32768，避免定點捨入成 0
+        const double alpha = learningRate < 0 ? 1.0 / m_history : std::min(learningRate, 1.0);
+        const int rate = alpha > 0.0 ? std::clamp(static_cast<int>(std::lround(alpha * RATE_ONE)), 1, RATE_ONE) : 0;
+
+        for (int y = 0; y < input.rows; ++y)
+        {
+            if (rate > 0)
+            {
+                updateRow<true>(input.ptr<uchar>(y), m_mean.ptr<ushort>(y), m_var.ptr<ushort>(y),
+                                mask.ptr<uchar>(y), input.cols, m_thresholdQ8, rate);
+            }
+            else
+            {
+                updateRow<false>(input.ptr<uchar>(y), m_mean.ptr<ushort>(y), m_var.ptr<ushort>(y),
+                                 mask.ptr<uchar>(y), input.cols, m_thresholdQ8, rate);
+            }
+        }
+    }
+
+    void GaussianBackgroundSubtractor::getBackgroundImage(cv::OutputArray backgroundImage) const
+    {
+        m_mean.convertTo(backgroundImage, CV_8U, 1.0 / 256.0);
+    }
+
+    cv::Ptr<GaussianBackgroundSubtractor> createGaussianBackgroundSubtractor(int history, double varThreshold)
+    {
+        return cv::makePtr<GaussianBackgroundSubtractor>(history, varThreshold);
+    }
+
+} // namespace basler
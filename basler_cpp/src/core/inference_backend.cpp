@@ -0,0 +1,344 @@
+#include "core/inference_backend.h"
+#include <opencv2/dnn.hpp>
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+
+#ifdef HAVE_ONNXRUNTIME
+#include <onnxruntime_cxx_api.h>
+#endif
+
+#ifdef HAVE_OPENVINO
+#include <openvino/openvino.hpp>
+#endif
+
+namespace basler
+{
+
+    namespace
+    {
+        std::string toLower(std::string text)
+        {
+            std::transform(text.begin(), text.end(), text.begin(),
+                           [](unsigned char c)
+                           { return static_cast<char>(std::tolower(c)); });
+            return text;
+        }
+
+#ifdef HAVE_OPENVINO
+        std::string toUpper(std::string text)
+        {
+            std::transform(text.begin(), text.end(), text.begin(),
+                           [](unsigned char c)
+                           { return static_cast<char>(std::toupper(c)); });
+            return text;
+        }
+#endif
+
+        // 外部 tensor 包成 cv::Mat（維度為 int）
+        template <typename Dims>
+        cv::Mat wrapTensor(const Dims &shape, float *data)
+        {
+            std::vector<int> sizes(shape.begin(), shape.end());
+            return cv::Mat(static_cast<int>(sizes.size()), sizes.data(), CV_32F, data);
+        }
+
+        // ===== OpenCV DNN =====
+
+        class OpenCvDnnBackend : public InferenceBackend
+        {
+        public:
+            const char *name() const override { return "opencv"; }
+
+            bool load(const std::string &modelPath, const std::string &device,
+                      ModelPrecision precision) override
+            {
+                try
+                {
+                    m_net = cv::dnn::readNetFromONNX(modelPath);
+                    m_outputNames = m_net.getUnconnectedOutLayersNames();
+
+                    // 優先使用 CUDA，fallback 到 CPU
+                    // INT8（QDQ）只有 OpenCV CPU 後端支援；FP16 在 CUDA 上使用半精度目標
+                    bool useCuda = device != "cpu" && precision != ModelPrecision::INT8;
+                    if (useCuda)
+                    {
+                        try
+                        {
+                            m_net.setPreferableBackend(cv::dnn::DNN_BACKEND_CUDA);
+                            m_net.setPreferableTarget(precision == ModelPrecision::FP16
+                                                          ? cv::dnn::DNN_TARGET_CUDA_FP16
+                                                          : cv::dnn::DNN_TARGET_CUDA);
+                            std::cout << "[YoloDetector] 使用 CUDA 加速" << std::endl;
+                        }
+                        catch (...)
+                        {
+                            useCuda = false;
+                        }
+                    }
+                    if (!useCuda)
+                    {
+                        m_net.setPreferableBackend(cv::dnn::DNN_BACKEND_OPENCV);
+                        m_net.setPreferableTarget(cv::dnn::DNN_TARGET_CPU);
+                        std::cout << "[YoloDetector] CUDA 不可用，使用 CPU" << std::endl;
+                    }
+                    return true;
+                }
+                catch (const cv::Exception &e)
+                {
+                    std::cerr << "[YoloDetector] OpenCV DNN 載入失敗: " << e.what() << std::endl;
+                    return false;
+                }
+            }
+
+            void infer(const cv::Mat &blob, cv::Mat &output) override
+            {
+                m_net.setInput(blob);
+                m_net.forward(m_outputs, m_outputNames);
+                if (m_outputs.empty())
+                {
+                    throw std::runtime_error("OpenCV DNN forward returned no output");
+                }
+                output = m_outputs[0];
+            }
+
+        private:
+            cv::dnn::Net m_net;
+            std::vector<std::string> m_outputNames;
+            std::vector<cv::Mat> m_outputs;
+        };
+
+#ifdef HAVE_ONNXRUNTIME
+        // ===== ONNX Runtime =====
+
+        class OnnxRuntimeBackend : public InferenceBackend
+        {
+        public:
+            const char *name() const override { return "onnxruntime"; }
+
+            bool load(const std::string &modelPath, const std::string &device,
+                      ModelPrecision precision) override
+            {
+                try
+                {
+                    Ort::SessionOptions options;
+                    options.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_ALL);
+
+                    // 執行提供者：tensorrt → cuda → cpu，附加失敗即回退
+                    if (device == "tensorrt")
+                    {
+                        try
+                        {
+                            OrtTensorRTProviderOptions trt{};
+                            trt.trt_fp16_enable = 1;
+                            trt.trt_int8_enable = precision == ModelPrecision::INT8 ? 1 : 0; // QDQ 模型自帶量化尺度
+                            options.AppendExecutionProvider_TensorRT(trt);
+                            std::cout << "[YoloDetector] ONNX Runtime 使用 TensorRT" << std::endl;
+                        }
+                        catch (const Ort::Exception &e)
+                        {
+                            std::cerr << "[YoloDetector] TensorRT 不可用: " << e.what() << std::endl;
+                        }
+                    }
+                    if (device == "auto" || device == "cuda" || device == "tensorrt")
+                    {
+                        try
+                        {
+                            OrtCUDAProviderOptions cuda{};
+                            options.AppendExecutionProvider_CUDA(cuda);
+                            std::cout << "[YoloDetector] ONNX Runtime 使用 CUDA" << std::endl;
+                        }
+                        catch (const Ort::Exception &)
+                        {
+                            std::cout << "[YoloDetector] ONNX Runtime CUDA 不可用，使用 CPU" << std::endl;
+                        }
+                    }
+
+                    // Windows 的 ORTCHAR_T 為 wchar_t，以 filesystem::path 轉換
+                    const std::filesystem::path modelFile(modelPath);
+                    m_session = std::make_unique<Ort::Session>(m_env, modelFile.c_str(), options);
+
+                    Ort::AllocatorWithDefaultOptions allocator;
+                    m_inputName = m_session->GetInputNameAllocated(0, allocator).get();
+                    m_outputName = m_session->GetOutputNameAllocated(0, allocator).get();
+
+                    const auto inputShape = m_session->GetInputTypeInfo(0).GetTensorTypeAndShapeInfo().GetShape();
+                    m_dynamicBatch = !inputShape.empty() && inputShape[0] < 0;
+                    return true;
+                }
+                catch (const Ort::Exception &e)
+                {
+                    std::cerr << "[YoloDetector] ONNX Runtime 載入失敗: " << e.what() << std::endl;
+                    m_session.reset();
+                    return false;
+                }
+            }
+
+            bool supportsBatch() const override { return m_dynamicBatch; }
+
+            void infer(const cv::Mat &blob, cv::Mat &output) override
+            {
+                if (!m_session)
+                {
+                    throw std::runtime_error("ONNX Runtime session not loaded");
+                }
+
+                const std::array<int64_t, 4> shape = {blob.size[0], blob.size[1], blob.size[2], blob.size[3]};
+                Ort::Value input = Ort::Value::CreateTensor<float>(
+                    m_memoryInfo, const_cast<float *>(blob.ptr<float>()), blob.total(),
+                    shape.data(), shape.size());
+
+                const char *inputNames[] = {m_inputName.c_str()};
+                const char *outputNames[] = {m_outputName.c_str()};
+                m_outputs = m_session->Run(Ort::RunOptions{nullptr}, inputNames, &input, 1, outputNames, 1);
+
+                // 輸出由 m_outputs 持有，下一次 infer() 前有效
+                Ort::Value &result = m_outputs.front();
+                output = wrapTensor(result.GetTensorTypeAndShapeInfo().GetShape(),
+                                    result.GetTensorMutableData<float>());
+            }
+
+        private:
+            Ort::Env m_env{ORT_LOGGING_LEVEL_WARNING, "basler-yolo"};
+            Ort::MemoryInfo m_memoryInfo = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
+            std::unique_ptr<Ort::Session> m_session;
+            std::vector<Ort::Value> m_outputs;
+            std::string m_inputName;
+            std::string m_outputName;
+            bool m_dynamicBatch = false;
+        };
+#endif // HAVE_ONNXRUNTIME
+
+#ifdef HAVE_OPENVINO
+        // ===== OpenVINO =====
+
+        class OpenVinoBackend : public InferenceBackend
+        {
+        public:
+            const char *name() const override { return "openvino"; }
+
+            bool load(const std::string &modelPath, const std::string &device,
+                      ModelPrecision precision) override
+            {
+                try
+                {
+                    auto model = m_core.read_model(modelPath);
+                    m_dynamicBatch = model->input().get_partial_shape()[0].is_dynamic();
+
+                    // 裝置名稱：auto → AUTO（由 OpenVINO 自選 CPU / iGPU）
+                    // INT8（QDQ）由 OpenVINO 自動走低精度核心；FP16 模型在 CPU 上仍以 FP32 累加
+                    const std::string ovDevice = toUpper(device.empty() ? std::string("auto") : device);
+                    ov::AnyMap config = {ov::hint::performance_mode(ov::hint::PerformanceMode::LATENCY)};
+                    if (precision == ModelPrecision::FP16 && ovDevice == "GPU")
+                    {
+                        config.insert(ov::hint::inference_precision(ov::element::f16));
+                    }
+                    m_compiled = m_core.compile_model(model, ovDevice, config);
+                    m_request = m_compiled.create_infer_request();
+                    std::cout << "[YoloDetector] OpenVINO 使用裝置 " << ovDevice << std::endl;
+                    return true;
+                }
+                catch (const std::exception &e)
+                {
+                    std::cerr << "[YoloDetector] OpenVINO 載入失敗: " << e.what() << std::endl;
+                    return false;
+                }
+            }
+
+            bool supportsBatch() const override { return m_dynamicBatch; }
+
+            void infer(const cv::Mat &blob, cv::Mat &output) override
+            {
+                const ov::Shape shape = {static_cast<size_t>(blob.size[0]), static_cast<size_t>(blob.size[1]),
+                                         static_cast<size_t>(blob.size[2]), static_cast<size_t>(blob.size[3])};
+                ov::Tensor input(ov::element::f32, shape, const_cast<float *>(blob.ptr<float>()));
+                m_request.set_input_tensor(input);
+                m_request.infer();
+
+                // 輸出由 infer request 持有，下一次 infer() 前有效
+                ov::Tensor result = m_request.get_output_tensor();
+                output = wrapTensor(result.get_shape(), result.data<float>());
+            }
+
+        private:
+            ov::Core m_core;
+            ov::CompiledModel m_compiled;
+            ov::InferRequest m_request;
+            bool m_dynamicBatch = false;
+        };
+#endif // HAVE_OPENVINO
+    }
+
+    ModelPrecision detectModelPrecision(const std::string &modelPath)
+    {
+        const std::string stem = toLower(std::filesystem::path(modelPath).stem().string());
+        auto endsWith = [&stem](const char *suffix)
+        {
+            const std::string s(suffix);
+            return stem.size() >= s.size() && stem.compare(stem.size() - s.size(), s.size(), s) == 0;
+        };
+
+        if (endsWith(".int8") || endsWith("_int8"))
+        {
+            return ModelPrecision::INT8;
+        }
+        if (endsWith(".fp16") || endsWith("_fp16"))
+        {
+            return ModelPrecision::FP16;
+        }
+        return ModelPrecision::FP32;
+    }
+
+    const char *modelPrecisionName(ModelPrecision precision)
+    {
+        switch (precision)
+        {
+        case ModelPrecision::FP16:
+            return "fp16";
+        case ModelPrecision::INT8:
+            return "int8";
+        default:
+            return "fp32";
+        }
+    }
+
+    std::unique_ptr<InferenceBackend> createInferenceBackend(const std::string &name)
+    {
+        const std::string key = toLower(name);
+
+#ifdef HAVE_ONNXRUNTIME
+        if (key == "onnxruntime")
+        {
+            return std::make_unique<OnnxRuntimeBackend>();
+        }
+#endif
+#ifdef HAVE_OPENVINO
+        if (key == "openvino")
+        {
+            return std::make_unique<OpenVinoBackend>();
+        }
+#endif
+
+        if (!key.empty() && key != "opencv")
+        {
+            std::cerr << "[YoloDetector] 推理後端 " << name << " 未編譯進此版本，改用 opencv" << std::endl;
+        }
+        return std::make_unique<OpenCvDnnBackend>();
+    }
+
+    std::vector<std::string> availableInferenceBackends()
+    {
+        std::vector<std::string> names = {"opencv"};
+#ifdef HAVE_ONNXRUNTIME
+        names.push_back("onnxruntime");
+#endif
+#ifdef HAVE_OPENVINO
+        names.push_back("openvino");
+#endif
+        return names;
+    }
+
+} // namespace basler
@@ -0,0 +1,193 @@
+#include "core/letterbox_tensor.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace basler
+{
+
+    namespace
+    {
+        constexpr float PAD_VALUE = 114.0f / 255.0f;
+        constexpr float NORMALIZE = 1.0f / 255.0f;
+
+        // 內容區雙線性取樣，BGR → RGB + 正規化一次完成（CN = 來源通道數）
+        template <int CN>
+        void sampleContent(const cv::Mat &roi,
+                           const std::vector<int> &x0, const std::vector<int> &x1, const std::vector<float> &wx,
+                           const std::vector<int> &y0, const std::vector<int> &y1, const std::vector<float> &wy,
+                           float *red, float *green, float *blue, int stride)
+        {
+            const int width = static_cast<int>(x0.size());
+            const int height = static_cast<int>(y0.size());
+
+            for (int y = 0; y < height; ++y)
+            {
+                const uchar *row0 = roi.ptr<uchar>(y0[y]);
+                const uchar *row1 = roi.ptr<uchar>(y1[y]);
+                const float fy1 = wy[y];
+                const float fy0 = 1.0f - fy1;
+
+                float *dr = red + static_cast<size_t>(y) * stride;
+                float *dg = green + static_cast<size_t>(y) * stride;
+                float *db = blue + static_cast<size_t>(y) * stride;
+
+                for (int x = 0; x < width; ++x)
+                {
+                    const int i0 = x0[x] * CN;
+                    const int i1 = x1[x] * CN;
+                    const float fx1 = wx[x];
+                    const float fx0 = 1.0f - fx1;
+                    const float w00 = fy0 * fx0 * NORMALIZE;
+                    const float w01 = fy0 * fx1 * NORMALIZE;
+                    const float w10 = fy1 * fx0 * NORMALIZE;
+                    const float w11 = fy1 * fx1 * NORMALIZE;
+
+                    auto sample = [&](int c)
+                    {
+                        return w00 * row0[i0 + c] + w01 * row0[i1 + c] + w10 * row1[i0 + c] + w11 * row1[i1 + c];
+                    };
+
+                    if (CN == 1)
+                    {
+                        const float v = sample(0);
+                        dr[x] = v;
+                        dg[x] = v;
+                        db[x] = v;
+                    }
+                    else
+                    {
+                        dr[x] = sample(2);
+                        dg[x] = sample(1);
+                        db[x] = sample(0);
+                    }
+                }
+            }
+        }
+    }
+
+    void LetterboxTensor::reserve(int batch, int size)
+    {
+        batch = std::max(batch, 1);
+        if (size == m_size && batch <= m_batch)
+        {
+            return;
+        }
+
+        const int sizes[4] = {batch, 3, size, size};
+        if (size == m_size && !m_tensor.empty())
+        {
+            // 只增加批次數：保留已寫入的槽位（填充區不必重寫）
+            cv::Mat grown(4, sizes, CV_32F);
+            std::memcpy(grown.data, m_tensor.data, m_tensor.total() * sizeof(float));
+            m_tensor = grown;
+        }
+        else
+        {
+            m_tensor.create(4, sizes, CV_32F);
+            m_slots.clear();
+        }
+
+        m_batch = batch;
+        m_size = size;
+        m_slots.resize(batch);
+    }
+
+    LetterboxTensor::Geometry LetterboxTensor::fill(int slot, const cv::Mat &roi, double upscaleFactor)
+    {
+        CV_Assert(slot >= 0 && slot < m_batch && !roi.empty() && roi.depth() == CV_8U);
+        CV_Assert(roi.channels() == 1 || roi.channels() == 3 || roi.channels() == 4);
+
+        // 幾何與「先放大、再 letterbox」相同：ratio 以放大後尺寸計算
+        const double upscale = upscaleFactor > 1.0 ? upscaleFactor : 1.0;
+        const int upW = upscale > 1.0 ? cvRound(roi.cols * upscale) : roi.cols;
+        const int upH = upscale > 1.0 ? cvRound(roi.rows * upscale) : roi.rows;
+
+        Geometry geometry;
+        geometry.ratio = std::min(static_cast<double>(m_size) / upW, static_cast<double>(m_size) / upH);
+        geometry.contentWidth = std::max(1, static_cast<int>(upW * geometry.ratio));
+        geometry.contentHeight = std::max(1, static_cast<int>(upH * geometry.ratio));
+        geometry.padX = (m_size - geometry.contentWidth) / 2;
+        geometry.padY = (m_size - geometry.contentHeight) / 2;
+
+        // 填充區只在幾何改變時重寫
+        SlotState &state = m_slots[slot];
+        if (state.padX != geometry.padX || state.padY != geometry.padY ||
+            state.contentWidth != geometry.contentWidth || state.contentHeight != geometry.contentHeight)
+        {
+            float *begin = plane(slot, 0);
+            std::fill(begin, begin + static_cast<size_t>(3) * m_size * m_size, PAD_VALUE);
+            state.padX = geometry.padX;
+            state.padY = geometry.padY;
+            state.contentWidth = geometry.contentWidth;
+            state.contentHeight = geometry.contentHeight;
+        }
+
+        // 放大 × letterbox 合成為單一比例：內容區直接由 ROI 取樣
+        buildAxis(m_xTable, roi.cols, geometry.contentWidth);
+        buildAxis(m_yTable, roi.rows, geometry.contentHeight);
+
+        const size_t offset = static_cast<size_t>(geometry.padY) * m_size + geometry.padX;
+        float *red = plane(slot, 0) + offset;
+        float *green = plane(slot, 1) + offset;
+        float *blue = plane(slot, 2) + offset;
+
+        switch (roi.channels())
+        {
+        case 1:
+            sampleContent<1>(roi, m_xTable.index0, m_xTable.index1, m_xTable.weight,
+                             m_yTable.index0, m_yTable.index1, m_yTable.weight, red, green, blue, m_size);
+            break;
+        case 3:
+            sampleContent<3>(roi, m_xTable.index0, m_xTable.index1, m_xTable.weight,
+                             m_yTable.index0, m_yTable.index1, m_yTable.weight, red, green, blue, m_size);
+            break;
+        default:
+            sampleContent<4>(roi, m_xTable.index0, m_xTable.index1, m_xTable.weight,
+                             m_yTable.index0, m_yTable.index1, m_yTable.weight, red, green, blue, m_size);
+            break;
+        }
+
+        return geometry;
+    }
+
+    cv::Mat LetterboxTensor::view(int first, int count) const
+    {
+        CV_Assert(first >= 0 && count > 0 && first + count <= m_batch);
+        const int sizes[4] = {count, 3, m_size, m_size};
+        return cv::Mat(4, sizes, CV_32F, plane(first, 0));
+    }
+
+    void LetterboxTensor::buildAxis(AxisTable &table, int srcLength, int dstLength)
+    {
+        if (table.srcLength == srcLength && table.dstLength == dstLength)
+        {
+            return;
+        }
+
+        table.srcLength = srcLength;
+        table.dstLength = dstLength;
+        table.index0.resize(dstLength);
+        table.index1.resize(dstLength);
+        table.weight.resize(dstLength);
+
+        // 像素中心對齊（與 cv::resize INTER_LINEAR 相同的座標定義）
+        const double scale = static_cast<double>(srcLength) / dstLength;
+        for (int i = 0; i < dstLength; ++i)
+        {
+            double src = (i + 0.5) * scale - 0.5;
+            src = std::clamp(src, 0.0, static_cast<double>(srcLength - 1));
+            const int i0 = static_cast<int>(std::floor(src));
+            table.index0[i] = i0;
+            table.index1[i] = std::min(i0 + 1, srcLength - 1);
+            table.weight[i] = static_cast<float>(src - i0);
+        }
+    }
+
+    float *LetterboxTensor::plane(int slot, int channel) const
+    {
+        const size_t planeSize = static_cast<size_t>(m_size) * m_size;
+        return reinterpret_cast<float *>(m_tensor.data) + (static_cast<size_t>(slot) * 3 + channel) * planeSize;
+    }
+
+} // namespace basler
@@ -0,0 +1,502 @@
+#include "core/metrics_server.h"
+#include "core/thread_affinity.h"
+#include <QDebug>
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#endif
+
+namespace basler
+{
+
+    namespace
+    {
+#ifdef _WIN32
+        using SocketHandle = SOCKET;
+        const SocketHandle INVALID_HANDLE = INVALID_SOCKET;
+
+        void closeSocket(SocketHandle socket) { closesocket(socket); }
+        int pollSockets(pollfd *fds, int count, int timeoutMs) { return WSAPoll(fds, count, timeoutMs); }
+        void setSendTimeout(SocketHandle socket, int timeoutMs)
+        {
+            const DWORD timeout = static_cast<DWORD>(timeoutMs);
+            setsockopt(socket, SOL_SOCKET, SO_SNDTIMEO, reinterpret_cast<const char *>(&timeout), sizeof(timeout));
+        }
+        constexpr int SEND_FLAGS = 0;
+#else
+        using SocketHandle = int;
+        const SocketHandle INVALID_HANDLE = -1;
+
+        void closeSocket(SocketHandle socket) { ::close(socket); }
+        int pollSockets(pollfd *fds, int count, int timeoutMs) { return ::poll(fds, count, timeoutMs); }
+        void setSendTimeout(SocketHandle socket, int timeoutMs)
+        {
+            timeval timeout{};
+            timeout.tv_sec = timeoutMs / 1000;
+            timeout.tv_usec = (timeoutMs % 1000) * 1000;
+            setsockopt(socket, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        }
+#ifdef MSG_NOSIGNAL
+        constexpr int SEND_FLAGS = MSG_NOSIGNAL; // 對方提早關閉連線時不觸發 SIGPIPE
+#else
+        constexpr int SEND_FLAGS = 0;
+#endif
+#endif
+
+        constexpr int ACCEPT_POLL_MS = 200;    // stop() 的最長等待
+        constexpr int REQUEST_TIMEOUT_MS = 1000;
+        constexpr int SEND_TIMEOUT_MS = 2000;  // 整個回應的送出期限（對方不讀取時放棄連線）
+        constexpr size_t MAX_REQUEST_BYTES = 8192;
+
+        // 直方圖 le 邊界（秒）：涵蓋單一階段的數十微秒到整幀 / 推理的百毫秒級
+        constexpr double HISTOGRAM_BOUNDS[] = {0.00005, 0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005,
+                                               0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1.0};
+
+        std::string formatValue(double value)
+        {
+            char buffer[32];
+            std::snprintf(buffer, sizeof(buffer), "%.10g", value);
+            return buffer;
+        }
+
+        std::string escapeLabel(const std::string &value)
+        {
+            std::string escaped;
+            escaped.reserve(value.size());
+            for (const char c : value)
+            {
+                if (c == '\\' || c == '"')
+                {
+                    escaped += '\\';
+                    escaped += c;
+                }
+                else if (c == '\n')
+                {
+                    escaped += "\\n";
+                }
+                else
+                {
+                    escaped += c;
+                }
+            }
+            return escaped;
+        }
+
+        bool sendAll(SocketHandle socket, const std::string &data)
+        {
+            // 不讀取的抓取端不能卡住 serveLoop（stop() 會 join 它）：每次送出前等 POLLOUT 到期限為止，
+            // 單次 send 的阻塞另由 SO_SNDTIMEO 限制
+            const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(SEND_TIMEOUT_MS);
+            size_t sent = 0;
+            while (sent < data.size())
+            {
+                const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                           deadline - std::chrono::steady_clock::now())
+                                           .count();
+                pollfd fd{};
+                fd.fd = socket;
+                fd.events = POLLOUT;
+                if (remaining <= 0 || pollSockets(&fd, 1, static_cast<int>(remaining)) <= 0 ||
+                    !(fd.revents & POLLOUT))
+                {
+                    return false;
+                }
+                const auto n = ::send(socket, data.data() + sent, static_cast<int>(data.size() - sent), SEND_FLAGS);
+                if (n <= 0)
+                {
+                    return false;
+                }
+                sent += static_cast<size_t>(n);
+            }
+            return true;
+        }
+
+        std::string httpResponse(const char *status, const char *contentType, const std::string &body)
+        {
+            std::string response = std::string("HTTP/1.1 ") + status + "\r\n";
+            response += std::string("Content-Type: ") + contentType + "\r\n";
+            response += "Content-Length: " + std::to_string(body.size()) + "\r\n";
+            response += "Connection: close\r\n\r\n";
+            response += body;
+            return response;
+        }
+    } // namespace
+
+    // ===== MetricsWriter =====
+
+    MetricsWriter::Family &MetricsWriter::family(const std::string &name, const char *type, const std::string &help)
+    {
+        auto it = m_families.find(name);
+        if (it == m_families.end())
+        {
+            it = m_families.emplace(name, Family{type, help, {}}).first;
+            m_order.push_back(name);
+        }
+        return it->second;
+    }
+
+    std::string MetricsWriter::labelText(const MetricLabels &labels, const char *extraKey,
+                                         const std::string &extraValue) const
+    {
+        std::string text;
+        auto append = [&text](const std::string &key, const std::string &value)
+        {
+            text += text.empty() ? "{" : ",";
+            text += key + "=\"" + escapeLabel(value) + "\"";
+        };
+        for (const auto &label : m_common)
+        {
+            append(label.first, label.second);
+        }
+        for (const auto &label : labels)
+        {
+            append(label.first, label.second);
+        }
+        if (extraKey)
+        {
+            append(extraKey, extraValue);
+        }
+        if (!text.empty())
+        {
+            text += "}";
+        }
+        return text;
+    }
+
+    void MetricsWriter::gauge(const std::string &name, const std::string &help, const MetricLabels &labels,
+                              double value)
+    {
+        family(name, "gauge", help).lines.push_back(name + labelText(labels) + " " + formatValue(value));
+    }
+
+    void MetricsWriter::counter(const std::string &name, const std::string &help, const MetricLabels &labels,
+                                double value)
+    {
+        family(name, "counter", help).lines.push_back(name + "_total" + labelText(labels) + " " + formatValue(value));
+    }
+
+    void MetricsWriter::histogram(const std::string &name, const std::string &help, const MetricLabels &labels,
+                                  const LatencyHistogram &histogram)
+    {
+        Family &entry = family(name, "histogram", help);
+
+        // 對數桶以中點歸入 le 邊界（對數桶相對誤差 <= 12.5%）
+        uint64_t cumulative = 0;
+        int bucket = 0;
+        for (const double bound : HISTOGRAM_BOUNDS)
+        {
+            const double boundNs = bound * 1e9;
+            while (bucket < LatencyHistogram::BUCKETS &&
+                   LatencyHistogram::bucketLowerNs(bucket) + LatencyHistogram::bucketWidthNs(bucket) / 2.0 <= boundNs)
+            {
+                cumulative += histogram.counts[bucket];
+                ++bucket;
+            }
+            entry.lines.push_back(name + "_bucket" + labelText(labels, "le", formatValue(bound)) + " " +
+                                  std::to_string(cumulative));
+        }
+        entry.lines.push_back(name + "_bucket" + labelText(labels, "le", "+Inf") + " " +
+                              std::to_string(histogram.count));
+        entry.lines.push_back(name + "_count" + labelText(labels) + " " + std::to_string(histogram.count));
+        entry.lines.push_back(name + "_sum" + labelText(labels) + " " + formatValue(histogram.sumNs / 1e9));
+    }
+
+    std::string MetricsWriter::render(bool openMetrics) const
+    {
+        std::string text;
+        for (const auto &name : m_order)
+        {
+            const Family &entry = m_families.at(name);
+            // Prometheus 文字格式的 counter family 名稱需與樣本同名（含 _total）
+            const std::string familyName = (!openMetrics && entry.type == "counter") ? name + "_total" : name;
+            text += "# HELP " + familyName + " " + entry.help + "\n";
+            text += "# TYPE " + familyName + " " + entry.type + "\n";
+            for (const auto &line : entry.lines)
+            {
+                text += line;
+                text += "\n";
+            }
+        }
+        if (openMetrics)
+        {
+            text += "# EOF\n";
+        }
+        return text;
+    }
+
+    // ===== SeqlockHistogram =====
+
+    void SeqlockHistogram::publish(const LatencyHistogram &histogram)
+    {
+        const uint32_t version = m_version.load(std::memory_order_relaxed);
+        m_version.store(version + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        for (int i = 0; i < LatencyHistogram::BUCKETS; ++i)
+        {
+            m_counts[i].store(histogram.counts[i], std::memory_order_relaxed);
+        }
+        m_count.store(histogram.count, std::memory_order_relaxed);
+        m_sumNs.store(histogram.sumNs, std::memory_order_relaxed);
+        m_maxNs.store(histogram.maxNs, std::memory_order_relaxed);
+
+        m_version.store(version + 2, std::memory_order_release);
+    }
+
+    LatencyHistogram SeqlockHistogram::load() const
+    {
+        LatencyHistogram histogram;
+        for (;;)
+        {
+            const uint32_t before = m_version.load(std::memory_order_acquire);
+            if (before & 1)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+            for (int i = 0; i < LatencyHistogram::BUCKETS; ++i)
+            {
+                histogram.counts[i] = m_counts[i].load(std::memory_order_relaxed);
+            }
+            histogram.count = m_count.load(std::memory_order_relaxed);
+            histogram.sumNs = m_sumNs.load(std::memory_order_relaxed);
+            histogram.maxNs = m_maxNs.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (m_version.load(std::memory_order_relaxed) == before)
+            {
+                return histogram;
+            }
+        }
+    }
+
+    // ===== MetricsRegistry =====
+
+    MetricsRegistry &MetricsRegistry::instance()
+    {
+        static MetricsRegistry registry;
+        return registry;
+    }
+
+    int MetricsRegistry::addCollector(Collector collector)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const int id = m_nextId++;
+        m_collectors.emplace(id, std::move(collector));
+        return id;
+    }
+
+    void MetricsRegistry::removeCollector(int id)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_collectors.erase(id);
+    }
+
+    void MetricsRegistry::setCommonLabels(const MetricLabels &labels)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_common = labels;
+    }
+
+    std::string MetricsRegistry::render(bool openMetrics) const
+    {
+        MetricsWriter writer;
+        std::lock_guard<std::mutex> lock(m_mutex);
+        writer.setCommonLabels(m_common);
+        for (const auto &entry : m_collectors)
+        {
+            entry.second(writer);
+        }
+        return writer.render(openMetrics);
+    }
+
+    // ===== MetricsServer =====
+
+    MetricsServer::~MetricsServer()
+    {
+        stop();
+    }
+
+    bool MetricsServer::start(const std::string &bindAddress, int port)
+    {
+        if (m_running.load())
+        {
+            return true;
+        }
+
+#ifdef _WIN32
+        static const bool winsockReady = []()
+        {
+            WSADATA data;
+            return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+        }();
+        if (!winsockReady)
+        {
+            qWarning() << "[MetricsServer] WSAStartup 失敗";
+            return false;
+        }
+#endif
+
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(static_cast<uint16_t>(port));
+        if (inet_pton(AF_INET, bindAddress.c_str(), &address.sin_addr) != 1)
+        {
+            qWarning() << "[MetricsServer] 無效的監聽位址:" << bindAddress.c_str();
+            return false;
+        }
+
+        const SocketHandle listener = ::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        if (listener == INVALID_HANDLE)
+        {
+            qWarning() << "[MetricsServer] 無法建立 socket";
+            return false;
+        }
+        const int reuse = 1;
+        setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char *>(&reuse), sizeof(reuse));
+
+        if (::bind(listener, reinterpret_cast<const sockaddr *>(&address), sizeof(address)) != 0 ||
+            ::listen(listener, 16) != 0)
+        {
+            qWarning() << "[MetricsServer] 無法監聽" << bindAddress.c_str() << ":" << port;
+            closeSocket(listener);
+            return false;
+        }
+
+        // port = 0 時取得系統分配的埠
+        socklen_t length = sizeof(address);
+        getsockname(listener, reinterpret_cast<sockaddr *>(&address), &length);
+        m_port = ntohs(address.sin_port);
+
+        m_listenSocket = static_cast<intptr_t>(listener);
+        m_running.store(true);
+        m_thread = std::thread(&MetricsServer::serveLoop, this);
+
+        qDebug() << "[MetricsServer] 指標端點: http://" << bindAddress.c_str() << ":" << m_port << "/metrics";
+        return true;
+    }
+
+    void MetricsServer::stop()
+    {
+        if (!m_running.exchange(false))
+        {
+            return;
+        }
+        if (m_thread.joinable())
+        {
+            m_thread.join();
+        }
+        closeSocket(static_cast<SocketHandle>(m_listenSocket));
+        m_listenSocket = -1;
+        qDebug() << "[MetricsServer] 已停止，共" << m_scrapes.load() << "次抓取";
+    }
+
+    void MetricsServer::serveLoop()
+    {
+        setCurrentThreadName("Metrics");
+        const SocketHandle listener = static_cast<SocketHandle>(m_listenSocket);
+        while (m_running.load(std::memory_order_relaxed))
+        {
+            pollfd fd{};
+            fd.fd = listener;
+            fd.events = POLLIN;
+            if (pollSockets(&fd, 1, ACCEPT_POLL_MS) <= 0 || !(fd.revents & POLLIN))
+            {
+                continue;
+            }
+
+            const SocketHandle client = ::accept(listener, nullptr, nullptr);
+            if (client == INVALID_HANDLE)
+            {
+                continue;
+            }
+            setSendTimeout(client, SEND_TIMEOUT_MS);
+            handleConnection(static_cast<intptr_t>(client));
+            closeSocket(client);
+        }
+    }
+
+    void MetricsServer::handleConnection(intptr_t clientHandle)
+    {
+        const SocketHandle client = static_cast<SocketHandle>(clientHandle);
+
+        // 讀到標頭結束（只處理 GET，不讀 body）
+        std::string request;
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(REQUEST_TIMEOUT_MS);
+        while (request.find("\r\n\r\n") == std::string::npos && request.size() < MAX_REQUEST_BYTES)
+        {
+            const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                       deadline - std::chrono::steady_clock::now())
+                                       .count();
+            pollfd fd{};
+            fd.fd = client;
+            fd.events = POLLIN;
+            if (remaining <= 0 || pollSockets(&fd, 1, static_cast<int>(remaining)) <= 0)
+            {
+                return;
+            }
+            char buffer[1024];
+            const auto n = ::recv(client, buffer, sizeof(buffer), 0);
+            if (n <= 0)
+            {
+                return;
+            }
+            request.append(buffer, static_cast<size_t>(n));
+        }
+
+        const size_t lineEnd = request.find("\r\n");
+        const std::string requestLine = request.substr(0, lineEnd);
+        const size_t methodEnd = requestLine.find(' ');
+        const size_t pathEnd = requestLine.find(' ', methodEnd + 1);
+        if (methodEnd == std::string::npos || pathEnd == std::string::npos)
+        {
+            sendAll(client, httpResponse("400 Bad Request", "text/plain; charset=utf-8", "bad request\n"));
+            return;
+        }
+        const std::string method = requestLine.substr(0, methodEnd);
+        std::string path = requestLine.substr(methodEnd + 1, pathEnd - methodEnd - 1);
+        path = path.substr(0, path.find('?'));
+
+        if (method != "GET")
+        {
+            sendAll(client, httpResponse("405 Method Not Allowed", "text/plain; charset=utf-8", "GET only\n"));
+            return;
+        }
+        if (path == "/")
+        {
+            sendAll(client, httpResponse("200 OK", "text/html; charset=utf-8",
+                                         "<html><body><a href=\"/metrics\">/metrics</a></body></html>\n"));
+            return;
+        }
+        if (path != "/metrics")
+        {
+            sendAll(client, httpResponse("404 Not Found", "text/plain; charset=utf-8", "not found\n"));
+            return;
+        }
+
+        std::string headers = request.substr(0, request.find("\r\n\r\n"));
+        std::transform(headers.begin(), headers.end(), headers.begin(),
+                       [](unsigned char c)
+                       { return static_cast<char>(std::tolower(c)); });
+        const bool openMetrics = headers.find("application/openmetrics-text") != std::string::npos;
+
+        const std::string body = MetricsRegistry::instance().render(openMetrics);
+        const char *contentType = openMetrics ? "application/openmetrics-text; version=1.0.0; charset=utf-8"
+                                              : "text/plain; version=0.0.4; charset=utf-8";
+        sendAll(client, httpResponse("200 OK", contentType, body));
+        m_scrapes.fetch_add(1, std::memory_order_relaxed);
+    }
+
+} // namespace basler
@@ -0,0 +1,709 @@
+#include "core/modbus_vibrator.h"
+#include "core/thread_affinity.h"
+#include "core/thread_scheduling.h"
+#include "config/settings.h"
+#include <QDebug>
+#include <QSerialPort>
+#include <QTcpSocket>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace basler {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr quint8 FC_WRITE_SINGLE_REGISTER = 0x06;
+constexpr int WRITE_RESPONSE_PDU_LENGTH = 5; // FC06 正常回應 = 請求回顯
+constexpr int EXCEPTION_PDU_LENGTH = 2;      // 功能碼 | 0x80 + 例外碼
+constexpr int MBAP_HEADER_LENGTH = 7;
+constexpr int CONNECT_TIMEOUT_MS = 1000;
+
+int msUntil(Clock::time_point deadline)
+{
+    const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count();
+    return static_cast<int>(std::max<long long>(0, remaining));
+}
+
+QString exceptionText(const QByteArray& response)
+{
+    if (response.size() == EXCEPTION_PDU_LENGTH && (static_cast<quint8>(response[0]) & 0x80)) {
+        return QString("Modbus 例外碼 %1").arg(static_cast<quint8>(response[1]));
+    }
+    return QString("回應內容不符");
+}
+
+/**
+ * @brief Modbus 傳輸層（只在鏈路的 I/O 線程建立與使用）
+ */
+class ModbusTransport {
+public:
+    virtual ~ModbusTransport() = default;
+
+    virtual bool open(QString& error) = 0;
+    virtual void close() = 0;
+    virtual bool isOpen() const = 0;
+
+    /**
+     * @brief 送出請求 PDU 並讀取回應 PDU（不含站號 / CRC / MBAP）
+     * @param expectedLength 正常回應的 PDU 長度（例外回應另行判斷）
+     */
+    virtual bool transact(quint8 unitId, const QByteArray& request, int expectedLength, int timeoutMs,
+                          QByteArray& response, QString& error) = 0;
+};
+
+/**
+ * @brief Modbus RTU（RS-485）：站號 + PDU + CRC，幀間至少 3.5 字元靜默
+ */
+class RtuTransport : public ModbusTransport {
+public:
+    explicit RtuTransport(const VibratorConfig& config)
+        : m_config(config)
+    {
+        // 每字元 11 位元；19200 以上規範建議固定 1.75ms
+        m_silenceUs = config.baudRate > 19200 ? 1750
+                                              : static_cast<int>(3.5 * 11 * 1e6 / std::max(1, config.baudRate));
+    }
+
+    bool open(QString& error) override
+    {
+        m_port = std::make_unique<QSerialPort>();
+        m_port->setPortName(m_config.serialPort);
+        m_port->setBaudRate(m_config.baudRate);
+        m_port->setDataBits(QSerialPort::Data8);
+        m_port->setParity(m_config.parity == "none" ? QSerialPort::NoParity
+                          : m_config.parity == "odd" ? QSerialPort::OddParity
+                                                     : QSerialPort::EvenParity);
+        m_port->setStopBits(m_config.stopBits == 2 ? QSerialPort::TwoStop : QSerialPort::OneStop);
+        m_port->setFlowControl(QSerialPort::NoFlowControl);
+        if (!m_port->open(QIODevice::ReadWrite)) {
+            error = QString("無法開啟序列埠 %1: %2").arg(m_config.serialPort, m_port->errorString());
+            m_port.reset();
+            return false;
+        }
+        return true;
+    }
+
+    void close() override
+    {
+        if (m_port) {
+            m_port->close();
+            m_port.reset();
+        }
+    }
+
+    bool isOpen() const override { return m_port && m_port->isOpen(); }
+
+    bool transact(quint8 unitId, const QByteArray& request, int expectedLength, int timeoutMs,
+                  QByteArray& response, QString& error) override
+    {
+        QByteArray frame;
+        frame.reserve(request.size() + 3);
+        frame.append(static_cast<char>(unitId));
+        frame.append(request);
+        const quint16 crc = modbusCrc16(frame);
+        frame.append(static_cast<char>(crc & 0xFF));
+        frame.append(static_cast<char>(crc >> 8));
+
+        // 幀間靜默；丟棄前一個請求逾時後才到的殘留位元組
+        const auto silenceEnd = m_lastFrameEnd + std::chrono::microseconds(m_silenceUs);
+        if (Clock::now() < silenceEnd) {
+            std::this_thread::sleep_until(silenceEnd);
+        }
+        m_port->clear(QSerialPort::Input);
+
+        const auto deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+        m_port->write(frame);
+        if (!m_port->waitForBytesWritten(timeoutMs)) {
+            m_lastFrameEnd = Clock::now();
+            error = QString("序列埠寫入逾時");
+            return false;
+        }
+
+        QByteArray reply;
+        int replyLength = 1 + expectedLength + 2;
+        while (reply.size() < replyLength) {
+            const int remainingMs = msUntil(deadline);
+            if (remainingMs <= 0 || !m_port->waitForReadyRead(remainingMs)) {
+                m_lastFrameEnd = Clock::now();
+                error = QString("回應逾時（收到 %1 / %2 位元組）").arg(reply.size()).arg(replyLength);
+                return false;
+            }
+            reply.append(m_port->readAll());
+            if (reply.size() >= 2 && (static_cast<quint8>(reply[1]) & 0x80)) {
+                replyLength = 1 + EXCEPTION_PDU_LENGTH + 2;
+            }
+        }
+        m_lastFrameEnd = Clock::now();
+        reply.truncate(replyLength);
+
+        const quint16 replyCrc = static_cast<quint8>(reply[replyLength - 2])
+                                 | (static_cast<quint16>(static_cast<quint8>(reply[replyLength - 1])) << 8);
+        if (modbusCrc16(reply.left(replyLength - 2)) != replyCrc) {
+            error = QString("CRC 錯誤");
+            return false;
+        }
+        if (static_cast<quint8>(reply[0]) != unitId) {
+            error = QString("站號不符: %1").arg(static_cast<quint8>(reply[0]));
+            return false;
+        }
+        response = reply.mid(1, replyLength - 3);
+        return true;
+    }
+
+private:
+    VibratorConfig m_config;
+    std::unique_ptr<QSerialPort> m_port;
+    int m_silenceUs = 1750;
+    Clock::time_point m_lastFrameEnd{};
+};
+
+/**
+ * @brief Modbus TCP：MBAP 標頭（交易編號 / 協定 0 / 長度 / 站號）+ PDU
+ */
+class TcpTransport : public ModbusTransport {
+public:
+    explicit TcpTransport(const VibratorConfig& config)
+        : m_config(config)
+    {
+    }
+
+    bool open(QString& error) override
+    {
+        m_socket = std::make_unique<QTcpSocket>();
+        m_socket->connectToHost(m_config.host, static_cast<quint16>(m_config.tcpPort));
+        if (!m_socket->waitForConnected(CONNECT_TIMEOUT_MS)) {
+            error = QString("無法連線 %1:%2: %3").arg(m_config.host).arg(m_config.tcpPort).arg(m_socket->errorString());
+            m_socket.reset();
+            return false;
+        }
+        m_socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+        m_buffer.clear();
+        return true;
+    }
+
+    void close() override
+    {
+        if (m_socket) {
+            m_socket->abort();
+            m_socket.reset();
+        }
+        m_buffer.clear();
+    }
+
+    bool isOpen() const override { return m_socket && m_socket->state() == QAbstractSocket::ConnectedState; }
+
+    bool transact(quint8 unitId, const QByteArray& request, int /*expectedLength*/, int timeoutMs,
+                  QByteArray& response, QString& error) override
+    {
+        const quint16 transactionId = ++m_transactionId;
+        const int length = request.size() + 1;
+
+        QByteArray frame;
+        frame.reserve(MBAP_HEADER_LENGTH + request.size());
+        frame.append(static_cast<char>(transactionId >> 8));
+        frame.append(static_cast<char>(transactionId & 0xFF));
+        frame.append('\0');
+        frame.append('\0');
+        frame.append(static_cast<char>(length >> 8));
+        frame.append(static_cast<char>(length & 0xFF));
+        frame.append(static_cast<char>(unitId));
+        frame.append(request);
+
+        const auto deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+        m_socket->write(frame);
+        if (!m_socket->waitForBytesWritten(timeoutMs)) {
+            error = QString("TCP 寫入逾時");
+            return false;
+        }
+
+        // 逾時請求的遲到回應交易編號不同，讀到後丟棄
+        for (;;) {
+            if (!readAtLeast(MBAP_HEADER_LENGTH, deadline, error)) {
+                return false;
+            }
+            const quint16 replyId = (static_cast<quint16>(static_cast<quint8>(m_buffer[0])) << 8)
+                                    | static_cast<quint8>(m_buffer[1]);
+            const int replyLength = (static_cast<quint8>(m_buffer[4]) << 8) | static_cast<quint8>(m_buffer[5]);
+            if (replyLength < 2 || replyLength > 254) {
+                error = QString("MBAP 長度錯誤: %1").arg(replyLength);
+                return false;
+            }
+            if (!readAtLeast(6 + replyLength, deadline, error)) {
+                return false;
+            }
+            const quint8 replyUnit = static_cast<quint8>(m_buffer[6]);
+            const QByteArray pdu = m_buffer.mid(MBAP_HEADER_LENGTH, replyLength - 1);
+            m_buffer.remove(0, 6 + replyLength);
+
+            if (replyId != transactionId) {
+                continue;
+            }
+            if (replyUnit != unitId) {
+                error = QString("站號不符: %1").arg(replyUnit);
+                return false;
+            }
+            response = pdu;
+            return true;
+        }
+    }
+
+private:
+    bool readAtLeast(int bytes, Clock::time_point deadline, QString& error)
+    {
+        while (m_buffer.size() < bytes) {
+            const int remainingMs = msUntil(deadline);
+            if (remainingMs <= 0 || !m_socket->waitForReadyRead(remainingMs)) {
+                error = QString("回應逾時（收到 %1 / %2 位元組）").arg(m_buffer.size()).arg(bytes);
+                return false;
+            }
+            m_buffer.append(m_socket->readAll());
+        }
+        return true;
+    }
+
+    VibratorConfig m_config;
+    std::unique_ptr<QTcpSocket> m_socket;
+    QByteArray m_buffer;
+    quint16 m_transactionId = 0;
+};
+
+} // namespace
+
+quint16 modbusCrc16(const QByteArray& data)
+{
+    quint16 crc = 0xFFFF;
+    for (const char byte : data) {
+        crc ^= static_cast<quint8>(byte);
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc & 1) ? static_cast<quint16>((crc >> 1) ^ 0xA001) : static_cast<quint16>(crc >> 1);
+        }
+    }
+    return crc;
+}
+
+// ============================================================================
+// ModbusLink：一條實體鏈路 + I/O 線程（同一端點的震動機共用）
+// ============================================================================
+
+class ModbusLink {
+public:
+    using ErrorHandler = std::function<void(const QString&)>;
+
+    static std::shared_ptr<ModbusLink> acquire(const VibratorConfig& config, bool tcp);
+
+    ModbusLink(const VibratorConfig& config, bool tcp, const QString& endpoint);
+    ~ModbusLink();
+
+    ModbusLink(const ModbusLink&) = delete;
+    ModbusLink& operator=(const ModbusLink&) = delete;
+
+    int addUnit(int unitId, ErrorHandler onError);
+    void removeUnit(int slot);
+    void setRunning(int slot, bool running);
+    void setSpeed(int slot, int percent);
+    ModbusCommandStats stats(int slot) const;
+    const QString& endpoint() const { return m_endpoint; }
+
+private:
+    struct Setpoint {
+        bool running = false;
+        int percent = 0;
+    };
+
+    struct Unit {
+        int unitId = 1;
+        bool active = true;
+        Setpoint desired;
+        bool pending = false;       // desired 尚未送出
+        Setpoint applied;
+        bool appliedValid = false;  // false = 裝置狀態未知，下次全部暫存器重寫
+        Clock::time_point retryAt{};
+        Clock::time_point refreshAt{};
+        ModbusCommandStats stats;
+    };
+
+    void ioLoop();
+    void markPending(Unit& unit);
+    bool sendSetpoint(int slot, int unitId, const Setpoint& target, const Setpoint& applied, bool force,
+                      QString& error);
+    bool writeRegister(int slot, int unitId, int reg, int value, QString& error);
+    void reportError(int slot, const QString& message);
+
+    const VibratorConfig m_config;
+    const bool m_tcp;
+    const QString m_endpoint;
+    std::unique_ptr<ModbusTransport> m_transport; // 只由 I/O 線程使用
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::deque<Unit> m_units; // 只附加（參考不失效），以 slot 索引
+    bool m_running = true;
+
+    std::mutex m_handlerMutex;
+    std::vector<ErrorHandler> m_handlers;
+
+    std::thread m_thread;
+};
+
+std::shared_ptr<ModbusLink> ModbusLink::acquire(const VibratorConfig& config, bool tcp)
+{
+    static std::mutex registryMutex;
+    static std::map<QString, std::weak_ptr<ModbusLink>> registry;
+
+    const QString endpoint = tcp ? QString("tcp://%1:%2").arg(config.host).arg(config.tcpPort)
+                                 : QString("rtu://%1@%2").arg(config.serialPort).arg(config.baudRate);
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    if (auto link = registry[endpoint].lock()) {
+        return link;
+    }
+    auto link = std::make_shared<ModbusLink>(config, tcp, endpoint);
+    registry[endpoint] = link;
+    return link;
+}
+
+ModbusLink::ModbusLink(const VibratorConfig& config, bool tcp, const QString& endpoint)
+    : m_config(config)
+    , m_tcp(tcp)
+    , m_endpoint(endpoint)
+{
+    m_thread = std::thread(&ModbusLink::ioLoop, this);
+    qDebug() << "[ModbusLink] 啟動 I/O 線程:" << m_endpoint;
+}
+
+ModbusLink::~ModbusLink()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_running = false;
+    }
+    m_cv.notify_one();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+    qDebug() << "[ModbusLink] 已關閉:" << m_endpoint;
+}
+
+int ModbusLink::addUnit(int unitId, ErrorHandler onError)
+{
+    int slot;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Unit unit;
+        unit.unitId = unitId;
+        m_units.push_back(unit);
+        slot = static_cast<int>(m_units.size()) - 1;
+    }
+    std::lock_guard<std::mutex> lock(m_handlerMutex);
+    m_handlers.resize(slot + 1);
+    m_handlers[slot] = std::move(onError);
+    return slot;
+}
+
+void ModbusLink::removeUnit(int slot)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_handlerMutex);
+        m_handlers[slot] = nullptr;
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_units[slot].active = false; // 尚未送出的設定值（例如析構前的停止）仍會送出
+}
+
+void ModbusLink::markPending(Unit& unit)
+{
+    if (unit.pending) {
+        unit.stats.coalesced++;
+    }
+    unit.pending = true;
+    unit.retryAt = Clock::time_point(); // 新設定值不等退避，立即嘗試
+}
+
+void ModbusLink::setRunning(int slot, bool running)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Unit& unit = m_units[slot];
+        unit.desired.running = running;
+        markPending(unit);
+    }
+    m_cv.notify_one();
+}
+
+void ModbusLink::setSpeed(int slot, int percent)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Unit& unit = m_units[slot];
+        unit.desired.percent = percent;
+        markPending(unit);
+    }
+    m_cv.notify_one();
+}
+
+ModbusCommandStats ModbusLink::stats(int slot) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_units[slot].stats;
+}
+
+void ModbusLink::ioLoop()
+{
+    setCurrentThreadName("ModbusIO");
+    applyThreadScheduling(ThreadRole::Control);
+    // 序列埠 / socket 屬於本線程（Qt 物件不跨線程使用）
+    if (m_tcp) {
+        m_transport = std::make_unique<TcpTransport>(m_config);
+    } else {
+        m_transport = std::make_unique<RtuTransport>(m_config);
+    }
+
+    const auto refreshInterval = std::chrono::milliseconds(std::max(0, m_config.refreshIntervalMs));
+    const auto retryBackoff = std::chrono::milliseconds(std::max(0, m_config.retryBackoffMs));
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;) {
+        // 找出下一個要送的站：有新設定值且不在退避中，或到了重送時間。
+        // 關閉中不等退避：每個尚未送出的站（例如最後的停止 / 歸零）都立即再試一次，失敗即放棄
+        const auto now = Clock::now();
+        const bool shuttingDown = !m_running;
+        auto wakeAt = now + std::chrono::seconds(1);
+        int slot = -1;
+        bool refresh = false;
+        for (size_t i = 0; i < m_units.size() && slot < 0; ++i) {
+            const Unit& unit = m_units[i];
+            if (unit.pending) {
+                if (shuttingDown || now >= unit.retryAt) {
+                    slot = static_cast<int>(i);
+                } else {
+                    wakeAt = std::min(wakeAt, unit.retryAt);
+                }
+            } else if (!shuttingDown && unit.active && unit.appliedValid && refreshInterval.count() > 0) {
+                if (now >= unit.refreshAt) {
+                    slot = static_cast<int>(i);
+                    refresh = true;
+                } else {
+                    wakeAt = std::min(wakeAt, unit.refreshAt);
+                }
+            }
+        }
+
+        if (slot < 0) {
+            if (!m_running) {
+                break; // 已排入的設定值都送完才結束
+            }
+            m_cv.wait_until(lock, wakeAt);
+            continue;
+        }
+
+        // 取用最新設定值（指令合併），送出期間不持鎖
+        Unit& unit = m_units[slot];
+        const Setpoint target = unit.desired;
+        const Setpoint applied = unit.applied;
+        const bool force = refresh || !unit.appliedValid;
+        const int unitId = unit.unitId;
+        unit.pending = false;
+        lock.unlock();
+
+        QString error;
+        const bool ok = sendSetpoint(slot, unitId, target, applied, force, error);
+
+        lock.lock();
+        Unit& done = m_units[slot];
+        if (ok) {
+            done.applied = target;
+            done.appliedValid = true;
+            done.refreshAt = Clock::now() + refreshInterval;
+            continue;
+        }
+
+        done.stats.failures++;
+        done.appliedValid = false;
+        if (m_running) {
+            done.pending = true; // 退避後以當時的最新設定值再送
+            done.retryAt = Clock::now() + retryBackoff;
+        } else {
+            done.pending = false; // 關閉中：重試已用盡，不再無限等待
+        }
+        lock.unlock();
+        reportError(slot, QString("%1 站號 %2: %3").arg(m_endpoint).arg(unitId).arg(error));
+        lock.lock();
+    }
+
+    lock.unlock();
+    m_transport->close();
+    m_transport.reset();
+}
+
+bool ModbusLink::sendSetpoint(int slot, int unitId, const Setpoint& target, const Setpoint& applied, bool force,
+                              QString& error)
+{
+    const int fullScale = std::max(1, m_config.speedFullScale);
+    auto registerValue = [fullScale](int percent) {
+        return std::clamp(percent * fullScale / 100, 0, 0xFFFF);
+    };
+
+    // 無運轉暫存器：速度 0 即停止
+    if (m_config.runRegister < 0) {
+        const int value = target.running ? target.percent : 0;
+        const int previous = applied.running ? applied.percent : 0;
+        if (!force && value == previous) {
+            return true;
+        }
+        return writeRegister(slot, unitId, m_config.speedRegister, registerValue(value), error);
+    }
+
+    // 停止：先停運轉再改速度；啟動：先設速度再運轉
+    if (!target.running && (force || applied.running)) {
+        if (!writeRegister(slot, unitId, m_config.runRegister, 0, error)) {
+            return false;
+        }
+    }
+    if (force || target.percent != applied.percent) {
+        if (!writeRegister(slot, unitId, m_config.speedRegister, registerValue(target.percent), error)) {
+            return false;
+        }
+    }
+    if (target.running && (force || !applied.running)) {
+        if (!writeRegister(slot, unitId, m_config.runRegister, 1, error)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ModbusLink::writeRegister(int slot, int unitId, int reg, int value, QString& error)
+{
+    QByteArray request(5, '\0');
+    request[0] = static_cast<char>(FC_WRITE_SINGLE_REGISTER);
+    request[1] = static_cast<char>((reg >> 8) & 0xFF);
+    request[2] = static_cast<char>(reg & 0xFF);
+    request[3] = static_cast<char>((value >> 8) & 0xFF);
+    request[4] = static_cast<char>(value & 0xFF);
+
+    const int attempts = 1 + std::max(0, m_config.maxRetries);
+    const int timeoutMs = std::max(1, m_config.responseTimeoutMs);
+    for (int attempt = 0; attempt < attempts; ++attempt) {
+        if (attempt > 0) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_units[slot].stats.retries++;
+        }
+        if (!m_transport->isOpen() && !m_transport->open(error)) {
+            continue;
+        }
+
+        const auto start = Clock::now();
+        QByteArray response;
+        if (!m_transport->transact(static_cast<quint8>(unitId), request, WRITE_RESPONSE_PDU_LENGTH, timeoutMs,
+                                   response, error)) {
+            m_transport->close(); // 逾時 / CRC 錯誤：重新開啟連線並清掉殘留資料
+            continue;
+        }
+        if (response != request) {
+            error = exceptionText(response); // 例外回應：連線正常，不需重連
+            continue;
+        }
+
+        const auto roundTripNs = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ModbusCommandStats& stats = m_units[slot].stats;
+        stats.roundTrip.record(static_cast<uint64_t>(roundTripNs));
+        stats.commands++;
+        stats.lastRoundTripUs = roundTripNs / 1000.0;
+        stats.linkUp = true;
+        return true;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_units[slot].stats.linkUp = false;
+    return false;
+}
+
+void ModbusLink::reportError(int slot, const QString& message)
+{
+    qWarning() << "[ModbusLink]" << message;
+    std::lock_guard<std::mutex> lock(m_handlerMutex);
+    if (m_handlers[slot]) {
+        m_handlers[slot](message);
+    }
+}
+
+// ============================================================================
+// ModbusVibratorController
+// ============================================================================
+
+ModbusVibratorController::ModbusVibratorController(const QString& name, const VibratorConfig& config, bool tcp,
+                                                   int unitId, QObject* parent)
+    : VibratorControllerBase(name, parent)
+    , m_link(ModbusLink::acquire(config, tcp))
+    , m_unitId(qBound(1, unitId, 247))
+{
+    // I/O 線程發出，接收端在其他線程時自動排隊
+    m_slot = m_link->addUnit(m_unitId, [this](const QString& message) { emit error(message); });
+    qDebug() << "[ModbusVibratorController] 創建:" << name << m_link->endpoint() << "站號" << m_unitId;
+}
+
+ModbusVibratorController::~ModbusVibratorController()
+{
+    // 析構前確保停機；鏈路最後一個使用者釋放時會先送完再關閉
+    m_link->setRunning(m_slot, false);
+    m_link->removeUnit(m_slot);
+}
+
+QString ModbusVibratorController::endpoint() const
+{
+    return m_link->endpoint();
+}
+
+ModbusCommandStats ModbusVibratorController::commandStats() const
+{
+    return m_link->stats(m_slot);
+}
+
+void ModbusVibratorController::start()
+{
+    if (m_isRunning) {
+        qDebug() << "[" << m_name << "] 已經在運行中";
+        return;
+    }
+
+    m_isRunning = true;
+    m_link->setRunning(m_slot, true);
+    qDebug() << "[" << m_name << "] 啟動 (Modbus 站號" << m_unitId << "), 速度:" << m_speedPercent.load() << "%";
+    emit runningStateChanged(true);
+}
+
+void ModbusVibratorController::stop()
+{
+    if (!m_isRunning) {
+        qDebug() << "[" << m_name << "] 已經停止";
+        return;
+    }
+
+    m_isRunning = false;
+    m_link->setRunning(m_slot, false);
+    qDebug() << "[" << m_name << "] 停止 (Modbus 站號" << m_unitId << ")";
+    emit runningStateChanged(false);
+}
+
+void ModbusVibratorController::setSpeedPercent(int percent)
+{
+    // 可能由即時控制線程呼叫：只更新設定值，不記錄日誌
+    percent = qBound(0, percent, 100);
+    if (m_speedPercent.exchange(percent) == percent) {
+        return;
+    }
+    m_link->setSpeed(m_slot, percent);
+    emit speedChanged(percent);
+}
+
+} // namespace basler
@@ -0,0 +1,643 @@
+#include "core/multi_pipeline.h"
+#include "core/detection_worker.h"
+#include "core/pipeline_telemetry.h"
+#include "core/source_manager.h"
+#include "core/thread_affinity.h"
+#include "core/thread_scheduling.h"
+#include "core/vibrator_controller.h"
+#include "core/yolo_detector.h"
+#include "core/yolo_inference_pool.h"
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+
+namespace basler
+{
+
+    MultiPipelineEngine::MultiPipelineEngine(QObject *parent)
+        : QObject(parent)
+    {
+    }
+
+    MultiPipelineEngine::~MultiPipelineEngine()
+    {
+        release();
+    }
+
+    void MultiPipelineEngine::release()
+    {
+        stop();
+        m_pipelines.clear();
+        m_lanes.clear();
+        if (m_modelLoader.joinable())
+        {
+            m_modelLoader.join();
+        }
+        m_inferencePool.reset();
+    }
+
+    bool MultiPipelineEngine::configure(const MultiCameraConfig &config)
+    {
+        release();
+
+        const auto &settings = Settings::instance();
+        const auto &yoloCfg = settings.yolo();
+
+        // 共用推理池：所有管線的 DetectionController 都掛在這裡，模型只載入 inferenceWorkers 份
+        m_inferencePool = std::make_unique<YoloInferencePool>(config.inferenceWorkers);
+        m_inferencePool->configure([&](YoloDetector &detector)
+                                   {
+            detector.setConfidenceThreshold(yoloCfg.confidenceThreshold);
+            detector.setNmsThreshold(yoloCfg.nmsThreshold);
+            detector.setRoiUpscaleFactor(yoloCfg.roiUpscaleFactor);
+            detector.setInputSize(yoloCfg.inputSize);
+            detector.setBackend(yoloCfg.backend.toStdString(), yoloCfg.device.toStdString());
+            detector.setTiling(yoloCfg.tiledInference, yoloCfg.tileOverlap); });
+        // 模型在背景載入並暖機，不延遲管線啟動；完成前各管線以傳統模式檢測
+        if (!yoloCfg.modelPath.isEmpty())
+        {
+            YoloInferencePool *pool = m_inferencePool.get();
+            const QString modelPath = yoloCfg.modelPath;
+            m_modelLoader = std::thread([pool, modelPath]()
+                                        {
+                                            setCurrentThreadName("YoloLoad");
+                                            QElapsedTimer timer;
+                                            timer.start();
+                                            const bool success = pool->loadModel(modelPath.toStdString());
+                                            qDebug() << "[MultiPipelineEngine] 共用推理池模型"
+                                                     << (success ? "已載入（含暖機）:" : "載入失敗:") << modelPath
+                                                     << "，耗時" << timer.elapsed() << "ms";
+                                        });
+        }
+
+        // 以序號指定的相機：列舉一次換成索引（各 CameraController 依相同順序列舉裝置）
+        QList<CameraInfo> cameras;
+        const bool needEnumeration = std::any_of(config.cameras.begin(), config.cameras.end(),
+                                                 [](const CameraPipelineConfig &camera)
+                                                 { return camera.source.isEmpty() && !camera.serial.isEmpty(); });
+        if (needEnumeration)
+        {
+            CameraController enumerator;
+            cameras = enumerator.detectCameras();
+        }
+
+        for (const auto &cameraConfig : config.cameras)
+        {
+            auto pipeline = std::make_unique<Pipeline>();
+            pipeline->config = cameraConfig;
+            pipeline->config.lane = std::max(0, cameraConfig.lane);
+
+            if (!cameraConfig.source.isEmpty())
+            {
+                pipeline->name = cameraConfig.source;
+            }
+            else if (!cameraConfig.serial.isEmpty())
+            {
+                auto it = std::find_if(cameras.begin(), cameras.end(), [&](const CameraInfo &info)
+                                       { return info.serial == cameraConfig.serial; });
+                if (it == cameras.end())
+                {
+                    qWarning() << "[MultiPipelineEngine] 找不到序號為" << cameraConfig.serial << "的相機，略過";
+                    emit pipelineError(static_cast<int>(m_pipelines.size()),
+                                       QString("找不到相機 %1").arg(cameraConfig.serial));
+                    continue;
+                }
+                pipeline->cameraIndex = it->index;
+                pipeline->name = QString("%1 (%2)").arg(it->model, it->serial);
+            }
+            else
+            {
+                pipeline->cameraIndex = std::max(0, cameraConfig.cameraIndex);
+                pipeline->name = QString("相機 #%1").arg(pipeline->cameraIndex);
+            }
+
+            m_pipelines.push_back(std::move(pipeline));
+        }
+
+        if (m_pipelines.empty())
+        {
+            qWarning() << "[MultiPipelineEngine] 沒有可建立的管線";
+            return false;
+        }
+
+        assignCores(config);
+
+        // 料道數 = 最大料道編號 + 1；目標預設沿用單相機的包裝配置
+        int laneTotal = 0;
+        for (const auto &pipeline : m_pipelines)
+        {
+            laneTotal = std::max(laneTotal, pipeline->config.lane + 1);
+        }
+        m_lanes.assign(laneTotal, Lane{});
+        for (auto &lane : m_lanes)
+        {
+            lane.target = settings.packaging().targetCount;
+        }
+        m_packagingEnabled = settings.packaging().enableAutoPackaging;
+
+        for (size_t i = 0; i < m_pipelines.size(); ++i)
+        {
+            createPipeline(*m_pipelines[i], static_cast<int>(i));
+        }
+
+        qDebug() << "[MultiPipelineEngine] 已建立" << m_pipelines.size() << "條管線,"
+                 << m_lanes.size() << "個料道, 推理池" << m_inferencePool->size() << "個實例";
+        return true;
+    }
+
+    void MultiPipelineEngine::assignCores(const MultiCameraConfig &config)
+    {
+        // 自動分配：從核心 1 開始依序給抓取、檢測線程（核心 0 留給主線程 / 事件循環），用完後輪回
+        const int cores = logicalCoreCount();
+        const bool autoAssign = config.autoAssignCores && cores > 1;
+        int next = 0;
+        auto nextCore = [&]()
+        {
+            const int core = 1 + next % (cores - 1);
+            next++;
+            return core;
+        };
+
+        for (auto &pipeline : m_pipelines)
+        {
+            const bool isCamera = pipeline->config.source.isEmpty();
+            if (isCamera)
+            {
+                pipeline->grabCore = pipeline->config.grabCore >= 0 ? pipeline->config.grabCore
+                                                                    : (autoAssign ? nextCore() : -1);
+            }
+            pipeline->detectionCore = pipeline->config.detectionCore >= 0 ? pipeline->config.detectionCore
+                                                                          : (autoAssign ? nextCore() : -1);
+        }
+
+        if (autoAssign && next > cores - 1)
+        {
+            qWarning() << "[MultiPipelineEngine] 線程數" << next << "超過可用核心" << cores - 1
+                       << "，部分線程共用核心";
+        }
+    }
+
+    void MultiPipelineEngine::createPipeline(Pipeline &pipeline, int index)
+    {
+        pipeline.source = std::make_unique<SourceManager>();
+        pipeline.controller = std::make_unique<DetectionController>(m_inferencePool.get());
+        pipeline.controller->enablePackagingMode(false);
+
+        pipeline.thread = std::make_unique<QThread>();
+        pipeline.thread->setObjectName(QString("DetectionThread-%1").arg(index));
+        pipeline.worker = std::make_unique<DetectionWorker>(pipeline.controller.get(),
+                                                            pipeline.source->frameRing());
+        pipeline.worker->moveToThread(pipeline.thread.get());
+
+        // 先在檢測線程內套用排程（直接連接，detectionCore 優先於 SchedulingConfig），再排入檢測循環
+        const int core = pipeline.detectionCore;
+        connect(pipeline.thread.get(), &QThread::started, pipeline.thread.get(), [core]()
+                { applyThreadScheduling(ThreadRole::Detection, core); },
+                Qt::DirectConnection);
+        connect(pipeline.thread.get(), &QThread::started,
+                pipeline.worker.get(), &DetectionWorker::run, Qt::QueuedConnection);
+
+        // 計數在檢測線程發出，佇列到引擎線程彙總
+        connect(pipeline.controller.get(), &DetectionController::countChanged, this,
+                [this, index](int count)
+                { onPipelineCount(index, count); },
+                Qt::QueuedConnection);
+
+        DetectionWorker *worker = pipeline.worker.get();
+        connect(pipeline.source.get(), &SourceManager::fpsUpdated, this,
+                [worker](double fps)
+                { worker->setSourceFps(fps); });
+        connect(pipeline.source.get(), &SourceManager::error, this,
+                [this, index](const QString &message)
+                { emit pipelineError(index, message); });
+
+        if (Settings::instance().telemetry().enabled)
+        {
+            pipeline.telemetry = std::make_unique<PipelineTelemetry>(QString::number(index), pipeline.controller.get(),
+                                                                     worker, pipeline.source.get());
+        }
+
+        if (pipeline.config.source.isEmpty())
+        {
+            CameraController *camera = pipeline.source->useCamera();
+            camera->setGrabThreadCore(pipeline.grabCore);
+
+            // 相機連接為非同步：連上後才開始抓取
+            SourceManager *source = pipeline.source.get();
+            connect(source, &SourceManager::connected, this, [this, source](const CameraInfo &)
+                    {
+                if (m_running)
+                {
+                    source->startGrabbing();
+                } });
+        }
+
+        qDebug() << "[MultiPipelineEngine] 管線" << index << pipeline.name
+                 << "料道" << pipeline.config.lane
+                 << "抓取核心" << pipeline.grabCore << "檢測核心" << pipeline.detectionCore;
+    }
+
+    // ===== 狀態查詢 =====
+
+    SourceManager *MultiPipelineEngine::source(int pipeline) const
+    {
+        return pipeline >= 0 && pipeline < pipelineCount() ? m_pipelines[pipeline]->source.get() : nullptr;
+    }
+
+    DetectionController *MultiPipelineEngine::controller(int pipeline) const
+    {
+        return pipeline >= 0 && pipeline < pipelineCount() ? m_pipelines[pipeline]->controller.get() : nullptr;
+    }
+
+    DetectionWorker *MultiPipelineEngine::worker(int pipeline) const
+    {
+        return pipeline >= 0 && pipeline < pipelineCount() ? m_pipelines[pipeline]->worker.get() : nullptr;
+    }
+
+    QString MultiPipelineEngine::pipelineName(int pipeline) const
+    {
+        return pipeline >= 0 && pipeline < pipelineCount() ? m_pipelines[pipeline]->name : QString();
+    }
+
+    int MultiPipelineEngine::pipelineLane(int pipeline) const
+    {
+        return pipeline >= 0 && pipeline < pipelineCount() ? m_pipelines[pipeline]->config.lane : -1;
+    }
+
+    int MultiPipelineEngine::countOf(int pipeline) const
+    {
+        return pipeline >= 0 && pipeline < pipelineCount() ? m_pipelines[pipeline]->count : 0;
+    }
+
+    int MultiPipelineEngine::laneCount(int lane) const
+    {
+        return lane >= 0 && lane < laneTotal() ? m_lanes[lane].count : 0;
+    }
+
+    VibratorSpeed MultiPipelineEngine::laneSpeed(int lane) const
+    {
+        return lane >= 0 && lane < laneTotal() ? m_lanes[lane].speed : VibratorSpeed::STOP;
+    }
+
+    int MultiPipelineEngine::totalCount() const
+    {
+        int total = 0;
+        for (const auto &lane : m_lanes)
+        {
+            total += lane.count;
+        }
+        return total;
+    }
+
+    // ===== 控制 =====
+
+    void MultiPipelineEngine::start()
+    {
+        if (m_running || m_pipelines.empty())
+        {
+            return;
+        }
+        m_running = true;
+
+        for (size_t i = 0; i < m_pipelines.size(); ++i)
+        {
+            Pipeline &pipeline = *m_pipelines[i];
+
+            // 檢測線程先於抓取啟動，第一幀就有消費者
+            pipeline.controller->setEnabled(true);
+            pipeline.thread->start();
+
+            if (!pipeline.config.source.isEmpty())
+            {
+                if (pipeline.source->useVideo(pipeline.config.source))
+                {
+                    pipeline.source->startGrabbing();
+                }
+            }
+            else if (pipeline.source->cameraController()->isConnected())
+            {
+                pipeline.source->startGrabbing();
+            }
+            else
+            {
+                pipeline.source->connectCamera(pipeline.cameraIndex);
+            }
+        }
+
+        for (int lane = 0; lane < laneTotal(); ++lane)
+        {
+            updateLaneSpeed(lane);
+        }
+
+        emit runningStateChanged(true);
+        qDebug() << "[MultiPipelineEngine] 已啟動" << m_pipelines.size() << "條管線";
+    }
+
+    void MultiPipelineEngine::stop()
+    {
+        if (!m_running)
+        {
+            return;
+        }
+        m_running = false;
+
+        // 先結束檢測線程（無損消費者不再阻塞生產者），再停止抓取
+        for (auto &pipeline : m_pipelines)
+        {
+            pipeline->controller->setEnabled(false);
+            pipeline->worker->stop();
+        }
+        for (auto &pipeline : m_pipelines)
+        {
+            pipeline->thread->quit();
+            pipeline->thread->wait();
+            pipeline->worker->clearLatestResult();
+            pipeline->source->stopGrabbing();
+        }
+
+        for (int lane = 0; lane < laneTotal(); ++lane)
+        {
+            updateLaneSpeed(lane); // 停止狀態 → STOP
+        }
+
+        emit runningStateChanged(false);
+        qDebug() << "[MultiPipelineEngine] 已停止，總計數" << totalCount();
+    }
+
+    void MultiPipelineEngine::resetCounts()
+    {
+        for (auto &pipeline : m_pipelines)
+        {
+            pipeline->controller->reset();
+            pipeline->count = 0;
+        }
+        for (int lane = 0; lane < laneTotal(); ++lane)
+        {
+            m_lanes[lane].count = 0;
+            m_lanes[lane].completed = false;
+            emit laneCountChanged(lane, 0);
+            updateLaneSpeed(lane);
+        }
+        emit totalCountChanged(0);
+    }
+
+    void MultiPipelineEngine::enablePackagingMode(bool enabled)
+    {
+        m_packagingEnabled = enabled;
+        for (int lane = 0; lane < laneTotal(); ++lane)
+        {
+            m_lanes[lane].completed = false;
+            updateLaneSpeed(lane);
+        }
+    }
+
+    void MultiPipelineEngine::setLaneTarget(int lane, int target)
+    {
+        if (lane < 0 || lane >= laneTotal())
+        {
+            return;
+        }
+        m_lanes[lane].target = std::max(1, target);
+        m_lanes[lane].completed = false;
+        updateLaneSpeed(lane);
+    }
+
+    // ===== 料道彙總 =====
+
+    void MultiPipelineEngine::onPipelineCount(int index, int count)
+    {
+        if (index < 0 || index >= pipelineCount())
+        {
+            return;
+        }
+
+        Pipeline &pipeline = *m_pipelines[index];
+        if (pipeline.count == count)
+        {
+            return;
+        }
+        pipeline.count = count;
+        emit pipelineCountChanged(index, count);
+
+        const int laneIndex = pipeline.config.lane;
+        int laneSum = 0;
+        for (const auto &other : m_pipelines)
+        {
+            if (other->config.lane == laneIndex)
+            {
+                laneSum += other->count;
+            }
+        }
+
+        m_lanes[laneIndex].count = laneSum;
+        emit laneCountChanged(laneIndex, laneSum);
+        emit totalCountChanged(totalCount());
+        updateLaneSpeed(laneIndex);
+    }
+
+    void MultiPipelineEngine::updateLaneSpeed(int laneIndex)
+    {
+        Lane &lane = m_lanes[laneIndex];
+        VibratorSpeed newSpeed = VibratorSpeed::FULL;
+
+        if (!m_running)
+        {
+            newSpeed = VibratorSpeed::STOP;
+        }
+        else if (m_packagingEnabled)
+        {
+            const auto &pkg = Settings::instance().packaging();
+            if (lane.count >= lane.target)
+            {
+                newSpeed = VibratorSpeed::STOP;
+                if (!lane.completed)
+                {
+                    lane.completed = true;
+                    emit lanePackagingCompleted(laneIndex, lane.count);
+                    qDebug() << "[MultiPipelineEngine] 料道" << laneIndex << "包裝完成！"
+                             << lane.count << "/" << lane.target;
+                }
+            }
+            else
+            {
+                newSpeed = packagingSpeedFor(lane.count, lane.target, pkg.advanceStopCount,
+                                             pkg.speedFullThreshold, pkg.speedMediumThreshold,
+                                             pkg.speedSlowThreshold);
+            }
+        }
+
+        if (newSpeed == lane.speed)
+        {
+            return;
+        }
+        lane.speed = newSpeed;
+        emit laneSpeedChanged(laneIndex, newSpeed);
+        if (m_vibrators)
+        {
+            m_vibrators->setLaneSpeed(laneIndex, newSpeed);
+        }
+    }
+
+    // ===== 命令列 =====
+
+    namespace
+    {
+        QtMessageHandler s_defaultHandler = nullptr;
+
+        void quietMessageHandler(QtMsgType type, const QMessageLogContext &context, const QString &message)
+        {
+            if (type == QtDebugMsg || type == QtInfoMsg)
+            {
+                return;
+            }
+            if (s_defaultHandler)
+            {
+                s_defaultHandler(type, context, message);
+            }
+        }
+    } // namespace
+
+    int runMultiCamera(const QStringList &arguments)
+    {
+        QCommandLineParser parser;
+        parser.setApplicationDescription("多相機檢測：每台相機一條抓取 / 檢測管線，料道計數彙總後控制震動機");
+        parser.addHelpOption();
+        parser.addOption({"multi-camera", "啟用多相機模式"});
+        parser.addOption({"config", "配置檔（JSON）；未指定則使用預設配置檔", "json"});
+        parser.addOption({"source", "以影片或 *.synth.json 取代配置中的相機（可重複指定，依序分到料道 0 / 1）", "input"});
+        parser.addOption({"duration", "執行秒數（0 = 直到全部影片播完；相機模式需手動結束）", "seconds", "0"});
+        parser.addOption({"verbose", "顯示檢測管線的調試輸出"});
+        parser.process(arguments);
+
+        if (!parser.isSet("verbose"))
+        {
+            s_defaultHandler = qInstallMessageHandler(quietMessageHandler);
+        }
+
+        auto &settings = Settings::instance();
+        const bool loaded = parser.isSet("config") ? settings.load(parser.value("config")) : settings.load();
+        if (parser.isSet("config") && !loaded)
+        {
+            std::cerr << "無法載入配置檔: " << parser.value("config").toStdString() << std::endl;
+            return 1;
+        }
+
+        MultiCameraConfig config = settings.multiCamera();
+        const QStringList sources = parser.values("source");
+        if (!sources.isEmpty())
+        {
+            config.cameras.clear();
+            for (int i = 0; i < sources.size(); ++i)
+            {
+                CameraPipelineConfig camera;
+                camera.source = sources[i];
+                camera.lane = i % 2;
+                config.cameras.push_back(camera);
+            }
+        }
+        if (config.cameras.empty())
+        {
+            std::cerr << "配置中沒有相機（multiCamera.cameras），也未指定 --source\n"
+                      << parser.helpText().toStdString();
+            return 1;
+        }
+
+        auto metricsServer = startMetricsServer(settings.telemetry());
+        auto vibrators = createDualVibratorManager(settings.vibrator().driver, "震動機A", "震動機B");
+
+        // 主線程（引擎事件循環）排程；管線線程各自在啟動時套用
+        applyThreadScheduling(ThreadRole::Ui);
+
+        MultiPipelineEngine engine;
+        engine.setVibratorManager(vibrators.get());
+        if (!engine.configure(config))
+        {
+            std::cerr << "沒有任何管線可啟動" << std::endl;
+            return 1;
+        }
+
+        std::cout << "多相機檢測: " << engine.pipelineCount() << " 條管線, " << engine.laneTotal() << " 個料道"
+                  << std::endl;
+        for (int i = 0; i < engine.pipelineCount(); ++i)
+        {
+            std::cout << "  [" << i << "] 料道 " << engine.pipelineLane(i) << "  "
+                      << engine.pipelineName(i).toStdString() << "\n";
+        }
+        std::cout << std::flush;
+
+        QObject::connect(&engine, &MultiPipelineEngine::pipelineError, [](int pipeline, const QString &message)
+                         { std::cerr << "管線 " << pipeline << " 錯誤: " << message.toStdString() << std::endl; });
+        QObject::connect(&engine, &MultiPipelineEngine::lanePackagingCompleted, [](int lane, int count)
+                         { std::cout << "料道 " << lane << " 包裝完成: " << count << std::endl; });
+
+        // 全部是影片來源時，全部播完即結束（有相機時只依 --duration 或手動結束）
+        const bool allVideo = std::all_of(config.cameras.begin(), config.cameras.end(),
+                                          [](const CameraPipelineConfig &camera)
+                                          { return !camera.source.isEmpty(); });
+        int remaining = engine.pipelineCount();
+        if (allVideo)
+        {
+            for (int i = 0; i < engine.pipelineCount(); ++i)
+            {
+                QObject::connect(engine.source(i), &SourceManager::grabbingStopped, &engine, [&remaining]()
+                                 {
+                    if (--remaining == 0)
+                    {
+                        // 讓檢測線程消化 FrameRing 中剩餘的幀
+                        QTimer::singleShot(500, QCoreApplication::instance(), &QCoreApplication::quit);
+                    } });
+            }
+        }
+
+        const double duration = parser.value("duration").toDouble();
+        if (duration > 0)
+        {
+            QTimer::singleShot(static_cast<int>(duration * 1000), QCoreApplication::instance(),
+                               &QCoreApplication::quit);
+        }
+
+        // 每秒輸出一次各管線 / 料道計數
+        QTimer reportTimer;
+        QObject::connect(&reportTimer, &QTimer::timeout, [&engine]()
+                         {
+            std::cout << "計數";
+            for (int i = 0; i < engine.pipelineCount(); ++i)
+            {
+                std::cout << "  [" << i << "] " << std::setw(5) << engine.countOf(i) << " @"
+                          << std::fixed << std::setprecision(0) << engine.source(i)->fps() << "fps";
+            }
+            for (int lane = 0; lane < engine.laneTotal(); ++lane)
+            {
+                std::cout << "  | 料道" << lane << " " << engine.laneCount(lane)
+                          << " (" << static_cast<int>(engine.laneSpeed(lane)) << "%)";
+            }
+            std::cout << std::endl; });
+        reportTimer.start(1000);
+
+        QElapsedTimer wall;
+        wall.start();
+        engine.start();
+        QCoreApplication::exec();
+        engine.stop();
+
+        std::cout << "==== 總結 ====（" << std::fixed << std::setprecision(1) << wall.elapsed() / 1000.0 << " 秒）\n";
+        for (int i = 0; i < engine.pipelineCount(); ++i)
+        {
+            std::cout << "  [" << i << "] " << std::setw(6) << engine.countOf(i)
+                      << "  處理 " << engine.worker(i)->processedFrames() << " 幀, 丟幀 "
+                      << engine.worker(i)->droppedFrames() << "  " << engine.pipelineName(i).toStdString() << "\n";
+        }
+        for (int lane = 0; lane < engine.laneTotal(); ++lane)
+        {
+            std::cout << "  料道 " << lane << ": " << engine.laneCount(lane) << "\n";
+        }
+        std::cout << "  總計: " << engine.totalCount() << std::endl;
+        return 0;
+    }
+
+} // namespace basler
@@ -0,0 +1,296 @@
+#include "core/offline_replay.h"
+#include "core/detection_controller.h"
+#include "core/raw_capture.h"
+#include "core/synthetic_parts.h"
+#include "config/settings.h"
+#include <QCommandLineParser>
+#include <QFileInfo>
+#include <QThread>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include <opencv2/videoio.hpp>
+
+namespace basler
+{
+
+    namespace
+    {
+        using Clock = std::chrono::steady_clock;
+
+        double secondsSince(Clock::time_point start)
+        {
+            return std::chrono::duration<double>(Clock::now() - start).count();
+        }
+
+        // 非 --verbose 時略過 qDebug / qInfo（檢測管線每次計數都會輸出），警告與錯誤照常顯示
+        QtMessageHandler s_defaultHandler = nullptr;
+
+        void quietMessageHandler(QtMsgType type, const QMessageLogContext &context, const QString &message)
+        {
+            if (type == QtDebugMsg || type == QtInfoMsg)
+            {
+                return;
+            }
+            if (s_defaultHandler)
+            {
+                s_defaultHandler(type, context, message);
+            }
+        }
+
+        /**
+         * @brief 依序讀取影片或原始擷取的每一幀
+         */
+        class ReplaySource
+        {
+        public:
+            bool open(const QString &input, QString &error)
+            {
+                if (SyntheticPartsGenerator::isSyntheticSpec(input))
+                {
+                    if (!m_synthetic.load(input))
+                    {
+                        error = m_synthetic.errorString();
+                        return false;
+                    }
+                    m_isSynthetic = true;
+                    return true;
+                }
+
+                if (RawCaptureReader::isRawCapture(input))
+                {
+                    if (!m_raw.open(input))
+                    {
+                        error = m_raw.errorString();
+                        return false;
+                    }
+                    m_isRaw = true;
+                    return true;
+                }
+
+                if (!m_capture.open(input.toStdString()))
+                {
+                    error = "無法打開視頻文件";
+                    return false;
+                }
+                return true;
+            }
+
+            // 原始擷取回傳指向映射記憶體的幀（不複製）
+            bool next(cv::Mat &frame)
+            {
+                if (m_isSynthetic)
+                {
+                    return m_synthetic.render(m_index++, frame);
+                }
+                if (m_isRaw)
+                {
+                    RawFrameHeader header;
+                    return m_raw.frame(m_index++, frame, header);
+                }
+                return m_capture.read(frame);
+            }
+
+            // 合成序列的真值（其他輸入為 nullptr）
+            const SyntheticPartsGenerator *synthetic() const { return m_isSynthetic ? &m_synthetic : nullptr; }
+
+        private:
+            cv::VideoCapture m_capture;
+            RawCaptureReader m_raw;
+            SyntheticPartsGenerator m_synthetic;
+            bool m_isRaw = false;
+            bool m_isSynthetic = false;
+            int m_index = 0;
+        };
+
+        void printResult(const ReplayResult &result)
+        {
+            std::ostringstream out;
+            out << std::fixed << std::setprecision(1);
+            out << "==== " << QFileInfo(result.input).fileName().toStdString() << " ====\n";
+            if (!result.ok)
+            {
+                out << "  失敗: " << result.error.toStdString() << "\n";
+                std::cout << out.str() << std::flush;
+                return;
+            }
+
+            out << "  計數: " << result.count << "  幀數: " << result.frames << "\n";
+            if (result.truth >= 0)
+            {
+                out << "  真值: " << result.truth << "  準確度: " << result.accuracy() * 100.0 << "%\n";
+            }
+            out << "  處理: " << result.processingFps() << " fps（" << result.processSeconds << " s）"
+                << "  含解碼: " << result.wallFps() << " fps（解碼 " << result.decodeSeconds << " s）\n";
+            out << "  " << std::left << std::setw(16) << "stage" << std::right << std::setw(9) << "frames"
+                << std::setw(10) << "mean_us" << std::setw(10) << "p50_us" << std::setw(10) << "p95_us"
+                << std::setw(10) << "p99_us" << std::setw(10) << "max_us" << "\n";
+            for (int s = 0; s < PIPELINE_STAGE_COUNT; ++s)
+            {
+                const LatencyHistogram &hist = result.latency.stages[s];
+                if (hist.count == 0)
+                {
+                    continue;
+                }
+                out << "  " << std::left << std::setw(16) << pipelineStageName(static_cast<PipelineStage>(s))
+                    << std::right << std::setw(9) << hist.count << std::setw(10) << hist.meanUs()
+                    << std::setw(10) << hist.percentileUs(0.50) << std::setw(10) << hist.percentileUs(0.95)
+                    << std::setw(10) << hist.percentileUs(0.99) << std::setw(10) << hist.maxUs() << "\n";
+            }
+            std::cout << out.str() << std::flush;
+        }
+    }
+
+    ReplayResult replayInput(const QString &input)
+    {
+        ReplayResult result;
+        result.input = input;
+
+        ReplaySource source;
+        if (!source.open(input, result.error))
+        {
+            return result;
+        }
+
+        // 每個輸入獨立的控制器；延遲窗口在本線程直接合併（不經事件迴圈）
+        DetectionController controller;
+        QObject::connect(&controller, &DetectionController::stageLatencyUpdated,
+                         [&result](const StageLatencySnapshot &snapshot)
+                         {
+                             result.latency.merge(snapshot);
+                         });
+        controller.loadConfiguredYoloModel(false); // 重播需要完整結果：同步載入後才開始
+        controller.enable();
+
+        cv::Mat frame;
+        std::vector<DetectedObject> objects;
+        FrameOverlay overlay;
+        const auto wallStart = Clock::now();
+        while (true)
+        {
+            const auto decodeStart = Clock::now();
+            if (!source.next(frame))
+            {
+                break;
+            }
+            const auto processStart = Clock::now();
+            result.decodeSeconds += std::chrono::duration<double>(processStart - decodeStart).count();
+
+            controller.processFrame(frame, objects, overlay); // 無人觀看：只產生疊加資料，不燒入
+            result.processSeconds += secondsSince(processStart);
+            result.frames++;
+        }
+        result.wallSeconds = secondsSince(wallStart);
+        result.latency.merge(controller.stageProfiler().collect());
+        result.count = controller.count();
+        if (const SyntheticPartsGenerator *synthetic = source.synthetic())
+        {
+            result.truth = synthetic->crossings(controller.gateLineY(), 0, result.frames - 1);
+        }
+
+        if (result.frames == 0)
+        {
+            result.error = "沒有可讀取的幀";
+            return result;
+        }
+        result.ok = true;
+        return result;
+    }
+
+    int runOfflineReplay(const QStringList &arguments)
+    {
+        QCommandLineParser parser;
+        parser.setApplicationDescription("離線重播：以最快速度將每一幀送進檢測管線，輸出計數與延遲");
+        parser.addHelpOption();
+        parser.addOption({"replay", "影片檔、原始擷取目錄或 *.synth.json 合成序列（可重複指定）", "input"});
+        parser.addOption({"config", "配置檔（JSON）；未指定則使用預設配置檔", "json"});
+        parser.addOption({"jobs", "平行處理的輸入數（預設 = min(輸入數, CPU 核心數)）", "n"});
+        parser.addOption({"verbose", "顯示檢測管線的調試輸出"});
+        parser.addPositionalArgument("inputs", "其他輸入", "[inputs...]");
+        parser.process(arguments);
+
+        QStringList inputs = parser.values("replay") + parser.positionalArguments();
+        if (inputs.isEmpty())
+        {
+            std::cerr << parser.helpText().toStdString();
+            return 1;
+        }
+
+        if (!parser.isSet("verbose"))
+        {
+            s_defaultHandler = qInstallMessageHandler(quietMessageHandler);
+        }
+
+        auto &settings = Settings::instance();
+        const bool loaded = parser.isSet("config") ? settings.load(parser.value("config")) : settings.load();
+        if (parser.isSet("config") && !loaded)
+        {
+            std::cerr << "無法載入配置檔: " << parser.value("config").toStdString() << std::endl;
+            return 1;
+        }
+
+        int jobs = parser.isSet("jobs") ? parser.value("jobs").toInt() : QThread::idealThreadCount();
+        jobs = std::clamp(jobs, 1, static_cast<int>(inputs.size()));
+
+        std::cout << "離線重播: " << inputs.size() << " 個輸入, " << jobs << " 個線程" << std::endl;
+
+        // 工作線程依序領取下一個輸入；完成一個就輸出一個
+        std::vector<ReplayResult> results(inputs.size());
+        std::atomic<int> nextInput{0};
+        std::mutex printMutex;
+        std::vector<std::thread> workers;
+        for (int j = 0; j < jobs; ++j)
+        {
+            workers.emplace_back([&]()
+                                 {
+                for (int i = nextInput.fetch_add(1); i < inputs.size(); i = nextInput.fetch_add(1))
+                {
+                    results[i] = replayInput(inputs[i]);
+                    std::lock_guard<std::mutex> lock(printMutex);
+                    printResult(results[i]);
+                } });
+        }
+        for (auto &worker : workers)
+        {
+            worker.join();
+        }
+
+        // 總結（依輸入順序）
+        int failed = 0;
+        int totalFrames = 0;
+        double totalProcessSeconds = 0.0;
+        std::cout << "==== 總結 ====\n";
+        for (const auto &result : results)
+        {
+            if (!result.ok)
+            {
+                failed++;
+                std::cout << "  失敗  " << result.input.toStdString() << "\n";
+                continue;
+            }
+            totalFrames += result.frames;
+            totalProcessSeconds += result.processSeconds;
+            std::cout << "  " << std::setw(6) << result.count;
+            if (result.truth >= 0)
+            {
+                std::cout << " / " << std::setw(6) << result.truth;
+            }
+            std::cout << "  " << result.input.toStdString() << "\n";
+        }
+        if (totalProcessSeconds > 0)
+        {
+            std::cout << std::fixed << std::setprecision(1) << "  每線程平均處理速度: "
+                      << totalFrames / totalProcessSeconds << " fps\n";
+        }
+        std::cout << std::flush;
+
+        return failed > 0 ? 1 : 0;
+    }
+
+} // namespace basler
@@ -0,0 +1,156 @@
+#include "core/pipeline_telemetry.h"
+#include "core/detection_controller.h"
+#include "core/detection_worker.h"
+#include "core/source_manager.h"
+#include "core/thread_cpu_sampler.h"
+#include "config/settings.h"
+#include <QDebug>
+#include <QSysInfo>
+
+namespace basler
+{
+
+    PipelineTelemetry::PipelineTelemetry(const QString &pipeline, DetectionController *controller,
+                                         DetectionWorker *worker, SourceManager *source, QObject *parent)
+        : QObject(parent), m_pipeline(pipeline.toStdString()), m_controller(controller), m_worker(worker)
+    {
+        // 直接連接：在發出端線程只做原子寫入，不經任何事件循環
+        connect(controller, &DetectionController::countChanged, this, [this](int count)
+                { m_count.store(count, std::memory_order_relaxed); }, Qt::DirectConnection);
+        connect(controller, &DetectionController::defectStatsUpdated, this,
+                [this](double passRate, int passCount, int failCount)
+                {
+                    m_passRate.store(passRate, std::memory_order_relaxed);
+                    m_passCount.store(passCount, std::memory_order_relaxed);
+                    m_failCount.store(failCount, std::memory_order_relaxed);
+                },
+                Qt::DirectConnection);
+        connect(controller, &DetectionController::packagingCompleted, this, [this]()
+                { m_packagesCompleted.fetch_add(1, std::memory_order_relaxed); }, Qt::DirectConnection);
+        connect(controller, &DetectionController::yoloInferenceTimeUpdated, this, [this](double ms)
+                { m_yoloInferenceMs.store(ms, std::memory_order_relaxed); }, Qt::DirectConnection);
+        connect(controller, &DetectionController::stageLatencyUpdated, this,
+                &PipelineTelemetry::onStageLatency, Qt::DirectConnection);
+        if (source)
+        {
+            connect(source, &SourceManager::fpsUpdated, this, [this](double fps)
+                    { m_cameraFps.store(fps, std::memory_order_relaxed); }, Qt::DirectConnection);
+        }
+
+        m_collectorId = MetricsRegistry::instance().addCollector([this](MetricsWriter &writer)
+                                                                 { collect(writer); });
+    }
+
+    PipelineTelemetry::~PipelineTelemetry()
+    {
+        // 返回後收集器不會再被呼叫
+        MetricsRegistry::instance().removeCollector(m_collectorId);
+    }
+
+    void PipelineTelemetry::onStageLatency(const StageLatencySnapshot &snapshot)
+    {
+        // 檢測線程：視窗快照累加成單調遞增的累計直方圖（Prometheus histogram 語意）
+        m_stageTotals.merge(snapshot);
+        for (int i = 0; i < PIPELINE_STAGE_COUNT; ++i)
+        {
+            m_stages[i].publish(m_stageTotals.stages[i]);
+        }
+    }
+
+    void PipelineTelemetry::collect(MetricsWriter &writer) const
+    {
+        const MetricLabels labels = {{"pipeline", m_pipeline}};
+
+        writer.gauge("basler_camera_fps", "Camera / video source frame rate", labels,
+                     m_cameraFps.load(std::memory_order_relaxed));
+        writer.counter("basler_frames_processed", "Frames processed by the detection thread", labels,
+                       static_cast<double>(m_worker->processedFrames()));
+        writer.counter("basler_frames_dropped", "Frames overwritten in FrameRing before detection read them",
+                       labels, static_cast<double>(m_worker->droppedFrames()));
+        writer.gauge("basler_frame_queue_depth", "Frames published but not yet processed by detection", labels,
+                     static_cast<double>(m_worker->backlogFrames()));
+        writer.gauge("basler_frame_processing_seconds", "Processing time of the last frame", labels,
+                     m_worker->lastProcessingMs() / 1000.0);
+        writer.gauge("basler_quality_level", "Adaptive quality level (0 = full quality)", labels,
+                     static_cast<double>(m_controller->qualityLevel()));
+
+        writer.gauge("basler_count", "Current package count", labels, m_count.load(std::memory_order_relaxed));
+        writer.counter("basler_packages_completed", "Packages that reached the target count", labels,
+                       static_cast<double>(m_packagesCompleted.load(std::memory_order_relaxed)));
+        writer.gauge("basler_defect_pass", "Parts judged good since the last reset", labels,
+                     m_passCount.load(std::memory_order_relaxed));
+        writer.gauge("basler_defect_fail", "Parts judged defective since the last reset", labels,
+                     m_failCount.load(std::memory_order_relaxed));
+        writer.gauge("basler_defect_pass_ratio", "Pass ratio since the last reset (0-1)", labels,
+                     m_passRate.load(std::memory_order_relaxed) / 100.0);
+        writer.gauge("basler_yolo_inference_seconds", "Most recent YOLO inference time", labels,
+                     m_yoloInferenceMs.load(std::memory_order_relaxed) / 1000.0);
+
+        for (int i = 0; i < PIPELINE_STAGE_COUNT; ++i)
+        {
+            const LatencyHistogram histogram = m_stages[i].load();
+            if (histogram.count == 0)
+            {
+                continue; // 未執行的階段（例如非融合管線的分段）不輸出
+            }
+            writer.histogram("basler_stage_latency_seconds", "Detection pipeline stage latency",
+                             {{"pipeline", m_pipeline}, {"stage", pipelineStageName(static_cast<PipelineStage>(i))}},
+                             histogram);
+        }
+    }
+
+    namespace
+    {
+        /**
+         * @brief 程序層級指標：逐線程累計 CPU 時間、常駐記憶體與缺頁次數
+         *
+         * 抓取時直接讀取系統統計（不經任何管線物件），速率由 Prometheus 端 rate() 計算。
+         */
+        void collectProcessMetrics(MetricsWriter &writer)
+        {
+            std::vector<ThreadCpuTimes> threads;
+            if (readThreadCpuTimes(threads))
+            {
+                for (const ThreadCpuTimes &thread : threads)
+                {
+                    writer.counter("basler_thread_cpu_seconds", "CPU time consumed by each process thread",
+                                   {{"thread", thread.name.empty() ? "unnamed" : thread.name},
+                                    {"tid", std::to_string(thread.id)}},
+                                   thread.cpuNs / 1e9);
+                }
+            }
+            ProcessMemoryStats memory;
+            if (readProcessMemory(memory))
+            {
+                writer.gauge("basler_process_resident_memory_bytes", "Resident memory of the process", {},
+                             static_cast<double>(memory.residentBytes));
+                writer.counter("basler_process_page_faults", "Page faults since process start (allocation proxy)",
+                               {}, static_cast<double>(memory.pageFaults));
+            }
+        }
+    }
+
+    std::unique_ptr<MetricsServer> startMetricsServer(const TelemetryConfig &config)
+    {
+        if (!config.enabled)
+        {
+            return nullptr;
+        }
+
+        // 程序層級收集器只註冊一次（不持有任何物件，隨程序存在）
+        static const int processCollectorId = MetricsRegistry::instance().addCollector(collectProcessMetrics);
+        Q_UNUSED(processCollectorId);
+
+        const QString station = config.station.isEmpty() ? QSysInfo::machineHostName() : config.station;
+        MetricsRegistry::instance().setCommonLabels({{"station", station.toStdString()}});
+
+        auto server = std::make_unique<MetricsServer>();
+        if (!server->start(config.bindAddress.toStdString(), config.port))
+        {
+            qWarning() << "[Telemetry] 指標端點啟動失敗，已停用";
+            return nullptr;
+        }
+        return server;
+    }
+
+} // namespace basler
@@ -0,0 +1,108 @@
+#include "core/quality_governor.h"
+#include <algorithm>
+
+namespace basler
+{
+
+    namespace
+    {
+        constexpr double EMA_ALPHA = 0.1;
+        constexpr int MAX_RESTORE_BACKOFF = 16;
+    }
+
+    const char *qualityLevelDescription(QualityLevel level)
+    {
+        switch (level)
+        {
+        case QualityLevel::Full:
+            return "完整品質";
+        case QualityLevel::NoDebugTaps:
+            return "已停止調試影像擷取";
+        case QualityLevel::NoOverlay:
+            return "已停止結果繪製";
+        case QualityLevel::HighSpeedProcessing:
+            return "已切換高速處理流程（偵測靈敏度降低）";
+        case QualityLevel::ReducedWidth:
+            return "已降低處理解析度（計數準確度可能受影響）";
+        default:
+            return "";
+        }
+    }
+
+    void QualityGovernor::configure(const Config &config)
+    {
+        m_config = config;
+        if (!m_config.enabled)
+        {
+            reset();
+        }
+    }
+
+    void QualityGovernor::reset()
+    {
+        m_level = QualityLevel::Full;
+        m_emaMs = 0.0;
+        m_load = 0.0;
+        m_hasSample = false;
+        m_overloadedFrames = 0;
+        m_headroomFrames = 0;
+        m_framesSinceRestore = -1;
+        m_restoreBackoff = 1;
+    }
+
+    bool QualityGovernor::update(double processingMs, quint64 backlog, double sourceFps)
+    {
+        if (!m_config.enabled)
+        {
+            return false;
+        }
+
+        m_emaMs = m_hasSample ? m_emaMs + EMA_ALPHA * (processingMs - m_emaMs) : processingMs;
+        m_hasSample = true;
+        m_load = sourceFps > 0.0 ? m_emaMs * sourceFps / 1000.0 : 0.0;
+        if (m_framesSinceRestore >= 0)
+        {
+            m_framesSinceRestore++;
+        }
+
+        const bool overloaded = m_load > m_config.degradeLoad ||
+                                backlog > static_cast<quint64>(m_config.backlogFrames);
+        const bool headroom = m_load < m_config.restoreLoad && backlog <= 1;
+
+        m_overloadedFrames = overloaded ? m_overloadedFrames + 1 : 0;
+        m_headroomFrames = headroom ? m_headroomFrames + 1 : 0;
+
+        const int level = static_cast<int>(m_level);
+        const int maxLevel = static_cast<int>(QualityLevel::Count) - 1;
+
+        if (m_overloadedFrames >= m_config.degradeHoldFrames && level < maxLevel)
+        {
+            // 剛升級就又跟不上：延長下一次升級的等待
+            if (m_framesSinceRestore >= 0 && m_framesSinceRestore < m_config.restoreHoldFrames * m_restoreBackoff)
+            {
+                m_restoreBackoff = std::min(m_restoreBackoff * 2, MAX_RESTORE_BACKOFF);
+            }
+            m_level = static_cast<QualityLevel>(level + 1);
+            m_overloadedFrames = 0;
+            m_headroomFrames = 0;
+            return true;
+        }
+
+        if (level == 0 && m_headroomFrames >= m_config.restoreHoldFrames)
+        {
+            m_restoreBackoff = 1;
+        }
+
+        if (m_headroomFrames >= m_config.restoreHoldFrames * m_restoreBackoff && level > 0)
+        {
+            m_level = static_cast<QualityLevel>(level - 1);
+            m_overloadedFrames = 0;
+            m_headroomFrames = 0;
+            m_framesSinceRestore = 0;
+            return true;
+        }
+
+        return false;
+    }
+
+} // namespace basler
@@ -0,0 +1,371 @@
+#include "core/raw_capture.h"
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+namespace basler {
+
+namespace {
+
+constexpr char SEGMENT_MAGIC[8] = {'B', 'R', 'A', 'W', 'S', 'E', 'G', '1'};
+constexpr char INDEX_MAGIC[8] = {'B', 'R', 'A', 'W', 'I', 'D', 'X', '1'};
+constexpr quint32 FORMAT_VERSION = 1;
+constexpr qint64 SEGMENT_HEADER_BYTES = 4096; // 紀錄從頁邊界開始
+constexpr size_t RECORD_ALIGN = 64;
+constexpr const char* INDEX_FILE = "index.bin";
+
+struct SegmentHeader {
+    char magic[8];
+    quint32 version;
+    quint32 headerBytes;
+    qint32 width;
+    qint32 height;
+    qint32 type;
+    quint32 rowBytes;
+    quint64 recordBytes;
+    quint32 capacity;
+    quint32 frameCount; // 逐幀更新
+    double fps;
+};
+static_assert(sizeof(SegmentHeader) <= SEGMENT_HEADER_BYTES, "分段標頭超過保留空間");
+
+struct IndexHeader {
+    char magic[8];
+    quint32 version;
+    quint32 entryBytes;
+};
+
+struct IndexEntry {
+    quint32 segment;
+    quint32 record;
+    quint64 sequence;
+    quint64 blockId;
+    qint64 hostTimestampUs;
+};
+static_assert(sizeof(IndexEntry) == 32, "IndexEntry 必須為 32 bytes");
+
+QString segmentFileName(int index)
+{
+    return QString("seg_%1.bin").arg(index, 5, 10, QChar('0'));
+}
+
+} // namespace
+
+// ============================================================================
+// RawCaptureWriter
+// ============================================================================
+
+RawCaptureWriter::~RawCaptureWriter()
+{
+    close();
+}
+
+bool RawCaptureWriter::open(const QString& directory, double fps, qint64 segmentBytes)
+{
+    close();
+
+    QDir dir(directory);
+    if (dir.exists()) {
+        m_error = QString("擷取目錄已存在: %1").arg(directory);
+        return false;
+    }
+    if (!dir.mkpath(".")) {
+        m_error = QString("無法建立擷取目錄: %1").arg(directory);
+        return false;
+    }
+
+    m_index.setFileName(dir.absoluteFilePath(INDEX_FILE));
+    if (!m_index.open(QIODevice::WriteOnly)) {
+        m_error = QString("無法建立索引檔: %1").arg(m_index.errorString());
+        return false;
+    }
+
+    IndexHeader header{};
+    std::memcpy(header.magic, INDEX_MAGIC, sizeof(header.magic));
+    header.version = FORMAT_VERSION;
+    header.entryBytes = sizeof(IndexEntry);
+    m_index.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    m_directory = dir.absolutePath();
+    m_fps = fps;
+    m_segmentBytes = segmentBytes;
+    m_segmentIndex = -1;
+    m_frames = 0;
+    m_error.clear();
+    return true;
+}
+
+bool RawCaptureWriter::openSegment(const cv::Mat& frame)
+{
+    finishSegment();
+
+    m_width = frame.cols;
+    m_height = frame.rows;
+    m_type = frame.type();
+    m_rowBytes = frame.cols * frame.elemSize();
+    const size_t payload = m_rowBytes * frame.rows;
+    m_recordBytes = (sizeof(RawFrameHeader) + payload + RECORD_ALIGN - 1) / RECORD_ALIGN * RECORD_ALIGN;
+    m_capacity = static_cast<int>(std::max<qint64>(
+        1, (m_segmentBytes - SEGMENT_HEADER_BYTES) / static_cast<qint64>(m_recordBytes)));
+    m_used = 0;
+    m_segmentIndex++;
+
+    m_segment = std::make_unique<QFile>(QDir(m_directory).absoluteFilePath(segmentFileName(m_segmentIndex)));
+    const qint64 fileBytes = SEGMENT_HEADER_BYTES + static_cast<qint64>(m_capacity) * m_recordBytes;
+    if (!m_segment->open(QIODevice::ReadWrite) || !m_segment->resize(fileBytes)) {
+        m_error = QString("無法配置分段檔: %1").arg(m_segment->errorString());
+        m_segment.reset();
+        return false;
+    }
+
+    m_map = m_segment->map(0, fileBytes);
+    if (!m_map) {
+        m_error = QString("無法映射分段檔: %1").arg(m_segment->errorString());
+        m_segment.reset();
+        return false;
+    }
+
+    SegmentHeader header{};
+    std::memcpy(header.magic, SEGMENT_MAGIC, sizeof(header.magic));
+    header.version = FORMAT_VERSION;
+    header.headerBytes = static_cast<quint32>(SEGMENT_HEADER_BYTES);
+    header.width = m_width;
+    header.height = m_height;
+    header.type = m_type;
+    header.rowBytes = static_cast<quint32>(m_rowBytes);
+    header.recordBytes = m_recordBytes;
+    header.capacity = static_cast<quint32>(m_capacity);
+    header.frameCount = 0;
+    header.fps = m_fps;
+    std::memcpy(m_map, &header, sizeof(header));
+    return true;
+}
+
+void RawCaptureWriter::finishSegment()
+{
+    if (!m_segment) {
+        return;
+    }
+
+    if (m_map) {
+        m_segment->unmap(m_map);
+        m_map = nullptr;
+    }
+    // 截去預配置但未使用的紀錄
+    m_segment->resize(SEGMENT_HEADER_BYTES + static_cast<qint64>(m_used) * m_recordBytes);
+    m_segment->close();
+    m_segment.reset();
+}
+
+bool RawCaptureWriter::append(const cv::Mat& frame, const FrameMeta& meta)
+{
+    if (!isOpen() || frame.empty() || frame.depth() != CV_8U ||
+        (frame.channels() != 1 && frame.channels() != 3)) {
+        return false;
+    }
+
+    if (!m_map || m_used >= m_capacity ||
+        frame.cols != m_width || frame.rows != m_height || frame.type() != m_type) {
+        if (!openSegment(frame)) {
+            return false;
+        }
+    }
+
+    uchar* record = m_map + SEGMENT_HEADER_BYTES + static_cast<size_t>(m_used) * m_recordBytes;
+
+    RawFrameHeader header;
+    header.sequence = meta.sequence;
+    header.blockId = meta.blockId;
+    header.deviceTimestamp = meta.deviceTimestamp;
+    header.hostTimestampUs = meta.timestampUs;
+    header.exposureUs = meta.exposureUs;
+    header.payloadBytes = static_cast<quint32>(m_rowBytes * m_height);
+    std::memcpy(record, &header, sizeof(header));
+
+    uchar* pixels = record + sizeof(RawFrameHeader);
+    if (frame.isContinuous()) {
+        std::memcpy(pixels, frame.data, header.payloadBytes);
+    } else {
+        for (int y = 0; y < frame.rows; ++y) {
+            std::memcpy(pixels + y * m_rowBytes, frame.ptr(y), m_rowBytes);
+        }
+    }
+
+    m_used++;
+    const quint32 frameCount = static_cast<quint32>(m_used);
+    std::memcpy(m_map + offsetof(SegmentHeader, frameCount), &frameCount, sizeof(frameCount));
+
+    IndexEntry entry{static_cast<quint32>(m_segmentIndex), static_cast<quint32>(m_used - 1),
+                     meta.sequence, meta.blockId, meta.timestampUs};
+    m_index.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+    m_frames++;
+    return true;
+}
+
+void RawCaptureWriter::close()
+{
+    finishSegment();
+    if (m_index.isOpen()) {
+        m_index.close();
+        qDebug() << "[RawCaptureWriter] 擷取完成:" << m_directory << "," << m_frames << "幀,"
+                 << (m_segmentIndex + 1) << "個分段";
+    }
+}
+
+// ============================================================================
+// RawCaptureReader
+// ============================================================================
+
+bool RawCaptureReader::isRawCapture(const QString& path)
+{
+    QFileInfo info(path);
+    if (info.isDir()) {
+        return QFileInfo::exists(QDir(path).absoluteFilePath(INDEX_FILE));
+    }
+    return info.fileName() == INDEX_FILE && info.dir().dirName().endsWith(RawCaptureWriter::EXTENSION);
+}
+
+bool RawCaptureReader::open(const QString& path)
+{
+    close();
+
+    QFileInfo info(path);
+    const QString directory = info.isDir() ? info.absoluteFilePath() : info.absolutePath();
+
+    m_indexFile.setFileName(QDir(directory).absoluteFilePath(INDEX_FILE));
+    if (!m_indexFile.open(QIODevice::ReadOnly) || m_indexFile.size() < static_cast<qint64>(sizeof(IndexHeader))) {
+        m_error = QString("無法開啟索引檔: %1").arg(m_indexFile.fileName());
+        close();
+        return false;
+    }
+
+    const qint64 indexSize = m_indexFile.size();
+    const uchar* map = m_indexFile.map(0, indexSize);
+    IndexHeader header{};
+    if (map) {
+        std::memcpy(&header, map, sizeof(header));
+    }
+    if (!map || std::memcmp(header.magic, INDEX_MAGIC, sizeof(header.magic)) != 0 ||
+        header.entryBytes != sizeof(IndexEntry)) {
+        m_error = "索引檔格式錯誤";
+        close();
+        return false;
+    }
+
+    m_entries = map + sizeof(IndexHeader);
+    // 中止的擷取可能留下不完整的最後一筆
+    m_count = static_cast<int>((indexSize - static_cast<qint64>(sizeof(IndexHeader))) / sizeof(IndexEntry));
+
+    // 映射索引引用到的所有分段；分段缺失或紀錄超出分段時只保留之前的幀
+    int valid = 0;
+    for (; valid < m_count; ++valid) {
+        IndexEntry entry;
+        std::memcpy(&entry, m_entries + static_cast<size_t>(valid) * sizeof(IndexEntry), sizeof(entry));
+        while (m_segments.size() <= entry.segment) {
+            if (!mapSegment(directory, static_cast<int>(m_segments.size()))) {
+                break;
+            }
+        }
+        if (entry.segment >= m_segments.size() ||
+            static_cast<int>(entry.record) >= m_segments[entry.segment].frameCount) {
+            break;
+        }
+    }
+    m_count = valid;
+
+    if (!m_segments.empty()) {
+        m_width = m_segments.front().width;
+        m_height = m_segments.front().height;
+    }
+
+    qDebug() << "[RawCaptureReader] 開啟原始擷取:" << directory << "," << m_count << "幀,"
+             << m_segments.size() << "個分段," << m_fps << "fps";
+    return true;
+}
+
+bool RawCaptureReader::mapSegment(const QString& directory, int segmentIndex)
+{
+    Segment segment;
+    segment.file = std::make_unique<QFile>(QDir(directory).absoluteFilePath(segmentFileName(segmentIndex)));
+    if (!segment.file->open(QIODevice::ReadOnly)) {
+        m_error = QString("無法開啟分段檔: %1").arg(segment.file->fileName());
+        return false;
+    }
+
+    segment.size = segment.file->size();
+    if (segment.size < SEGMENT_HEADER_BYTES) {
+        m_error = QString("分段檔不完整: %1").arg(segment.file->fileName());
+        return false;
+    }
+    segment.map = segment.file->map(0, segment.size);
+    if (!segment.map) {
+        m_error = QString("無法映射分段檔: %1").arg(segment.file->fileName());
+        return false;
+    }
+
+    SegmentHeader header;
+    std::memcpy(&header, segment.map, sizeof(header));
+    if (std::memcmp(header.magic, SEGMENT_MAGIC, sizeof(header.magic)) != 0 || header.recordBytes == 0) {
+        m_error = QString("分段檔格式錯誤: %1").arg(segment.file->fileName());
+        return false;
+    }
+
+    segment.width = header.width;
+    segment.height = header.height;
+    segment.type = header.type;
+    segment.rowBytes = header.rowBytes;
+    segment.recordBytes = header.recordBytes;
+    // 以標頭計數與實際檔案長度中較小者為準（異常中止時檔案保留預配置長度）
+    const qint64 recordsInFile = (segment.size - SEGMENT_HEADER_BYTES) / static_cast<qint64>(header.recordBytes);
+    segment.frameCount = static_cast<int>(std::min<qint64>(header.frameCount, recordsInFile));
+    if (m_segments.empty()) {
+        m_fps = header.fps;
+    }
+
+    m_segments.push_back(std::move(segment));
+    return true;
+}
+
+void RawCaptureReader::close()
+{
+    for (auto& segment : m_segments) {
+        if (segment.map) {
+            segment.file->unmap(const_cast<uchar*>(segment.map));
+        }
+    }
+    m_segments.clear();
+
+    if (m_entries) {
+        m_indexFile.unmap(const_cast<uchar*>(m_entries - sizeof(IndexHeader)));
+        m_entries = nullptr;
+    }
+    if (m_indexFile.isOpen()) {
+        m_indexFile.close();
+    }
+    m_count = 0;
+    m_fps = 0.0;
+    m_width = 0;
+    m_height = 0;
+}
+
+bool RawCaptureReader::frame(int index, cv::Mat& view, RawFrameHeader& header) const
+{
+    if (index < 0 || index >= m_count) {
+        return false;
+    }
+
+    IndexEntry entry;
+    std::memcpy(&entry, m_entries + static_cast<size_t>(index) * sizeof(IndexEntry), sizeof(entry));
+    const Segment& segment = m_segments[entry.segment];
+
+    const uchar* record = segment.map + SEGMENT_HEADER_BYTES + static_cast<size_t>(entry.record) * segment.recordBytes;
+    std::memcpy(&header, record, sizeof(header));
+    view = cv::Mat(segment.height, segment.width, segment.type,
+                   const_cast<uchar*>(record + sizeof(RawFrameHeader)), segment.rowBytes);
+    return true;
+}
+
+} // namespace basler
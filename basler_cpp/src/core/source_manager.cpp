@@ -1,5 +1,7 @@
 #include "core/source_manager.h"
 #include "core/video_player.h"
+#include "core/synthetic_parts.h"
+#include "config/settings.h"
 #include <QDebug>
 
 namespace basler
@@ -10,8 +12,11 @@ namespace basler
     {
         qRegisterMetaType<SourceType>("SourceType");
 
+        m_frameRing = std::make_unique<FrameRing>(Settings::instance().performance().frameRingCapacity);
+
         // 默認創建相機控制器
         m_cameraController = std::make_unique<CameraController>(this);
+        m_cameraController->setFrameRing(m_frameRing.get());
         setupCameraConnections();
 
         qDebug() << "[SourceManager] 初始化完成";
@@ -73,6 +78,8 @@ namespace basler
                 this, &SourceManager::onCameraFrameReady, Qt::QueuedConnection);
         connect(m_cameraController.get(), &CameraController::fpsUpdated,
                 this, &SourceManager::onCameraFpsUpdated, Qt::QueuedConnection);
+        connect(m_cameraController.get(), &CameraController::framesMissed,
+                this, &SourceManager::framesMissed, Qt::QueuedConnection);
 
         // 連接錯誤信號
         connect(m_cameraController.get(), &CameraController::connectionError,
@@ -110,6 +117,7 @@ namespace basler
         if (!m_cameraController)
         {
             m_cameraController = std::make_unique<CameraController>(this);
+            m_cameraController->setFrameRing(m_frameRing.get());
             setupCameraConnections();
         }
 
@@ -120,7 +128,7 @@ namespace basler
         return m_cameraController.get();
     }
 
-    bool SourceManager::useVideo(const QString &videoPath)
+    void SourceManager::prepareVideoPlayer()
     {
         // 停止相機抓取
         if (m_cameraController && m_cameraController->isGrabbing())
@@ -132,8 +140,14 @@ namespace basler
         if (!m_videoPlayer)
         {
             m_videoPlayer = std::make_unique<VideoPlayer>(this);
+            m_videoPlayer->setFrameRing(m_frameRing.get());
             setupVideoConnections();
         }
+    }
+
+    bool SourceManager::useVideo(const QString &videoPath)
+    {
+        prepareVideoPlayer();
 
         if (m_videoPlayer->loadVideo(videoPath))
         {
@@ -150,6 +164,24 @@ namespace basler
         }
     }
 
+    bool SourceManager::useSynthetic(const SyntheticConfig &config)
+    {
+        prepareVideoPlayer();
+
+        if (!m_videoPlayer->loadSynthetic(config))
+        {
+            emit error("無法產生合成序列");
+            return false;
+        }
+
+        m_sourceType = SourceType::Video;
+        emit sourceTypeChanged(m_sourceType);
+
+        qDebug() << "[SourceManager] 切換到合成序列:" << config.partsPerMinute << "個/分鐘,"
+                 << config.width << "x" << config.height << "@" << config.fps << "fps";
+        return true;
+    }
+
     void SourceManager::connectCamera(int index)
     {
         useCamera();
@@ -159,6 +191,15 @@ namespace basler
         }
     }
 
+    void SourceManager::connectCameraBySerial(const QString &serial, const QString &ipAddress)
+    {
+        useCamera();
+        if (m_cameraController)
+        {
+            m_cameraController->connectCameraBySerial(serial, ipAddress);
+        }
+    }
+
     void SourceManager::disconnectCamera()
     {
         if (m_cameraController)
@@ -213,8 +254,10 @@ namespace basler
 
     cv::Mat SourceManager::getFrame()
     {
-        QMutexLocker locker(&m_frameMutex);
-        return m_latestFrame.clone();
+        cv::Mat frame;
+        FrameMeta meta;
+        m_frameRing->readLatest(frame, meta);
+        return frame;
     }
 
     void SourceManager::cleanup()
@@ -273,18 +316,10 @@ namespace basler
         emit grabbingStopped();
     }
 
-    void SourceManager::onCameraFrameReady(const cv::Mat &frame)
+    void SourceManager::onCameraFrameReady(quint64 sequence)
     {
-        // 注意：CameraController 已經做過 clone()，這裡的 frame 已是獨立副本
-        // 只有當需要保存最新幀供外部查詢時才進行第二次 clone
-        {
-            QMutexLocker locker(&m_frameMutex);
-            // 使用移動語義避免不必要的拷貝，但 cv::Mat 的 clone 是深拷貝
-            // 這裡只在需要保留幀時才 clone
-            m_latestFrame = frame.clone();
-        }
-        // 直接轉發不 clone 的幀給下游（它們應該在需要時自行 clone）
-        emit frameReady(frame);
+        // 幀已由 GrabWorker 寫入共用 FrameRing，這裡只轉發序號
+        emit frameReady(sequence);
     }
 
     void SourceManager::onCameraFpsUpdated(double fps)
@@ -301,13 +336,9 @@ namespace basler
     // 視頻信號處理
     // ============================================================================
 
-    void SourceManager::onVideoFrameReady(const cv::Mat &frame)
+    void SourceManager::onVideoFrameReady(quint64 sequence)
     {
-        {
-            QMutexLocker locker(&m_frameMutex);
-            m_latestFrame = frame.clone();
-        }
-        emit frameReady(frame);
+        emit frameReady(sequence);
     }
 
     void SourceManager::onVideoPlaybackFinished()
@@ -0,0 +1,180 @@
+#include "core/spatial_grid.h"
+#include <algorithm>
+#include <cmath>
+
+namespace basler
+{
+
+    namespace
+    {
+        // 格座標雜湊（大質數混合，避免相鄰格落在同一桶）
+        inline quint32 hashCell(int cellX, int cellY)
+        {
+            return static_cast<quint32>(cellX) * 73856093u ^ static_cast<quint32>(cellY) * 19349663u;
+        }
+
+        // 向負無窮取整的整數除法（座標可能為負）
+        inline int floorDivide(int value, int divisor)
+        {
+            int q = value / divisor;
+            return (value % divisor != 0 && value < 0) ? q - 1 : q;
+        }
+    }
+
+    // ===== SpatialGrid =====
+
+    SpatialGrid::SpatialGrid(int bucketBits)
+        : m_bucketMask((1 << std::clamp(bucketBits, 1, 16)) - 1)
+    {
+        m_bucketStart.assign(m_bucketMask + 2, 0);
+    }
+
+    void SpatialGrid::setCellSize(int cellWidth, int cellHeight)
+    {
+        m_cellWidth = std::max(cellWidth, 1);
+        m_cellHeight = std::max(cellHeight, 1);
+    }
+
+    void SpatialGrid::clear()
+    {
+        m_pending.clear();
+        m_items.clear();
+        std::fill(m_bucketStart.begin(), m_bucketStart.end(), 0);
+    }
+
+    void SpatialGrid::insert(int item, int x, int y)
+    {
+        m_pending.emplace_back(bucketOf(cellX(x), cellY(y)), item);
+    }
+
+    void SpatialGrid::build()
+    {
+        // 計數排序：先數每桶項目數，前綴和得到起點，再依插入順序填入
+        std::fill(m_bucketStart.begin(), m_bucketStart.end(), 0);
+        for (const auto &[bucket, item] : m_pending)
+        {
+            m_bucketStart[bucket + 1]++;
+        }
+        for (size_t b = 1; b < m_bucketStart.size(); ++b)
+        {
+            m_bucketStart[b] += m_bucketStart[b - 1];
+        }
+
+        m_items.resize(m_pending.size());
+        for (const auto &[bucket, item] : m_pending)
+        {
+            // 借用 start[bucket] 當寫入游標，填完後整體後移一桶
+            m_items[m_bucketStart[bucket]++] = item;
+        }
+        for (size_t b = m_bucketStart.size() - 1; b > 0; --b)
+        {
+            m_bucketStart[b] = m_bucketStart[b - 1];
+        }
+        m_bucketStart[0] = 0;
+
+        m_pending.clear();
+    }
+
+    int SpatialGrid::bucketOf(int cellX, int cellY) const
+    {
+        return static_cast<int>(hashCell(cellX, cellY) & static_cast<quint32>(m_bucketMask));
+    }
+
+    int SpatialGrid::floorDiv(int value, int divisor)
+    {
+        return floorDivide(value, divisor);
+    }
+
+    // ===== RecentPositionIndex =====
+
+    RecentPositionIndex::RecentPositionIndex(int capacity, int cellSize, int bucketBits)
+        : m_bucketMask((1 << std::clamp(bucketBits, 1, 16)) - 1)
+    {
+        m_heads.resize(m_bucketMask + 1);
+        configure(capacity, cellSize);
+    }
+
+    void RecentPositionIndex::configure(int capacity, int cellSize)
+    {
+        m_entries.assign(std::max(capacity, 1), Entry());
+        m_cellSize = std::max(cellSize, 1);
+        clear();
+    }
+
+    void RecentPositionIndex::clear()
+    {
+        std::fill(m_heads.begin(), m_heads.end(), Link());
+        for (auto &entry : m_entries)
+        {
+            entry.serial = 0;
+        }
+        m_writeIndex = 0;
+        m_nextSerial = 1;
+    }
+
+    void RecentPositionIndex::push(int x, int y, int frame)
+    {
+        const int bucket = bucketOf(floorDivide(x, m_cellSize), floorDivide(y, m_cellSize));
+
+        // 覆寫最舊的一筆；舊紀錄的序號失效，指向它的鏈在此中止
+        Entry &entry = m_entries[m_writeIndex];
+        entry.x = x;
+        entry.y = y;
+        entry.frame = frame;
+        entry.serial = m_nextSerial++;
+        entry.next = m_heads[bucket];
+        m_heads[bucket] = {m_writeIndex, entry.serial};
+
+        m_writeIndex = (m_writeIndex + 1) % static_cast<int>(m_entries.size());
+    }
+
+    bool RecentPositionIndex::containsNear(int x, int y, double radius, int frame, int maxAge) const
+    {
+        if (radius <= 0.0 || maxAge <= 0)
+        {
+            return false;
+        }
+
+        const double radiusSq = radius * radius;
+        const int reach = static_cast<int>(std::ceil(radius / m_cellSize));
+        const int cx = floorDivide(x, m_cellSize);
+        const int cy = floorDivide(y, m_cellSize);
+
+        for (int dy = -reach; dy <= reach; ++dy)
+        {
+            for (int dx = -reach; dx <= reach; ++dx)
+            {
+                // 鏈由新到舊：遇到覆寫或超出時間窗的紀錄，後面只會更舊
+                Link link = m_heads[bucketOf(cx + dx, cy + dy)];
+                while (isLive(link))
+                {
+                    const Entry &entry = m_entries[link.index];
+                    if (frame - entry.frame >= maxAge)
+                    {
+                        break;
+                    }
+
+                    const double ex = x - entry.x;
+                    const double ey = y - entry.y;
+                    if (ex * ex + ey * ey < radiusSq)
+                    {
+                        return true;
+                    }
+                    link = entry.next;
+                }
+            }
+        }
+        return false;
+    }
+
+    int RecentPositionIndex::bucketOf(int cellX, int cellY) const
+    {
+        return static_cast<int>(hashCell(cellX, cellY) & static_cast<quint32>(m_bucketMask));
+    }
+
+    bool RecentPositionIndex::isLive(const Link &link) const
+    {
+        return link.index >= 0 && link.serial != 0 && m_entries[link.index].serial == link.serial;
+    }
+
+} // namespace basler
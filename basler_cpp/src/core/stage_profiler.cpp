@@ -0,0 +1,203 @@
+#include "core/stage_profiler.h"
+#include <algorithm>
+
+namespace basler
+{
+
+    namespace
+    {
+        int64_t nowNs()
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       StageProfiler::Clock::now().time_since_epoch())
+                .count();
+        }
+
+        int highestBit(uint64_t value)
+        {
+            int bit = 0;
+            while (value >>= 1)
+            {
+                ++bit;
+            }
+            return bit;
+        }
+    }
+
+    const char *pipelineStageName(PipelineStage stage)
+    {
+        switch (stage)
+        {
+        case PipelineStage::Resize:
+            return "resize";
+        case PipelineStage::RoiExtract:
+            return "roi_extract";
+        case PipelineStage::BackgroundSubtract:
+            return "bg_subtract";
+        case PipelineStage::Blur:
+            return "blur";
+        case PipelineStage::MedianFilter:
+            return "median";
+        case PipelineStage::MorphOpen:
+            return "morph_open";
+        case PipelineStage::MorphClose:
+            return "morph_close";
+        case PipelineStage::MorphRefine:
+            return "morph_refine";
+        case PipelineStage::Canny:
+            return "canny";
+        case PipelineStage::AdaptiveThreshold:
+            return "adaptive_thresh";
+        case PipelineStage::MaskFusion:
+            return "mask_fusion";
+        case PipelineStage::PostMorphology:
+            return "post_morph";
+        case PipelineStage::DeviceTransfer:
+            return "device_transfer";
+        case PipelineStage::BlobExtraction:
+            return "blobs";
+        case PipelineStage::Tracking:
+            return "tracking";
+        case PipelineStage::GateCounting:
+            return "gate_counting";
+        case PipelineStage::YoloInference:
+            return "yolo";
+        case PipelineStage::Draw:
+            return "draw";
+        case PipelineStage::Total:
+            return "total";
+        default:
+            return "";
+        }
+    }
+
+    // ===== LatencyHistogram =====
+
+    int LatencyHistogram::bucketOf(uint64_t ns)
+    {
+        if (ns < SUB_BUCKETS)
+        {
+            return static_cast<int>(ns);
+        }
+        // 最高位 msb >= 3：取其下 3 位作為桶內索引
+        const int msb = highestBit(ns);
+        const int sub = static_cast<int>((ns >> (msb - 3)) & (SUB_BUCKETS - 1));
+        return std::min((msb - 2) * SUB_BUCKETS + sub, BUCKETS - 1);
+    }
+
+    uint64_t LatencyHistogram::bucketLowerNs(int bucket)
+    {
+        if (bucket < SUB_BUCKETS)
+        {
+            return static_cast<uint64_t>(bucket);
+        }
+        return static_cast<uint64_t>(SUB_BUCKETS + bucket % SUB_BUCKETS) << (bucket / SUB_BUCKETS - 1);
+    }
+
+    uint64_t LatencyHistogram::bucketWidthNs(int bucket)
+    {
+        return bucket < SUB_BUCKETS ? 1 : uint64_t(1) << (bucket / SUB_BUCKETS - 1);
+    }
+
+    double LatencyHistogram::percentileUs(double q) const
+    {
+        if (count == 0)
+        {
+            return 0.0;
+        }
+
+        const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(q * count + 0.5));
+        uint64_t seen = 0;
+        for (int b = 0; b < BUCKETS; ++b)
+        {
+            seen += counts[b];
+            if (seen >= rank)
+            {
+                const double mid = bucketLowerNs(b) + bucketWidthNs(b) / 2.0;
+                return std::min(mid, static_cast<double>(maxNs)) / 1000.0;
+            }
+        }
+        return maxUs();
+    }
+
+    void LatencyHistogram::merge(const LatencyHistogram &other)
+    {
+        for (int b = 0; b < BUCKETS; ++b)
+        {
+            counts[b] += other.counts[b];
+        }
+        count += other.count;
+        sumNs += other.sumNs;
+        maxNs = std::max(maxNs, other.maxNs);
+    }
+
+    void LatencyHistogram::record(uint64_t ns)
+    {
+        counts[bucketOf(ns)]++;
+        count++;
+        sumNs += ns;
+        maxNs = std::max(maxNs, ns);
+    }
+
+    void StageLatencySnapshot::merge(const StageLatencySnapshot &other)
+    {
+        windowMs += other.windowMs;
+        for (int s = 0; s < PIPELINE_STAGE_COUNT; ++s)
+        {
+            stages[s].merge(other.stages[s]);
+        }
+    }
+
+    // ===== StageProfiler =====
+
+    StageProfiler::StageProfiler()
+    {
+        m_windowStartNs.store(nowNs(), std::memory_order_relaxed);
+    }
+
+    void StageProfiler::record(PipelineStage stage, uint64_t ns)
+    {
+        if (stage >= PipelineStage::Count)
+        {
+            return;
+        }
+
+        AtomicHistogram &hist = m_stages[static_cast<int>(stage)];
+        hist.counts[LatencyHistogram::bucketOf(ns)].fetch_add(1, std::memory_order_relaxed);
+        hist.count.fetch_add(1, std::memory_order_relaxed);
+        hist.sumNs.fetch_add(ns, std::memory_order_relaxed);
+
+        uint64_t currentMax = hist.maxNs.load(std::memory_order_relaxed);
+        while (ns > currentMax &&
+               !hist.maxNs.compare_exchange_weak(currentMax, ns, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    double StageProfiler::windowElapsedMs() const
+    {
+        return (nowNs() - m_windowStartNs.load(std::memory_order_relaxed)) / 1e6;
+    }
+
+    StageLatencySnapshot StageProfiler::collect()
+    {
+        StageLatencySnapshot snapshot;
+        const int64_t now = nowNs();
+        snapshot.windowMs = (now - m_windowStartNs.exchange(now, std::memory_order_relaxed)) / 1e6;
+
+        for (int s = 0; s < PIPELINE_STAGE_COUNT; ++s)
+        {
+            AtomicHistogram &source = m_stages[s];
+            LatencyHistogram &target = snapshot.stages[s];
+            for (int b = 0; b < LatencyHistogram::BUCKETS; ++b)
+            {
+                target.counts[b] = source.counts[b].exchange(0, std::memory_order_relaxed);
+            }
+            target.count = source.count.exchange(0, std::memory_order_relaxed);
+            target.sumNs = source.sumNs.exchange(0, std::memory_order_relaxed);
+            target.maxNs = source.maxNs.exchange(0, std::memory_order_relaxed);
+        }
+        return snapshot;
+    }
+
+} // namespace basler
@@ -0,0 +1,479 @@
+#include "core/thread_affinity.h"
+#include <QDebug>
+#include <QThread>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#if defined(Q_OS_LINUX) || defined(Q_OS_MACOS)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#ifdef Q_OS_LINUX
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#ifdef Q_OS_WIN
+#define NOMINMAX  // 防止 windows.h 定義 min/max 宏，避免與 std::max 衝突
+#include <windows.h>
+#endif
+
+namespace basler
+{
+
+    bool pinCurrentThreadToCore(int core)
+    {
+        if (core < 0)
+        {
+            return true;
+        }
+        if (core >= logicalCoreCount())
+        {
+            qWarning() << "[ThreadAffinity] 核心編號超出範圍:" << core << "/" << logicalCoreCount();
+            return false;
+        }
+
+#if defined(Q_OS_LINUX)
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(core, &set);
+        const int rc = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        if (rc != 0)
+        {
+            qWarning() << "[ThreadAffinity] pthread_setaffinity_np 失敗:" << rc << "core =" << core;
+            return false;
+        }
+        return true;
+#elif defined(Q_OS_WIN)
+        if (core >= static_cast<int>(sizeof(DWORD_PTR) * 8))
+        {
+            return false;
+        }
+        if (SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << core) == 0)
+        {
+            qWarning() << "[ThreadAffinity] SetThreadAffinityMask 失敗:" << GetLastError() << "core =" << core;
+            return false;
+        }
+        return true;
+#else
+        qWarning() << "[ThreadAffinity] 此平台不支援線程綁核，core =" << core;
+        return false;
+#endif
+    }
+
+    bool raiseCurrentThreadToRealtime()
+    {
+#if defined(Q_OS_LINUX)
+        sched_param param{};
+        param.sched_priority = sched_get_priority_min(SCHED_FIFO) + 1;
+        const int rc = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+        if (rc != 0)
+        {
+            qWarning() << "[ThreadAffinity] 無法設定 SCHED_FIFO（權限不足？）:" << rc;
+            return false;
+        }
+        return true;
+#elif defined(Q_OS_WIN)
+        if (!SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL))
+        {
+            qWarning() << "[ThreadAffinity] SetThreadPriority 失敗:" << GetLastError();
+            return false;
+        }
+        return true;
+#else
+        qWarning() << "[ThreadAffinity] 此平台不支援即時排程";
+        return false;
+#endif
+    }
+
+    namespace
+    {
+#ifdef Q_OS_LINUX
+        std::vector<int> readCpuListFile(const std::string &path)
+        {
+            std::ifstream file(path);
+            std::string text;
+            if (!file || !std::getline(file, text))
+            {
+                return {};
+            }
+            return parseCpuList(text);
+        }
+#endif
+    }
+
+    bool setCurrentThreadAffinity(const std::vector<int> &cores)
+    {
+        if (cores.empty())
+        {
+            return true;
+        }
+
+#if defined(Q_OS_LINUX)
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        int valid = 0;
+        for (int core : cores)
+        {
+            if (core >= 0 && core < CPU_SETSIZE)
+            {
+                CPU_SET(core, &set);
+                ++valid;
+            }
+        }
+        if (valid == 0)
+        {
+            return false;
+        }
+        const int rc = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        if (rc != 0)
+        {
+            qWarning() << "[ThreadAffinity] pthread_setaffinity_np 失敗:" << rc
+                       << "cores =" << QString::fromStdString(formatCpuList(cores));
+            return false;
+        }
+        return true;
+#elif defined(Q_OS_WIN)
+        DWORD_PTR mask = 0;
+        for (int core : cores)
+        {
+            if (core >= 0 && core < static_cast<int>(sizeof(DWORD_PTR) * 8))
+            {
+                mask |= DWORD_PTR(1) << core;
+            }
+        }
+        if (mask == 0 || SetThreadAffinityMask(GetCurrentThread(), mask) == 0)
+        {
+            qWarning() << "[ThreadAffinity] SetThreadAffinityMask 失敗:" << GetLastError()
+                       << "cores =" << QString::fromStdString(formatCpuList(cores));
+            return false;
+        }
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    std::vector<int> currentThreadAffinity()
+    {
+        std::vector<int> cores;
+#if defined(Q_OS_LINUX)
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (pthread_getaffinity_np(pthread_self(), sizeof(set), &set) == 0)
+        {
+            for (int core = 0; core < CPU_SETSIZE; ++core)
+            {
+                if (CPU_ISSET(core, &set))
+                {
+                    cores.push_back(core);
+                }
+            }
+        }
+#elif defined(Q_OS_WIN)
+        // Windows 沒有 GetThreadAffinityMask：暫時設為程序遮罩取回舊值後還原
+        DWORD_PTR processMask = 0, systemMask = 0;
+        if (GetProcessAffinityMask(GetCurrentProcess(), &processMask, &systemMask))
+        {
+            const DWORD_PTR mask = SetThreadAffinityMask(GetCurrentThread(), processMask);
+            if (mask != 0)
+            {
+                SetThreadAffinityMask(GetCurrentThread(), mask);
+                for (int core = 0; core < static_cast<int>(sizeof(DWORD_PTR) * 8); ++core)
+                {
+                    if (mask & (DWORD_PTR(1) << core))
+                    {
+                        cores.push_back(core);
+                    }
+                }
+            }
+        }
+#endif
+        return cores;
+    }
+
+    int currentCpu()
+    {
+#if defined(Q_OS_LINUX)
+        return sched_getcpu();
+#elif defined(Q_OS_WIN)
+        return static_cast<int>(GetCurrentProcessorNumber());
+#else
+        return -1;
+#endif
+    }
+
+    bool setCurrentThreadPriority(ThreadPriority priority)
+    {
+        switch (priority)
+        {
+        case ThreadPriority::Normal:
+            return true;
+        case ThreadPriority::Realtime:
+            return raiseCurrentThreadToRealtime();
+        case ThreadPriority::High:
+            break;
+        }
+
+#if defined(Q_OS_LINUX)
+        // Linux 的 nice 值以線程為單位（NPTL），負值需 CAP_SYS_NICE 或 RLIMIT_NICE
+        if (setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), -10) != 0)
+        {
+            qWarning() << "[ThreadAffinity] 無法提高 nice 值（權限不足？）";
+            return false;
+        }
+        return true;
+#elif defined(Q_OS_WIN)
+        if (!SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_HIGHEST))
+        {
+            qWarning() << "[ThreadAffinity] SetThreadPriority 失敗:" << GetLastError();
+            return false;
+        }
+        return true;
+#elif defined(Q_OS_MACOS)
+        return pthread_set_qos_class_self_np(QOS_CLASS_USER_INTERACTIVE, 0) == 0;
+#else
+        return false;
+#endif
+    }
+
+    std::vector<int> coresOfClass(CoreClass coreClass)
+    {
+        if (coreClass == CoreClass::Any)
+        {
+            return {};
+        }
+
+#if defined(Q_OS_LINUX)
+        // Intel 混合架構：核心 PMU 分為 cpu_core（P 核）與 cpu_atom（E 核）
+        const std::vector<int> performance = readCpuListFile("/sys/devices/cpu_core/cpus");
+        const std::vector<int> efficiency = readCpuListFile("/sys/devices/cpu_atom/cpus");
+        if (!performance.empty() && !efficiency.empty())
+        {
+            return coreClass == CoreClass::Performance ? performance : efficiency;
+        }
+
+        // ARM big.LITTLE：cpu_capacity 最高者為大核
+        std::vector<std::pair<int, long>> capacities;
+        for (int core = 0; core < logicalCoreCount(); ++core)
+        {
+            std::ifstream file("/sys/devices/system/cpu/cpu" + std::to_string(core) + "/cpu_capacity");
+            long capacity = 0;
+            if (file >> capacity)
+            {
+                capacities.emplace_back(core, capacity);
+            }
+        }
+        if (capacities.empty())
+        {
+            return {};
+        }
+        const auto [minIt, maxIt] = std::minmax_element(capacities.begin(), capacities.end(),
+                                                        [](const auto &a, const auto &b)
+                                                        { return a.second < b.second; });
+        const long maxCapacity = maxIt->second;
+        if (minIt->second == maxCapacity)
+        {
+            return {}; // 同質核心
+        }
+        std::vector<int> cores;
+        for (const auto &[core, capacity] : capacities)
+        {
+            if ((capacity == maxCapacity) == (coreClass == CoreClass::Performance))
+            {
+                cores.push_back(core);
+            }
+        }
+        return cores;
+#elif defined(Q_OS_WIN)
+        // Windows 10 起才有 GetSystemCpuSetInformation；EfficiencyClass 越大越偏向效能
+        using GetSystemCpuSetInformationFn = BOOL(WINAPI *)(PSYSTEM_CPU_SET_INFORMATION, ULONG, PULONG, HANDLE, ULONG);
+        static const auto getCpuSets = reinterpret_cast<GetSystemCpuSetInformationFn>(reinterpret_cast<void *>(
+            GetProcAddress(GetModuleHandleW(L"kernel32.dll"), "GetSystemCpuSetInformation")));
+        if (!getCpuSets)
+        {
+            return {};
+        }
+        ULONG length = 0;
+        getCpuSets(nullptr, 0, &length, GetCurrentProcess(), 0);
+        std::vector<char> buffer(length);
+        if (length == 0 || !getCpuSets(reinterpret_cast<PSYSTEM_CPU_SET_INFORMATION>(buffer.data()), length, &length,
+                                       GetCurrentProcess(), 0))
+        {
+            return {};
+        }
+
+        std::vector<std::pair<int, int>> classes; // (核心, EfficiencyClass)，僅處理器群組 0
+        for (ULONG offset = 0; offset < length;)
+        {
+            const auto *info = reinterpret_cast<const SYSTEM_CPU_SET_INFORMATION *>(buffer.data() + offset);
+            if (info->Type == CpuSetInformation && info->CpuSet.Group == 0)
+            {
+                classes.emplace_back(info->CpuSet.LogicalProcessorIndex, info->CpuSet.EfficiencyClass);
+            }
+            offset += info->Size;
+        }
+        if (classes.empty())
+        {
+            return {};
+        }
+        const auto [minIt, maxIt] = std::minmax_element(classes.begin(), classes.end(),
+                                                        [](const auto &a, const auto &b)
+                                                        { return a.second < b.second; });
+        const int maxClass = maxIt->second;
+        if (minIt->second == maxClass)
+        {
+            return {};
+        }
+        std::vector<int> cores;
+        for (const auto &[core, efficiencyClass] : classes)
+        {
+            if ((efficiencyClass == maxClass) == (coreClass == CoreClass::Performance))
+            {
+                cores.push_back(core);
+            }
+        }
+        std::sort(cores.begin(), cores.end());
+        return cores;
+#else
+        return {};
+#endif
+    }
+
+    bool hintCurrentThreadCoreClass(CoreClass coreClass)
+    {
+#if defined(Q_OS_MACOS)
+        // Apple Silicon：user-interactive 優先排在 P 核，background 限制在 E 核
+        switch (coreClass)
+        {
+        case CoreClass::Performance:
+            return pthread_set_qos_class_self_np(QOS_CLASS_USER_INTERACTIVE, 0) == 0;
+        case CoreClass::Efficiency:
+            return pthread_set_qos_class_self_np(QOS_CLASS_BACKGROUND, 0) == 0;
+        case CoreClass::Any:
+            return true;
+        }
+        return false;
+#else
+        Q_UNUSED(coreClass);
+        return false;
+#endif
+    }
+
+    std::vector<int> coresOfNumaNode(int node)
+    {
+        if (node < 0)
+        {
+            return {};
+        }
+#if defined(Q_OS_LINUX)
+        return readCpuListFile("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+#elif defined(Q_OS_WIN)
+        GROUP_AFFINITY affinity{};
+        if (!GetNumaNodeProcessorMaskEx(static_cast<USHORT>(node), &affinity) || affinity.Group != 0)
+        {
+            return {};
+        }
+        std::vector<int> cores;
+        for (int core = 0; core < static_cast<int>(sizeof(KAFFINITY) * 8); ++core)
+        {
+            if (affinity.Mask & (KAFFINITY(1) << core))
+            {
+                cores.push_back(core);
+            }
+        }
+        return cores;
+#else
+        return {};
+#endif
+    }
+
+    std::vector<int> parseCpuList(const std::string &text)
+    {
+        std::vector<int> cores;
+        std::stringstream stream(text);
+        std::string item;
+        while (std::getline(stream, item, ','))
+        {
+            int first = 0, last = 0;
+            char extra = 0;
+            const int fields = std::sscanf(item.c_str(), " %d - %d %c", &first, &last, &extra);
+            if (fields == 1)
+            {
+                if (std::sscanf(item.c_str(), " %d %c", &first, &extra) != 1)
+                {
+                    continue; // 例如 "3x"
+                }
+                last = first;
+            }
+            else if (fields != 2)
+            {
+                continue;
+            }
+            for (int core = std::max(0, first); core <= last && core < 4096; ++core)
+            {
+                cores.push_back(core);
+            }
+        }
+        std::sort(cores.begin(), cores.end());
+        cores.erase(std::unique(cores.begin(), cores.end()), cores.end());
+        return cores;
+    }
+
+    std::string formatCpuList(const std::vector<int> &cores)
+    {
+        std::string text;
+        for (size_t i = 0; i < cores.size();)
+        {
+            size_t j = i;
+            while (j + 1 < cores.size() && cores[j + 1] == cores[j] + 1)
+            {
+                ++j;
+            }
+            if (!text.empty())
+            {
+                text += ',';
+            }
+            text += std::to_string(cores[i]);
+            if (j > i)
+            {
+                text += '-' + std::to_string(cores[j]);
+            }
+            i = j + 1;
+        }
+        return text;
+    }
+
+    void setCurrentThreadName(const char *name)
+    {
+#if defined(Q_OS_LINUX)
+        const std::string truncated = std::string(name).substr(0, 15); // 含結尾共 16 bytes
+        pthread_setname_np(pthread_self(), truncated.c_str());
+#elif defined(Q_OS_MACOS)
+        pthread_setname_np(name); // macOS 只能命名呼叫線程
+#elif defined(Q_OS_WIN)
+        // 以 GetProcAddress 取得，避免在舊版 Windows 上載入失敗
+        using SetThreadDescriptionFn = HRESULT(WINAPI *)(HANDLE, PCWSTR);
+        static const auto setDescription = reinterpret_cast<SetThreadDescriptionFn>(
+            reinterpret_cast<void *>(GetProcAddress(GetModuleHandleW(L"kernel32.dll"), "SetThreadDescription")));
+        if (setDescription)
+        {
+            setDescription(GetCurrentThread(), QString::fromUtf8(name).toStdWString().c_str());
+        }
+#else
+        Q_UNUSED(name);
+#endif
+    }
+
+    int logicalCoreCount()
+    {
+        return std::max(1, QThread::idealThreadCount());
+    }
+
+} // namespace basler
@@ -0,0 +1,378 @@
+#include "core/thread_cpu_sampler.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__linux__)
+#include <dirent.h>
+#include <unistd.h>
+#elif defined(_WIN32)
+#define NOMINMAX  // 防止 windows.h 定義 min/max 宏，避免與 std::max 衝突
+#include <windows.h>
+#include <psapi.h>
+#include <tlhelp32.h>
+#elif defined(__APPLE__)
+#include <mach/mach.h>
+#include <pthread.h>
+#endif
+
+namespace basler
+{
+
+#if defined(__linux__)
+
+    namespace
+    {
+        bool readSmallFile(const char *path, char *buffer, size_t size)
+        {
+            FILE *file = std::fopen(path, "r");
+            if (!file)
+            {
+                return false;
+            }
+            const size_t n = std::fread(buffer, 1, size - 1, file);
+            std::fclose(file);
+            buffer[n] = '\0';
+            return n > 0;
+        }
+
+        /**
+         * @brief 讀取 /proc/.../stat 中 comm 之後的欄位（comm 可能含空白，從最後一個 ')' 起算）
+         * @param index 從 state 欄位（第 3 欄）起算的索引
+         */
+        bool statField(const char *stat, int index, unsigned long long &value)
+        {
+            const char *p = std::strrchr(stat, ')');
+            if (!p)
+            {
+                return false;
+            }
+            ++p;
+            for (int i = 0; i <= index; ++i)
+            {
+                while (*p == ' ')
+                {
+                    ++p;
+                }
+                if (*p == '\0')
+                {
+                    return false;
+                }
+                if (i == index)
+                {
+                    return std::sscanf(p, "%llu", &value) == 1;
+                }
+                while (*p && *p != ' ')
+                {
+                    ++p;
+                }
+            }
+            return false;
+        }
+    }
+
+    bool readThreadCpuTimes(std::vector<ThreadCpuTimes> &threads)
+    {
+        threads.clear();
+        DIR *dir = opendir("/proc/self/task");
+        if (!dir)
+        {
+            return false;
+        }
+
+        static const long ticksPerSec = sysconf(_SC_CLK_TCK);
+        char path[64];
+        char buffer[512];
+        while (dirent *entry = readdir(dir))
+        {
+            if (entry->d_name[0] < '0' || entry->d_name[0] > '9')
+            {
+                continue;
+            }
+            const unsigned long long tid = std::strtoull(entry->d_name, nullptr, 10);
+            ThreadCpuTimes thread;
+            thread.id = tid;
+
+            // schedstat 第一欄為實際在 CPU 上的奈秒數（比 clock tick 精確）
+            std::snprintf(path, sizeof(path), "/proc/self/task/%llu/schedstat", tid);
+            unsigned long long onCpuNs = 0;
+            if (readSmallFile(path, buffer, sizeof(buffer)) && std::sscanf(buffer, "%llu", &onCpuNs) == 1)
+            {
+                thread.cpuNs = onCpuNs;
+            }
+            else
+            {
+                // 核心未啟用 schedstats：utime + stime（第 14、15 欄）
+                std::snprintf(path, sizeof(path), "/proc/self/task/%llu/stat", tid);
+                unsigned long long utime = 0, stime = 0;
+                if (!readSmallFile(path, buffer, sizeof(buffer)) || !statField(buffer, 11, utime) ||
+                    !statField(buffer, 12, stime))
+                {
+                    continue; // 線程已結束
+                }
+                thread.cpuNs = (utime + stime) * 1000000000ULL / static_cast<unsigned long long>(ticksPerSec);
+            }
+
+            std::snprintf(path, sizeof(path), "/proc/self/task/%llu/comm", tid);
+            if (readSmallFile(path, buffer, sizeof(buffer)))
+            {
+                thread.name = buffer;
+                while (!thread.name.empty() && thread.name.back() == '\n')
+                {
+                    thread.name.pop_back();
+                }
+            }
+            threads.push_back(std::move(thread));
+        }
+        closedir(dir);
+        return true;
+    }
+
+    bool readProcessMemory(ProcessMemoryStats &stats)
+    {
+        static const long pageSize = sysconf(_SC_PAGESIZE);
+        char buffer[512];
+
+        unsigned long long sizePages = 0, residentPages = 0;
+        if (!readSmallFile("/proc/self/statm", buffer, sizeof(buffer)) ||
+            std::sscanf(buffer, "%llu %llu", &sizePages, &residentPages) != 2)
+        {
+            return false;
+        }
+        stats.residentBytes = residentPages * static_cast<unsigned long long>(pageSize);
+
+        // minflt（第 10 欄）+ majflt（第 12 欄）
+        unsigned long long minorFaults = 0, majorFaults = 0;
+        if (readSmallFile("/proc/self/stat", buffer, sizeof(buffer)) && statField(buffer, 7, minorFaults) &&
+            statField(buffer, 9, majorFaults))
+        {
+            stats.pageFaults = minorFaults + majorFaults;
+        }
+        return true;
+    }
+
+#elif defined(_WIN32)
+
+    namespace
+    {
+        uint64_t fileTimeToNs(const FILETIME &time)
+        {
+            ULARGE_INTEGER value;
+            value.LowPart = time.dwLowDateTime;
+            value.HighPart = time.dwHighDateTime;
+            return value.QuadPart * 100ULL; // 100ns 單位
+        }
+
+        std::string threadDescription(HANDLE thread)
+        {
+            // Windows 10 1607 起才有 GetThreadDescription
+            using GetThreadDescriptionFn = HRESULT(WINAPI *)(HANDLE, PWSTR *);
+            static const auto getDescription = reinterpret_cast<GetThreadDescriptionFn>(
+                reinterpret_cast<void *>(GetProcAddress(GetModuleHandleW(L"kernel32.dll"), "GetThreadDescription")));
+            if (!getDescription)
+            {
+                return {};
+            }
+            PWSTR wide = nullptr;
+            if (FAILED(getDescription(thread, &wide)) || !wide)
+            {
+                return {};
+            }
+            std::string name;
+            const int length = WideCharToMultiByte(CP_UTF8, 0, wide, -1, nullptr, 0, nullptr, nullptr);
+            if (length > 1)
+            {
+                name.resize(static_cast<size_t>(length - 1));
+                WideCharToMultiByte(CP_UTF8, 0, wide, -1, &name[0], length, nullptr, nullptr);
+            }
+            LocalFree(wide);
+            return name;
+        }
+    }
+
+    bool readThreadCpuTimes(std::vector<ThreadCpuTimes> &threads)
+    {
+        threads.clear();
+        HANDLE snapshot = CreateToolhelp32Snapshot(TH32CS_SNAPTHREAD, 0);
+        if (snapshot == INVALID_HANDLE_VALUE)
+        {
+            return false;
+        }
+
+        const DWORD processId = GetCurrentProcessId();
+        THREADENTRY32 entry;
+        entry.dwSize = sizeof(entry);
+        for (BOOL ok = Thread32First(snapshot, &entry); ok; ok = Thread32Next(snapshot, &entry))
+        {
+            if (entry.th32OwnerProcessID != processId)
+            {
+                continue;
+            }
+            HANDLE thread = OpenThread(THREAD_QUERY_LIMITED_INFORMATION, FALSE, entry.th32ThreadID);
+            if (!thread)
+            {
+                continue;
+            }
+            FILETIME creation, exit, kernel, user;
+            if (GetThreadTimes(thread, &creation, &exit, &kernel, &user))
+            {
+                ThreadCpuTimes times;
+                times.id = entry.th32ThreadID;
+                times.name = threadDescription(thread);
+                times.cpuNs = fileTimeToNs(kernel) + fileTimeToNs(user);
+                threads.push_back(std::move(times));
+            }
+            CloseHandle(thread);
+        }
+        CloseHandle(snapshot);
+        return true;
+    }
+
+    bool readProcessMemory(ProcessMemoryStats &stats)
+    {
+        PROCESS_MEMORY_COUNTERS counters;
+        if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        {
+            return false;
+        }
+        stats.residentBytes = counters.WorkingSetSize;
+        stats.pageFaults = counters.PageFaultCount;
+        return true;
+    }
+
+#elif defined(__APPLE__)
+
+    bool readThreadCpuTimes(std::vector<ThreadCpuTimes> &threads)
+    {
+        threads.clear();
+        thread_act_array_t list = nullptr;
+        mach_msg_type_number_t count = 0;
+        if (task_threads(mach_task_self(), &list, &count) != KERN_SUCCESS)
+        {
+            return false;
+        }
+
+        for (mach_msg_type_number_t i = 0; i < count; ++i)
+        {
+            thread_extended_info_data_t extended;
+            mach_msg_type_number_t extendedCount = THREAD_EXTENDED_INFO_COUNT;
+            thread_identifier_info_data_t identifier;
+            mach_msg_type_number_t identifierCount = THREAD_IDENTIFIER_INFO_COUNT;
+            if (thread_info(list[i], THREAD_EXTENDED_INFO, reinterpret_cast<thread_info_t>(&extended),
+                            &extendedCount) == KERN_SUCCESS &&
+                thread_info(list[i], THREAD_IDENTIFIER_INFO, reinterpret_cast<thread_info_t>(&identifier),
+                            &identifierCount) == KERN_SUCCESS)
+            {
+                ThreadCpuTimes times;
+                times.id = identifier.thread_id;
+                times.name = extended.pth_name;
+                times.cpuNs = extended.pth_user_time + extended.pth_system_time; // 已是奈秒
+                threads.push_back(std::move(times));
+            }
+            mach_port_deallocate(mach_task_self(), list[i]);
+        }
+        vm_deallocate(mach_task_self(), reinterpret_cast<vm_address_t>(list), sizeof(thread_act_t) * count);
+        return true;
+    }
+
+    bool readProcessMemory(ProcessMemoryStats &stats)
+    {
+        task_vm_info_data_t vmInfo;
+        mach_msg_type_number_t vmCount = TASK_VM_INFO_COUNT;
+        if (task_info(mach_task_self(), TASK_VM_INFO, reinterpret_cast<task_info_t>(&vmInfo), &vmCount) !=
+            KERN_SUCCESS)
+        {
+            return false;
+        }
+        stats.residentBytes = vmInfo.phys_footprint;
+
+        task_events_info_data_t events;
+        mach_msg_type_number_t eventsCount = TASK_EVENTS_INFO_COUNT;
+        if (task_info(mach_task_self(), TASK_EVENTS_INFO, reinterpret_cast<task_info_t>(&events), &eventsCount) ==
+            KERN_SUCCESS)
+        {
+            stats.pageFaults = static_cast<uint64_t>(events.faults);
+        }
+        return true;
+    }
+
+#else
+
+    bool readThreadCpuTimes(std::vector<ThreadCpuTimes> &threads)
+    {
+        threads.clear();
+        return false;
+    }
+
+    bool readProcessMemory(ProcessMemoryStats &)
+    {
+        return false;
+    }
+
+#endif
+
+    ProcessUsageSample ThreadCpuSampler::sample()
+    {
+        ProcessUsageSample result;
+        const auto now = Clock::now();
+        const double intervalSec = m_hasLast ? std::chrono::duration<double>(now - m_lastSample).count() : 0.0;
+
+        ProcessMemoryStats memory;
+        const bool hasMemory = readProcessMemory(memory);
+        if (!readThreadCpuTimes(m_threads) && !hasMemory)
+        {
+            return result;
+        }
+
+        std::unordered_map<uint64_t, uint64_t> current;
+        current.reserve(m_threads.size());
+        result.threads.reserve(m_threads.size());
+        uint64_t totalDeltaNs = 0;
+        for (const ThreadCpuTimes &thread : m_threads)
+        {
+            current[thread.id] = thread.cpuNs;
+            ThreadCpuUsage usage;
+            usage.id = thread.id;
+            usage.name = thread.name;
+            usage.cpuSeconds = thread.cpuNs / 1e9;
+            if (intervalSec > 0.0)
+            {
+                // 新線程沒有上一筆：以 0 為基準會把啟動前的累計算入本區間，改以本次為基準
+                const auto last = m_lastCpuNs.find(thread.id);
+                const uint64_t deltaNs =
+                    (last != m_lastCpuNs.end() && thread.cpuNs >= last->second) ? thread.cpuNs - last->second : 0;
+                totalDeltaNs += deltaNs;
+                usage.cpuPercent = deltaNs / 1e9 / intervalSec * 100.0;
+            }
+            result.threads.push_back(std::move(usage));
+        }
+        std::sort(result.threads.begin(), result.threads.end(),
+                  [](const ThreadCpuUsage &a, const ThreadCpuUsage &b)
+                  { return a.cpuPercent != b.cpuPercent ? a.cpuPercent > b.cpuPercent : a.cpuSeconds > b.cpuSeconds; });
+
+        result.residentMb = memory.residentBytes / (1024.0 * 1024.0);
+        if (intervalSec > 0.0)
+        {
+            result.intervalSec = intervalSec;
+            result.processCpuPercent = totalDeltaNs / 1e9 / intervalSec * 100.0;
+            if (hasMemory)
+            {
+                result.residentMbPerSec =
+                    (static_cast<double>(memory.residentBytes) - static_cast<double>(m_lastMemory.residentBytes)) /
+                    (1024.0 * 1024.0) / intervalSec;
+                result.pageFaultsPerSec =
+                    memory.pageFaults >= m_lastMemory.pageFaults
+                        ? (memory.pageFaults - m_lastMemory.pageFaults) / intervalSec
+                        : 0.0;
+            }
+        }
+
+        m_lastCpuNs.swap(current); // 已結束的線程自然移除
+        m_lastMemory = memory;
+        m_lastSample = now;
+        m_hasLast = true;
+        return result;
+    }
+
+} // namespace basler
@@ -0,0 +1,180 @@
+#include "core/thread_scheduling.h"
+#include "core/thread_affinity.h"
+#include "config/settings.h"
+#include <QDebug>
+#include <algorithm>
+#include <iterator>
+
+namespace basler
+{
+
+    namespace
+    {
+        const ThreadSchedulingConfig &roleConfig(const SchedulingConfig &scheduling, ThreadRole role)
+        {
+            switch (role)
+            {
+            case ThreadRole::Grab:
+                return scheduling.grab;
+            case ThreadRole::Detection:
+                return scheduling.detection;
+            case ThreadRole::Inference:
+                return scheduling.inference;
+            case ThreadRole::Recording:
+                return scheduling.recording;
+            case ThreadRole::Control:
+                return scheduling.control;
+            case ThreadRole::Ui:
+                break;
+            }
+            return scheduling.ui;
+        }
+
+        ThreadPriority parsePriority(const QString &text)
+        {
+            if (text == "realtime")
+            {
+                return ThreadPriority::Realtime;
+            }
+            if (text == "high")
+            {
+                return ThreadPriority::High;
+            }
+            if (text != "normal")
+            {
+                qWarning() << "[ThreadScheduling] 未知的優先權:" << text << "，使用 normal";
+            }
+            return ThreadPriority::Normal;
+        }
+
+        CoreClass parseCoreClass(const QString &text)
+        {
+            if (text == "performance")
+            {
+                return CoreClass::Performance;
+            }
+            if (text == "efficiency")
+            {
+                return CoreClass::Efficiency;
+            }
+            if (text != "any")
+            {
+                qWarning() << "[ThreadScheduling] 未知的核心類型:" << text << "，使用 any";
+            }
+            return CoreClass::Any;
+        }
+
+        /**
+         * @brief 以 hint 縮小允許核心；hint 為空（無法判斷）時不變，交集為空時保留原集合
+         */
+        bool narrowCores(std::vector<int> &cores, const std::vector<int> &hint)
+        {
+            if (hint.empty())
+            {
+                return false;
+            }
+            if (cores.empty())
+            {
+                cores = hint;
+                return true;
+            }
+            std::vector<int> intersection;
+            std::set_intersection(cores.begin(), cores.end(), hint.begin(), hint.end(),
+                                  std::back_inserter(intersection));
+            if (intersection.empty())
+            {
+                return false;
+            }
+            cores.swap(intersection);
+            return true;
+        }
+    }
+
+    const char *threadRoleName(ThreadRole role)
+    {
+        switch (role)
+        {
+        case ThreadRole::Grab:
+            return "grab";
+        case ThreadRole::Detection:
+            return "detection";
+        case ThreadRole::Inference:
+            return "inference";
+        case ThreadRole::Recording:
+            return "recording";
+        case ThreadRole::Control:
+            return "control";
+        case ThreadRole::Ui:
+            break;
+        }
+        return "ui";
+    }
+
+    void applyThreadScheduling(ThreadRole role, int pinnedCore)
+    {
+        // 新線程繼承建立者的 affinity：第一次呼叫時（主線程、尚未套用前）記下程序原本允許的核心，
+        // 未設定 affinity 的角色還原為此集合，避免 ui.affinity 連帶限制之後建立的線程
+        static const std::vector<int> processCores = currentThreadAffinity();
+
+        const SchedulingConfig &scheduling = Settings::instance().scheduling();
+        const char *name = threadRoleName(role);
+        if (!scheduling.enabled)
+        {
+            pinCurrentThreadToCore(pinnedCore);
+            return;
+        }
+        const ThreadSchedulingConfig &config = roleConfig(scheduling, role);
+
+        // 允許核心：單一核心覆寫優先，否則 affinity ∩ 核心類型 ∩ NUMA
+        std::vector<int> cores;
+        if (pinnedCore >= 0)
+        {
+            pinCurrentThreadToCore(pinnedCore);
+        }
+        else
+        {
+            const int available = logicalCoreCount();
+            cores = parseCpuList(config.affinity.toStdString());
+            cores.erase(std::remove_if(cores.begin(), cores.end(), [available](int core)
+                                       { return core >= available; }),
+                        cores.end());
+            if (!config.affinity.isEmpty() && cores.empty())
+            {
+                qWarning() << "[ThreadScheduling]" << name << "affinity 無可用核心:" << config.affinity;
+            }
+
+            const CoreClass coreClass = parseCoreClass(config.coreClass);
+            if (coreClass != CoreClass::Any && !narrowCores(cores, coresOfClass(coreClass)) &&
+                !hintCurrentThreadCoreClass(coreClass))
+            {
+                qWarning() << "[ThreadScheduling]" << name << "無法套用核心類型" << config.coreClass
+                           << "（非異質核心或與 affinity 無交集）";
+            }
+            if (config.numaNode >= 0 && !narrowCores(cores, coresOfNumaNode(config.numaNode)))
+            {
+                qWarning() << "[ThreadScheduling]" << name << "無法套用 NUMA 節點" << config.numaNode
+                           << "（節點不存在或與 affinity 無交集）";
+            }
+        }
+
+        if (cores.empty() && pinnedCore < 0 && currentThreadAffinity() != processCores)
+        {
+            cores = processCores;
+        }
+        if (!cores.empty() && !setCurrentThreadAffinity(cores))
+        {
+            qWarning() << "[ThreadScheduling]" << name << "綁核失敗，維持原排程";
+        }
+        const bool priorityApplied = setCurrentThreadPriority(parsePriority(config.priority));
+
+        // 實際結果（回讀作業系統的設定，而非配置值）
+        const std::vector<int> effective = currentThreadAffinity();
+        qDebug() << "[ThreadScheduling]" << name
+                 << "允許核心" << (effective.empty() ? QString("不限") : QString::fromStdString(formatCpuList(effective)))
+                 << "優先權" << config.priority << (priorityApplied ? "" : "(未套用)")
+                 << "核心類型" << config.coreClass
+                 << "NUMA" << config.numaNode
+                 << "目前 CPU" << currentCpu();
+    }
+
+} // namespace basler
@@ -0,0 +1,123 @@
+#include "core/track_table.h"
+#include <algorithm>
+
+namespace basler
+{
+
+    TrackTable::TrackTable(int reserveCapacity)
+    {
+        const size_t capacity = static_cast<size_t>(std::max(reserveCapacity, 0));
+        state.reserve(capacity);
+        forEachColumn([capacity](auto &column) { column.reserve(capacity); });
+    }
+
+    int TrackTable::count(State s) const
+    {
+        return static_cast<int>(std::count(state.begin(), state.end(), static_cast<quint8>(s)));
+    }
+
+    void TrackTable::clear()
+    {
+        // clear() 保留容量，之後新增不重新配置
+        state.clear();
+        forEachColumn([](auto &column) { column.clear(); });
+    }
+
+    int TrackTable::add(int id, int cx, int cy, int width, int height, int objArea, int frame)
+    {
+        trackId.push_back(id);
+        state.push_back(Active);
+        matched.push_back(0);
+        x.push_back(cx);
+        y.push_back(cy);
+        w.push_back(width);
+        h.push_back(height);
+        area.push_back(objArea);
+        firstFrame.push_back(frame);
+        lastFrame.push_back(frame);
+        inRoiFrames.push_back(1);
+        maxY.push_back(cy);
+        minY.push_back(cy);
+        firstY.push_back(cy);
+        counted.push_back(0);
+        velocityX.push_back(0.0);
+        velocityY.push_back(0.0);
+        predictedX.push_back(cx);
+        predictedY.push_back(cy);
+        missedFrames.push_back(0);
+
+        positions.emplace_back();
+        positions.back().push({cx, cy});
+        areaHistory.emplace_back();
+        areaHistory.back().push(objArea);
+
+        return size() - 1;
+    }
+
+    void TrackTable::observe(int slot, int cx, int cy, int width, int height, int objArea, int frame)
+    {
+        x[slot] = cx;
+        y[slot] = cy;
+        w[slot] = width;
+        h[slot] = height;
+        area[slot] = objArea;
+        lastFrame[slot] = frame;
+        positions[slot].push({cx, cy});
+        areaHistory[slot].push(objArea);
+        inRoiFrames[slot]++;
+        maxY[slot] = std::max(maxY[slot], cy);
+        minY[slot] = std::min(minY[slot], cy);
+        missedFrames[slot] = 0;
+    }
+
+    void TrackTable::updateVelocity(int slot)
+    {
+        const auto &history = positions[slot];
+        if (history.size() >= 2)
+        {
+            // 使用最近兩個位置計算速度
+            const TrackPoint &recent = history.back(0);
+            const TrackPoint &previous = history.back(1);
+
+            velocityX[slot] = recent.x - previous.x;
+            velocityY[slot] = recent.y - previous.y;
+
+            // 預測下一幀位置
+            predictedX[slot] = recent.x + velocityX[slot];
+            predictedY[slot] = recent.y + velocityY[slot];
+        }
+        else
+        {
+            // 沒有足夠歷史，使用當前位置
+            predictedX[slot] = x[slot];
+            predictedY[slot] = y[slot];
+        }
+    }
+
+    void TrackTable::compact()
+    {
+        const size_t total = state.size();
+        if (std::find(state.begin(), state.end(), static_cast<quint8>(Dead)) == state.end())
+        {
+            return;
+        }
+
+        // 各欄位以同一份 state 穩定壓縮，state 本身最後處理
+        forEachColumn([this, total](auto &column)
+                      {
+                          size_t write = 0;
+                          for (size_t read = 0; read < total; ++read)
+                          {
+                              if (state[read] == Dead)
+                                  continue;
+                              if (write != read)
+                                  column[write] = column[read];
+                              ++write;
+                          }
+                          column.resize(write); // 縮小不釋放容量
+                      });
+
+        state.erase(std::remove(state.begin(), state.end(), static_cast<quint8>(Dead)), state.end());
+    }
+
+} // namespace basler
@@ -0,0 +1,381 @@
+#include "core/vibrator_control_loop.h"
+#include "core/vibrator_controller.h"
+#include "core/thread_affinity.h"
+#include "core/thread_scheduling.h"
+#include "config/settings.h"
+#include <QDebug>
+#include <algorithm>
+#include <chrono>
+
+namespace basler {
+
+namespace {
+
+int64_t nowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+uint64_t elapsedNs(int64_t fromNs, int64_t toNs)
+{
+    return toNs > fromNs ? static_cast<uint64_t>(toNs - fromNs) : 0;
+}
+
+} // namespace
+
+// ============================================================================
+// CountEventQueue
+// ============================================================================
+
+CountEventQueue::CountEventQueue(int capacity)
+{
+    uint64_t size = 2;
+    while (size < static_cast<uint64_t>(std::max(2, capacity))) {
+        size <<= 1;
+    }
+    m_slots.reset(new Slot[size]);
+    m_mask = size - 1;
+    m_limit.store(size, std::memory_order_relaxed);
+    for (uint64_t i = 0; i < size; ++i) {
+        m_slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+bool CountEventQueue::push(const CountEvent& event)
+{
+    uint64_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+    for (;;) {
+        Slot& slot = m_slots[pos & m_mask];
+        const uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+        const int64_t diff = static_cast<int64_t>(sequence - pos);
+        if (diff == 0) {
+            if (pos - m_dequeuePos.load(std::memory_order_acquire) >= m_limit.load(std::memory_order_relaxed)) {
+                return false; // 已達排隊上限
+            }
+            // 槽位可寫：搶下這個位置
+            if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                slot.event = event;
+                slot.sequence.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (diff < 0) {
+            return false; // 已滿：消費者尚未取走上一輪的事件
+        } else {
+            pos = m_enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+bool CountEventQueue::pop(CountEvent& event)
+{
+    const uint64_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+    Slot& slot = m_slots[pos & m_mask];
+    if (slot.sequence.load(std::memory_order_acquire) != pos + 1) {
+        return false; // 空（或生產者仍在寫入）
+    }
+    event = slot.event;
+    slot.sequence.store(pos + m_mask + 1, std::memory_order_release);
+    m_dequeuePos.store(pos + 1, std::memory_order_relaxed);
+    return true;
+}
+
+void CountEventQueue::setLimit(int limit)
+{
+    m_limit.store(static_cast<uint64_t>(std::clamp(limit, 1, capacity())), std::memory_order_relaxed);
+}
+
+bool CountEventQueue::empty() const
+{
+    const uint64_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+    return m_slots[pos & m_mask].sequence.load(std::memory_order_acquire) != pos + 1;
+}
+
+// ============================================================================
+// VibratorLatencySnapshot
+// ============================================================================
+
+void VibratorLatencySnapshot::merge(const VibratorLatencySnapshot& other)
+{
+    dispatch.merge(other.dispatch);
+    actuation.merge(other.actuation);
+    stop.merge(other.stop);
+    countInterval.merge(other.countInterval);
+    droppedEvents += other.droppedEvents;
+    windowMs += other.windowMs;
+}
+
+// ============================================================================
+// VibratorControlLoop
+// ============================================================================
+
+VibratorControlLoop::VibratorControlLoop(QObject* parent)
+    : QObject(parent)
+{
+}
+
+VibratorControlLoop::~VibratorControlLoop()
+{
+    stop();
+}
+
+bool VibratorControlLoop::start()
+{
+    if (m_running.load()) {
+        return true;
+    }
+
+    const PackagingConfig& config = Settings::instance().packaging();
+    if (!config.realtimeControl || !m_vibrators) {
+        return false;
+    }
+
+    // 佇列不重建（停止後仍可能有檢測端的 post() 正在存取），只調整排隊上限
+    if (config.controlQueueCapacity > MAX_QUEUE_CAPACITY) {
+        qWarning() << "[VibratorControlLoop] controlQueueCapacity" << config.controlQueueCapacity
+                   << "超過上限，使用" << MAX_QUEUE_CAPACITY;
+    }
+    m_queue.setLimit(config.controlQueueCapacity);
+    CountEvent stale;
+    while (m_queue.pop(stale)) {
+    }
+
+    m_core = config.controlThreadCore;
+    m_spinNs = static_cast<int64_t>(std::max(0, config.controlSpinUs)) * 1000;
+    m_reportIntervalMs = std::max(0, config.latencyReportIntervalMs);
+    m_advanceStopCount = config.advanceStopCount;
+    m_lastApplied.fill(-1);
+    m_lastCountNs.fill(0);
+    {
+        std::lock_guard<std::mutex> lock(m_statsMutex);
+        m_window = VibratorLatencySnapshot();
+        m_total = VibratorLatencySnapshot();
+        m_windowStartNs = nowNs();
+    }
+    m_dropped.store(0);
+    m_actuationEstimateNs.store(0);
+
+    m_running.store(true);
+    m_thread = std::thread(&VibratorControlLoop::controlLoop, this);
+
+    qDebug() << "[VibratorControlLoop] 啟動: 核心" << m_core << ", 佇列" << m_queue.limit()
+             << ", 自旋" << config.controlSpinUs << "µs";
+    return true;
+}
+
+void VibratorControlLoop::stop()
+{
+    if (!m_running.exchange(false)) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_wakeCv.notify_one();
+    }
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+
+    logSnapshot("累計", total());
+    qDebug() << "[VibratorControlLoop] 已停止";
+}
+
+bool VibratorControlLoop::post(int lane, int count, int speedPercent)
+{
+    if (!m_running.load(std::memory_order_acquire)) {
+        return false;
+    }
+
+    CountEvent event;
+    event.lane = lane;
+    event.count = count;
+    event.speedPercent = speedPercent;
+    event.timestampNs = nowNs();
+    if (!m_queue.push(event)) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    // 與消費者的「設定 m_sleeping → 檢查佇列」配對，確保不會漏掉喚醒
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_sleeping.load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_wakeCv.notify_one();
+    }
+    return true;
+}
+
+VibratorLatencySnapshot VibratorControlLoop::collect()
+{
+    std::lock_guard<std::mutex> lock(m_statsMutex);
+    const int64_t now = nowNs();
+    VibratorLatencySnapshot snapshot = m_window;
+    snapshot.windowMs = elapsedNs(m_windowStartNs, now) / 1e6;
+    snapshot.droppedEvents = m_dropped.load() - m_total.droppedEvents;
+
+    m_total.droppedEvents += snapshot.droppedEvents;
+    m_total.windowMs += snapshot.windowMs;
+    m_window = VibratorLatencySnapshot();
+    m_windowStartNs = now;
+    return snapshot;
+}
+
+VibratorLatencySnapshot VibratorControlLoop::total() const
+{
+    std::lock_guard<std::mutex> lock(m_statsMutex);
+    VibratorLatencySnapshot snapshot = m_total;
+    snapshot.droppedEvents = m_dropped.load();
+    snapshot.windowMs += elapsedNs(m_windowStartNs, nowNs()) / 1e6;
+    return snapshot;
+}
+
+void VibratorControlLoop::controlLoop()
+{
+    setCurrentThreadName("VibratorCtrl");
+    applyThreadScheduling(ThreadRole::Control, m_core);
+
+    int64_t nextReportNs = nowNs() + static_cast<int64_t>(m_reportIntervalMs) * 1000000;
+    CountEvent event;
+
+    while (m_running.load()) {
+        if (waitForEvent(m_spinNs)) {
+            while (m_queue.pop(event)) {
+                handleEvent(event, nowNs());
+            }
+        }
+
+        if (m_reportIntervalMs > 0 && nowNs() >= nextReportNs) {
+            logSnapshot("窗口", collect());
+            nextReportNs = nowNs() + static_cast<int64_t>(m_reportIntervalMs) * 1000000;
+        }
+    }
+
+    // 停止前把已排入的事件處理完（停止指令不能遺失）
+    while (m_queue.pop(event)) {
+        handleEvent(event, nowNs());
+    }
+}
+
+bool VibratorControlLoop::waitForEvent(int64_t spinNs)
+{
+    // 1. 自旋：計數通常成串出現，避免每個事件都付一次喚醒延遲
+    const int64_t spinUntil = nowNs() + spinNs;
+    while (m_queue.empty()) {
+        if (!m_running.load(std::memory_order_relaxed)) {
+            return false;
+        }
+        if (nowNs() >= spinUntil) {
+            break;
+        }
+    }
+    if (!m_queue.empty()) {
+        return true;
+    }
+
+    // 2. 休眠：逾時只作保險（並讓延遲報告按時輸出）
+    std::unique_lock<std::mutex> lock(m_wakeMutex);
+    m_sleeping.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    m_wakeCv.wait_for(lock, std::chrono::milliseconds(10), [this]() {
+        return !m_queue.empty() || !m_running.load(std::memory_order_relaxed);
+    });
+    m_sleeping.store(false, std::memory_order_relaxed);
+    return !m_queue.empty();
+}
+
+void VibratorControlLoop::handleEvent(const CountEvent& event, int64_t dequeuedNs)
+{
+    const bool known = event.lane < MAX_LANES; // 超出的料道沒有對應震動機
+    const int slot = event.lane < 0 ? LANE_ALL : std::min(event.lane, LANE_ALL);
+
+    bool applied = false;
+    if (known && m_lastApplied[slot] != event.speedPercent) {
+        applied = applySpeed(event.lane, event.speedPercent);
+        if (applied) {
+            m_lastApplied[slot] = event.speedPercent;
+        }
+    }
+    const int64_t doneNs = nowNs();
+
+    std::lock_guard<std::mutex> lock(m_statsMutex);
+    const uint64_t dispatchNs = elapsedNs(event.timestampNs, dequeuedNs);
+    m_window.dispatch.record(dispatchNs);
+    m_total.dispatch.record(dispatchNs);
+    if (applied) {
+        const uint64_t actuationNs = elapsedNs(event.timestampNs, doneNs);
+        // 峰值立即跟上、下降時每次只回落 1/16（供預測式降速保守估計延遲）
+        const int64_t estimate = m_actuationEstimateNs.load(std::memory_order_relaxed);
+        const int64_t sample = static_cast<int64_t>(actuationNs);
+        m_actuationEstimateNs.store(sample >= estimate ? sample : estimate - (estimate - sample) / 16,
+                                    std::memory_order_relaxed);
+        m_window.actuation.record(actuationNs);
+        m_total.actuation.record(actuationNs);
+        if (event.speedPercent == 0) {
+            m_window.stop.record(actuationNs);
+            m_total.stop.record(actuationNs);
+        }
+    }
+    if (known) {
+        if (m_lastCountNs[slot] > 0) {
+            const uint64_t intervalNs = elapsedNs(m_lastCountNs[slot], event.timestampNs);
+            m_window.countInterval.record(intervalNs);
+            m_total.countInterval.record(intervalNs);
+        }
+        m_lastCountNs[slot] = event.timestampNs;
+    }
+}
+
+bool VibratorControlLoop::applySpeed(int lane, int speedPercent)
+{
+    if (lane >= 0) {
+        VibratorControllerBase* vibrator = m_vibrators->vibrator(lane);
+        if (!vibrator) {
+            return false;
+        }
+        vibrator->setSpeedPercent(speedPercent);
+        return true;
+    }
+
+    bool any = false;
+    for (VibratorControllerBase* vibrator : {m_vibrators->vibrator1(), m_vibrators->vibrator2()}) {
+        if (vibrator) {
+            vibrator->setSpeedPercent(speedPercent);
+            any = true;
+        }
+    }
+    return any;
+}
+
+void VibratorControlLoop::logSnapshot(const char* label, const VibratorLatencySnapshot& snapshot) const
+{
+    if (snapshot.dispatch.count == 0 && snapshot.droppedEvents == 0) {
+        return;
+    }
+
+    qDebug().nospace() << "[VibratorControlLoop] " << label << " " << snapshot.windowMs / 1000.0 << "s: "
+                       << "事件 " << snapshot.dispatch.count << "，丟棄 " << snapshot.droppedEvents
+                       << " | 計數→取出 p50/p99/max = " << snapshot.dispatch.percentileUs(0.5) << "/"
+                       << snapshot.dispatch.percentileUs(0.99) << "/" << snapshot.dispatch.maxUs() << " µs"
+                       << " | 計數→致動 p99 = " << snapshot.actuation.percentileUs(0.99) << " µs ("
+                       << snapshot.actuation.count << " 次)"
+                       << " | 停止 max = " << snapshot.stop.maxUs() << " µs (" << snapshot.stop.count << " 次)";
+
+    // 提前停止餘裕：advanceStopCount 顆零件落下所需時間（以較快的 5% 計數間隔估計）必須大於最慢的停止延遲
+    if (m_advanceStopCount <= 0 || snapshot.stop.count == 0 || snapshot.countInterval.count == 0) {
+        return;
+    }
+    const double budgetUs = m_advanceStopCount * snapshot.countInterval.percentileUs(0.05);
+    const double worstStopUs = snapshot.stop.maxUs();
+    if (worstStopUs < budgetUs) {
+        qDebug().nospace() << "[VibratorControlLoop] 提前停止餘裕足夠: " << m_advanceStopCount
+                           << " 顆 × 計數間隔 p5 = " << budgetUs / 1000.0 << " ms > 停止延遲 max "
+                           << worstStopUs / 1000.0 << " ms";
+    } else {
+        qWarning().nospace() << "[VibratorControlLoop] 提前停止餘裕不足: " << m_advanceStopCount
+                             << " 顆 × 計數間隔 p5 = " << budgetUs / 1000.0 << " ms <= 停止延遲 max "
+                             << worstStopUs / 1000.0 << " ms，建議提高 advanceStopCount";
+    }
+}
+
+} // namespace basler
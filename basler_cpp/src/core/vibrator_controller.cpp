@@ -1,7 +1,12 @@
 #include "core/vibrator_controller.h"
 #include "core/detection_controller.h" // for VibratorSpeed enum
+#include "config/settings.h"
 #include <QDebug>
 
+#ifdef HAVE_MODBUS_DRIVERS
+#include "core/modbus_vibrator.h"
+#endif
+
 namespace basler
 {
 
@@ -40,7 +45,7 @@ namespace basler
         }
 
         m_isRunning = true;
-        qDebug() << "[" << m_name << "] 啟動 (模擬), 速度:" << m_speedPercent << "%";
+        qDebug() << "[" << m_name << "] 啟動 (模擬), 速度:" << m_speedPercent.load() << "%";
         emit runningStateChanged(true);
     }
 
@@ -59,16 +64,14 @@ namespace basler
 
     void SimulatedVibratorController::setSpeedPercent(int percent)
     {
-        // 限制範圍 0-100
+        // 可能由即時控制線程呼叫：單次 exchange 判斷是否改變（並行呼叫只有一方發出信號），不記錄日誌
         percent = qBound(0, percent, 100);
 
-        if (m_speedPercent == percent)
+        if (m_speedPercent.exchange(percent) == percent)
         {
             return;
         }
 
-        m_speedPercent = percent;
-        qDebug() << "[" << m_name << "] 設置速度:" << percent << "% (模擬)";
         emit speedChanged(percent);
     }
 
@@ -200,23 +203,64 @@ namespace basler
         }
     }
 
+    VibratorControllerBase *DualVibratorManager::vibrator(int lane) const
+    {
+        switch (lane)
+        {
+        case 0:
+            return m_vibrator1.get();
+        case 1:
+            return m_vibrator2.get();
+        default:
+            return nullptr;
+        }
+    }
+
+    void DualVibratorManager::setLaneSpeed(int lane, VibratorSpeed speed)
+    {
+        VibratorControllerBase *target = vibrator(lane);
+        if (!target)
+        {
+            qWarning() << "[DualVibratorManager] 無此料道:" << lane;
+            return;
+        }
+
+        qDebug() << "[DualVibratorManager] 料道" << lane << "設置速度:" << static_cast<int>(speed) << "%";
+        target->setSpeed(speed);
+        emit laneSpeedChanged(lane, speed);
+    }
+
     // ============================================================================
     // 工廠函數實現
     // ============================================================================
 
     std::unique_ptr<VibratorControllerBase> createVibratorController(
         const QString &type,
-        const QString &name)
+        const QString &name,
+        int index)
     {
         if (type == "simulated" || type.isEmpty())
         {
             return std::make_unique<SimulatedVibratorController>(name);
         }
+
+        // "hardware" = 依設定檔 vibrator.driver 選擇實際驅動
+        const VibratorConfig &config = Settings::instance().vibrator();
+        const QString driver = (type == "hardware") ? config.driver : type;
+
+        if (driver == "modbus_rtu" || driver == "modbus_tcp")
+        {
+#ifdef HAVE_MODBUS_DRIVERS
+            const int unitId = (index == 0) ? config.unitId1 : config.unitId2;
+            return std::make_unique<ModbusVibratorController>(name, config, driver == "modbus_tcp", unitId);
+#else
+            qWarning() << "[createVibratorController] 未編譯 Modbus 驅動（需要 Qt SerialPort / Network），使用模擬控制器";
+            return std::make_unique<SimulatedVibratorController>(name + " (simulated)");
+#endif
+        }
         else if (type == "hardware")
         {
-            // TODO: 實現實際硬體控制器
-            // 目前返回模擬控制器並發出警告
-            qWarning() << "[createVibratorController] 硬體控制器尚未實現，使用模擬控制器";
+            qWarning() << "[createVibratorController] 未知硬體驅動:" << driver << "，使用模擬控制器";
             return std::make_unique<SimulatedVibratorController>(name + " (simulated)");
         }
         else
@@ -231,8 +275,8 @@ namespace basler
         const QString &name1,
         const QString &name2)
     {
-        auto vibrator1 = createVibratorController(controllerType, name1);
-        auto vibrator2 = createVibratorController(controllerType, name2);
+        auto vibrator1 = createVibratorController(controllerType, name1, 0);
+        auto vibrator2 = createVibratorController(controllerType, name2, 1);
 
         return std::make_unique<DualVibratorManager>(
             std::move(vibrator1),
@@ -1,19 +1,221 @@
 #include "core/video_player.h"
+#include "core/frame_ring.h"
+#include "core/raw_capture.h"
+#include "core/synthetic_parts.h"
+#include "core/thread_affinity.h"
+#include "core/thread_scheduling.h"
+#include "config/settings.h"
 #include <QDebug>
 #include <QFileInfo>
 #include <QThread>
+#include <algorithm>
+#include <chrono>
 
 namespace basler {
 
+// ============================================================================
+// CachedVideoDecoder 實現
+// ============================================================================
+
+void CachedVideoDecoder::reset(cv::VideoCapture* capture, int cacheFrames, int stepBackSpan)
+{
+    m_capture = capture;
+    m_position = capture ? static_cast<int>(capture->get(cv::CAP_PROP_POS_FRAMES)) : 0;
+    m_entries.clear();
+    m_entries.resize(capture ? std::max(1, cacheFrames) : 0);
+    // 回填的整段必須放得進快取，否則目標幀會被同一段較早的幀擠掉
+    m_stepBackSpan = std::clamp(stepBackSpan, 1, std::max(1, cacheFrames));
+    m_clock = 0;
+}
+
+CachedVideoDecoder::Entry* CachedVideoDecoder::find(int index)
+{
+    for (Entry& entry : m_entries) {
+        if (entry.index == index) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+CachedVideoDecoder::Entry& CachedVideoDecoder::evictSlot()
+{
+    Entry* oldest = &m_entries.front();
+    for (Entry& entry : m_entries) {
+        if (entry.index < 0) {
+            return entry;
+        }
+        if (entry.lastUse < oldest->lastUse) {
+            oldest = &entry;
+        }
+    }
+    return *oldest;
+}
+
+bool CachedVideoDecoder::frameAt(int index, cv::Mat& out)
+{
+    if (!m_capture || index < 0) {
+        return false;
+    }
+
+    if (Entry* hit = find(index)) {
+        hit->lastUse = ++m_clock;
+        hit->frame.copyTo(out);
+        return true;
+    }
+
+    // 未命中：往後跳則回填 [index - span + 1, index]；往前跳超過一段則直接跳到目標；否則順序解碼
+    int start = m_position;
+    if (index < m_position) {
+        start = std::max(0, index - m_stepBackSpan + 1);
+    } else if (index - m_position > m_stepBackSpan) {
+        start = index;
+    }
+    if (start != m_position) {
+        m_capture->set(cv::CAP_PROP_POS_FRAMES, start);
+        m_position = start;
+    }
+
+    while (m_position <= index) {
+        Entry& slot = evictSlot();
+        slot.index = -1;
+        if (!m_capture->read(slot.frame)) {
+            return false;
+        }
+        slot.index = m_position++;
+        slot.lastUse = ++m_clock;
+    }
+
+    find(index)->frame.copyTo(out);
+    return true;
+}
+
 // ============================================================================
 // VideoPlayWorker 實現
 // ============================================================================
 
-VideoPlayWorker::VideoPlayWorker(cv::VideoCapture* capture, double fps, QObject* parent)
+VideoPlayWorker::VideoPlayWorker(CachedVideoDecoder* decoder, double fps, FrameRing* ring, QObject* parent)
     : QObject(parent)
-    , m_capture(capture)
+    , m_decoder(decoder)
     , m_fps(fps)
+    , m_ring(ring)
+{
+}
+
+VideoPlayWorker::~VideoPlayWorker()
+{
+    stopDecoding();
+}
+
+void VideoPlayWorker::setRawSource(const RawCaptureReader* reader)
+{
+    m_raw = reader;
+}
+
+void VideoPlayWorker::setSyntheticSource(const SyntheticPartsGenerator* generator)
+{
+    m_synthetic = generator;
+}
+
+void VideoPlayWorker::requestSeek(int frameIndex, bool publishWhilePaused)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        m_seekRequest = std::max(0, frameIndex);
+        ++m_generation;
+        for (auto& item : m_queue) {
+            if (!m_raw) {
+                m_freeBuffers.push_back(std::move(item.image));
+            }
+        }
+        m_queue.clear();
+        m_stepPending = m_stepPending || publishWhilePaused;
+    }
+    m_queueNotFull.notify_all();
+}
+
+void VideoPlayWorker::decodeLoop(bool loop)
+{
+    setCurrentThreadName("VideoDecode");
+    int nextIndex = m_startFrame;
+    DecodedFrame item;
+    RawFrameHeader header;
+
+    while (m_running.load()) {
+        quint64 generation;
+        {
+            std::unique_lock<std::mutex> lock(m_queueMutex);
+            m_queueNotFull.wait(lock, [this] {
+                return !m_running.load() || m_seekRequest >= 0 ||
+                       static_cast<int>(m_queue.size()) < m_prefetchCapacity;
+            });
+            if (!m_running.load()) {
+                break;
+            }
+            if (m_seekRequest >= 0) {
+                nextIndex = m_seekRequest;
+                m_seekRequest = -1;
+            }
+            generation = m_generation;
+            if (!m_raw && item.image.empty() && !m_freeBuffers.empty()) {
+                item.image = std::move(m_freeBuffers.back());
+                m_freeBuffers.pop_back();
+            }
+        }
+
+        bool ok;
+        if (m_raw) {
+            // frame 指向映射記憶體，publish 時才複製進 FrameRing
+            ok = m_raw->frame(nextIndex, item.image, header);
+            item.meta.blockId = header.blockId;
+            item.meta.deviceTimestamp = header.deviceTimestamp;
+            item.meta.exposureUs = header.exposureUs;
+        } else if (m_synthetic) {
+            ok = m_synthetic->render(nextIndex, item.image);
+        } else {
+            ok = m_decoder->frameAt(nextIndex, item.image);
+        }
+
+        if (!ok) {
+            if (loop && nextIndex > 0) {
+                nextIndex = 0;
+                qDebug() << "[VideoPlayWorker] 視頻循環播放";
+                continue;
+            }
+            std::lock_guard<std::mutex> lock(m_queueMutex);
+            if (generation != m_generation) {
+                continue; // 播完之前已要求跳轉
+            }
+            m_decodeFinished = true;
+            m_queueNotEmpty.notify_all();
+            break;
+        }
+
+        item.index = nextIndex++;
+        item.generation = generation;
+        {
+            std::lock_guard<std::mutex> lock(m_queueMutex);
+            if (generation != m_generation) {
+                continue; // 跳轉前解碼的幀（緩衝留給下一次解碼）
+            }
+            m_queue.push_back(std::move(item));
+            item = DecodedFrame();
+        }
+        m_queueNotEmpty.notify_one();
+    }
+}
+
+void VideoPlayWorker::stopDecoding()
 {
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        m_running.store(false);
+    }
+    m_queueNotFull.notify_all();
+    m_queueNotEmpty.notify_all();
+    if (m_decodeThread.joinable()) {
+        m_decodeThread.join();
+    }
 }
 
 void VideoPlayWorker::startPlaying(bool loop)
@@ -22,52 +224,103 @@ void VideoPlayWorker::startPlaying(bool loop)
         return;
     }
 
+    // 播放線程負責依幀率發布到 FrameRing，排程等同相機抓取線程
+    applyThreadScheduling(ThreadRole::Grab);
+
     m_running.store(true);
     m_paused.store(false);
-    qDebug() << "[VideoPlayWorker] 開始播放";
-
-    int frameIndex = 0;
-    int delayMs = static_cast<int>(1000.0 / m_fps);
+    m_decodeFinished = false;
+    m_decodeThread = std::thread(&VideoPlayWorker::decodeLoop, this, loop);
+    qDebug() << "[VideoPlayWorker] 開始播放（預解碼" << m_prefetchCapacity << "幀）";
+
+    using Clock = std::chrono::steady_clock;
+    const auto period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / m_fps));
+    const auto maxLag = std::max<Clock::duration>(period * 8, std::chrono::milliseconds(50));
+    Clock::time_point origin;
+    qint64 pacedFrames = 0;
+    quint64 pacedGeneration = 0;
+    bool resync = true;
+    DecodedFrame item;
 
     while (m_running.load()) {
-        // 檢查暫停
-        if (m_paused.load()) {
-            QThread::msleep(50);
-            continue;
-        }
-
-        cv::Mat frame;
-        bool ret = m_capture->read(frame);
-
-        if (!ret) {
-            if (loop) {
-                // 循環播放
-                m_capture->set(cv::CAP_PROP_POS_FRAMES, 0);
-                frameIndex = 0;
-                qDebug() << "[VideoPlayWorker] 視頻循環播放";
+        const bool paused = m_paused.load();
+        {
+            std::unique_lock<std::mutex> lock(m_queueMutex);
+            if (paused && !m_stepPending) {
+                lock.unlock();
+                resync = true;
+                QThread::msleep(20);
                 continue;
-            } else {
-                // 播放完畢
-                qDebug() << "[VideoPlayWorker] 視頻播放完畢";
+            }
+            const bool ready = m_queueNotEmpty.wait_for(lock, std::chrono::milliseconds(100), [this] {
+                return !m_running.load() || !m_queue.empty() || m_decodeFinished;
+            });
+            if (!ready) {
+                resync = true; // 解碼跟不上：之後從現在重新起算
+                continue;
+            }
+            if (m_queue.empty()) {
+                if (m_decodeFinished) {
+                    qDebug() << "[VideoPlayWorker] 視頻播放完畢";
+                }
                 break;
             }
+            item = std::move(m_queue.front());
+            m_queue.pop_front();
+            m_stepPending = false; // 佇列在跳轉時清空，取出的已是跳轉後的幀
+        }
+        m_queueNotFull.notify_one();
+
+        // 絕對時間表：跳轉、暫停或解碼停頓後重新起算
+        if (resync || item.generation != pacedGeneration) {
+            origin = Clock::now();
+            pacedFrames = 0;
+            pacedGeneration = item.generation;
+            resync = false;
+        }
+        if (!paused) {
+            const auto deadline = origin + period * pacedFrames;
+            const auto now = Clock::now();
+            if (now - deadline > maxLag) {
+                origin = now;
+                pacedFrames = 0;
+            } else if (deadline > now) {
+                std::this_thread::sleep_until(deadline);
+            }
+        }
+
+        // 有無損消費者（無損計數模式的檢測）時等它讀完，播放不會丟掉未檢測的幀
+        while (m_running.load() && !m_ring->waitForSpace(100)) {
         }
 
-        emit frameReady(frame, frameIndex);
-        frameIndex++;
+        quint64 sequence = m_ring->publish(item.image, FrameRing::steadyTimestampUs(), item.meta.blockId,
+                                           item.meta.deviceTimestamp, item.meta.exposureUs);
+        m_lastPublished.store(item.index);
+        emit frameReady(sequence, item.index);
+        ++pacedFrames;
 
-        // 控制播放速度
-        QThread::msleep(delayMs);
+        if (!m_raw) {
+            std::lock_guard<std::mutex> lock(m_queueMutex);
+            if (static_cast<int>(m_freeBuffers.size()) < m_prefetchCapacity) {
+                m_freeBuffers.push_back(std::move(item.image));
+            }
+        }
+        item = DecodedFrame();
     }
 
-    m_running.store(false);
+    stopDecoding();
     emit playbackFinished();
 }
 
 void VideoPlayWorker::stopPlaying()
 {
     qDebug() << "[VideoPlayWorker] 收到停止請求";
-    m_running.store(false);
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        m_running.store(false);
+    }
+    m_queueNotFull.notify_all();
+    m_queueNotEmpty.notify_all();
 }
 
 void VideoPlayWorker::pause()
@@ -88,6 +341,10 @@ VideoPlayer::VideoPlayer(QObject* parent)
     : QObject(parent)
 {
     qRegisterMetaType<cv::Mat>("cv::Mat");
+
+    m_ownedRing = std::make_unique<FrameRing>(Settings::instance().performance().frameRingCapacity);
+    m_frameRing = m_ownedRing.get();
+
     qDebug() << "[VideoPlayer] 初始化完成";
 }
 
@@ -96,6 +353,11 @@ VideoPlayer::~VideoPlayer()
     release();
 }
 
+void VideoPlayer::setFrameRing(FrameRing* ring)
+{
+    m_frameRing = ring ? ring : m_ownedRing.get();
+}
+
 double VideoPlayer::progress() const
 {
     if (m_totalFrames == 0) {
@@ -115,6 +377,20 @@ bool VideoPlayer::loadVideo(const QString& videoPath)
         return false;
     }
 
+    if (RawCaptureReader::isRawCapture(videoPath)) {
+        return loadRawCapture(videoPath);
+    }
+
+    if (SyntheticPartsGenerator::isSyntheticSpec(videoPath)) {
+        m_synthetic = std::make_unique<SyntheticPartsGenerator>();
+        if (!m_synthetic->load(videoPath)) {
+            emit loadError(m_synthetic->errorString());
+            m_synthetic.reset();
+            return false;
+        }
+        return finishSyntheticLoad(videoPath);
+    }
+
     m_capture = std::make_unique<cv::VideoCapture>(videoPath.toStdString());
 
     if (!m_capture->isOpened()) {
@@ -134,6 +410,10 @@ bool VideoPlayer::loadVideo(const QString& videoPath)
         m_fps = 30.0;  // 預設值
     }
 
+    const PerformanceConfig& perf = Settings::instance().performance();
+    m_decoder.reset(m_capture.get(), perf.videoFrameCacheFrames, perf.videoStepBackSpan);
+    m_nextFrame = 0;
+
     qDebug() << "[VideoPlayer] 視頻載入成功:" << fileInfo.fileName();
     qDebug() << "[VideoPlayer] 總幀數:" << m_totalFrames << ", FPS:" << m_fps
              << ", 尺寸:" << m_frameWidth << "x" << m_frameHeight;
@@ -142,9 +422,89 @@ bool VideoPlayer::loadVideo(const QString& videoPath)
     return true;
 }
 
+bool VideoPlayer::loadRawCapture(const QString& path)
+{
+    m_rawReader = std::make_unique<RawCaptureReader>();
+    if (!m_rawReader->open(path) || m_rawReader->frameCount() == 0) {
+        const QString error = m_rawReader->isOpen() ? QString("原始擷取沒有任何幀") : m_rawReader->errorString();
+        m_rawReader.reset();
+        emit loadError(QString("無法打開原始擷取: %1").arg(error));
+        return false;
+    }
+
+    m_videoPath = path;
+    m_totalFrames = m_rawReader->frameCount();
+    m_fps = m_rawReader->fps() > 0 ? m_rawReader->fps() : 30.0;
+    m_frameWidth = m_rawReader->width();
+    m_frameHeight = m_rawReader->height();
+    m_nextFrame = 0;
+
+    qDebug() << "[VideoPlayer] 原始擷取載入成功:" << path;
+    qDebug() << "[VideoPlayer] 總幀數:" << m_totalFrames << ", FPS:" << m_fps
+             << ", 尺寸:" << m_frameWidth << "x" << m_frameHeight;
+
+    emit videoLoaded(path, m_totalFrames, m_fps);
+    return true;
+}
+
+bool VideoPlayer::loadSynthetic(const SyntheticConfig& config)
+{
+    release();
+
+    m_synthetic = std::make_unique<SyntheticPartsGenerator>();
+    m_synthetic->configure(config);
+    return finishSyntheticLoad(QString("synthetic:%1ppm").arg(config.partsPerMinute));
+}
+
+bool VideoPlayer::finishSyntheticLoad(const QString& label)
+{
+    m_videoPath = label;
+    m_totalFrames = m_synthetic->frameCount();
+    m_fps = m_synthetic->fps();
+    m_frameWidth = m_synthetic->width();
+    m_frameHeight = m_synthetic->height();
+    m_nextFrame = 0;
+
+    qDebug() << "[VideoPlayer] 合成序列載入成功:" << label << "," << m_synthetic->parts().size() << "個零件";
+    qDebug() << "[VideoPlayer] 總幀數:" << m_totalFrames << ", FPS:" << m_fps
+             << ", 尺寸:" << m_frameWidth << "x" << m_frameHeight;
+
+    emit videoLoaded(label, m_totalFrames, m_fps);
+    return true;
+}
+
+bool VideoPlayer::publishFrameAt(int frameIndex)
+{
+    FrameMeta meta;
+    if (m_rawReader) {
+        RawFrameHeader header;
+        if (!m_rawReader->frame(frameIndex, m_stepFrame, header)) {
+            return false;
+        }
+        meta.blockId = header.blockId;
+        meta.deviceTimestamp = header.deviceTimestamp;
+        meta.exposureUs = header.exposureUs;
+    } else if (m_synthetic) {
+        if (!m_synthetic->render(frameIndex, m_stepFrame)) {
+            return false;
+        }
+    } else if (!m_decoder.frameAt(frameIndex, m_stepFrame)) {
+        return false;
+    }
+
+    // 停止時播放線程不存在，不會同時 publish
+    quint64 sequence = m_frameRing->publish(m_stepFrame, FrameRing::steadyTimestampUs(),
+                                            meta.blockId, meta.deviceTimestamp, meta.exposureUs);
+    m_currentFrameIndex.store(frameIndex);
+    m_nextFrame = frameIndex + 1;
+    emit frameReady(sequence);
+    emit frameChanged(frameIndex);
+    return true;
+}
+
 void VideoPlayer::startPlaying(bool loop)
 {
-    if (!m_capture || !m_capture->isOpened()) {
+    if (!isLoaded()) {
         emit playError("未載入視頻文件");
         return;
     }
@@ -154,9 +514,21 @@ void VideoPlayer::startPlaying(bool loop)
         return;
     }
 
+    // 播完後再次播放從頭開始
+    if (m_totalFrames > 0 && m_nextFrame >= m_totalFrames) {
+        m_nextFrame = 0;
+    }
+
     // 創建播放線程
     m_playThread = std::make_unique<QThread>();
-    m_playWorker = std::make_unique<VideoPlayWorker>(m_capture.get(), m_fps);
+    m_playWorker = std::make_unique<VideoPlayWorker>(&m_decoder, m_fps, m_frameRing);
+    if (m_rawReader) {
+        m_playWorker->setRawSource(m_rawReader.get());
+    } else if (m_synthetic) {
+        m_playWorker->setSyntheticSource(m_synthetic.get());
+    }
+    m_playWorker->setStartFrame(m_nextFrame);
+    m_playWorker->setPrefetchFrames(Settings::instance().performance().videoPrefetchFrames);
     m_playWorker->moveToThread(m_playThread.get());
 
     // 連接信號
@@ -172,7 +544,6 @@ void VideoPlayer::startPlaying(bool loop)
 
     m_isPlaying.store(true);
     m_isPaused.store(false);
-    m_currentFrameIndex.store(0);
 
     m_playThread->start();
     emit playingStateChanged(true);
@@ -195,6 +566,11 @@ void VideoPlayer::stopPlaying()
         m_playThread->wait(2000);
     }
 
+    // 停止後的單步 / 再次播放從最後顯示的幀之後繼續
+    if (m_playWorker && m_playWorker->lastPublishedFrame() >= 0) {
+        m_nextFrame = m_playWorker->lastPublishedFrame() + 1;
+    }
+
     m_isPlaying.store(false);
     m_isPaused.store(false);
 
@@ -222,42 +598,46 @@ void VideoPlayer::resume()
 
 void VideoPlayer::seek(int frameIndex)
 {
-    if (!m_capture || !m_capture->isOpened()) {
+    if (!isLoaded() || frameIndex < 0 || frameIndex >= m_totalFrames) {
         return;
     }
 
-    if (frameIndex >= 0 && frameIndex < m_totalFrames) {
-        m_capture->set(cv::CAP_PROP_POS_FRAMES, frameIndex);
-        m_currentFrameIndex.store(frameIndex);
-        emit frameChanged(frameIndex);
+    // 播放中交給解碼線程；停止時只移動位置，下一次單步 / 播放才解碼
+    if (m_isPlaying.load() && m_playWorker) {
+        m_playWorker->requestSeek(frameIndex, false);
+    } else {
+        m_nextFrame = frameIndex;
     }
+    m_currentFrameIndex.store(frameIndex);
+    emit frameChanged(frameIndex);
 }
 
 void VideoPlayer::nextFrame()
 {
-    if (!m_capture || !m_capture->isOpened()) {
+    if (!isLoaded()) {
         return;
     }
 
-    cv::Mat frame;
-    if (m_capture->read(frame)) {
-        int index = m_currentFrameIndex.fetch_add(1) + 1;
-        {
-            QMutexLocker locker(&m_frameMutex);
-            m_latestFrame = frame.clone();
-        }
-        emit frameReady(frame);
-        emit frameChanged(index);
+    if (m_isPlaying.load() && m_playWorker) {
+        m_playWorker->requestSeek(m_currentFrameIndex.load() + 1, true);
+        return;
     }
+    publishFrameAt(m_nextFrame);
 }
 
 void VideoPlayer::previousFrame()
 {
-    int currentIndex = m_currentFrameIndex.load();
-    if (currentIndex > 0) {
-        seek(currentIndex - 1);
-        nextFrame();
+    const int target = m_currentFrameIndex.load() - 1;
+    if (!isLoaded() || target < 0) {
+        return;
+    }
+
+    // 後退由 CachedVideoDecoder 快取命中，未命中時一次回填一段
+    if (m_isPlaying.load() && m_playWorker) {
+        m_playWorker->requestSeek(target, true);
+        return;
     }
+    publishFrameAt(target);
 }
 
 void VideoPlayer::release()
@@ -290,6 +670,11 @@ void VideoPlayer::release()
         m_capture->release();
         m_capture.reset();
     }
+    m_stepFrame.release(); // 可能指向原始擷取的映射記憶體
+    m_rawReader.reset();
+    m_synthetic.reset();
+    m_decoder.reset(nullptr, 0, 0);
+    m_nextFrame = 0;
 
     m_videoPath.clear();
     m_totalFrames = 0;
@@ -298,20 +683,20 @@ void VideoPlayer::release()
     qDebug() << "[VideoPlayer] 資源已釋放";
 }
 
-void VideoPlayer::onFrameReady(const cv::Mat& frame, int frameIndex)
+void VideoPlayer::onFrameReady(quint64 sequence, int frameIndex)
 {
-    {
-        QMutexLocker locker(&m_frameMutex);
-        m_latestFrame = frame.clone();
-    }
     m_currentFrameIndex.store(frameIndex);
 
-    emit frameReady(frame);
+    emit frameReady(sequence);
     emit frameChanged(frameIndex);
 }
 
 void VideoPlayer::onPlaybackFinished()
 {
+    // 解碼線程已結束（worker 發出信號前先 join），之後的單步直接使用 m_decoder
+    if (m_playWorker && m_playWorker->lastPublishedFrame() >= 0) {
+        m_nextFrame = m_playWorker->lastPublishedFrame() + 1;
+    }
     m_isPlaying.store(false);
     emit playingStateChanged(false);
     emit playbackFinished();
@@ -1,6 +1,21 @@
 #include "core/video_recorder.h"
+#include "core/raw_capture.h"
+#include "core/thread_affinity.h"
+#include "core/thread_scheduling.h"
+#include "config/settings.h"
 #include <QDebug>
 #include <QSize>
+#include <algorithm>
+#include <chrono>
+#include <opencv2/imgproc.hpp>
+
+// cv::VideoWriter 參數建構與硬體加速（VIDEOWRITER_PROP_HW_ACCELERATION）需 OpenCV 4.5.2 以上
+#if CV_VERSION_MAJOR > 4 || \
+    (CV_VERSION_MAJOR == 4 && (CV_VERSION_MINOR > 5 || (CV_VERSION_MINOR == 5 && CV_VERSION_REVISION >= 2)))
+#define VIDEO_RECORDER_HW_PARAMS 1
+#else
+#define VIDEO_RECORDER_HW_PARAMS 0
+#endif
 
 namespace basler {
 
@@ -13,6 +28,8 @@ VideoRecorder::VideoRecorder(const QString& outputDir, QObject* parent)
         m_outputPath.mkpath(".");
     }
 
+    qRegisterMetaType<RecordingInfo>("RecordingInfo");
+
     qDebug() << "[VideoRecorder] 初始化完成，輸出目錄:" << m_outputPath.absolutePath();
 }
 
@@ -29,6 +46,32 @@ double VideoRecorder::recordingDuration() const
     return m_recordingStartTime.msecsTo(QDateTime::currentDateTime()) / 1000.0;
 }
 
+RecordingInfo VideoRecorder::currentInfo() const
+{
+    RecordingInfo info;
+    if (!m_isRecording.load()) {
+        return info;
+    }
+    info.filename = m_currentFilename;
+    info.fullPath = m_currentFullPath;
+    info.codec = m_codecName;
+    info.duration = recordingDuration();
+    fillStats(info);
+    return info;
+}
+
+void VideoRecorder::fillStats(RecordingInfo& info) const
+{
+    const int frames = m_framesRecorded.load();
+    info.framesRecorded = frames;
+    info.averageFps = (info.duration > 0) ? (frames / info.duration) : 0.0;
+    info.queueDepth = m_queueDepth.load();
+    info.maxQueueDepth = m_maxQueueDepth.load();
+    info.framesDropped = m_framesDropped.load();
+    info.averageEncodeMs = frames > 0 ? m_encodeTotalMs.load() / frames : 0.0;
+    info.maxEncodeMs = m_maxEncodeMs.load();
+}
+
 void VideoRecorder::setOutputDirectory(const QString& dir)
 {
     m_outputPath = QDir(dir);
@@ -37,8 +80,9 @@ void VideoRecorder::setOutputDirectory(const QString& dir)
     }
 }
 
-bool VideoRecorder::startRecording(const QSize& frameSize, double fps, const QString& filename)
+bool VideoRecorder::startRecording(const QSize& frameSize, double fps, const QString& filename, bool isColor)
 {
+    QMutexLocker controlLocker(&m_controlMutex);
     if (m_isRecording.load()) {
         qWarning() << "[VideoRecorder] 錄製已在進行中";
         return false;
@@ -53,58 +97,167 @@ bool VideoRecorder::startRecording(const QSize& frameSize, double fps, const QSt
     m_currentFilename = actualFilename;
     m_fps = fps;
 
-    // 嘗試不同的編碼器
-    struct CodecInfo {
-        QString name;
-        int fourcc;
-        QString extension;
-    };
-
-    std::vector<CodecInfo> codecs = {
-        {"mp4v", cv::VideoWriter::fourcc('m', 'p', '4', 'v'), ".mp4"},
-        {"MJPG", cv::VideoWriter::fourcc('M', 'J', 'P', 'G'), ".avi"},
-        {"XVID", cv::VideoWriter::fourcc('X', 'V', 'I', 'D'), ".avi"}
-    };
-
-    for (const auto& codec : codecs) {
-        if (tryCodec(codec.name, codec.fourcc, codec.extension, frameSize, fps)) {
-            m_isRecording.store(true);
-            m_framesRecorded.store(0);
-            m_recordingStartTime = QDateTime::currentDateTime();
-
-            emit recordingStarted(m_currentFilename);
-            emit recordingStateChanged(true);
-
-            qDebug() << "[VideoRecorder] 開始錄製:" << m_currentFilename;
-            return true;
+    const auto& rec = Settings::instance().recording();
+    const bool raw = rec.format == "raw";
+
+    // 燒入檢測疊加只用於編碼檔（原始擷取保持無損）；疊加是彩色的，單通道來源改以彩色編碼
+    m_burnIn = rec.burnInOverlay && !raw;
+    const bool colorOutput = isColor || m_burnIn;
+
+    // 依序嘗試編碼器（硬體優先，最後是軟體）
+    bool opened = raw && openRawCapture(actualFilename, fps);
+    if (!raw) {
+        for (const auto& encoder : encoderCandidates(rec.encoderBackend, colorOutput)) {
+            if (tryEncoder(encoder, frameSize, fps, colorOutput)) {
+                opened = true;
+                break;
+            }
         }
     }
 
-    emit recordingError("所有編碼器都失敗");
-    return false;
+    if (!opened) {
+        if (!raw) {
+            emit recordingError("所有編碼器都失敗");
+        }
+        return false;
+    }
+
+    m_queueCapacity = std::max(1, rec.queueFrames);
+    m_blockWhenFull = rec.blockWhenFull;
+    m_blockTimeoutMs = std::max(0, rec.blockTimeoutMs);
+    m_progressIntervalMs = std::max(0, rec.progressIntervalMs);
+
+    m_framesRecorded.store(0);
+    m_framesDropped.store(0);
+    m_queueDepth.store(0);
+    m_maxQueueDepth.store(0);
+    m_encodeTotalMs.store(0.0);
+    m_maxEncodeMs.store(0.0);
+    m_recordingStartTime = QDateTime::currentDateTime();
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        m_queue.clear();
+        m_stopWriter = false;
+    }
+    m_writerThread = std::thread(&VideoRecorder::writerLoop, this);
+    m_isRecording.store(true);
+
+    emit recordingStarted(m_currentFilename);
+    emit recordingStateChanged(true);
+
+    qDebug() << "[VideoRecorder] 開始錄製:" << m_currentFilename;
+    return true;
 }
 
-bool VideoRecorder::tryCodec(const QString& codecName, int fourcc, const QString& extension,
-                             const QSize& frameSize, double fps)
+bool VideoRecorder::openRawCapture(const QString& filename, double fps)
 {
-    try {
-        QString filepath = m_outputPath.absoluteFilePath(m_currentFilename + extension);
+    const QString directory = m_outputPath.absoluteFilePath(filename + RawCaptureWriter::EXTENSION);
+    const qint64 segmentBytes =
+        static_cast<qint64>(std::max(16, Settings::instance().recording().rawSegmentMegabytes)) * 1024 * 1024;
+
+    m_rawWriter = std::make_unique<RawCaptureWriter>();
+    if (!m_rawWriter->open(directory, fps, segmentBytes)) {
+        const QString error = m_rawWriter->errorString();
+        m_rawWriter.reset();
+        qWarning() << "[VideoRecorder] 原始擷取開啟失敗:" << error;
+        emit recordingError(QString("原始擷取開啟失敗: %1").arg(error));
+        return false;
+    }
+
+    m_codecName = "raw";
+    m_currentFullPath = directory;
+    qDebug() << "[VideoRecorder] 原始擷取目錄:" << directory
+             << ", 分段" << segmentBytes / (1024 * 1024) << "MB";
+    return true;
+}
+
+std::vector<VideoRecorder::EncoderCandidate> VideoRecorder::encoderCandidates(const QString& backend, bool isColor)
+{
+    const int color = isColor ? 1 : 0;
+    const int h264 = cv::VideoWriter::fourcc('a', 'v', 'c', '1');
+    std::vector<EncoderCandidate> candidates;
+
+#if VIDEO_RECORDER_HW_PARAMS
+    // OpenCV FFmpeg 後端的硬體編碼（h264_qsv / h264_vaapi；Windows 上 ANY 也涵蓋 D3D11）
+    const EncoderCandidate qsv{"h264/qsv", cv::CAP_FFMPEG, h264, ".mp4",
+                               {cv::VIDEOWRITER_PROP_HW_ACCELERATION, cv::VIDEO_ACCELERATION_MFX,
+                                cv::VIDEOWRITER_PROP_IS_COLOR, color}, QString()};
+    const EncoderCandidate vaapi{"h264/vaapi", cv::CAP_FFMPEG, h264, ".mp4",
+                                 {cv::VIDEOWRITER_PROP_HW_ACCELERATION, cv::VIDEO_ACCELERATION_VAAPI,
+                                  cv::VIDEOWRITER_PROP_IS_COLOR, color}, QString()};
+    const EncoderCandidate anyHw{"h264/hw", cv::CAP_FFMPEG, h264, ".mp4",
+                                 {cv::VIDEOWRITER_PROP_HW_ACCELERATION, cv::VIDEO_ACCELERATION_ANY,
+                                  cv::VIDEOWRITER_PROP_IS_COLOR, color}, QString()};
+#endif
+    // NVENC：OpenCV FFmpeg 後端不支援 CUDA 裝置，改走 GStreamer（appsrc 依 isColor 送 GRAY8 / BGR）
+    const EncoderCandidate nvenc{"h264/nvenc", cv::CAP_GSTREAMER, 0, ".mp4", {},
+                                 "appsrc ! videoconvert ! nvh264enc ! h264parse ! mp4mux ! filesink location=\"%1\""};
+    // macOS：AVFoundation 的 H.264 由 VideoToolbox 硬體編碼
+    const EncoderCandidate videoToolbox{"h264/videotoolbox", cv::CAP_AVFOUNDATION, h264, ".mov", {}, QString()};
+
+    if (backend == "auto") {
+#if defined(Q_OS_MACOS)
+        candidates = {videoToolbox};
+#elif VIDEO_RECORDER_HW_PARAMS
+        candidates = {anyHw, nvenc};
+#else
+        candidates = {nvenc};
+#endif
+    }
+#if VIDEO_RECORDER_HW_PARAMS
+    else if (backend == "qsv") {
+        candidates = {qsv};
+    } else if (backend == "vaapi") {
+        candidates = {vaapi};
+    }
+#endif
+    else if (backend == "nvenc") {
+        candidates = {nvenc};
+    } else if (backend == "videotoolbox") {
+        candidates = {videoToolbox};
+    } else if (backend != "software") {
+        qWarning() << "[VideoRecorder] 不支援的編碼後端:" << backend << "，使用軟體編碼器";
+    }
 
-        m_videoWriter = std::make_unique<cv::VideoWriter>(
-            filepath.toStdString(),
-            fourcc,
-            fps,
-            cv::Size(frameSize.width(), frameSize.height())
-        );
+    // 軟體編碼器（一律作為退路）
+    for (const auto& software : std::vector<std::pair<QString, int>>{
+             {"mp4v", cv::VideoWriter::fourcc('m', 'p', '4', 'v')},
+             {"MJPG", cv::VideoWriter::fourcc('M', 'J', 'P', 'G')},
+             {"XVID", cv::VideoWriter::fourcc('X', 'V', 'I', 'D')}}) {
+        candidates.push_back({software.first, cv::CAP_ANY, software.second,
+                              software.first == "mp4v" ? ".mp4" : ".avi", {}, QString()});
+    }
+    return candidates;
+}
+
+bool VideoRecorder::tryEncoder(const EncoderCandidate& encoder, const QSize& frameSize, double fps, bool isColor)
+{
+    try {
+        const QString filepath = m_outputPath.absoluteFilePath(m_currentFilename + encoder.extension);
+        const cv::Size size(frameSize.width(), frameSize.height());
+
+        if (!encoder.pipeline.isEmpty()) {
+            m_videoWriter = std::make_unique<cv::VideoWriter>(
+                encoder.pipeline.arg(filepath).toStdString(), encoder.apiPreference, 0, fps, size, isColor);
+#if VIDEO_RECORDER_HW_PARAMS
+        } else if (!encoder.params.empty()) {
+            m_videoWriter = std::make_unique<cv::VideoWriter>(
+                filepath.toStdString(), encoder.apiPreference, encoder.fourcc, fps, size, encoder.params);
+#endif
+        } else {
+            m_videoWriter = std::make_unique<cv::VideoWriter>(
+                filepath.toStdString(), encoder.apiPreference, encoder.fourcc, fps, size, isColor);
+        }
 
         if (m_videoWriter->isOpened()) {
-            m_codecName = codecName;
+            m_codecName = encoder.name;
             m_currentFullPath = filepath;
 
-            qDebug() << "[VideoRecorder] 使用" << codecName << "編碼器";
+            qDebug() << "[VideoRecorder] 使用" << encoder.name << "編碼器"
+                     << "（" << QString::fromStdString(m_videoWriter->getBackendName()) << "）";
             qDebug() << "[VideoRecorder] 錄製參數:"
                      << frameSize.width() << "x" << frameSize.height()
-                     << "@" << fps << "fps";
+                     << "@" << fps << "fps" << (isColor ? "" : "（灰階）");
             qDebug() << "[VideoRecorder] 錄製文件:" << filepath;
 
             return true;
@@ -114,41 +267,181 @@ bool VideoRecorder::tryCodec(const QString& codecName, int fourcc, const QString
         return false;
 
     } catch (const std::exception& e) {
-        qWarning() << "[VideoRecorder]" << codecName << "編碼器失敗:" << e.what();
+        qWarning() << "[VideoRecorder]" << encoder.name << "編碼器失敗:" << e.what();
         m_videoWriter.reset();
         return false;
     }
 }
 
-bool VideoRecorder::writeFrame(const cv::Mat& frame)
+bool VideoRecorder::waitForSpace(std::unique_lock<std::mutex>& lock)
+{
+    auto hasSpace = [this] { return m_stopWriter || static_cast<int>(m_queue.size()) < m_queueCapacity; };
+    if (m_lossless) {
+        m_spaceAvailable.wait(lock, hasSpace);
+    } else if (!hasSpace() && m_blockWhenFull) {
+        m_spaceAvailable.wait_for(lock, std::chrono::milliseconds(m_blockTimeoutMs), hasSpace);
+    }
+    if (m_stopWriter || !hasSpace()) {
+        if (!m_stopWriter) {
+            m_framesDropped.fetch_add(1);
+        }
+        return false;
+    }
+    return true;
+}
+
+bool VideoRecorder::writeFrame(const cv::Mat& frame, const FrameMeta& meta)
 {
-    if (!m_isRecording.load() || !m_videoWriter) {
+    if (!m_isRecording.load() || frame.empty()) {
         return false;
     }
 
-    QMutexLocker locker(&m_writerMutex);
+    // 先取得空位與可重用緩衝，複製在鎖外進行
+    cv::Mat buffer;
+    {
+        std::unique_lock<std::mutex> lock(m_queueMutex);
+        if (!waitForSpace(lock)) {
+            return false;
+        }
+        if (!m_freeBuffers.empty()) {
+            buffer = std::move(m_freeBuffers.back());
+            m_freeBuffers.pop_back();
+        }
+    }
+    frame.copyTo(buffer);
+    return enqueueFrame(buffer, meta);
+}
 
-    try {
-        m_videoWriter->write(frame);
-        int frames = m_framesRecorded.fetch_add(1) + 1;
-        emit frameWritten(frames);
-        return true;
+bool VideoRecorder::enqueueFrame(cv::Mat& frame, const FrameMeta& meta)
+{
+    return enqueueFrame(frame, meta, FrameOverlay());
+}
 
-    } catch (const std::exception& e) {
-        qWarning() << "[VideoRecorder] 寫入幀失敗:" << e.what();
+bool VideoRecorder::enqueueFrame(cv::Mat& frame, const FrameMeta& meta, const FrameOverlay& overlay)
+{
+    if (!m_isRecording.load() || frame.empty()) {
         return false;
     }
+
+    {
+        std::unique_lock<std::mutex> lock(m_queueMutex);
+        if (!waitForSpace(lock)) {
+            return false;
+        }
+        m_queue.push_back({std::move(frame), meta, m_burnIn ? overlay : FrameOverlay()});
+        frame = cv::Mat();
+        if (!m_freeBuffers.empty()) {
+            frame = std::move(m_freeBuffers.back());
+            m_freeBuffers.pop_back();
+        }
+
+        const int depth = static_cast<int>(m_queue.size());
+        m_queueDepth.store(depth);
+        if (depth > m_maxQueueDepth.load()) {
+            m_maxQueueDepth.store(depth);
+        }
+    }
+    m_frameAvailable.notify_one();
+    return true;
+}
+
+void VideoRecorder::writerLoop()
+{
+    setCurrentThreadName("VideoWriter");
+    applyThreadScheduling(ThreadRole::Recording);
+    using Clock = std::chrono::steady_clock;
+    auto lastProgress = Clock::now();
+    bool writeFailed = false;
+
+    while (true) {
+        QueuedFrame item;
+        {
+            std::unique_lock<std::mutex> lock(m_queueMutex);
+            m_frameAvailable.wait(lock, [this] { return m_stopWriter || !m_queue.empty(); });
+            if (m_queue.empty()) {
+                break; // 已要求停止且佇列已清空
+            }
+            item = std::move(m_queue.front());
+            m_queue.pop_front();
+            m_queueDepth.store(static_cast<int>(m_queue.size()));
+        }
+        m_spaceAvailable.notify_one();
+
+        const auto encodeStart = Clock::now();
+        try {
+            if (m_rawWriter) {
+                if (m_rawWriter->append(item.image, item.meta)) {
+                    m_framesRecorded.fetch_add(1);
+                } else if (!writeFailed) {
+                    qWarning() << "[VideoRecorder] 原始擷取寫入失敗:" << m_rawWriter->errorString();
+                    emit recordingError(QString("原始擷取寫入失敗: %1").arg(m_rawWriter->errorString()));
+                    writeFailed = true;
+                }
+            } else {
+                m_videoWriter->write(m_burnIn ? composeBurnIn(item.image, item.overlay) : item.image);
+                m_framesRecorded.fetch_add(1);
+            }
+        } catch (const std::exception& e) {
+            if (!writeFailed) {
+                qWarning() << "[VideoRecorder] 寫入幀失敗:" << e.what();
+                emit recordingError(QString("寫入幀失敗: %1").arg(e.what()));
+                writeFailed = true;
+            }
+        }
+        const auto now = Clock::now();
+        const double encodeMs = std::chrono::duration<double, std::milli>(now - encodeStart).count();
+        m_encodeTotalMs.store(m_encodeTotalMs.load() + encodeMs);
+        if (encodeMs > m_maxEncodeMs.load()) {
+            m_maxEncodeMs.store(encodeMs);
+        }
+
+        // 緩衝交回重用池（上限 = 佇列容量，避免尖峰後長期佔用記憶體）
+        {
+            std::lock_guard<std::mutex> lock(m_queueMutex);
+            if (static_cast<int>(m_freeBuffers.size()) < m_queueCapacity) {
+                m_freeBuffers.push_back(std::move(item.image));
+            }
+        }
+
+        if (m_isRecording.load() && now - lastProgress >= std::chrono::milliseconds(m_progressIntervalMs)) {
+            lastProgress = now;
+            emit recordingProgress(currentInfo());
+        }
+    }
+}
+
+const cv::Mat& VideoRecorder::composeBurnIn(cv::Mat& image, const FrameOverlay& overlay)
+{
+    // 彩色來源直接畫在佇列緩衝上（之後只會被覆寫重用）
+    if (image.channels() != 1) {
+        burnInOverlay(image, overlay);
+        return image;
+    }
+    cv::cvtColor(image, m_burnInFrame, cv::COLOR_GRAY2BGR);
+    burnInOverlay(m_burnInFrame, overlay);
+    return m_burnInFrame;
 }
 
 RecordingInfo VideoRecorder::stopRecording()
 {
+    QMutexLocker controlLocker(&m_controlMutex);
     RecordingInfo info;
 
     if (!m_isRecording.load()) {
         return info;
     }
 
+    // 停止接收新幀，等錄影線程寫完佇列中剩餘的幀
     m_isRecording.store(false);
+    {
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        m_stopWriter = true;
+    }
+    m_frameAvailable.notify_all();
+    m_spaceAvailable.notify_all();
+    if (m_writerThread.joinable()) {
+        m_writerThread.join();
+    }
 
     // 計算錄製時長
     double duration = 0.0;
@@ -156,23 +449,27 @@ RecordingInfo VideoRecorder::stopRecording()
         duration = m_recordingStartTime.msecsTo(QDateTime::currentDateTime()) / 1000.0;
     }
 
-    // 釋放寫入器
+    // 釋放寫入器（錄影線程已結束）
+    if (m_videoWriter) {
+        m_videoWriter->release();
+        m_videoWriter.reset();
+    }
+    if (m_rawWriter) {
+        m_rawWriter->close();
+        m_rawWriter.reset();
+    }
     {
-        QMutexLocker locker(&m_writerMutex);
-        if (m_videoWriter) {
-            m_videoWriter->release();
-            m_videoWriter.reset();
-        }
+        std::lock_guard<std::mutex> lock(m_queueMutex);
+        m_freeBuffers.clear();
     }
 
     // 填充錄製信息
-    int frames = m_framesRecorded.load();
     info.filename = m_currentFilename;
     info.fullPath = m_currentFullPath;
-    info.framesRecorded = frames;
     info.duration = duration;
-    info.averageFps = (duration > 0) ? (frames / duration) : 0.0;
     info.codec = m_codecName;
+    fillStats(info);
+    const int frames = info.framesRecorded;
 
     emit recordingStopped(info);
     emit recordingStateChanged(false);
@@ -180,6 +477,9 @@ RecordingInfo VideoRecorder::stopRecording()
     qDebug() << "[VideoRecorder] 錄製完成:" << m_currentFilename;
     qDebug() << "[VideoRecorder] 錄製統計:" << frames << "幀," << duration << "秒";
     qDebug() << "[VideoRecorder] 平均幀率:" << info.averageFps << "fps";
+    qDebug() << "[VideoRecorder] 編碼佇列: 丟幀" << info.framesDropped
+             << ", 最大深度" << info.maxQueueDepth << "/" << m_queueCapacity
+             << ", 編碼平均" << info.averageEncodeMs << "ms, 最大" << info.maxEncodeMs << "ms";
 
     return info;
 }
@@ -190,11 +490,12 @@ void VideoRecorder::cleanup()
         stopRecording();
     }
 
-    QMutexLocker locker(&m_writerMutex);
+    QMutexLocker controlLocker(&m_controlMutex);
     if (m_videoWriter) {
         m_videoWriter->release();
         m_videoWriter.reset();
     }
+    m_rawWriter.reset();
 
     qDebug() << "[VideoRecorder] 資源已清理";
 }
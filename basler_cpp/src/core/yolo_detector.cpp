@@ -1,52 +1,167 @@
 #include "core/yolo_detector.h"
 #include "core/detection_controller.h" // for DetectedObject
-#include <opencv2/imgproc.hpp>
+#include "core/inference_backend.h"
+#include "core/thread_affinity.h"
+#include "core/thread_scheduling.h"
+#include <algorithm>
 #include <chrono>
+#include <cmath>
 #include <iostream>
 
 namespace basler
 {
 
+    namespace
+    {
+        constexpr double SEAM_MERGE_IOMIN = 0.5; // 接縫兩側框的交集 / 較小框面積 > 此值視為同一物件
+
+        // 固定 batch=1 模型的批次 forward 失敗型態：輸出形狀不符、cv::dnn 的輸入 / reshape 形狀斷言
+        // （ONNX Runtime / OpenVINO 載入時已由 supportsBatch() 排除靜態 batch）
+        bool isBatchShapeError(const cv::Exception &e)
+        {
+            return e.code == cv::Error::StsUnmatchedSizes || e.code == cv::Error::StsBadSize ||
+                   e.code == cv::Error::StsAssert;
+        }
+
+        // 條帶切 tile：方形（邊長 = ROI 高度），起點平均分配，相鄰重疊 >= overlap
+        struct TileLayout
+        {
+            int count = 1;
+            int width = 0; // tile 寬（ROI 像素）
+            int span = 0;  // 第一個與最後一個 tile 起點的距離
+
+            int x(int k) const
+            {
+                return count > 1 ? static_cast<int>(std::lround(static_cast<double>(k) * span / (count - 1))) : 0;
+            }
+
+            // tile k 與 k + 1 的分界：重疊區中線
+            int seam(int k) const { return (x(k + 1) + x(k) + width) / 2; }
+        };
+
+        TileLayout planTiles(int roiWidth, int roiHeight, bool enabled, int overlap)
+        {
+            TileLayout layout;
+            layout.width = roiWidth;
+            if (!enabled || roiHeight <= 0 || roiWidth <= roiHeight)
+            {
+                return layout; // 非條帶形狀：整張一個槽位
+            }
+
+            const int tileWidth = roiHeight;
+            overlap = std::clamp(overlap, 0, tileWidth / 2);
+            const int stride = tileWidth - overlap;
+            layout.count = (roiWidth - overlap + stride - 1) / stride;
+            layout.width = tileWidth;
+            layout.span = roiWidth - tileWidth;
+            return layout;
+        }
+
+        inline bool touchesSeam(const DetectedObject &obj, int seam, int margin)
+        {
+            return obj.x <= seam + margin && obj.x + obj.w >= seam - margin;
+        }
+
+        inline double intersectionOverMin(const DetectedObject &a, const DetectedObject &b)
+        {
+            const int iw = std::min(a.x + a.w, b.x + b.w) - std::max(a.x, b.x);
+            const int ih = std::min(a.y + a.h, b.y + b.h) - std::max(a.y, b.y);
+            if (iw <= 0 || ih <= 0)
+            {
+                return 0.0;
+            }
+            const int minArea = std::max(1, std::min(a.w * a.h, b.w * b.h));
+            return static_cast<double>(iw) * ih / minArea;
+        }
+    }
+
     YoloDetector::YoloDetector()
     {
     }
 
     YoloDetector::~YoloDetector()
     {
+        stopAsync();
     }
 
     bool YoloDetector::loadModel(const std::string &modelPath)
     {
-        std::lock_guard<std::mutex> lock(m_mutex);
+        // 先取 m_netMutex：等待進行中的 forward 結束再替換模型
+        std::lock_guard<std::mutex> netLock(m_netMutex);
+        std::string backendName;
+        std::string device;
+        int inputSize;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_batchUnsupported = false;
+            m_modelLoaded = false;
+            backendName = m_backendName;
+            device = m_device;
+            inputSize = m_inputSize;
+        }
 
-        try
+        // 載入與暖機不持有 m_mutex：背景載入期間檢測線程的 isModelLoaded() 不會被阻塞
+        // 後端於載入時依設定建立（未編譯進來的後端回退為 opencv）
+        std::unique_ptr<InferenceBackend> backend = createInferenceBackend(backendName);
+        const ModelPrecision precision = detectModelPrecision(modelPath);
+        if (!backend->load(modelPath, device, precision))
         {
-            m_net = cv::dnn::readNetFromONNX(modelPath);
+            std::cerr << "[YoloDetector] 模型載入失敗: " << modelPath << std::endl;
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_backend.reset();
+            return false;
+        }
+        warmUp(*backend, inputSize);
 
-            // 優先使用 CUDA，fallback 到 CPU
-            try
-            {
-                m_net.setPreferableBackend(cv::dnn::DNN_BACKEND_CUDA);
-                m_net.setPreferableTarget(cv::dnn::DNN_TARGET_CUDA);
-                std::cout << "[YoloDetector] 使用 CUDA 加速" << std::endl;
-            }
-            catch (...)
-            {
-                m_net.setPreferableBackend(cv::dnn::DNN_BACKEND_OPENCV);
-                m_net.setPreferableTarget(cv::dnn::DNN_TARGET_CPU);
-                std::cout << "[YoloDetector] CUDA 不可用，使用 CPU" << std::endl;
-            }
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_backend = std::move(backend);
+        m_precision = precision;
+        m_modelLoaded = true;
+        std::cout << "[YoloDetector] 模型載入成功 (" << m_backend->name() << ", "
+                  << modelPrecisionName(m_precision) << "): " << modelPath << std::endl;
+        return true;
+    }
 
-            m_modelLoaded = true;
-            std::cout << "[YoloDetector] 模型載入成功: " << modelPath << std::endl;
-            return true;
+    void YoloDetector::warmUp(InferenceBackend &backend, int inputSize)
+    {
+        // 以空白輸入跑一次 forward：後端的延遲初始化（圖最佳化、核心選擇、記憶體配置）在此完成，
+        // 模型標為已載入前執行，第一個真實幀不承擔冷啟動延遲
+        const int sizes[4] = {1, 3, inputSize, inputSize};
+        const cv::Mat blob(4, sizes, CV_32F, cv::Scalar(0));
+        cv::Mat output;
+        const auto startTime = std::chrono::high_resolution_clock::now();
+        try
+        {
+            backend.infer(blob, output);
         }
-        catch (const cv::Exception &e)
+        catch (const std::exception &e)
         {
-            std::cerr << "[YoloDetector] 模型載入失敗: " << e.what() << std::endl;
-            m_modelLoaded = false;
-            return false;
+            std::cerr << "[YoloDetector] 暖機推理失敗（第一幀將承擔初始化延遲）: " << e.what() << std::endl;
+            return;
         }
+        const double elapsedMs = std::chrono::duration<double, std::milli>(
+                                     std::chrono::high_resolution_clock::now() - startTime)
+                                     .count();
+        std::cout << "[YoloDetector] 暖機推理完成: " << elapsedMs << " ms" << std::endl;
+    }
+
+    void YoloDetector::setBackend(const std::string &backend, const std::string &device)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_backendName = backend;
+        m_device = device;
+    }
+
+    std::string YoloDetector::backendName() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_backend ? m_backend->name() : m_backendName;
+    }
+
+    std::string YoloDetector::modelPrecision() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return modelPrecisionName(m_precision);
     }
 
     bool YoloDetector::isModelLoaded() const
@@ -55,198 +170,487 @@ namespace basler
         return m_modelLoaded;
     }
 
+    YoloDetector::InferenceParams YoloDetector::snapshotParams() const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        InferenceParams params;
+        params.confidenceThreshold = m_confidenceThreshold;
+        params.nmsThreshold = m_nmsThreshold;
+        params.roiUpscaleFactor = m_roiUpscaleFactor;
+        params.inputSize = m_inputSize;
+        params.tiled = m_tiledInference;
+        params.tileOverlap = m_tileOverlap;
+        return params;
+    }
+
+    void YoloDetector::preprocess(const cv::Mat &roiImage, const InferenceParams &params, LetterboxTensor &tensor,
+                                  int slot, double &scaleX, double &scaleY, int &padX, int &padY)
+    {
+        // ROI 放大 + letterbox + blob（BGR → RGB, 0~1 正規化）單次寫入持久 tensor
+        const LetterboxTensor::Geometry geometry = tensor.fill(slot, roiImage, params.roiUpscaleFactor);
+        scaleX = geometry.ratio;
+        scaleY = geometry.ratio;
+        padX = geometry.padX;
+        padY = geometry.padY;
+    }
+
     double YoloDetector::detect(const cv::Mat &roiImage, int offsetX, int offsetY,
                                  std::vector<DetectedObject> &results)
     {
-        std::lock_guard<std::mutex> lock(m_mutex);
         results.clear();
 
-        if (!m_modelLoaded || roiImage.empty())
+        if (!isModelLoaded() || roiImage.empty())
         {
             return 0.0;
         }
 
         auto startTime = std::chrono::high_resolution_clock::now();
+        const InferenceParams params = snapshotParams();
+
+        // 1-3. ROI 放大 + Letterbox + blob（同步呼叫端共用一個持久批次；tile 推理時每個 tile 一個槽位）
+        std::lock_guard<std::mutex> syncLock(m_syncMutex);
+        m_syncBatch.count = 0;
+        m_syncBatch.frames = 0;
+        appendFrame(m_syncBatch, roiImage, offsetX, offsetY, 0, 0, params, 1);
+
+        // 4. 推理 + 5. 後處理（NMS + 座標反映射 + tile 接縫合併）
+        runBatch(m_syncBatch, m_syncResults);
+        results.swap(m_syncResults.front().objects);
+
+        auto endTime = std::chrono::high_resolution_clock::now();
+        double elapsedMs = std::chrono::duration<double, std::milli>(endTime - startTime).count();
+        m_lastInferenceTimeMs.store(elapsedMs);
 
-        // 1. ROI 放大（小零件增強）
-        cv::Mat upscaled;
-        if (m_roiUpscaleFactor > 1.0)
+        return elapsedMs;
+    }
+
+    // ===== 非同步推理 =====
+
+    void YoloDetector::startAsync(int batchSize)
+    {
         {
-            cv::resize(roiImage, upscaled, cv::Size(),
-                        m_roiUpscaleFactor, m_roiUpscaleFactor,
-                        cv::INTER_LINEAR);
+            std::lock_guard<std::mutex> lock(m_asyncMutex);
+            m_batchSize = std::max(1, batchSize);
         }
-        else
+
+        if (m_asyncRunning.exchange(true))
         {
-            upscaled = roiImage;
+            return;
         }
 
-        // 2. Letterbox 到模型輸入尺寸
-        cv::Mat letterboxed;
-        double scaleX, scaleY;
-        int padX, padY;
-        letterbox(upscaled, letterboxed, scaleX, scaleY, padX, padY);
+        m_inferenceThread = std::thread(&YoloDetector::inferenceLoop, this);
+        std::cout << "[YoloDetector] 非同步推理線程啟動，批次上限 " << m_batchSize << std::endl;
+    }
 
-        // 3. 建立 blob（BGR → RGB, 0~1 正規化）
-        cv::Mat blob = cv::dnn::blobFromImage(
-            letterboxed, 1.0 / 255.0,
-            cv::Size(m_inputSize, m_inputSize),
-            cv::Scalar(0, 0, 0), true, false);
+    void YoloDetector::stopAsync()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_asyncMutex);
+            if (!m_asyncRunning.exchange(false))
+            {
+                return;
+            }
+        }
+        m_asyncCv.notify_all();
 
-        // 4. 推理
-        m_net.setInput(blob);
-        std::vector<cv::Mat> outputs;
-        m_net.forward(outputs, m_net.getUnconnectedOutLayersNames());
+        if (m_inferenceThread.joinable())
+        {
+            m_inferenceThread.join();
+        }
 
-        // 5. 後處理（NMS + 座標反映射）
-        if (!outputs.empty())
+        std::lock_guard<std::mutex> lock(m_asyncMutex);
+        for (auto &batch : m_batches)
         {
-            postProcess(outputs[0], scaleX, scaleY, padX, padY,
-                         m_roiUpscaleFactor, offsetX, offsetY, results);
+            batch.count = 0;
+            batch.frames = 0;
         }
+        m_pendingIndex = -1;
+        m_inferenceBusy = false;
+        m_completed.clear();
+        std::cout << "[YoloDetector] 非同步推理線程停止" << std::endl;
+    }
 
-        auto endTime = std::chrono::high_resolution_clock::now();
-        m_lastInferenceTimeMs = std::chrono::duration<double, std::milli>(endTime - startTime).count();
+    bool YoloDetector::submitAsync(const cv::Mat &roiImage, int offsetX, int offsetY, uint64_t frameId)
+    {
+        if (!m_asyncRunning.load() || roiImage.empty() || !isModelLoaded())
+        {
+            return false;
+        }
+
+        const InferenceParams params = snapshotParams();
+        std::unique_lock<std::mutex> lock(m_asyncMutex);
+
+        // 填充中的批次已滿（或輸入尺寸改變）：等推理線程空出來再交出（背壓，最壞情況等同同步推理）
+        const Batch &filling = m_batches[m_fillIndex];
+        if (filling.frames >= m_batchSize ||
+            (filling.count > 0 && filling.tensor.size() != params.inputSize))
+        {
+            m_asyncCv.wait(lock, [this]()
+                           { return !m_asyncRunning.load() || (m_pendingIndex < 0 && !m_inferenceBusy); });
+            if (!m_asyncRunning.load())
+            {
+                return false;
+            }
+            handOffLocked();
+        }
+
+        Batch &batch = m_batches[m_fillIndex];
+        const uint64_t generation = m_generation;
+        const int batchCapacity = m_batchSize;
+        lock.unlock();
+
+        // 前處理在呼叫端線程進行，與推理線程上一批的 forward 重疊
+        // （填充中的批次只由呼叫端線程存取，交出前不需持鎖）
+        appendFrame(batch, roiImage, offsetX, offsetY, frameId, generation, params, batchCapacity);
 
-        return m_lastInferenceTimeMs;
+        lock.lock();
+        if (m_pendingIndex < 0 && !m_inferenceBusy)
+        {
+            handOffLocked(); // 推理線程閒置：立即送出，不等湊滿批次
+        }
+        return true;
     }
 
-    void YoloDetector::letterbox(const cv::Mat &src, cv::Mat &dst,
-                                  double &scaleX, double &scaleY,
-                                  int &padX, int &padY)
+    size_t YoloDetector::takeResults(std::vector<YoloFrameResult> &results)
     {
-        int srcW = src.cols;
-        int srcH = src.rows;
-        int targetSize = m_inputSize;
+        std::lock_guard<std::mutex> lock(m_asyncMutex);
+
+        // 推理線程在上次提交後才空閒：把累積中的批次交出去
+        if (m_pendingIndex < 0 && !m_inferenceBusy && m_batches[m_fillIndex].frames > 0)
+        {
+            handOffLocked();
+        }
 
-        // 計算等比縮放比例
-        double ratio = std::min(
-            static_cast<double>(targetSize) / srcW,
-            static_cast<double>(targetSize) / srcH);
+        size_t taken = m_completed.size();
+        while (!m_completed.empty())
+        {
+            results.push_back(std::move(m_completed.front()));
+            m_completed.pop_front();
+        }
+        return taken;
+    }
 
-        int newW = static_cast<int>(srcW * ratio);
-        int newH = static_cast<int>(srcH * ratio);
+    void YoloDetector::discardPendingResults()
+    {
+        std::lock_guard<std::mutex> lock(m_asyncMutex);
+        m_generation++;
+        m_completed.clear();
+        m_batches[m_fillIndex].count = 0;
+        m_batches[m_fillIndex].frames = 0;
+    }
 
-        // 縮放
-        cv::Mat resized;
-        cv::resize(src, resized, cv::Size(newW, newH), 0, 0, cv::INTER_LINEAR);
+    void YoloDetector::appendFrame(Batch &batch, const cv::Mat &roiImage, int offsetX, int offsetY,
+                                   uint64_t frameId, uint64_t generation, const InferenceParams &params,
+                                   int frameCapacity)
+    {
+        const TileLayout layout = planTiles(roiImage.cols, roiImage.rows, params.tiled, params.tileOverlap);
+        const int first = batch.count;
+        const int end = first + layout.count;
 
-        // 計算填充量
-        padX = (targetSize - newW) / 2;
-        padY = (targetSize - newH) / 2;
+        batch.tensor.reserve(std::max(frameCapacity * layout.count, end), params.inputSize);
+        if (static_cast<int>(batch.entries.size()) < end)
+        {
+            batch.entries.resize(end);
+        }
+        if (static_cast<int>(batch.frameFirstSlot.size()) <= batch.frames)
+        {
+            batch.frameFirstSlot.resize(batch.frames + 1);
+        }
 
-        // 灰色填充
-        dst = cv::Mat(targetSize, targetSize, src.type(), cv::Scalar(114, 114, 114));
-        resized.copyTo(dst(cv::Rect(padX, padY, newW, newH)));
+        for (int k = 0; k < layout.count; ++k)
+        {
+            const int tileX = layout.x(k);
+            BatchEntry &entry = batch.entries[first + k];
+            entry.frameId = frameId;
+            entry.generation = generation;
+            entry.params = params;
+            entry.offsetX = offsetX + tileX;
+            entry.offsetY = offsetY;
+            entry.frame = batch.frames;
+            entry.tile = k;
+            entry.tileCount = layout.count;
+            entry.ownBegin = offsetX + (k == 0 ? 0 : layout.seam(k - 1));
+            entry.ownEnd = offsetX + (k + 1 == layout.count ? roiImage.cols : layout.seam(k));
+
+            // tile 是 ROI 的視圖，不複製
+            const cv::Mat tile = layout.count == 1 ? roiImage
+                                                   : roiImage(cv::Rect(tileX, 0, layout.width, roiImage.rows));
+            preprocess(tile, params, batch.tensor, first + k, entry.scaleX, entry.scaleY, entry.padX, entry.padY);
+        }
 
-        // 輸出縮放比（用於反映射）
-        scaleX = ratio;
-        scaleY = ratio;
+        batch.frameFirstSlot[batch.frames] = first;
+        batch.count = end;
+        batch.frames++;
     }
 
-    void YoloDetector::postProcess(const cv::Mat &output,
-                                    double scaleX, double scaleY,
-                                    int padX, int padY,
-                                    double upscaleRatio,
-                                    int offsetX, int offsetY,
-                                    std::vector<DetectedObject> &results)
+    void YoloDetector::handOffLocked()
     {
-        // YOLOv8 輸出格式: [1, (4+numClasses), numDetections]
-        // 對於單類別: [1, 5, N]，需要 transpose 為 [N, 5]
-        // 每行: [cx, cy, w, h, confidence]
+        m_pendingIndex = m_fillIndex;
+        m_fillIndex ^= 1; // 另一組必定空閒：推理線程一次只持有一組
+        m_asyncCv.notify_all();
+    }
+
+    void YoloDetector::inferenceLoop()
+    {
+        setCurrentThreadName("YoloInfer");
+        applyThreadScheduling(ThreadRole::Inference);
+        static constexpr size_t MAX_COMPLETED = 256; // 呼叫端長時間未取用時的上限
+        std::vector<YoloFrameResult> batchResults;
+
+        while (true)
+        {
+            std::unique_lock<std::mutex> lock(m_asyncMutex);
+            m_asyncCv.wait(lock, [this]()
+                           { return !m_asyncRunning.load() || m_pendingIndex >= 0; });
+            if (!m_asyncRunning.load())
+            {
+                break;
+            }
 
-        // 取得輸出維度
-        int rows = output.size[1]; // 5 (4+1 for single class)
-        int cols = output.size[2]; // N detections
+            Batch &batch = m_batches[m_pendingIndex];
+            m_pendingIndex = -1;
+            m_inferenceBusy = true;
+            lock.unlock();
 
-        // 如果 rows < cols，表示需要 transpose（YOLOv8 格式）
-        cv::Mat detections;
-        if (rows < cols)
+            runBatch(batch, batchResults);
+
+            lock.lock();
+            for (int f = 0; f < batch.frames; ++f)
+            {
+                if (batch.entries[batch.frameFirstSlot[f]].generation != m_generation)
+                {
+                    continue; // 重置前提交的幀，不再交付
+                }
+                if (m_completed.size() >= MAX_COMPLETED)
+                {
+                    m_completed.pop_front();
+                }
+                m_completed.push_back(std::move(batchResults[f]));
+            }
+            batch.count = 0;
+            batch.frames = 0;
+            m_inferenceBusy = false;
+            lock.unlock();
+            m_asyncCv.notify_all();
+        }
+    }
+
+    void YoloDetector::runBatch(Batch &batch, std::vector<YoloFrameResult> &out)
+    {
+        const int n = batch.count;
+        out.resize(batch.frames);
+        for (int f = 0; f < batch.frames; ++f)
         {
-            // [1, 5, N] → reshape 為 [5, N] → transpose 為 [N, 5]
-            cv::Mat reshaped = output.reshape(1, rows);
-            cv::transpose(reshaped, detections);
+            const BatchEntry &first = batch.entries[batch.frameFirstSlot[f]];
+            out[f].frameId = first.frameId;
+            out[f].objects.clear();
+            out[f].batchSize = batch.frames;
+            out[f].tileCount = first.tileCount;
         }
-        else
+        if (n == 0)
         {
-            detections = output.reshape(1, rows);
+            return;
         }
 
-        int numDetections = detections.rows;
-        int numFields = detections.cols; // 4 + numClasses
+        auto startTime = std::chrono::high_resolution_clock::now();
+        cv::Mat output;
 
-        std::vector<cv::Rect> boxes;
-        std::vector<float> confidences;
-        std::vector<int> classIds;
+        std::lock_guard<std::mutex> netLock(m_netMutex);
+        if (!m_backend)
+        {
+            return;
+        }
 
-        for (int i = 0; i < numDetections; i++)
+        bool batched = n > 1 && !m_batchUnsupported && m_backend->supportsBatch();
+        bool batchShapeError = false; // 批次失敗且看起來是形狀問題：逐張全部成功時才認定模型不支援批次
+        if (batched)
         {
-            const float *row = detections.ptr<float>(i);
+            try
+            {
+                // 同一批次的 tensor 已連續排列（submitAsync 保證同尺寸），所有幀的所有 tile 一次 forward
+                m_backend->infer(batch.tensor.view(0, n), output);
 
-            // 前 4 個值是 bbox: cx, cy, w, h
-            float cx = row[0];
-            float cy = row[1];
-            float bw = row[2];
-            float bh = row[3];
+                // 輸出 [N, C, A]：逐槽位切出 [1, C, A] 視圖後處理
+                if (output.dims != 3 || output.size[0] != n)
+                {
+                    throw cv::Exception(cv::Error::StsUnmatchedSizes, "unexpected batch output shape",
+                                        __func__, __FILE__, __LINE__);
+                }
+                int sizes[3] = {1, output.size[1], output.size[2]};
+                for (int i = 0; i < n; ++i)
+                {
+                    BatchEntry &entry = batch.entries[i];
+                    cv::Mat single(3, sizes, CV_32F, const_cast<float *>(output.ptr<float>(i)));
+                    decodeSlot(entry, single, out[entry.frame].objects);
+                }
+            }
+            catch (const cv::Exception &e)
+            {
+                batchShapeError = isBatchShapeError(e);
+                batched = false;
+                for (auto &result : out)
+                {
+                    result.objects.clear();
+                }
+                std::cerr << "[YoloDetector] 批次推理失敗，本次改為逐張: " << e.what() << std::endl;
+            }
+            catch (const std::exception &e)
+            {
+                // 非形狀錯誤（記憶體、裝置等）：只有這一批逐張，下一批仍嘗試批次
+                batched = false;
+                for (auto &result : out)
+                {
+                    result.objects.clear();
+                }
+                std::cerr << "[YoloDetector] 批次推理失敗，本次改為逐張: " << e.what() << std::endl;
+            }
+        }
 
-            // 從第 5 個值開始是各類別的信心分數
-            // 找最高信心的類別
-            float maxConf = 0.0f;
-            int maxClassId = 0;
-            for (int j = 4; j < numFields; j++)
+        if (!batched)
+        {
+            bool singlesOk = true;
+            for (int i = 0; i < n; ++i)
             {
-                if (row[j] > maxConf)
+                BatchEntry &entry = batch.entries[i];
+                std::vector<DetectedObject> &objects = out[entry.frame].objects;
+                entry.firstObject = static_cast<int>(objects.size());
+                try
+                {
+                    m_backend->infer(batch.tensor.view(i, 1), output);
+                    decodeSlot(entry, output, objects);
+                }
+                catch (const std::exception &e)
                 {
-                    maxConf = row[j];
-                    maxClassId = j - 4;
+                    // 推理線程不可拋出例外；該槽位視為無偵測
+                    singlesOk = false;
+                    objects.resize(entry.firstObject);
+                    std::cerr << "[YoloDetector] 推理失敗 (frame " << entry.frameId << "): " << e.what() << std::endl;
                 }
             }
 
-            if (maxConf < m_confidenceThreshold)
+            if (batchShapeError && singlesOk)
             {
-                continue;
+                // 形狀錯誤且 batch=1 可正常推理：固定 batch=1 匯出的模型，之後一律逐張
+                m_batchUnsupported = true;
+                std::cerr << "[YoloDetector] 模型不支援批次推理，之後一律逐張" << std::endl;
             }
+        }
 
-            // 座標反映射：letterbox → upscaled image
-            float x1 = (cx - bw / 2.0f - padX) / static_cast<float>(scaleX);
-            float y1 = (cy - bh / 2.0f - padY) / static_cast<float>(scaleY);
-            float x2 = (cx + bw / 2.0f - padX) / static_cast<float>(scaleX);
-            float y2 = (cy + bh / 2.0f - padY) / static_cast<float>(scaleY);
+        for (int f = 0; f < batch.frames; ++f)
+        {
+            const int firstSlot = batch.frameFirstSlot[f];
+            if (batch.entries[firstSlot].tileCount > 1)
+            {
+                mergeTileSeams(batch, firstSlot, out[f].objects);
+            }
+        }
+
+        auto endTime = std::chrono::high_resolution_clock::now();
+        double elapsedMs = std::chrono::duration<double, std::milli>(endTime - startTime).count();
+        m_lastInferenceTimeMs.store(elapsedMs);
+        for (auto &result : out)
+        {
+            result.inferenceMs = elapsedMs;
+        }
+    }
 
-            // 反映射：upscaled → 原始 ROI
-            x1 /= static_cast<float>(upscaleRatio);
-            y1 /= static_cast<float>(upscaleRatio);
-            x2 /= static_cast<float>(upscaleRatio);
-            y2 /= static_cast<float>(upscaleRatio);
+    void YoloDetector::decodeSlot(BatchEntry &entry, const cv::Mat &output, std::vector<DetectedObject> &objects)
+    {
+        entry.firstObject = static_cast<int>(objects.size());
+        postProcess(output, entry.params, entry.scaleX, entry.scaleY, entry.padX, entry.padY,
+                    entry.params.roiUpscaleFactor, entry.offsetX, entry.offsetY, objects);
 
-            int bx = static_cast<int>(x1);
-            int by = static_cast<int>(y1);
-            int boxW = static_cast<int>(x2 - x1);
-            int boxH = static_cast<int>(y2 - y1);
+        if (entry.tileCount > 1)
+        {
+            // 只保留中心點落在本 tile 負責範圍的框；重疊區另一半由相鄰 tile 負責
+            auto begin = objects.begin() + entry.firstObject;
+            objects.erase(std::remove_if(begin, objects.end(),
+                                         [&entry](const DetectedObject &obj)
+                                         { return obj.cx < entry.ownBegin || obj.cx >= entry.ownEnd; }),
+                          objects.end());
+        }
+    }
 
-            if (boxW > 0 && boxH > 0)
+    void YoloDetector::mergeTileSeams(const Batch &batch, int firstSlot, std::vector<DetectedObject> &objects)
+    {
+        // 物件跨越接縫時，其中一側只看到被 tile 邊緣切斷的部分：
+        // 截斷框的中心可能落在本側負責範圍，與另一側的完整框重複。
+        // 兩側靠近接縫的框 IoMin 大於閾值即視為同一物件，保留較大（較完整）者。
+        const BatchEntry *tiles = &batch.entries[firstSlot];
+        const int tileCount = tiles[0].tileCount;
+        const int total = static_cast<int>(objects.size());
+        m_seamRemoved.assign(total, 0);
+        bool removedAny = false;
+
+        for (int k = 0; k + 1 < tileCount; ++k)
+        {
+            const int seam = tiles[k].ownEnd;
+            const int margin = std::max(1, seam - tiles[k + 1].offsetX); // 半個實際重疊寬
+            const int rightEnd = k + 2 < tileCount ? tiles[k + 2].firstObject : total;
+
+            for (int i = tiles[k].firstObject; i < tiles[k + 1].firstObject; ++i)
             {
-                boxes.push_back(cv::Rect(bx, by, boxW, boxH));
-                confidences.push_back(maxConf);
-                classIds.push_back(maxClassId);
+                if (!touchesSeam(objects[i], seam, margin))
+                {
+                    continue;
+                }
+                for (int j = tiles[k + 1].firstObject; j < rightEnd && !m_seamRemoved[i]; ++j)
+                {
+                    if (m_seamRemoved[j] || !touchesSeam(objects[j], seam, margin) ||
+                        intersectionOverMin(objects[i], objects[j]) <= SEAM_MERGE_IOMIN)
+                    {
+                        continue;
+                    }
+                    m_seamRemoved[objects[i].area >= objects[j].area ? j : i] = 1;
+                    removedAny = true;
+                }
             }
         }
 
-        // NMS 去除重疊框
-        std::vector<int> nmsIndices;
-        cv::dnn::NMSBoxes(boxes, confidences, static_cast<float>(m_confidenceThreshold),
-                           static_cast<float>(m_nmsThreshold), nmsIndices);
+        if (!removedAny)
+        {
+            return;
+        }
 
-        for (int idx : nmsIndices)
+        int kept = 0;
+        for (int i = 0; i < total; ++i)
         {
-            const auto &box = boxes[idx];
+            if (!m_seamRemoved[i])
+            {
+                objects[kept++] = objects[i];
+            }
+        }
+        objects.resize(kept);
+    }
 
+    void YoloDetector::postProcess(const cv::Mat &output, const InferenceParams &params,
+                                    double scaleX, double scaleY,
+                                    int padX, int padY,
+                                    double upscaleRatio,
+                                    int offsetX, int offsetY,
+                                    std::vector<DetectedObject> &results)
+    {
+        // YOLOv8 輸出格式: [1, (4+numClasses), numDetections]
+        // 解碼、信心過濾與 NMS 由 YoloPostProcessor 處理（SIMD 提早淘汰 + 小框 NMS）
+        YoloPostProcessor::Mapping mapping;
+        mapping.scaleX = scaleX;
+        mapping.scaleY = scaleY;
+        mapping.padX = padX;
+        mapping.padY = padY;
+        mapping.upscaleRatio = upscaleRatio;
+
+        const auto &boxes = m_postProcessor.run(output, static_cast<float>(params.confidenceThreshold),
+                                                static_cast<float>(params.nmsThreshold), mapping);
+
+        results.reserve(results.size() + boxes.size());
+        for (const auto &box : boxes)
+        {
             DetectedObject obj;
             // 加上 ROI 偏移轉換到原圖座標
             obj.x = box.x + offsetX;
             obj.y = box.y + offsetY;
-            obj.w = box.width;
-            obj.h = box.height;
+            obj.w = box.w;
+            obj.h = box.h;
             obj.cx = obj.x + obj.w / 2;
             obj.cy = obj.y + obj.h / 2;
             obj.area = obj.w * obj.h;
@@ -280,4 +684,11 @@ namespace basler
         m_inputSize = size;
     }
 
+    void YoloDetector::setTiling(bool enabled, int overlap)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_tiledInference = enabled;
+        m_tileOverlap = std::max(0, overlap);
+    }
+
 } // namespace basler
@@ -0,0 +1,93 @@
+#include "core/yolo_inference_pool.h"
+#include "core/yolo_detector.h"
+#include "core/detection_controller.h"
+#include <algorithm>
+
+namespace basler
+{
+
+    YoloInferencePool::YoloInferencePool(int workers)
+    {
+        workers = std::max(1, workers);
+        m_detectors.reserve(workers);
+        m_idle.reserve(workers);
+        for (int i = 0; i < workers; ++i)
+        {
+            m_detectors.push_back(std::make_unique<YoloDetector>());
+            m_idle.push_back(m_detectors.back().get());
+        }
+    }
+
+    YoloInferencePool::~YoloInferencePool()
+    {
+        // 呼叫端應先停止所有檢測線程；這裡仍等待進行中的推理歸還實例
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_idleCv.wait(lock, [this]()
+                      { return m_idle.size() == m_detectors.size(); });
+    }
+
+    YoloDetector *YoloInferencePool::acquire()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_idleCv.wait(lock, [this]()
+                      { return !m_idle.empty(); });
+        YoloDetector *detector = m_idle.back();
+        m_idle.pop_back();
+        return detector;
+    }
+
+    void YoloInferencePool::release(YoloDetector *detector)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_idle.push_back(detector);
+        }
+        m_idleCv.notify_one();
+    }
+
+    void YoloInferencePool::configure(const std::function<void(YoloDetector &)> &apply)
+    {
+        // 逐一取得所有實例（套用期間不會有推理在同一實例上進行）
+        std::vector<YoloDetector *> held;
+        held.reserve(m_detectors.size());
+        for (size_t i = 0; i < m_detectors.size(); ++i)
+        {
+            held.push_back(acquire());
+        }
+        for (YoloDetector *detector : held)
+        {
+            apply(*detector);
+        }
+        for (YoloDetector *detector : held)
+        {
+            release(detector);
+        }
+    }
+
+    bool YoloInferencePool::loadModel(const std::string &modelPath)
+    {
+        bool allLoaded = true;
+        configure([&](YoloDetector &detector)
+                  { allLoaded = detector.loadModel(modelPath) && allLoaded; });
+        m_modelLoaded.store(allLoaded);
+        return allLoaded;
+    }
+
+    double YoloInferencePool::detect(const cv::Mat &roiImage, int offsetX, int offsetY,
+                                     std::vector<DetectedObject> &results)
+    {
+        results.clear();
+        if (!m_modelLoaded.load())
+        {
+            return 0.0;
+        }
+
+        YoloDetector *detector = acquire();
+        const double ms = detector->detect(roiImage, offsetX, offsetY, results);
+        release(detector);
+
+        m_lastInferenceTimeMs.store(ms);
+        return ms;
+    }
+
+} // namespace basler
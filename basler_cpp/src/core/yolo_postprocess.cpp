@@ -0,0 +1,239 @@
+#include "core/yolo_postprocess.h"
+#include <opencv2/core/hal/intrin.hpp>
+#include <algorithm>
+
+namespace basler
+{
+
+    namespace
+    {
+        constexpr int MAX_NMS_BUCKETS = 4096;
+
+        inline double boxIoU(const YoloPostProcessor::Box &a, const YoloPostProcessor::Box &b)
+        {
+            const int iw = std::min(a.x + a.w, b.x + b.w) - std::max(a.x, b.x);
+            const int ih = std::min(a.y + a.h, b.y + b.h) - std::max(a.y, b.y);
+            if (iw <= 0 || ih <= 0)
+            {
+                return 0.0;
+            }
+            const double inter = static_cast<double>(iw) * ih;
+            return inter / (static_cast<double>(a.w) * a.h + static_cast<double>(b.w) * b.h - inter);
+        }
+    }
+
+    const std::vector<YoloPostProcessor::Box> &YoloPostProcessor::run(const cv::Mat &output, float confThreshold,
+                                                                      float nmsThreshold, const Mapping &mapping)
+    {
+        m_candidates.clear();
+        m_kept.clear();
+        m_mapping = mapping;
+
+        CV_Assert(output.type() == CV_32F && output.isContinuous());
+
+        // [1, C, A] 或 [C, A]
+        const int rows = output.dims >= 3 ? output.size[1] : output.rows;
+        const int cols = output.dims >= 3 ? output.size[2] : output.cols;
+        const float *data = output.ptr<float>();
+
+        if (rows < cols)
+        {
+            // 通道優先（YOLOv8 標準）：rows = 4 + 類別數
+            const int numClasses = rows - 4;
+            switch (numClasses)
+            {
+            case 1:
+                collectChannelMajor<1>(data, numClasses, cols, confThreshold);
+                break;
+            case 2:
+                collectChannelMajor<2>(data, numClasses, cols, confThreshold);
+                break;
+            case 3:
+                collectChannelMajor<3>(data, numClasses, cols, confThreshold);
+                break;
+            case 4:
+                collectChannelMajor<4>(data, numClasses, cols, confThreshold);
+                break;
+            default:
+                if (numClasses > 0)
+                {
+                    collectChannelMajor<0>(data, numClasses, cols, confThreshold);
+                }
+                break;
+            }
+        }
+        else
+        {
+            collectAnchorMajor(data, cols, rows, confThreshold);
+        }
+
+        suppress(nmsThreshold);
+        return m_kept;
+    }
+
+    template <int NumClasses>
+    void YoloPostProcessor::collectChannelMajor(const float *data, int numClasses, int anchors, float confThreshold)
+    {
+        // NumClasses > 0：編譯期類別數，類別迴圈可完全展開；0 = 執行期類別數
+        const int nc = NumClasses > 0 ? NumClasses : numClasses;
+        const float *conf = data + 4 * anchors; // 類別 c 的信心平面 = conf + c * anchors
+
+        auto consider = [&](int a)
+        {
+            float maxConf = 0.0f;
+            int maxClassId = 0;
+            for (int c = 0; c < nc; ++c)
+            {
+                const float v = conf[c * anchors + a];
+                if (v > maxConf)
+                {
+                    maxConf = v;
+                    maxClassId = c;
+                }
+            }
+            if (maxConf > confThreshold)
+            {
+                pushCandidate(data[a], data[anchors + a], data[2 * anchors + a], data[3 * anchors + a],
+                              maxConf, maxClassId);
+            }
+        };
+
+        int a = 0;
+#if CV_SIMD128
+        const cv::v_float32x4 vThresh = cv::v_setall_f32(confThreshold);
+        for (; a <= anchors - 4; a += 4)
+        {
+            cv::v_float32x4 vMax = cv::v_load(conf + a);
+            for (int c = 1; c < nc; ++c)
+            {
+                vMax = cv::v_max(vMax, cv::v_load(conf + c * anchors + a));
+            }
+
+            // 絕大多數 anchor 整組低於閾值，直接跳過
+            if (!cv::v_check_any(vMax > vThresh))
+            {
+                continue;
+            }
+            for (int k = 0; k < 4; ++k)
+            {
+                consider(a + k);
+            }
+        }
+#endif
+        for (; a < anchors; ++a)
+        {
+            consider(a);
+        }
+    }
+
+    void YoloPostProcessor::collectAnchorMajor(const float *data, int numFields, int anchors, float confThreshold)
+    {
+        // 少見的 [1, A, 4 + 類別數] 匯出格式：逐列純量
+        for (int a = 0; a < anchors; ++a)
+        {
+            const float *row = data + static_cast<size_t>(a) * numFields;
+            float maxConf = 0.0f;
+            int maxClassId = 0;
+            for (int j = 4; j < numFields; ++j)
+            {
+                if (row[j] > maxConf)
+                {
+                    maxConf = row[j];
+                    maxClassId = j - 4;
+                }
+            }
+            if (maxConf > confThreshold)
+            {
+                pushCandidate(row[0], row[1], row[2], row[3], maxConf, maxClassId);
+            }
+        }
+    }
+
+    void YoloPostProcessor::pushCandidate(float cx, float cy, float bw, float bh, float score, int classId)
+    {
+        const float scaleX = static_cast<float>(m_mapping.scaleX);
+        const float scaleY = static_cast<float>(m_mapping.scaleY);
+        const float upscale = static_cast<float>(m_mapping.upscaleRatio);
+
+        // 座標反映射：letterbox → upscaled image → 原始 ROI
+        const float x1 = (cx - bw / 2.0f - m_mapping.padX) / scaleX / upscale;
+        const float y1 = (cy - bh / 2.0f - m_mapping.padY) / scaleY / upscale;
+        const float x2 = (cx + bw / 2.0f - m_mapping.padX) / scaleX / upscale;
+        const float y2 = (cy + bh / 2.0f - m_mapping.padY) / scaleY / upscale;
+
+        Box box;
+        box.x = static_cast<int>(x1);
+        box.y = static_cast<int>(y1);
+        box.w = static_cast<int>(x2 - x1);
+        box.h = static_cast<int>(y2 - y1);
+        box.score = score;
+        box.classId = classId;
+
+        if (box.w > 0 && box.h > 0)
+        {
+            m_candidates.push_back(box);
+        }
+    }
+
+    void YoloPostProcessor::suppress(float nmsThreshold)
+    {
+        const int count = static_cast<int>(m_candidates.size());
+        if (count == 0)
+        {
+            return;
+        }
+
+        // 依分數由高到低（穩定排序，同分保持原順序，與 cv::dnn::NMSBoxes 相同）
+        m_order.resize(count);
+        for (int i = 0; i < count; ++i)
+        {
+            m_order[i] = i;
+        }
+        std::stable_sort(m_order.begin(), m_order.end(),
+                         [this](int a, int b)
+                         { return m_candidates[a].score > m_candidates[b].score; });
+
+        // x 分桶：桶寬 >= 最大框寬，兩框要重疊 x 起點差必小於桶寬 → 只需比相鄰桶
+        int minX = m_candidates[0].x;
+        int maxX = minX;
+        int maxW = 1;
+        for (const auto &box : m_candidates)
+        {
+            minX = std::min(minX, box.x);
+            maxX = std::max(maxX, box.x);
+            maxW = std::max(maxW, box.w);
+        }
+        const int range = maxX - minX + 1;
+        const int bucketWidth = std::max(maxW, range / MAX_NMS_BUCKETS + 1);
+        const int bucketCount = range / bucketWidth + 1;
+        m_bucketHead.assign(bucketCount, -1);
+        m_nextInBucket.clear();
+
+        for (int idx : m_order)
+        {
+            const Box &box = m_candidates[idx];
+            const int bucket = (box.x - minX) / bucketWidth;
+
+            bool keep = true;
+            for (int b = std::max(bucket - 1, 0); b <= std::min(bucket + 1, bucketCount - 1) && keep; ++b)
+            {
+                for (int k = m_bucketHead[b]; k >= 0; k = m_nextInBucket[k])
+                {
+                    if (boxIoU(box, m_kept[k]) > nmsThreshold)
+                    {
+                        keep = false;
+                        break;
+                    }
+                }
+            }
+
+            if (keep)
+            {
+                m_nextInBucket.push_back(m_bucketHead[bucket]);
+                m_bucketHead[bucket] = static_cast<int>(m_kept.size());
+                m_kept.push_back(box);
+            }
+        }
+    }
+
+} // namespace basler
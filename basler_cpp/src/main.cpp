@@ -1,7 +1,11 @@
 #include <QApplication>
+#include <QCoreApplication>
 #include <QStyleFactory>
 #include <QDebug>
+#include <cstring>
 #include "ui/main_window.h"
+#include "core/offline_replay.h"
+#include "core/multi_pipeline.h"
 
 /**
  * Basler 工業視覺系統 - C++ 版本
@@ -14,6 +18,25 @@
  */
 int main(int argc, char *argv[])
 {
+    // 離線重播 / 多相機：無介面，不建立 QApplication / MainWindow
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--replay") == 0 || std::strncmp(argv[i], "--replay=", 9) == 0)
+        {
+            QCoreApplication app(argc, argv);
+            app.setApplicationName("Basler Vision System");
+            app.setApplicationVersion("2.0.0");
+            return basler::runOfflineReplay(app.arguments());
+        }
+        if (std::strcmp(argv[i], "--multi-camera") == 0)
+        {
+            QCoreApplication app(argc, argv);
+            app.setApplicationName("Basler Vision System");
+            app.setApplicationVersion("2.0.0");
+            return basler::runMultiCamera(app.arguments());
+        }
+    }
+
     // 高 DPI 支援
     QApplication::setHighDpiScaleFactorRoundingPolicy(
         Qt::HighDpiScaleFactorRoundingPolicy::PassThrough
@@ -11,6 +11,7 @@
 #include "ui/widgets/system_monitor.h"
 #include "config/settings.h"
 #include "core/video_player.h"
+#include "core/thread_scheduling.h"
 
 #include <QMenuBar>
 #include <QStatusBar>
@@ -58,11 +59,57 @@ namespace basler
         applyTheme(m_isDarkTheme);
         applyFontScale(m_fontScale);
 
+        // 主線程（UI 事件循環）排程；管線線程各自在啟動時套用
+        applyThreadScheduling(ThreadRole::Ui);
+
         // 初始化核心控制器
         m_sourceManager = std::make_unique<SourceManager>(this);
         m_detectionController = std::make_unique<DetectionController>(this);
         m_videoRecorder = std::make_unique<VideoRecorder>("recordings", this);
-        m_vibratorManager = createDualVibratorManager("simulated", "震動機A", "震動機B");
+        m_eventRecorder = std::make_unique<EventRecorder>(m_sourceManager->frameRing(), this);
+        m_vibratorManager = createDualVibratorManager(Settings::instance().vibrator().driver, "震動機A", "震動機B");
+
+        // 即時震動機控制：計數事件由檢測線程直送控制線程（PackagingConfig::realtimeControl）
+        m_vibratorControl = std::make_unique<VibratorControlLoop>();
+        m_vibratorControl->setVibrators(m_vibratorManager.get());
+        if (m_vibratorControl->start())
+        {
+            m_detectionController->setControlLoop(m_vibratorControl.get());
+        }
+
+        // 檢測管線線程：processFrame 不再佔用 UI 線程
+        m_detectionThread = std::make_unique<QThread>();
+        m_detectionThread->setObjectName("DetectionThread");
+        m_detectionWorker = std::make_unique<DetectionWorker>(m_detectionController.get(),
+                                                              m_sourceManager->frameRing());
+        m_detectionWorker->moveToThread(m_detectionThread.get());
+        connect(m_detectionThread.get(), &QThread::started, m_detectionThread.get(), []()
+                { applyThreadScheduling(ThreadRole::Detection); },
+                Qt::DirectConnection);
+        connect(m_detectionThread.get(), &QThread::started,
+                m_detectionWorker.get(), &DetectionWorker::run, Qt::QueuedConnection);
+        connect(m_detectionWorker.get(), &DetectionWorker::qualityLevelChanged, this,
+                [this](int level, const QString &description)
+                {
+                    if (level == static_cast<int>(QualityLevel::Full))
+                    {
+                        m_statusLabel->setText("品質調節: 已恢復完整品質");
+                        return;
+                    }
+                    m_statusLabel->setText(QString("⚠ 品質調節: %1（檢測跟不上輸入幀率）").arg(description));
+                    if (Settings::instance().debug().triggerOnQualityDegrade)
+                        m_eventRecorder->trigger(EventTrigger::QualityDegrade, description);
+                },
+                Qt::QueuedConnection);
+
+        // 遙測端點（TelemetryConfig::enabled）：在檢測線程啟動前接上指標來源
+        m_metricsServer = startMetricsServer(Settings::instance().telemetry());
+        if (m_metricsServer)
+        {
+            m_telemetry = std::make_unique<PipelineTelemetry>("main", m_detectionController.get(),
+                                                              m_detectionWorker.get(), m_sourceManager.get());
+        }
+        m_detectionThread->start();
 
         // 設置 UI
         setupUi();
@@ -75,6 +122,10 @@ namespace basler
         connectPackagingSignals();
         connectDetectionSignals();
         connectDebugSignals();
+        connectEventRecordingSignals();
+
+        // 事件錄影：常駐預觸發緩衝（DebugConfig::eventRecordingEnabled）
+        m_eventRecorder->start();
 
         // UI 更新定時器（60 FPS）
         m_updateTimer = new QTimer(this);
@@ -87,6 +138,9 @@ namespace basler
         // 設置鍵盤快捷鍵
         setupKeyboardShortcuts();
 
+        // 啟動第二階段：耗時的模型載入與相機連接在視窗顯示後於背景進行
+        QTimer::singleShot(0, this, &MainWindow::startDeferredStartup);
+
         // 首次使用：延遲 500ms 後顯示設定向導（讓主視窗先完整渲染）
         if (SetupWizard::isFirstRun())
         {
@@ -102,6 +156,27 @@ namespace basler
         qDebug() << "[MainWindow] 初始化完成";
     }
 
+    void MainWindow::startDeferredStartup()
+    {
+        // YOLO：依偵測模式延遲載入，載入與暖機在背景線程，完成前以傳統模式檢測
+        m_detectionController->loadConfiguredYoloModel();
+
+        // 相機：有上次連線的序號時直接連接（GigE 帶快取 IP，跳過完整列舉），否則在背景掃描
+        QSettings prefs("BaslerVision", "BaslerVisionSystem");
+        const QString serial = prefs.value("lastCameraSerial").toString();
+        if (Settings::instance().camera().autoConnectLastCamera && !serial.isEmpty())
+        {
+            m_startupReconnect = true;
+            m_statusLabel->setText(QString("重新連接上次的相機 %1...").arg(serial));
+            m_sourceManager->connectCameraBySerial(serial, prefs.value("lastCameraIp").toString());
+        }
+        else
+        {
+            m_statusLabel->setText("背景掃描相機中...");
+            detectCamerasAsync(3, 2000);
+        }
+    }
+
     MainWindow::~MainWindow()
     {
         qDebug() << "[MainWindow] 開始析構...";
@@ -128,6 +203,11 @@ namespace basler
         {
             m_videoRecorder->disconnect(this);
         }
+        if (m_eventRecorder)
+        {
+            m_eventRecorder->disconnect(this);
+            m_eventRecorder->stop();
+        }
 
         // 4. 停止進行中的操作（如果 closeEvent 沒被調用）
         if (m_isRecording && m_videoRecorder)
@@ -143,7 +223,25 @@ namespace basler
             m_sourceManager->stopGrabbing();
         }
 
-        // 5. 其他資源由 unique_ptr RAII 自動清理
+        // 5. 停止檢測線程（必須在 DetectionController 析構前完成）
+        if (m_detectionThread)
+        {
+            m_detectionWorker->stop();
+            m_detectionThread->quit();
+            m_detectionThread->wait();
+        }
+
+        // 6. 檢測線程結束後才停止即時控制（已排入的停止指令會先送出）
+        if (m_vibratorControl)
+        {
+            if (m_detectionController)
+            {
+                m_detectionController->setControlLoop(nullptr);
+            }
+            m_vibratorControl->stop();
+        }
+
+        // 7. 其他資源由 unique_ptr RAII 自動清理
         qDebug() << "[MainWindow] 析構完成";
     }
 
@@ -154,6 +252,7 @@ namespace basler
         {
             m_videoRecorder->stopRecording();
         }
+        m_eventRecorder->stop();
         if (m_isDetecting)
         {
             m_detectionController->disable();
@@ -443,6 +542,9 @@ namespace basler
         QAction *loadYoloAction = fileMenu->addAction("載入 YOLO 模型(&Y)...");
         connect(loadYoloAction, &QAction::triggered, this, &MainWindow::onLoadYoloModel);
 
+        QAction *exportLatencyAction = fileMenu->addAction("匯出檢測延遲統計(&T)");
+        connect(exportLatencyAction, &QAction::triggered, this, &MainWindow::exportStageLatency);
+
         fileMenu->addSeparator();
 
         QAction *exitAction = fileMenu->addAction("退出(&X)");
@@ -585,6 +687,8 @@ namespace basler
                 this, &MainWindow::onFrameReady, Qt::QueuedConnection);
         connect(m_sourceManager.get(), &SourceManager::fpsUpdated,
                 this, &MainWindow::onFpsUpdated, Qt::QueuedConnection);
+        connect(m_sourceManager.get(), &SourceManager::framesMissed,
+                this, &MainWindow::onFramesMissed, Qt::QueuedConnection);
         connect(m_sourceManager.get(), &SourceManager::error,
                 this, &MainWindow::onCameraError, Qt::QueuedConnection);
     }
@@ -605,13 +709,20 @@ namespace basler
         connect(m_videoRecorder.get(), &VideoRecorder::recordingError,
                 this, &MainWindow::onRecordingError);
 
-        // 錄影幀數/時長即時更新
-        connect(m_videoRecorder.get(), &VideoRecorder::frameWritten,
-                [this](int totalFrames)
+        // 錄影進度（錄影線程節流發出，排隊到 UI 線程）
+        connect(m_videoRecorder.get(), &VideoRecorder::recordingProgress, this,
+                [this](const RecordingInfo &info)
                 {
-                    double duration = m_videoRecorder->recordingDuration();
-                    m_recordingControl->updateStats(totalFrames, duration);
-                });
+                    m_recordingControl->updateStats(info.framesRecorded, info.duration);
+                    m_recordingLabel->setToolTip(QString("編碼佇列: %1/%2 幀（最大 %3），丟幀 %4，編碼 %5 ms（最大 %6 ms）")
+                                                     .arg(info.queueDepth)
+                                                     .arg(Settings::instance().recording().queueFrames)
+                                                     .arg(info.maxQueueDepth)
+                                                     .arg(info.framesDropped)
+                                                     .arg(info.averageEncodeMs, 0, 'f', 1)
+                                                     .arg(info.maxEncodeMs, 0, 'f', 1));
+                },
+                Qt::QueuedConnection);
     }
 
     void MainWindow::connectPackagingSignals()
@@ -657,14 +768,65 @@ namespace basler
         connect(m_detectionController.get(), &DetectionController::defectStatsUpdated,
                 this, &MainWindow::onDefectStatsUpdated);
 
-        // 震動機控制
+        // 逐階段延遲：每個窗口顯示於系統監控，並合併供匯出
+        connect(m_detectionController.get(), &DetectionController::stageLatencyUpdated, this,
+                [this](const StageLatencySnapshot &snapshot)
+                {
+                    m_systemMonitor->setStageLatency(snapshot);
+                    m_latencyTotal.merge(snapshot);
+                },
+                Qt::QueuedConnection);
+
+        // 震動機控制（信號由檢測線程發出，指定 this 作為 context 使其在 UI 線程執行）
+        // 即時控制線程執行中時已由它致動，這裡不重複設定
         connect(m_detectionController.get(), &DetectionController::vibratorSpeedChanged,
-                [this](VibratorSpeed speed)
+                this, [this](VibratorSpeed speed)
+                {
+                    if (!m_vibratorControl->isRunning())
+                        m_vibratorManager->setSpeed(speed);
+                });
+        // 多料道：各料道各自控制對應的震動機（料道 0 / 1 = 震動機 1 / 2）
+        connect(m_detectionController.get(), &DetectionController::laneVibratorSpeedChanged,
+                this, [this](int lane, VibratorSpeed speed)
                 {
-                    m_vibratorManager->setSpeed(speed);
+                    if (!m_vibratorControl->isRunning())
+                        m_vibratorManager->setLaneSpeed(lane, speed);
                 });
     }
 
+    void MainWindow::connectEventRecordingSignals()
+    {
+        // 光柵爆量：objectsCrossedGate 由檢測線程發出，排隊到 EventRecorder 所在的 UI 線程統計
+        connect(m_detectionController.get(), &DetectionController::objectsCrossedGate,
+                m_eventRecorder.get(), [this](int)
+                {
+                    m_eventRecorder->noteGateCrossing();
+                });
+
+        // 片段進度（由事件錄影線程發出）
+        connect(m_eventRecorder.get(), &EventRecorder::eventStarted, this,
+                [this](const QString &reason, const QString &path)
+                {
+                    m_statusLabel->setText(QString("事件錄影: %1 → %2").arg(reason, QFileInfo(path).fileName()));
+                },
+                Qt::QueuedConnection);
+        connect(m_eventRecorder.get(), &EventRecorder::eventSaved, this,
+                [this](const QString &path, int frames, int preTriggerFrames)
+                {
+                    m_statusLabel->setText(QString("事件片段已保存: %1（%2 幀，含預觸發 %3 幀）")
+                                               .arg(QFileInfo(path).fileName())
+                                               .arg(frames)
+                                               .arg(preTriggerFrames));
+                },
+                Qt::QueuedConnection);
+        connect(m_eventRecorder.get(), &EventRecorder::eventError, this,
+                [this](const QString &error)
+                {
+                    m_debugPanel->logError("事件錄影：" + error);
+                },
+                Qt::QueuedConnection);
+    }
+
     void MainWindow::connectDebugSignals()
     {
         // ROI 參數
@@ -684,6 +846,7 @@ namespace basler
                 {
                     Settings::instance().detection().roiEnabled = enabled;
                     m_detectionController->setRoiEnabled(enabled);
+                    updateSensorAoi();
                 });
 
         // 背景減除參數
@@ -851,18 +1014,24 @@ namespace basler
                 this, &MainWindow::onLoadYoloModel);
 
         // YOLO 狀態反饋到 UI
+        connect(m_detectionController.get(), &DetectionController::yoloModelLoading,
+                m_debugPanel, &DebugPanelWidget::showYoloModelLoading);
         connect(m_detectionController.get(), &DetectionController::yoloModelLoaded,
                 m_debugPanel, &DebugPanelWidget::updateYoloModelStatus);
+        connect(m_detectionController.get(), &DetectionController::yoloModelLoaded,
+                this, &MainWindow::onYoloModelLoaded);
         connect(m_detectionController.get(), &DetectionController::yoloInferenceTimeUpdated,
                 m_debugPanel, &DebugPanelWidget::updateYoloInferenceTime);
 
         // 處理解析度（targetProcessingWidth）
         connect(m_debugPanel, &DebugPanelWidget::processingWidthChanged,
-                [](int width)
+                [this](int width)
                 {
                     auto &cfg = Settings::instance().performance();
                     // 0 = 原生解析度模式：設為一個不可能超過的大值，讓縮放邏輯跳過縮放
                     cfg.targetProcessingWidth = (width > 0) ? width : 99999;
+                    m_detectionController->reloadPerformanceParams();
+                    updateSensorAoi(); // ROI 參數在處理解析度下，換算到感測器的位置隨之改變
                 });
 
         // Profile 載入後將新設定套用到 DetectionController
@@ -883,6 +1052,7 @@ namespace basler
                     m_detectionController->setGateTriggerRadius(gate.triggerRadius);
                     m_detectionController->setGateHistoryFrames(gate.gateHistoryFrames);
                     m_detectionController->setGateLinePositionRatio(gate.gateLinePositionRatio);
+                    updateSensorAoi();
                     m_statusLabel->setText(QString("已載入模板：%1").arg(profileName));
                 });
 
@@ -912,13 +1082,36 @@ namespace basler
 
         // 主畫面視覺化模式：0=原始, 1=前景遮罩, 2=Canny, 3=三重聯合, 4=最終形態學
         connect(m_debugPanel, &DebugPanelWidget::debugViewModeChanged,
-                [this](int mode){ m_debugViewMode = mode; });
+                [this](int mode){ m_debugViewMode = mode; updateDebugTapSubscription(); });
+
+        // 調試視圖開關：只在需要中間幀時讓檢測線程擷取
+        connect(m_debugPanel, &DebugPanelWidget::debugViewToggled,
+                [this](bool){ updateDebugTapSubscription(); });
 
         // 分割顯示模式（Debug Panel 按鈕觸發）
         connect(m_debugPanel, &DebugPanelWidget::splitViewToggleRequested,
                 this, &MainWindow::toggleSplitView);
     }
 
+    void MainWindow::updateDebugTapSubscription()
+    {
+        // 調試面板開啟或主畫面選了中間結果時才需要檢測線程擷取中間幀
+        const bool wanted = (m_debugPanel && m_debugPanel->isShowingDebugView()) || m_debugViewMode != 0;
+        if (wanted == m_debugTapSubscribed)
+            return;
+
+        m_debugTapSubscribed = wanted;
+        if (wanted)
+        {
+            m_detectionController->debugTap().subscribe();
+        }
+        else
+        {
+            m_detectionController->debugTap().unsubscribe();
+            m_debugFrames = DebugFrames(); // 釋放中間幀，下次開啟不顯示過期畫面
+        }
+    }
+
     void MainWindow::toggleFullscreenMode()
     {
         m_isFullscreenMode = !m_isFullscreenMode;
@@ -994,6 +1187,17 @@ namespace basler
             onResetCount();
         });
 
+        // F8：手動觸發事件錄影（保存前後數秒）
+        new QShortcut(Qt::Key_F8, this, [this]()
+        {
+            if (!m_eventRecorder->isRunning())
+            {
+                m_statusLabel->setText("事件錄影未啟用（設定 debug.eventRecordingEnabled）");
+                return;
+            }
+            m_eventRecorder->trigger(EventTrigger::Manual);
+        });
+
         // F9：分割顯示模式（左右並排兩個視角）
         new QShortcut(Qt::Key_F9, this, [this]()
         {
@@ -1018,7 +1222,7 @@ namespace basler
             m_statusLabel->setText("已取消編輯模式");
         });
 
-        qDebug() << "[MainWindow] 鍵盤快捷鍵已設定 (Space/←/→/Ctrl+R/F5/F9/F11/ESC)";
+        qDebug() << "[MainWindow] 鍵盤快捷鍵已設定 (Space/←/→/Ctrl+R/F5/F8/F9/F11/ESC)";
     }
 
     // ============================================================================
@@ -1028,52 +1232,51 @@ namespace basler
     void MainWindow::onDetectCameras()
     {
         m_statusLabel->setText("Detecting cameras (quick scan)...");
-        auto cameras = m_sourceManager->cameraController()->detectCameras();
-
-        if (cameras.isEmpty())
-        {
-            m_statusLabel->setText("No cameras found");
-            m_cameraControl->setCameraList({});
-        }
-        else
-        {
-            m_statusLabel->setText(QString("Found %1 camera(s)").arg(cameras.size()));
-            QStringList cameraNames;
-            for (const auto &cam : cameras)
-            {
-                cameraNames.append(QString("%1 (%2)").arg(cam.model).arg(cam.serial));
-            }
-            m_cameraControl->setCameraList(cameraNames);
-        }
+        detectCamerasAsync(1, 0);
     }
 
     void MainWindow::onDetectCamerasWithRetry()
     {
         m_statusLabel->setText("Auto-detecting cameras (smart scan with retry)...");
+        detectCamerasAsync(3, 2000);
+    }
 
-        // Run in background to avoid UI blocking
-        QThreadPool::globalInstance()->start([this]()
-                                             {
-            auto cameras = m_sourceManager->cameraController()->detectCamerasWithRetry(3, 2000);
+    void MainWindow::detectCamerasAsync(int maxRetries, int delayMs)
+    {
+        // 列舉在背景線程執行，結果以 camerasDetected 回到 UI 線程
+        CameraController *camera = m_sourceManager->cameraController();
+        connect(camera, &CameraController::camerasDetected,
+                this, &MainWindow::onCamerasDetected, Qt::UniqueConnection);
+        camera->detectCamerasAsync(maxRetries, delayMs);
+    }
 
-            // Update UI in main thread
-            QMetaObject::invokeMethod(this, [this, cameras]() {
-                if (cameras.isEmpty())
-                {
-                    m_statusLabel->setText("No cameras found after 3 attempts. Check connections and power.");
-                    m_cameraControl->setCameraList({});
-                }
-                else
-                {
-                    m_statusLabel->setText(QString("Successfully found %1 camera(s)").arg(cameras.size()));
-                    QStringList cameraNames;
-                    for (const auto &cam : cameras)
-                    {
-                        cameraNames.append(QString("%1 (%2)").arg(cam.model).arg(cam.serial));
-                    }
-                    m_cameraControl->setCameraList(cameraNames);
-                }
-            }, Qt::QueuedConnection); });
+    void MainWindow::updateSensorAoi()
+    {
+        CameraController *camera = m_sourceManager->cameraController();
+        if (!camera || !camera->isConnected())
+        {
+            return;
+        }
+        const QSize sensor = camera->sensorSize();
+        camera->setSensorAoi(m_detectionController->sensorRoi(sensor.width(), sensor.height()));
+    }
+
+    void MainWindow::onCamerasDetected(const QList<CameraInfo> &cameras)
+    {
+        if (cameras.isEmpty())
+        {
+            m_statusLabel->setText("No cameras found. Check connections and power.");
+            m_cameraControl->setCameraList({});
+            return;
+        }
+
+        m_statusLabel->setText(QString("Found %1 camera(s)").arg(cameras.size()));
+        QStringList cameraNames;
+        for (const auto &cam : cameras)
+        {
+            cameraNames.append(QString("%1 (%2)").arg(cam.model).arg(cam.serial));
+        }
+        m_cameraControl->setCameraList(cameraNames);
     }
 
     void MainWindow::onConnectCamera()
@@ -1102,8 +1305,17 @@ namespace basler
     {
         m_statusLabel->setText(QString("已連接: %1").arg(info.model));
         m_cameraControl->setConnected(true);
+        m_startupReconnect = false;
         qDebug() << "[MainWindow] 相機已連接:" << info.model;
 
+        // 快取序號與 IP：下次啟動直接重新連接，不必完整列舉
+        QSettings prefs("BaslerVision", "BaslerVisionSystem");
+        prefs.setValue("lastCameraSerial", info.serial);
+        prefs.setValue("lastCameraIp", info.ipAddress);
+
+        // 抓取前先依檢測 ROI 裁切感測器 AOI（尚未抓取，直接寫入相機）
+        updateSensorAoi();
+
         // 連接成功後自動開始抓取
         QTimer::singleShot(100, this, [this]()
                            { m_sourceManager->startGrabbing(); });
@@ -1120,6 +1332,7 @@ namespace basler
     {
         m_statusLabel->setText("抓取中");
         m_cameraControl->setGrabbing(true);
+        m_cameraMissedFrames = 0;
     }
 
     void MainWindow::onGrabbingStopped()
@@ -1130,6 +1343,15 @@ namespace basler
 
     void MainWindow::onCameraError(const QString &error)
     {
+        if (m_startupReconnect)
+        {
+            // 上次的相機不在（換機或未開機）：改為背景掃描，啟動時不彈窗
+            m_startupReconnect = false;
+            m_debugPanel->logError("相機：上次的相機無法連接（" + error + "），改為掃描");
+            m_statusLabel->setText("上次的相機無法連接，背景掃描相機中...");
+            detectCamerasAsync(3, 2000);
+            return;
+        }
         m_statusLabel->setText(QString("錯誤: %1").arg(error));
         m_debugPanel->logError("相機：" + error);
         QMessageBox::warning(this, "相機錯誤", error);
@@ -1139,45 +1361,57 @@ namespace basler
     // 幀處理
     // ============================================================================
 
-    void MainWindow::onFrameReady(const cv::Mat &frame)
+    void MainWindow::onFrameReady(quint64 sequence)
     {
         static int frameCount = 0;
         frameCount++;
         if (frameCount == 1 || frameCount % 100 == 0)
         {
             qDebug() << "[MainWindow::onFrameReady] 收到幀 #" << frameCount
-                     << ", 尺寸:" << frame.cols << "x" << frame.rows;
+                     << ", 序號:" << sequence;
         }
 
-        // 只更新幀數據，不在這裡做耗時處理
+        // 幀數據都在 FrameRing：檢測由 DetectionWorker 自行讀取，
+        // 顯示與錄影在 updateDisplay() 中以 UI 頻率讀取，這裡不做任何拷貝
+    }
+
+    void MainWindow::drainRecordingFrames()
+    {
+        if (!m_isRecording || m_recordingConsumerId < 0)
         {
-            QMutexLocker locker(&m_frameMutex);
-            m_latestFrame = frame.clone();
+            return;
         }
 
-        // 錄製（快速操作）
-        if (m_isRecording)
+        // 依序排入自上次以來的所有幀（錄影消費者落後過多時由 FrameRing 記錄丟幀）
+        // 編碼在錄影線程進行；enqueueFrame 交換緩衝，這裡只有 FrameRing 的一次複製
+        // meta 一併排入：原始擷取模式把區塊 ID / 相機時間戳 / 曝光寫進幀標頭
+        FrameRing *ring = m_sourceManager->frameRing();
+        FrameMeta meta;
+        // 燒入錄影：以最近的檢測結果疊加（在錄影線程繪製）
+        const bool burnIn = m_videoRecorder->isBurningIn() && m_isDetecting;
+        while (ring->read(m_recordingConsumerId, m_recordingFrame, meta))
         {
-            m_videoRecorder->writeFrame(frame);
+            if (burnIn)
+            {
+                m_videoRecorder->enqueueFrame(m_recordingFrame, meta, m_processedOverlay);
+            }
+            else
+            {
+                m_videoRecorder->enqueueFrame(m_recordingFrame, meta);
+            }
         }
-
-        // 注意：檢測處理已移到 updateDisplay() 中，與 UI 更新同步
     }
 
-    void MainWindow::processFrame(const cv::Mat &frame)
+    void MainWindow::applyDetectionResult(const DetectionResult &result)
     {
-        // 送入檢測控制器
-        std::vector<DetectedObject> detectedObjects;
-        cv::Mat processedFrame = m_detectionController->processFrame(frame, detectedObjects);
-
         // ===== StatusBar 即時更新 =====
         // 1. 即時偵測物件數
-        m_objectCountLabel->setText(QString("物件: %1").arg(static_cast<int>(detectedObjects.size())));
+        m_objectCountLabel->setText(QString("物件: %1").arg(static_cast<int>(result.objects.size())));
 
         // 2. ROI 尺寸
         const auto &det = Settings::instance().detection();
         if (det.roiEnabled)
-            m_roiLabel->setText(QString("ROI: %1×%2").arg(frame.cols).arg(det.roiHeight));
+            m_roiLabel->setText(QString("ROI: %1×%2").arg(result.frameWidth).arg(det.roiHeight));
         else
             m_roiLabel->setText("ROI: 關閉");
 
@@ -1202,11 +1436,13 @@ namespace basler
         }
 
         // 調試視圖：將二值化遮罩傳給 Debug Panel 顯示
-        if (m_debugPanel && m_debugPanel->isShowingDebugView())
+        if (m_debugTapSubscribed)
         {
-            cv::Mat debugFrame = m_detectionController->lastDebugFrame();
-            if (!debugFrame.empty())
-                m_debugPanel->updateDebugImage(debugFrame);
+            m_detectionController->debugTap().take(m_debugFrames);
+        }
+        if (m_debugPanel && m_debugPanel->isShowingDebugView() && !m_debugFrames.finalMask.empty())
+        {
+            m_debugPanel->updateDebugImage(m_debugFrames.finalMask);
         }
 
         // HUD 更新（全螢幕模式下疊加計數/FPS/光柵線）
@@ -1216,39 +1452,81 @@ namespace basler
             m_videoDisplay->updateHud(m_hudCount, m_hudFps, gateRatio);
         }
 
-        // 儲存處理後的幀用於顯示
+        // 儲存處理結果用於顯示（overlayAsData 時只有疊加資料，顯示幀直接取 FrameRing 最新幀）
         {
             QMutexLocker locker(&m_frameMutex);
-            m_processedFrame = processedFrame;
+            m_processedFrame = result.annotatedFrame;
+            m_processedOverlay = result.overlay;
         }
     }
 
     void MainWindow::onFpsUpdated(double fps)
     {
         m_hudFps = fps;
+        m_detectionWorker->setSourceFps(fps);
         m_fpsLabel->setText(QString("FPS: %1").arg(fps, 0, 'f', 1));
+
+        // 各消費者丟幀數（找出哪個階段跟不上）
+        FrameRing *ring = m_sourceManager->frameRing();
+        QString dropInfo = QString("丟幀 - 檢測: %1").arg(m_detectionWorker->droppedFrames());
+        if (m_recordingConsumerId >= 0)
+            dropInfo += QString("  錄影: %1").arg(ring->droppedFrames(m_recordingConsumerId));
+        if (m_cameraMissedFrames > 0)
+            dropInfo += QString("\n相機漏幀（區塊 ID 缺口）: %1").arg(m_cameraMissedFrames);
+        m_fpsLabel->setToolTip(dropInfo);
+    }
+
+    void MainWindow::onFramesMissed(quint64 missed, quint64 totalMissed)
+    {
+        m_cameraMissedFrames = totalMissed;
+
+        // 漏幀代表可能漏算零件，在狀態欄提示操作員
+        if (m_isDetecting)
+        {
+            m_statusLabel->setText(QString("⚠ 相機漏幀 %1（累計 %2），計數可能不準確")
+                                       .arg(missed).arg(totalMissed));
+        }
     }
 
     void MainWindow::updateDisplay()
     {
+        drainRecordingFrames();
+
         cv::Mat frame;
         cv::Mat processed;
+        FrameOverlay overlay;
         {
+            // 只在有新幀時從 FrameRing 複製（重用 m_latestFrame 緩衝）
             QMutexLocker locker(&m_frameMutex);
+            FrameMeta meta;
+            if (m_sourceManager->frameRing()->readLatest(m_latestFrame, meta, m_lastDisplayedSequence))
+            {
+                m_lastDisplayedSequence = meta.sequence;
+            }
             if (m_latestFrame.empty())
                 return;
-            frame = m_latestFrame.clone();
+            frame = m_latestFrame;
         }
 
-        // 如果正在檢測，在 UI 線程處理（60fps 頻率）
+        // 檢測在 DetectionWorker 線程以輸入幀率進行，這裡只取用最新結果
         if (m_isDetecting && !frame.empty())
         {
-            processFrame(frame);
+            DetectionResult result;
+            if (m_detectionWorker->takeLatestResult(result))
+            {
+                applyDetectionResult(result);
+            }
             QMutexLocker locker(&m_frameMutex);
             if (!m_processedFrame.empty())
             {
                 processed = m_processedFrame.clone();
             }
+            else if (!m_processedOverlay.isEmpty())
+            {
+                // 疊加資料模式：最新原始幀 + 疊加（由顯示組件繪製）
+                processed = frame;
+                overlay = m_processedOverlay;
+            }
         }
 
         // 根據調試模式選擇主畫面顯示幀
@@ -1265,10 +1543,10 @@ namespace basler
                 cv::Mat debugGray;
                 switch (m_debugViewMode)
                 {
-                    case 1: debugGray = m_detectionController->lastFgMask();    break;
-                    case 2: debugGray = m_detectionController->lastCannyEdges(); break;
-                    case 3: debugGray = m_detectionController->lastCombined();   break;
-                    case 4: debugGray = m_detectionController->lastDebugFrame(); break;
+                    case 1: debugGray = m_debugFrames.fgMask;     break;
+                    case 2: debugGray = m_debugFrames.cannyEdges; break;
+                    case 3: debugGray = m_debugFrames.combined;   break;
+                    case 4: debugGray = m_debugFrames.finalMask;  break;
                     default: break;
                 }
                 if (!debugGray.empty())
@@ -1288,6 +1566,9 @@ namespace basler
         {
             displayMat = frame;
         }
+        // 疊加只屬於最終結果畫面（調試中間幀為處理解析度的遮罩）
+        const bool showingResult = !displayMat.empty() && displayMat.data == processed.data;
+        m_videoDisplay->setOverlay(showingResult ? overlay : FrameOverlay());
         m_videoDisplay->displayFrame(displayMat);
 
         // 分割視圖第二面板（非全螢幕時才更新）
@@ -1302,6 +1583,8 @@ namespace basler
                 splitMat = processed;                       // 互補：最終檢測結果
             else
                 splitMat = frame;
+            const bool splitResult = m_debugViewMode != 0 && splitMat.data == processed.data;
+            m_videoDisplay2->setOverlay(splitResult ? overlay : FrameOverlay());
             m_videoDisplay2->displayFrame(splitMat);
         }
 
@@ -1331,17 +1614,19 @@ namespace basler
         QString filename = QString("recording_%1")
                                .arg(QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss"));
 
-        // 獲取幀尺寸（使用默認值或從最新幀獲取）
+        // 獲取幀尺寸與通道數（使用默認值或從最新幀獲取）；單通道來源直接以灰階編碼
         QSize frameSize(640, 480);
+        bool isColor = true;
         {
             QMutexLocker locker(&m_frameMutex);
             if (!m_latestFrame.empty())
             {
                 frameSize = QSize(m_latestFrame.cols, m_latestFrame.rows);
+                isColor = m_latestFrame.channels() != 1;
             }
         }
 
-        m_videoRecorder->startRecording(frameSize, 30.0, filename);
+        m_videoRecorder->startRecording(frameSize, 30.0, filename, isColor);
     }
 
     void MainWindow::onStopRecording()
@@ -1351,6 +1636,7 @@ namespace basler
 
     void MainWindow::onRecordingStarted()
     {
+        m_recordingConsumerId = m_sourceManager->frameRing()->registerConsumer("recording");
         m_isRecording = true;
         m_recordingLabel->setText("🔴 錄製中");
         m_recordingLabel->setStyleSheet(
@@ -1361,7 +1647,13 @@ namespace basler
     void MainWindow::onRecordingStopped()
     {
         m_isRecording = false;
+        if (m_recordingConsumerId >= 0)
+        {
+            m_sourceManager->frameRing()->unregisterConsumer(m_recordingConsumerId);
+            m_recordingConsumerId = -1;
+        }
         m_recordingLabel->setText("");
+        m_recordingLabel->setToolTip("");
         m_recordingControl->setRecording(false);
     }
 
@@ -1539,6 +1831,12 @@ namespace basler
         int actual  = m_detectionController->count();
         exportPackagingReport(target, actual, elapsedSec);
 
+        if (actual != target && Settings::instance().debug().triggerOnPackagingMismatch)
+        {
+            m_eventRecorder->trigger(EventTrigger::PackagingMismatch,
+                                     QString("計數 %1 / 目標 %2").arg(actual).arg(target));
+        }
+
         qDebug() << "[MainWindow] 包裝完成！計數:" << actual << "耗時:" << elapsedSec << "s";
     }
 
@@ -1600,6 +1898,42 @@ namespace basler
         qDebug() << "[MainWindow] 導出報告:" << filePath;
     }
 
+    void MainWindow::exportStageLatency()
+    {
+        QString reportsDir = QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation)
+                             + "/BaslerReports";
+        QDir().mkpath(reportsDir);
+        QString filePath = QString("%1/latency_%2.csv")
+                               .arg(reportsDir, QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss"));
+
+        QFile file(filePath);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+        {
+            m_statusLabel->setText("⚠ 無法寫入延遲統計: " + filePath);
+            return;
+        }
+
+        QTextStream out(&file);
+        out.setEncoding(QStringConverter::Utf8);
+        out << "stage,samples,mean_us,p50_us,p95_us,p99_us,max_us\n";
+        for (int s = 0; s < PIPELINE_STAGE_COUNT; ++s)
+        {
+            const auto &hist = m_latencyTotal.stages[s];
+            out << pipelineStageName(static_cast<PipelineStage>(s)) << ","
+                << hist.count << ","
+                << QString::number(hist.meanUs(), 'f', 1) << ","
+                << QString::number(hist.percentileUs(0.50), 'f', 1) << ","
+                << QString::number(hist.percentileUs(0.95), 'f', 1) << ","
+                << QString::number(hist.percentileUs(0.99), 'f', 1) << ","
+                << QString::number(hist.maxUs(), 'f', 1) << "\n";
+        }
+
+        m_statusLabel->setText(QString("📄 延遲統計已儲存（%1 秒）: %2")
+                                   .arg(m_latencyTotal.windowMs / 1000.0, 0, 'f', 0)
+                                   .arg(filePath));
+        qDebug() << "[MainWindow] 導出延遲統計:" << filePath;
+    }
+
     void MainWindow::onDefectStatsUpdated(double passRate, int passCount, int failCount)
     {
         m_packagingControl->updateDefectStats(passRate, passCount, failCount);
@@ -1619,10 +1953,19 @@ namespace basler
         m_detectionController->setRoiX(x);
         m_detectionController->setRoiWidth(width);
         m_detectionController->setRoiHeight(height);
+        updateSensorAoi();
     }
 
     void MainWindow::onRoiSelectedFromDrag(int x, int y, int w, int h)
     {
+        // 畫面顯示的是相機 AOI：框選座標加上 AOI 原點，換回以完整感測器為基準的 ROI
+        CameraController *camera = m_sourceManager->cameraController();
+        if (camera && camera->isConnected() && m_sourceManager->sourceType() == SourceType::Camera)
+        {
+            x += camera->sensorAoi().x();
+            y += camera->sensorAoi().y();
+        }
+
         // 更新 Settings
         auto &config = Settings::instance().detection();
         config.roiX      = x;
@@ -1634,6 +1977,7 @@ namespace basler
         m_detectionController->setRoiX(x);
         m_detectionController->setRoiWidth(w);
         m_detectionController->setRoiHeight(h);
+        updateSensorAoi();
 
         // 同步 Debug Panel SpinBox（靜默，不重複觸發信號）
         m_debugPanel->setRoiValues(x, y, w, h);
@@ -1671,7 +2015,7 @@ namespace basler
             this,
             "選擇影片檔案",
             defaultDir,
-            "影片檔案 (*.mp4 *.avi *.mov *.mkv);;所有檔案 (*.*)",
+            "影片檔案 (*.mp4 *.avi *.mov *.mkv);;原始擷取 (index.bin);;合成落料序列 (*.synth.json);;所有檔案 (*.*)",
             nullptr,
             QFileDialog::DontUseNativeDialog);
 
@@ -1750,15 +2094,29 @@ namespace basler
         if (filePath.isEmpty())
             return;
 
-        bool success = m_detectionController->loadYoloModel(filePath);
+        // 背景載入並暖機，結果由 onYoloModelLoaded 顯示
+        m_userYoloLoad = true;
+        m_statusLabel->setText(QString("YOLO 模型載入中: %1").arg(QFileInfo(filePath).fileName()));
+        m_detectionController->loadYoloModelAsync(filePath);
+    }
+
+    void MainWindow::onYoloModelLoaded(bool success)
+    {
+        const QString modelName = QFileInfo(Settings::instance().yolo().modelPath).fileName();
         if (success)
         {
-            m_statusLabel->setText(QString("YOLO 模型已載入: %1").arg(QFileInfo(filePath).fileName()));
+            m_statusLabel->setText(QString("YOLO 模型已載入: %1").arg(modelName));
         }
-        else
+        else if (m_userYoloLoad)
         {
             QMessageBox::warning(this, "載入失敗", "無法載入 YOLO ONNX 模型");
         }
+        else
+        {
+            m_statusLabel->setText("YOLO 模型載入失敗，使用傳統檢測");
+            m_debugPanel->logError("YOLO：配置中的模型無法載入");
+        }
+        m_userYoloLoad = false;
     }
 
 } // namespace basler
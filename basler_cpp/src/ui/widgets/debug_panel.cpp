@@ -1078,6 +1078,13 @@ void DebugPanelWidget::onYoloRoiUpscaleChanged(double value)
     emit yoloRoiUpscaleChanged(value);
 }
 
+void DebugPanelWidget::showYoloModelLoading(const QString& modelPath)
+{
+    m_yoloStatusLabel->setText(tr("模型: 載入中..."));
+    m_yoloStatusLabel->setToolTip(modelPath);
+    m_yoloStatusLabel->setStyleSheet("color: #ffaa00;");
+}
+
 void DebugPanelWidget::updateYoloModelStatus(bool loaded)
 {
     if (loaded)
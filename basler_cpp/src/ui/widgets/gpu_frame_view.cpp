@@ -0,0 +1,398 @@
+#include "ui/widgets/gpu_frame_view.h"
+#include <QOpenGLContext>
+#include <QSurfaceFormat>
+#include <QPainter>
+#include <QVector2D>
+#include <QVector4D>
+#include <QDebug>
+#include <iterator>
+
+namespace basler {
+
+namespace {
+
+// 影像四邊形：a_uv ∈ [0,1]²，乘上影像尺寸得到影像座標，再由 u_map 映射到 NDC
+const char* kImageVertex = R"(
+in vec2 a_uv;
+uniform vec4 u_map;
+uniform vec2 u_size;
+out vec2 v_uv;
+void main() {
+    v_uv = a_uv;
+    gl_Position = vec4(a_uv * u_size * u_map.xy + u_map.zw, 0.0, 1.0);
+}
+)";
+
+// 通道順序已由紋理 swizzle 處理（mono → rrr1，BGR → bgr1）
+const char* kImageFragment = R"(
+in vec2 v_uv;
+uniform sampler2D u_texture;
+out vec4 fragColor;
+void main() {
+    fragColor = vec4(texture(u_texture, v_uv).rgb, 1.0);
+}
+)";
+
+const char* kLineVertex = R"(
+in vec2 a_pos;
+uniform vec4 u_map;
+void main() {
+    gl_Position = vec4(a_pos * u_map.xy + u_map.zw, 0.0, 1.0);
+}
+)";
+
+const char* kLineFragment = R"(
+uniform vec4 u_color;
+out vec4 fragColor;
+void main() {
+    fragColor = u_color;
+}
+)";
+
+// 與 DetectionController::drawDetectionResults 的燒入顏色一致
+const QVector4D kRoiColor(0.0f, 1.0f, 1.0f, 1.0f);  // 青色
+const QVector4D kGateColor(1.0f, 0.0f, 0.0f, 1.0f); // 紅色
+const QVector4D kBoxColor(0.0f, 1.0f, 0.0f, 1.0f);  // 綠色：未穿越
+const QVector4D kCrossedColor(1.0f, 1.0f, 0.0f, 1.0f); // 黃色：已穿越
+
+void appendRect(std::vector<float>& v, const QRect& r)
+{
+    const float x0 = static_cast<float>(r.left());
+    const float y0 = static_cast<float>(r.top());
+    const float x1 = static_cast<float>(r.left() + r.width());
+    const float y1 = static_cast<float>(r.top() + r.height());
+    const float lines[] = {x0, y0, x1, y0,  x1, y0, x1, y1,  x1, y1, x0, y1,  x0, y1, x0, y0};
+    v.insert(v.end(), std::begin(lines), std::end(lines));
+}
+
+} // namespace
+
+GpuFrameView::GpuFrameView(QWidget* parent)
+    : QOpenGLWidget(parent)
+{
+    // 桌面 GL 需明確要求 3.3 core（macOS 預設只給 2.1 legacy）；ES 平台沿用預設格式
+    if (QOpenGLContext::openGLModuleType() == QOpenGLContext::LibGL) {
+        QSurfaceFormat fmt = format();
+        fmt.setVersion(3, 3);
+        fmt.setProfile(QSurfaceFormat::CoreProfile);
+        setFormat(fmt);
+    }
+
+    setAttribute(Qt::WA_TransparentForMouseEvents);
+}
+
+GpuFrameView::~GpuFrameView()
+{
+    if (!isValid()) {
+        return;
+    }
+
+    makeCurrent();
+    if (m_texture) {
+        glDeleteTextures(1, &m_texture);
+    }
+    m_imageVbo.destroy();
+    m_imageVao.destroy();
+    m_lineVbo.destroy();
+    m_lineVao.destroy();
+    m_imageProgram.reset();
+    m_lineProgram.reset();
+    doneCurrent();
+}
+
+void GpuFrameView::setFrame(const cv::Mat& frame)
+{
+    if (frame.empty() || frame.depth() != CV_8U ||
+        (frame.channels() != 1 && frame.channels() != 3 && frame.channels() != 4)) {
+        return;
+    }
+
+    // 複製到自有緩衝（尺寸不變時重用）：呼叫端的 Mat 可能之後被原地覆寫
+    frame.copyTo(m_pending);
+    m_frameDirty = true;
+    update();
+}
+
+void GpuFrameView::clearFrame()
+{
+    m_pending.release();
+    m_frameDirty = true;
+    update();
+}
+
+void GpuFrameView::setOverlay(const FrameOverlay& overlay)
+{
+    m_overlay = overlay;
+    m_overlayDirty = true;
+    update();
+}
+
+void GpuFrameView::setDisplayRect(const QRect& rect)
+{
+    if (m_displayRect != rect) {
+        m_displayRect = rect;
+        update();
+    }
+}
+
+void GpuFrameView::fail(const QString& reason)
+{
+    m_failed = true;
+    qWarning() << "[GpuFrameView] GPU 顯示不可用:" << reason;
+    emit unavailable(reason);
+}
+
+void GpuFrameView::initializeGL()
+{
+    initializeOpenGLFunctions();
+
+    const QSurfaceFormat fmt = context()->format();
+    m_isGles = context()->isOpenGLES();
+    if (fmt.majorVersion() < 3 || (!m_isGles && fmt.majorVersion() == 3 && fmt.minorVersion() < 3)) {
+        fail(QString("OpenGL%1 %2.%3 低於需求")
+                 .arg(m_isGles ? " ES" : "")
+                 .arg(fmt.majorVersion())
+                 .arg(fmt.minorVersion()));
+        return;
+    }
+
+    if (!buildPrograms()) {
+        return;
+    }
+
+    // 影像四邊形（triangle strip，單位正方形）
+    const float quad[] = {0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f};
+    m_imageVao.create();
+    {
+        QOpenGLVertexArrayObject::Binder binder(&m_imageVao);
+        m_imageVbo.create();
+        m_imageVbo.bind();
+        m_imageVbo.allocate(quad, sizeof(quad));
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), nullptr);
+        m_imageVbo.release();
+    }
+
+    m_lineVao.create();
+    {
+        QOpenGLVertexArrayObject::Binder binder(&m_lineVao);
+        m_lineVbo.create();
+        m_lineVbo.setUsagePattern(QOpenGLBuffer::DynamicDraw);
+        m_lineVbo.bind();
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), nullptr);
+        m_lineVbo.release();
+    }
+
+    glGenTextures(1, &m_texture);
+    glBindTexture(GL_TEXTURE_2D, m_texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    // 重新建立上下文時（例如換螢幕）需重新上傳
+    m_texWidth = m_texHeight = m_texChannels = 0;
+    m_frameDirty = !m_pending.empty();
+    m_overlayDirty = true;
+
+    qDebug() << "[GpuFrameView] 初始化完成:" << reinterpret_cast<const char*>(glGetString(GL_VERSION));
+}
+
+bool GpuFrameView::buildPrograms()
+{
+    const QByteArray header = m_isGles
+        ? QByteArrayLiteral("#version 300 es\nprecision mediump float;\n")
+        : QByteArrayLiteral("#version 330 core\n");
+
+    auto build = [&](const char* vertex, const char* fragment, const char* attribute)
+        -> std::unique_ptr<QOpenGLShaderProgram> {
+        auto program = std::make_unique<QOpenGLShaderProgram>();
+        if (!program->addShaderFromSourceCode(QOpenGLShader::Vertex, header + vertex) ||
+            !program->addShaderFromSourceCode(QOpenGLShader::Fragment, header + fragment)) {
+            fail(program->log());
+            return nullptr;
+        }
+        program->bindAttributeLocation(attribute, 0);
+        if (!program->link()) {
+            fail(program->log());
+            return nullptr;
+        }
+        return program;
+    };
+
+    m_imageProgram = build(kImageVertex, kImageFragment, "a_uv");
+    if (!m_imageProgram) {
+        return false;
+    }
+    m_lineProgram = build(kLineVertex, kLineFragment, "a_pos");
+    return m_lineProgram != nullptr;
+}
+
+void GpuFrameView::uploadPendingFrame()
+{
+    if (!m_frameDirty) {
+        return;
+    }
+    m_frameDirty = false;
+
+    if (m_pending.empty()) {
+        m_texWidth = m_texHeight = m_texChannels = 0;
+        return;
+    }
+
+    const int channels = m_pending.channels();
+    GLenum internalFormat = GL_R8;
+    GLenum format = GL_RED;
+    GLint swizzle[4] = {GL_RED, GL_RED, GL_RED, GL_ONE};
+    if (channels == 3) {
+        internalFormat = GL_RGB8;
+        format = GL_RGB;
+        swizzle[0] = GL_BLUE; swizzle[1] = GL_GREEN; swizzle[2] = GL_RED;
+    } else if (channels == 4) {
+        internalFormat = GL_RGBA8;
+        format = GL_RGBA;
+        swizzle[0] = GL_BLUE; swizzle[1] = GL_GREEN; swizzle[2] = GL_RED;
+    }
+
+    glBindTexture(GL_TEXTURE_2D, m_texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, static_cast<GLint>(m_pending.step / m_pending.elemSize()));
+
+    if (m_pending.cols != m_texWidth || m_pending.rows != m_texHeight || channels != m_texChannels) {
+        glTexImage2D(GL_TEXTURE_2D, 0, static_cast<GLint>(internalFormat),
+                     m_pending.cols, m_pending.rows, 0, format, GL_UNSIGNED_BYTE, m_pending.data);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_R, swizzle[0]);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_G, swizzle[1]);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_B, swizzle[2]);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_A, swizzle[3]);
+        m_texWidth = m_pending.cols;
+        m_texHeight = m_pending.rows;
+        m_texChannels = channels;
+    } else {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, m_pending.cols, m_pending.rows,
+                        format, GL_UNSIGNED_BYTE, m_pending.data);
+    }
+
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void GpuFrameView::rebuildOverlayVertices()
+{
+    m_overlayDirty = false;
+    m_lineVertices.clear();
+
+    if (!m_overlay.roi.isEmpty()) {
+        appendRect(m_lineVertices, m_overlay.roi);
+    }
+    for (const auto& lane : m_overlay.lanes) {
+        appendRect(m_lineVertices, lane.roi);
+    }
+    m_roiVertexCount = static_cast<int>(m_lineVertices.size() / 2);
+
+    if (m_overlay.showGateLine) {
+        // 光柵線橫跨整幀
+        const float x1 = static_cast<float>(m_overlay.frameWidth > 0 ? m_overlay.frameWidth : m_texWidth);
+        const float y = static_cast<float>(m_overlay.gateLineY);
+        m_lineVertices.insert(m_lineVertices.end(), {0.0f, y, x1, y});
+    }
+    for (const auto& lane : m_overlay.lanes) {
+        // 料道光柵線只橫跨該料道
+        if (lane.gateLineY > 0) {
+            const float y = static_cast<float>(lane.gateLineY);
+            m_lineVertices.insert(m_lineVertices.end(),
+                                  {static_cast<float>(lane.roi.left()), y,
+                                   static_cast<float>(lane.roi.left() + lane.roi.width()), y});
+        }
+    }
+    m_gateVertexCount = static_cast<int>(m_lineVertices.size() / 2) - m_roiVertexCount;
+
+    // 依顏色分兩段：未穿越在前、已穿越在後
+    for (const auto& box : m_overlay.boxes) {
+        if (!box.crossed) {
+            appendRect(m_lineVertices, box.rect);
+        }
+    }
+    m_boxVertexCount = static_cast<int>(m_lineVertices.size() / 2) - m_roiVertexCount - m_gateVertexCount;
+    for (const auto& box : m_overlay.boxes) {
+        if (box.crossed) {
+            appendRect(m_lineVertices, box.rect);
+        }
+    }
+    m_crossedVertexCount = static_cast<int>(m_lineVertices.size() / 2)
+                         - m_roiVertexCount - m_gateVertexCount - m_boxVertexCount;
+
+    if (!m_lineVertices.empty()) {
+        m_lineVbo.bind();
+        m_lineVbo.allocate(m_lineVertices.data(), static_cast<int>(m_lineVertices.size() * sizeof(float)));
+        m_lineVbo.release();
+    }
+}
+
+void GpuFrameView::paintGL()
+{
+    if (m_failed) {
+        return;
+    }
+
+    const qreal dpr = devicePixelRatioF();
+    glViewport(0, 0, static_cast<GLsizei>(width() * dpr), static_cast<GLsizei>(height() * dpr));
+    glClearColor(26.0f / 255.0f, 26.0f / 255.0f, 26.0f / 255.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    uploadPendingFrame();
+
+    if (m_texWidth > 0 && m_texHeight > 0 && !m_displayRect.isEmpty() && width() > 0 && height() > 0) {
+        // 影像座標 → NDC：ndc = p * (sx, sy) + (ox, oy)
+        const float w = static_cast<float>(width());
+        const float h = static_cast<float>(height());
+        const QVector4D map(2.0f * m_displayRect.width() / (m_texWidth * w),
+                            -2.0f * m_displayRect.height() / (m_texHeight * h),
+                            2.0f * m_displayRect.x() / w - 1.0f,
+                            1.0f - 2.0f * m_displayRect.y() / h);
+
+        m_imageProgram->bind();
+        m_imageProgram->setUniformValue("u_map", map);
+        m_imageProgram->setUniformValue("u_size", QVector2D(static_cast<float>(m_texWidth),
+                                                            static_cast<float>(m_texHeight)));
+        m_imageProgram->setUniformValue("u_texture", 0);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, m_texture);
+        {
+            QOpenGLVertexArrayObject::Binder binder(&m_imageVao);
+            glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+        }
+        glBindTexture(GL_TEXTURE_2D, 0);
+        m_imageProgram->release();
+
+        if (m_overlayDirty) {
+            rebuildOverlayVertices();
+        }
+        if (!m_lineVertices.empty()) {
+            m_lineProgram->bind();
+            m_lineProgram->setUniformValue("u_map", map);
+            QOpenGLVertexArrayObject::Binder binder(&m_lineVao);
+            auto drawRange = [&](const QVector4D& color, int first, int count) {
+                if (count > 0) {
+                    m_lineProgram->setUniformValue("u_color", color);
+                    glDrawArrays(GL_LINES, first, count);
+                }
+            };
+            drawRange(kRoiColor, 0, m_roiVertexCount);
+            drawRange(kGateColor, m_roiVertexCount, m_gateVertexCount);
+            drawRange(kBoxColor, m_roiVertexCount + m_gateVertexCount, m_boxVertexCount);
+            drawRange(kCrossedColor, m_roiVertexCount + m_gateVertexCount + m_boxVertexCount, m_crossedVertexCount);
+            m_lineProgram->release();
+        }
+    }
+
+    if (m_overlayPainter) {
+        QPainter painter(this);
+        painter.setRenderHint(QPainter::Antialiasing);
+        m_overlayPainter(painter);
+    }
+}
+
+} // namespace basler
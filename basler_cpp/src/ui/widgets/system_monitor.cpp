@@ -1,6 +1,8 @@
 #include "ui/widgets/system_monitor.h"
 #include <QVBoxLayout>
+#include <QFont>
 #include <QProcess>
+#include <algorithm>
 
 #ifdef Q_OS_MAC
 #include <mach/mach.h>
@@ -67,6 +69,20 @@ namespace basler
         memLayout->addWidget(m_memBar);
         groupLayout->addLayout(memLayout);
 
+        // 本程序逐線程 CPU 與記憶體
+        m_threadLabel = new QLabel(tr("線程 CPU：等待資料"));
+        m_threadLabel->setTextFormat(Qt::PlainText);
+        m_threadLabel->setFont(QFont("Monospace", 8));
+        m_threadLabel->setWordWrap(false);
+        groupLayout->addWidget(m_threadLabel);
+
+        // 檢測管線逐階段延遲
+        m_latencyLabel = new QLabel(tr("檢測延遲：等待資料"));
+        m_latencyLabel->setTextFormat(Qt::PlainText);
+        m_latencyLabel->setFont(QFont("Monospace", 8));
+        m_latencyLabel->setWordWrap(false);
+        groupLayout->addWidget(m_latencyLabel);
+
         m_groupBox->setLayout(groupLayout);
         mainLayout->addWidget(m_groupBox);
         mainLayout->addStretch();
@@ -92,6 +108,33 @@ namespace basler
         m_updateTimer->stop();
     }
 
+    void SystemMonitorWidget::setStageLatency(const StageLatencySnapshot &snapshot)
+    {
+        const double windowSec = snapshot.windowMs / 1000.0;
+        const auto &total = snapshot[PipelineStage::Total];
+        QString text = QString("%1 幀 / %2 s       p50    p95    p99    max (µs)\n")
+                           .arg(total.count)
+                           .arg(windowSec, 0, 'f', 1);
+
+        // 只列出本窗口有樣本的階段（依管線順序，total 最後）
+        for (int s = 0; s < PIPELINE_STAGE_COUNT; ++s)
+        {
+            const auto &hist = snapshot.stages[s];
+            if (hist.count == 0)
+            {
+                continue;
+            }
+            text += QString("%1%2 %3 %4 %5\n")
+                        .arg(QString(pipelineStageName(static_cast<PipelineStage>(s))), -16)
+                        .arg(hist.percentileUs(0.50), 6, 'f', 0)
+                        .arg(hist.percentileUs(0.95), 6, 'f', 0)
+                        .arg(hist.percentileUs(0.99), 6, 'f', 0)
+                        .arg(hist.maxUs(), 6, 'f', 0);
+        }
+        text.chop(1);
+        m_latencyLabel->setText(text);
+    }
+
     void SystemMonitorWidget::updateStats()
     {
         double cpu = getCpuUsage();
@@ -111,6 +154,51 @@ namespace basler
         QString memStyle = (mem > 80) ? "QProgressBar::chunk { background-color: #ff4444; }" : (mem > 50) ? "QProgressBar::chunk { background-color: #ffaa00; }"
                                                                                                           : "QProgressBar::chunk { background-color: #00aa00; }";
         m_memBar->setStyleSheet(memStyle);
+
+        updateThreadStats();
+    }
+
+    void SystemMonitorWidget::updateThreadStats()
+    {
+        const ProcessUsageSample sample = m_threadSampler.sample();
+        if (sample.intervalSec <= 0.0)
+        {
+            return; // 第一次取樣只建立基準
+        }
+
+        // 百分比以單一核心為 100%（與 top -H 相同），程序合計可超過 100%
+        QString text = QString("程序 CPU %1%   RSS %2 MB (%3 MB/s)   缺頁 %4/s\n")
+                           .arg(sample.processCpuPercent, 0, 'f', 1)
+                           .arg(sample.residentMb, 0, 'f', 1)
+                           .arg(sample.residentMbPerSec, 0, 'f', 2)
+                           .arg(sample.pageFaultsPerSec, 0, 'f', 0);
+        text += QString("%1%2 %3\n").arg(QString("線程"), -16).arg(QString("tid"), 8).arg(QString("CPU%"), 6);
+
+        const int listed = std::min<int>(MAX_LISTED_THREADS, static_cast<int>(sample.threads.size()));
+        double otherPercent = 0.0;
+        for (int i = 0; i < static_cast<int>(sample.threads.size()); ++i)
+        {
+            const ThreadCpuUsage &thread = sample.threads[i];
+            if (i >= listed)
+            {
+                otherPercent += thread.cpuPercent;
+                continue;
+            }
+            const QString name = thread.name.empty() ? QString("?") : QString::fromStdString(thread.name);
+            text += QString("%1%2 %3\n")
+                        .arg(name.left(15), -16)
+                        .arg(static_cast<qulonglong>(thread.id), 8)
+                        .arg(thread.cpuPercent, 6, 'f', 1);
+        }
+        if (listed < static_cast<int>(sample.threads.size()))
+        {
+            text += QString("%1%2 %3\n")
+                        .arg(QString("（其餘 %1 個）").arg(static_cast<int>(sample.threads.size()) - listed), -16)
+                        .arg(QString(), 8)
+                        .arg(otherPercent, 6, 'f', 1);
+        }
+        text.chop(1);
+        m_threadLabel->setText(text);
     }
 
     double SystemMonitorWidget::getCpuUsage()
@@ -1,7 +1,12 @@
 #include "ui/widgets/video_display.h"
+#include "config/settings.h"
+#ifdef HAVE_GPU_DISPLAY
+#include "ui/widgets/gpu_frame_view.h"
+#endif
 #include <QPainter>
 #include <QResizeEvent>
 #include <QMouseEvent>
+#include <QDebug>
 #include <algorithm>
 #include <opencv2/imgproc.hpp>
 
@@ -15,6 +20,53 @@ VideoDisplayWidget::VideoDisplayWidget(QWidget* parent)
     setStyleSheet("background-color: #1a1a1a;");
 
     m_message = tr("等待視頻輸入...");
+
+    if (Settings::instance().ui().gpuDisplay) {
+        enableGpuView();
+    }
+}
+
+void VideoDisplayWidget::enableGpuView()
+{
+#ifdef HAVE_GPU_DISPLAY
+    m_gpuView = new GpuFrameView(this);
+    m_gpuView->setGeometry(rect());
+    m_gpuView->setOverlayPainter([this](QPainter& painter) { paintOverlays(painter); });
+    // 初始化在第一次顯示時進行，失敗則於事件迴圈中改回 CPU 路徑
+    connect(m_gpuView, &GpuFrameView::unavailable,
+            this, &VideoDisplayWidget::disableGpuView, Qt::QueuedConnection);
+#endif
+}
+
+void VideoDisplayWidget::disableGpuView(const QString& reason)
+{
+    if (!m_gpuView) {
+        return;
+    }
+
+    qWarning() << "[VideoDisplayWidget] 改用 CPU 繪製:" << reason;
+#ifdef HAVE_GPU_DISPLAY
+    m_gpuView->hide();
+    m_gpuView->deleteLater();
+#endif
+    m_gpuView = nullptr;
+
+    // GPU 路徑未保留 QImage，等下一幀再顯示
+    QMutexLocker locker(&m_mutex);
+    m_imageSize = QSize();
+    m_displayRect = QRect();
+    update();
+}
+
+void VideoDisplayWidget::requestRepaint()
+{
+#ifdef HAVE_GPU_DISPLAY
+    if (m_gpuView) {
+        m_gpuView->update();
+        return;
+    }
+#endif
+    update();
 }
 
 void VideoDisplayWidget::updateFrame(const cv::Mat& frame)
@@ -24,21 +76,31 @@ void VideoDisplayWidget::updateFrame(const cv::Mat& frame)
     }
 
     QMutexLocker locker(&m_mutex);
+    m_message.clear();
+
+#ifdef HAVE_GPU_DISPLAY
+    if (m_gpuView) {
+        // GPU 路徑：原樣上傳，不轉換 / 不縮放
+        m_gpuView->setFrame(frame);
+        const QSize frameSize(frame.cols, frame.rows);
+        if (frameSize != m_imageSize) {
+            m_imageSize = frameSize;
+            updateDisplayRect();
+        }
+        return;
+    }
+#endif
+
     m_currentImage = matToQImage(frame);
     m_imageSize = m_currentImage.size();
-    m_message.clear();
 
-    updateScaledImage();
+    updateDisplayRect();
     update();  // 觸發重繪
 }
 
 void VideoDisplayWidget::clear()
 {
-    QMutexLocker locker(&m_mutex);
-    m_currentImage = QImage();
-    m_scaledImage = QImage();
-    m_message = tr("等待視頻輸入...");
-    update();
+    showMessage(tr("等待視頻輸入..."));
 }
 
 void VideoDisplayWidget::showMessage(const QString& message)
@@ -47,6 +109,27 @@ void VideoDisplayWidget::showMessage(const QString& message)
     m_message = message;
     m_currentImage = QImage();
     m_scaledImage = QImage();
+    m_imageSize = QSize();
+    m_displayRect = QRect();
+#ifdef HAVE_GPU_DISPLAY
+    if (m_gpuView) {
+        m_gpuView->clearFrame();
+        m_gpuView->setDisplayRect(m_displayRect);
+        return;
+    }
+#endif
+    update();
+}
+
+void VideoDisplayWidget::setOverlay(const FrameOverlay& overlay)
+{
+    m_overlay = overlay;
+#ifdef HAVE_GPU_DISPLAY
+    if (m_gpuView) {
+        m_gpuView->setOverlay(overlay);
+        return;
+    }
+#endif
     update();
 }
 
@@ -84,9 +167,10 @@ QImage VideoDisplayWidget::matToQImage(const cv::Mat& mat)
     }
 }
 
-void VideoDisplayWidget::updateScaledImage()
+void VideoDisplayWidget::updateDisplayRect()
 {
-    if (m_currentImage.isNull()) {
+    if (m_imageSize.isEmpty()) {
+        m_displayRect = QRect();
         m_scaledImage = QImage();
         return;
     }
@@ -104,41 +188,160 @@ void VideoDisplayWidget::updateScaledImage()
             break;
     }
 
-    m_scaledImage = m_currentImage.scaled(
-        size(), aspectMode, Qt::SmoothTransformation
-    );
+    const QSize scaled = m_imageSize.scaled(size(), aspectMode);
+    m_displayRect = QRect(QPoint((width() - scaled.width()) / 2, (height() - scaled.height()) / 2), scaled);
+
+#ifdef HAVE_GPU_DISPLAY
+    if (m_gpuView) {
+        m_gpuView->setDisplayRect(m_displayRect);  // 縮放交給紋理取樣
+        return;
+    }
+#endif
+
+    m_scaledImage = m_currentImage.scaled(scaled, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
 }
 
 void VideoDisplayWidget::paintEvent(QPaintEvent* event)
 {
     Q_UNUSED(event);
+    if (m_gpuView) {
+        return;  // GpuFrameView 覆蓋整個組件，overlay 由其 paintGL 回呼 paintOverlays()
+    }
+
     QPainter painter(this);
     painter.setRenderHint(QPainter::Antialiasing);
 
     // 填充背景
     painter.fillRect(rect(), QColor(26, 26, 26));
 
-    int scaledW = 0, scaledH = 0, origW = 0, origH = 0;
-    QPoint imageOffset;
-
     {
         QMutexLocker locker(&m_mutex);
-
         if (!m_scaledImage.isNull()) {
-            // 計算居中位置
-            imageOffset.setX((width() - m_scaledImage.width()) / 2);
-            imageOffset.setY((height() - m_scaledImage.height()) / 2);
-            scaledW = m_scaledImage.width();
-            scaledH = m_scaledImage.height();
-            origW = m_currentImage.width();
-            origH = m_currentImage.height();
-            painter.drawImage(imageOffset, m_scaledImage);
-        } else if (!m_message.isEmpty()) {
+            painter.drawImage(m_displayRect.topLeft(), m_scaledImage);
+        }
+    } // mutex 在此釋放，之後繪製 overlay 不持鎖
+
+    paintFrameOverlay(painter);
+    paintOverlays(painter);
+}
+
+void VideoDisplayWidget::paintFrameOverlay(QPainter& painter)
+{
+    if (m_overlay.isEmpty() || m_displayRect.isEmpty() || m_imageSize.isEmpty()) {
+        return;
+    }
+
+    const double sx = static_cast<double>(m_displayRect.width()) / m_imageSize.width();
+    const double sy = static_cast<double>(m_displayRect.height()) / m_imageSize.height();
+    auto toWidget = [&](const QRect& r) {
+        return QRectF(m_displayRect.x() + r.x() * sx, m_displayRect.y() + r.y() * sy,
+                      r.width() * sx, r.height() * sy);
+    };
+
+    // 顏色與 DetectionController::drawDetectionResults 的燒入顏色一致
+    painter.setBrush(Qt::NoBrush);
+    if (!m_overlay.roi.isEmpty()) {
+        painter.setPen(QPen(QColor(0, 255, 255), 2));
+        painter.drawRect(toWidget(m_overlay.roi));
+    }
+    if (m_overlay.showGateLine) {
+        const int lineWidth = m_overlay.frameWidth > 0 ? m_overlay.frameWidth : m_imageSize.width();
+        const double y = m_displayRect.y() + m_overlay.gateLineY * sy;
+        painter.setPen(QPen(QColor(255, 0, 0), 3));
+        painter.drawLine(QPointF(m_displayRect.x(), y), QPointF(m_displayRect.x() + lineWidth * sx, y));
+    }
+    for (const auto& lane : m_overlay.lanes) {
+        const QRectF laneRect = toWidget(lane.roi);
+        painter.setPen(QPen(QColor(0, 255, 255), 2));
+        painter.drawRect(laneRect);
+        if (lane.gateLineY > 0) {
+            const double y = m_displayRect.y() + lane.gateLineY * sy;
+            painter.setPen(QPen(QColor(255, 0, 0), 3));
+            painter.drawLine(QPointF(laneRect.left(), y), QPointF(laneRect.right(), y));
+        }
+    }
+    for (const auto& box : m_overlay.boxes) {
+        painter.setPen(QPen(box.crossed ? QColor(255, 255, 0) : QColor(0, 255, 0), 2));
+        painter.drawRect(toWidget(box.rect));
+    }
+}
+
+void VideoDisplayWidget::paintOverlayLabels(QPainter& painter)
+{
+    if (m_overlay.isEmpty() || m_displayRect.isEmpty() || m_imageSize.isEmpty()) {
+        return;
+    }
+
+    const double sx = static_cast<double>(m_displayRect.width()) / m_imageSize.width();
+    const double sy = static_cast<double>(m_displayRect.height()) / m_imageSize.height();
+    auto toWidget = [&](const QPoint& p) {
+        return QPointF(m_displayRect.x() + p.x() * sx, m_displayRect.y() + p.y() * sy);
+    };
+
+    // 物件中心與面積標籤
+    painter.setFont(QFont("Arial", 8));
+    for (const auto& box : m_overlay.boxes) {
+        painter.setPen(Qt::NoPen);
+        painter.setBrush(QColor(0, 0, 255));
+        painter.drawEllipse(toWidget(box.center), 3.0, 3.0);
+        painter.setPen(Qt::white);
+        painter.drawText(toWidget(box.rect.topLeft()) - QPointF(0, 4), QString::number(box.area));
+    }
+
+    // 光柵線標籤
+    painter.setFont(QFont("Arial", 9, QFont::Bold));
+    if (m_overlay.showGateLine) {
+        painter.setPen(QColor(255, 0, 0));
+        painter.drawText(toWidget(QPoint(0, m_overlay.gateLineY)) + QPointF(8, -6),
+                         QString("GATE LINE (Y=%1)").arg(m_overlay.gateLineY));
+    }
+
+    // 料道計數（料道 ROI 左上角）
+    for (const auto& lane : m_overlay.lanes) {
+        painter.setPen(QColor(0, 255, 255));
+        const QString text = lane.targetCount > 0
+                                 ? QString("%1/%2").arg(lane.counted).arg(lane.targetCount)
+                                 : QString::number(lane.counted);
+        painter.drawText(toWidget(lane.roi.topLeft()) + QPointF(4, -6), text);
+    }
+
+    // 計數摘要（HUD 已顯示計數時略過，避免重疊）
+    if (!m_overlay.mode.isEmpty() && !m_hudEnabled) {
+        const QPointF origin(m_displayRect.x() + 8, m_displayRect.y() + 20);
+        painter.setPen(QColor(255, 255, 0));
+        painter.drawText(origin, QString("[%1] Detections: %2 | Counted: %3 | Gate: Y=%4")
+                                     .arg(m_overlay.mode)
+                                     .arg(m_overlay.detections)
+                                     .arg(m_overlay.counted)
+                                     .arg(m_overlay.gateLineY));
+        if (m_overlay.yoloInferenceMs >= 0.0) {
+            painter.setPen(QColor(255, 200, 0));
+            painter.setFont(QFont("Arial", 8));
+            painter.drawText(origin + QPointF(0, 18),
+                             QString("YOLO: %1 ms").arg(m_overlay.yoloInferenceMs, 0, 'f', 1));
+        }
+    }
+}
+
+void VideoDisplayWidget::paintOverlays(QPainter& painter)
+{
+    const QPoint imageOffset = m_displayRect.topLeft();
+    const int scaledW = m_displayRect.width();
+    const int scaledH = m_displayRect.height();
+    const int origW = m_imageSize.width();
+    const int origH = m_imageSize.height();
+
+    if (m_displayRect.isEmpty()) {
+        QMutexLocker locker(&m_mutex);
+        if (!m_message.isEmpty()) {
             painter.setPen(QColor(136, 136, 136));
             painter.setFont(QFont("Microsoft YaHei", 14));
             painter.drawText(rect(), Qt::AlignCenter, m_message);
         }
-    } // mutex 在此釋放，之後繪製 overlay 不持鎖
+    }
+
+    // 檢測疊加的文字部分（框線由 paintFrameOverlay / GPU 頂點繪製）
+    paintOverlayLabels(painter);
 
     // ===== ROI 編輯模式 overlay（主線程，無需 mutex）=====
     if (m_roiEditMode) {
@@ -248,13 +451,19 @@ void VideoDisplayWidget::resizeEvent(QResizeEvent* event)
 {
     QWidget::resizeEvent(event);
 
+#ifdef HAVE_GPU_DISPLAY
+    if (m_gpuView) {
+        m_gpuView->setGeometry(rect());
+    }
+#endif
+
     QMutexLocker locker(&m_mutex);
-    updateScaledImage();
+    updateDisplayRect();
 }
 
 void VideoDisplayWidget::mousePressEvent(QMouseEvent* event)
 {
-    if (m_scaledImage.isNull() || m_currentImage.isNull()) {
+    if (m_displayRect.isEmpty() || m_imageSize.isEmpty()) {
         return;
     }
 
@@ -263,37 +472,28 @@ void VideoDisplayWidget::mousePressEvent(QMouseEvent* event)
         m_isDragging = true;
         m_dragStart = event->pos();
         m_dragEnd = event->pos();
-        update();
+        requestRepaint();
         return;
     }
 
     if (m_gateLineEditMode && event->button() == Qt::LeftButton) {
         // 光柵線點擊模式：計算 Y ratio 並發出信號
-        QMutexLocker locker(&m_mutex);
-        if (!m_scaledImage.isNull() && m_scaledImage.height() > 0) {
-            int offsetY = (height() - m_scaledImage.height()) / 2;
-            int scaledH = m_scaledImage.height();
-            locker.unlock();
-
-            double ratio = static_cast<double>(event->pos().y() - offsetY) / scaledH;
-            ratio = std::max(0.0, std::min(1.0, ratio));
-            emit gateLinePositionSelected(ratio);
-        }
+        double ratio = static_cast<double>(event->pos().y() - m_displayRect.y()) / m_displayRect.height();
+        ratio = std::max(0.0, std::min(1.0, ratio));
+        emit gateLinePositionSelected(ratio);
         setGateLineEditMode(false);
         return;
     }
 
     // 一般模式：發出 clicked 信號（影像原始座標）
-    int offsetX = (width() - m_scaledImage.width()) / 2;
-    int offsetY = (height() - m_scaledImage.height()) / 2;
     QPoint clickPos = event->pos();
-    int imgX = clickPos.x() - offsetX;
-    int imgY = clickPos.y() - offsetY;
+    int imgX = clickPos.x() - m_displayRect.x();
+    int imgY = clickPos.y() - m_displayRect.y();
 
-    if (imgX >= 0 && imgX < m_scaledImage.width() &&
-        imgY >= 0 && imgY < m_scaledImage.height()) {
-        double scaleX = static_cast<double>(m_currentImage.width()) / m_scaledImage.width();
-        double scaleY = static_cast<double>(m_currentImage.height()) / m_scaledImage.height();
+    if (imgX >= 0 && imgX < m_displayRect.width() &&
+        imgY >= 0 && imgY < m_displayRect.height()) {
+        double scaleX = static_cast<double>(m_imageSize.width()) / m_displayRect.width();
+        double scaleY = static_cast<double>(m_imageSize.height()) / m_displayRect.height();
         emit clicked(QPoint(static_cast<int>(imgX * scaleX),
                             static_cast<int>(imgY * scaleY)));
     }
@@ -303,12 +503,12 @@ void VideoDisplayWidget::mouseMoveEvent(QMouseEvent* event)
 {
     if (m_isDragging) {
         m_dragEnd = event->pos();
-        update();  // 觸發 paintEvent 重繪 rubber-band
+        requestRepaint();  // 重繪 rubber-band
     }
 
     if (m_gateLineEditMode) {
         m_gateLineMouseY = event->pos().y();
-        update();  // 觸發 paintEvent 重繪水平預覽線
+        requestRepaint();  // 重繪水平預覽線
     }
 }
 
@@ -322,24 +522,22 @@ void VideoDisplayWidget::mouseReleaseEvent(QMouseEvent* event)
     m_dragEnd = event->pos();
 
     // 轉換拖拽矩形到影像原始座標
-    QMutexLocker locker(&m_mutex);
-    if (!m_scaledImage.isNull() && !m_currentImage.isNull()) {
-        int offsetX = (width() - m_scaledImage.width()) / 2;
-        int offsetY = (height() - m_scaledImage.height()) / 2;
-        double scaleX = static_cast<double>(m_currentImage.width()) / m_scaledImage.width();
-        double scaleY = static_cast<double>(m_currentImage.height()) / m_scaledImage.height();
+    if (!m_displayRect.isEmpty() && !m_imageSize.isEmpty()) {
+        const int offsetX = m_displayRect.x();
+        const int offsetY = m_displayRect.y();
+        double scaleX = static_cast<double>(m_imageSize.width()) / m_displayRect.width();
+        double scaleY = static_cast<double>(m_imageSize.height()) / m_displayRect.height();
 
         // 轉換兩端點並正規化矩形
         int x1 = static_cast<int>((m_dragStart.x() - offsetX) * scaleX);
         int y1 = static_cast<int>((m_dragStart.y() - offsetY) * scaleY);
         int x2 = static_cast<int>((m_dragEnd.x() - offsetX) * scaleX);
         int y2 = static_cast<int>((m_dragEnd.y() - offsetY) * scaleY);
-        locker.unlock();
 
         QRect roi = QRect(QPoint(x1, y1), QPoint(x2, y2)).normalized();
 
         // 限制在影像範圍內
-        roi = roi.intersected(QRect(0, 0, m_currentImage.width(), m_currentImage.height()));
+        roi = roi.intersected(QRect(QPoint(0, 0), m_imageSize));
 
         if (roi.width() > 4 && roi.height() > 4) {
             emit roiSelected(roi.x(), roi.y(), roi.width(), roi.height());
@@ -364,7 +562,7 @@ void VideoDisplayWidget::setRoiEditMode(bool enabled)
             setMouseTracking(false);
         }
     }
-    update();
+    requestRepaint();
 }
 
 void VideoDisplayWidget::mouseDoubleClickEvent(QMouseEvent* event)
@@ -378,7 +576,7 @@ void VideoDisplayWidget::mouseDoubleClickEvent(QMouseEvent* event)
 void VideoDisplayWidget::setHudEnabled(bool enabled)
 {
     m_hudEnabled = enabled;
-    update();
+    requestRepaint();
 }
 
 void VideoDisplayWidget::updateHud(int count, double fps, double gateRatio)
@@ -386,7 +584,7 @@ void VideoDisplayWidget::updateHud(int count, double fps, double gateRatio)
     m_hudCount = count;
     m_hudFps   = fps;
     m_hudGateRatio = gateRatio;
-    if (m_hudEnabled) update();
+    if (m_hudEnabled) requestRepaint();
 }
 
 void VideoDisplayWidget::setGateLineEditMode(bool enabled)
@@ -404,7 +602,7 @@ void VideoDisplayWidget::setGateLineEditMode(bool enabled)
             setMouseTracking(false);
         }
     }
-    update();
+    requestRepaint();
 }
 
 } // namespace basler
@@ -0,0 +1,187 @@
+#include "core/assignment_solver.h"
+#include "test_support.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+/**
+ * AssignmentSolver 等價測試
+ *
+ * 1. 小型隨機實例：總分與窮舉的最大權匹配相同（容許不配對），且配對合法
+ * 2. 超過 MAX_DENSE_SIZE 的分量與超出時間預算的幀：結果與依分數排序的貪婪相同
+ */
+
+namespace
+{
+    using basler::AssignmentCandidate;
+    using basler::AssignmentSolver;
+    using basler_test::uniformInt;
+    using basler_test::uniformReal;
+
+    using Assignments = std::vector<std::pair<int, int>>;
+
+    // 窮舉：逐一決定每個追蹤配哪個偵測（或不配）
+    double bruteForceBest(const std::vector<std::vector<double>> &score, int track, std::vector<char> &usedObject)
+    {
+        if (track == static_cast<int>(score.size()))
+        {
+            return 0.0;
+        }
+        double best = bruteForceBest(score, track + 1, usedObject);
+        for (size_t obj = 0; obj < usedObject.size(); ++obj)
+        {
+            if (usedObject[obj] || score[track][obj] <= 0.0)
+                continue;
+            usedObject[obj] = 1;
+            best = std::max(best, score[track][obj] + bruteForceBest(score, track + 1, usedObject));
+            usedObject[obj] = 0;
+        }
+        return best;
+    }
+
+    // 驗證配對合法（都是候選、兩端不重複）並回傳總分
+    bool checkAssignments(const Assignments &assignments, const std::vector<std::vector<double>> &score,
+                          double &total)
+    {
+        const int tracks = static_cast<int>(score.size());
+        const int objects = tracks == 0 ? 0 : static_cast<int>(score[0].size());
+        std::vector<char> usedTrack(tracks, 0), usedObject(objects, 0);
+        total = 0.0;
+        for (const auto &[track, object] : assignments)
+        {
+            if (!TEST_CHECK(track >= 0 && track < tracks && object >= 0 && object < objects) ||
+                !TEST_CHECK(!usedTrack[track] && !usedObject[object]) ||
+                !TEST_CHECK(score[track][object] > 0.0))
+            {
+                return false;
+            }
+            usedTrack[track] = usedObject[object] = 1;
+            total += score[track][object];
+        }
+        return true;
+    }
+
+    Assignments referenceGreedy(std::vector<AssignmentCandidate> candidates, int tracks, int objects)
+    {
+        std::stable_sort(candidates.begin(), candidates.end(),
+                         [](const AssignmentCandidate &a, const AssignmentCandidate &b)
+                         {
+                             if (a.score != b.score)
+                                 return a.score > b.score;
+                             if (a.track != b.track)
+                                 return a.track < b.track;
+                             return a.object < b.object;
+                         });
+        std::vector<char> usedTrack(tracks, 0), usedObject(objects, 0);
+        Assignments out;
+        for (const auto &c : candidates)
+        {
+            if (usedTrack[c.track] || usedObject[c.object])
+                continue;
+            usedTrack[c.track] = usedObject[c.object] = 1;
+            out.emplace_back(c.track, c.object);
+        }
+        std::sort(out.begin(), out.end());
+        return out;
+    }
+
+    void testOptimal(basler_test::Rng &rng)
+    {
+        AssignmentSolver solver;
+        std::vector<AssignmentCandidate> candidates;
+        Assignments assignments;
+
+        for (int run = 0; run < 3000; ++run)
+        {
+            const int tracks = uniformInt(rng, 0, 7);
+            const int objects = uniformInt(rng, 0, 7);
+            const double density = uniformReal(rng, 0.1, 1.0);
+
+            std::vector<std::vector<double>> score(tracks, std::vector<double>(objects, 0.0));
+            candidates.clear();
+            for (int t = 0; t < tracks; ++t)
+            {
+                for (int o = 0; o < objects; ++o)
+                {
+                    if (uniformReal(rng, 0.0, 1.0) >= density)
+                        continue;
+                    // 量化分數製造同分（密集零件常見）
+                    score[t][o] = uniformInt(rng, 1, 8) / 8.0;
+                    candidates.push_back({t, o, score[t][o]});
+                }
+            }
+
+            const auto stats = solver.solve(candidates, tracks, objects, 0.0, assignments);
+            double total = 0.0;
+            std::vector<char> usedObject(objects, 0);
+            if (!checkAssignments(assignments, score, total) ||
+                !TEST_CHECK(std::abs(total - bruteForceBest(score, 0, usedObject)) < 1e-9) ||
+                !TEST_CHECK(!stats.budgetExceeded && stats.greedyComponents == 0))
+            {
+                return;
+            }
+        }
+    }
+
+    void testGreedyFallback(basler_test::Rng &rng)
+    {
+        AssignmentSolver solver;
+        std::vector<AssignmentCandidate> candidates;
+        Assignments assignments;
+
+        for (int run = 0; run < 50; ++run)
+        {
+            // 過大分量：一條鏈串起所有追蹤，邊長超過 MAX_DENSE_SIZE
+            const int n = AssignmentSolver::MAX_DENSE_SIZE + uniformInt(rng, 1, 40);
+            candidates.clear();
+            for (int i = 0; i < n; ++i)
+            {
+                candidates.push_back({i, i, uniformInt(rng, 1, 16) / 16.0});
+                if (i + 1 < n)
+                    candidates.push_back({i, i + 1, uniformInt(rng, 1, 16) / 16.0});
+            }
+            const Assignments expected = referenceGreedy(candidates, n, n);
+
+            auto stats = solver.solve(candidates, n, n, 0.0, assignments);
+            std::sort(assignments.begin(), assignments.end());
+            if (!TEST_CHECK(assignments == expected) || !TEST_CHECK(stats.greedyComponents == 1))
+            {
+                return;
+            }
+
+            // 幾乎為零的預算：第一個多候選分量之後全部走貪婪。
+            // 每個分量的貪婪解（0.6）都比最佳解（0.5 + 0.5）差，兩種路徑可區分
+            std::vector<AssignmentCandidate> small;
+            for (int c = 0; c < 20; ++c)
+            {
+                const int t = 2 * c;
+                small.push_back({t, t, 0.6});
+                small.push_back({t, t + 1, 0.5});
+                small.push_back({t + 1, t, 0.5});
+            }
+            Assignments expectedSmall = referenceGreedy(small, 40, 40);
+            stats = solver.solve(small, 40, 40, 1e-9, assignments);
+            std::sort(assignments.begin(), assignments.end());
+
+            // 第一個分量可能在預算檢查前就已求解，只比較其餘分量
+            auto dropFirst = [](Assignments &a)
+            { a.erase(std::remove_if(a.begin(), a.end(), [](const auto &p) { return p.first < 2; }), a.end()); };
+            dropFirst(assignments);
+            dropFirst(expectedSmall);
+            if (!TEST_CHECK(stats.budgetExceeded && stats.greedyComponents >= 19) ||
+                !TEST_CHECK(assignments == expectedSmall))
+            {
+                return;
+            }
+        }
+    }
+}
+
+int main()
+{
+    basler_test::Rng rng(20240614);
+    testOptimal(rng);
+    testGreedyFallback(rng);
+    return basler_test::testResult("assignment_solver");
+}
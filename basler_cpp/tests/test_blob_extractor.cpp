@@ -0,0 +1,211 @@
+#include "core/blob_extractor.h"
+#include "test_support.h"
+
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+#include <vector>
+
+/**
+ * RunLengthBlobExtractor 等價測試
+ *
+ * 參考實作：cv::dilate(ones(2, 2)) 之後以光柵順序 flood fill 標記，逐元件比較外框、面積、重心與順序；
+ * 另與 cv::connectedComponentsWithStats 比較元件集合（OpenCV 的標籤順序不保證光柵順序）。
+ * 隨機遮罩涵蓋 4 / 8 連通、有無 2×2 微膨脹、非 16 倍數的寬度與貼邊的前景。
+ */
+
+namespace
+{
+    using basler::RunLengthBlobExtractor;
+    using basler_test::uniformInt;
+    using Blob = RunLengthBlobExtractor::Blob;
+
+    std::vector<Blob> referenceBlobs(const cv::Mat &mask, int connectivity)
+    {
+        cv::Mat visited = cv::Mat::zeros(mask.size(), CV_8UC1);
+        std::vector<Blob> blobs;
+        std::vector<cv::Point> stack;
+
+        for (int y = 0; y < mask.rows; ++y)
+        {
+            for (int x = 0; x < mask.cols; ++x)
+            {
+                if (!mask.at<uchar>(y, x) || visited.at<uchar>(y, x))
+                    continue;
+
+                int minX = x, maxX = x, minY = y, maxY = y;
+                long long area = 0, sumX = 0, sumY = 0;
+                stack.assign(1, cv::Point(x, y));
+                visited.at<uchar>(y, x) = 1;
+                while (!stack.empty())
+                {
+                    const cv::Point p = stack.back();
+                    stack.pop_back();
+                    ++area;
+                    sumX += p.x;
+                    sumY += p.y;
+                    minX = std::min(minX, p.x);
+                    maxX = std::max(maxX, p.x);
+                    minY = std::min(minY, p.y);
+                    maxY = std::max(maxY, p.y);
+
+                    for (int dy = -1; dy <= 1; ++dy)
+                    {
+                        for (int dx = -1; dx <= 1; ++dx)
+                        {
+                            if ((dx == 0 && dy == 0) || (connectivity == 4 && dx != 0 && dy != 0))
+                                continue;
+                            const int nx = p.x + dx;
+                            const int ny = p.y + dy;
+                            if (nx < 0 || ny < 0 || nx >= mask.cols || ny >= mask.rows)
+                                continue;
+                            if (mask.at<uchar>(ny, nx) && !visited.at<uchar>(ny, nx))
+                            {
+                                visited.at<uchar>(ny, nx) = 1;
+                                stack.emplace_back(nx, ny);
+                            }
+                        }
+                    }
+                }
+
+                Blob blob;
+                blob.left = minX;
+                blob.top = minY;
+                blob.width = maxX - minX + 1;
+                blob.height = maxY - minY + 1;
+                blob.area = static_cast<int>(area);
+                blob.centroidX = static_cast<double>(sumX) / area;
+                blob.centroidY = static_cast<double>(sumY) / area;
+                blobs.push_back(blob);
+            }
+        }
+        return blobs;
+    }
+
+    bool sameBlob(const Blob &a, const Blob &b)
+    {
+        return a.left == b.left && a.top == b.top && a.width == b.width && a.height == b.height &&
+               a.area == b.area && std::abs(a.centroidX - b.centroidX) < 1e-9 &&
+               std::abs(a.centroidY - b.centroidY) < 1e-9;
+    }
+
+    // 以外框、面積與重心排序，用於和 OpenCV 的元件集合比較
+    auto blobKey(const Blob &b) { return std::make_tuple(b.top, b.left, b.width, b.height, b.area, b.centroidX, b.centroidY); }
+
+    bool matchesOpenCv(const cv::Mat &mask, int connectivity, std::vector<Blob> blobs)
+    {
+        cv::Mat labels, stats, centroids;
+        const int n = cv::connectedComponentsWithStats(mask, labels, stats, centroids, connectivity, CV_32S);
+        std::vector<Blob> expected;
+        for (int i = 1; i < n; ++i)
+        {
+            Blob b;
+            b.left = stats.at<int>(i, cv::CC_STAT_LEFT);
+            b.top = stats.at<int>(i, cv::CC_STAT_TOP);
+            b.width = stats.at<int>(i, cv::CC_STAT_WIDTH);
+            b.height = stats.at<int>(i, cv::CC_STAT_HEIGHT);
+            b.area = stats.at<int>(i, cv::CC_STAT_AREA);
+            b.centroidX = centroids.at<double>(i, 0);
+            b.centroidY = centroids.at<double>(i, 1);
+            expected.push_back(b);
+        }
+
+        auto byKey = [](const Blob &a, const Blob &b) { return blobKey(a) < blobKey(b); };
+        std::sort(blobs.begin(), blobs.end(), byKey);
+        std::sort(expected.begin(), expected.end(), byKey);
+        if (!TEST_CHECK(blobs.size() == expected.size()))
+        {
+            return false;
+        }
+        for (size_t i = 0; i < blobs.size(); ++i)
+        {
+            if (!TEST_CHECK(sameBlob(blobs[i], expected[i])))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    cv::Mat randomMask(basler_test::Rng &rng, int width, int height)
+    {
+        cv::Mat mask = cv::Mat::zeros(height, width, CV_8UC1);
+        const int density = uniformInt(rng, 1, 60); // 百分比
+        const int style = uniformInt(rng, 0, 2);
+        if (style == 0)
+        {
+            // 散點雜訊：大量細碎元件與對角相鄰
+            for (int y = 0; y < height; ++y)
+                for (int x = 0; x < width; ++x)
+                    mask.at<uchar>(y, x) = uniformInt(rng, 0, 99) < density ? 255 : 0;
+        }
+        else
+        {
+            // 零件形狀：矩形、橢圓與細線，可能貼邊或互相接觸
+            const int shapes = uniformInt(rng, 0, 30);
+            for (int i = 0; i < shapes; ++i)
+            {
+                const cv::Point c(uniformInt(rng, -5, width + 5), uniformInt(rng, -5, height + 5));
+                const cv::Size axes(uniformInt(rng, 1, 25), uniformInt(rng, 1, 25));
+                switch (uniformInt(rng, 0, 2))
+                {
+                case 0:
+                    cv::rectangle(mask, cv::Rect(c, axes), cv::Scalar(255), cv::FILLED);
+                    break;
+                case 1:
+                    cv::ellipse(mask, c, axes, uniformInt(rng, 0, 180), 0, 360, cv::Scalar(255), cv::FILLED);
+                    break;
+                default:
+                    cv::line(mask, c, c + cv::Point(axes.width, axes.height - 12), cv::Scalar(255), 1);
+                    break;
+                }
+            }
+            if (style == 2)
+            {
+                // 非 255 的前景值也必須視為前景
+                mask.setTo(cv::Scalar(1), mask);
+            }
+        }
+        return mask;
+    }
+}
+
+int main()
+{
+    basler_test::Rng rng(20240625);
+    RunLengthBlobExtractor extractor;
+    const cv::Mat kernel = cv::Mat::ones(2, 2, CV_8U);
+
+    for (int run = 0; run < 1000 && basler_test::failureCount() == 0; ++run)
+    {
+        const int width = uniformInt(rng, 1, 200);
+        const int height = uniformInt(rng, 1, 80);
+        const cv::Mat mask = randomMask(rng, width, height);
+
+        for (int connectivity : {4, 8})
+        {
+            for (bool dilate : {false, true})
+            {
+                cv::Mat input = mask;
+                if (dilate)
+                {
+                    cv::dilate(mask, input, kernel);
+                }
+                const std::vector<Blob> blobs = extractor.extract(mask, connectivity, dilate);
+                const std::vector<Blob> expected = referenceBlobs(input, connectivity);
+
+                bool ok = TEST_CHECK(blobs.size() == expected.size());
+                for (size_t i = 0; ok && i < blobs.size(); ++i)
+                {
+                    ok = TEST_CHECK(sameBlob(blobs[i], expected[i]));
+                }
+                if (!ok || !matchesOpenCv(input, connectivity, blobs))
+                {
+                    return basler_test::testResult("blob_extractor");
+                }
+            }
+        }
+    }
+    return basler_test::testResult("blob_extractor");
+}
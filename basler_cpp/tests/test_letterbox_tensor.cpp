@@ -0,0 +1,190 @@
+#include "core/letterbox_tensor.h"
+#include "test_support.h"
+
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+/**
+ * LetterboxTensor 等價測試
+ *
+ * 1. 幾何（ratio、填充、內容區）與原本「cv::resize 放大 → letterbox」逐值相同
+ * 2. 內容區與 cv::resize(INTER_LINEAR) 直接縮放到內容尺寸的結果相同
+ *    （OpenCV 8 位元路徑為定點運算，容許 1/255 誤差）；1:1 幾何則精確重現像素 / 255
+ * 3. 內容區以外全部是 114/255，包含同一槽位由大內容換成小內容之後
+ * 4. 灰階複製到三個平面、BGRA 忽略 alpha、BGR → RGB 平面順序
+ * 5. 只增加批次數時保留已寫入的槽位；view() 與 tensor 共用資料
+ */
+
+namespace
+{
+    using basler::LetterboxTensor;
+    using basler_test::uniformInt;
+    using basler_test::uniformReal;
+
+    constexpr float PAD = 114.0f / 255.0f;
+
+    // 原本 YoloDetector::preprocess + letterbox 的幾何
+    LetterboxTensor::Geometry referenceGeometry(const cv::Mat &roi, double upscaleFactor, int size)
+    {
+        cv::Size upscaled = roi.size();
+        if (upscaleFactor > 1.0)
+        {
+            cv::Mat tmp;
+            cv::resize(roi, tmp, cv::Size(), upscaleFactor, upscaleFactor, cv::INTER_LINEAR);
+            upscaled = tmp.size();
+        }
+
+        LetterboxTensor::Geometry g;
+        g.ratio = std::min(static_cast<double>(size) / upscaled.width, static_cast<double>(size) / upscaled.height);
+        g.contentWidth = static_cast<int>(upscaled.width * g.ratio);
+        g.contentHeight = static_cast<int>(upscaled.height * g.ratio);
+        g.padX = (size - g.contentWidth) / 2;
+        g.padY = (size - g.contentHeight) / 2;
+        return g;
+    }
+
+    // 像素值由 cv::theRNG() 產生（main() 設定種子）
+    cv::Mat randomRoi(int width, int height, int channels)
+    {
+        cv::Mat roi(height, width, CV_8UC(channels));
+        cv::randu(roi, cv::Scalar::all(0), cv::Scalar::all(256));
+        return roi;
+    }
+
+    // 檢查一個槽位：內容區與 expected（CV_32FC3，RGB）比較，其餘為填充值
+    bool checkSlot(const LetterboxTensor &tensor, int slot, const LetterboxTensor::Geometry &g,
+                   const cv::Mat &expected, float tolerance)
+    {
+        const int size = tensor.size();
+        const cv::Mat view = tensor.view(slot, 1);
+        for (int c = 0; c < 3; ++c)
+        {
+            const float *plane = view.ptr<float>() + static_cast<size_t>(c) * size * size;
+            for (int y = 0; y < size; ++y)
+            {
+                for (int x = 0; x < size; ++x)
+                {
+                    const float v = plane[static_cast<size_t>(y) * size + x];
+                    const int cx = x - g.padX;
+                    const int cy = y - g.padY;
+                    const bool inside = cx >= 0 && cy >= 0 && cx < g.contentWidth && cy < g.contentHeight;
+                    const float want = inside ? expected.at<cv::Vec3f>(cy, cx)[c] : PAD;
+                    if (!TEST_CHECK(std::abs(v - want) <= (inside ? tolerance : 0.0f)))
+                    {
+                        return false;
+                    }
+                }
+            }
+        }
+        return true;
+    }
+
+    // cv::resize 直接縮放到內容尺寸，轉 RGB、0~1
+    cv::Mat referenceContent(const cv::Mat &roi, const LetterboxTensor::Geometry &g)
+    {
+        cv::Mat resized, rgb, out;
+        cv::resize(roi, resized, cv::Size(g.contentWidth, g.contentHeight), 0, 0, cv::INTER_LINEAR);
+        switch (roi.channels())
+        {
+        case 1:
+            cv::cvtColor(resized, rgb, cv::COLOR_GRAY2RGB);
+            break;
+        case 3:
+            cv::cvtColor(resized, rgb, cv::COLOR_BGR2RGB);
+            break;
+        default:
+            cv::cvtColor(resized, rgb, cv::COLOR_BGRA2RGB);
+            break;
+        }
+        rgb.convertTo(out, CV_32FC3, 1.0 / 255.0);
+        return out;
+    }
+
+    void testRandomFills(basler_test::Rng &rng)
+    {
+        LetterboxTensor tensor;
+        const int channelChoices[3] = {1, 3, 4};
+
+        for (int run = 0; run < 100; ++run)
+        {
+            const int size = uniformInt(rng, 0, 3) == 0 ? 640 : uniformInt(rng, 32, 320);
+            const int batch = uniformInt(rng, 1, 4);
+            tensor.reserve(batch, size);
+
+            for (int fill = 0; fill < 3; ++fill)
+            {
+                const int slot = uniformInt(rng, 0, batch - 1);
+                const int width = uniformInt(rng, 1, 900);
+                const int height = uniformInt(rng, 1, 300);
+                const int channels = channelChoices[uniformInt(rng, 0, 2)];
+                const double upscale = uniformInt(rng, 0, 2) == 0 ? 1.0 : uniformReal(rng, 1.0, 3.0);
+                const cv::Mat roi = randomRoi(width, height, channels);
+
+                const auto g = tensor.fill(slot, roi, upscale);
+                const auto ref = referenceGeometry(roi, upscale, size);
+                if (!TEST_CHECK(g.ratio == ref.ratio && g.padX == ref.padX && g.padY == ref.padY) ||
+                    !TEST_CHECK(g.contentWidth == std::max(1, ref.contentWidth) &&
+                                g.contentHeight == std::max(1, ref.contentHeight)) ||
+                    !checkSlot(tensor, slot, g, referenceContent(roi, g), 1.0f / 255.0f + 1e-5f))
+                {
+                    return;
+                }
+            }
+        }
+    }
+
+    void testIdentityAndLayout()
+    {
+        // 1:1 幾何：寬 = tensor 尺寸，內容即原像素 / 255
+        LetterboxTensor tensor;
+        tensor.reserve(1, 64);
+        const cv::Mat roi = randomRoi(64, 20, 3);
+        const auto g = tensor.fill(0, roi, 1.0);
+        cv::Mat rgb, expected;
+        cv::cvtColor(roi, rgb, cv::COLOR_BGR2RGB);
+        rgb.convertTo(expected, CV_32FC3, 1.0 / 255.0);
+        if (!TEST_CHECK(g.contentWidth == 64 && g.contentHeight == 20 && g.padX == 0 && g.padY == 22) ||
+            !checkSlot(tensor, 0, g, expected, 1e-6f))
+        {
+            return;
+        }
+
+        // 同一槽位換成較小內容：舊內容區必須回到填充值
+        const cv::Mat gray = randomRoi(10, 30, 1);
+        const auto small = tensor.fill(0, gray, 1.0);
+        if (!checkSlot(tensor, 0, small, referenceContent(gray, small), 1.0f / 255.0f + 1e-5f))
+        {
+            return;
+        }
+
+        // 只增加批次數：槽位 0 保留，新槽位首次寫入時填滿填充值
+        tensor.reserve(3, 64);
+        if (!TEST_CHECK(tensor.capacity() == 3) ||
+            !checkSlot(tensor, 0, small, referenceContent(gray, small), 1.0f / 255.0f + 1e-5f))
+        {
+            return;
+        }
+        const auto second = tensor.fill(2, roi, 1.0);
+        if (!checkSlot(tensor, 2, second, expected, 1e-6f))
+        {
+            return;
+        }
+
+        // view() 不複製
+        const cv::Mat all = tensor.view(0, 3);
+        const cv::Mat last = tensor.view(2, 1);
+        TEST_CHECK(all.dims == 4 && all.size[0] == 3 && all.size[1] == 3 && all.size[2] == 64 && all.size[3] == 64);
+        TEST_CHECK(last.ptr<float>() == all.ptr<float>() + static_cast<size_t>(2) * 3 * 64 * 64);
+    }
+}
+
+int main()
+{
+    basler_test::Rng rng(20240621);
+    cv::theRNG().state = 20240621;
+    testRandomFills(rng);
+    testIdentityAndLayout();
+    return basler_test::testResult("letterbox_tensor");
+}
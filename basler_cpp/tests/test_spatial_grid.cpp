@@ -0,0 +1,156 @@
+#include "core/spatial_grid.h"
+#include "test_support.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+/**
+ * SpatialGrid / RecentPositionIndex 等價測試
+ *
+ * SpatialGrid：查詢點周圍 3×3 格的候選必須涵蓋全掃描時所有 |dx| < 格寬、|dy| < 格高 的項目，
+ * 且每個項目最多出現一次（匹配評分只看這個範圍，漏一個就會改變匹配結果）。
+ * RecentPositionIndex：與原本「vector 保存最近 capacity 筆、逐筆掃描」的去重複判斷逐次比較。
+ */
+
+namespace
+{
+    using basler::RecentPositionIndex;
+    using basler::SpatialGrid;
+    using basler_test::uniformInt;
+    using basler_test::uniformReal;
+
+    struct Point
+    {
+        int x, y, frame;
+    };
+
+    void testGrid(basler_test::Rng &rng)
+    {
+        SpatialGrid grid;
+        std::vector<Point> points;
+        std::vector<int> seen;
+
+        for (int run = 0; run < 200; ++run)
+        {
+            const int cellW = uniformInt(rng, 1, 80);
+            const int cellH = uniformInt(rng, 1, 80);
+            grid.setCellSize(cellW, cellH);
+            grid.clear();
+
+            // 含負座標（預測位置可能超出畫面）與密集群聚
+            points.clear();
+            const int count = uniformInt(rng, 0, 300);
+            for (int i = 0; i < count; ++i)
+            {
+                points.push_back({uniformInt(rng, -100, 740), uniformInt(rng, -50, 170), 0});
+                grid.insert(i, points.back().x, points.back().y);
+            }
+            grid.build();
+            if (!TEST_CHECK(grid.size() == count))
+            {
+                return;
+            }
+
+            seen.assign(count, 0);
+            for (int q = 0; q < 50; ++q)
+            {
+                const int qx = uniformInt(rng, -120, 760);
+                const int qy = uniformInt(rng, -60, 180);
+                std::fill(seen.begin(), seen.end(), 0);
+                bool valid = true;
+                grid.forEachCandidate(qx, qy, [&](int item)
+                                      {
+                                          valid = valid && item >= 0 && item < count && seen[item] == 0;
+                                          if (item >= 0 && item < count)
+                                              seen[item]++;
+                                      });
+                if (!TEST_CHECK(valid))
+                {
+                    return;
+                }
+
+                for (int i = 0; i < count; ++i)
+                {
+                    const bool near = std::abs(points[i].x - qx) < cellW && std::abs(points[i].y - qy) < cellH;
+                    if (near && !TEST_CHECK(seen[i] == 1))
+                    {
+                        return;
+                    }
+                }
+            }
+        }
+    }
+
+    bool referenceContainsNear(const std::vector<Point> &history, int capacity, int x, int y, double radius,
+                               int frame, int maxAge)
+    {
+        if (radius <= 0.0 || maxAge <= 0)
+        {
+            return false;
+        }
+        const size_t first = history.size() > static_cast<size_t>(capacity) ? history.size() - capacity : 0;
+        for (size_t i = first; i < history.size(); ++i)
+        {
+            const double dx = x - history[i].x;
+            const double dy = y - history[i].y;
+            if (frame - history[i].frame < maxAge && dx * dx + dy * dy < radius * radius)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void testRecentPositions(basler_test::Rng &rng)
+    {
+        RecentPositionIndex index(16, 10);
+        std::vector<Point> history;
+
+        for (int run = 0; run < 200; ++run)
+        {
+            const int capacity = uniformInt(rng, 1, 128);
+            const int cellSize = uniformInt(rng, 1, 60);
+            index.configure(capacity, cellSize);
+            history.clear();
+
+            int frame = 0;
+            for (int step = 0; step < 400; ++step)
+            {
+                frame += uniformInt(rng, 0, 2); // 幀號單調不減，可重複
+                const int pushes = uniformInt(rng, 0, 3);
+                for (int i = 0; i < pushes; ++i)
+                {
+                    const Point p{uniformInt(rng, -20, 660), uniformInt(rng, -20, 140), frame};
+                    index.push(p.x, p.y, p.frame);
+                    history.push_back(p);
+                }
+
+                const int qx = uniformInt(rng, -30, 670);
+                const int qy = uniformInt(rng, -30, 150);
+                const double radius = uniformReal(rng, 0.0, 90.0);
+                const int maxAge = uniformInt(rng, 0, 40);
+                const bool expected = referenceContainsNear(history, capacity, qx, qy, radius, frame, maxAge);
+                if (!TEST_CHECK(index.containsNear(qx, qy, radius, frame, maxAge) == expected))
+                {
+                    return;
+                }
+            }
+
+            // clear() 後不應再看到任何舊紀錄
+            index.clear();
+            if (!TEST_CHECK(!index.containsNear(320, 60, 1000.0, frame, 1 << 20)))
+            {
+                return;
+            }
+        }
+    }
+}
+
+int main()
+{
+    basler_test::Rng rng(20240611);
+    testGrid(rng);
+    testRecentPositions(rng);
+    return basler_test::testResult("spatial_grid");
+}
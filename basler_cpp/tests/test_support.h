@@ -0,0 +1,61 @@
+#ifndef TEST_SUPPORT_H
+#define TEST_SUPPORT_H
+
+#include <cstdio>
+#include <random>
+
+/**
+ * 核心演算法等價測試的共用工具（不依賴測試框架，ctest 以結束碼判定）
+ *
+ * TEST_CHECK 失敗時印出位置並累計，main() 以 testResult() 回傳；
+ * 隨機輸入一律以固定種子產生，失敗可重現。
+ */
+
+namespace basler_test
+{
+
+    inline int &failureCount()
+    {
+        static int failures = 0;
+        return failures;
+    }
+
+    inline bool reportFailure(const char *expr, const char *file, int line)
+    {
+        // 只印前幾筆，避免隨機測試一次失敗洗版
+        if (++failureCount() <= 20)
+        {
+            std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", file, line, expr);
+        }
+        return false;
+    }
+
+    inline int testResult(const char *name)
+    {
+        if (failureCount() == 0)
+        {
+            std::printf("[%s] passed\n", name);
+            return 0;
+        }
+        std::printf("[%s] %d check(s) failed\n", name, failureCount());
+        return 1;
+    }
+
+    using Rng = std::mt19937;
+
+    inline int uniformInt(Rng &rng, int lo, int hi)
+    {
+        return std::uniform_int_distribution<int>(lo, hi)(rng);
+    }
+
+    inline double uniformReal(Rng &rng, double lo, double hi)
+    {
+        return std::uniform_real_distribution<double>(lo, hi)(rng);
+    }
+
+} // namespace basler_test
+
+// 回傳條件結果，呼叫端可在失敗時提早結束該輪
+#define TEST_CHECK(cond) ((cond) ? true : ::basler_test::reportFailure(#cond, __FILE__, __LINE__))
+
+#endif // TEST_SUPPORT_H
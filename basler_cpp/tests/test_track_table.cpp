@@ -0,0 +1,236 @@
+#include "core/track_table.h"
+#include "test_support.h"
+
+#include <map>
+#include <utility>
+#include <vector>
+
+/**
+ * TrackTable 等價測試
+ *
+ * 參考實作是原本的 std::map<int, ObjectTrack>：位置 / 面積歷史為 vector，
+ * 超過 10 筆時 erase(begin())。隨機執行新增、更新、速度預測、狀態轉移與移除，
+ * 每幀 compact() 後逐欄比較，並確認槽位順序與 map 的 trackId 順序相同。
+ */
+
+namespace
+{
+    using basler::TrackTable;
+    using basler_test::uniformInt;
+
+    struct RefTrack
+    {
+        int x, y, w, h, area;
+        int firstFrame, lastFrame, inRoiFrames;
+        int maxY, minY, firstY;
+        bool counted = false;
+        std::vector<std::pair<int, int>> positions;
+        std::vector<int> areaHistory;
+        double velocityX = 0.0, velocityY = 0.0;
+        double predictedX = 0.0, predictedY = 0.0;
+        int missedFrames = 0;
+        int state = TrackTable::Active;
+    };
+
+    void refObserve(RefTrack &t, int cx, int cy, int width, int height, int objArea, int frame)
+    {
+        t.x = cx;
+        t.y = cy;
+        t.w = width;
+        t.h = height;
+        t.area = objArea;
+        t.lastFrame = frame;
+        t.positions.push_back({cx, cy});
+        t.areaHistory.push_back(objArea);
+        t.inRoiFrames++;
+        t.maxY = std::max(t.maxY, cy);
+        t.minY = std::min(t.minY, cy);
+        t.missedFrames = 0;
+        if (t.positions.size() > TrackTable::HISTORY_LENGTH)
+        {
+            t.positions.erase(t.positions.begin());
+            t.areaHistory.erase(t.areaHistory.begin());
+        }
+    }
+
+    void refUpdateVelocity(RefTrack &t)
+    {
+        if (t.positions.size() >= 2)
+        {
+            const auto &recent = t.positions[t.positions.size() - 1];
+            const auto &previous = t.positions[t.positions.size() - 2];
+            t.velocityX = recent.first - previous.first;
+            t.velocityY = recent.second - previous.second;
+            t.predictedX = recent.first + t.velocityX;
+            t.predictedY = recent.second + t.velocityY;
+        }
+        else
+        {
+            t.predictedX = t.x;
+            t.predictedY = t.y;
+        }
+    }
+
+    bool sameTrack(const TrackTable &table, int slot, const RefTrack &t)
+    {
+        bool ok = TEST_CHECK(table.x[slot] == t.x && table.y[slot] == t.y) &&
+                  TEST_CHECK(table.w[slot] == t.w && table.h[slot] == t.h) &&
+                  TEST_CHECK(table.area[slot] == t.area) &&
+                  TEST_CHECK(table.firstFrame[slot] == t.firstFrame && table.lastFrame[slot] == t.lastFrame) &&
+                  TEST_CHECK(table.inRoiFrames[slot] == t.inRoiFrames) &&
+                  TEST_CHECK(table.maxY[slot] == t.maxY && table.minY[slot] == t.minY) &&
+                  TEST_CHECK(table.firstY[slot] == t.firstY) &&
+                  TEST_CHECK((table.counted[slot] != 0) == t.counted) &&
+                  TEST_CHECK(table.velocityX[slot] == t.velocityX && table.velocityY[slot] == t.velocityY) &&
+                  TEST_CHECK(table.predictedX[slot] == t.predictedX && table.predictedY[slot] == t.predictedY) &&
+                  TEST_CHECK(table.missedFrames[slot] == t.missedFrames) &&
+                  TEST_CHECK(table.state[slot] == t.state);
+        if (!ok)
+        {
+            return false;
+        }
+
+        const auto &positions = table.positions[slot];
+        const auto &areas = table.areaHistory[slot];
+        const int n = static_cast<int>(t.positions.size());
+        if (!TEST_CHECK(positions.size() == n && areas.size() == n))
+        {
+            return false;
+        }
+        for (int age = 0; age < n; ++age)
+        {
+            const auto &expected = t.positions[n - 1 - age];
+            if (!TEST_CHECK(positions.back(age).x == expected.first && positions.back(age).y == expected.second) ||
+                !TEST_CHECK(areas.back(age) == t.areaHistory[n - 1 - age]))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool sameTable(const TrackTable &table, const std::map<int, RefTrack> &reference)
+    {
+        if (!TEST_CHECK(table.size() == static_cast<int>(reference.size())))
+        {
+            return false;
+        }
+        int slot = 0;
+        for (const auto &[id, track] : reference)
+        {
+            if (!TEST_CHECK(table.trackId[slot] == id) || !sameTrack(table, slot, track))
+            {
+                return false;
+            }
+            ++slot;
+        }
+        return true;
+    }
+
+    void runOnce(basler_test::Rng &rng)
+    {
+        TrackTable table(8); // 刻意給小容量，也涵蓋成長路徑
+        std::map<int, RefTrack> reference;
+        int nextId = 1;
+
+        auto randomSlot = [&]() { return uniformInt(rng, 0, table.size() - 1); };
+
+        for (int frame = 0; frame < 120; ++frame)
+        {
+            const int births = uniformInt(rng, 0, 6);
+            for (int i = 0; i < births; ++i)
+            {
+                const int cx = uniformInt(rng, 0, 640);
+                const int cy = uniformInt(rng, 0, 120);
+                const int w = uniformInt(rng, 1, 40);
+                const int h = uniformInt(rng, 1, 40);
+                const int id = nextId++;
+                table.add(id, cx, cy, w, h, w * h, frame);
+
+                RefTrack t;
+                t.x = cx;
+                t.y = cy;
+                t.w = w;
+                t.h = h;
+                t.area = w * h;
+                t.firstFrame = t.lastFrame = frame;
+                t.inRoiFrames = 1;
+                t.maxY = t.minY = t.firstY = cy;
+                t.positions.push_back({cx, cy});
+                t.areaHistory.push_back(w * h);
+                t.predictedX = cx;
+                t.predictedY = cy;
+                reference[id] = t;
+            }
+
+            const int ops = table.size() == 0 ? 0 : uniformInt(rng, 0, 3 * table.size());
+            for (int i = 0; i < ops; ++i)
+            {
+                const int slot = randomSlot();
+                RefTrack &t = reference[table.trackId[slot]];
+                if (table.state[slot] == TrackTable::Dead)
+                {
+                    continue;
+                }
+
+                switch (uniformInt(rng, 0, 5))
+                {
+                case 0:
+                case 1:
+                {
+                    const int cx = table.x[slot] + uniformInt(rng, -8, 8);
+                    const int cy = table.y[slot] + uniformInt(rng, 0, 12);
+                    const int w = uniformInt(rng, 1, 40);
+                    const int h = uniformInt(rng, 1, 40);
+                    table.observe(slot, cx, cy, w, h, w * h, frame);
+                    refObserve(t, cx, cy, w, h, w * h, frame);
+                    break;
+                }
+                case 2:
+                    table.updateVelocity(slot);
+                    refUpdateVelocity(t);
+                    break;
+                case 3:
+                    table.state[slot] = table.state[slot] == TrackTable::Active ? TrackTable::Lost : TrackTable::Active;
+                    t.state = table.state[slot];
+                    table.missedFrames[slot]++;
+                    t.missedFrames++;
+                    break;
+                case 4:
+                    table.counted[slot] = 1;
+                    t.counted = true;
+                    break;
+                default:
+                    table.state[slot] = TrackTable::Dead;
+                    t.state = TrackTable::Dead;
+                    break;
+                }
+            }
+
+            table.compact();
+            for (auto it = reference.begin(); it != reference.end();)
+            {
+                it = it->second.state == TrackTable::Dead ? reference.erase(it) : std::next(it);
+            }
+
+            if (!sameTable(table, reference) ||
+                !TEST_CHECK(table.count(TrackTable::Dead) == 0))
+            {
+                return;
+            }
+        }
+
+        table.clear();
+        TEST_CHECK(table.size() == 0);
+    }
+}
+
+int main()
+{
+    basler_test::Rng rng(20240607);
+    for (int run = 0; run < 200 && basler_test::failureCount() == 0; ++run)
+    {
+        runOnce(rng);
+    }
+    return basler_test::testResult("track_table");
+}
@@ -0,0 +1,196 @@
+#include "core/yolo_postprocess.h"
+#include "test_support.h"
+
+#include <opencv2/dnn.hpp>
+#include <vector>
+
+/**
+ * YoloPostProcessor 等價測試
+ *
+ * 參考實作是原本 YoloDetector::postProcess 的流程：transpose 成 [A, 4 + 類別數]、
+ * 逐列取最大類別、座標反映射後交給 cv::dnn::NMSBoxes。
+ * 隨機輸出涵蓋 1~6 類、非 4 倍數的 anchor 數、群聚重複框與兩種輸出排列，
+ * 要求回傳相同的框、分數與類別，順序也相同。
+ */
+
+namespace
+{
+    using basler::YoloPostProcessor;
+    using basler_test::uniformInt;
+    using basler_test::uniformReal;
+
+    struct RefBox
+    {
+        cv::Rect rect;
+        float score;
+        int classId;
+    };
+
+    std::vector<RefBox> referencePostProcess(const cv::Mat &output, float confThreshold, float nmsThreshold,
+                                             const YoloPostProcessor::Mapping &m)
+    {
+        const int rows = output.size[1];
+        const int cols = output.size[2];
+
+        cv::Mat detections;
+        if (rows < cols)
+        {
+            cv::transpose(output.reshape(1, rows), detections);
+        }
+        else
+        {
+            detections = output.reshape(1, rows);
+        }
+
+        std::vector<cv::Rect> boxes;
+        std::vector<float> confidences;
+        std::vector<int> classIds;
+        for (int i = 0; i < detections.rows; i++)
+        {
+            const float *row = detections.ptr<float>(i);
+            float maxConf = 0.0f;
+            int maxClassId = 0;
+            for (int j = 4; j < detections.cols; j++)
+            {
+                if (row[j] > maxConf)
+                {
+                    maxConf = row[j];
+                    maxClassId = j - 4;
+                }
+            }
+            if (maxConf < confThreshold)
+            {
+                continue;
+            }
+
+            float x1 = (row[0] - row[2] / 2.0f - m.padX) / static_cast<float>(m.scaleX);
+            float y1 = (row[1] - row[3] / 2.0f - m.padY) / static_cast<float>(m.scaleY);
+            float x2 = (row[0] + row[2] / 2.0f - m.padX) / static_cast<float>(m.scaleX);
+            float y2 = (row[1] + row[3] / 2.0f - m.padY) / static_cast<float>(m.scaleY);
+            x1 /= static_cast<float>(m.upscaleRatio);
+            y1 /= static_cast<float>(m.upscaleRatio);
+            x2 /= static_cast<float>(m.upscaleRatio);
+            y2 /= static_cast<float>(m.upscaleRatio);
+
+            const int boxW = static_cast<int>(x2 - x1);
+            const int boxH = static_cast<int>(y2 - y1);
+            if (boxW > 0 && boxH > 0)
+            {
+                boxes.push_back(cv::Rect(static_cast<int>(x1), static_cast<int>(y1), boxW, boxH));
+                confidences.push_back(maxConf);
+                classIds.push_back(maxClassId);
+            }
+        }
+
+        std::vector<int> indices;
+        cv::dnn::NMSBoxes(boxes, confidences, confThreshold, nmsThreshold, indices);
+
+        std::vector<RefBox> result;
+        for (int idx : indices)
+        {
+            result.push_back({boxes[idx], confidences[idx], classIds[idx]});
+        }
+        return result;
+    }
+
+    // 通道優先 [1, 4 + nc, A]；大部分 anchor 低於閾值，少數群聚在幾個零件周圍
+    cv::Mat randomOutput(basler_test::Rng &rng, int numClasses, int anchors, float confThreshold)
+    {
+        const int fields = 4 + numClasses;
+        const int sizes[3] = {1, fields, anchors};
+        cv::Mat output(3, sizes, CV_32F);
+        float *data = output.ptr<float>();
+
+        const int parts = uniformInt(rng, 0, 12);
+        std::vector<cv::Point2f> centers;
+        for (int i = 0; i < parts; ++i)
+        {
+            centers.emplace_back(static_cast<float>(uniformReal(rng, 0, 640)), static_cast<float>(uniformReal(rng, 200, 440)));
+        }
+
+        for (int a = 0; a < anchors; ++a)
+        {
+            const bool hit = !centers.empty() && uniformInt(rng, 0, 20) == 0;
+            const cv::Point2f c = hit ? centers[uniformInt(rng, 0, parts - 1)] : cv::Point2f(0, 0);
+            data[a] = hit ? c.x + static_cast<float>(uniformReal(rng, -3, 3)) : static_cast<float>(uniformReal(rng, 0, 640));
+            data[anchors + a] = hit ? c.y + static_cast<float>(uniformReal(rng, -3, 3)) : static_cast<float>(uniformReal(rng, 0, 640));
+            data[2 * anchors + a] = static_cast<float>(uniformReal(rng, 0.5, 40));
+            data[3 * anchors + a] = static_cast<float>(uniformReal(rng, 0.5, 40));
+            for (int k = 0; k < numClasses; ++k)
+            {
+                // 量化分數製造同分；偶爾落在閾值上，驗證 > 與 >= 的邊界
+                float score = static_cast<float>(uniformInt(rng, 0, 32)) / 32.0f * (hit ? 1.0f : 0.3f);
+                if (uniformInt(rng, 0, 200) == 0)
+                    score = confThreshold;
+                data[(4 + k) * anchors + a] = score;
+            }
+        }
+        return output;
+    }
+
+    // [1, C, A] → [1, A, C]
+    cv::Mat anchorMajor(const cv::Mat &channelMajor)
+    {
+        const int fields = channelMajor.size[1];
+        const int anchors = channelMajor.size[2];
+        cv::Mat transposed;
+        cv::transpose(channelMajor.reshape(1, fields), transposed);
+        const int sizes[3] = {1, anchors, fields};
+        return transposed.clone().reshape(1, 3, sizes);
+    }
+
+    bool sameResult(const std::vector<YoloPostProcessor::Box> &actual, const std::vector<RefBox> &expected)
+    {
+        if (!TEST_CHECK(actual.size() == expected.size()))
+        {
+            return false;
+        }
+        for (size_t i = 0; i < actual.size(); ++i)
+        {
+            const auto &a = actual[i];
+            const auto &e = expected[i];
+            if (!TEST_CHECK(a.x == e.rect.x && a.y == e.rect.y && a.w == e.rect.width && a.h == e.rect.height) ||
+                !TEST_CHECK(a.score == e.score && a.classId == e.classId))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+int main()
+{
+    basler_test::Rng rng(20240618);
+    YoloPostProcessor processor;
+
+    for (int run = 0; run < 2000 && basler_test::failureCount() == 0; ++run)
+    {
+        const int numClasses = uniformInt(rng, 1, 6);
+        const int anchors = uniformInt(rng, 8, 2100);
+        const float confThreshold = static_cast<float>(uniformInt(rng, 4, 24)) / 32.0f;
+        const float nmsThreshold = static_cast<float>(uniformReal(rng, 0.2, 0.7));
+
+        YoloPostProcessor::Mapping mapping;
+        mapping.scaleX = mapping.scaleY = uniformReal(rng, 0.5, 4.0);
+        mapping.padX = uniformInt(rng, 0, 40);
+        mapping.padY = uniformInt(rng, 0, 260);
+        mapping.upscaleRatio = uniformInt(rng, 0, 1) ? 1.0 : uniformReal(rng, 1.0, 3.0);
+
+        const cv::Mat output = randomOutput(rng, numClasses, anchors, confThreshold);
+        const auto expected = referencePostProcess(output, confThreshold, nmsThreshold, mapping);
+        if (!sameResult(processor.run(output, confThreshold, nmsThreshold, mapping), expected))
+        {
+            break;
+        }
+
+        // anchor 優先排列（anchor 數需 >= 欄位數才會被辨識成此格式）
+        if (anchors >= 4 + numClasses)
+        {
+            const cv::Mat rowMajor = anchorMajor(output);
+            sameResult(processor.run(rowMajor, confThreshold, nmsThreshold, mapping),
+                       referencePostProcess(rowMajor, confThreshold, nmsThreshold, mapping));
+        }
+    }
+    return basler_test::testResult("yolo_postprocess");
+}
@@ -0,0 +1,275 @@
+#!/usr/bin/env python3
+"""
+量化模型驗收：比較 FP32 基準模型與 FP16 / INT8 候選模型的偵測品質與延遲。
+
+功能：
+- 與 C++ YoloDetector 相同的前後處理（letterbox → 推理 → 信心過濾 → NMS）
+- 以 FP32 模型結果為參考：回報候選模型的一致率（recall / precision，IoU 匹配）
+  與每幀偵測數差異（計數結果受影響的程度）
+- 有標註時（YOLO 格式 labels 目錄）另外回報兩個模型對標註的 recall / precision
+- 回報推理延遲（平均 / P95）與相對 FP32 的差異
+- 依門檻判定 ACCEPT / REJECT，可輸出 JSON 報告存檔（每個零件配置一份）
+
+使用方式:
+    python compare_models.py --reference models/small_part.onnx \\
+        --candidate models/small_part.int8.onnx --frames ./frames
+    python compare_models.py --reference models/small_part.onnx \\
+        --candidate models/small_part.fp16.onnx --video recordings/run_001.avi \\
+        --part-id M3_screw --report reports/M3_screw_fp16.json
+"""
+
+import argparse
+import json
+import sys
+import time
+from pathlib import Path
+
+import cv2
+import numpy as np
+
+from export_onnx import letterbox_blob, load_calibration_images
+
+
+def create_session(model_path: str, threads: int):
+    import onnxruntime as ort
+
+    options = ort.SessionOptions()
+    options.graph_optimization_level = ort.GraphOptimizationLevel.ORT_ENABLE_ALL
+    if threads > 0:
+        options.intra_op_num_threads = threads
+    return ort.InferenceSession(
+        model_path, options, providers=["CPUExecutionProvider"]
+    )
+
+
+def decode(output: np.ndarray, image_shape, img_size: int, conf: float, nms: float):
+    """
+    與 YoloDetector::postProcess 相同：[1, 4+nc, N] → 信心過濾 → 反映射到 ROI 影像 → NMS。
+    回傳 [(x, y, w, h, score), ...]（放大後 ROI 影像座標）
+    """
+    data = output[0]
+    if data.shape[0] < data.shape[1]:
+        data = data.T
+
+    h, w = image_shape[:2]
+    ratio = min(img_size / w, img_size / h)
+    pad_x = (img_size - int(w * ratio)) // 2
+    pad_y = (img_size - int(h * ratio)) // 2
+
+    scores = data[:, 4:].max(axis=1)
+    keep = scores >= conf
+    data, scores = data[keep], scores[keep]
+
+    boxes = []
+    for (cx, cy, bw, bh), score in zip(data[:, :4], scores):
+        x1 = (cx - bw / 2 - pad_x) / ratio
+        y1 = (cy - bh / 2 - pad_y) / ratio
+        x2 = (cx + bw / 2 - pad_x) / ratio
+        y2 = (cy + bh / 2 - pad_y) / ratio
+        if x2 - x1 > 0 and y2 - y1 > 0:
+            boxes.append([int(x1), int(y1), int(x2 - x1), int(y2 - y1), float(score)])
+
+    if not boxes:
+        return []
+    indices = cv2.dnn.NMSBoxes(
+        [b[:4] for b in boxes], [b[4] for b in boxes], conf, nms
+    )
+    return [boxes[i] for i in np.array(indices).flatten()]
+
+
+def iou(a, b) -> float:
+    ax2, ay2 = a[0] + a[2], a[1] + a[3]
+    bx2, by2 = b[0] + b[2], b[1] + b[3]
+    iw = max(0, min(ax2, bx2) - max(a[0], b[0]))
+    ih = max(0, min(ay2, by2) - max(a[1], b[1]))
+    inter = iw * ih
+    union = a[2] * a[3] + b[2] * b[3] - inter
+    return inter / union if union > 0 else 0.0
+
+
+def match_count(predicted, truth, iou_threshold: float) -> int:
+    """貪婪 IoU 匹配（依分數由高到低），回傳匹配數"""
+    used = [False] * len(truth)
+    matched = 0
+    for p in sorted(predicted, key=lambda b: -b[4]):
+        best, best_iou = -1, iou_threshold
+        for j, t in enumerate(truth):
+            if used[j]:
+                continue
+            v = iou(p, t)
+            if v >= best_iou:
+                best, best_iou = j, v
+        if best >= 0:
+            used[best] = True
+            matched += 1
+    return matched
+
+
+def load_labels(label_path: Path, image_shape):
+    """YOLO 格式標註（class cx cy w h，0~1 正規化）→ 像素框"""
+    if not label_path.exists():
+        return []
+    h, w = image_shape[:2]
+    boxes = []
+    for line in label_path.read_text().splitlines():
+        parts = line.split()
+        if len(parts) < 5:
+            continue
+        cx, cy, bw, bh = (float(v) for v in parts[1:5])
+        boxes.append([int((cx - bw / 2) * w), int((cy - bh / 2) * h), int(bw * w), int(bh * h), 1.0])
+    return boxes
+
+
+def run_model(session, blobs, images, img_size, conf, nms, warmup: int):
+    input_name = session.get_inputs()[0].name
+    for blob in blobs[:warmup]:
+        session.run(None, {input_name: blob})
+
+    detections, latencies = [], []
+    for blob, image in zip(blobs, images):
+        start = time.perf_counter()
+        output = session.run(None, {input_name: blob})[0]
+        latencies.append((time.perf_counter() - start) * 1000.0)
+        detections.append(decode(output, image.shape, img_size, conf, nms))
+    return detections, np.array(latencies)
+
+
+def ratio(num: int, den: int) -> float:
+    return num / den if den > 0 else 1.0
+
+
+def main():
+    parser = argparse.ArgumentParser(description="比較 FP32 與量化 YOLO 模型的品質與延遲")
+    parser.add_argument("--reference", "-r", required=True, help="FP32 基準 .onnx")
+    parser.add_argument("--candidate", "-c", required=True, help="FP16 / INT8 候選 .onnx")
+    parser.add_argument("--frames", default=None, help="驗證幀目錄（extract_frames.py 輸出）")
+    parser.add_argument("--video", default=None, help="驗證影片（VideoRecorder 錄影）")
+    parser.add_argument("--labels", default=None, help="YOLO 標註目錄（檔名與 --frames 對應）")
+    parser.add_argument("--count", type=int, default=300, help="影像數上限")
+    parser.add_argument("--roi-y", type=float, default=0.12, help="影片 ROI Y 位置比例 (0~1)")
+    parser.add_argument("--roi-h", type=int, default=120, help="影片 ROI 高度 (像素)")
+    parser.add_argument("--upscale", type=float, default=2.0, help="影片 ROI 放大倍數")
+    parser.add_argument("--imgsz", type=int, default=640, help="模型輸入尺寸")
+    parser.add_argument("--conf", type=float, default=0.25, help="信心閾值")
+    parser.add_argument("--nms", type=float, default=0.45, help="NMS 閾值")
+    parser.add_argument("--iou", type=float, default=0.5, help="匹配 IoU 閾值")
+    parser.add_argument("--threads", type=int, default=0, help="推理線程數（0 = 預設）")
+    parser.add_argument("--warmup", type=int, default=10, help="暖機次數")
+    parser.add_argument("--min-agreement", type=float, default=0.98, help="與 FP32 一致率下限")
+    parser.add_argument("--max-count-diff", type=float, default=0.01, help="總偵測數相對差異上限")
+    parser.add_argument("--part-id", default="", help="零件配置 ID（寫入報告）")
+    parser.add_argument("--report", default=None, help="JSON 報告輸出路徑")
+
+    args = parser.parse_args()
+
+    if args.labels and not args.frames:
+        print("[ERROR] --labels 需搭配 --frames")
+        sys.exit(1)
+
+    images = load_calibration_images(
+        calib_dir=args.frames,
+        calib_video=args.video,
+        max_images=args.count,
+        roi_position_ratio=args.roi_y,
+        roi_height=args.roi_h,
+        upscale_factor=args.upscale,
+    )
+    if not images:
+        print("[ERROR] 沒有驗證影像（--frames 或 --video）")
+        sys.exit(1)
+
+    print(f"[INFO] 驗證影像: {len(images)} 張")
+    blobs = [letterbox_blob(img, args.imgsz) for img in images]
+
+    ref_session = create_session(args.reference, args.threads)
+    cand_session = create_session(args.candidate, args.threads)
+    ref_dets, ref_lat = run_model(ref_session, blobs, images, args.imgsz, args.conf, args.nms, args.warmup)
+    cand_dets, cand_lat = run_model(cand_session, blobs, images, args.imgsz, args.conf, args.nms, args.warmup)
+
+    # 與 FP32 的一致率
+    ref_total = sum(len(d) for d in ref_dets)
+    cand_total = sum(len(d) for d in cand_dets)
+    agreed = sum(match_count(c, r, args.iou) for c, r in zip(cand_dets, ref_dets))
+    agreement_recall = ratio(agreed, ref_total)
+    agreement_precision = ratio(agreed, cand_total)
+    count_diff = abs(cand_total - ref_total) / max(ref_total, 1)
+    frames_changed = sum(1 for c, r in zip(cand_dets, ref_dets) if len(c) != len(r))
+
+    report = {
+        "partId": args.part_id,
+        "reference": args.reference,
+        "candidate": args.candidate,
+        "images": len(images),
+        "agreement": {
+            "recall": agreement_recall,
+            "precision": agreement_precision,
+            "referenceDetections": ref_total,
+            "candidateDetections": cand_total,
+            "countDiffRatio": count_diff,
+            "framesWithCountChange": frames_changed,
+        },
+        "latencyMs": {
+            "referenceMean": float(ref_lat.mean()),
+            "referenceP95": float(np.percentile(ref_lat, 95)),
+            "candidateMean": float(cand_lat.mean()),
+            "candidateP95": float(np.percentile(cand_lat, 95)),
+            "speedup": float(ref_lat.mean() / cand_lat.mean()) if cand_lat.mean() > 0 else 0.0,
+        },
+    }
+
+    # 有標註時：兩個模型對標註的 recall / precision
+    if args.labels:
+        files = sorted(
+            f for f in Path(args.frames).iterdir() if f.suffix.lower() in {".jpg", ".jpeg", ".png", ".bmp"}
+        )
+        step = max(1, len(files) // args.count) if args.count > 0 else 1
+        files = files[::step][: len(images)]
+        truth = [load_labels(Path(args.labels) / (f.stem + ".txt"), img.shape) for f, img in zip(files, images)]
+        gt_total = sum(len(t) for t in truth)
+
+        def ground_truth_stats(dets):
+            hit = sum(match_count(d, t, args.iou) for d, t in zip(dets, truth))
+            return {
+                "recall": ratio(hit, gt_total),
+                "precision": ratio(hit, sum(len(d) for d in dets)),
+            }
+
+        report["groundTruth"] = {
+            "labels": gt_total,
+            "reference": ground_truth_stats(ref_dets),
+            "candidate": ground_truth_stats(cand_dets),
+        }
+
+    accepted = agreement_recall >= args.min_agreement and count_diff <= args.max_count_diff
+    report["accepted"] = accepted
+
+    # 輸出
+    print("\n==========================================")
+    print(f"量化模型驗收 {('- ' + args.part_id) if args.part_id else ''}")
+    print("==========================================")
+    print(f"基準: {args.reference}")
+    print(f"候選: {args.candidate}")
+    print(f"一致率 recall={agreement_recall:.4f}, precision={agreement_precision:.4f}")
+    print(f"偵測數 {ref_total} → {cand_total} (差異 {count_diff * 100:.2f}%，{frames_changed} 幀數量不同)")
+    lat = report["latencyMs"]
+    print(f"延遲 平均 {lat['referenceMean']:.2f} → {lat['candidateMean']:.2f} ms "
+          f"(P95 {lat['referenceP95']:.2f} → {lat['candidateP95']:.2f} ms, {lat['speedup']:.2f}x)")
+    if "groundTruth" in report:
+        gt = report["groundTruth"]
+        print(f"標註 {gt['labels']} 個: FP32 recall={gt['reference']['recall']:.4f} "
+              f"precision={gt['reference']['precision']:.4f} / 候選 recall={gt['candidate']['recall']:.4f} "
+              f"precision={gt['candidate']['precision']:.4f}")
+    print(f"判定: {'ACCEPT' if accepted else 'REJECT'} "
+          f"(一致率 >= {args.min_agreement}, 數量差異 <= {args.max_count_diff * 100:.1f}%)")
+
+    if args.report:
+        report_path = Path(args.report)
+        report_path.parent.mkdir(parents=True, exist_ok=True)
+        report_path.write_text(json.dumps(report, indent=2, ensure_ascii=False))
+        print(f"[INFO] 報告已寫入: {report_path}")
+
+    sys.exit(0 if accepted else 2)
+
+
+if __name__ == "__main__":
+    main()
@@ -6,10 +6,21 @@
 - best.pt → .onnx（opset 12）
 - 自動使用 onnxsim 簡化模型
 - 驗證匯出模型推理結果一致
+- 可選 FP16 / INT8 量化（無獨立 GPU 的工作站用）
+  - FP16：權重與運算轉半精度，輸入輸出維持 float32（C++ blob 不變）
+  - INT8：靜態量化（QDQ），校正資料取自 extract_frames.py 的幀目錄或 VideoRecorder 錄影
+  - 輸出檔名加上 .fp16 / .int8 後綴，並寫入 ONNX metadata "precision"，
+    C++ YoloDetector 依此選擇後端的精度設定
 
 使用方式:
     python export_onnx.py --model runs/train/small_part/weights/best.pt
     python export_onnx.py --model best.pt --output ./models/small_part.onnx --imgsz 640
+    python export_onnx.py --model best.pt --output ./models/small_part.onnx --precision fp16
+    python export_onnx.py --model best.pt --output ./models/small_part.onnx --precision int8 --calib-dir ./frames
+    python export_onnx.py --model best.pt --output ./models/small_part.onnx --precision int8 \
+        --calib-video recordings/run_001.avi --roi-y 0.12 --roi-h 120 --upscale 2.0
+
+量化後請用 compare_models.py 與 FP32 模型比較準確度與延遲，再決定是否採用。
 """
 
 import argparse
@@ -17,6 +28,182 @@ import sys
 from pathlib import Path
 import numpy as np
 
+IMAGE_SUFFIXES = {".jpg", ".jpeg", ".png", ".bmp"}
+
+
+def letterbox_blob(image: np.ndarray, img_size: int) -> np.ndarray:
+    """
+    與 C++ YoloDetector::letterbox + blobFromImage 相同的前處理：
+    等比縮放、灰色 (114) 置中填充、BGR→RGB、0~1 正規化、NCHW float32。
+    """
+    import cv2
+
+    h, w = image.shape[:2]
+    ratio = min(img_size / w, img_size / h)
+    new_w, new_h = int(w * ratio), int(h * ratio)
+    resized = cv2.resize(image, (new_w, new_h), interpolation=cv2.INTER_LINEAR)
+
+    canvas = np.full((img_size, img_size, 3), 114, dtype=np.uint8)
+    pad_x = (img_size - new_w) // 2
+    pad_y = (img_size - new_h) // 2
+    canvas[pad_y : pad_y + new_h, pad_x : pad_x + new_w] = resized
+
+    return cv2.dnn.blobFromImage(
+        canvas, 1.0 / 255.0, (img_size, img_size), (0, 0, 0), True, False
+    ).astype(np.float32)
+
+
+def load_calibration_images(
+    calib_dir: str = None,
+    calib_video: str = None,
+    max_images: int = 200,
+    roi_position_ratio: float = 0.12,
+    roi_height: int = 120,
+    upscale_factor: float = 2.0,
+):
+    """
+    載入校正 / 驗證影像（已是 C++ 推理前的 ROI 放大影像，尚未 letterbox）。
+
+    - calib_dir：extract_frames.py 的輸出（已裁切 + 放大）
+    - calib_video：VideoRecorder 錄影，依 ROI 參數裁切 + 放大，均勻取樣
+    """
+    import cv2
+
+    images = []
+
+    if calib_dir:
+        files = sorted(
+            f for f in Path(calib_dir).iterdir() if f.suffix.lower() in IMAGE_SUFFIXES
+        )
+        step = max(1, len(files) // max_images) if max_images > 0 else 1
+        for f in files[::step][:max_images]:
+            img = cv2.imread(str(f))
+            if img is not None:
+                images.append(img)
+
+    if calib_video:
+        cap = cv2.VideoCapture(calib_video)
+        if not cap.isOpened():
+            print(f"[ERROR] 無法開啟影片: {calib_video}")
+        else:
+            total = int(cap.get(cv2.CAP_PROP_FRAME_COUNT))
+            step = max(1, total // max_images) if max_images > 0 and total > 0 else 1
+            frame_idx = 0
+            while len(images) < max_images or max_images <= 0:
+                ret, frame = cap.read()
+                if not ret:
+                    break
+                frame_idx += 1
+                if frame_idx % step != 0:
+                    continue
+
+                frame_h = frame.shape[0]
+                roi_y = int(frame_h * roi_position_ratio)
+                roi_h = min(roi_height, frame_h - roi_y)
+                roi = frame[roi_y : roi_y + roi_h, :]
+                if upscale_factor > 1.0:
+                    roi = cv2.resize(
+                        roi,
+                        None,
+                        fx=upscale_factor,
+                        fy=upscale_factor,
+                        interpolation=cv2.INTER_LINEAR,
+                    )
+                images.append(roi)
+            cap.release()
+
+    return images
+
+
+def precision_output_path(onnx_path: str, precision: str) -> str:
+    """small_part.onnx → small_part.fp16.onnx / small_part.int8.onnx"""
+    path = Path(onnx_path)
+    return str(path.with_name(f"{path.stem}.{precision}{path.suffix}"))
+
+
+def tag_precision(onnx_path: str, precision: str):
+    """寫入 ONNX metadata "precision"（C++ 端亦依檔名後綴判斷）"""
+    import onnx
+
+    model = onnx.load(onnx_path)
+    for prop in list(model.metadata_props):
+        if prop.key == "precision":
+            model.metadata_props.remove(prop)
+    entry = model.metadata_props.add()
+    entry.key = "precision"
+    entry.value = precision
+    onnx.save(model, onnx_path)
+
+
+def convert_fp16(onnx_path: str, output_path: str) -> str:
+    """
+    轉換為 FP16（keep_io_types：輸入輸出維持 float32，C++ 前後處理不變）。
+    """
+    try:
+        import onnx
+        from onnxconverter_common import float16
+    except ImportError:
+        print("[ERROR] FP16 轉換需要 onnxconverter-common: pip install onnxconverter-common")
+        sys.exit(1)
+
+    print(f"[INFO] 轉換 FP16: {onnx_path} → {output_path}")
+    model = onnx.load(onnx_path)
+    model_fp16 = float16.convert_float_to_float16(model, keep_io_types=True)
+    onnx.save(model_fp16, output_path)
+    tag_precision(output_path, "fp16")
+    return output_path
+
+
+def quantize_int8(onnx_path: str, output_path: str, calib_images, img_size: int) -> str:
+    """
+    INT8 靜態量化（QDQ 格式，權重逐通道）。
+
+    校正資料使用與 C++ 相同的 letterbox 前處理，讓量化範圍符合實際輸入分佈。
+    """
+    try:
+        from onnxruntime.quantization import (
+            CalibrationDataReader,
+            CalibrationMethod,
+            QuantFormat,
+            QuantType,
+            quantize_static,
+        )
+    except ImportError:
+        print("[ERROR] INT8 量化需要 onnxruntime: pip install onnxruntime")
+        sys.exit(1)
+
+    if not calib_images:
+        print("[ERROR] INT8 量化需要校正資料（--calib-dir 或 --calib-video）")
+        sys.exit(1)
+
+    import onnx
+
+    input_name = onnx.load(onnx_path).graph.input[0].name
+
+    class LetterboxReader(CalibrationDataReader):
+        def __init__(self, images):
+            self._iter = iter(images)
+
+        def get_next(self):
+            img = next(self._iter, None)
+            if img is None:
+                return None
+            return {input_name: letterbox_blob(img, img_size)}
+
+    print(f"[INFO] INT8 靜態量化: {len(calib_images)} 張校正影像 → {output_path}")
+    quantize_static(
+        onnx_path,
+        output_path,
+        LetterboxReader(calib_images),
+        quant_format=QuantFormat.QDQ,
+        activation_type=QuantType.QUInt8,
+        weight_type=QuantType.QInt8,
+        per_channel=True,
+        calibrate_method=CalibrationMethod.Percentile,
+    )
+    tag_precision(output_path, "int8")
+    return output_path
+
 
 def export_onnx(
     model_path: str,
@@ -25,6 +212,8 @@ def export_onnx(
     opset: int = 12,
     simplify: bool = True,
     verify: bool = True,
+    precision: str = "fp32",
+    calib_images=None,
 ):
     """
     匯出 YOLOv8 模型為 ONNX 格式。
@@ -36,6 +225,8 @@ def export_onnx(
         opset: ONNX opset 版本
         simplify: 是否使用 onnxsim 簡化
         verify: 是否驗證匯出結果
+        precision: fp32 / fp16 / int8（fp16 / int8 另外輸出帶後綴的量化模型，FP32 模型保留供比較）
+        calib_images: INT8 校正影像（load_calibration_images 的結果）
     """
     from ultralytics import YOLO
 
@@ -73,6 +264,24 @@ def export_onnx(
     if verify:
         verify_export(str(model_path), str(export_path), img_size)
 
+    # 量化（FP32 模型保留，作為 compare_models.py 的基準）
+    if precision == "fp16":
+        export_path = convert_fp16(
+            str(export_path), precision_output_path(str(export_path), "fp16")
+        )
+    elif precision == "int8":
+        export_path = quantize_int8(
+            str(export_path),
+            precision_output_path(str(export_path), "int8"),
+            calib_images,
+            img_size,
+        )
+
+    if precision != "fp32":
+        print(f"[INFO] 量化模型: {export_path}")
+        print("[INFO] 下一步: python compare_models.py --reference <fp32.onnx> --candidate "
+              f"{export_path} --frames <驗證幀目錄>")
+
     return export_path
 
 
@@ -121,9 +330,32 @@ def main():
         "--no-simplify", action="store_true", help="不使用 onnxsim 簡化"
     )
     parser.add_argument("--no-verify", action="store_true", help="跳過驗證")
+    parser.add_argument(
+        "--precision",
+        choices=["fp32", "fp16", "int8"],
+        default="fp32",
+        help="模型精度（fp16 / int8 額外輸出量化模型）",
+    )
+    parser.add_argument("--calib-dir", default=None, help="INT8 校正幀目錄（extract_frames.py 輸出）")
+    parser.add_argument("--calib-video", default=None, help="INT8 校正影片（VideoRecorder 錄影）")
+    parser.add_argument("--calib-count", type=int, default=200, help="校正影像數上限")
+    parser.add_argument("--roi-y", type=float, default=0.12, help="校正影片 ROI Y 位置比例 (0~1)")
+    parser.add_argument("--roi-h", type=int, default=120, help="校正影片 ROI 高度 (像素)")
+    parser.add_argument("--upscale", type=float, default=2.0, help="校正影片 ROI 放大倍數")
 
     args = parser.parse_args()
 
+    calib_images = None
+    if args.precision == "int8":
+        calib_images = load_calibration_images(
+            calib_dir=args.calib_dir,
+            calib_video=args.calib_video,
+            max_images=args.calib_count,
+            roi_position_ratio=args.roi_y,
+            roi_height=args.roi_h,
+            upscale_factor=args.upscale,
+        )
+
     export_onnx(
         model_path=args.model,
         output_path=args.output,
@@ -131,6 +363,8 @@ def main():
         opset=args.opset,
         simplify=not args.no_simplify,
         verify=not args.no_verify,
+        precision=args.precision,
+        calib_images=calib_images,
     )
 
 